@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../fileparse/ini/ini_reader.h"
+
+/**
+ * @brief 原有实现(逐字节读取, 线性查找, 每次获取都用字符串流转换), 作为对照
+ */
+class LegacyIni
+{
+public:
+    int open(const std::string& filename)
+    {
+        auto f = fopen(filename.c_str(), "rb");
+        if (!f)
+        {
+            return 1;
+        }
+        m_sections.clear();
+        auto sectionIter = m_sections.end();
+        std::string comment;
+        while (!feof(f))
+        {
+            std::string line;
+            char ch;
+            while (!feof(f) && '\n' != (ch = fgetc(f)))
+            {
+                line.push_back(ch);
+            }
+            if (!line.empty() && ('\r' == line.back() || 0xFF == (unsigned char)line.back()))
+            {
+                line.pop_back();
+            }
+            trim(line);
+            if (line.empty())
+            {
+                continue;
+            }
+            if ('#' == line[0] || ';' == line[0])
+            {
+                comment = comment.empty() ? line : comment + "\n" + line;
+            }
+            else if ('[' == line[0])
+            {
+                std::string name(line, 1, line.find_first_of(']') - 1);
+                for (const auto& section : m_sections)
+                {
+                    if (name == section.name)
+                    {
+                        fclose(f);
+                        return 4;
+                    }
+                }
+                ini::IniSection section;
+                section.name = name;
+                section.comment = comment;
+                sectionIter = m_sections.insert(m_sections.end(), section);
+                comment.clear();
+            }
+            else
+            {
+                auto pos = line.find('=');
+                if (std::string::npos == pos || m_sections.end() == sectionIter)
+                {
+                    fclose(f);
+                    return 5;
+                }
+                ini::IniItem item;
+                item.key = line.substr(0, pos);
+                item.value = line.substr(pos + 1);
+                trim(item.key);
+                trim(item.value);
+                for (const auto& exist : sectionIter->items)
+                {
+                    if (item.key == exist.key)
+                    {
+                        fclose(f);
+                        return 6;
+                    }
+                }
+                item.comment = comment;
+                sectionIter->items.emplace_back(item);
+                comment.clear();
+            }
+        }
+        fclose(f);
+        return 0;
+    }
+
+    bool getValue(const std::string& name, const std::string& key, std::string& value) const
+    {
+        value.clear();
+        for (const auto& section : m_sections)
+        {
+            if (name == section.name)
+            {
+                for (const auto& item : section.items)
+                {
+                    if (key == item.key)
+                    {
+                        value = item.value;
+                        return true;
+                    }
+                }
+                break;
+            }
+        }
+        return false;
+    }
+
+    int getInt(const std::string& name, const std::string& key, int defaultValue = 0) const
+    {
+        std::string value;
+        if (getValue(name, key, value))
+        {
+            std::stringstream ss;
+            ss << value;
+            int result;
+            ss >> result;
+            return result;
+        }
+        return defaultValue;
+    }
+
+private:
+    static void trim(std::string& str)
+    {
+        str.erase(0, str.find_first_not_of(' '));
+        str.erase(str.find_last_not_of(' ') + 1);
+    }
+
+private:
+    std::vector<ini::IniSection> m_sections;
+};
+
+/**
+ * @brief 生成测试文件
+ */
+static void makeFile(const std::string& filename, size_t sectionCount, size_t keyCount)
+{
+    auto f = fopen(filename.c_str(), "wb");
+    if (!f)
+    {
+        return;
+    }
+    for (size_t i = 0; i < sectionCount; ++i)
+    {
+        fprintf(f, "# section comment %zu\n[section_%zu]\n", i, i);
+        for (size_t j = 0; j < keyCount; ++j)
+        {
+            if (0 == j % 10)
+            {
+                fprintf(f, "# item comment %zu\n", j);
+            }
+            fprintf(f, "key_%zu = %zu\n", j, (i * keyCount + j) % 100000);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+}
+
+static double elapsedMs(const std::chrono::steady_clock::time_point& tp1, const std::chrono::steady_clock::time_point& tp2)
+{
+    return std::chrono::duration<double, std::milli>(tp2 - tp1).count();
+}
+
+static double nsPerOp(const std::chrono::steady_clock::time_point& tp1, const std::chrono::steady_clock::time_point& tp2, size_t count)
+{
+    return std::chrono::duration<double, std::nano>(tp2 - tp1).count() / count;
+}
+
+int main(int argc, char** argv)
+{
+    size_t sectionCount = 100;
+    size_t keyCount = 100;
+    size_t lookupCount = 1000000;
+    if (argc > 1)
+    {
+        sectionCount = std::max(1, atoi(argv[1]));
+    }
+    if (argc > 2)
+    {
+        keyCount = std::max(1, atoi(argv[2]));
+    }
+    if (argc > 3)
+    {
+        lookupCount = std::max(1, atoi(argv[3]));
+    }
+    const std::string filename = "example_ini_benchmark.ini";
+    makeFile(filename, sectionCount, keyCount);
+    /* 随机键 */
+    std::mt19937 rng(1);
+    std::vector<std::pair<std::string, std::string>> keyList;
+    keyList.reserve(4096);
+    for (size_t i = 0; i < 4096; ++i)
+    {
+        keyList.emplace_back("section_" + std::to_string(rng() % sectionCount), "key_" + std::to_string(rng() % keyCount));
+    }
+    printf("sections: %zu, keys per section: %zu, lookups: %zu\n", sectionCount, keyCount, lookupCount);
+    printf("%-10s %12s %16s %16s\n", "impl", "open(ms)", "getString(ns)", "getInt(ns)");
+    long long checksum = 0;
+    {
+        LegacyIni legacy;
+        auto tp1 = std::chrono::steady_clock::now();
+        if (0 != legacy.open(filename))
+        {
+            printf("legacy open failed\n");
+            return 1;
+        }
+        auto tp2 = std::chrono::steady_clock::now();
+        std::string value;
+        for (size_t i = 0; i < lookupCount; ++i)
+        {
+            const auto& kv = keyList[i & 4095];
+            legacy.getValue(kv.first, kv.second, value);
+            checksum += value.size();
+        }
+        auto tp3 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookupCount; ++i)
+        {
+            const auto& kv = keyList[i & 4095];
+            checksum += legacy.getInt(kv.first, kv.second);
+        }
+        auto tp4 = std::chrono::steady_clock::now();
+        printf("%-10s %12.2f %16.1f %16.1f\n", "legacy", elapsedMs(tp1, tp2), nsPerOp(tp2, tp3, lookupCount),
+               nsPerOp(tp3, tp4, lookupCount));
+    }
+    {
+        ini::IniReader reader;
+        std::string errorDesc;
+        auto tp1 = std::chrono::steady_clock::now();
+        if (0 != reader.open(filename, errorDesc))
+        {
+            printf("indexed open failed: %s\n", errorDesc.c_str());
+            return 1;
+        }
+        auto tp2 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookupCount; ++i)
+        {
+            const auto& kv = keyList[i & 4095];
+            auto item = reader.findItem(kv.first, kv.second);
+            checksum += item ? item->value.size() : 0;
+        }
+        auto tp3 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookupCount; ++i)
+        {
+            const auto& kv = keyList[i & 4095];
+            checksum -= reader.getInt(kv.first, kv.second);
+        }
+        auto tp4 = std::chrono::steady_clock::now();
+        printf("%-10s %12.2f %16.1f %16.1f\n", "indexed", elapsedMs(tp1, tp2), nsPerOp(tp2, tp3, lookupCount),
+               nsPerOp(tp3, tp4, lookupCount));
+    }
+    printf("checksum: %lld\n", checksum);
+    remove(filename.c_str());
+    return 0;
+}
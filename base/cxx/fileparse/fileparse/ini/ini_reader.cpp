@@ -1,18 +1,37 @@
 #include "ini_reader.h"
 
-#include <algorithm>
-#include <sstream>
+#include <limits>
 
 namespace ini
 {
-template<typename in_value, typename out_type>
-out_type convert(const in_value& t)
+/**
+ * @brief 转换为有符号整型(溢出时取边界值)
+ */
+template<typename T>
+T toSigned(const IniTypedValue& typed)
 {
-    std::stringstream ss;
-    ss << t;
-    out_type result;
-    ss >> result;
-    return result;
+    if (typed.llValue > (long long)std::numeric_limits<T>::max())
+    {
+        return std::numeric_limits<T>::max();
+    }
+    else if (typed.llValue < (long long)std::numeric_limits<T>::min())
+    {
+        return std::numeric_limits<T>::min();
+    }
+    return (T)typed.llValue;
+}
+
+/**
+ * @brief 转换为无符号整型(负数按类型回绕, 溢出时取最大值)
+ */
+template<typename T>
+T toUnsigned(const IniTypedValue& typed)
+{
+    if (!typed.negative && typed.ullValue > (unsigned long long)std::numeric_limits<T>::max())
+    {
+        return std::numeric_limits<T>::max();
+    }
+    return (T)typed.ullValue;
 }
 
 int IniReader::open(const std::string& filename, std::string& errorDesc)
@@ -46,6 +65,16 @@ bool IniReader::getSectionComment(const std::string& name, std::string& comment)
     return IniFile::getSectionComment(name, comment);
 }
 
+const IniSection* IniReader::findSection(const std::string& name) const
+{
+    return IniFile::findSection(name);
+}
+
+const IniItem* IniReader::findItem(const std::string& name, const std::string& key) const
+{
+    return IniFile::findItem(name, key);
+}
+
 bool IniReader::hasItem(const std::string& name, const std::string& key) const
 {
     return IniFile::hasItem(name, key);
@@ -58,101 +87,111 @@ bool IniReader::getComment(const std::string& name, const std::string& key, std:
 
 bool IniReader::getBool(const std::string& name, const std::string& key, bool defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        std::transform(value.begin(), value.end(), value.begin(), tolower);
-        return 0 == value.compare("true");
+        return typed->boolValue;
     }
     return defaultValue;
 }
 
 int IniReader::getInt(const std::string& name, const std::string& key, int defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, int>(value);
+        return toSigned<int>(*typed);
     }
     return defaultValue;
 }
 
 unsigned int IniReader::getUInt(const std::string& name, const std::string& key, unsigned int defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, unsigned int>(value);
+        return toUnsigned<unsigned int>(*typed);
     }
     return defaultValue;
 }
 
 long IniReader::getLong(const std::string& name, const std::string& key, long defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, long>(value);
+        return toSigned<long>(*typed);
     }
     return defaultValue;
 }
 
 unsigned long IniReader::getULong(const std::string& name, const std::string& key, unsigned long defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, unsigned long>(value);
+        return toUnsigned<unsigned long>(*typed);
     }
     return defaultValue;
 }
 
 long long IniReader::getLongLong(const std::string& name, const std::string& key, long long defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, long long>(value);
+        return typed->llValue;
     }
     return defaultValue;
 }
 
 unsigned long long IniReader::getULongLong(const std::string& name, const std::string& key, unsigned long long defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, unsigned long long>(value);
+        return typed->ullValue;
     }
     return defaultValue;
 }
 
 float IniReader::getFloat(const std::string& name, const std::string& key, float defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
     {
-        return convert<std::string, float>(value);
+        return (float)typed->doubleValue;
     }
     return defaultValue;
 }
 
 double IniReader::getDouble(const std::string& name, const std::string& key, double defaultValue) const
 {
-    std::string value;
-    if (getValue(name, key, value))
+    auto typed = getTypedValue(name, key);
+    if (typed)
+    {
+        return typed->doubleValue;
+    }
+    return defaultValue;
+}
+
+std::chrono::milliseconds IniReader::getDuration(const std::string& name, const std::string& key,
+                                                 const std::chrono::milliseconds& defaultValue) const
+{
+    auto typed = getTypedValue(name, key);
+    if (typed && typed->durationValid)
     {
-        return convert<std::string, double>(value);
+        return typed->durationValue;
     }
     return defaultValue;
 }
 
 std::string IniReader::getString(const std::string& name, const std::string& key, std::string defaultValue) const
 {
-    std::string value;
-    if (IniFile::getValue(name, key, value))
+    auto item = findItem(name, key);
+    if (item)
     {
-        return value;
+        return item->value;
     }
     return defaultValue;
 }
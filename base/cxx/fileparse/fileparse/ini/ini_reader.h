@@ -53,6 +53,21 @@ public:
      */
     bool getSectionComment(const std::string& name, std::string& comment) const;
 
+    /**
+     * @brief 查找节(不拷贝)
+     * @param name 节名称
+     * @return 节, 为空表示不存在(修改节/项之后失效)
+     */
+    const IniSection* findSection(const std::string& name) const;
+
+    /**
+     * @brief 查找项(不拷贝)
+     * @param name 节名称
+     * @param key 键
+     * @return 项, 为空表示不存在(修改节/项之后失效)
+     */
+    const IniItem* findItem(const std::string& name, const std::string& key) const;
+
     /**
      * @brief 是否存在项
      * @param name 节名称
@@ -151,6 +166,16 @@ public:
      */
     double getDouble(const std::string& name, const std::string& key, double defaultValue = 0.0) const;
 
+    /**
+     * @brief 获取时长
+     * @param name 节名称
+     * @param key 键
+     * @param defaultValue 默认值(值的格式无效时也返回默认值)
+     * @return 值, 格式: 数值+单位(us,ms,s,m,h,d), 无单位时为毫秒, 例如: "500", "1.5s", "10m"
+     */
+    std::chrono::milliseconds getDuration(const std::string& name, const std::string& key,
+                                          const std::chrono::milliseconds& defaultValue = std::chrono::milliseconds(0)) const;
+
     /**
      * @brief 获取字符串
      * @param name 节名称
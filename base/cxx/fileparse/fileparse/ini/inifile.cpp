@@ -1,7 +1,13 @@
 #include "inifile.h"
 
 #include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <tuple>
 #ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
@@ -41,29 +47,189 @@ void trimLeftRightCRLF(std::string& str)
     trimRight(str, '\r');
 }
 
-std::string getLine(FILE* f)
+/**
+ * @brief 只读文件视图(非Windows平台使用内存映射, 不需要把文件内容拷贝到用户态缓冲区)
+ */
+class FileView
 {
-    std::string line;
-    if (f)
+public:
+    ~FileView()
+    {
+#ifndef _WIN32
+        if (m_addr)
+        {
+            munmap(m_addr, m_size);
+        }
+#endif
+    }
+
+    /**
+     * @brief 打开文件
+     * @param filename 文件名
+     * @return true-成功, false-失败
+     */
+    bool open(const std::string& filename)
     {
-        char ch;
-        while (!feof(f) && '\n' != (ch = fgetc(f)))
+#ifdef _WIN32
+        auto f = fopen(filename.c_str(), "rb");
+        if (!f)
+        {
+            return false;
+        }
+        char buf[64 * 1024];
+        size_t count;
+        while ((count = fread(buf, 1, sizeof(buf), f)) > 0)
         {
-            line.push_back(ch);
+            m_buffer.append(buf, count);
         }
-        /* BOM字符检测 */
-        if (line.size() >= 3 && (0xEF == (unsigned char)line[0] && 0xBB == (unsigned char)line[1] && 0xBF == (unsigned char)line[2]))
+        fclose(f);
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
         {
-            line = line.substr(3);
+            return false;
         }
-        /* 非显示字符检测 */
-        long long lastIndex = line.size() - 1;
-        if (lastIndex >= 0 && ('\r' == line[lastIndex] || 0xFF == (unsigned char)line[lastIndex]))
+        struct stat st;
+        if (0 != fstat(fd, &st) || !S_ISREG(st.st_mode))
         {
-            line.erase(lastIndex);
+            ::close(fd);
+            return false;
         }
+        m_size = (size_t)st.st_size;
+        if (m_size > 0)
+        {
+            void* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != addr)
+            {
+                madvise(addr, m_size, MADV_SEQUENTIAL);
+                m_addr = addr;
+                m_data = (const char*)addr;
+            }
+            else /* 映射失败时读入内存 */
+            {
+                m_buffer.resize(m_size);
+                size_t offset = 0;
+                while (offset < m_size)
+                {
+                    auto count = ::read(fd, &m_buffer[offset], m_size - offset);
+                    if (count <= 0)
+                    {
+                        break;
+                    }
+                    offset += (size_t)count;
+                }
+                m_buffer.resize(offset);
+                m_data = m_buffer.data();
+                m_size = m_buffer.size();
+            }
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+#ifndef _WIN32
+    void* m_addr = nullptr; /* 映射地址 */
+#endif
+    std::string m_buffer; /* 缓冲区(未映射时使用) */
+    const char* m_data = nullptr; /* 数据 */
+    size_t m_size = 0; /* 数据长度 */
+};
+
+/**
+ * @brief 去除行首的BOM和行尾的不可显示字符
+ */
+void normalizeLine(std::string& line)
+{
+    /* BOM字符检测 */
+    if (line.size() >= 3 && (0xEF == (unsigned char)line[0] && 0xBB == (unsigned char)line[1] && 0xBF == (unsigned char)line[2]))
+    {
+        line.erase(0, 3);
+    }
+    /* 非显示字符检测 */
+    if (!line.empty() && ('\r' == line.back() || 0xFF == (unsigned char)line.back()))
+    {
+        line.pop_back();
     }
-    return line;
+}
+
+/**
+ * @brief 解析时长
+ * @param value 值, 格式: 数值+单位(us,ms,s,m,h,d), 无单位时为毫秒
+ * @param duration [输出]时长
+ * @return true-成功, false-失败
+ */
+bool parseDuration(const std::string& value, std::chrono::milliseconds& duration)
+{
+    char* endPtr = nullptr;
+    const double num = strtod(value.c_str(), &endPtr);
+    if (endPtr == value.c_str())
+    {
+        return false;
+    }
+    std::string unit(endPtr);
+    trimLeftRightSpace(unit);
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::tolower);
+    double factor = 0;
+    if (unit.empty() || "ms" == unit)
+    {
+        factor = 1;
+    }
+    else if ("us" == unit)
+    {
+        factor = 0.001;
+    }
+    else if ("s" == unit)
+    {
+        factor = 1000;
+    }
+    else if ("m" == unit || "min" == unit)
+    {
+        factor = 60 * 1000;
+    }
+    else if ("h" == unit)
+    {
+        factor = 60 * 60 * 1000;
+    }
+    else if ("d" == unit)
+    {
+        factor = 24 * 60 * 60 * 1000;
+    }
+    else
+    {
+        return false;
+    }
+    duration = std::chrono::milliseconds((long long)(num * factor));
+    return true;
+}
+
+/**
+ * @brief 解析类型化的值
+ */
+void parseTypedValue(const std::string& value, IniTypedValue& typed)
+{
+    std::string lower(value);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    typed.boolValue = ("true" == lower);
+    typed.negative = (!value.empty() && '-' == value[0]);
+    typed.llValue = strtoll(value.c_str(), nullptr, 10);
+    typed.ullValue = strtoull(value.c_str(), nullptr, 10);
+    typed.doubleValue = strtod(value.c_str(), nullptr);
+    typed.durationValid = parseDuration(value, typed.durationValue);
 }
 
 bool getKeyAndValue(const std::string& content, std::string& key, std::string& value, char c)
@@ -91,29 +257,56 @@ IniFile::IniFile()
     m_commentFlags.emplace_back(";");
 }
 
+IniFile::IniFile(const IniFile& src)
+    : m_filename(src.m_filename), m_sections(src.m_sections), m_commentFlags(src.m_commentFlags), m_changed(src.m_changed)
+{
+    rebuildIndex();
+}
+
 IniFile::~IniFile()
 {
     save();
 }
 
+IniFile& IniFile::operator=(const IniFile& src)
+{
+    if (this != &src)
+    {
+        m_filename = src.m_filename;
+        m_sections = src.m_sections;
+        m_commentFlags = src.m_commentFlags;
+        m_changed = src.m_changed;
+        rebuildIndex();
+    }
+    return *this;
+}
+
 int IniFile::open(const std::string& filename, bool allowTailComment, std::string& errorDesc)
 {
     errorDesc.clear();
-    auto f = fopen(filename.c_str(), "rb");
-    if (!f)
+    FileView view;
+    if (!view.open(filename))
     {
         errorDesc = "can't open file [" + filename + "]";
         return 1;
     }
     m_filename = filename;
     m_sections.clear();
-    auto sectionIter = m_sections.begin();
+    m_sectionIndexMap.clear();
+    SectionIndex* sectionIndex = nullptr;
     std::string comment;
+    std::string line;
     size_t lineNumber = 0;
-    while (!feof(f))
-    {
-        auto line = getLine(f);
+    const char* ptr = view.data();
+    const char* end = ptr + view.size();
+    while (ptr < end)
+    {
+        auto eol = (const char*)memchr(ptr, '\n', end - ptr);
+        const char* lineEnd = eol ? eol : end;
+        line.assign(ptr, lineEnd - ptr);
+        ptr = eol ? eol + 1 : end;
         ++lineNumber;
+        normalizeLine(line);
         trimLeftRightSpace(line);
         trimLeftRightCRLF(line);
         if (line.empty())
@@ -161,31 +354,23 @@ int IniFile::open(const std::string& filename, bool allowTailComment, std::strin
                 auto sectionTailIndex = line.find_first_of(']');
                 if (std::string::npos == sectionTailIndex) /* 没有找到节结束标识, 说明格式不对 */
                 {
-                    fclose(f);
                     errorDesc = "section format error, line[" + std::to_string(lineNumber) + "]: " + line;
                     return 2;
                 }
                 auto sectionNameLen = sectionTailIndex - 1;
                 if (sectionNameLen <= 0) /* 节名称为空, 说明格式不对 */
                 {
-                    fclose(f);
                     errorDesc = "section is empty, line[" + std::to_string(lineNumber) + "]: " + line;
                     return 3;
                 }
                 std::string name(line, 1, sectionNameLen);
-                for (const auto& section : m_sections)
+                if (m_sectionIndexMap.end() != m_sectionIndexMap.find(name)) /* 节名称已经存在, 说明格式不对 */
                 {
-                    if (name == section.name) /* 节名称已经存在, 说明格式不对 */
-                    {
-                        fclose(f);
-                        errorDesc = "section [" + name + "] is duplicated, line[" + std::to_string(lineNumber) + "]: " + line;
-                        return 4;
-                    }
+                    errorDesc = "section [" + name + "] is duplicated, line[" + std::to_string(lineNumber) + "]: " + line;
+                    return 4;
                 }
-                IniSection section;
-                section.name = name;
-                section.comment = comment;
-                sectionIter = m_sections.insert(m_sections.end(), section);
+                sectionIndex = &appendSection(name);
+                m_sections.back().comment = std::move(comment);
                 comment.clear();
             }
             else /* 项内容 */
@@ -193,40 +378,34 @@ int IniFile::open(const std::string& filename, bool allowTailComment, std::strin
                 std::string key, value;
                 if (getKeyAndValue(line, key, value, '='))
                 {
-                    if (m_sections.end() == sectionIter)
+                    if (!sectionIndex)
                     {
-                        sectionIter = m_sections.insert(m_sections.end(), IniSection());
+                        sectionIndex = &appendSection(std::string());
                     }
-                    else
+                    auto& items = m_sections[sectionIndex->pos].items;
+                    auto result = sectionIndex->itemMap.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                                                                std::forward_as_tuple(items.size()));
+                    if (!result.second) /* 项已经存在, 说明格式不对 */
                     {
-                        for (const auto& item : sectionIter->items)
-                        {
-                            if (key == item.key) /* 项已经存在, 说明格式不对 */
-                            {
-                                fclose(f);
-                                errorDesc = "key [" + key + "] in section [" + sectionIter->name + "] is duplicated, line["
-                                            + std::to_string(lineNumber) + "]: " + line;
-                                return 6;
-                            }
-                        }
+                        errorDesc = "key [" + key + "] in section [" + m_sections[sectionIndex->pos].name + "] is duplicated, line["
+                                    + std::to_string(lineNumber) + "]: " + line;
+                        return 6;
                     }
                     IniItem item;
-                    item.key = key;
-                    item.value = value;
-                    item.comment = comment;
-                    sectionIter->items.emplace_back(item);
+                    item.key = std::move(key);
+                    item.value = std::move(value);
+                    item.comment = std::move(comment);
+                    items.emplace_back(std::move(item));
                     comment.clear();
                 }
                 else /* 项解析出错, 说明格式不对 */
                 {
-                    fclose(f);
                     errorDesc = "format error, line[" + std::to_string(lineNumber) + "]: " + line;
                     return 5;
                 }
             }
         }
     }
-    fclose(f);
     return 0;
 }
 
@@ -285,6 +464,10 @@ int IniFile::save(int sortType)
             data.append(item.key).append("=").append(item.value).append("\n"); /* 写项内容 */
         }
     }
+    if (1 == sortType || 2 == sortType) /* 排序后位置已改变 */
+    {
+        rebuildIndex();
+    }
     bool ret = false;
     if (data.size() == fwrite(data.c_str(), 1, data.size(), f))
     {
@@ -307,6 +490,7 @@ int IniFile::save(int sortType)
 void IniFile::clear()
 {
     m_sections.clear();
+    m_sectionIndexMap.clear();
     m_changed = true;
 }
 
@@ -315,6 +499,47 @@ std::vector<IniSection> IniFile::getSections() const
     return m_sections;
 }
 
+const IniSection* IniFile::findSection(const std::string& name) const
+{
+    auto sectionIndex = findSectionIndex(name);
+    if (sectionIndex)
+    {
+        return &m_sections[sectionIndex->pos];
+    }
+    return nullptr;
+}
+
+const IniItem* IniFile::findItem(const std::string& name, const std::string& key) const
+{
+    auto sectionIndex = findSectionIndex(name);
+    if (sectionIndex)
+    {
+        auto iter = sectionIndex->itemMap.find(key);
+        if (sectionIndex->itemMap.end() != iter)
+        {
+            return &m_sections[sectionIndex->pos].items[iter->second.pos];
+        }
+    }
+    return nullptr;
+}
+
+const IniTypedValue* IniFile::getTypedValue(const std::string& name, const std::string& key) const
+{
+    auto sectionIndex = findSectionIndex(name);
+    if (sectionIndex)
+    {
+        auto iter = sectionIndex->itemMap.find(key);
+        if (sectionIndex->itemMap.end() != iter)
+        {
+            const auto& itemIndex = iter->second;
+            const auto& value = m_sections[sectionIndex->pos].items[itemIndex.pos].value;
+            std::call_once(itemIndex.parsed, [&] { parseTypedValue(value, itemIndex.typed); });
+            return &itemIndex.typed;
+        }
+    }
+    return nullptr;
+}
+
 std::vector<std::string> IniFile::getCommentFlags() const
 {
     return m_commentFlags;
@@ -332,40 +557,38 @@ bool IniFile::setCommentFlags(const std::vector<std::string>& flags)
 
 bool IniFile::hasSection(const std::string& name) const
 {
-    for (const auto& section : m_sections)
-    {
-        if (name == section.name)
-        {
-            return true;
-        }
-    }
-    return false;
+    return (nullptr != findSectionIndex(name));
 }
 
 bool IniFile::removeSection(const std::string& name)
 {
-    for (auto iter = m_sections.begin(); m_sections.end() != iter; ++iter)
+    auto iter = m_sectionIndexMap.find(name);
+    if (m_sectionIndexMap.end() == iter)
+    {
+        return false;
+    }
+    const auto pos = iter->second.pos;
+    m_sections.erase(m_sections.begin() + pos);
+    m_sectionIndexMap.erase(iter);
+    for (auto& kv : m_sectionIndexMap) /* 后面的节前移 */
     {
-        if (name == iter->name)
+        if (kv.second.pos > pos)
         {
-            m_sections.erase(iter);
-            m_changed = true;
-            return true;
+            --kv.second.pos;
         }
     }
-    return false;
+    m_changed = true;
+    return true;
 }
 
 bool IniFile::getSectionComment(const std::string& name, std::string& comment) const
 {
     comment.clear();
-    for (const auto& section : m_sections)
+    auto section = findSection(name);
+    if (section)
     {
-        if (name == section.name)
-        {
-            comment = section.comment;
-            return true;
-        }
+        comment = section->comment;
+        return true;
     }
     return false;
 }
@@ -376,15 +599,9 @@ int IniFile::setSectionComment(const std::string& name, const std::string& comme
     {
         return 2;
     }
-    auto iter = m_sections.begin();
-    for (; m_sections.end() != iter; ++iter)
-    {
-        if (name == iter->name)
-        {
-            break;
-        }
-    }
-    if (m_sections.end() == iter)
+    auto iter = m_sectionIndexMap.find(name);
+    IniSection* section = nullptr;
+    if (m_sectionIndexMap.end() == iter)
     {
         if (!isAllowAutoCreate())
         {
@@ -394,76 +611,62 @@ int IniFile::setSectionComment(const std::string& name, const std::string& comme
         {
             return 1;
         }
-        IniSection section;
-        section.name = name;
-        iter = m_sections.insert(m_sections.end(), section);
+        section = &m_sections[appendSection(name).pos];
     }
-    else if (comment == iter->comment)
+    else
     {
-        return 1;
+        section = &m_sections[iter->second.pos];
+        if (comment == section->comment)
+        {
+            return 1;
+        }
     }
-    iter->comment = comment;
+    section->comment = comment;
     m_changed = true;
     return 0;
 }
 
 bool IniFile::hasItem(const std::string& name, const std::string& key) const
 {
-    for (const auto& section : m_sections)
-    {
-        if (name == section.name)
-        {
-            for (const auto& item : section.items)
-            {
-                if (key == item.key)
-                {
-                    return true;
-                }
-            }
-            break;
-        }
-    }
-    return false;
+    return (nullptr != findItem(name, key));
 }
 
 bool IniFile::removeItem(const std::string& name, const std::string& key)
 {
-    for (auto& section : m_sections)
+    auto sectionIter = m_sectionIndexMap.find(name);
+    if (m_sectionIndexMap.end() == sectionIter)
+    {
+        return false;
+    }
+    auto& itemMap = sectionIter->second.itemMap;
+    auto itemIter = itemMap.find(key);
+    if (itemMap.end() == itemIter)
     {
-        if (name == section.name)
+        return false;
+    }
+    const auto pos = itemIter->second.pos;
+    auto& items = m_sections[sectionIter->second.pos].items;
+    items.erase(items.begin() + pos);
+    itemMap.erase(itemIter);
+    for (auto& kv : itemMap) /* 后面的项前移 */
+    {
+        if (kv.second.pos > pos)
         {
-            for (auto iter = section.items.begin(); section.items.end() != iter; ++iter)
-            {
-                if (key == iter->key)
-                {
-                    section.items.erase(iter);
-                    m_changed = true;
-                    return true;
-                }
-            }
-            break;
+            --kv.second.pos;
         }
     }
-    return false;
+    m_changed = true;
+    return true;
 }
 
 bool IniFile::getValue(const std::string& name, const std::string& key, std::string& value) const
 {
     value.clear();
-    for (const auto& section : m_sections)
+    auto item = findItem(name, key);
+    if (item)
     {
-        if (name == section.name)
-        {
-            for (const auto& item : section.items)
-            {
-                if (key == item.key)
-                {
-                    value = item.value;
-                    return true;
-                }
-            }
-            break;
-        }
+        value = item->value;
+        return true;
     }
     return false;
 }
@@ -474,37 +677,33 @@ int IniFile::setValue(const std::string& name, const std::string& key, const std
     {
         return 2;
     }
-    auto sectionIter = m_sections.begin();
-    for (; m_sections.end() != sectionIter; ++sectionIter)
-    {
-        if (name == sectionIter->name)
-        {
-            break;
-        }
-    }
-    if (m_sections.end() == sectionIter)
+    auto sectionIter = m_sectionIndexMap.find(name);
+    SectionIndex* sectionIndex = nullptr;
+    if (m_sectionIndexMap.end() == sectionIter)
     {
         if (!isAllowAutoCreate())
         {
             return 3;
         }
-        IniSection section;
-        section.name = name;
-        sectionIter = m_sections.insert(m_sections.end(), section);
+        sectionIndex = &appendSection(name);
+    }
+    else
+    {
+        sectionIndex = &sectionIter->second;
     }
-    auto itemIter = sectionIter->items.begin();
-    for (; sectionIter->items.end() != itemIter; ++itemIter)
+    auto& items = m_sections[sectionIndex->pos].items;
+    auto itemIter = sectionIndex->itemMap.find(key);
+    if (sectionIndex->itemMap.end() != itemIter)
     {
-        if (key == itemIter->key)
+        auto& item = items[itemIter->second.pos];
+        if (value == item.value)
         {
-            if (value == itemIter->value)
-            {
-                return 1;
-            }
-            itemIter->value = value;
-            m_changed = true;
-            return 0;
+            return 1;
         }
+        item.value = value;
+        resetItemIndex(*sectionIndex, key, itemIter->second.pos);
+        m_changed = true;
+        return 0;
     }
     if (!isAllowAutoCreate())
     {
@@ -513,7 +712,8 @@ int IniFile::setValue(const std::string& name, const std::string& key, const std
     IniItem item;
     item.key = key;
     item.value = value;
-    sectionIter->items.emplace_back(item);
+    resetItemIndex(*sectionIndex, key, items.size());
+    items.emplace_back(std::move(item));
     m_changed = true;
     return 0;
 }
@@ -521,20 +721,11 @@ int IniFile::setValue(const std::string& name, const std::string& key, const std
 bool IniFile::getComment(const std::string& name, const std::string& key, std::string& comment) const
 {
     comment.clear();
-    for (const auto& section : m_sections)
+    auto item = findItem(name, key);
+    if (item)
     {
-        if (name == section.name)
-        {
-            for (const auto& item : section.items)
-            {
-                if (key == item.key)
-                {
-                    comment = item.comment;
-                    return true;
-                }
-            }
-            break;
-        }
+        comment = item->comment;
+        return true;
     }
     return false;
 }
@@ -545,15 +736,9 @@ int IniFile::setComment(const std::string& name, const std::string& key, const s
     {
         return 2;
     }
-    auto sectionIter = m_sections.begin();
-    for (; m_sections.end() != sectionIter; ++sectionIter)
-    {
-        if (name == sectionIter->name)
-        {
-            break;
-        }
-    }
-    if (m_sections.end() == sectionIter)
+    auto sectionIter = m_sectionIndexMap.find(name);
+    SectionIndex* sectionIndex = nullptr;
+    if (m_sectionIndexMap.end() == sectionIter)
     {
         if (!isAllowAutoCreate())
         {
@@ -563,23 +748,24 @@ int IniFile::setComment(const std::string& name, const std::string& key, const s
         {
             return 1;
         }
-        IniSection section;
-        section.name = name;
-        sectionIter = m_sections.insert(m_sections.end(), section);
+        sectionIndex = &appendSection(name);
+    }
+    else
+    {
+        sectionIndex = &sectionIter->second;
     }
-    auto itemIter = sectionIter->items.begin();
-    for (; sectionIter->items.end() != itemIter; ++itemIter)
+    auto& items = m_sections[sectionIndex->pos].items;
+    auto itemIter = sectionIndex->itemMap.find(key);
+    if (sectionIndex->itemMap.end() != itemIter)
     {
-        if (key == itemIter->key)
+        auto& item = items[itemIter->second.pos];
+        if (comment == item.comment)
         {
-            if (comment == itemIter->comment)
-            {
-                return 1;
-            }
-            itemIter->comment = comment;
-            m_changed = true;
-            return 0;
+            return 1;
         }
+        item.comment = comment;
+        m_changed = true;
+        return 0;
     }
     if (!isAllowAutoCreate())
     {
@@ -588,7 +774,8 @@ int IniFile::setComment(const std::string& name, const std::string& key, const s
     IniItem item;
     item.key = key;
     item.comment = comment;
-    sectionIter->items.emplace_back(item);
+    resetItemIndex(*sectionIndex, key, items.size());
+    items.emplace_back(std::move(item));
     m_changed = true;
     return 0;
 }
@@ -596,24 +783,14 @@ int IniFile::setComment(const std::string& name, const std::string& key, const s
 bool IniFile::getExtra(const std::string& name, const std::string& key, const std::string& extraName, std::string& extraValue) const
 {
     extraValue.clear();
-    for (const auto& section : m_sections)
+    auto item = findItem(name, key);
+    if (item)
     {
-        if (name == section.name)
+        auto iter = item->extraMap.find(extraName);
+        if (item->extraMap.end() != iter)
         {
-            for (const auto& item : section.items)
-            {
-                if (key == item.key)
-                {
-                    auto iter = item.extraMap.find(extraName);
-                    if (item.extraMap.end() != iter)
-                    {
-                        extraValue = iter->second;
-                        return true;
-                    }
-                    break;
-                }
-            }
-            break;
+            extraValue = iter->second;
+            return true;
         }
     }
     return false;
@@ -625,26 +802,11 @@ bool IniFile::setExtra(const std::string& name, const std::string& key, const st
     {
         return false;
     }
-    auto sectionIter = m_sections.begin();
-    for (; m_sections.end() != sectionIter; ++sectionIter)
+    auto item = const_cast<IniItem*>(findItem(name, key));
+    if (item)
     {
-        if (name == sectionIter->name)
-        {
-            break;
-        }
-    }
-    if (m_sections.end() == sectionIter)
-    {
-        return false;
-    }
-    auto itemIter = sectionIter->items.begin();
-    for (; sectionIter->items.end() != itemIter; ++itemIter)
-    {
-        if (key == itemIter->key)
-        {
-            itemIter->extraMap[extraName] = extraValue;
-            return true;
-        }
+        item->extraMap[extraName] = extraValue;
+        return true;
     }
     return false;
 }
@@ -664,4 +826,45 @@ bool IniFile::isComment(const std::string& str) const
     }
     return false;
 }
+
+void IniFile::rebuildIndex()
+{
+    m_sectionIndexMap.clear();
+    for (size_t i = 0; i < m_sections.size(); ++i)
+    {
+        auto& sectionIndex = m_sectionIndexMap[m_sections[i].name];
+        sectionIndex.pos = i;
+        const auto& items = m_sections[i].items;
+        for (size_t j = 0; j < items.size(); ++j)
+        {
+            sectionIndex.itemMap.emplace(std::piecewise_construct, std::forward_as_tuple(items[j].key), std::forward_as_tuple(j));
+        }
+    }
+}
+
+const IniFile::SectionIndex* IniFile::findSectionIndex(const std::string& name) const
+{
+    auto iter = m_sectionIndexMap.find(name);
+    if (m_sectionIndexMap.end() != iter)
+    {
+        return &iter->second;
+    }
+    return nullptr;
+}
+
+IniFile::SectionIndex& IniFile::appendSection(const std::string& name)
+{
+    IniSection section;
+    section.name = name;
+    m_sections.emplace_back(std::move(section));
+    auto& sectionIndex = m_sectionIndexMap[name];
+    sectionIndex.pos = m_sections.size() - 1;
+    return sectionIndex;
+}
+
+void IniFile::resetItemIndex(SectionIndex& sectionIndex, const std::string& key, size_t pos)
+{
+    sectionIndex.itemMap.erase(key); /* 已解析的标识不能重置, 需要重新创建 */
+    sectionIndex.itemMap.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(pos));
+}
 } // namespace ini
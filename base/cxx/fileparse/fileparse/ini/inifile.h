@@ -1,6 +1,9 @@
 #pragma once
+#include <chrono>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ini
@@ -26,16 +29,36 @@ struct IniSection
     std::string comment; /* 注释 */
 };
 
+/**
+ * @brief INI值的类型化解析结果(首次按类型获取时解析一次并缓存, 值被修改后重新解析)
+ */
+struct IniTypedValue
+{
+    bool boolValue = false; /* 布尔值(不区分大小写等于"true") */
+    bool negative = false; /* 是否以'-'开头 */
+    long long llValue = 0; /* 有符号整数值(溢出时取边界值) */
+    unsigned long long ullValue = 0; /* 无符号整数值 */
+    double doubleValue = 0.0; /* 浮点值 */
+    bool durationValid = false; /* 时长是否有效 */
+    std::chrono::milliseconds durationValue{0}; /* 时长, 格式: 数值+单位(us,ms,s,m,h,d), 无单位时为毫秒 */
+};
+
 /**
  * @brief INI文件
+ *        说明: 1.节/项按名称建立哈希索引, 查找不需要遍历
+ *              2.打开文件时使用内存映射, 逐行解析不需要逐字节读取
  */
 class IniFile
 {
 public:
     IniFile();
 
+    IniFile(const IniFile& src);
+
     virtual ~IniFile();
 
+    IniFile& operator=(const IniFile& src);
+
     /**
      * @brief 打开文件
      * @param filename 文件名, 例如: "test.ini", "../test.ini", "temp\\test.ini"
@@ -63,6 +86,29 @@ public:
      */
     std::vector<IniSection> getSections() const;
 
+    /**
+     * @brief 查找节(不拷贝)
+     * @param name 节名称
+     * @return 节, 为空表示不存在(修改节/项之后失效)
+     */
+    const IniSection* findSection(const std::string& name) const;
+
+    /**
+     * @brief 查找项(不拷贝)
+     * @param name 节名称
+     * @param key 键
+     * @return 项, 为空表示不存在(修改节/项之后失效)
+     */
+    const IniItem* findItem(const std::string& name, const std::string& key) const;
+
+    /**
+     * @brief 获取类型化的值(首次调用时解析并缓存, 多线程同时读取是安全的)
+     * @param name 节名称
+     * @param key 键
+     * @return 值, 为空表示不存在(修改节/项之后失效)
+     */
+    const IniTypedValue* getTypedValue(const std::string& name, const std::string& key) const;
+
     /**
      * @brief 获取注释标识符列表
      * @return 标识符列表
@@ -185,6 +231,27 @@ public:
     virtual bool isAllowAutoCreate() const = 0;
 
 private:
+    /**
+     * @brief 项索引
+     */
+    struct ItemIndex
+    {
+        explicit ItemIndex(size_t p) : pos(p) {}
+
+        size_t pos; /* 在节的项列表中的位置 */
+        mutable std::once_flag parsed; /* 类型化的值是否已解析 */
+        mutable IniTypedValue typed; /* 类型化的值 */
+    };
+
+    /**
+     * @brief 节索引
+     */
+    struct SectionIndex
+    {
+        size_t pos = 0; /* 在节列表中的位置 */
+        std::unordered_map<std::string, ItemIndex> itemMap; /* 项索引表 */
+    };
+
     /**
      * @brief 判断是否为注释
      * @param str 字符串内容
@@ -192,9 +259,37 @@ private:
      */
     bool isComment(const std::string& str) const;
 
+    /**
+     * @brief 重建索引(节/项列表被整体修改后调用)
+     */
+    void rebuildIndex();
+
+    /**
+     * @brief 查找节索引
+     * @param name 节名称
+     * @return 节索引, 为空表示不存在
+     */
+    const SectionIndex* findSectionIndex(const std::string& name) const;
+
+    /**
+     * @brief 追加节(调用前需确认节不存在)
+     * @param name 节名称
+     * @return 节索引
+     */
+    SectionIndex& appendSection(const std::string& name);
+
+    /**
+     * @brief 设置项索引(值被修改时调用, 清除已解析的类型化的值)
+     * @param sectionIndex 节索引
+     * @param key 键
+     * @param pos 在节的项列表中的位置
+     */
+    static void resetItemIndex(SectionIndex& sectionIndex, const std::string& key, size_t pos);
+
 private:
     std::string m_filename; /* 文件名称 */
     std::vector<IniSection> m_sections; /* 节列表 */
+    std::unordered_map<std::string, SectionIndex> m_sectionIndexMap; /* 节索引表 */
     std::vector<std::string> m_commentFlags; /* 注释标识列表 */
     bool m_changed = false; /* 是否被改变 */
 };
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "ipc/shm_ring.h"
+
+/**
+ * @brief 共享统计(匿名共享映射, 父子进程可见)
+ */
+struct SharedStat
+{
+    std::atomic<uint64_t> received; /* 已接收记录数 */
+    std::atomic<uint64_t> errors; /* 序号/内容校验错误数 */
+    std::atomic<uint64_t> checksum; /* 接收数据累加和 */
+};
+
+static double elapsedSec(const std::chrono::steady_clock::time_point& tp1, const std::chrono::steady_clock::time_point& tp2)
+{
+    return std::chrono::duration<double>(tp2 - tp1).count();
+}
+
+/**
+ * @brief 打开环形队列, 失败时退出
+ */
+static void openRing(ipc::ShmRing& ring, const std::string& name, size_t capacity, ipc::ShmRing::Mode mode)
+{
+    std::string errorDesc;
+    const int ret = ring.open(name, capacity, mode, errorDesc);
+    if (0 != ret)
+    {
+        printf("open [%s] failed: %d, %s\n", name.c_str(), ret, errorDesc.c_str());
+        exit(1);
+    }
+}
+
+/**
+ * @brief 生产者: 记录内容为[生产者序号(4字节)][记录序号(8字节)][填充]
+ */
+static void runProducer(const std::string& name, ipc::ShmRing::Mode mode, uint32_t producerId, uint64_t count, size_t msgSize)
+{
+    ipc::ShmRing ring;
+    openRing(ring, name, 0, mode);
+    for (uint64_t seq = 0; seq < count; ++seq)
+    {
+        ipc::ShmRingBuffer buffer;
+        if (!ring.reserve(msgSize, buffer, std::chrono::milliseconds(-1)))
+        {
+            printf("reserve failed\n");
+            exit(1);
+        }
+        memcpy(buffer.data, &producerId, sizeof(producerId));
+        memcpy(buffer.data + sizeof(producerId), &seq, sizeof(seq));
+        memset(buffer.data + 12, (int)(seq & 0xFF), msgSize - 12);
+        ring.commit(buffer);
+    }
+}
+
+/**
+ * @brief 消费者: 校验每个生产者的序号单调递增(同一生产者的记录按提交顺序被获取)
+ */
+static void runConsumer(const std::string& name, ipc::ShmRing::Mode mode, uint32_t producerCount, uint64_t total, SharedStat* stat)
+{
+    ipc::ShmRing ring;
+    openRing(ring, name, 0, mode);
+    std::vector<int64_t> lastSeqList(producerCount, -1);
+    uint64_t checksum = 0;
+    while (stat->received.load(std::memory_order_relaxed) < total)
+    {
+        ipc::ShmRingBuffer buffer;
+        if (!ring.acquire(buffer, std::chrono::milliseconds(100)))
+        {
+            continue;
+        }
+        uint32_t producerId = 0;
+        uint64_t seq = 0;
+        memcpy(&producerId, buffer.data, sizeof(producerId));
+        memcpy(&seq, buffer.data + sizeof(producerId), sizeof(seq));
+        if (producerId >= producerCount || (int64_t)seq <= lastSeqList[producerId] || buffer.data[buffer.size - 1] != (uint8_t)(seq & 0xFF))
+        {
+            stat->errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            lastSeqList[producerId] = (int64_t)seq;
+        }
+        checksum += seq;
+        ring.release(buffer);
+        stat->received.fetch_add(1, std::memory_order_relaxed);
+    }
+    stat->checksum.fetch_add(checksum, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 吞吐测试: 多进程生产/消费
+ */
+static void benchThroughput(ipc::ShmRing::Mode mode, uint32_t producerCount, uint32_t consumerCount, uint64_t perProducer, size_t msgSize)
+{
+    const std::string name = "example_shm_ring_benchmark";
+    ipc::ShmRing::remove(name);
+    ipc::ShmRing ring;
+    openRing(ring, name, 1024 * 1024, mode);
+    auto stat = (SharedStat*)mmap(nullptr, sizeof(SharedStat), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    new (stat) SharedStat();
+    const uint64_t total = perProducer * producerCount;
+    std::vector<pid_t> pidList;
+    const auto tp1 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < consumerCount; ++i)
+    {
+        pid_t pid = fork();
+        if (0 == pid)
+        {
+            runConsumer(name, mode, producerCount, total, stat);
+            _exit(0);
+        }
+        pidList.emplace_back(pid);
+    }
+    for (uint32_t i = 0; i < producerCount; ++i)
+    {
+        pid_t pid = fork();
+        if (0 == pid)
+        {
+            runProducer(name, mode, i, perProducer, msgSize);
+            _exit(0);
+        }
+        pidList.emplace_back(pid);
+    }
+    for (auto pid : pidList)
+    {
+        waitpid(pid, nullptr, 0);
+    }
+    const auto tp2 = std::chrono::steady_clock::now();
+    const uint64_t expectChecksum = producerCount * (perProducer * (perProducer - 1) / 2);
+    const double sec = elapsedSec(tp1, tp2);
+    printf("%-6s %2ux%-2u %8zu %12.2f %12.1f %8llu %s\n", ipc::ShmRing::Mode::SPSC == mode ? "spsc" : "mpmc", producerCount, consumerCount,
+           msgSize, total / sec / 1000000, total * msgSize / sec / 1024 / 1024, (unsigned long long)stat->errors.load(),
+           (stat->received.load() == total && stat->checksum.load() == expectChecksum) ? "ok" : "MISMATCH");
+    munmap(stat, sizeof(SharedStat));
+    ring.close();
+    ipc::ShmRing::remove(name);
+}
+
+/**
+ * @brief 往返延迟测试: 两个SPSC队列, 子进程收到后原样回写
+ */
+static void benchPingPong(uint64_t count, size_t msgSize)
+{
+    const std::string pingName = "example_shm_ring_ping";
+    const std::string pongName = "example_shm_ring_pong";
+    ipc::ShmRing::remove(pingName);
+    ipc::ShmRing::remove(pongName);
+    ipc::ShmRing ping, pong;
+    openRing(ping, pingName, 64 * 1024, ipc::ShmRing::Mode::SPSC);
+    openRing(pong, pongName, 64 * 1024, ipc::ShmRing::Mode::SPSC);
+    pid_t pid = fork();
+    if (0 == pid)
+    {
+        ipc::ShmRing in, out;
+        openRing(in, pingName, 0, ipc::ShmRing::Mode::SPSC);
+        openRing(out, pongName, 0, ipc::ShmRing::Mode::SPSC);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            ipc::ShmRingBuffer buffer;
+            in.acquire(buffer, std::chrono::milliseconds(-1));
+            out.write(buffer.data, buffer.size, std::chrono::milliseconds(-1));
+            in.release(buffer);
+        }
+        _exit(0);
+    }
+    std::vector<uint8_t> msg(msgSize, 0x5A), reply;
+    std::vector<int64_t> rttList;
+    rttList.reserve(count);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const auto tp1 = std::chrono::steady_clock::now();
+        ping.write(msg.data(), msg.size(), std::chrono::milliseconds(-1));
+        pong.read(reply, std::chrono::milliseconds(-1));
+        const auto tp2 = std::chrono::steady_clock::now();
+        rttList.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(tp2 - tp1).count());
+    }
+    waitpid(pid, nullptr, 0);
+    std::sort(rttList.begin(), rttList.end());
+    printf("pingpong: %llu round trips, %zu bytes, rtt(ns) p50: %lld, p99: %lld, max: %lld\n", (unsigned long long)count, msgSize,
+           (long long)rttList[count / 2], (long long)rttList[count * 99 / 100], (long long)rttList.back());
+    ping.close();
+    pong.close();
+    ipc::ShmRing::remove(pingName);
+    ipc::ShmRing::remove(pongName);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t count = 1000000;
+    size_t msgSize = 64;
+    if (argc > 1)
+    {
+        count = std::max<uint64_t>(1, std::atoll(argv[1]));
+    }
+    if (argc > 2)
+    {
+        msgSize = std::max<size_t>(16, std::atoll(argv[2]));
+    }
+    printf("records per producer: %llu, record size: %zu, cpu cores: %ld\n", (unsigned long long)count, msgSize,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-6s %5s %8s %12s %12s %8s %s\n", "mode", "p x c", "size", "Mmsg/s", "MB/s", "errors", "check");
+    benchThroughput(ipc::ShmRing::Mode::SPSC, 1, 1, count, msgSize);
+    benchThroughput(ipc::ShmRing::Mode::MPMC, 2, 2, count / 2, msgSize);
+    benchPingPong(std::max<uint64_t>(1, count / 10), msgSize);
+    return 0;
+}
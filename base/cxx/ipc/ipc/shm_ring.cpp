@@ -0,0 +1,727 @@
+#include "shm_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits.h>
+#include <new>
+#include <string.h>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace ipc
+{
+static const uint32_t RING_MAGIC = 0x474E4952; /* "RING" */
+static const uint32_t RING_VERSION = 1;
+static const size_t HEADER_SIZE = 4096; /* 控制区长度(一页) */
+static const size_t RECORD_ALIGN = 16; /* 记录对齐 */
+static const std::chrono::milliseconds WAIT_SLICE(100); /* 单次等待时长, 超过后执行恢复检查 */
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared memory atomics must be lock free");
+
+/**
+ * @brief 记录状态
+ */
+enum RecordState : uint32_t
+{
+    STATE_PENDING = 0, /* 已预留未提交 */
+    STATE_READY = 1, /* 已提交 */
+    STATE_PADDING = 2, /* 填充(跳过) */
+    STATE_CLAIMED = 3, /* 已被消费者获取 */
+    STATE_DONE = 4 /* 已释放 */
+};
+
+/**
+ * @brief 控制区(位于共享内存开头, 各字段独占缓存行避免伪共享)
+ */
+struct ShmRing::Header
+{
+    std::atomic<uint32_t> magic; /* 魔数(初始化完成后设置) */
+    uint32_t version; /* 版本 */
+    uint32_t mode; /* 模式 */
+    uint32_t reserved; /* 保留 */
+    uint64_t capacity; /* 数据区容量 */
+    alignas(64) std::atomic<uint64_t> writePos; /* 生产位置 */
+    std::atomic<int32_t> writeLock; /* 生产锁(持有者进程ID, MPMC模式) */
+    alignas(64) std::atomic<uint64_t> readPos; /* 消费位置(下一条待获取的记录) */
+    alignas(64) std::atomic<uint64_t> freePos; /* 释放位置(之前的空间可被重用) */
+    alignas(64) std::atomic<uint32_t> dataSeq; /* 数据序号(futex) */
+    std::atomic<uint32_t> dataWaiters; /* 等待数据的数量 */
+    alignas(64) std::atomic<uint32_t> spaceSeq; /* 空间序号(futex) */
+    std::atomic<uint32_t> spaceWaiters; /* 等待空间的数量 */
+};
+
+/**
+ * @brief 记录头(数据紧随其后)
+ */
+struct ShmRing::Record
+{
+    std::atomic<uint32_t> state; /* 状态 */
+    std::atomic<uint32_t> len; /* 记录总长度(包含记录头, 已对齐) */
+    std::atomic<uint32_t> size; /* 数据长度 */
+    std::atomic<int32_t> pid; /* 生产者(提交前)/消费者(获取后)进程ID */
+};
+
+/**
+ * @brief 获取当前进程ID
+ */
+static int32_t currentPid()
+{
+#ifdef _WIN32
+    return (int32_t)GetCurrentProcessId();
+#else
+    return (int32_t)getpid();
+#endif
+}
+
+/**
+ * @brief 进程是否存活
+ */
+static bool isProcessAlive(int32_t pid)
+{
+    if (pid <= 0)
+    {
+        return true; /* 未知时当作存活 */
+    }
+#ifdef _WIN32
+    auto h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, (DWORD)pid);
+    if (!h)
+    {
+        return (ERROR_INVALID_PARAMETER != GetLastError());
+    }
+    DWORD code = 0;
+    bool alive = (GetExitCodeProcess(h, &code) && STILL_ACTIVE == code);
+    CloseHandle(h);
+    return alive;
+#else
+    return (0 == kill(pid, 0) || ESRCH != errno);
+#endif
+}
+
+/**
+ * @brief 等待序号变化(Linux下使用共享的futex, 其他平台短暂休眠)
+ */
+static void waitOnAddress(std::atomic<uint32_t>& seq, uint32_t expected, const std::chrono::milliseconds& timeout)
+{
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = (time_t)(timeout.count() / 1000);
+    ts.tv_nsec = (long)(timeout.count() % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+    if (seq.load(std::memory_order_acquire) == expected)
+    {
+        std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds(1)));
+    }
+#endif
+}
+
+/**
+ * @brief 唤醒所有等待者(没有等待者时不产生系统调用)
+ */
+static void wakeAddress(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst); /* 与等待者的登记/检查配对, 避免丢失唤醒 */
+    if (waiters.load(std::memory_order_relaxed) > 0)
+    {
+        seq.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&seq), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+}
+
+/**
+ * @brief 阻塞等待直到条件满足或超时, 每等待WAIT_SLICE回调一次(用于恢复检查)
+ */
+template<typename ReadyFunc, typename SliceFunc>
+static bool waitUntil(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters, const ReadyFunc& ready, const SliceFunc& onSlice,
+                      const std::chrono::milliseconds& timeout)
+{
+    const bool forever = (timeout.count() < 0);
+    const auto deadline = std::chrono::steady_clock::now() + (forever ? std::chrono::milliseconds(0) : timeout);
+    auto lastCheck = std::chrono::steady_clock::now();
+    while (true)
+    {
+        if (ready())
+        {
+            return true;
+        }
+        const auto expected = seq.load(std::memory_order_acquire);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst); /* 先登记再检查 */
+        if (ready())
+        {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        auto slice = WAIT_SLICE;
+        if (!forever)
+        {
+            const auto remain = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remain.count() <= 0)
+            {
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+            slice = std::min(slice, remain);
+        }
+        waitOnAddress(seq, expected, slice);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastCheck >= WAIT_SLICE)
+        {
+            lastCheck = now;
+            onSlice(); /* 长时间没有进展, 可能有进程崩溃 */
+        }
+    }
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t align)
+{
+    return (value + align - 1) & ~(align - 1);
+}
+
+ShmRing::~ShmRing()
+{
+    close();
+}
+
+int ShmRing::open(const std::string& name, size_t capacity, Mode mode, std::string& errorDesc)
+{
+    errorDesc.clear();
+    close();
+    if (name.empty() || std::string::npos != name.find('/') || std::string::npos != name.find('\\'))
+    {
+        errorDesc = "invalid name [" + name + "]";
+        return 1;
+    }
+    if (capacity > 0)
+    {
+        capacity = std::max<size_t>(capacity, 4096);
+        size_t pow2 = 4096;
+        while (pow2 < capacity)
+        {
+            pow2 <<= 1;
+        }
+        capacity = pow2;
+        if (capacity > UINT32_MAX) /* 记录长度用32位表示 */
+        {
+            errorDesc = "capacity too large";
+            return 1;
+        }
+    }
+    auto ret = mapMemory(name, capacity, mode, errorDesc);
+    if (0 != ret)
+    {
+        close();
+        return ret;
+    }
+    m_name = name;
+    m_data = m_addr + HEADER_SIZE;
+    m_mask = m_header->capacity - 1;
+    m_mpmc = (Mode::MPMC == (Mode)m_header->mode);
+    m_pid = currentPid();
+    recover(); /* 接管崩溃进程遗留的状态 */
+    return 0;
+}
+
+int ShmRing::mapMemory(const std::string& name, size_t capacity, Mode mode, std::string& errorDesc)
+{
+    static_assert(sizeof(Header) <= HEADER_SIZE, "header too large");
+    static_assert(sizeof(Record) == RECORD_ALIGN, "record header size mismatch");
+    bool created = false;
+#ifdef _WIN32
+    HANDLE h = nullptr;
+    if (capacity > 0)
+    {
+        const uint64_t total = HEADER_SIZE + capacity;
+        h = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)(total >> 32), (DWORD)(total & 0xFFFFFFFF),
+                               name.c_str());
+        created = (h && ERROR_ALREADY_EXISTS != GetLastError());
+    }
+    else
+    {
+        h = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+    }
+    if (!h)
+    {
+        errorDesc = "can't open shared memory [" + name + "], error: " + std::to_string(GetLastError());
+        return 2;
+    }
+    m_handle = h;
+    m_addr = (uint8_t*)MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!m_addr)
+    {
+        errorDesc = "can't map shared memory [" + name + "], error: " + std::to_string(GetLastError());
+        return 3;
+    }
+    MEMORY_BASIC_INFORMATION info;
+    m_mapSize = VirtualQuery(m_addr, &info, sizeof(info)) ? info.RegionSize : 0;
+    m_header = (Header*)m_addr;
+#else
+    const std::string shmName = "/" + name;
+    int fd = -1;
+    if (capacity > 0)
+    {
+        fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+        created = (fd >= 0);
+    }
+    if (fd < 0)
+    {
+        fd = shm_open(shmName.c_str(), O_RDWR, 0666);
+    }
+    if (fd < 0)
+    {
+        errorDesc = "can't open shared memory [" + name + "], errno: " + std::to_string(errno);
+        return 2;
+    }
+    size_t total = HEADER_SIZE + capacity;
+    if (created)
+    {
+        if (0 != ftruncate(fd, (off_t)total))
+        {
+            errorDesc = "can't resize shared memory [" + name + "], errno: " + std::to_string(errno);
+            ::close(fd);
+            shm_unlink(shmName.c_str());
+            return 2;
+        }
+    }
+    else /* 等待创建者设置长度 */
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        struct stat st;
+        while (0 == fstat(fd, &st) && (size_t)st.st_size <= HEADER_SIZE && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (0 != fstat(fd, &st) || (size_t)st.st_size <= HEADER_SIZE)
+        {
+            errorDesc = "wait shared memory [" + name + "] initialization timeout";
+            ::close(fd);
+            return 5;
+        }
+        total = (size_t)st.st_size;
+    }
+    void* addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        errorDesc = "can't map shared memory [" + name + "], errno: " + std::to_string(errno);
+        return 3;
+    }
+    m_addr = (uint8_t*)addr;
+    m_mapSize = total;
+    m_header = (Header*)m_addr;
+#endif
+    if (created) /* 初始化控制区, 最后设置魔数 */
+    {
+        m_header = new (m_addr) Header();
+        m_header->version = RING_VERSION;
+        m_header->mode = (uint32_t)mode;
+        m_header->capacity = capacity;
+        m_header->magic.store(RING_MAGIC, std::memory_order_release);
+    }
+    else
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (RING_MAGIC != m_header->magic.load(std::memory_order_acquire))
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                errorDesc = "wait shared memory [" + name + "] initialization timeout";
+                return 5;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (RING_VERSION != m_header->version || HEADER_SIZE + m_header->capacity > m_mapSize
+            || (capacity > 0 && (capacity != m_header->capacity || (uint32_t)mode != m_header->mode)))
+        {
+            errorDesc = "shared memory [" + name + "] exists with capacity " + std::to_string(m_header->capacity) + ", mode "
+                        + std::to_string(m_header->mode);
+            return 4;
+        }
+    }
+    return 0;
+}
+
+void ShmRing::close()
+{
+    if (m_addr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_addr);
+#else
+        munmap(m_addr, m_mapSize);
+#endif
+    }
+#ifdef _WIN32
+    if (m_handle)
+    {
+        CloseHandle((HANDLE)m_handle);
+    }
+#endif
+    m_name.clear();
+    m_handle = nullptr;
+    m_addr = nullptr;
+    m_mapSize = 0;
+    m_header = nullptr;
+    m_data = nullptr;
+    m_mask = 0;
+}
+
+bool ShmRing::remove(const std::string& name)
+{
+#ifdef _WIN32
+    return true; /* 最后一个句柄关闭时自动删除 */
+#else
+    return (0 == shm_unlink(("/" + name).c_str()));
+#endif
+}
+
+bool ShmRing::isOpen() const
+{
+    return (nullptr != m_header);
+}
+
+size_t ShmRing::getCapacity() const
+{
+    return m_header ? (size_t)m_header->capacity : 0;
+}
+
+size_t ShmRing::getMaxRecordSize() const
+{
+    return m_header ? (size_t)(m_header->capacity / 2 - sizeof(Record)) : 0;
+}
+
+size_t ShmRing::getUsedSize() const
+{
+    if (!m_header)
+    {
+        return 0;
+    }
+    return (size_t)(m_header->writePos.load(std::memory_order_acquire) - m_header->freePos.load(std::memory_order_acquire));
+}
+
+bool ShmRing::tryReserve(size_t size, ShmRingBuffer& buffer)
+{
+    if (!m_header || size > getMaxRecordSize())
+    {
+        return false;
+    }
+    const uint64_t len = alignUp(sizeof(Record) + size, RECORD_ALIGN);
+    if (m_mpmc)
+    {
+        lockWriter();
+    }
+    /* 记录不跨越数据区末尾, 剩余空间不足时先写入填充记录 */
+    uint64_t pos = m_header->writePos.load(std::memory_order_relaxed);
+    const uint64_t tail = m_header->capacity - (pos & m_mask);
+    const uint64_t need = (len > tail) ? (tail + len) : len;
+    if (need > m_header->capacity - (pos - m_header->freePos.load(std::memory_order_acquire)))
+    {
+        if (m_mpmc)
+        {
+            unlockWriter();
+        }
+        return false;
+    }
+    if (len > tail)
+    {
+        auto padding = recordAt(pos);
+        padding->len.store((uint32_t)tail, std::memory_order_relaxed);
+        padding->size.store(0, std::memory_order_relaxed);
+        padding->pid.store(m_pid, std::memory_order_relaxed);
+        padding->state.store(STATE_PADDING, std::memory_order_release);
+        pos += tail;
+    }
+    auto record = recordAt(pos);
+    record->len.store((uint32_t)len, std::memory_order_relaxed);
+    record->size.store((uint32_t)size, std::memory_order_relaxed);
+    record->pid.store(m_pid, std::memory_order_relaxed);
+    record->state.store(STATE_PENDING, std::memory_order_relaxed);
+    m_header->writePos.store(pos + len, std::memory_order_release); /* 发布后记录头对消费者可见 */
+    if (m_mpmc)
+    {
+        unlockWriter();
+    }
+    buffer.data = (uint8_t*)(record + 1);
+    buffer.size = size;
+    buffer.pos = pos;
+    return true;
+}
+
+bool ShmRing::reserve(size_t size, ShmRingBuffer& buffer, const std::chrono::milliseconds& timeout)
+{
+    if (!m_header || size > getMaxRecordSize())
+    {
+        return false;
+    }
+    return waitUntil(
+        m_header->spaceSeq, m_header->spaceWaiters, [&] { return tryReserve(size, buffer); }, [&] { recover(); }, timeout);
+}
+
+void ShmRing::commit(const ShmRingBuffer& buffer)
+{
+    auto record = recordAt(buffer.pos);
+    const auto maxSize = record->len.load(std::memory_order_relaxed) - sizeof(Record);
+    record->size.store((uint32_t)std::min<size_t>(buffer.size, maxSize), std::memory_order_relaxed);
+    record->state.store(STATE_READY, std::memory_order_release);
+    wakeAddress(m_header->dataSeq, m_header->dataWaiters);
+}
+
+void ShmRing::cancel(const ShmRingBuffer& buffer)
+{
+    recordAt(buffer.pos)->state.store(STATE_PADDING, std::memory_order_release);
+    wakeAddress(m_header->dataSeq, m_header->dataWaiters); /* 消费者需要跳过 */
+}
+
+bool ShmRing::write(const void* data, size_t size, const std::chrono::milliseconds& timeout)
+{
+    ShmRingBuffer buffer;
+    if (!reserve(size, buffer, timeout))
+    {
+        return false;
+    }
+    if (size > 0)
+    {
+        memcpy(buffer.data, data, size);
+    }
+    commit(buffer);
+    return true;
+}
+
+bool ShmRing::tryAcquire(ShmRingBuffer& buffer)
+{
+    if (!m_header)
+    {
+        return false;
+    }
+    while (true)
+    {
+        uint64_t pos = m_header->readPos.load(std::memory_order_acquire);
+        if (pos == m_header->writePos.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        auto record = recordAt(pos);
+        const auto state = record->state.load(std::memory_order_acquire);
+        if (STATE_PENDING == state || STATE_CLAIMED == state) /* 未提交(或位置已被其他消费者推进) */
+        {
+            if (pos != m_header->readPos.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+            return false;
+        }
+        const auto len = record->len.load(std::memory_order_relaxed);
+        if (!m_header->readPos.compare_exchange_weak(pos, pos + len, std::memory_order_acq_rel))
+        {
+            continue;
+        }
+        if (STATE_READY != state) /* 填充或恢复后已释放的记录 */
+        {
+            record->state.store(STATE_DONE, std::memory_order_seq_cst);
+            advanceFree();
+            continue;
+        }
+        record->pid.store(m_pid, std::memory_order_relaxed);
+        record->state.store(STATE_CLAIMED, std::memory_order_relaxed);
+        buffer.data = (uint8_t*)(record + 1);
+        buffer.size = record->size.load(std::memory_order_relaxed);
+        buffer.pos = pos;
+        return true;
+    }
+}
+
+bool ShmRing::acquire(ShmRingBuffer& buffer, const std::chrono::milliseconds& timeout)
+{
+    if (!m_header)
+    {
+        return false;
+    }
+    return waitUntil(
+        m_header->dataSeq, m_header->dataWaiters, [&] { return tryAcquire(buffer); }, [&] { recover(); }, timeout);
+}
+
+void ShmRing::release(const ShmRingBuffer& buffer)
+{
+    recordAt(buffer.pos)->state.store(STATE_DONE, std::memory_order_seq_cst);
+    advanceFree();
+}
+
+bool ShmRing::read(std::vector<uint8_t>& data, const std::chrono::milliseconds& timeout)
+{
+    ShmRingBuffer buffer;
+    if (!acquire(buffer, timeout))
+    {
+        return false;
+    }
+    data.assign(buffer.data, buffer.data + buffer.size);
+    release(buffer);
+    return true;
+}
+
+size_t ShmRing::recover()
+{
+    if (!m_header)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    /* 持有生产锁的进程已崩溃 */
+    auto owner = m_header->writeLock.load(std::memory_order_acquire);
+    if (0 != owner && !isProcessAlive(owner) && m_header->writeLock.compare_exchange_strong(owner, 0))
+    {
+        ++count;
+    }
+    /* 已获取未释放的记录, 消费者已崩溃 */
+    const uint64_t readPos = m_header->readPos.load(std::memory_order_acquire);
+    std::vector<uint64_t> deadList;
+    bool liveAfterDead = false; /* 崩溃的记录之后是否有存活的消费者获取的记录 */
+    for (uint64_t pos = m_header->freePos.load(std::memory_order_acquire); pos < readPos;)
+    {
+        auto record = recordAt(pos);
+        const auto len = record->len.load(std::memory_order_relaxed);
+        const auto state = record->state.load(std::memory_order_acquire);
+        const auto pid = record->pid.load(std::memory_order_relaxed);
+        if (len < sizeof(Record) || len > m_header->capacity || 0 != len % RECORD_ALIGN
+            || m_header->freePos.load(std::memory_order_acquire) > pos) /* 已被释放, 记录头已失效 */
+        {
+            break;
+        }
+        if (STATE_CLAIMED == state)
+        {
+            if (!isProcessAlive(pid))
+            {
+                deadList.emplace_back(pos);
+            }
+            else if (!deadList.empty())
+            {
+                liveAfterDead = true;
+            }
+        }
+        pos += len;
+    }
+    if (!deadList.empty())
+    {
+        /* SPSC模式重新投递: 先回退消费位置再恢复状态, 回退失败时丢弃 */
+        uint64_t expected = readPos;
+        const bool redeliver = (!m_mpmc && !liveAfterDead
+                                && m_header->readPos.compare_exchange_strong(expected, deadList.front(), std::memory_order_acq_rel));
+        for (auto pos : deadList)
+        {
+            uint32_t state = STATE_CLAIMED;
+            if (recordAt(pos)->state.compare_exchange_strong(state, redeliver ? STATE_READY : STATE_DONE))
+            {
+                ++count;
+            }
+        }
+        if (redeliver)
+        {
+            wakeAddress(m_header->dataSeq, m_header->dataWaiters);
+        }
+        advanceFree();
+    }
+    /* 已预留未提交的记录, 生产者已崩溃(消费位置不会越过未提交的记录, 只需要检查队首) */
+    while (true)
+    {
+        uint64_t pos = m_header->readPos.load(std::memory_order_acquire);
+        if (pos == m_header->writePos.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        auto record = recordAt(pos);
+        uint32_t state = STATE_PENDING;
+        if (state != record->state.load(std::memory_order_acquire) || isProcessAlive(record->pid.load(std::memory_order_relaxed))
+            || !record->state.compare_exchange_strong(state, STATE_PADDING))
+        {
+            break;
+        }
+        ++count;
+        if (m_header->readPos.compare_exchange_strong(pos, pos + record->len.load(std::memory_order_relaxed))) /* 直接跳过 */
+        {
+            record->state.store(STATE_DONE, std::memory_order_seq_cst);
+            advanceFree();
+        }
+        wakeAddress(m_header->dataSeq, m_header->dataWaiters);
+    }
+    return count;
+}
+
+ShmRing::Record* ShmRing::recordAt(uint64_t pos) const
+{
+    return (Record*)(m_data + (pos & m_mask));
+}
+
+void ShmRing::lockWriter()
+{
+    for (uint32_t spin = 0;; ++spin)
+    {
+        int32_t owner = 0;
+        if (m_header->writeLock.compare_exchange_weak(owner, m_pid, std::memory_order_acquire))
+        {
+            return;
+        }
+        if (spin < 64)
+        {
+            continue;
+        }
+        if (0 == (spin & 0xFFFF) && 0 != owner && !isProcessAlive(owner)) /* 持有者已崩溃 */
+        {
+            m_header->writeLock.compare_exchange_strong(owner, 0);
+        }
+        std::this_thread::yield();
+    }
+}
+
+void ShmRing::unlockWriter()
+{
+    m_header->writeLock.store(0, std::memory_order_release);
+}
+
+void ShmRing::advanceFree()
+{
+    bool advanced = false;
+    while (true)
+    {
+        const uint64_t pos = m_header->freePos.load(std::memory_order_seq_cst);
+        if (pos == m_header->readPos.load(std::memory_order_seq_cst))
+        {
+            break;
+        }
+        auto record = recordAt(pos);
+        uint32_t state = STATE_DONE;
+        if (!record->state.compare_exchange_strong(state, STATE_PENDING, std::memory_order_seq_cst)) /* 前面的记录还未释放 */
+        {
+            break;
+        }
+        const auto len = record->len.load(std::memory_order_relaxed);
+        uint64_t expected = pos;
+        if (!m_header->freePos.compare_exchange_strong(expected, pos + len, std::memory_order_seq_cst))
+        {
+            /* 读取释放位置后被挂起, 期间环形缓冲区已回绕, 占用的是同一位置上的新记录(ABA), 撤销后重试 */
+            record->state.store(STATE_DONE, std::memory_order_seq_cst);
+            continue;
+        }
+        record->pid.store(0, std::memory_order_relaxed);
+        advanced = true;
+    }
+    if (advanced)
+    {
+        wakeAddress(m_header->spaceSeq, m_header->spaceWaiters);
+    }
+}
+} // namespace ipc
@@ -0,0 +1,205 @@
+#pragma once
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ipc
+{
+/**
+ * @brief 共享内存环形队列的记录缓冲(零拷贝, 直接指向共享内存)
+ */
+struct ShmRingBuffer
+{
+    uint8_t* data = nullptr; /* 数据 */
+    size_t size = 0; /* 数据长度(提交前可以改小) */
+    uint64_t pos = 0; /* 记录位置(内部使用) */
+};
+
+/**
+ * @brief 共享内存环形队列(进程间消息通道, 记录长度可变)
+ *        说明: 1.SPSC模式只允许一个生产者进程和一个消费者进程, MPMC模式允许多个生产者和多个消费者(进程/线程)
+ *              2.Linux下使用共享的futex阻塞等待和唤醒, 没有等待者时提交/释放不产生系统调用, 其他平台退化为短暂休眠轮询
+ *              3.生产/消费位置是单调递增的64位计数, 记录头保存生产者/消费者进程ID, 进程崩溃后:
+ *                - 已预留未提交的记录被丢弃
+ *                - 已获取未释放的记录, SPSC模式重新投递, MPMC模式丢弃
+ *                - 持有生产锁的进程崩溃时锁被回收
+ *              4.阻塞等待超过100毫秒时会自动执行恢复检查, 也可以手动调用recover
+ */
+class ShmRing final
+{
+public:
+    /**
+     * @brief 模式
+     */
+    enum class Mode
+    {
+        SPSC = 0, /* 单生产者单消费者 */
+        MPMC = 1 /* 多生产者多消费者 */
+    };
+
+    ShmRing() = default;
+    ~ShmRing();
+    ShmRing(const ShmRing& src) = delete;
+    ShmRing& operator=(const ShmRing& src) = delete;
+
+    /**
+     * @brief 打开(不存在时创建)
+     * @param name 名称(不能包含'/'), 例如: "sample_stream"
+     * @param capacity 数据区容量(字节, 向上取整为2的幂, 最小4096), 为0时表示只打开已存在的
+     * @param mode 模式(已存在时需要一致)
+     * @param errorDesc [输出]错误信息
+     * @return 0-成功, 1-参数错误, 2-共享内存创建/打开失败, 3-映射失败, 4-已存在但容量/模式不一致, 5-等待初始化超时
+     */
+    int open(const std::string& name, size_t capacity, Mode mode, std::string& errorDesc);
+
+    /**
+     * @brief 关闭(不删除共享内存)
+     */
+    void close();
+
+    /**
+     * @brief 删除共享内存(已打开的进程不受影响)
+     * @param name 名称
+     * @return true-成功, false-失败
+     */
+    static bool remove(const std::string& name);
+
+    /**
+     * @brief 是否已打开
+     * @return true-已打开, false-未打开
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief 获取数据区容量
+     * @return 容量(字节)
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief 获取单条记录的最大长度
+     * @return 长度(字节)
+     */
+    size_t getMaxRecordSize() const;
+
+    /**
+     * @brief 获取已使用的字节数(包含已获取未释放的记录)
+     * @return 字节数
+     */
+    size_t getUsedSize() const;
+
+    /**
+     * @brief 预留记录(不阻塞)
+     * @param size 数据长度
+     * @param buffer [输出]记录缓冲, 写入数据后调用commit或cancel
+     * @return true-成功, false-空间不足或长度超过上限
+     */
+    bool tryReserve(size_t size, ShmRingBuffer& buffer);
+
+    /**
+     * @brief 预留记录(空间不足时阻塞等待)
+     * @param size 数据长度
+     * @param buffer [输出]记录缓冲, 写入数据后调用commit或cancel
+     * @param timeout 超时, 小于0表示一直等待
+     * @return true-成功, false-超时或长度超过上限
+     */
+    bool reserve(size_t size, ShmRingBuffer& buffer, const std::chrono::milliseconds& timeout);
+
+    /**
+     * @brief 提交记录(消费者可见)
+     * @param buffer 记录缓冲(size可以改小)
+     */
+    void commit(const ShmRingBuffer& buffer);
+
+    /**
+     * @brief 取消已预留的记录
+     * @param buffer 记录缓冲
+     */
+    void cancel(const ShmRingBuffer& buffer);
+
+    /**
+     * @brief 写入记录(拷贝)
+     * @param data 数据
+     * @param size 数据长度
+     * @param timeout 超时, 小于0表示一直等待
+     * @return true-成功, false-超时或长度超过上限
+     */
+    bool write(const void* data, size_t size, const std::chrono::milliseconds& timeout);
+
+    /**
+     * @brief 获取记录(不阻塞)
+     * @param buffer [输出]记录缓冲, 处理完后调用release
+     * @return true-成功, false-没有可读记录
+     */
+    bool tryAcquire(ShmRingBuffer& buffer);
+
+    /**
+     * @brief 获取记录(没有记录时阻塞等待)
+     * @param buffer [输出]记录缓冲, 处理完后调用release
+     * @param timeout 超时, 小于0表示一直等待
+     * @return true-成功, false-超时
+     */
+    bool acquire(ShmRingBuffer& buffer, const std::chrono::milliseconds& timeout);
+
+    /**
+     * @brief 释放记录(空间可被生产者重用)
+     * @param buffer 记录缓冲
+     */
+    void release(const ShmRingBuffer& buffer);
+
+    /**
+     * @brief 读取记录(拷贝)
+     * @param data [输出]数据
+     * @param timeout 超时, 小于0表示一直等待
+     * @return true-成功, false-超时
+     */
+    bool read(std::vector<uint8_t>& data, const std::chrono::milliseconds& timeout);
+
+    /**
+     * @brief 恢复崩溃进程遗留的状态(生产锁, 已预留未提交的记录, 已获取未释放的记录)
+     * @return 恢复的数量
+     */
+    size_t recover();
+
+private:
+    struct Header;
+    struct Record;
+
+    /**
+     * @brief 获取位置对应的记录
+     */
+    Record* recordAt(uint64_t pos) const;
+
+    /**
+     * @brief 映射共享内存
+     */
+    int mapMemory(const std::string& name, size_t capacity, Mode mode, std::string& errorDesc);
+
+    /**
+     * @brief 加生产锁(MPMC模式)
+     */
+    void lockWriter();
+
+    /**
+     * @brief 解生产锁(MPMC模式)
+     */
+    void unlockWriter();
+
+    /**
+     * @brief 推进释放位置(跳过已释放的记录)
+     */
+    void advanceFree();
+
+private:
+    std::string m_name; /* 名称 */
+    void* m_handle = nullptr; /* 映射句柄(Windows) */
+    uint8_t* m_addr = nullptr; /* 映射地址 */
+    size_t m_mapSize = 0; /* 映射长度 */
+    Header* m_header = nullptr; /* 控制区 */
+    uint8_t* m_data = nullptr; /* 数据区 */
+    uint64_t m_mask = 0; /* 容量掩码 */
+    bool m_mpmc = false; /* 是否MPMC模式 */
+    int32_t m_pid = 0; /* 当前进程ID */
+};
+} // namespace ipc
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "logger/binlog/binlog_reader.h"
+#include "logger/logger_manager.h"
+
+/**
+ * @brief 压测模式
+ */
+struct BenchMode
+{
+    const char* name; /* 名称(同时作为记录器名称和日志目录名) */
+    bool asyncMode; /* 是否异步模式 */
+    int asyncOverflow; /* 异步模式下缓冲区满时的处理策略 */
+    int flushLevel; /* 刷新等级 */
+    int formatMode; /* 格式化模式 */
+    int level; /* 日志等级(大于INFO时测试的是等级过滤的开销) */
+};
+
+/**
+ * @brief 获取当天的日志文件全名(不按天创建文件夹, 文件容量足够大不会滚动)
+ * @param path 日志文件路径
+ * @param name 记录器名称
+ * @param extName 扩展名
+ * @return 文件全名
+ */
+static std::string getLogFullName(const std::string& path, const std::string& name, const std::string& extName)
+{
+    time_t now = time(nullptr);
+    struct tm t;
+#ifdef _WIN32
+    localtime_s(&t, &now);
+#else
+    localtime_r(&now, &t);
+#endif
+    char dateStr[12] = {0};
+    strftime(dateStr, sizeof(dateStr), "%Y%m%d", &t);
+    return path + "/" + name + dateStr + "-1" + extName;
+}
+
+/**
+ * @brief 统计日志文件的行数
+ * @param fullName 日志文件全名
+ * @return 行数, -1表示文件不存在
+ */
+static long long countLines(const std::string& fullName)
+{
+    std::ifstream f(fullName, std::ios::binary);
+    if (!f.is_open())
+    {
+        return -1;
+    }
+    long long count = 0;
+    std::vector<char> buf(1024 * 1024);
+    while (f.read(buf.data(), buf.size()) || f.gcount() > 0)
+    {
+        count += std::count(buf.data(), buf.data() + f.gcount(), '\n');
+    }
+    return count;
+}
+
+/**
+ * @brief 解码二进制日志文件并统计行数
+ * @param fullName 日志文件全名
+ * @return 行数, -1表示文件不存在或格式错误
+ */
+static long long countBinaryLines(const std::string& fullName)
+{
+    logger::binlog::BinlogReader reader;
+    if (!reader.open(fullName))
+    {
+        return -1;
+    }
+    long long count = 0;
+    int level = 0;
+    std::string line;
+    while (reader.next(level, line))
+    {
+        ++count;
+    }
+    return count;
+}
+
+/**
+ * @brief 多线程写日志, 统计调用处的耗时分布
+ */
+static void bench(const BenchMode& mode, const std::string& dir, size_t threadCount, size_t msgCount, size_t bufferSize)
+{
+    const std::string path = dir + "/" + mode.name;
+    logger::LogConfig cfg;
+    cfg.path = path;
+    cfg.name = mode.name;
+    cfg.level = mode.level;
+    cfg.flushLevel = mode.flushLevel;
+    cfg.fileMaxSize = 1024 * 1024 * 1024;
+    cfg.newFolderDaily = false;
+    cfg.asyncMode = mode.asyncMode;
+    cfg.asyncBufferSize = bufferSize;
+    cfg.asyncOverflow = mode.asyncOverflow;
+    cfg.formatMode = mode.formatMode;
+    cfg.fileExtName = (logger::FORMAT_BINARY == mode.formatMode ? ".blog" : ".log");
+    logger::LoggerManager::setConfig(cfg);
+    auto lg = logger::LoggerManager::getLogger("bench", -1, mode.name);
+    const std::string text(48, 'x'); /* 加上头部(等级,时间,进程,线程,标签,文件,函数,行号)约100字节 */
+    std::vector<std::vector<uint32_t>> latencyList(threadCount);
+    std::atomic<size_t> readyCount{0};
+    std::atomic_bool start{false};
+    std::vector<std::thread> threadList;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threadList.emplace_back([&, i]() {
+            auto& latency = latencyList[i];
+            latency.reserve(msgCount);
+            ++readyCount;
+            while (!start)
+            {
+                std::this_thread::yield();
+            }
+            for (size_t n = 0; n < msgCount; ++n)
+            {
+                const auto tp = std::chrono::steady_clock::now();
+                INFO_LOG(lg, "seq={:08d} {}", n, text);
+                latency.emplace_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tp)
+                                         .count());
+            }
+        });
+    }
+    while (readyCount < threadCount)
+    {
+        std::this_thread::yield();
+    }
+    const auto tp1 = std::chrono::steady_clock::now();
+    start = true;
+    for (auto& th : threadList)
+    {
+        th.join();
+    }
+    const auto tp2 = std::chrono::steady_clock::now();
+    lg.forceFlush();
+    const auto tp3 = std::chrono::steady_clock::now();
+    std::vector<uint32_t> allLatency;
+    allLatency.reserve(threadCount * msgCount);
+    for (const auto& latency : latencyList)
+    {
+        allLatency.insert(allLatency.end(), latency.begin(), latency.end());
+    }
+    std::sort(allLatency.begin(), allLatency.end());
+    auto percentile = [&](double p) {
+        return allLatency[std::min(allLatency.size() - 1, (size_t)(p * allLatency.size()))] / 1000.0;
+    };
+    const double callSec = std::chrono::duration<double>(tp2 - tp1).count();
+    const double totalSec = std::chrono::duration<double>(tp3 - tp1).count();
+    printf("%-18s %9.2f %9.2f %9.2f %9.2f %10.1f %12.0f %12.0f %10llu %10lld\n", mode.name, percentile(0.5), percentile(0.99),
+           percentile(0.999), allLatency.back() / 1000.0, callSec * 1000, allLatency.size() / callSec, allLatency.size() / totalSec,
+           (unsigned long long)lg.getDropCount(),
+           logger::FORMAT_BINARY == mode.formatMode ? countBinaryLines(getLogFullName(path, mode.name, cfg.fileExtName))
+                                                    : countLines(getLogFullName(path, mode.name, cfg.fileExtName)));
+}
+
+int main(int argc, char* argv[])
+{
+    printf("*************************************************************************************************************\n");
+    printf("** 说明: 日志写入压测, 多线程同时写约100字节的日志, 统计调用处的耗时分布(微秒), 对比同步模式和异步模式,    **\n");
+    printf("**       以及调用处格式化(文本), 延迟格式化(deferred)和二进制(binary)模式, level_filtered为等级过滤的开销. **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 选项:                                                                                                   **\n");
+    printf("**                                                                                                         **\n");
+    printf("** [-d 目录]           日志目录, 默认logbench, 测试前删除已有的日志文件.                                   **\n");
+    printf("** [-t 线程数]         写日志的线程数, 默认16.                                                             **\n");
+    printf("** [-n 数量]           每个线程写的日志数量, 默认20000.                                                    **\n");
+    printf("** [-b 大小]           异步模式下每个线程的缓冲区大小(KB), 默认1024.                                       **\n");
+    printf("**                                                                                                         **\n");
+    printf("*************************************************************************************************************\n");
+    printf("\n");
+    std::string dir = "logbench";
+    size_t threadCount = 16;
+    size_t msgCount = 20000;
+    size_t bufferSize = 1024 * 1024;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        if ("-d" == key)
+        {
+            dir = argv[i + 1];
+        }
+        else if ("-t" == key)
+        {
+            threadCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-n" == key)
+        {
+            msgCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-b" == key)
+        {
+            bufferSize = (size_t)std::max(atoi(argv[i + 1]), 1) * 1024;
+        }
+    }
+    const int BLOCK = logger::ASYNC_OVERFLOW_BLOCK, TRACE = logger::LEVEL_TRACE, IMMEDIATE = logger::FORMAT_IMMEDIATE;
+    const BenchMode modeList[] = {
+        {"sync_flush", false, BLOCK, TRACE, IMMEDIATE, TRACE},
+        {"sync", false, BLOCK, logger::LEVEL_FATAL, IMMEDIATE, TRACE},
+        {"async_block", true, BLOCK, TRACE, IMMEDIATE, TRACE},
+        {"async_drop_oldest", true, logger::ASYNC_OVERFLOW_DROP_OLDEST, TRACE, IMMEDIATE, TRACE},
+        {"async_drop_new", true, logger::ASYNC_OVERFLOW_DROP_NEW, TRACE, IMMEDIATE, TRACE},
+        {"async_deferred", true, BLOCK, TRACE, logger::FORMAT_DEFERRED, TRACE},
+        {"async_binary", true, BLOCK, TRACE, logger::FORMAT_BINARY, TRACE},
+        {"level_filtered", false, BLOCK, TRACE, IMMEDIATE, logger::LEVEL_WARN},
+    };
+    printf("threads: %zu, messages per thread: %zu, async buffer: %zu KB, cpu cores: %u\n", threadCount, msgCount, bufferSize / 1024,
+           std::thread::hardware_concurrency());
+    printf("%-18s %9s %9s %9s %9s %10s %12s %12s %10s %10s\n", "mode", "p50(us)", "p99(us)", "p99.9(us)", "max(us)", "calls(ms)",
+           "calls/sec", "written/sec", "dropped", "lines");
+    for (const auto& mode : modeList)
+    {
+        remove(getLogFullName(dir + "/" + mode.name, mode.name, logger::FORMAT_BINARY == mode.formatMode ? ".blog" : ".log").c_str());
+        bench(mode, dir, threadCount, msgCount, bufferSize);
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "logger/binlog/binlog_reader.h"
+#include "logger/logger_define.h"
+
+int main(int argc, char* argv[])
+{
+    std::string inputFile;
+    std::string outputFile;
+    int minLevel = logger::LEVEL_TRACE;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        if ("-f" == key)
+        {
+            inputFile = argv[i + 1];
+        }
+        else if ("-o" == key)
+        {
+            outputFile = argv[i + 1];
+        }
+        else if ("-l" == key)
+        {
+            minLevel = atoi(argv[i + 1]);
+        }
+    }
+    if (inputFile.empty())
+    {
+        printf("*************************************************************************************************************\n");
+        printf("** 说明: 二进制日志解码工具, 把二进制模式(FORMAT_BINARY)写入的日志文件转换为文本日志(格式同文本模式).      **\n");
+        printf("**                                                                                                         **\n");
+        printf("** 选项:                                                                                                   **\n");
+        printf("**                                                                                                         **\n");
+        printf("** [-f 文件]           二进制日志文件(必填).                                                               **\n");
+        printf("** [-o 文件]           输出的文本日志文件, 默认输出到控制台.                                               **\n");
+        printf("** [-l 等级]           只输出大于等于该等级的日志, 0-跟踪, 1-调试, 2-信息, 3-警告, 4-错误, 5-致命, 默认0.  **\n");
+        printf("**                                                                                                         **\n");
+        printf("** 示例:                                                                                                   **\n");
+        printf("**       example_logger_decoder -f app20240101-1.blog -o app20240101-1.log -l 2                            **\n");
+        printf("**                                                                                                         **\n");
+        printf("*************************************************************************************************************\n");
+        return 1;
+    }
+    logger::binlog::BinlogReader reader;
+    std::string errDesc;
+    if (!reader.open(inputFile, &errDesc))
+    {
+        fprintf(stderr, "%s\n", errDesc.c_str());
+        return 1;
+    }
+    FILE* out = stdout;
+    if (!outputFile.empty())
+    {
+        out = fopen(outputFile.c_str(), "wb");
+        if (!out)
+        {
+            fprintf(stderr, "open output file [%s] fail\n", outputFile.c_str());
+            return 1;
+        }
+    }
+    size_t count = 0;
+    int level = 0;
+    std::string line;
+    while (reader.next(level, line))
+    {
+        if (level >= minLevel)
+        {
+            fwrite(line.data(), 1, line.size(), out);
+            ++count;
+        }
+    }
+    if (stdout != out)
+    {
+        fclose(out);
+        printf("decoded %zu lines, %zu errors\n", count, reader.getErrorCount());
+    }
+    return (0 == reader.getErrorCount() ? 0 : 2);
+}
@@ -22,6 +22,10 @@ int main()
     cfg.fileMaxCount = 5;
     cfg.fileIndexFixed = true;
     cfg.newFolderDaily = true;
+    cfg.fileMaxTotalSize = 200 * 1024 * 1024; /* 目录下已归档文件最多占用200M */
+#if (1 == ENABLE_LOGGER_ZLIB)
+    cfg.fileCompressor = LogCompressor::gzip(); /* 滚动后的文件在后台压缩为.gz */
+#endif
     logger::LoggerManager::setConfig(cfg, "who");
     auto logger1 = logger::LoggerManager::getLogger("test", -1, "main_");
     logger1.setConsoleMode(2);
@@ -0,0 +1,266 @@
+#include "binlog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "../impl/log_line.h"
+
+namespace logger
+{
+static const uint32_t SITE_CHUNK_BITS = 10;
+static const uint32_t SITE_CHUNK_SIZE = (1U << SITE_CHUNK_BITS); /* 每块调用处数量 */
+static const uint32_t SITE_CHUNK_COUNT = 1024; /* 最多块数(调用处最多1M个) */
+
+/**
+ * @brief 调用处表(分块存储, 只追加, 已注册的调用处地址不变, 读取时无需加锁)
+ */
+struct SiteTable
+{
+    std::mutex mutex;
+    std::atomic<const LogSite**> chunkList[SITE_CHUNK_COUNT] = {};
+    std::atomic<uint32_t> count{0};
+};
+
+static SiteTable& getSiteTable()
+{
+    static SiteTable* s_table = new SiteTable(); /* 不释放, 避免进程退出时后台线程访问已析构的对象 */
+    return *s_table;
+}
+
+LogSite::LogSite(const char* file, int line, const char* func, const char* format)
+    : file(file ? file : ""), line(line), func(func ? func : ""), format(format ? format : "")
+{
+    auto& table = getSiteTable();
+    std::lock_guard<std::mutex> locker(table.mutex);
+    const uint32_t index = table.count.load(std::memory_order_relaxed);
+    const uint32_t chunkIndex = (index >> SITE_CHUNK_BITS);
+    if (chunkIndex >= SITE_CHUNK_COUNT) /* 超过最大数量, 复用最后一个ID(解码时调用处信息不准确) */
+    {
+        id = index - 1;
+        return;
+    }
+    auto chunk = table.chunkList[chunkIndex].load(std::memory_order_relaxed);
+    if (!chunk)
+    {
+        chunk = new const LogSite*[SITE_CHUNK_SIZE]();
+        table.chunkList[chunkIndex].store(chunk, std::memory_order_release);
+    }
+    chunk[index & (SITE_CHUNK_SIZE - 1)] = this;
+    id = index;
+    table.count.store(index + 1, std::memory_order_release);
+}
+
+uint32_t LogSite::getCount()
+{
+    return getSiteTable().count.load(std::memory_order_acquire);
+}
+
+const LogSite* LogSite::find(uint32_t id)
+{
+    auto& table = getSiteTable();
+    if (id >= table.count.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    return table.chunkList[id >> SITE_CHUNK_BITS].load(std::memory_order_acquire)[id & (SITE_CHUNK_SIZE - 1)];
+}
+
+namespace binlog
+{
+template<typename T>
+inline void appendPod(std::string& buf, const T& value)
+{
+    buf.append((const char*)&value, sizeof(value));
+}
+
+template<typename T>
+inline bool readPod(const char*& p, const char* end, T& value)
+{
+    if ((size_t)(end - p) < sizeof(T))
+    {
+        return false;
+    }
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+std::string& getArgBuffer()
+{
+    static thread_local std::string s_buffer;
+    return s_buffer;
+}
+
+void encodeRecord(std::string& buf, uint32_t siteId, int tid, int64_t timeUs, const std::string& tag, const char* args, size_t argsLen)
+{
+    const uint16_t tagLen = (uint16_t)std::min<size_t>(tag.size(), UINT16_MAX);
+    appendPod(buf, siteId);
+    appendPod(buf, (int32_t)tid);
+    appendPod(buf, timeUs);
+    appendPod(buf, tagLen);
+    buf.append(tag.data(), tagLen);
+    buf.append(args, argsLen);
+}
+
+bool decodeRecord(const char* data, size_t size, RecordView& view)
+{
+    const char* p = data;
+    const char* end = data + size;
+    int32_t tid = 0;
+    uint16_t tagLen = 0;
+    if (!readPod(p, end, view.siteId) || !readPod(p, end, tid) || !readPod(p, end, view.timeUs) || !readPod(p, end, tagLen)
+        || (size_t)(end - p) < tagLen)
+    {
+        return false;
+    }
+    view.tid = tid;
+    view.tag = p;
+    view.tagLen = tagLen;
+    p += tagLen;
+    view.args = p;
+    view.argsLen = end - p;
+    return true;
+}
+
+bool formatArgs(const char* format, const char* args, size_t argsLen, std::string& msg)
+{
+    const char* p = args;
+    const char* end = args + argsLen;
+    uint8_t count = 0;
+    if (!readPod(p, end, count))
+    {
+        msg = "[binlog] invalid arguments";
+        return false;
+    }
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        uint8_t type = 0;
+        bool ok = readPod(p, end, type);
+        switch (type)
+        {
+        case ARG_INT: {
+            int64_t v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back(v);
+        }
+        break;
+        case ARG_UINT: {
+            uint64_t v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back(v);
+        }
+        break;
+        case ARG_FLOAT: {
+            float v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back(v);
+        }
+        break;
+        case ARG_DOUBLE: {
+            double v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back(v);
+        }
+        break;
+        case ARG_BOOL: {
+            uint8_t v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back(0 != v);
+        }
+        break;
+        case ARG_CHAR: {
+            char v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back(v);
+        }
+        break;
+        case ARG_STRING: {
+            uint32_t len = 0;
+            ok = ok && readPod(p, end, len) && (size_t)(end - p) >= len;
+            if (ok)
+            {
+                store.push_back(fmt::string_view(p, len));
+                p += len;
+            }
+        }
+        break;
+        case ARG_POINTER: {
+            uint64_t v = 0;
+            ok = ok && readPod(p, end, v);
+            store.push_back((const void*)(uintptr_t)v);
+        }
+        break;
+        default:
+            ok = false;
+        }
+        if (!ok)
+        {
+            msg = "[binlog] invalid arguments";
+            return false;
+        }
+    }
+    try
+    {
+        msg = fmt::vformat(format, store);
+    }
+    catch (const std::exception& e)
+    {
+        msg = fmt::format("[binlog] format \"{}\" fail: {}", format, e.what());
+        return false;
+    }
+    return true;
+}
+
+size_t appendRecordLine(std::string& buf, int level, int pid, const RecordView& view, const char* file, int line, const char* func,
+                        const char* format)
+{
+    static thread_local std::string msg;
+    formatArgs(format, view.args, view.argsLen, msg);
+    const size_t offset = buf.size();
+    buf.resize(offset + getLineMaxLength(view.tagLen, strlen(file), strlen(func), msg.size()));
+    const size_t len = formatLine(&buf[offset], level, getDateTime(view.timeUs), pid, view.tid, view.tag, view.tagLen, file, line, func,
+                                  msg.data(), msg.size());
+    buf.resize(offset + len);
+    return len;
+}
+
+void appendFrame(std::string& buf, uint8_t type, int level, const char* data, size_t size)
+{
+    FrameHead head;
+    head.size = (uint32_t)size;
+    head.type = type;
+    head.level = (int8_t)level;
+    head.reserved = 0;
+    appendPod(buf, head);
+    buf.append(data, size);
+}
+
+void appendSessionFrame(std::string& buf, int pid)
+{
+    std::string payload(MAGIC, sizeof(MAGIC));
+    appendPod(payload, VERSION);
+    appendPod(payload, (int32_t)pid);
+    appendFrame(buf, FRAME_SESSION, 0, payload.data(), payload.size());
+}
+
+void appendSiteFrame(std::string& buf, const LogSite& site)
+{
+    const uint16_t fileLen = (uint16_t)std::min<size_t>(strlen(site.file), UINT16_MAX);
+    const uint16_t funcLen = (uint16_t)std::min<size_t>(strlen(site.func), UINT16_MAX);
+    const uint32_t formatLen = (uint32_t)strlen(site.format);
+    std::string payload;
+    payload.reserve(16 + fileLen + funcLen + formatLen);
+    appendPod(payload, site.id);
+    appendPod(payload, (int32_t)site.line);
+    appendPod(payload, fileLen);
+    appendPod(payload, funcLen);
+    appendPod(payload, formatLen);
+    payload.append(site.file, fileLen);
+    payload.append(site.func, funcLen);
+    payload.append(site.format, formatLen);
+    appendFrame(buf, FRAME_SITE, 0, payload.data(), payload.size());
+}
+} // namespace binlog
+} // namespace logger
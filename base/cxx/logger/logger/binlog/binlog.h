@@ -0,0 +1,310 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <string>
+#include <string.h>
+#include <type_traits>
+
+namespace logger
+{
+/**
+ * @brief 日志调用处(延迟格式化/二进制模式下, 每个调用处只注册一次, 日志记录中只保存调用处ID)
+ */
+struct LogSite
+{
+    /**
+     * @brief 构造函数(注册到全局调用处表, 参数必须是静态存储的字符串)
+     * @param file 文件名
+     * @param line 行号
+     * @param func 函数名
+     * @param format 格式串
+     */
+    LogSite(const char* file, int line, const char* func, const char* format);
+
+    LogSite(const LogSite& src) = delete;
+    LogSite& operator=(const LogSite& src) = delete;
+
+    /**
+     * @brief 获取已注册的调用处数量
+     * @return 数量(调用处ID范围: [0, 数量))
+     */
+    static uint32_t getCount();
+
+    /**
+     * @brief 根据ID获取调用处
+     * @param id 调用处ID
+     * @return 调用处, 为空表示不存在
+     */
+    static const LogSite* find(uint32_t id);
+
+    const char* const file; /* 文件名 */
+    const int line; /* 行号 */
+    const char* const func; /* 函数名 */
+    const char* const format; /* 格式串 */
+    uint32_t id = 0; /* 调用处ID */
+};
+
+namespace binlog
+{
+/**
+ * @brief 二进制日志文件格式, 说明:
+ *        1.文件由帧组成, 帧头为FrameHead(8字节), 之后是帧内容, 整数使用本机字节序
+ *        2.每次打开文件时先写入会话帧(FRAME_SESSION)和所有已注册的调用处帧(FRAME_SITE), 之后新注册的调用处在首次使用前写入
+ *        3.解码时遇到会话帧则清空调用处表, 因此同一文件中可以包含多个进程(或多次运行)的日志
+ */
+const uint32_t VERSION = 1; /* 格式版本 */
+const char MAGIC[8] = {'N', 'L', 'O', 'G', 'B', 'I', 'N', '\0'}; /* 会话帧中的魔数 */
+
+/**
+ * @brief 帧类型
+ */
+const uint8_t FRAME_SESSION = 'P'; /* 会话: 魔数(8字节) + 版本(uint32) + 进程ID(int32) */
+const uint8_t FRAME_SITE = 'S'; /* 调用处: ID(uint32) + 行号(int32) + 文件名长度(uint16) + 函数名长度(uint16) + 格式串长度(uint32) + 字符串 */
+const uint8_t FRAME_RECORD = 'R'; /* 延迟格式化的日志记录, 格式见encodeRecord */
+const uint8_t FRAME_TEXT = 'T'; /* 已格式化的日志行 */
+
+/**
+ * @brief 帧头
+ */
+struct FrameHead
+{
+    uint32_t size; /* 帧内容长度 */
+    uint8_t type; /* 帧类型 */
+    int8_t level; /* 日志等级(日志帧有效) */
+    uint16_t reserved; /* 保留 */
+};
+
+/**
+ * @brief 参数类型
+ */
+const uint8_t ARG_INT = 1; /* 有符号整数(int64) */
+const uint8_t ARG_UINT = 2; /* 无符号整数(uint64) */
+const uint8_t ARG_FLOAT = 3; /* 单精度浮点数 */
+const uint8_t ARG_DOUBLE = 4; /* 双精度浮点数 */
+const uint8_t ARG_BOOL = 5; /* 布尔 */
+const uint8_t ARG_CHAR = 6; /* 字符 */
+const uint8_t ARG_STRING = 7; /* 字符串: 长度(uint32) + 内容 */
+const uint8_t ARG_POINTER = 8; /* 指针(uint64) */
+
+/**
+ * @brief 参数类型是否可以延迟格式化(只保存值, 不依赖调用处的对象生命周期), 其他类型在调用处格式化
+ */
+template<typename T>
+struct IsDeferrableArg
+    : std::integral_constant<bool, (std::is_arithmetic<T>::value && !std::is_same<T, long double>::value && !std::is_same<T, wchar_t>::value
+                                    && !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value)
+                                       || std::is_same<T, const char*>::value || std::is_same<T, char*>::value
+                                       || std::is_same<T, std::string>::value || std::is_same<T, fmt::string_view>::value
+                                       || std::is_same<T, const void*>::value || std::is_same<T, void*>::value
+                                       || std::is_same<T, std::nullptr_t>::value>
+{
+};
+
+template<size_t N>
+struct IsDeferrableArg<char[N]> : std::true_type
+{
+};
+
+template<typename... Args>
+struct IsDeferrable;
+
+template<>
+struct IsDeferrable<> : std::true_type
+{
+};
+
+template<typename T, typename... Rest>
+struct IsDeferrable<T, Rest...> : std::integral_constant<bool, IsDeferrableArg<T>::value && IsDeferrable<Rest...>::value>
+{
+};
+
+template<typename T>
+inline void appendValue(std::string& buf, uint8_t type, T value)
+{
+    buf.push_back((char)type);
+    buf.append((const char*)&value, sizeof(value));
+}
+
+inline void appendStringArg(std::string& buf, const char* s, size_t n)
+{
+    const uint32_t len = (uint32_t)n;
+    buf.push_back((char)ARG_STRING);
+    buf.append((const char*)&len, sizeof(len));
+    buf.append(s, n);
+}
+
+inline void encodeArg(std::string& buf, bool v)
+{
+    appendValue(buf, ARG_BOOL, (uint8_t)(v ? 1 : 0));
+}
+
+inline void encodeArg(std::string& buf, char v)
+{
+    appendValue(buf, ARG_CHAR, v);
+}
+
+inline void encodeArg(std::string& buf, float v)
+{
+    appendValue(buf, ARG_FLOAT, v);
+}
+
+inline void encodeArg(std::string& buf, double v)
+{
+    appendValue(buf, ARG_DOUBLE, v);
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type encodeArg(std::string& buf, T v)
+{
+    appendValue(buf, ARG_INT, (int64_t)v);
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type encodeArg(std::string& buf, T v)
+{
+    appendValue(buf, ARG_UINT, (uint64_t)v);
+}
+
+inline void encodeArg(std::string& buf, const char* v)
+{
+    if (!v)
+    {
+        throw fmt::format_error("string pointer is null"); /* 同fmt::format的行为 */
+    }
+    appendStringArg(buf, v, strlen(v));
+}
+
+inline void encodeArg(std::string& buf, const std::string& v)
+{
+    appendStringArg(buf, v.data(), v.size());
+}
+
+inline void encodeArg(std::string& buf, fmt::string_view v)
+{
+    appendStringArg(buf, v.data(), v.size());
+}
+
+inline void encodeArg(std::string& buf, const void* v)
+{
+    appendValue(buf, ARG_POINTER, (uint64_t)(uintptr_t)v);
+}
+
+inline void encodeArg(std::string& buf, std::nullptr_t)
+{
+    appendValue(buf, ARG_POINTER, (uint64_t)0);
+}
+
+inline void encodeArgList(std::string& /*buf*/) {}
+
+template<typename T, typename... Rest>
+inline void encodeArgList(std::string& buf, const T& first, const Rest&... rest)
+{
+    encodeArg(buf, first);
+    encodeArgList(buf, rest...);
+}
+
+/**
+ * @brief 编码参数列表, 格式: 参数个数(uint8) + [参数类型(uint8) + 值]...
+ * @param buf [输出]编码结果
+ * @param args 参数列表(类型需满足IsDeferrable)
+ */
+template<typename... Args>
+inline void encodeArgs(std::string& buf, const Args&... args)
+{
+    static_assert(sizeof...(Args) <= 255, "too many arguments");
+    buf.push_back((char)sizeof...(Args));
+    encodeArgList(buf, args...);
+}
+
+/**
+ * @brief 获取当前线程的参数编码缓冲区
+ * @return 缓冲区
+ */
+std::string& getArgBuffer();
+
+/**
+ * @brief 日志记录(解码结果, 指向原始数据)
+ */
+struct RecordView
+{
+    uint32_t siteId; /* 调用处ID */
+    int tid; /* 线程ID */
+    int64_t timeUs; /* 时间戳(微秒) */
+    const char* tag; /* 标签 */
+    size_t tagLen; /* 标签长度 */
+    const char* args; /* 编码后的参数列表 */
+    size_t argsLen; /* 参数列表长度 */
+};
+
+/**
+ * @brief 编码日志记录, 格式: 调用处ID(uint32) + 线程ID(int32) + 时间戳(int64, 微秒) + 标签长度(uint16) + 标签 + 参数列表
+ * @param buf [输出]编码结果
+ * @param siteId 调用处ID
+ * @param tid 线程ID
+ * @param timeUs 时间戳(微秒)
+ * @param tag 标签
+ * @param args 编码后的参数列表
+ * @param argsLen 参数列表长度
+ */
+void encodeRecord(std::string& buf, uint32_t siteId, int tid, int64_t timeUs, const std::string& tag, const char* args, size_t argsLen);
+
+/**
+ * @brief 解码日志记录
+ * @param data 数据
+ * @param size 数据长度
+ * @param view [输出]日志记录
+ * @return true-成功, false-数据不完整
+ */
+bool decodeRecord(const char* data, size_t size, RecordView& view);
+
+/**
+ * @brief 使用编码后的参数列表格式化日志消息
+ * @param format 格式串
+ * @param args 编码后的参数列表
+ * @param argsLen 参数列表长度
+ * @param msg [输出]日志消息, 格式化失败时为错误描述
+ * @return true-成功, false-失败
+ */
+bool formatArgs(const char* format, const char* args, size_t argsLen, std::string& msg);
+
+/**
+ * @brief 格式化日志记录为日志行(追加到缓冲区), 格式同文本模式
+ * @param buf [输出]缓冲区
+ * @param level 日志等级
+ * @param pid 进程ID
+ * @param view 日志记录
+ * @param file 文件名
+ * @param line 行号
+ * @param func 函数名
+ * @param format 格式串
+ * @return 日志行长度
+ */
+size_t appendRecordLine(std::string& buf, int level, int pid, const RecordView& view, const char* file, int line, const char* func,
+                        const char* format);
+
+/**
+ * @brief 追加帧(帧头 + 帧内容)到缓冲区
+ * @param buf [输出]缓冲区
+ * @param type 帧类型
+ * @param level 日志等级
+ * @param data 帧内容
+ * @param size 帧内容长度
+ */
+void appendFrame(std::string& buf, uint8_t type, int level, const char* data, size_t size);
+
+/**
+ * @brief 追加会话帧到缓冲区
+ * @param buf [输出]缓冲区
+ * @param pid 进程ID
+ */
+void appendSessionFrame(std::string& buf, int pid);
+
+/**
+ * @brief 追加调用处帧到缓冲区
+ * @param buf [输出]缓冲区
+ * @param site 调用处
+ */
+void appendSiteFrame(std::string& buf, const LogSite& site);
+} // namespace binlog
+} // namespace logger
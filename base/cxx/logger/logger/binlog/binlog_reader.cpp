@@ -0,0 +1,148 @@
+#include "binlog_reader.h"
+
+#include <errno.h>
+#include <string.h>
+
+namespace logger
+{
+namespace binlog
+{
+static const uint32_t MAX_FRAME_SIZE = 64 * 1024 * 1024; /* 帧内容最大长度(超过认为文件已损坏) */
+
+BinlogReader::~BinlogReader()
+{
+    close();
+}
+
+bool BinlogReader::open(const std::string& fullName, std::string* errDesc)
+{
+    close();
+    m_f = fopen(fullName.c_str(), "rb");
+    if (!m_f)
+    {
+        if (errDesc)
+        {
+            *errDesc = "open file [" + fullName + "] fail, errno[" + std::to_string(errno) + "], desc: " + strerror(errno);
+        }
+        return false;
+    }
+    FrameHead head;
+    if (!readFrame(head) || FRAME_SESSION != head.type || m_payload.size() < sizeof(MAGIC) + 8
+        || 0 != memcmp(m_payload.data(), MAGIC, sizeof(MAGIC)))
+    {
+        if (errDesc)
+        {
+            *errDesc = "file [" + fullName + "] is not a binary log file";
+        }
+        close();
+        return false;
+    }
+    memcpy(&m_pid, m_payload.data() + sizeof(MAGIC) + 4, sizeof(m_pid));
+    return true;
+}
+
+void BinlogReader::close()
+{
+    if (m_f)
+    {
+        fclose(m_f);
+        m_f = nullptr;
+    }
+    m_payload.clear();
+    m_pid = 0;
+    m_siteMap.clear();
+}
+
+bool BinlogReader::next(int& level, std::string& line)
+{
+    FrameHead head;
+    while (readFrame(head))
+    {
+        switch (head.type)
+        {
+        case FRAME_SESSION: /* 新的会话(进程重启后追加写入), 调用处ID重新分配 */
+            m_siteMap.clear();
+            if (m_payload.size() >= sizeof(MAGIC) + 8)
+            {
+                memcpy(&m_pid, m_payload.data() + sizeof(MAGIC) + 4, sizeof(m_pid));
+            }
+            break;
+        case FRAME_SITE:
+            parseSite();
+            break;
+        case FRAME_TEXT:
+            level = head.level;
+            line.assign(m_payload.data(), m_payload.size());
+            return true;
+        case FRAME_RECORD: {
+            RecordView view;
+            if (!decodeRecord(m_payload.data(), m_payload.size(), view))
+            {
+                ++m_errorCount;
+                break;
+            }
+            level = head.level;
+            line.clear();
+            auto iter = m_siteMap.find(view.siteId);
+            if (m_siteMap.end() == iter)
+            {
+                ++m_errorCount;
+                const std::string format = "[binlog] unknown site " + std::to_string(view.siteId);
+                appendRecordLine(line, level, m_pid, view, "", 0, "", format.c_str());
+            }
+            else
+            {
+                const auto& site = iter->second;
+                appendRecordLine(line, level, m_pid, view, site.file.c_str(), site.line, site.func.c_str(), site.format.c_str());
+            }
+            return true;
+        }
+        }
+    }
+    return false;
+}
+
+size_t BinlogReader::getErrorCount() const
+{
+    return m_errorCount;
+}
+
+bool BinlogReader::readFrame(FrameHead& head)
+{
+    if (!m_f || 1 != fread(&head, sizeof(head), 1, m_f) || head.size > MAX_FRAME_SIZE)
+    {
+        return false;
+    }
+    m_payload.resize(head.size);
+    return (0 == head.size || 1 == fread(m_payload.data(), head.size, 1, m_f));
+}
+
+void BinlogReader::parseSite()
+{
+    uint32_t id = 0, formatLen = 0;
+    int32_t line = 0;
+    uint16_t fileLen = 0, funcLen = 0;
+    const size_t headLen = sizeof(id) + sizeof(line) + sizeof(fileLen) + sizeof(funcLen) + sizeof(formatLen);
+    if (m_payload.size() < headLen)
+    {
+        return;
+    }
+    const char* p = m_payload.data();
+    memcpy(&id, p, sizeof(id));
+    memcpy(&line, p + 4, sizeof(line));
+    memcpy(&fileLen, p + 8, sizeof(fileLen));
+    memcpy(&funcLen, p + 10, sizeof(funcLen));
+    memcpy(&formatLen, p + 12, sizeof(formatLen));
+    if (m_payload.size() < headLen + fileLen + funcLen + formatLen)
+    {
+        return;
+    }
+    p += headLen;
+    auto& site = m_siteMap[id];
+    site.file.assign(p, fileLen);
+    site.line = line;
+    site.func.assign(p + fileLen, funcLen);
+    site.format.assign(p + fileLen + funcLen, formatLen);
+}
+} // namespace binlog
+} // namespace logger
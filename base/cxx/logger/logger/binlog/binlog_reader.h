@@ -0,0 +1,83 @@
+#pragma once
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "binlog.h"
+
+namespace logger
+{
+namespace binlog
+{
+/**
+ * @brief 二进制日志文件读取器(把日志帧解码为文本日志行, 格式同文本模式)
+ */
+class BinlogReader final
+{
+public:
+    BinlogReader() = default;
+    ~BinlogReader();
+    BinlogReader(const BinlogReader& src) = delete;
+    BinlogReader& operator=(const BinlogReader& src) = delete;
+
+    /**
+     * @brief 打开文件
+     * @param fullName 文件全名
+     * @param errDesc [输出]错误描述(选填)
+     * @return true-成功, false-失败(文件不存在或不是二进制日志文件)
+     */
+    bool open(const std::string& fullName, std::string* errDesc = nullptr);
+
+    /**
+     * @brief 关闭文件
+     */
+    void close();
+
+    /**
+     * @brief 读取下一条日志
+     * @param level [输出]日志等级
+     * @param line [输出]日志行(包含换行符)
+     * @return true-成功, false-文件结束(文件尾部不完整的帧被忽略)
+     */
+    bool next(int& level, std::string& line);
+
+    /**
+     * @brief 获取无法解码的日志数量(调用处未定义)
+     * @return 数量
+     */
+    size_t getErrorCount() const;
+
+private:
+    /**
+     * @brief 调用处信息
+     */
+    struct SiteInfo
+    {
+        std::string file; /* 文件名 */
+        int line = 0; /* 行号 */
+        std::string func; /* 函数名 */
+        std::string format; /* 格式串 */
+    };
+
+    /**
+     * @brief 读取下一帧
+     * @param head [输出]帧头
+     * @return true-成功, false-文件结束
+     */
+    bool readFrame(FrameHead& head);
+
+    /**
+     * @brief 解析调用处帧
+     */
+    void parseSite();
+
+private:
+    FILE* m_f = nullptr; /* 文件指针 */
+    std::vector<char> m_payload; /* 当前帧内容 */
+    int m_pid = 0; /* 当前会话的进程ID */
+    std::unordered_map<uint32_t, SiteInfo> m_siteMap; /* 当前会话的调用处表 */
+    size_t m_errorCount = 0; /* 无法解码的日志数量 */
+};
+} // namespace binlog
+} // namespace logger
@@ -0,0 +1,451 @@
+#include "async_log_writer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "../logger_define.h"
+
+namespace logger
+{
+static const uint64_t BUSY_FLAG = (1ULL << 63); /* 读位置的忙标识(后台线程正在回调缓冲区中的日志) */
+static const size_t MIN_BUFFER_SIZE = 64 * 1024; /* 线程缓冲区最小长度 */
+static const int IDLE_WAIT_MS = 50; /* 后台线程空闲时的最长等待时间(毫秒) */
+
+/**
+ * @brief 缓冲区中的日志头部(每条日志按8字节对齐)
+ */
+struct RecordHead
+{
+    uint32_t size; /* 内容长度 */
+    int8_t level; /* 日志等级 */
+    uint8_t type; /* 记录类型 */
+    uint8_t consoleMode; /* 控制台日志输出模式 */
+    uint8_t isPad; /* 是否为填充(缓冲区尾部不足以存放日志时, 跳到头部) */
+};
+
+static const size_t HEAD_SIZE = sizeof(RecordHead);
+
+inline size_t align8(size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+inline size_t roundUpPow2(size_t size)
+{
+    size_t value = MIN_BUFFER_SIZE;
+    while (value < size)
+    {
+        value <<= 1;
+    }
+    return value;
+}
+
+/**
+ * @brief 退避等待(先让出CPU, 仍未就绪则短暂休眠)
+ * @param spin 已等待的次数
+ */
+inline void backoff(int spin)
+{
+    if (spin < 64)
+    {
+        std::this_thread::yield();
+    }
+    else
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+/**
+ * @brief 线程缓冲区(单生产者单消费者), 读/写位置单调递增, 对容量取模得到偏移
+ */
+struct AsyncLogWriter::Ring
+{
+    explicit Ring(size_t capacity) : storage(capacity / sizeof(uint64_t)), mask(capacity - 1) {}
+
+    char* at(uint64_t pos)
+    {
+        return (char*)storage.data() + (pos & mask);
+    }
+
+    std::vector<uint64_t> storage; /* 存储区(保证8字节对齐) */
+    const size_t mask; /* 偏移掩码(容量 - 1) */
+    char pad1[64]; /* 避免读/写位置伪共享 */
+    std::atomic<uint64_t> head{0}; /* 读位置(后台线程更新, 丢弃最早日志时生产线程也会更新), 最高位为忙标识 */
+    char pad2[64];
+    std::atomic<uint64_t> tail{0}; /* 写位置(生产线程更新) */
+    std::atomic_bool closed{false}; /* 所属线程已退出 */
+    std::atomic_bool orphan{false}; /* 所属写入器已销毁 */
+};
+
+/**
+ * @brief 写入器注册表(用于进程退出时刷新)
+ */
+struct WriterRegistry
+{
+    std::mutex mutex;
+    std::vector<AsyncLogWriter*> writerList;
+};
+
+static WriterRegistry& getWriterRegistry()
+{
+    static auto s_registry = new WriterRegistry(); /* 不释放, 静态对象(如日志记录器映射表)析构时仍可访问 */
+    return *s_registry;
+}
+
+AsyncLogWriter::AsyncLogWriter(size_t bufferSize, int overflow, const RECORD_CALLBACK& recordCb, const FLUSH_CALLBACK& flushCb)
+    : m_id([]() {
+        static std::atomic<uint64_t> s_id{0};
+        return ++s_id;
+    }())
+    , m_bufferSize(roundUpPow2(bufferSize))
+    , m_overflow(overflow)
+    , m_recordCb(recordCb)
+    , m_flushCb(flushCb)
+{
+    auto& registry = getWriterRegistry();
+    static std::once_flag s_onceFlag;
+    std::call_once(s_onceFlag, []() { atexit(&AsyncLogWriter::flushAll); });
+    {
+        std::lock_guard<std::mutex> locker(registry.mutex);
+        registry.writerList.emplace_back(this);
+    }
+    m_thread = std::thread([this]() { run(); });
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    {
+        auto& registry = getWriterRegistry();
+        std::lock_guard<std::mutex> locker(registry.mutex);
+        for (auto iter = registry.writerList.begin(); registry.writerList.end() != iter; ++iter)
+        {
+            if (this == *iter)
+            {
+                registry.writerList.erase(iter);
+                break;
+            }
+        }
+    }
+    m_stop = true;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_wakeup = true;
+        m_cv.notify_one();
+    }
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    std::lock_guard<std::mutex> locker(m_mutexRing);
+    for (const auto& ring : m_ringList)
+    {
+        ring->orphan = true;
+    }
+}
+
+bool AsyncLogWriter::push(int type, int level, int consoleMode, const char* data, size_t size, bool urgent)
+{
+    Ring* ring = getThreadRing();
+    const size_t capacity = ring->mask + 1;
+    const size_t needLen = HEAD_SIZE + align8(size);
+    const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (needLen > capacity / 2) /* 超长日志: 等待本线程缓冲区清空后直接回调, 保证本线程日志的顺序 */
+    {
+        for (int spin = 0; (ring->head.load(std::memory_order_acquire) & ~BUSY_FLAG) != tail; ++spin)
+        {
+            wakeup();
+            backoff(spin);
+        }
+        const AsyncRecord record = {type, level, consoleMode, data, size};
+        std::lock_guard<std::mutex> locker(m_mutexRecord);
+        m_recordCb(&record, 1);
+        return true;
+    }
+    const size_t offset = (size_t)(tail & ring->mask);
+    const size_t padLen = (capacity - offset < needLen) ? capacity - offset : 0; /* 尾部空间不足时填充到缓冲区末尾 */
+    for (int spin = 0;; ++spin)
+    {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t readPos = (head & ~BUSY_FLAG);
+        if (tail + padLen + needLen - readPos <= capacity)
+        {
+            break;
+        }
+        if (ASYNC_OVERFLOW_BLOCK == m_overflow)
+        {
+            wakeup();
+            backoff(spin);
+            continue;
+        }
+        if (ASYNC_OVERFLOW_DROP_OLDEST == m_overflow && 0 == (head & BUSY_FLAG)) /* 后台线程未在读取时, 丢弃最早的1条日志 */
+        {
+            const auto oldest = (const RecordHead*)ring->at(readPos);
+            const bool isPad = (0 != oldest->isPad);
+            const uint64_t nextPos = readPos + HEAD_SIZE + align8(oldest->size);
+            if (ring->head.compare_exchange_weak(head, nextPos, std::memory_order_acq_rel) && !isPad)
+            {
+                ++m_dropCount;
+            }
+            continue;
+        }
+        ++m_dropCount;
+        wakeup();
+        return false;
+    }
+    if (padLen > 0)
+    {
+        auto pad = (RecordHead*)ring->at(tail);
+        pad->size = (uint32_t)(padLen - HEAD_SIZE);
+        pad->isPad = 1;
+    }
+    const uint64_t pos = tail + padLen;
+    auto recordHead = (RecordHead*)ring->at(pos);
+    recordHead->size = (uint32_t)size;
+    recordHead->level = (int8_t)level;
+    recordHead->type = (uint8_t)type;
+    recordHead->consoleMode = (uint8_t)consoleMode;
+    recordHead->isPad = 0;
+    memcpy(ring->at(pos) + HEAD_SIZE, data, size);
+    ring->tail.store(pos + needLen, std::memory_order_release);
+    if (urgent || pos + needLen - (ring->head.load(std::memory_order_relaxed) & ~BUSY_FLAG) > capacity / 2)
+    {
+        wakeup();
+    }
+    return true;
+}
+
+void AsyncLogWriter::flush()
+{
+    if (std::this_thread::get_id() == m_thread.get_id()) /* 在回调中调用, 避免死锁 */
+    {
+        return;
+    }
+    const uint64_t request = ++m_flushRequest;
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_wakeup = true;
+    m_cv.notify_one();
+    m_cvFlush.wait(locker, [&]() { return m_flushDone >= request; });
+}
+
+uint64_t AsyncLogWriter::getDropCount() const
+{
+    return m_dropCount;
+}
+
+void AsyncLogWriter::flushAll()
+{
+    auto& registry = getWriterRegistry();
+    std::lock_guard<std::mutex> locker(registry.mutex);
+    for (auto writer : registry.writerList)
+    {
+        writer->flush();
+    }
+}
+
+AsyncLogWriter::Ring* AsyncLogWriter::getThreadRing()
+{
+    struct ThreadRingList
+    {
+        ~ThreadRingList()
+        {
+            for (const auto& item : ringList)
+            {
+                item.second->closed.store(true, std::memory_order_release);
+            }
+        }
+
+        std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> ringList; /* key-写入器ID, value-缓冲区 */
+        uint64_t lastId = 0; /* 最近使用的写入器ID */
+        Ring* lastRing = nullptr; /* 最近使用的缓冲区 */
+    };
+    static thread_local ThreadRingList threadRings;
+    if (m_id == threadRings.lastId)
+    {
+        return threadRings.lastRing;
+    }
+    Ring* ring = nullptr;
+    for (auto iter = threadRings.ringList.begin(); threadRings.ringList.end() != iter;)
+    {
+        if (m_id == iter->first)
+        {
+            ring = iter->second.get();
+            ++iter;
+        }
+        else if (iter->second->orphan) /* 清理已销毁的写入器的缓冲区 */
+        {
+            iter = threadRings.ringList.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    if (!ring)
+    {
+        auto newRing = std::make_shared<Ring>(m_bufferSize);
+        {
+            std::lock_guard<std::mutex> locker(m_mutexRing);
+            m_ringList.emplace_back(newRing);
+            ++m_ringVersion;
+        }
+        threadRings.ringList.emplace_back(m_id, newRing);
+        ring = newRing.get();
+    }
+    threadRings.lastId = m_id;
+    threadRings.lastRing = ring;
+    return ring;
+}
+
+void AsyncLogWriter::wakeup()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst); /* 和后台线程进入等待前的检查配对, 避免丢失唤醒 */
+    if (m_sleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_wakeup = true;
+        m_cv.notify_one();
+    }
+}
+
+void AsyncLogWriter::run()
+{
+    std::vector<std::shared_ptr<Ring>> ringList;
+    uint64_t ringVersion = UINT64_MAX;
+    uint64_t flushDone = 0;
+    while (true)
+    {
+        const uint64_t flushRequest = m_flushRequest.load(std::memory_order_acquire);
+        const bool stop = m_stop.load(std::memory_order_acquire);
+        if (ringVersion != m_ringVersion.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> locker(m_mutexRing);
+            ringList = m_ringList;
+            ringVersion = m_ringVersion;
+        }
+        /* 1.取出所有缓冲区中的日志 */
+        const size_t count = drain(ringList);
+        bool hasClosed = false;
+        for (const auto& ring : ringList)
+        {
+            if (ring->closed.load(std::memory_order_acquire)
+                && ring->tail.load(std::memory_order_acquire) == ring->head.load(std::memory_order_acquire))
+            {
+                hasClosed = true;
+            }
+        }
+        /* 2.移除已退出线程的缓冲区 */
+        if (hasClosed)
+        {
+            std::lock_guard<std::mutex> locker(m_mutexRing);
+            for (auto iter = m_ringList.begin(); m_ringList.end() != iter;)
+            {
+                const auto& ring = *iter;
+                if (ring->closed.load(std::memory_order_acquire)
+                    && ring->tail.load(std::memory_order_acquire) == ring->head.load(std::memory_order_acquire))
+                {
+                    ring->orphan = true;
+                    iter = m_ringList.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+            ++m_ringVersion;
+        }
+        /* 3.处理刷新请求(请求之前写入的日志在本轮已全部取出) */
+        if (flushRequest > flushDone)
+        {
+            if (m_flushCb)
+            {
+                m_flushCb();
+            }
+            flushDone = flushRequest;
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_flushDone = flushDone;
+            m_cvFlush.notify_all();
+        }
+        if (stop && 0 == count)
+        {
+            break;
+        }
+        if (count > 0)
+        {
+            continue;
+        }
+        /* 4.空闲等待, 进入等待前再检查一次缓冲区 */
+        m_sleeping.store(true, std::memory_order_seq_cst);
+        bool pending = false;
+        for (const auto& ring : ringList)
+        {
+            if (ring->tail.load(std::memory_order_seq_cst) != (ring->head.load(std::memory_order_relaxed) & ~BUSY_FLAG))
+            {
+                pending = true;
+                break;
+            }
+        }
+        if (!pending)
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_cv.wait_for(locker, std::chrono::milliseconds(IDLE_WAIT_MS), [&]() { return m_wakeup; });
+            m_wakeup = false;
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+    if (m_flushCb)
+    {
+        m_flushCb();
+    }
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_flushDone = UINT64_MAX;
+    m_cvFlush.notify_all();
+}
+
+size_t AsyncLogWriter::drain(const std::vector<std::shared_ptr<Ring>>& ringList)
+{
+    std::lock_guard<std::mutex> locker(m_mutexRecord);
+    m_recordList.clear();
+    m_claimList.clear();
+    for (const auto& ring : ringList)
+    {
+        /* 设置忙标识, 回调期间生产线程不能丢弃缓冲区中的日志 */
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        bool empty = false;
+        do
+        {
+            if (ring->tail.load(std::memory_order_acquire) == head)
+            {
+                empty = true;
+                break;
+            }
+        } while (!ring->head.compare_exchange_weak(head, head | BUSY_FLAG, std::memory_order_acq_rel));
+        if (empty)
+        {
+            continue;
+        }
+        const uint64_t tail = ring->tail.load(std::memory_order_acquire);
+        for (uint64_t pos = head; pos < tail;)
+        {
+            const auto recordHead = (const RecordHead*)ring->at(pos);
+            if (0 == recordHead->isPad)
+            {
+                m_recordList.push_back(
+                    {recordHead->type, recordHead->level, recordHead->consoleMode, ring->at(pos) + HEAD_SIZE, recordHead->size});
+            }
+            pos += HEAD_SIZE + align8(recordHead->size);
+        }
+        m_claimList.emplace_back(ring.get(), tail);
+    }
+    if (!m_recordList.empty())
+    {
+        m_recordCb(m_recordList.data(), m_recordList.size());
+    }
+    for (const auto& claim : m_claimList) /* 释放已回调的空间(同时清除忙标识) */
+    {
+        claim.first->head.store(claim.second, std::memory_order_release);
+    }
+    return m_recordList.size();
+}
+} // namespace logger
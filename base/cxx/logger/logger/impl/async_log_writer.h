@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace logger
+{
+/**
+ * @brief 异步日志记录类型
+ */
+const int RECORD_TEXT = 0; /* 已格式化的日志行 */
+const int RECORD_DEFERRED = 1; /* 延迟格式化的日志记录(格式见binlog::encodeRecord) */
+
+/**
+ * @brief 异步日志记录
+ */
+struct AsyncRecord
+{
+    int type; /* 记录类型 */
+    int level; /* 日志等级 */
+    int consoleMode; /* 控制台日志输出模式 */
+    const char* data; /* 日志内容(指向线程缓冲区, 只在回调期间有效) */
+    size_t size; /* 日志内容长度 */
+};
+
+/**
+ * @brief 异步日志写入器, 说明:
+ *        1.每个生产线程拥有独立的环形缓冲区(单生产者单消费者, 无锁), 日志写入时只拷贝一次内容
+ *        2.后台线程按批次取出各线程缓冲区中的日志, 在缓冲区上直接回调(零拷贝), 回调中可合并为一次writev
+ *        3.同一线程的日志保持顺序, 不同线程之间的日志不保证严格按时间排序
+ */
+class AsyncLogWriter final
+{
+public:
+    /**
+     * @brief 批量记录回调(在后台线程中调用)
+     * @param recordList 日志记录列表
+     * @param recordCount 日志记录数量
+     */
+    using RECORD_CALLBACK = std::function<void(const AsyncRecord* recordList, size_t recordCount)>;
+
+    /**
+     * @brief 刷新回调(在后台线程中调用, 此前所有的日志已回调)
+     */
+    using FLUSH_CALLBACK = std::function<void()>;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param bufferSize 每个线程的缓冲区大小(字节), 向上取整为2的幂
+     * @param overflow 缓冲区满时的处理策略, 值: ASYNC_OVERFLOW_BLOCK, ASYNC_OVERFLOW_DROP_OLDEST, ASYNC_OVERFLOW_DROP_NEW
+     * @param recordCb 批量记录回调
+     * @param flushCb 刷新回调
+     */
+    AsyncLogWriter(size_t bufferSize, int overflow, const RECORD_CALLBACK& recordCb, const FLUSH_CALLBACK& flushCb);
+
+    /**
+     * @brief 析构函数(写入缓冲区中剩余的日志后停止后台线程)
+     */
+    ~AsyncLogWriter();
+
+    AsyncLogWriter(const AsyncLogWriter& src) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter& src) = delete;
+
+    /**
+     * @brief 写入日志到当前线程的缓冲区
+     * @param type 记录类型, 值: RECORD_TEXT, RECORD_DEFERRED
+     * @param level 日志等级
+     * @param consoleMode 控制台日志输出模式
+     * @param data 日志内容
+     * @param size 日志内容长度
+     * @param urgent 是否立即唤醒后台线程
+     * @return true-成功, false-被丢弃
+     */
+    bool push(int type, int level, int consoleMode, const char* data, size_t size, bool urgent);
+
+    /**
+     * @brief 刷新(阻塞直到调用之前写入的日志全部回调, 且刷新回调执行完毕)
+     */
+    void flush();
+
+    /**
+     * @brief 获取被丢弃的日志数量
+     * @return 丢弃数量
+     */
+    uint64_t getDropCount() const;
+
+    /**
+     * @brief 刷新所有的异步日志写入器(进程退出时调用)
+     */
+    static void flushAll();
+
+private:
+    struct Ring;
+
+    /**
+     * @brief 获取当前线程的缓冲区(首次调用时创建并注册)
+     * @return 缓冲区
+     */
+    Ring* getThreadRing();
+
+    /**
+     * @brief 唤醒后台线程
+     */
+    void wakeup();
+
+    /**
+     * @brief 后台线程
+     */
+    void run();
+
+    /**
+     * @brief 取出各个缓冲区中当前所有的日志并合并为一次回调
+     * @param ringList 缓冲区列表
+     * @return 日志数量
+     */
+    size_t drain(const std::vector<std::shared_ptr<Ring>>& ringList);
+
+private:
+    const uint64_t m_id; /* 写入器ID(用于线程缓冲区查找, 避免地址复用) */
+    const size_t m_bufferSize; /* 每个线程的缓冲区大小 */
+    const int m_overflow; /* 缓冲区满时的处理策略 */
+    const RECORD_CALLBACK m_recordCb; /* 批量记录回调 */
+    const FLUSH_CALLBACK m_flushCb; /* 刷新回调 */
+    std::mutex m_mutexRing;
+    std::vector<std::shared_ptr<Ring>> m_ringList; /* 所有线程的缓冲区 */
+    std::atomic<uint64_t> m_ringVersion{0}; /* 缓冲区列表版本(列表变化时递增) */
+    std::mutex m_mutexRecord; /* 回调锁(后台线程和超长日志直接回调之间互斥) */
+    std::vector<AsyncRecord> m_recordList; /* 回调的日志记录列表(复用) */
+    std::vector<std::pair<Ring*, uint64_t>> m_claimList; /* 本次回调占用的缓冲区及其写位置(复用) */
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic_bool m_sleeping{false}; /* 后台线程是否在等待 */
+    bool m_wakeup = false; /* 唤醒标识 */
+    uint64_t m_flushDone = 0; /* 已完成的刷新请求序号 */
+    std::condition_variable m_cvFlush;
+    std::atomic<uint64_t> m_flushRequest{0}; /* 刷新请求序号 */
+    std::atomic<uint64_t> m_dropCount{0}; /* 丢弃的日志数量 */
+    std::atomic_bool m_stop{false}; /* 是否停止 */
+    std::thread m_thread; /* 后台线程 */
+};
+} // namespace logger
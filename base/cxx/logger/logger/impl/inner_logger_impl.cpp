@@ -1,5 +1,6 @@
 #include "inner_logger_impl.h"
 
+#include <algorithm>
 #include <fmt/color.h>
 #include <thread>
 #ifdef _WIN32
@@ -7,10 +8,12 @@
 #include <process.h>
 #else
 #include <sys/syscall.h>
-#include <sys/time.h>
 #include <unistd.h>
 #endif
 
+#include "../binlog/binlog.h"
+#include "log_line.h"
+
 namespace logger
 {
 inline int getProcessId()
@@ -25,91 +28,11 @@ inline int getProcessId()
 inline int getThreadId()
 {
 #ifdef _WIN32
-    return GetCurrentThreadId();
-#else
-    return syscall(__NR_gettid);
-#endif
-}
-
-struct DateTime
-{
-    char ymd[12]; /* 年月日 */
-    char hms[12]; /* 时分秒 */
-    char ms[4]; /* 毫秒 */
-};
-
-inline DateTime& getDateTime()
-{
-    static thread_local DateTime dt;
-    static thread_local uint64_t lastMs = 0;
-#ifdef _WIN32
-    struct timeval /* Windows平台补充timeval结构体定义 */
-    {
-        long tv_sec; /* 秒 */
-        long tv_usec; /* 微秒 */
-    };
-#endif
-    time_t sec; /* 秒 */
-    int ms = 0; /* 毫秒 */
-#ifdef _WIN32
-    SYSTEMTIME st;
-    GetLocalTime(&st);
-    sec = time(nullptr);
-    ms = st.wMilliseconds;
-#else
-    struct timeval tv;
-    gettimeofday(&tv, nullptr);
-    sec = tv.tv_sec;
-    ms = tv.tv_usec / 1000;
-#endif
-    uint64_t nowMs = (uint64_t)(sec)*1000 + ms;
-    if (nowMs != lastMs)
-    {
-        lastMs = nowMs;
-        struct tm t;
-#ifdef _WIN32
-        localtime_s(&t, &sec);
+    static thread_local int tid = GetCurrentThreadId();
 #else
-        localtime_r(&sec, &t);
+    static thread_local int tid = syscall(__NR_gettid);
 #endif
-        /* 手动格式化, 避免strftime */
-        auto itoa2 = [](int v, char* p) {
-            *p = (char)('0' + v / 10);
-            *(p + 1) = (char)('0' + v % 10);
-        };
-        auto itoa4 = [](int v, char* p) {
-            *(p + 3) = (char)('0' + v % 10);
-            v /= 10;
-            *(p + 2) = (char)('0' + v % 10);
-            v /= 10;
-            *(p + 1) = (char)('0' + v % 10);
-            v /= 10;
-            *p = (char)('0' + v);
-        };
-        itoa4(t.tm_year + 1900, dt.ymd);
-        dt.ymd[4] = '-';
-        itoa2(t.tm_mon + 1, dt.ymd + 5);
-        dt.ymd[7] = '-';
-        itoa2(t.tm_mday, dt.ymd + 8);
-        dt.ymd[10] = '\0';
-        itoa2(t.tm_hour, dt.hms);
-        dt.hms[2] = ':';
-        itoa2(t.tm_min, dt.hms + 3);
-        dt.hms[5] = ':';
-        itoa2(t.tm_sec, dt.hms + 6);
-        dt.hms[8] = '\0';
-        dt.ms[0] = (char)('0' + ms / 100);
-        dt.ms[1] = (char)('0' + (ms / 10) % 10);
-        dt.ms[2] = (char)('0' + ms % 10);
-        dt.ms[3] = '\0';
-    }
-    return dt;
-}
-
-inline char getLevelShortName(int level)
-{
-    static const char LEVEL_NAME[] = "TDIWEF";
-    return (level >= 0 && level <= 5) ? LEVEL_NAME[level] : (char)('0' + level);
+    return tid;
 }
 
 inline fmt::v7::text_style getLevelTextStyle(const int level)
@@ -125,63 +48,6 @@ inline fmt::v7::text_style getLevelTextStyle(const int level)
     return (level >= 0 && level <= 5) ? LEVEL_STYLES[level] : fmt::v7::fg(fmt::v7::color::white);
 }
 
-inline void appendChar(char*& p, char c)
-{
-    *p++ = c;
-}
-
-inline void appendString(char*& p, const char* s, size_t n)
-{
-    memcpy(p, s, n);
-    p += n;
-}
-
-inline void appendInt(char*& p, int v)
-{
-    if (0 == v)
-    {
-        *p++ = '0';
-        return;
-    }
-    if (v < 0)
-    {
-        *p++ = '-';
-        v = -v;
-    }
-    if (v < 1000) /* 小整数展开 */
-    {
-        if (v >= 100)
-        {
-            *p++ = (char)('0' + v / 100);
-            v %= 100;
-            *p++ = (char)('0' + v / 10);
-            *p++ = (char)('0' + v % 10);
-        }
-        else if (v >= 10)
-        {
-            *p++ = (char)('0' + v / 10);
-            *p++ = (char)('0' + v % 10);
-        }
-        else
-        {
-            *p++ = (char)('0' + v);
-        }
-        return;
-    }
-    /* 大整数通用实现 */
-    char tmp[16];
-    int i = 0;
-    while (v > 0)
-    {
-        tmp[i++] = (char)('0' + (v % 10));
-        v /= 10;
-    }
-    while (i--)
-    {
-        *p++ = tmp[i];
-    }
-}
-
 InnerLoggerImpl::InnerLoggerImpl(const LogConfig& cfg) : InnerLogger(cfg.path, cfg.name)
 {
     if (!cfg.path.empty())
@@ -200,6 +66,12 @@ InnerLoggerImpl::InnerLoggerImpl(const LogConfig& cfg) : InnerLogger(cfg.path, c
                                                          cfg.fileIndexFixed, cfg.newFolderDaily);
         m_dailyLogFatal = std::make_shared<DailyLogfile>(cfg.path, cfg.name, "_fatal", cfg.fileExtName, cfg.fileMaxSize, cfg.fileMaxCount,
                                                          cfg.fileIndexFixed, cfg.newFolderDaily);
+        for (const auto& dailyLog : {m_dailyLog, m_dailyLogTrace, m_dailyLogDebug, m_dailyLogInfo, m_dailyLogWarn, m_dailyLogError,
+                                     m_dailyLogFatal}) /* 滚动后的文件在后台压缩, 目录下已归档文件共享总大小预算 */
+        {
+            dailyLog->setCompressor(cfg.fileCompressor);
+            dailyLog->setMaxTotalSize(cfg.fileMaxTotalSize);
+        }
     }
     m_fileMaxSize = cfg.fileMaxSize;
     m_fileMaxCount = cfg.fileMaxCount;
@@ -210,6 +82,21 @@ InnerLoggerImpl::InnerLoggerImpl(const LogConfig& cfg) : InnerLogger(cfg.path, c
     }
     m_flushLevel = cfg.flushLevel;
     m_consoleMode = cfg.consoleMode;
+    m_formatMode = (cfg.formatMode >= FORMAT_IMMEDIATE && cfg.formatMode <= FORMAT_BINARY) ? cfg.formatMode : FORMAT_IMMEDIATE;
+    if (FORMAT_BINARY == m_formatMode && m_dailyLog) /* 二进制文件每次打开时写入会话帧和调用处表 */
+    {
+        m_dailyLog->setHeaderCallback([this]() { return makeBinaryHeader(); });
+    }
+    if (cfg.asyncMode || FORMAT_IMMEDIATE != m_formatMode) /* 延迟格式化需要由后台线程格式化 */
+    {
+        auto recordCb = [this](const AsyncRecord* recordList, size_t recordCount) { writeRecords(recordList, recordCount); };
+        m_asyncWriter = std::make_unique<AsyncLogWriter>(cfg.asyncBufferSize, cfg.asyncOverflow, recordCb, [this]() { flushFiles(); });
+    }
+}
+
+InnerLoggerImpl::~InnerLoggerImpl()
+{
+    m_asyncWriter.reset(); /* 先写入缓冲区中剩余的日志 */
 }
 
 size_t InnerLoggerImpl::getMaxSize()
@@ -351,71 +238,28 @@ void InnerLoggerImpl::print(int level, const std::string& tag, const char* file,
     }
     /* 静态缓存 */
     static const int PID = getProcessId();
-    static thread_local int TID = getThreadId();
     static thread_local std::vector<char> buffer;
     static thread_local size_t bufferCapacity = 0;
-    size_t totalLen = 512 + msgLen; /* 预计算总长度 */
+    auto fileLen = (file ? strlen(file) : 0);
+    auto funcLen = (func ? strlen(func) : 0);
+    size_t totalLen = getLineMaxLength(tag.size(), fileLen, funcLen, msgLen); /* 预计算总长度 */
     if (bufferCapacity < totalLen) /* 缓冲区扩容 */
     {
         buffer.reserve(totalLen);
         bufferCapacity = buffer.capacity();
     }
-    char* p = (char*)buffer.data();
     const auto& dt = getDateTime();
-    /* 级别 */
-    appendChar(p, getLevelShortName(level));
-    /* 时间, [YYYY-MM-DD HH:MM:SS.mmm] */
-    appendChar(p, '[');
-    appendString(p, dt.ymd, 10);
-    appendChar(p, ' ');
-    appendString(p, dt.hms, 8);
-    appendChar(p, '.');
-    appendString(p, dt.ms, 3);
-    appendChar(p, ']');
-    /* [进程:线程] */
-    appendChar(p, '[');
-    appendInt(p, PID);
-    appendChar(p, ':');
-    appendInt(p, TID);
-    appendChar(p, ']');
-    /* [标签] */
-    if (!tag.empty())
-    {
-        appendChar(p, '[');
-        appendString(p, tag.data(), tag.size());
-        appendChar(p, ']');
-    }
-    /* [文件名 函数名 行号] */
-    auto fileLen = (file ? strlen(file) : 0);
-    auto funcLen = (func ? strlen(func) : 0);
-    if (fileLen > 0 || funcLen > 0)
+    size_t bufLen = formatLine(buffer.data(), level, dt, PID, getThreadId(), tag.data(), tag.size(), file, line, func, msg, msgLen);
+    /* 异步模式: 写入线程缓冲区, 由后台线程写到文件和控制台 */
+    if (m_asyncWriter)
     {
-        appendChar(p, '[');
-        if (fileLen > 0)
-        {
-            appendString(p, file, fileLen);
-            if (funcLen > 0)
-            {
-                appendChar(p, ' ');
-            }
-        }
-        if (funcLen > 0)
+        m_asyncWriter->push(RECORD_TEXT, level, m_consoleMode, buffer.data(), bufLen, level >= m_flushLevel);
+        if (level >= LEVEL_FATAL) /* 致命日志等待写入完成, 避免程序随后终止导致日志丢失 */
         {
-            appendString(p, func, funcLen);
+            m_asyncWriter->flush();
         }
-        appendChar(p, ' ');
-        appendInt(p, line);
-        appendChar(p, ']');
-    }
-    /* 内容 */
-    if (msg && msgLen > 0)
-    {
-        appendChar(p, ' ');
-        appendString(p, msg, msgLen);
+        return;
     }
-    /* 换行符 */
-    appendChar(p, '\n');
-    size_t bufLen = p - buffer.data();
     /* 记录到文件 */
     auto dailyLog = getDailyLog(level);
     if (dailyLog)
@@ -424,22 +268,51 @@ void InnerLoggerImpl::print(int level, const std::string& tag, const char* file,
         dailyLog->record(buffer.data(), bufLen, false, immediateFlush);
     }
     /* 打印到控制台 */
-    if (1 == m_consoleMode)
+    printConsole(level, m_consoleMode, buffer.data(), bufLen);
+}
+
+void InnerLoggerImpl::print(int level, const std::string& tag, const char* file, int line, const char* func, const std::string& msg)
+{
+    print(level, tag, file, line, func, msg.data(), msg.size());
+}
+
+int InnerLoggerImpl::getFormatMode()
+{
+    return m_formatMode;
+}
+
+void InnerLoggerImpl::printDeferred(int level, const std::string& tag, const LogSite& site, const char* args, size_t argsLen)
+{
+    if (level < m_level.load(std::memory_order_relaxed) || !m_asyncWriter)
     {
-        fwrite(buffer.data(), 1, bufLen, stdout);
+        return;
     }
-    else if (2 == m_consoleMode)
+    static thread_local std::string record;
+    record.clear();
+    binlog::encodeRecord(record, site.id, getThreadId(), getTimestampUs(), tag, args, argsLen);
+    m_asyncWriter->push(RECORD_DEFERRED, level, m_consoleMode, record.data(), record.size(), level >= m_flushLevel);
+    if (level >= LEVEL_FATAL) /* 致命日志等待写入完成, 避免程序随后终止导致日志丢失 */
     {
-        fmt::print(getLevelTextStyle(level), "{}", fmt::v7::string_view(buffer.data(), bufLen));
+        m_asyncWriter->flush();
     }
 }
 
-void InnerLoggerImpl::print(int level, const std::string& tag, const char* file, int line, const char* func, const std::string& msg)
+void InnerLoggerImpl::forceFlush()
 {
-    print(level, tag, file, line, func, msg.data(), msg.size());
+    if (m_asyncWriter)
+    {
+        m_asyncWriter->flush();
+        return;
+    }
+    flushFiles();
 }
 
-void InnerLoggerImpl::forceFlush()
+uint64_t InnerLoggerImpl::getDropCount()
+{
+    return m_asyncWriter ? m_asyncWriter->getDropCount() : 0;
+}
+
+void InnerLoggerImpl::flushFiles()
 {
     if (m_dailyLog)
     {
@@ -499,4 +372,159 @@ std::shared_ptr<DailyLogfile> InnerLoggerImpl::getDailyLog(int level)
     }
     return m_dailyLog;
 }
+
+void InnerLoggerImpl::printConsole(int level, int consoleMode, const char* data, size_t size)
+{
+    if (1 == consoleMode)
+    {
+        fwrite(data, 1, size, stdout);
+    }
+    else if (2 == consoleMode)
+    {
+        fmt::print(getLevelTextStyle(level), "{}", fmt::v7::string_view(data, size));
+    }
+}
+
+size_t InnerLoggerImpl::appendDeferredLine(std::string& buf, const AsyncRecord& record)
+{
+    static const int PID = getProcessId();
+    binlog::RecordView view;
+    if (!binlog::decodeRecord(record.data, record.size, view))
+    {
+        return 0;
+    }
+    const auto site = LogSite::find(view.siteId);
+    if (!site)
+    {
+        return 0;
+    }
+    return binlog::appendRecordLine(buf, record.level, PID, view, site->file, site->line, site->func, site->format);
+}
+
+std::string InnerLoggerImpl::makeBinaryHeader()
+{
+    std::string header;
+    binlog::appendSessionFrame(header, getProcessId());
+    const uint32_t siteCount = LogSite::getCount();
+    for (uint32_t id = 0; id < siteCount; ++id)
+    {
+        binlog::appendSiteFrame(header, *LogSite::find(id));
+    }
+    m_siteWritten = siteCount;
+    return header;
+}
+
+void InnerLoggerImpl::writeRecords(const AsyncRecord* recordList, size_t recordCount)
+{
+    if (FORMAT_BINARY == m_formatMode)
+    {
+        writeBinaryRecords(recordList, recordCount);
+        return;
+    }
+    /* 先格式化延迟格式化的日志, 日志行依次存放在格式化缓冲区中 */
+    m_formatBuffer.clear();
+    m_lineSizeList.clear();
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        if (RECORD_DEFERRED == recordList[i].type)
+        {
+            m_lineSizeList.push_back(appendDeferredLine(m_formatBuffer, recordList[i]));
+        }
+    }
+    std::shared_ptr<DailyLogfile> levelLogList[LEVEL_FATAL + 1]; /* 本批次各等级对应的日志文件(避免每条日志都查找) */
+    bool levelResolved[LEVEL_FATAL + 1] = {false};
+    std::shared_ptr<DailyLogfile> lastLog = nullptr;
+    size_t lineIndex = 0, lineOffset = 0;
+    m_sliceList.clear();
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        const auto& record = recordList[i];
+        Logfile::Slice slice = {record.data, record.size};
+        if (RECORD_DEFERRED == record.type)
+        {
+            slice = {m_formatBuffer.data() + lineOffset, m_lineSizeList[lineIndex++]};
+            lineOffset += slice.size;
+        }
+        std::shared_ptr<DailyLogfile> dailyLog;
+        if (record.level >= 0 && record.level <= LEVEL_FATAL)
+        {
+            if (!levelResolved[record.level])
+            {
+                levelLogList[record.level] = getDailyLog(record.level);
+                levelResolved[record.level] = true;
+            }
+            dailyLog = levelLogList[record.level];
+        }
+        else
+        {
+            dailyLog = getDailyLog(record.level);
+        }
+        if (dailyLog != lastLog && !m_sliceList.empty()) /* 文件变化, 先写入之前的日志 */
+        {
+            lastLog->record(m_sliceList.data(), m_sliceList.size());
+            m_sliceList.clear();
+        }
+        lastLog = dailyLog;
+        if (dailyLog)
+        {
+            m_sliceList.push_back(slice);
+        }
+        printConsole(record.level, record.consoleMode, slice.data, slice.size);
+    }
+    if (lastLog && !m_sliceList.empty())
+    {
+        lastLog->record(m_sliceList.data(), m_sliceList.size());
+    }
+    m_sliceList.clear();
+}
+
+void InnerLoggerImpl::writeBinaryRecords(const AsyncRecord* recordList, size_t recordCount)
+{
+    /* 组装帧: 新注册的调用处帧在前, 之后是日志帧, 每帧作为一个片段(文件滚动时不会拆分帧) */
+    m_formatBuffer.clear();
+    m_lineSizeList.clear();
+    const uint32_t siteCount = LogSite::getCount();
+    for (uint32_t id = m_siteWritten; id < siteCount; ++id)
+    {
+        const size_t offset = m_formatBuffer.size();
+        binlog::appendSiteFrame(m_formatBuffer, *LogSite::find(id));
+        m_lineSizeList.push_back(m_formatBuffer.size() - offset);
+    }
+    m_siteWritten = std::max(m_siteWritten, siteCount);
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        const auto& record = recordList[i];
+        const size_t offset = m_formatBuffer.size();
+        const uint8_t frameType = (RECORD_DEFERRED == record.type ? binlog::FRAME_RECORD : binlog::FRAME_TEXT);
+        binlog::appendFrame(m_formatBuffer, frameType, record.level, record.data, record.size);
+        m_lineSizeList.push_back(m_formatBuffer.size() - offset);
+        if (0 == record.consoleMode)
+        {
+            continue;
+        }
+        if (RECORD_DEFERRED == record.type) /* 控制台输出需要格式化 */
+        {
+            m_consoleBuffer.clear();
+            appendDeferredLine(m_consoleBuffer, record);
+            printConsole(record.level, record.consoleMode, m_consoleBuffer.data(), m_consoleBuffer.size());
+        }
+        else
+        {
+            printConsole(record.level, record.consoleMode, record.data, record.size);
+        }
+    }
+    if (!m_dailyLog)
+    {
+        return;
+    }
+    m_sliceList.clear();
+    size_t offset = 0;
+    for (auto size : m_lineSizeList)
+    {
+        m_sliceList.push_back({m_formatBuffer.data() + offset, size});
+        offset += size;
+    }
+    m_dailyLog->record(m_sliceList.data(), m_sliceList.size());
+    m_sliceList.clear();
+}
 } // namespace logger
@@ -7,6 +7,7 @@
 
 #include "../inner_logger.h"
 #include "../logfile/daily_logfile.h"
+#include "async_log_writer.h"
 
 namespace logger
 {
@@ -21,7 +22,7 @@ public:
      * @param cfg 日志配置
      */
     InnerLoggerImpl(const LogConfig& cfg);
-    virtual ~InnerLoggerImpl() = default;
+    virtual ~InnerLoggerImpl();
     InnerLoggerImpl& operator=(const InnerLoggerImpl& src) = delete;
 
     /**
@@ -121,11 +122,33 @@ public:
      */
     void print(int level, const std::string& tag, const char* file, int line, const char* func, const std::string& msg) override;
 
+    /**
+     * @brief 获取格式化模式
+     * @return 值: FORMAT_IMMEDIATE, FORMAT_DEFERRED, FORMAT_BINARY
+     */
+    int getFormatMode() override;
+
+    /**
+     * @brief 打印日志(延迟格式化, 只记录调用处和编码后的参数列表)
+     * @param level 日志等级
+     * @param tag 日志标签
+     * @param site 调用处
+     * @param args 编码后的参数列表
+     * @param argsLen 参数列表长度
+     */
+    void printDeferred(int level, const std::string& tag, const LogSite& site, const char* args, size_t argsLen) override;
+
     /**
      * @brief 强制刷新日志内容(耗时, 调用频率不宜过高, 建议间隔1秒以上)
      */
     void forceFlush() override;
 
+    /**
+     * @brief 获取异步模式下被丢弃的日志数量
+     * @return 丢弃数量
+     */
+    uint64_t getDropCount() override;
+
 private:
     /**
      * @brief 获取每天日志文件
@@ -134,6 +157,48 @@ private:
      */
     std::shared_ptr<DailyLogfile> getDailyLog(int level);
 
+    /**
+     * @brief 输出日志到控制台
+     * @param level 日志等级
+     * @param consoleMode 控制台日志输出模式
+     * @param data 日志内容
+     * @param size 日志内容长度
+     */
+    void printConsole(int level, int consoleMode, const char* data, size_t size);
+
+    /**
+     * @brief 批量记录日志(异步模式下在后台线程中调用), 连续写到同一文件的日志合并为一次写入
+     * @param recordList 日志记录列表
+     * @param recordCount 日志记录数量
+     */
+    void writeRecords(const AsyncRecord* recordList, size_t recordCount);
+
+    /**
+     * @brief 批量记录日志到二进制文件(二进制模式下在后台线程中调用), 所有等级写入通用文件
+     * @param recordList 日志记录列表
+     * @param recordCount 日志记录数量
+     */
+    void writeBinaryRecords(const AsyncRecord* recordList, size_t recordCount);
+
+    /**
+     * @brief 格式化延迟格式化的日志记录为日志行(追加到缓冲区)
+     * @param buf [输出]缓冲区
+     * @param record 日志记录
+     * @return 日志行长度, 0表示记录无效
+     */
+    size_t appendDeferredLine(std::string& buf, const AsyncRecord& record);
+
+    /**
+     * @brief 生成二进制文件头(会话帧和所有已注册的调用处帧)
+     * @return 文件头
+     */
+    std::string makeBinaryHeader();
+
+    /**
+     * @brief 刷新所有日志文件
+     */
+    void flushFiles();
+
 private:
     std::shared_ptr<DailyLogfile> m_dailyLog = nullptr; /* 每天日志文件(通用) */
     std::shared_ptr<DailyLogfile> m_dailyLogTrace = nullptr; /* 每天日志文件(跟踪) */
@@ -149,6 +214,13 @@ private:
     std::unordered_map<int, int> m_levelFile; /* 等级文件类型, key-日志等级, value-文件类型(同等级类型, 若不在范围内表示写入到通用文件) */
     std::atomic_int m_flushLevel = {LEVEL_TRACE}; /* 刷新等级(当日志等级大等于刷新等级时, 日志写入后立即刷新) */
     std::atomic_int m_consoleMode = {0}; /* 控制台日志输出模式: 0-不输出, 1-普通输出, 2-带样式输出 */
+    int m_formatMode = FORMAT_IMMEDIATE; /* 格式化模式(创建后不能修改) */
+    std::vector<Logfile::Slice> m_sliceList; /* 批量写入的日志片段列表(只在后台线程中使用) */
+    std::string m_formatBuffer; /* 本批次格式化后的日志行或二进制帧(只在后台线程中使用) */
+    std::vector<size_t> m_lineSizeList; /* 格式化缓冲区中各日志行或帧的长度(只在后台线程中使用) */
+    std::string m_consoleBuffer; /* 二进制模式下控制台输出的日志行(只在后台线程中使用) */
+    uint32_t m_siteWritten = 0; /* 二进制模式下当前文件已写入的调用处数量(只在后台线程中使用) */
+    std::unique_ptr<AsyncLogWriter> m_asyncWriter; /* 异步日志写入器(异步模式下有效) */
 };
 
 using InnerLoggerPtr = std::shared_ptr<InnerLogger>;
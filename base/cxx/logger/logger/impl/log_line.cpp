@@ -0,0 +1,204 @@
+#include "log_line.h"
+
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace logger
+{
+inline void appendChar(char*& p, char c)
+{
+    *p++ = c;
+}
+
+inline void appendString(char*& p, const char* s, size_t n)
+{
+    memcpy(p, s, n);
+    p += n;
+}
+
+inline void appendInt(char*& p, int v)
+{
+    if (0 == v)
+    {
+        *p++ = '0';
+        return;
+    }
+    if (v < 0)
+    {
+        *p++ = '-';
+        v = -v;
+    }
+    if (v < 1000) /* 小整数展开 */
+    {
+        if (v >= 100)
+        {
+            *p++ = (char)('0' + v / 100);
+            v %= 100;
+            *p++ = (char)('0' + v / 10);
+            *p++ = (char)('0' + v % 10);
+        }
+        else if (v >= 10)
+        {
+            *p++ = (char)('0' + v / 10);
+            *p++ = (char)('0' + v % 10);
+        }
+        else
+        {
+            *p++ = (char)('0' + v);
+        }
+        return;
+    }
+    /* 大整数通用实现 */
+    char tmp[16];
+    int i = 0;
+    while (v > 0)
+    {
+        tmp[i++] = (char)('0' + (v % 10));
+        v /= 10;
+    }
+    while (i--)
+    {
+        *p++ = tmp[i];
+    }
+}
+
+int64_t getTimestampUs()
+{
+#ifdef _WIN32
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft); /* 从1601-01-01开始的100纳秒数 */
+    const int64_t t = ((int64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (t - 116444736000000000LL) / 10;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+const DateTime& getDateTime()
+{
+    return getDateTime(getTimestampUs());
+}
+
+const DateTime& getDateTime(int64_t timeUs)
+{
+    static thread_local DateTime dt;
+    static thread_local int64_t lastMs = -1;
+    const int64_t nowMs = timeUs / 1000;
+    if (nowMs != lastMs)
+    {
+        lastMs = nowMs;
+        time_t sec = (time_t)(nowMs / 1000); /* 秒 */
+        int ms = (int)(nowMs % 1000); /* 毫秒 */
+        struct tm t;
+#ifdef _WIN32
+        localtime_s(&t, &sec);
+#else
+        localtime_r(&sec, &t);
+#endif
+        /* 手动格式化, 避免strftime */
+        auto itoa2 = [](int v, char* p) {
+            *p = (char)('0' + v / 10);
+            *(p + 1) = (char)('0' + v % 10);
+        };
+        auto itoa4 = [](int v, char* p) {
+            *(p + 3) = (char)('0' + v % 10);
+            v /= 10;
+            *(p + 2) = (char)('0' + v % 10);
+            v /= 10;
+            *(p + 1) = (char)('0' + v % 10);
+            v /= 10;
+            *p = (char)('0' + v);
+        };
+        itoa4(t.tm_year + 1900, dt.ymd);
+        dt.ymd[4] = '-';
+        itoa2(t.tm_mon + 1, dt.ymd + 5);
+        dt.ymd[7] = '-';
+        itoa2(t.tm_mday, dt.ymd + 8);
+        dt.ymd[10] = '\0';
+        itoa2(t.tm_hour, dt.hms);
+        dt.hms[2] = ':';
+        itoa2(t.tm_min, dt.hms + 3);
+        dt.hms[5] = ':';
+        itoa2(t.tm_sec, dt.hms + 6);
+        dt.hms[8] = '\0';
+        dt.ms[0] = (char)('0' + ms / 100);
+        dt.ms[1] = (char)('0' + (ms / 10) % 10);
+        dt.ms[2] = (char)('0' + ms % 10);
+        dt.ms[3] = '\0';
+    }
+    return dt;
+}
+
+char getLevelShortName(int level)
+{
+    static const char LEVEL_NAME[] = "TDIWEF";
+    return (level >= 0 && level <= 5) ? LEVEL_NAME[level] : (char)('0' + level);
+}
+
+size_t formatLine(char* buf, int level, const DateTime& dt, int pid, int tid, const char* tag, size_t tagLen, const char* file, int line,
+                  const char* func, const char* msg, size_t msgLen)
+{
+    char* p = buf;
+    /* 级别 */
+    appendChar(p, getLevelShortName(level));
+    /* 时间, [YYYY-MM-DD HH:MM:SS.mmm] */
+    appendChar(p, '[');
+    appendString(p, dt.ymd, 10);
+    appendChar(p, ' ');
+    appendString(p, dt.hms, 8);
+    appendChar(p, '.');
+    appendString(p, dt.ms, 3);
+    appendChar(p, ']');
+    /* [进程:线程] */
+    appendChar(p, '[');
+    appendInt(p, pid);
+    appendChar(p, ':');
+    appendInt(p, tid);
+    appendChar(p, ']');
+    /* [标签] */
+    if (tagLen > 0)
+    {
+        appendChar(p, '[');
+        appendString(p, tag, tagLen);
+        appendChar(p, ']');
+    }
+    /* [文件名 函数名 行号] */
+    auto fileLen = (file ? strlen(file) : 0);
+    auto funcLen = (func ? strlen(func) : 0);
+    if (fileLen > 0 || funcLen > 0)
+    {
+        appendChar(p, '[');
+        if (fileLen > 0)
+        {
+            appendString(p, file, fileLen);
+            if (funcLen > 0)
+            {
+                appendChar(p, ' ');
+            }
+        }
+        if (funcLen > 0)
+        {
+            appendString(p, func, funcLen);
+        }
+        appendChar(p, ' ');
+        appendInt(p, line);
+        appendChar(p, ']');
+    }
+    /* 内容 */
+    if (msg && msgLen > 0)
+    {
+        appendChar(p, ' ');
+        appendString(p, msg, msgLen);
+    }
+    /* 换行符 */
+    appendChar(p, '\n');
+    return p - buf;
+}
+} // namespace logger
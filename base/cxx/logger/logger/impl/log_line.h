@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace logger
+{
+/**
+ * @brief 日志行中的日期时间(已格式化)
+ */
+struct DateTime
+{
+    char ymd[12]; /* 年月日 */
+    char hms[12]; /* 时分秒 */
+    char ms[4]; /* 毫秒 */
+};
+
+/**
+ * @brief 获取当前时间戳
+ * @return 时间戳(微秒)
+ */
+int64_t getTimestampUs();
+
+/**
+ * @brief 获取当前时间(线程缓存, 同一毫秒内不重复格式化)
+ * @return 日期时间
+ */
+const DateTime& getDateTime();
+
+/**
+ * @brief 获取指定时间(线程缓存, 同一毫秒内不重复格式化)
+ * @param timeUs 时间戳(微秒)
+ * @return 日期时间
+ */
+const DateTime& getDateTime(int64_t timeUs);
+
+/**
+ * @brief 获取日志等级简称
+ * @param level 日志等级
+ * @return 简称, 例如: 'T', 'D', 'I', 'W', 'E', 'F'
+ */
+char getLevelShortName(int level);
+
+/**
+ * @brief 计算日志行的最大长度
+ * @param tagLen 标签长度
+ * @param fileLen 文件名长度
+ * @param funcLen 函数名长度
+ * @param msgLen 日志消息长度
+ * @return 最大长度
+ */
+inline size_t getLineMaxLength(size_t tagLen, size_t fileLen, size_t funcLen, size_t msgLen)
+{
+    return 96 + tagLen + fileLen + funcLen + msgLen;
+}
+
+/**
+ * @brief 组装日志行, 格式: 级别[YYYY-MM-DD HH:MM:SS.mmm][进程:线程][标签][文件名 函数名 行号] 内容\n
+ * @param buf 缓冲区, 长度不小于getLineMaxLength的返回值
+ * @param level 日志等级
+ * @param dt 日期时间
+ * @param pid 进程ID
+ * @param tid 线程ID
+ * @param tag 日志标签
+ * @param tagLen 日志标签长度
+ * @param file 文件名
+ * @param line 行号
+ * @param func 函数名
+ * @param msg 日志消息
+ * @param msgLen 日志消息长度
+ * @return 日志行长度
+ */
+size_t formatLine(char* buf, int level, const DateTime& dt, int pid, int tid, const char* tag, size_t tagLen, const char* file, int line,
+                  const char* func, const char* msg, size_t msgLen);
+} // namespace logger
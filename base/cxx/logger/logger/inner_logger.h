@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -6,6 +7,8 @@
 
 namespace logger
 {
+struct LogSite;
+
 /**
  * @brief 内部日志记录器
  */
@@ -130,11 +133,33 @@ public:
      */
     virtual void print(int level, const std::string& tag, const char* file, int line, const char* func, const std::string& msg) = 0;
 
+    /**
+     * @brief 获取格式化模式
+     * @return 值: FORMAT_IMMEDIATE, FORMAT_DEFERRED, FORMAT_BINARY
+     */
+    virtual int getFormatMode() = 0;
+
+    /**
+     * @brief 打印日志(延迟格式化, 只记录调用处和编码后的参数列表)
+     * @param level 日志等级
+     * @param tag 日志标签
+     * @param site 调用处
+     * @param args 编码后的参数列表
+     * @param argsLen 参数列表长度
+     */
+    virtual void printDeferred(int level, const std::string& tag, const LogSite& site, const char* args, size_t argsLen) = 0;
+
     /**
      * @brief 强制刷新日志内容(耗时, 调用频率不宜过高, 建议间隔1秒以上)
      */
     virtual void forceFlush() = 0;
 
+    /**
+     * @brief 获取异步模式下被丢弃的日志数量
+     * @return 丢弃数量
+     */
+    virtual uint64_t getDropCount() = 0;
+
 private:
     const std::string m_path; /* 日志路径 */
     const std::string m_name; /* 日志记录器名称 */
@@ -1,6 +1,7 @@
 #include "daily_logfile.h"
 
 #include <stdio.h>
+#include <string.h>
 
 inline struct tm& getLocalTime()
 {
@@ -38,6 +39,36 @@ DailyLogfile::DailyLogfile(const std::string& path, const std::string& prefixNam
     m_createDailyFolder = createDailyFolder;
 }
 
+void DailyLogfile::setHeaderCallback(const Logfile::HEADER_CALLBACK& headerCb)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_headerCb = headerCb;
+    if (m_rotatingLogfile)
+    {
+        m_rotatingLogfile->setHeaderCallback(headerCb);
+    }
+}
+
+void DailyLogfile::setCompressor(const LogCompressor& compressor)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_compressor = compressor;
+    if (m_rotatingLogfile)
+    {
+        m_rotatingLogfile->setCompressor(compressor);
+    }
+}
+
+void DailyLogfile::setMaxTotalSize(size_t maxTotalSize)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_maxTotalSize = maxTotalSize;
+    if (m_rotatingLogfile)
+    {
+        m_rotatingLogfile->setMaxTotalSize(maxTotalSize);
+    }
+}
+
 size_t DailyLogfile::getMaxSize() const
 {
     return m_maxSize;
@@ -73,6 +104,31 @@ void DailyLogfile::setMaxFiles(size_t maxFiles)
 }
 
 Logfile::Result DailyLogfile::record(const char* content, size_t contentSize, bool newline, bool immediateFlush)
+{
+    return checkDate()->record(content, contentSize, newline, immediateFlush);
+}
+
+Logfile::Result DailyLogfile::record(const std::string& content, bool newline, bool immediateFlush)
+{
+    return record(content.data(), content.size(), newline, immediateFlush);
+}
+
+Logfile::Result DailyLogfile::record(const Logfile::Slice* sliceList, size_t sliceCount)
+{
+    return checkDate()->record(sliceList, sliceCount);
+}
+
+bool DailyLogfile::forceFlush()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (m_rotatingLogfile)
+    {
+        return m_rotatingLogfile->forceFlush();
+    }
+    return false;
+}
+
+std::shared_ptr<RotatingLogfile> DailyLogfile::checkDate()
 {
     const auto& localTm = getLocalTime();
     auto today = (localTm.tm_year + 1900) * 10000 + (localTm.tm_mon + 1) * 100 + localTm.tm_mday; /* 用本地时间的年月日组合作为天数标识 */
@@ -96,24 +152,12 @@ Logfile::Result DailyLogfile::record(const char* content, size_t contentSize, bo
 #endif
             }
             m_rotatingLogfile = std::make_shared<RotatingLogfile>(path, m_baseName, m_extName, m_maxSize, m_maxFiles, m_indexFixed);
+            m_rotatingLogfile->setHeaderCallback(m_headerCb);
+            m_rotatingLogfile->setCompressor(m_compressor);
+            m_rotatingLogfile->setMaxTotalSize(m_maxTotalSize);
             m_rotatingLogfile->open();
             m_today.store(today, std::memory_order_release);
         }
     }
-    return m_rotatingLogfile->record(content, contentSize, newline, immediateFlush);
-}
-
-Logfile::Result DailyLogfile::record(const std::string& content, bool newline, bool immediateFlush)
-{
-    return record(content.data(), content.size(), newline, immediateFlush);
-}
-
-bool DailyLogfile::forceFlush()
-{
-    std::lock_guard<std::mutex> locker(m_mutex);
-    if (m_rotatingLogfile)
-    {
-        return m_rotatingLogfile->forceFlush();
-    }
-    return false;
+    return m_rotatingLogfile;
 }
@@ -29,6 +29,24 @@ public:
 
     virtual ~DailyLogfile() = default;
 
+    /**
+     * @brief 设置文件头回调(每次打开文件后写入, 包括每天的新文件和滚动后的新文件)
+     * @param headerCb 文件头回调
+     */
+    void setHeaderCallback(const Logfile::HEADER_CALLBACK& headerCb);
+
+    /**
+     * @brief 设置压缩器(滚动后的文件在后台线程压缩)
+     * @param compressor 压缩器
+     */
+    void setCompressor(const LogCompressor& compressor);
+
+    /**
+     * @brief 设置目录下已归档文件的总大小预算(超过时删除最早的已归档文件)
+     * @param maxTotalSize 总大小(字节), 为0时表示不限制
+     */
+    void setMaxTotalSize(size_t maxTotalSize);
+
     /**
      * @brief 获取日志文件最大容量
      * @return 文件最大容量(字节)
@@ -72,12 +90,27 @@ public:
      */
     Logfile::Result record(const std::string& content, bool newline = true, bool immediateFlush = true);
 
+    /**
+     * @brief 批量记录日志内容
+     * @param sliceList 日志内容片段列表
+     * @param sliceCount 片段数量
+     * @return 操作结果
+     */
+    Logfile::Result record(const Logfile::Slice* sliceList, size_t sliceCount);
+
     /**
      * @brief 强制刷新日志内容(耗时, 调用频率不宜过高, 建议间隔1秒以上)
      * @return true-成功, false-失败
      */
     bool forceFlush();
 
+private:
+    /**
+     * @brief 检测日期, 日期变化时创建新的滚动日志文件
+     * @return 滚动日志文件
+     */
+    std::shared_ptr<RotatingLogfile> checkDate();
+
 private:
     std::string m_path; /* 日志文件路径 */
     std::string m_prefixName; /* 日志文件前缀名 */
@@ -90,5 +123,8 @@ private:
     bool m_createDailyFolder = true; /* 是否创建每日文件夹 */
     std::mutex m_mutex; /* 互斥锁 */
     std::shared_ptr<RotatingLogfile> m_rotatingLogfile = nullptr; /* 滚动日志文件 */
+    Logfile::HEADER_CALLBACK m_headerCb = nullptr; /* 文件头回调 */
+    LogCompressor m_compressor; /* 压缩器 */
+    size_t m_maxTotalSize = 0; /* 目录下已归档文件的总大小预算 */
     std::atomic<time_t> m_today{0}; /* 今天(缓存) */
 };
@@ -8,6 +8,8 @@
 #include <io.h>
 #else
 #include <dirent.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 
@@ -17,6 +19,10 @@
 #define FILE_SYNC(fp) fsync(fileno(fp))
 #endif
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 bool Logfile::createPath(const std::string& path)
 {
     if (path.empty())
@@ -111,6 +117,12 @@ Logfile::~Logfile()
     close();
 }
 
+void Logfile::setHeaderCallback(const HEADER_CALLBACK& headerCb)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_headerCb = headerCb;
+}
+
 bool Logfile::isOpened()
 {
     std::lock_guard<std::mutex> locker(m_mutex);
@@ -142,6 +154,7 @@ bool Logfile::open()
     fseeko64(m_f, 0, SEEK_END);
     m_size = ftello64(m_f);
 #endif
+    writeHeader();
     return true;
 }
 
@@ -218,6 +231,7 @@ void Logfile::clear()
         fseeko64(m_f, 0, SEEK_END);
         m_size = ftello64(m_f);
 #endif
+        writeHeader();
     }
     else
     {
@@ -290,6 +304,110 @@ Logfile::Result Logfile::record(const std::string& content, bool newline, bool i
     return record(content.data(), content.size(), newline, immediateFlush);
 }
 
+Logfile::Result Logfile::record(const Slice* sliceList, size_t sliceCount, size_t& recordCount)
+{
+    recordCount = 0;
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (!m_f)
+    {
+        return Result::invalid;
+    }
+    if (!m_enable)
+    {
+        return Result::disabled;
+    }
+    /* 计算文件能容纳的片段数量 */
+    size_t count = 0, totalSize = 0;
+    for (; count < sliceCount; ++count)
+    {
+        if (m_maxSize > 0 && m_size + totalSize + sliceList[count].size > m_maxSize)
+        {
+            break;
+        }
+        totalSize += sliceList[count].size;
+    }
+    if (0 == count && sliceCount > 0) /* 文件中只有文件头时仍不能容纳, 则滚动文件也无法写入 */
+    {
+        return (m_size <= m_headerSize) ? Result::too_large : Result::will_full;
+    }
+    if (!m_flushed && 0 != fflush(m_f)) /* 先把文件缓冲区中的内容写到内核, 保证顺序 */
+    {
+        fclose(m_f);
+        m_f = nullptr;
+        return Result::flush_failed;
+    }
+#ifdef _WIN32
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (sliceList[i].size > 0 && 0 == fwrite(sliceList[i].data, 1, sliceList[i].size, m_f))
+        {
+            fclose(m_f);
+            m_f = nullptr;
+            return Result::content_failed;
+        }
+    }
+    if (0 != fflush(m_f))
+    {
+        fclose(m_f);
+        m_f = nullptr;
+        return Result::flush_failed;
+    }
+#else
+    const int fd = fileno(m_f);
+    struct iovec iov[IOV_MAX];
+    size_t index = 0, offset = 0; /* 当前片段索引及片段内已写入的长度(处理部分写入) */
+    while (index < count)
+    {
+        int iovCount = 0;
+        for (size_t i = index; i < count && iovCount < IOV_MAX; ++i)
+        {
+            const size_t skip = (i == index ? offset : 0);
+            iov[iovCount].iov_base = (void*)(sliceList[i].data + skip);
+            iov[iovCount].iov_len = sliceList[i].size - skip;
+            ++iovCount;
+        }
+        const ssize_t written = writev(fd, iov, iovCount);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            fclose(m_f);
+            m_f = nullptr;
+            return Result::content_failed;
+        }
+        size_t remain = (size_t)written;
+        while (index < count && remain >= sliceList[index].size - offset)
+        {
+            remain -= sliceList[index].size - offset;
+            offset = 0;
+            ++index;
+        }
+        offset += remain;
+    }
+#endif
+    m_size = m_size + totalSize;
+    m_flushed = true;
+    recordCount = count;
+    return (count < sliceCount) ? Result::will_full : Result::ok;
+}
+
+void Logfile::writeHeader()
+{
+    m_headerSize = 0;
+    if (!m_f || !m_headerCb)
+    {
+        return;
+    }
+    const auto header = m_headerCb();
+    if (!header.empty() && 1 == fwrite(header.data(), header.size(), 1, m_f) && 0 == fflush(m_f))
+    {
+        m_headerSize = header.size();
+        m_size = m_size + header.size();
+    }
+}
+
 bool Logfile::forceFlush()
 {
     std::lock_guard<std::mutex> locker(m_mutex);
@@ -1,5 +1,6 @@
 #pragma once
 #include <atomic>
+#include <functional>
 #include <mutex>
 #include <stdio.h>
 #include <string>
@@ -22,6 +23,21 @@ public:
         flush_failed /* 刷新出错 */
     };
 
+    /**
+     * @brief 日志内容片段(批量写入时使用)
+     */
+    struct Slice
+    {
+        const char* data; /* 内容 */
+        size_t size; /* 内容长度 */
+    };
+
+    /**
+     * @brief 文件头回调(每次打开文件后调用, 返回的内容写入到文件, 用于二进制日志文件的自描述信息)
+     * @return 文件头内容
+     */
+    using HEADER_CALLBACK = std::function<std::string()>;
+
 public:
     /**
      * @brief 创建路径
@@ -48,6 +64,12 @@ public:
 
     ~Logfile();
 
+    /**
+     * @brief 设置文件头回调(需要在打开文件之前设置)
+     * @param headerCb 文件头回调
+     */
+    void setHeaderCallback(const HEADER_CALLBACK& headerCb);
+
     /**
      * @brief 文件是否已打开
      * @return true-有效, false-无效(打开失败)
@@ -137,12 +159,27 @@ public:
      */
     Result record(const std::string& content, bool newline = true, bool immediateFlush = true);
 
+    /**
+     * @brief 批量记录日志内容(不换行, 不经过文件缓冲区, 非Windows平台使用一次writev写入)
+     * @param sliceList 日志内容片段列表
+     * @param sliceCount 片段数量
+     * @param recordCount [输出]已写入的片段数量, 文件将满时只写入能容纳的片段
+     * @return 操作结果, will_full-剩余的片段需要写到新文件, too_large-第1个片段超过文件容量(不包括文件头)
+     */
+    Result record(const Slice* sliceList, size_t sliceCount, size_t& recordCount);
+
     /**
      * @brief 强制刷新日志内容(耗时, 调用频率不宜过高, 建议间隔1秒以上)
      * @return true-成功, false-失败
      */
     bool forceFlush();
 
+private:
+    /**
+     * @brief 写入文件头(打开文件后调用, 调用前需加锁)
+     */
+    void writeHeader();
+
 private:
     std::string m_path; /* 日志文件路径 */
     std::string m_filename; /* 日志文件名 */
@@ -153,4 +190,6 @@ private:
     std::atomic<size_t> m_size = {0}; /* 文件当前大小 */
     std::atomic_bool m_flushed = {true}; /* 写入的日志是否已刷新 */
     std::atomic_bool m_enable = {true}; /* 是否启用日志记录功能 */
+    HEADER_CALLBACK m_headerCb = nullptr; /* 文件头回调 */
+    size_t m_headerSize = 0; /* 本次打开时写入的文件头长度 */
 };
@@ -0,0 +1,543 @@
+#include "logfile_index.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <thread>
+#include <unordered_map>
+#if (1 == ENABLE_LOGGER_ZLIB)
+#include <zlib.h>
+#endif
+
+static const char* INDEX_FILENAME = ".logfile_index"; /* 索引文件名 */
+static const char* INDEX_VERSION = "LOGFILE_INDEX 1"; /* 索引文件版本(第一行) */
+static const char* TEMP_EXT_NAME = ".tmp"; /* 临时文件后缀名 */
+
+/**
+ * @brief 获取文件大小
+ * @param fullName 文件全名
+ * @param size [输出]文件大小
+ * @return true-文件存在, false-文件不存在
+ */
+static bool getFileSize(const std::string& fullName, size_t& size)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    if (0 != _stat64(fullName.c_str(), &st) || !(S_IFREG & st.st_mode))
+#else
+    struct stat64 st;
+    if (0 != stat64(fullName.c_str(), &st) || !(S_IFREG & st.st_mode))
+#endif
+    {
+        return false;
+    }
+    size = (size_t)st.st_size;
+    return true;
+}
+
+/**
+ * @brief 重命名文件(目标文件存在时覆盖)
+ * @return true-成功, false-失败
+ */
+static bool renameFile(const std::string& srcFullName, const std::string& dstFullName)
+{
+#ifdef _WIN32
+    remove(dstFullName.c_str()); /* Windows下目标文件存在时重命名会失败 */
+#endif
+    if (0 != rename(srcFullName.c_str(), dstFullName.c_str()))
+    {
+        printf("move file [%s] to [%s] fail, errno[%d], desc: %s\n", srcFullName.c_str(), dstFullName.c_str(), errno, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 后台压缩线程(全进程共享一个, 任务按顺序执行)
+ */
+class ArchiveWorker final
+{
+public:
+    static ArchiveWorker& getInstance()
+    {
+        static ArchiveWorker* s_worker = new ArchiveWorker(); /* 不释放, 线程分离运行, 避免进程退出时访问已析构的对象 */
+        return *s_worker;
+    }
+
+    void post(const std::function<void()>& task)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_taskQueue.emplace_back(task);
+        if (!m_started)
+        {
+            m_started = true;
+            std::thread([this]() { run(); }).detach();
+        }
+        m_cv.notify_one();
+    }
+
+private:
+    void run()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> locker(m_mutex);
+                m_cv.wait(locker, [&]() { return !m_taskQueue.empty(); });
+                task = std::move(m_taskQueue.front());
+                m_taskQueue.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_taskQueue; /* 任务队列 */
+    bool m_started = false; /* 线程是否已启动 */
+};
+
+#if (1 == ENABLE_LOGGER_ZLIB)
+LogCompressor LogCompressor::gzip(int level)
+{
+    LogCompressor compressor;
+    compressor.extName = ".gz";
+    const std::string mode = "wb" + std::to_string((level >= 1 && level <= 9) ? level : 6);
+    compressor.compress = [mode](const std::string& srcFullName, const std::string& dstFullName) {
+        FILE* src = fopen(srcFullName.c_str(), "rb");
+        if (!src)
+        {
+            return false;
+        }
+        gzFile dst = gzopen(dstFullName.c_str(), mode.c_str());
+        if (!dst)
+        {
+            fclose(src);
+            return false;
+        }
+        bool ok = true;
+        std::vector<char> buf(256 * 1024);
+        size_t len = 0;
+        while (ok && (len = fread(buf.data(), 1, buf.size(), src)) > 0)
+        {
+            ok = (gzwrite(dst, buf.data(), (unsigned)len) == (int)len);
+        }
+        ok = ok && !ferror(src);
+        fclose(src);
+        return (Z_OK == gzclose(dst)) && ok;
+    };
+    return compressor;
+}
+#endif
+
+std::shared_ptr<LogfileIndex> LogfileIndex::getInstance(const std::string& path)
+{
+    static std::mutex s_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<LogfileIndex>> s_indexMap;
+    std::string key = path;
+    if (key.empty() || ('/' != key.back() && '\\' != key.back()))
+    {
+#ifdef _WIN32
+        key.push_back('\\');
+#else
+        key.push_back('/');
+#endif
+    }
+    std::lock_guard<std::mutex> locker(s_mutex);
+    auto& weakIndex = s_indexMap[key];
+    auto index = weakIndex.lock();
+    if (!index)
+    {
+        for (auto iter = s_indexMap.begin(); s_indexMap.end() != iter;) /* 顺便清除已释放的索引 */
+        {
+            iter = iter->second.expired() && iter->first != key ? s_indexMap.erase(iter) : std::next(iter);
+        }
+        index = std::make_shared<LogfileIndex>(key);
+        s_indexMap[key] = index;
+    }
+    return index;
+}
+
+std::string LogfileIndex::calcFilename(const std::string& baseName, int index, const std::string& extName)
+{
+    std::string filename;
+    filename.append(baseName).append("-").append(std::to_string(index)).append(extName);
+    return filename;
+}
+
+LogfileIndex::LogfileIndex(const std::string& path) : m_path(path)
+{
+    load();
+}
+
+void LogfileIndex::setCompressor(const LogCompressor& compressor)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_compressor = compressor;
+    for (auto& entry : m_entryList)
+    {
+        queueCompress(entry);
+    }
+}
+
+void LogfileIndex::setMaxTotalSize(size_t maxTotalSize)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_maxTotalSize = maxTotalSize;
+    enforceBudget();
+}
+
+bool LogfileIndex::hasFamily(const std::string& baseName, const std::string& extName)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    for (const auto& entry : m_entryList)
+    {
+        if (entry.baseName == baseName && entry.extName == extName)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> LogfileIndex::getIndexList(const std::string& baseName, const std::string& extName)
+{
+    std::vector<int> indexList;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        for (const auto& entry : m_entryList)
+        {
+            if (entry.baseName == baseName && entry.extName == extName)
+            {
+                indexList.emplace_back(entry.index);
+            }
+        }
+    }
+    std::sort(indexList.begin(), indexList.end());
+    return indexList;
+}
+
+bool LogfileIndex::isArchived(const std::string& baseName, const std::string& extName, int index)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto entry = find(baseName, extName, index);
+    return (entry && 0 != entry->state);
+}
+
+void LogfileIndex::add(const std::string& baseName, const std::string& extName, int index, const std::string& filename, bool archived)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (find(baseName, extName, index))
+    {
+        return;
+    }
+    Entry entry;
+    entry.seq = m_nextSeq++;
+    entry.baseName = baseName;
+    entry.extName = extName;
+    entry.index = index;
+    entry.filename = filename;
+    if (archived)
+    {
+        getFileSize(m_path + filename, entry.size);
+        entry.state = (filename.size() > calcFilename(baseName, index, extName).size()) ? 2 : 1;
+        queueCompress(entry);
+    }
+    m_entryList.emplace_back(entry);
+    enforceBudget();
+    save();
+}
+
+void LogfileIndex::archive(const std::string& baseName, const std::string& extName, int index)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto entry = find(baseName, extName, index);
+    if (!entry || 0 != entry->state)
+    {
+        return;
+    }
+    entry->seq = m_nextSeq++; /* 按归档先后排序 */
+    entry->state = 1;
+    getFileSize(m_path + entry->filename, entry->size);
+    queueCompress(*entry);
+    enforceBudget();
+    save();
+}
+
+void LogfileIndex::remove(const std::string& baseName, const std::string& extName, int index)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto entry = find(baseName, extName, index);
+    if (entry)
+    {
+        ::remove((m_path + entry->filename).c_str());
+        m_entryList.erase(m_entryList.begin() + (entry - m_entryList.data()));
+        save();
+    }
+}
+
+bool LogfileIndex::move(const std::string& baseName, const std::string& extName, int fromIndex, int toIndex)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto entry = find(baseName, extName, fromIndex);
+    if (!entry)
+    {
+        return false;
+    }
+    auto target = find(baseName, extName, toIndex);
+    if (target)
+    {
+        ::remove((m_path + target->filename).c_str());
+        m_entryList.erase(m_entryList.begin() + (target - m_entryList.data()));
+        entry = find(baseName, extName, fromIndex); /* 删除元素后指针可能失效 */
+    }
+    const std::string suffix = entry->filename.substr(calcFilename(baseName, fromIndex, extName).size()); /* 压缩后缀名 */
+    const std::string filename = calcFilename(baseName, toIndex, extName) + suffix;
+    if (!renameFile(m_path + entry->filename, m_path + filename))
+    {
+        return false;
+    }
+    entry->index = toIndex;
+    entry->filename = filename;
+    save();
+    return true;
+}
+
+LogfileIndex::Entry* LogfileIndex::find(const std::string& baseName, const std::string& extName, int index)
+{
+    for (auto& entry : m_entryList)
+    {
+        if (entry.index == index && entry.baseName == baseName && entry.extName == extName)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+LogfileIndex::Entry* LogfileIndex::findBySeq(uint64_t seq)
+{
+    for (auto& entry : m_entryList)
+    {
+        if (entry.seq == seq)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void LogfileIndex::load()
+{
+    FILE* f = fopen((m_path + INDEX_FILENAME).c_str(), "rb");
+    if (!f)
+    {
+        return;
+    }
+    std::string content;
+    char buf[4096];
+    size_t len = 0;
+    while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+    {
+        content.append(buf, len);
+    }
+    fclose(f);
+    size_t lineStart = 0;
+    bool versionOk = false;
+    while (lineStart < content.size())
+    {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (std::string::npos == lineEnd)
+        {
+            break; /* 最后一行不完整, 忽略 */
+        }
+        const std::string line = content.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if (!versionOk)
+        {
+            if (line != INDEX_VERSION)
+            {
+                return; /* 版本不匹配, 由滚动日志文件重新扫描 */
+            }
+            versionOk = true;
+            continue;
+        }
+        /* 格式: 序号\t状态\t索引值\t日志文件名\t后缀名\t当前文件名 */
+        std::vector<std::string> fields;
+        size_t fieldStart = 0;
+        for (size_t pos = line.find('\t'); std::string::npos != pos; pos = line.find('\t', fieldStart))
+        {
+            fields.emplace_back(line.substr(fieldStart, pos - fieldStart));
+            fieldStart = pos + 1;
+        }
+        fields.emplace_back(line.substr(fieldStart));
+        if (6 != fields.size())
+        {
+            continue;
+        }
+        Entry entry;
+        entry.seq = strtoull(fields[0].c_str(), nullptr, 10);
+        entry.state = atoi(fields[1].c_str());
+        entry.index = atoi(fields[2].c_str());
+        entry.baseName = fields[3];
+        entry.extName = fields[4];
+        entry.filename = fields[5];
+        if (!getFileSize(m_path + entry.filename, entry.size)) /* 文件已被外部删除 */
+        {
+            continue;
+        }
+        if (1 == entry.state)
+        {
+            ::remove((m_path + entry.filename + TEMP_EXT_NAME).c_str()); /* 上次退出时未完成的压缩 */
+        }
+        m_nextSeq = std::max(m_nextSeq, entry.seq + 1);
+        m_entryList.emplace_back(entry);
+    }
+}
+
+void LogfileIndex::save()
+{
+    std::string content(INDEX_VERSION);
+    content.push_back('\n');
+    for (const auto& entry : m_entryList)
+    {
+        content.append(std::to_string(entry.seq)).push_back('\t');
+        content.append(std::to_string(entry.state)).push_back('\t');
+        content.append(std::to_string(entry.index)).push_back('\t');
+        content.append(entry.baseName).push_back('\t');
+        content.append(entry.extName).push_back('\t');
+        content.append(entry.filename).push_back('\n');
+    }
+    const std::string fullName = m_path + INDEX_FILENAME;
+    const std::string tempFullName = fullName + TEMP_EXT_NAME;
+    FILE* f = fopen(tempFullName.c_str(), "wb");
+    if (!f)
+    {
+        return; /* 目录可能还未创建, 下次变更时再保存 */
+    }
+    const bool ok = (content.size() == fwrite(content.data(), 1, content.size(), f));
+    fclose(f);
+    if (ok)
+    {
+        renameFile(tempFullName, fullName);
+    }
+}
+
+void LogfileIndex::queueCompress(Entry& entry)
+{
+    if (1 != entry.state || entry.compressing || !m_compressor.compress)
+    {
+        return;
+    }
+    entry.compressing = true;
+    std::weak_ptr<LogfileIndex> weakSelf = shared_from_this();
+    const uint64_t seq = entry.seq;
+    ArchiveWorker::getInstance().post([weakSelf, seq]() {
+        auto self = weakSelf.lock();
+        if (self)
+        {
+            self->compressEntry(seq);
+        }
+    });
+}
+
+void LogfileIndex::compressEntry(uint64_t seq)
+{
+    std::string srcFullName, tempFullName;
+    LogCompressor compressor;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        auto entry = findBySeq(seq);
+        if (!entry || 1 != entry->state)
+        {
+            return;
+        }
+        if (!m_compressor.compress) /* 压缩器已被取消 */
+        {
+            entry->compressing = false;
+            enforceBudget();
+            return;
+        }
+        compressor = m_compressor;
+        srcFullName = m_path + entry->filename;
+        tempFullName = srcFullName + compressor.extName + TEMP_EXT_NAME;
+    }
+    const bool ok = compressor.compress(srcFullName, tempFullName); /* 压缩时不加锁, 不阻塞写入线程的滚动 */
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto entry = findBySeq(seq);
+    if (!entry) /* 压缩期间文件已被删除 */
+    {
+        ::remove(tempFullName.c_str());
+        return;
+    }
+    entry->compressing = false;
+    if (!ok)
+    {
+        ::remove(tempFullName.c_str());
+        if (srcFullName != m_path + entry->filename) /* 压缩期间文件被重命名(索引值固定模式), 重新压缩 */
+        {
+            queueCompress(*entry);
+        }
+        else /* 压缩失败, 保留原文件并计入总大小 */
+        {
+            enforceBudget();
+            save();
+        }
+        return;
+    }
+    /* 压缩期间文件可能被重命名(内容不变), 以当前文件名为准 */
+    const std::string currFullName = m_path + entry->filename;
+    if (!renameFile(tempFullName, currFullName + compressor.extName))
+    {
+        ::remove(tempFullName.c_str());
+        enforceBudget();
+        return;
+    }
+    ::remove(currFullName.c_str());
+    entry->filename.append(compressor.extName);
+    entry->state = 2;
+    getFileSize(currFullName + compressor.extName, entry->size);
+    enforceBudget();
+    save();
+}
+
+void LogfileIndex::enforceBudget()
+{
+    if (0 == m_maxTotalSize)
+    {
+        return;
+    }
+    size_t totalSize = 0;
+    for (const auto& entry : m_entryList)
+    {
+        if (0 != entry.state)
+        {
+            totalSize += entry.size;
+        }
+    }
+    while (totalSize > m_maxTotalSize)
+    {
+        auto oldest = m_entryList.end();
+        for (auto iter = m_entryList.begin(); m_entryList.end() != iter; ++iter)
+        {
+            if (0 != iter->state && (m_entryList.end() == oldest || iter->seq < oldest->seq)) /* 等待压缩的文件被删除后, 压缩任务会跳过 */
+            {
+                oldest = iter;
+            }
+        }
+        if (m_entryList.end() == oldest)
+        {
+            break;
+        }
+        ::remove((m_path + oldest->filename).c_str());
+        totalSize -= oldest->size;
+        m_entryList.erase(oldest);
+    }
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifndef ENABLE_LOGGER_ZLIB
+#define ENABLE_LOGGER_ZLIB 0
+#endif
+
+/**
+ * @brief 日志文件压缩器(可插拔, 例如: gzip, zstd)
+ */
+struct LogCompressor
+{
+    /**
+     * @brief 压缩函数(在后台线程调用)
+     * @param srcFullName 源文件全名
+     * @param dstFullName 目标文件全名
+     * @return true-成功, false-失败
+     */
+    using COMPRESS_FUNC = std::function<bool(const std::string& srcFullName, const std::string& dstFullName)>;
+
+#if (1 == ENABLE_LOGGER_ZLIB)
+    /**
+     * @brief 创建gzip压缩器(依赖zlib)
+     * @param level 压缩等级(1-9), 默认6
+     * @return 压缩器
+     */
+    static LogCompressor gzip(int level = 6);
+#endif
+
+    std::string extName; /* 压缩文件后缀名, 例如: ".gz" */
+    COMPRESS_FUNC compress = nullptr; /* 压缩函数, 为空时表示不压缩 */
+};
+
+/**
+ * @brief 日志文件索引(每个目录一份, 记录目录下滚动日志文件的列表, 持久化到目录下的索引文件, 滚动时无需重新扫描目录)
+ *        说明: 1.滚动后的文件(已归档)在后台线程压缩, 不阻塞日志写入
+ *              2.目录下已归档文件的总大小超过预算时, 按归档先后删除最早的文件(正在写入和等待压缩的文件不计入)
+ *              3.索引文件丢失或损坏时, 由滚动日志文件重新扫描目录建立
+ */
+class LogfileIndex final : public std::enable_shared_from_this<LogfileIndex>
+{
+public:
+    /**
+     * @brief 获取目录的索引(同一进程内相同目录共享)
+     * @param path 目录
+     * @return 索引
+     */
+    static std::shared_ptr<LogfileIndex> getInstance(const std::string& path);
+
+    /**
+     * @brief 根据索引值计算文件名
+     * @param baseName 日志文件名
+     * @param index 索引值
+     * @param extName 日志文件后缀名
+     * @return 文件名
+     */
+    static std::string calcFilename(const std::string& baseName, int index, const std::string& extName);
+
+public:
+    explicit LogfileIndex(const std::string& path);
+    ~LogfileIndex() = default;
+    LogfileIndex(const LogfileIndex& src) = delete;
+    LogfileIndex& operator=(const LogfileIndex& src) = delete;
+
+    /**
+     * @brief 设置压缩器(设置后会压缩之前未压缩的已归档文件)
+     * @param compressor 压缩器
+     */
+    void setCompressor(const LogCompressor& compressor);
+
+    /**
+     * @brief 设置已归档文件的总大小预算
+     * @param maxTotalSize 总大小(字节), 为0时表示不限制
+     */
+    void setMaxTotalSize(size_t maxTotalSize);
+
+    /**
+     * @brief 索引中是否有文件族的记录
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @return true-有, false-没有(需要扫描目录)
+     */
+    bool hasFamily(const std::string& baseName, const std::string& extName);
+
+    /**
+     * @brief 获取文件族的索引值列表
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @return 索引值列表(按升序排序)
+     */
+    std::vector<int> getIndexList(const std::string& baseName, const std::string& extName);
+
+    /**
+     * @brief 文件是否已归档
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @param index 索引值
+     * @return true-已归档(或已压缩), false-正在写入或不存在
+     */
+    bool isArchived(const std::string& baseName, const std::string& extName, int index);
+
+    /**
+     * @brief 添加文件记录(已存在时忽略)
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @param index 索引值
+     * @param filename 文件名(可能带压缩后缀名)
+     * @param archived 是否已归档
+     */
+    void add(const std::string& baseName, const std::string& extName, int index, const std::string& filename, bool archived);
+
+    /**
+     * @brief 归档文件(滚动后调用), 之后在后台压缩并检查总大小预算
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @param index 索引值
+     */
+    void archive(const std::string& baseName, const std::string& extName, int index);
+
+    /**
+     * @brief 删除文件及记录
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @param index 索引值
+     */
+    void remove(const std::string& baseName, const std::string& extName, int index);
+
+    /**
+     * @brief 修改文件索引值(文件被重命名, 保留压缩后缀名)
+     * @param baseName 日志文件名
+     * @param extName 日志文件后缀名
+     * @param fromIndex 原索引值
+     * @param toIndex 新索引值(文件已存在时被覆盖)
+     * @return true-成功, false-失败
+     */
+    bool move(const std::string& baseName, const std::string& extName, int fromIndex, int toIndex);
+
+private:
+    /**
+     * @brief 文件记录
+     */
+    struct Entry
+    {
+        uint64_t seq = 0; /* 序号(越小越早) */
+        std::string baseName; /* 日志文件名 */
+        std::string extName; /* 日志文件后缀名 */
+        int index = 0; /* 索引值 */
+        std::string filename; /* 当前文件名 */
+        size_t size = 0; /* 文件大小(归档时记录) */
+        int state = 0; /* 状态: 0-正在写入, 1-已归档, 2-已压缩 */
+        bool compressing = false; /* 是否等待压缩或正在压缩(不持久化, 按未压缩大小计入总大小) */
+    };
+
+    /**
+     * @brief 查找文件记录
+     * @return 记录, 为空表示不存在
+     */
+    Entry* find(const std::string& baseName, const std::string& extName, int index);
+
+    /**
+     * @brief 根据序号查找文件记录
+     * @return 记录, 为空表示不存在
+     */
+    Entry* findBySeq(uint64_t seq);
+
+    /**
+     * @brief 加载索引文件(丢弃文件已不存在的记录)
+     */
+    void load();
+
+    /**
+     * @brief 保存索引文件(先写临时文件再重命名)
+     */
+    void save();
+
+    /**
+     * @brief 把已归档文件加入后台压缩队列
+     * @param entry 文件记录
+     */
+    void queueCompress(Entry& entry);
+
+    /**
+     * @brief 压缩文件(在后台线程调用)
+     * @param seq 文件记录序号
+     */
+    void compressEntry(uint64_t seq);
+
+    /**
+     * @brief 检查总大小预算, 超过时删除最早的已归档文件(等待压缩的文件按未压缩大小计入, 也可被删除, 压缩积压时目录不会超出预算)
+     */
+    void enforceBudget();
+
+private:
+    std::string m_path; /* 目录(以分隔符结尾) */
+    std::mutex m_mutex; /* 互斥锁 */
+    std::vector<Entry> m_entryList; /* 文件记录列表 */
+    uint64_t m_nextSeq = 1; /* 下一个序号 */
+    LogCompressor m_compressor; /* 压缩器 */
+    size_t m_maxTotalSize = 0; /* 已归档文件的总大小预算 */
+};
@@ -1,7 +1,9 @@
 #include "rotating_logfile.h"
 
+#include <map>
 #include <regex>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #ifdef _WIN32
@@ -29,11 +31,29 @@ RotatingLogfile::RotatingLogfile(const std::string& path, const std::string& bas
     }
     m_maxFiles = maxFiles > 0 ? maxFiles : 0;
     m_indexFixed = indexFixed;
+    m_fileIndex = LogfileIndex::getInstance(logPath);
     std::vector<int> indexList;
     m_index = findLastIndex(logPath, indexList);
     m_logfile = std::make_shared<Logfile>(logPath, calcFilenameByIndex(m_index), maxSize);
 }
 
+void RotatingLogfile::setHeaderCallback(const Logfile::HEADER_CALLBACK& headerCb)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_headerCb = headerCb;
+    m_logfile->setHeaderCallback(headerCb);
+}
+
+void RotatingLogfile::setCompressor(const LogCompressor& compressor)
+{
+    m_fileIndex->setCompressor(compressor);
+}
+
+void RotatingLogfile::setMaxTotalSize(size_t maxTotalSize)
+{
+    m_fileIndex->setMaxTotalSize(maxTotalSize);
+}
+
 int RotatingLogfile::getFileIndex() const
 {
     return m_index;
@@ -42,7 +62,12 @@ int RotatingLogfile::getFileIndex() const
 bool RotatingLogfile::open()
 {
     std::lock_guard<std::mutex> locker(m_mutex);
-    return m_logfile->open();
+    if (!m_logfile->open())
+    {
+        return false;
+    }
+    m_fileIndex->add(m_baseName, m_extName, m_index, m_logfile->getFilename(), false);
+    return true;
 }
 
 void RotatingLogfile::close()
@@ -134,6 +159,35 @@ Logfile::Result RotatingLogfile::record(const std::string& content, bool newline
     return record(content.data(), content.size(), newline, immediateFlush);
 }
 
+Logfile::Result RotatingLogfile::record(const Logfile::Slice* sliceList, size_t sliceCount)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    Logfile::Result ret = Logfile::Result::ok;
+    size_t offset = 0;
+    while (offset < sliceCount)
+    {
+        size_t recordCount = 0;
+        ret = m_logfile->record(sliceList + offset, sliceCount - offset, recordCount);
+        offset += recordCount;
+        if (Logfile::Result::will_full == ret)
+        {
+            if (0 == recordCount && !rotateFileList())
+            {
+                return ret;
+            }
+        }
+        else if (Logfile::Result::too_large == ret) /* 丢弃超过文件容量的片段 */
+        {
+            ++offset;
+        }
+        else if (Logfile::Result::ok != ret)
+        {
+            return ret;
+        }
+    }
+    return ret;
+}
+
 bool RotatingLogfile::forceFlush()
 {
     std::lock_guard<std::mutex> locker(m_mutex);
@@ -226,10 +280,10 @@ void RotatingLogfile::traverseFile(std::string path, std::function<void(const st
 #endif
 }
 
-std::vector<int> RotatingLogfile::findIndexList(const std::string& path, const std::string& pattern)
+void RotatingLogfile::scanFileList(const std::string& path)
 {
-    std::vector<int> indexList;
-    std::regex re(pattern);
+    std::map<int, std::string> fileMap; /* key-索引值, value-文件名 */
+    std::regex re(m_baseName + "-([0-9]+)" + m_extName + "(\\.[0-9A-Za-z]+)?"); /* 可能带压缩后缀名 */
     std::smatch results;
     traverseFile(path, [&](const std::string& fullName) {
         std::string filename = fullName;
@@ -238,36 +292,41 @@ std::vector<int> RotatingLogfile::findIndexList(const std::string& path, const s
         {
             filename = filename.substr(pos + 1, filename.size() - 1);
         }
-        if (std::regex_match(filename, results, re))
+        if (std::regex_match(filename, results, re) && ".tmp" != results[2].str())
         {
-            indexList.emplace_back(atoi(results[1].str().c_str()));
+            auto& name = fileMap[atoi(results[1].str().c_str())];
+            if (name.empty() || filename.size() < name.size()) /* 同时存在压缩文件和原文件(压缩未完成)时保留原文件 */
+            {
+                name = filename;
+            }
         }
     });
-    std::sort(indexList.begin(), indexList.end(), [](int a, int b) { return a < b; });
-    return indexList;
+    for (auto iter = fileMap.begin(); fileMap.end() != iter; ++iter)
+    {
+        const bool isLast = (std::next(iter) == fileMap.end());
+        const bool compressed = (iter->second.size() > calcFilenameByIndex(iter->first).size());
+        m_fileIndex->add(m_baseName, m_extName, iter->first, iter->second, !isLast || compressed); /* 最后的原文件继续写入 */
+    }
 }
 
 int RotatingLogfile::findLastIndex(const std::string& path, std::vector<int>& indexList)
 {
-#ifdef _WIN32
-    const std::string SLASH = "\\";
-#else
-    const std::string SLASH = "/";
-#endif
-    std::string pattern = m_baseName + "-([0-9]+)" + m_extName;
-    indexList = findIndexList(path, pattern);
+    if (!m_fileIndex->hasFamily(m_baseName, m_extName)) /* 首次运行或索引文件丢失, 扫描一次目录 */
+    {
+        scanFileList(path);
+    }
+    indexList = m_fileIndex->getIndexList(m_baseName, m_extName);
     if (indexList.empty())
     {
         return 1;
     }
-    return indexList[indexList.size() - 1];
+    const int lastIndex = indexList[indexList.size() - 1];
+    return m_fileIndex->isArchived(m_baseName, m_extName, lastIndex) ? lastIndex + 1 : lastIndex;
 }
 
 std::string RotatingLogfile::calcFilenameByIndex(int index)
 {
-    std::string filename;
-    filename.append(m_baseName).append("-").append(std::to_string(index).append(m_extName));
-    return filename;
+    return LogfileIndex::calcFilename(m_baseName, index, m_extName);
 }
 
 bool RotatingLogfile::rotateFileList()
@@ -279,8 +338,8 @@ bool RotatingLogfile::rotateFileList()
     path.append("/");
 #endif
     size_t maxSize = m_logfile->getMaxSize();
-    std::vector<int> indexList;
-    int lastIndex = findLastIndex(path, indexList);
+    std::vector<int> indexList = m_fileIndex->getIndexList(m_baseName, m_extName); /* 从文件索引获取, 不再扫描目录 */
+    int lastIndex = indexList.empty() ? m_index.load() : indexList[indexList.size() - 1];
     if (m_maxFiles > 0 && indexList.size() >= m_maxFiles) /* 已达到文件最大数 */
     {
         /* 删除最早的文件 */
@@ -289,8 +348,7 @@ bool RotatingLogfile::rotateFileList()
         {
             for (size_t i = 0; i < discardCount; ++i)
             {
-                std::string descardFullName = path + calcFilenameByIndex(indexList[i]);
-                remove(descardFullName.c_str());
+                m_fileIndex->remove(m_baseName, m_extName, indexList[i]);
             }
             indexList.erase(indexList.begin(), indexList.begin() + discardCount);
         }
@@ -301,41 +359,42 @@ bool RotatingLogfile::rotateFileList()
         else /* 允许多个文件 */
         {
             m_logfile->close();
+            m_fileIndex->archive(m_baseName, m_extName, m_index); /* 归档当前文件(后台压缩) */
             if (m_indexFixed) /* 文件索引值固定, 把后面的文件向前移 */
             {
+                m_fileIndex->remove(m_baseName, m_extName, indexList[0]);
                 for (size_t i = 1; i < indexList.size(); ++i)
                 {
-                    std::string prevFullName = path + calcFilenameByIndex(indexList[i - 1]);
-                    std::string currFullName = path + calcFilenameByIndex(indexList[i]);
-                    remove(prevFullName.c_str());
-                    if (0 != rename(currFullName.c_str(), prevFullName.c_str()))
+                    if (!m_fileIndex->move(m_baseName, m_extName, indexList[i], indexList[i - 1]))
                     {
-                        printf("move file [%s] to [%s] fail, errno[%d], desc: %s\n", currFullName.c_str(), prevFullName.c_str(), errno,
-                               strerror(errno));
                         return false;
                     }
                 }
             }
             else /* 文件索引值递增, 删除最早的文件 */
             {
-                std::string descardFullName = path + calcFilenameByIndex(indexList[0]);
-                remove(descardFullName.c_str());
+                m_fileIndex->remove(m_baseName, m_extName, indexList[0]);
                 m_index = lastIndex + 1;
             }
             m_logfile = std::make_shared<Logfile>(path, calcFilenameByIndex(m_index), maxSize);
+            m_logfile->setHeaderCallback(m_headerCb);
             m_logfile->open();
         }
     }
     else /* 不限文件个数, 或未达到最大文件数 */
     {
+        const int currIndex = m_index;
         m_index = lastIndex + 1;
         m_logfile->close();
+        m_fileIndex->archive(m_baseName, m_extName, currIndex); /* 归档当前文件(后台压缩) */
         m_logfile = std::make_shared<Logfile>(path, calcFilenameByIndex(m_index), maxSize);
+        m_logfile->setHeaderCallback(m_headerCb);
         m_logfile->open();
     }
     if (!m_logfile->isOpened())
     {
         return false;
     }
+    m_fileIndex->add(m_baseName, m_extName, m_index, m_logfile->getFilename(), false);
     return true;
 }
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "logfile.h"
+#include "logfile_index.h"
 
 /**
  * @brief 滚动日志文件
@@ -28,6 +29,24 @@ public:
 
     virtual ~RotatingLogfile() = default;
 
+    /**
+     * @brief 设置文件头回调(每次打开文件后写入, 包括滚动后的新文件)
+     * @param headerCb 文件头回调
+     */
+    void setHeaderCallback(const Logfile::HEADER_CALLBACK& headerCb);
+
+    /**
+     * @brief 设置压缩器(滚动后的文件在后台线程压缩, 同一目录共享)
+     * @param compressor 压缩器
+     */
+    void setCompressor(const LogCompressor& compressor);
+
+    /**
+     * @brief 设置目录下已归档文件的总大小预算(超过时删除最早的已归档文件, 同一目录共享)
+     * @param maxTotalSize 总大小(字节), 为0时表示不限制
+     */
+    void setMaxTotalSize(size_t maxTotalSize);
+
     /**
      * @brief 打开
      * @return true-成功, false-失败
@@ -129,6 +148,14 @@ public:
      */
     Logfile::Result record(const std::string& content, bool newline = true, bool immediateFlush = true);
 
+    /**
+     * @brief 批量记录日志内容(文件将满时自动滚动, 超过文件容量的片段被丢弃)
+     * @param sliceList 日志内容片段列表
+     * @param sliceCount 片段数量
+     * @return 操作结果
+     */
+    Logfile::Result record(const Logfile::Slice* sliceList, size_t sliceCount);
+
     /**
      * @brief 强制刷新日志内容(耗时, 调用频率不宜过高, 建议间隔1秒以上)
      * @return true-成功, false-失败
@@ -144,18 +171,16 @@ private:
     void traverseFile(std::string path, std::function<void(const std::string& fullName)> callback);
 
     /**
-     * @brief 查找指定路径下匹配的文件名索引列表
+     * @brief 扫描指定路径下匹配的文件, 建立文件索引(索引中没有该文件的记录时调用)
      * @param path 路径
-     * @param pattern 匹配模式(正则表达式)
-     * @return 匹配到的索引列表(按降序排序)
      */
-    std::vector<int> findIndexList(const std::string& path, const std::string& pattern);
+    void scanFileList(const std::string& path);
 
     /**
-     * @brief 查找指定路径下的最后的索引值
+     * @brief 查找指定路径下的最后的索引值(优先从文件索引中获取)
      * @param path 路径
-     * @param indexList [输出]匹配到的索引列表(按降序排序)
-     * @return 索引值, -1.未找到
+     * @param indexList [输出]匹配到的索引列表(按升序排序)
+     * @return 索引值(最后的文件已归档时返回下一个索引值)
      */
     int findLastIndex(const std::string& path, std::vector<int>& indexList);
 
@@ -180,4 +205,6 @@ private:
     bool m_indexFixed = false; /* 文件数最大时, 索引值固定还是递增 */
     std::mutex m_mutex; /* 互斥锁 */
     std::shared_ptr<Logfile> m_logfile = nullptr; /* 基础日志文件 */
+    Logfile::HEADER_CALLBACK m_headerCb = nullptr; /* 文件头回调 */
+    std::shared_ptr<LogfileIndex> m_fileIndex = nullptr; /* 文件索引(同一目录共享) */
 };
@@ -207,6 +207,15 @@ void Logger::fatal(const char* file, int line, const char* func, const std::stri
     fatal(file, line, func, msg.data(), msg.size());
 }
 
+int Logger::checkLevel(int level) const
+{
+    if (m_inner && level >= m_inner->getLevel())
+    {
+        return m_inner->getFormatMode();
+    }
+    return -1;
+}
+
 void Logger::forceFlush()
 {
     if (m_inner)
@@ -214,4 +223,13 @@ void Logger::forceFlush()
         m_inner->forceFlush();
     }
 }
+
+uint64_t Logger::getDropCount() const
+{
+    if (m_inner)
+    {
+        return m_inner->getDropCount();
+    }
+    return 0;
+}
 } // namespace logger
@@ -1,7 +1,9 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <type_traits>
 
+#include "binlog/binlog.h"
 #include "inner_logger.h"
 
 namespace logger
@@ -131,11 +133,52 @@ public:
     void fatal(const char* file, int line, const char* func, const char* msg, size_t msgLen) const;
     void fatal(const char* file, int line, const char* func, const std::string& msg) const;
 
+    /**
+     * @brief 检查日志等级是否需要记录, 并获取格式化模式(日志宏中调用, 不需要记录时不格式化)
+     * @param level 日志等级
+     * @return -1-不需要记录, 其他-格式化模式: FORMAT_IMMEDIATE, FORMAT_DEFERRED, FORMAT_BINARY
+     */
+    int checkLevel(int level) const;
+
+    /**
+     * @brief 打印日志(延迟格式化), 参数都是基本类型或字符串时只记录参数值, 否则在调用处格式化
+     * @param level 日志等级
+     * @param site 调用处
+     * @param args 参数列表
+     */
+    template<typename... Args>
+    void deferred(int level, const LogSite& site, const Args&... args) const
+    {
+        deferredImpl(level, site, binlog::IsDeferrable<Args...>(), args...);
+    }
+
     /**
      * @brief 强制刷新日志内容(耗时, 调用频率不宜过高, 建议间隔1秒以上)
      */
     void forceFlush();
 
+    /**
+     * @brief 获取异步模式下被丢弃的日志数量
+     * @return 丢弃数量
+     */
+    uint64_t getDropCount() const;
+
+private:
+    template<typename... Args>
+    void deferredImpl(int level, const LogSite& site, std::true_type, const Args&... args) const
+    {
+        auto& buffer = binlog::getArgBuffer();
+        buffer.clear();
+        binlog::encodeArgs(buffer, args...);
+        m_inner->printDeferred(level, m_tag, site, buffer.data(), buffer.size());
+    }
+
+    template<typename... Args>
+    void deferredImpl(int level, const LogSite& site, std::false_type, const Args&... args) const
+    {
+        m_inner->print(level, m_tag, site.file, site.line, site.func, fmt::format(site.format, args...));
+    }
+
 private:
     std::string m_tag; /* 标签 */
     std::shared_ptr<InnerLogger> m_inner = nullptr; /* 内部日志记录器 */
@@ -2,6 +2,8 @@
 #include <string>
 #include <unordered_map>
 
+#include "logfile/logfile_index.h"
+
 namespace logger
 {
 /**
@@ -14,6 +16,20 @@ const int LEVEL_WARN = 3; /* 警告, 指明可能潜在的危险状况 */
 const int LEVEL_ERROR = 4; /* 错误, 指明错误事件, 但应用可能还能继续运行 */
 const int LEVEL_FATAL = 5; /* 致命, 指明非常严重的可能会导致应用终止执行错误事件 */
 
+/**
+ * @brief 异步模式下线程缓冲区满时的处理策略
+ */
+const int ASYNC_OVERFLOW_BLOCK = 0; /* 阻塞等待后台线程写入 */
+const int ASYNC_OVERFLOW_DROP_OLDEST = 1; /* 丢弃缓冲区中最早的日志(后台线程正在写入时丢弃新日志) */
+const int ASYNC_OVERFLOW_DROP_NEW = 2; /* 丢弃新日志 */
+
+/**
+ * @brief 日志格式化模式
+ */
+const int FORMAT_IMMEDIATE = 0; /* 在调用处格式化 */
+const int FORMAT_DEFERRED = 1; /* 调用处只记录格式串和参数值, 由后台线程格式化后写入文本文件(自动启用异步模式) */
+const int FORMAT_BINARY = 2; /* 调用处只记录格式串和参数值, 由后台线程写入二进制文件(自动启用异步模式, 所有等级写入通用文件) */
+
 /**
  * @brief 日志配置
  */
@@ -23,7 +39,9 @@ struct LogConfig
     {
         if (other.path != path || other.name != name || other.fileExtName != fileExtName || other.level != level
             || other.fileMaxSize != fileMaxSize || other.fileMaxCount != fileMaxCount || other.fileIndexFixed != fileIndexFixed
-            || other.newFolderDaily != newFolderDaily || other.consoleMode != consoleMode)
+            || other.newFolderDaily != newFolderDaily || other.consoleMode != consoleMode || other.asyncMode != asyncMode
+            || other.asyncBufferSize != asyncBufferSize || other.asyncOverflow != asyncOverflow || other.formatMode != formatMode
+            || other.fileMaxTotalSize != fileMaxTotalSize || other.fileCompressor.extName != fileCompressor.extName)
         {
             return false;
         }
@@ -60,7 +78,13 @@ struct LogConfig
     size_t fileMaxSize = (20 * 1024 * 1024); /* (选填)每个日志文件最大长度(字节), 默认: 20M = 20 * 1024 * 1024 */
     size_t fileMaxCount = 0; /* (选填)每天允许最多的日志文件数, 默认: 0-表示不限制 */
     bool fileIndexFixed = false; /* 文件数最大时, 索引值固定还是递增, 默认: false-递增 */
+    size_t fileMaxTotalSize = 0; /* (选填)日志目录下已归档(已滚动)文件的总大小预算(字节), 超过时删除最早的文件, 默认: 0-表示不限制 */
+    LogCompressor fileCompressor; /* (选填)已归档文件的压缩器(后台线程压缩), 例如: LogCompressor::gzip(), 默认: 不压缩 */
     bool newFolderDaily = true; /* (选填)是否每天使用新文件夹, 默认: true-表示每天都创建新文件夹 */
     int consoleMode = 0; /* (选填)控制台日志输出模式: 0-不输出, 1-普通输出, 2-带样式输出 */
+    bool asyncMode = false; /* (选填)是否异步模式(日志写入线程缓冲区, 由后台线程批量写入文件), 创建记录器后不能修改, 默认: false */
+    size_t asyncBufferSize = (1024 * 1024); /* (选填)异步模式下每个线程的缓冲区大小(字节), 默认: 1M */
+    int asyncOverflow = ASYNC_OVERFLOW_BLOCK; /* (选填)异步模式下缓冲区满时的处理策略, 默认: ASYNC_OVERFLOW_BLOCK */
+    int formatMode = FORMAT_IMMEDIATE; /* (选填)格式化模式, 二进制模式下建议扩展名使用".blog", 创建记录器后不能修改, 默认: FORMAT_IMMEDIATE */
 };
 } // namespace logger
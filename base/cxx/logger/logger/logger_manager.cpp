@@ -272,6 +272,18 @@ void LoggerManager::forceFlush(const std::string& loggerName)
     }
 }
 
+uint64_t LoggerManager::getDropCount(const std::string& loggerName)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    auto name = loggerName.empty() ? m_logCfg.name : loggerName;
+    auto iter = m_loggerMap.find(name);
+    if (m_loggerMap.end() == iter)
+    {
+        return 0;
+    }
+    return iter->second->getDropCount();
+}
+
 InnerLoggerPtr LoggerManager::createInnerLogger(const LogConfig& cfg)
 {
     return std::make_shared<InnerLoggerImpl>(cfg);
@@ -7,19 +7,49 @@
 #include "logger.h"
 #include "logger_define.h"
 
-#define __LOGGER_LOG_IMPL__(logger, func, filename, lineNumber, funcName, f, ...) \
-    try \
-    { \
-        (logger).func(filename, lineNumber, funcName, fmt::format(FMT_STRING(f), ##__VA_ARGS__)); \
-    } \
-    catch (const std::exception& e) \
-    { \
-        (logger).warn(filename, lineNumber, funcName, e.what(), strlen(e.what())); \
-    } \
-    catch (...) \
+/* 日志函数名对应的日志等级 */
+#define __LOGGER_LEVEL_trace__ ::logger::LEVEL_TRACE
+#define __LOGGER_LEVEL_debug__ ::logger::LEVEL_DEBUG
+#define __LOGGER_LEVEL_info__ ::logger::LEVEL_INFO
+#define __LOGGER_LEVEL_warn__ ::logger::LEVEL_WARN
+#define __LOGGER_LEVEL_error__ ::logger::LEVEL_ERROR
+#define __LOGGER_LEVEL_fatal__ ::logger::LEVEL_FATAL
+
+/**
+ * @brief 日志宏实现, 说明:
+ *        1.先检查日志等级, 不需要记录时不格式化
+ *        2.延迟格式化/二进制模式下, 每个调用处注册一次(静态变量), 之后只记录调用处ID和参数值, 由后台线程格式化
+ */
+#define __LOGGER_LOG_IMPL__(lg, func, filename, lineNumber, funcName, f, ...) \
+    do \
     { \
-        (logger).warn(filename, lineNumber, funcName, "unknown exception", strlen("unknown exception")); \
-    }
+        auto&& __loggerRef__ = (lg); /* 只求值1次 */ \
+        const int __loggerFormatMode__ = __loggerRef__.checkLevel(__LOGGER_LEVEL_##func##__); \
+        if (__loggerFormatMode__ < 0) \
+        { \
+            break; \
+        } \
+        try \
+        { \
+            if (::logger::FORMAT_IMMEDIATE == __loggerFormatMode__) \
+            { \
+                __loggerRef__.func(filename, lineNumber, funcName, fmt::format(FMT_STRING(f), ##__VA_ARGS__)); \
+            } \
+            else \
+            { \
+                static const ::logger::LogSite __loggerSite__(filename, lineNumber, funcName, f); \
+                __loggerRef__.deferred(__LOGGER_LEVEL_##func##__, __loggerSite__, ##__VA_ARGS__); \
+            } \
+        } \
+        catch (const std::exception& e) \
+        { \
+            __loggerRef__.warn(filename, lineNumber, funcName, e.what(), strlen(e.what())); \
+        } \
+        catch (...) \
+        { \
+            __loggerRef__.warn(filename, lineNumber, funcName, "unknown exception", strlen("unknown exception")); \
+        } \
+    } while (0)
 
 #ifdef _WIN32
 #define __LOGGER_FILENAME__(x) strrchr(x, '\\') ? strrchr(x, '\\') + 1 : x
@@ -198,6 +228,13 @@ public:
      */
     static void forceFlush(const std::string& loggerName = std::string());
 
+    /**
+     * @brief 获取异步模式下被丢弃的日志数量
+     * @param loggerName 日志记录器名称(选填)
+     * @return 丢弃数量
+     */
+    static uint64_t getDropCount(const std::string& loggerName = std::string());
+
 private:
     /**
      * @brief 创建内部日志记录器
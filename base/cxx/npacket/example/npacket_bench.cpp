@@ -0,0 +1,933 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "npacket/analyzer.h"
+#include "npacket/pcap_file.h"
+#include "npacket/proto/ftp.h"
+#include "npacket/proto/iec103.h"
+#include "npacket/proto/modbus_rtu.h"
+#include "npacket/proto/modbus_tcp.h"
+#include "npacket/proto/s7comm.h"
+#include "npacket/proto/tpkt_cotp.h"
+#include "npacket/sharded_analyzer.h"
+
+/**
+ * @brief 数据包
+ */
+struct BenchPacket
+{
+    std::vector<uint8_t> data; /* 数据(以太网帧) */
+};
+
+static std::atomic<size_t> s_modbusCount = {0}; /* 解析出的Modbus帧数量 */
+static std::atomic<size_t> s_detectCount = {0}; /* 协议识别测试中解析出的帧数量 */
+static std::atomic<size_t> s_allocCount = {0}; /* 堆分配次数 */
+
+/**
+ * @brief 统计堆分配次数(用于解码测试)
+ */
+void* operator new(size_t size)
+{
+    s_allocCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size > 0 ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t size) noexcept
+{
+    free(p);
+}
+
+/**
+ * @brief 读取抓包文件(pcap或pcapng格式, 只保留链路类型为以太网的数据包)
+ * @param filename 文件名
+ * @param pktList [输出]数据包列表
+ * @return true-成功, false-失败
+ */
+bool loadPcapFile(const std::string& filename, std::vector<BenchPacket>& pktList)
+{
+    npacket::PcapFileReader reader;
+    std::string errorDesc;
+    if (!reader.open(filename, &errorDesc))
+    {
+        printf("打开文件失败: %s\n", errorDesc.c_str());
+        return false;
+    }
+    npacket::PcapFilePacket pkt;
+    while (reader.next(pkt))
+    {
+        if (1 == pkt.linkType) /* LINKTYPE_ETHERNET */
+        {
+            BenchPacket item;
+            item.data.assign(pkt.data, pkt.data + pkt.capLen);
+            pktList.emplace_back(std::move(item));
+        }
+    }
+    if (reader.isTruncated())
+    {
+        printf("文件已损坏或被截断, 只读取了前 %zu 个包\n", pktList.size());
+    }
+    return true;
+}
+
+/**
+ * @brief 生成模拟数据包(多个Modbus/TCP流, 请求和响应交替)
+ * @param flowCount 流数量
+ * @param pktCount 数据包数量
+ * @param pktList [输出]数据包列表
+ */
+void generatePackets(size_t flowCount, size_t pktCount, std::vector<BenchPacket>& pktList)
+{
+    std::vector<uint32_t> seqList(flowCount * 2, 1000); /* 每个流两个方向的序列号 */
+    for (size_t i = 0; i < pktCount; ++i)
+    {
+        const size_t flow = i % flowCount;
+        const bool isRequest = (0 == (i / flowCount) % 2);
+        const uint8_t clientIp[4] = {10, 0, (uint8_t)(flow >> 8), (uint8_t)flow};
+        const uint8_t serverIp[4] = {192, 168, 1, 10};
+        const uint16_t clientPort = (uint16_t)(20000 + flow % 40000);
+        const uint16_t serverPort = 502;
+        const uint16_t transactionId = (uint16_t)(i / flowCount / 2);
+        /* Modbus: 读保持寄存器请求(12字节)/响应(9+2*4字节) */
+        std::vector<uint8_t> modbus;
+        if (isRequest)
+        {
+            modbus = {(uint8_t)(transactionId >> 8), (uint8_t)transactionId, 0, 0, 0, 6, 1, 3, 0, 0, 0, 4};
+        }
+        else
+        {
+            modbus = {(uint8_t)(transactionId >> 8), (uint8_t)transactionId, 0, 0, 0, 11, 1, 3, 8, 0, 1, 0, 2, 0, 3, 0, 4};
+        }
+        BenchPacket pkt;
+        auto& d = pkt.data;
+        d.resize(14 + 20 + 20 + modbus.size(), 0);
+        /* 以太网 */
+        const uint8_t mac1[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55}, mac2[6] = {0x00, 0x66, 0x77, 0x88, 0x99, 0xaa};
+        memcpy(&d[0], isRequest ? mac2 : mac1, 6);
+        memcpy(&d[6], isRequest ? mac1 : mac2, 6);
+        d[12] = 0x08;
+        d[13] = 0x00;
+        /* IPv4 */
+        uint8_t* ip = &d[14];
+        const uint16_t totalLen = (uint16_t)(20 + 20 + modbus.size());
+        ip[0] = 0x45;
+        ip[2] = (uint8_t)(totalLen >> 8);
+        ip[3] = (uint8_t)totalLen;
+        ip[8] = 64;
+        ip[9] = 6;
+        memcpy(ip + 12, isRequest ? clientIp : serverIp, 4);
+        memcpy(ip + 16, isRequest ? serverIp : clientIp, 4);
+        /* TCP */
+        uint8_t* tcp = ip + 20;
+        const uint16_t srcPort = isRequest ? clientPort : serverPort, dstPort = isRequest ? serverPort : clientPort;
+        tcp[0] = (uint8_t)(srcPort >> 8);
+        tcp[1] = (uint8_t)srcPort;
+        tcp[2] = (uint8_t)(dstPort >> 8);
+        tcp[3] = (uint8_t)dstPort;
+        auto& seq = seqList[flow * 2 + (isRequest ? 0 : 1)];
+        auto& ack = seqList[flow * 2 + (isRequest ? 1 : 0)];
+        const uint32_t seqValue = seq, ackValue = ack;
+        for (int k = 0; k < 4; ++k)
+        {
+            tcp[4 + k] = (uint8_t)(seqValue >> (24 - 8 * k));
+            tcp[8 + k] = (uint8_t)(ackValue >> (24 - 8 * k));
+        }
+        tcp[12] = 0x50;
+        tcp[13] = 0x18; /* PSH|ACK */
+        tcp[14] = 0xff;
+        tcp[15] = 0xff;
+        memcpy(tcp + 20, modbus.data(), modbus.size());
+        seq += (uint32_t)modbus.size();
+        pktList.emplace_back(std::move(pkt));
+    }
+}
+
+/**
+ * @brief 加入重组压力(模拟丢包链路和分片洪泛): 同一流同一方向相隔2轮的数据包交换顺序(产生乱序分段),
+ *        并每隔8个包插入1个永远收不齐的IP分片(只有首片)
+ * @param flowCount 流数量
+ * @param pktList [输入/输出]数据包列表
+ */
+void addReassemblyStress(size_t flowCount, std::vector<BenchPacket>& pktList)
+{
+    for (size_t i = 0; i + 2 * flowCount < pktList.size(); i += 4 * flowCount + 1) /* 每4轮交换1次, 错开不同的流 */
+    {
+        std::swap(pktList[i], pktList[i + 2 * flowCount]);
+    }
+    std::vector<BenchPacket> result;
+    result.reserve(pktList.size() + pktList.size() / 8 + 1);
+    uint16_t identification = 0;
+    for (size_t i = 0; i < pktList.size(); ++i)
+    {
+        result.emplace_back(std::move(pktList[i]));
+        if (7 != i % 8)
+        {
+            continue;
+        }
+        BenchPacket pkt;
+        auto& d = pkt.data;
+        d.resize(14 + 20 + 1480, 0x5a);
+        memset(&d[0], 0, 12);
+        d[12] = 0x08;
+        d[13] = 0x00;
+        uint8_t* ip = &d[14];
+        const uint16_t totalLen = 20 + 1480;
+        ++identification;
+        ip[0] = 0x45;
+        ip[1] = 0;
+        ip[2] = (uint8_t)(totalLen >> 8);
+        ip[3] = (uint8_t)totalLen;
+        ip[4] = (uint8_t)(identification >> 8);
+        ip[5] = (uint8_t)identification;
+        ip[6] = 0x20; /* MF=1, 偏移=0 */
+        ip[7] = 0;
+        ip[8] = 64;
+        ip[9] = 17; /* UDP */
+        const uint8_t srcIp[4] = {172, 16, (uint8_t)(i >> 16), (uint8_t)(i >> 8)}, dstIp[4] = {192, 168, 1, 20};
+        memcpy(ip + 12, srcIp, 4);
+        memcpy(ip + 16, dstIp, 4);
+        result.emplace_back(std::move(pkt));
+    }
+    pktList.swap(result);
+}
+
+/**
+ * @brief 打印重组内存统计
+ * @param stat 统计
+ */
+void printReassemblyStat(const npacket::ReassemblyStat& stat)
+{
+    printf("    重组内存 上限: %.1f MB, 已用: %.1f MB, 已申请: %.1f MB, 缓存数据: %.1f MB, 淘汰流: %zu (%.1f MB), 分配失败: %zu\n",
+           stat.maxMemory / 1048576.0, stat.usedMemory / 1048576.0, stat.reservedMemory / 1048576.0, stat.dataBytes / 1048576.0,
+           stat.evictedFlows, stat.evictedBytes / 1048576.0, stat.allocFailures);
+}
+
+/**
+ * @brief 打印结果
+ * @param name 名称
+ * @param pktCount 数据包数量
+ * @param byteCount 数据包总字节数
+ * @param elapsed 总耗时
+ */
+void printResult(const std::string& name, size_t pktCount, uint64_t byteCount, const std::chrono::steady_clock::duration& elapsed)
+{
+    const double sec = std::chrono::duration<double>(elapsed).count();
+    printf("%-24s 包数: %zu, 耗时: %.3f 秒, 吞吐: %.0f 包/秒, %.1f MB/秒, Modbus帧: %zu\n", name.c_str(), pktCount, sec, pktCount / sec,
+           byteCount / 1048576.0 / sec, s_modbusCount.load());
+}
+
+/**
+ * @brief 回放测试: 直接从文件映射内存读取数据包送入分析器(不预先拷贝), 使用文件中的原始时间戳作为接收时间点,
+ *        可以按原始速率(或倍速)回放以复现现场的流过期/重组超时行为
+ * @param filename 文件名
+ * @param speed 回放速度, <=0表示全速
+ * @param repeat 回放次数
+ * @param memoryCfg 重组内存配置
+ */
+void benchReplay(const std::string& filename, double speed, size_t repeat, const npacket::ReassemblyMemoryConfig& memoryCfg)
+{
+    npacket::PcapFileReader reader;
+    std::string errorDesc;
+    if (!reader.open(filename, &errorDesc))
+    {
+        printf("打开文件失败: %s\n", errorDesc.c_str());
+        return;
+    }
+    printf("%s文件: %s, 大小: %.1f MB, 回放速度: %s\n", npacket::PcapFileFormat::PCAPNG == reader.getFormat() ? "pcapng" : "pcap",
+           filename.c_str(), reader.getFileSize() / 1048576.0, speed > 0 ? (std::to_string(speed) + "倍").c_str() : "全速");
+    s_modbusCount = 0;
+    auto parser = std::make_shared<npacket::ModbusTcpParser>();
+    parser->setDataCallback([](const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen, const npacket::ProtocolHeader* header,
+                               const npacket::modbus::DataSt& data) { ++s_modbusCount; });
+    npacket::Analyzer analyzer(npacket::CallbackConfig(), npacket::IpReassemblyConfig(), npacket::TcpReassemblyConfig(), memoryCfg);
+    analyzer.addProtocolParser(parser, {502});
+    size_t num = 0;
+    uint64_t byteCount = 0;
+    const auto tp = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeat; ++r)
+    {
+        reader.rewind();
+        reader.replay(
+            [&](const npacket::PcapFilePacket& pkt, const std::chrono::steady_clock::time_point& ntp) {
+                if (1 == pkt.linkType)
+                {
+                    analyzer.parse(0, ++num, ntp, pkt.data, pkt.capLen);
+                    byteCount += pkt.capLen;
+                }
+                return true;
+            },
+            speed);
+    }
+    printResult("回放Analyzer(1线程)", num, byteCount, std::chrono::steady_clock::now() - tp);
+    printReassemblyStat(analyzer.getReassemblyStat());
+    if (reader.isTruncated())
+    {
+        printf("    文件已损坏或被截断\n");
+    }
+}
+
+/**
+ * @brief 流过期测试: 每个流发送4个数据包后不再活动, 模拟时钟每包前进10微秒(10万包/秒),
+ *        存活流数量约为 超时时间/40微秒, 统计单包解析延迟分布(过期清理的开销体现在尾延迟上)
+ * @param pktCount 数据包数量
+ */
+void benchFlowExpiry(size_t pktCount)
+{
+    size_t endCount[4] = {0};
+    npacket::CallbackConfig cbCfg;
+    cbCfg.flowEndCb = [&](const std::chrono::steady_clock::time_point& ntp, const npacket::TcpStreamKey& key,
+                          npacket::FlowEndReason reason) { ++endCount[(int)reason]; };
+    npacket::TcpReassemblyConfig tcpCfg;
+    tcpCfg.timeout = 1000;
+    tcpCfg.maxCacheCount = 100000;
+    npacket::Analyzer analyzer(cbCfg, npacket::IpReassemblyConfig(), tcpCfg);
+    /* 数据包模板: 以太网 + IPv4 + TCP(PSH|ACK) + 12字节负载, 每个包只修改源地址/源端口/序列号 */
+    std::vector<uint8_t> d(14 + 20 + 20 + 12, 0);
+    d[12] = 0x08;
+    uint8_t* ip = &d[14];
+    ip[0] = 0x45;
+    ip[3] = 52;
+    ip[8] = 64;
+    ip[9] = 6;
+    ip[16] = 192;
+    ip[17] = 168;
+    ip[18] = 1;
+    ip[19] = 10;
+    uint8_t* tcp = ip + 20;
+    tcp[2] = 0x01;
+    tcp[3] = 0xf6; /* 502 */
+    tcp[12] = 0x50;
+    tcp[13] = 0x18;
+    tcp[14] = 0xff;
+    std::vector<int64_t> latencyList;
+    latencyList.reserve(pktCount);
+    const auto tp = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pktCount; ++i)
+    {
+        const size_t flow = i / 4;
+        const uint32_t seq = 1000 + (uint32_t)(i % 4) * 12;
+        ip[12] = 10;
+        ip[13] = (uint8_t)(flow >> 16);
+        ip[14] = (uint8_t)(flow >> 8);
+        ip[15] = (uint8_t)flow;
+        tcp[0] = (uint8_t)(flow >> 24);
+        tcp[1] = 1;
+        for (int k = 0; k < 4; ++k)
+        {
+            tcp[4 + k] = (uint8_t)(seq >> (24 - 8 * k));
+        }
+        const auto ntp = tp + std::chrono::microseconds(i * 10);
+        const auto tp1 = std::chrono::steady_clock::now();
+        analyzer.parse(0, i, ntp, d.data(), (uint32_t)d.size());
+        const auto tp2 = std::chrono::steady_clock::now();
+        latencyList.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(tp2 - tp1).count());
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    std::sort(latencyList.begin(), latencyList.end());
+    const size_t n = latencyList.size();
+    printf("%-24s 包数: %zu, 耗时: %.3f 秒, 单包延迟(ns) p50: %lld, p99: %lld, p99.99: %lld, max: %lld\n", "流过期(1线程)", n, sec,
+           (long long)latencyList[n / 2], (long long)latencyList[n * 99 / 100], (long long)latencyList[n * 9999 / 10000],
+           (long long)latencyList.back());
+    printf("    流结束 FIN: %zu, RST: %zu, 超时: %zu, 淘汰: %zu\n", endCount[(int)npacket::FlowEndReason::FIN],
+           endCount[(int)npacket::FlowEndReason::RST], endCount[(int)npacket::FlowEndReason::TIMEOUT],
+           endCount[(int)npacket::FlowEndReason::EVICTED]);
+}
+
+/**
+ * @brief 只有特征的模拟解析器(用于尚未实现的协议): 负载符合特征时消费全部数据, 否则失败
+ */
+class SignatureParser : public npacket::ProtocolParser
+{
+public:
+    SignatureParser(uint32_t protocol, const std::vector<npacket::ProtocolSignature>& sigList, bool declare)
+        : m_protocol(protocol), m_signatureList(sigList), m_declare(declare)
+    {
+    }
+
+    uint32_t getProtocol() const noexcept override
+    {
+        return m_protocol;
+    }
+
+    std::vector<npacket::ProtocolSignature> getSignatures() const override
+    {
+        return m_declare ? m_signatureList : std::vector<npacket::ProtocolSignature>();
+    }
+
+    npacket::ParseResult parse(const npacket::ProtocolData& pd, uint32_t& consumeLen) override
+    {
+        for (const auto& sig : m_signatureList)
+        {
+            if (sig.offset < 0 || (size_t)sig.offset + sig.pattern.size() > pd.payloadLen)
+            {
+                continue;
+            }
+            bool match = true;
+            for (size_t i = 0; i < sig.pattern.size() && match; ++i)
+            {
+                const uint8_t mask = sig.mask.empty() ? 0xFF : sig.mask[i];
+                match = ((pd.payload[sig.offset + i] & mask) == (sig.pattern[i] & mask));
+            }
+            if (match)
+            {
+                consumeLen = pd.payloadLen;
+                ++s_detectCount;
+                return npacket::ParseResult::SUCCESS;
+            }
+        }
+        return npacket::ParseResult::FAILURE;
+    }
+
+private:
+    const uint32_t m_protocol; /* 协议 */
+    const std::vector<npacket::ProtocolSignature> m_signatureList; /* 特征列表 */
+    const bool m_declare; /* 是否向分析器声明特征 */
+};
+
+/**
+ * @brief 不声明特征的解析器(对比测试用)
+ */
+template<typename T>
+class NoSignatureParser : public T
+{
+public:
+    using T::T;
+
+    std::vector<npacket::ProtocolSignature> getSignatures() const override
+    {
+        return {};
+    }
+};
+
+/**
+ * @brief 添加全部解析器(5个已实现的解析器 + 15个只有特征的模拟解析器, 均不绑定端口)
+ * @param analyzer 分析器
+ * @param declare 是否声明特征
+ */
+void addDetectionParsers(npacket::Analyzer& analyzer, bool declare)
+{
+    using namespace npacket;
+    using Sig = ProtocolSignature;
+    auto text = [](const auto& str) { return std::vector<uint8_t>(str, str + sizeof(str) - 1); }; /* 字符串常量(可包含0) */
+    std::shared_ptr<ModbusTcpParser> modbusTcp;
+    if (declare)
+    {
+        analyzer.addProtocolParser(std::make_shared<TpktCotpParser>());
+        analyzer.addProtocolParser(std::make_shared<Iec103Parser>());
+        modbusTcp = std::make_shared<ModbusTcpParser>();
+    }
+    else
+    {
+        analyzer.addProtocolParser(std::make_shared<NoSignatureParser<TpktCotpParser>>());
+        analyzer.addProtocolParser(std::make_shared<NoSignatureParser<Iec103Parser>>());
+        modbusTcp = std::make_shared<NoSignatureParser<ModbusTcpParser>>();
+    }
+    modbusTcp->setDataCallback([](const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen, const ProtocolHeader* header,
+                                  const modbus::DataSt& data) { ++s_detectCount; });
+    analyzer.addProtocolParser(modbusTcp);
+    analyzer.addProtocolParser(std::make_shared<FtpParser>());
+    analyzer.addProtocolParser(std::make_shared<ModbusRtuParser>(true));
+    const std::vector<std::pair<uint32_t, std::vector<Sig>>> stubList = {
+        {ApplicationProtocol::AMQP, {Sig(0, text("AMQP"))}},
+        {ApplicationProtocol::BACNET, {Sig(0, {0x81})}},
+        {ApplicationProtocol::DNP3, {Sig(0, {0x05, 0x64})}},
+        {ApplicationProtocol::ETHERNET_IP, {Sig(0, {0x65, 0x00}), Sig(0, {0x6F, 0x00}), Sig(0, {0x70, 0x00})}},
+        {ApplicationProtocol::HTTP, {Sig(0, text("GET ")), Sig(0, text("POST ")), Sig(0, text("HTTP/1.")), Sig(-1, text(" HTTP/1.1\r\n"))}},
+        {ApplicationProtocol::IEC104, {Sig(0, {0x68, 0x04}), Sig(0, {0x68, 0x00, 0x00}, {0xFF, 0x00, 0x01})}},
+        {ApplicationProtocol::MQTT, {Sig(0, {0x10, 0x00, 0x00, 0x04}, {0xFF, 0x00, 0xFF, 0xFF}), Sig(0, {0x20, 0x02})}},
+        {ApplicationProtocol::NFS, {Sig(20, {0x00, 0x01, 0x86, 0xA3})}},
+        {ApplicationProtocol::OMRON_FINS, {Sig(0, text("FINS"))}},
+        {ApplicationProtocol::OPC_UA, {Sig(0, text("HELF")), Sig(0, text("ACKF")), Sig(0, text("OPNF")), Sig(0, text("MSGF"))}},
+        {ApplicationProtocol::POP3, {Sig(0, text("+OK")), Sig(0, text("-ERR")), Sig(0, text("USER "))}},
+        {ApplicationProtocol::PROFINET, {Sig(0, {0x04, 0x00, 0x20}, {0xFF, 0x00, 0xFF})}},
+        {ApplicationProtocol::SMB2, {Sig(4, {0xFE, 'S', 'M', 'B'})}},
+        {ApplicationProtocol::SMTP, {Sig(0, text("220 ")), Sig(0, text("EHLO ")), Sig(0, text("HELO "))}},
+        {ApplicationProtocol::TELNET, {Sig(0, {0xFF, 0xF0}, {0xFF, 0xF0})}},
+    };
+    for (const auto& item : stubList)
+    {
+        analyzer.addProtocolParser(std::make_shared<SignatureParser>(item.first, item.second, declare));
+    }
+}
+
+/**
+ * @brief 模拟流量
+ */
+struct Traffic
+{
+    uint16_t port; /* 服务端端口 */
+    std::vector<uint8_t> request; /* 请求负载 */
+    std::vector<uint8_t> response; /* 响应负载 */
+};
+
+/**
+ * @brief 生成TCP流量, 第i个流使用trafficList[i % trafficList.size()], 每个流请求和响应交替
+ * @param trafficList 流量列表
+ * @param flowCount 流数量
+ * @param pktCount 数据包数量
+ * @param pktList [输出]数据包列表
+ */
+void generateTrafficPackets(const std::vector<Traffic>& trafficList, size_t flowCount, size_t pktCount, std::vector<BenchPacket>& pktList)
+{
+    std::vector<uint32_t> seqList(flowCount * 2, 1000); /* 每个流两个方向的序列号 */
+    for (size_t i = 0; i < pktCount; ++i)
+    {
+        const size_t flow = i % flowCount;
+        const bool isRequest = (0 == (i / flowCount) % 2);
+        const auto& traffic = trafficList[flow % trafficList.size()];
+        const auto& payload = isRequest ? traffic.request : traffic.response;
+        BenchPacket pkt;
+        auto& d = pkt.data;
+        d.resize(14 + 20 + 20 + payload.size(), 0);
+        d[12] = 0x08;
+        uint8_t* ip = &d[14];
+        const uint16_t totalLen = (uint16_t)(20 + 20 + payload.size());
+        ip[0] = 0x45;
+        ip[2] = (uint8_t)(totalLen >> 8);
+        ip[3] = (uint8_t)totalLen;
+        ip[8] = 64;
+        ip[9] = 6;
+        const uint8_t clientIp[4] = {10, (uint8_t)(flow >> 16), (uint8_t)(flow >> 8), (uint8_t)flow};
+        const uint8_t serverIp[4] = {192, 168, 1, 10};
+        memcpy(ip + 12, isRequest ? clientIp : serverIp, 4);
+        memcpy(ip + 16, isRequest ? serverIp : clientIp, 4);
+        uint8_t* tcp = ip + 20;
+        const uint16_t clientPort = (uint16_t)(20000 + flow % 40000);
+        const uint16_t srcPort = isRequest ? clientPort : traffic.port, dstPort = isRequest ? traffic.port : clientPort;
+        tcp[0] = (uint8_t)(srcPort >> 8);
+        tcp[1] = (uint8_t)srcPort;
+        tcp[2] = (uint8_t)(dstPort >> 8);
+        tcp[3] = (uint8_t)dstPort;
+        auto& seq = seqList[flow * 2 + (isRequest ? 0 : 1)];
+        for (int k = 0; k < 4; ++k)
+        {
+            tcp[4 + k] = (uint8_t)(seq >> (24 - 8 * k));
+        }
+        tcp[12] = 0x50;
+        tcp[13] = 0x18; /* PSH|ACK */
+        tcp[14] = 0xff;
+        tcp[15] = 0xff;
+        memcpy(tcp + 20, payload.data(), payload.size());
+        seq += (uint32_t)payload.size();
+        pktList.emplace_back(std::move(pkt));
+    }
+}
+
+/**
+ * @brief 生成混合工业流量(Modbus/TCP, S7(TPKT), IEC103, DNP3, IEC104, EtherNet/IP, MQTT, OPC UA, HTTP, FINS), 每个流请求和响应交替
+ * @param flowCount 流数量
+ * @param pktCount 数据包数量
+ * @param pktList [输出]数据包列表
+ */
+void generateMixedPackets(size_t flowCount, size_t pktCount, std::vector<BenchPacket>& pktList)
+{
+    auto text = [](const auto& str) { return std::vector<uint8_t>(str, str + sizeof(str) - 1); }; /* 字符串常量(可包含0) */
+    const std::vector<Traffic> trafficList = {
+        {502, {0, 1, 0, 0, 0, 6, 1, 3, 0, 0, 0, 4}, {0, 1, 0, 0, 0, 11, 1, 3, 8, 0, 1, 0, 2, 0, 3, 0, 4}},
+        {102,
+         {0x03, 0x00, 0x00, 0x16, 0x11, 0xE0, 0x00, 0x00, 0x00, 0x01, 0x00, 0xC1, 0x02, 0x01, 0x00, 0xC2, 0x02, 0x01, 0x02, 0xC0, 0x01, 0x0A},
+         {0x03, 0x00, 0x00, 0x16, 0x11, 0xD0, 0x00, 0x01, 0x00, 0x01, 0x00, 0xC1, 0x02, 0x01, 0x00, 0xC2, 0x02, 0x01, 0x02, 0xC0, 0x01, 0x0A}},
+        {1048, {0x10, 0x5A, 0x01, 0x5B, 0x16}, {0x10, 0x09, 0x01, 0x0A, 0x16}},
+        {20000, {0x05, 0x64, 0x05, 0xC9, 0x01, 0x00, 0x00, 0x04, 0x9E, 0x18}, {0x05, 0x64, 0x05, 0x0B, 0x00, 0x04, 0x01, 0x00, 0x8A, 0x8E}},
+        {2404, {0x68, 0x04, 0x07, 0x00, 0x00, 0x00}, {0x68, 0x04, 0x0B, 0x00, 0x00, 0x00}},
+        {44818, {0x65, 0x00, 0x04, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0x00, 0x00, 0x00},
+         {0x65, 0x00, 0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01, 0x00, 0x00, 0x00}},
+        {1883, {0x10, 0x0C, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02, 0x00, 0x3C, 0x00, 0x00}, {0x20, 0x02, 0x00, 0x00}},
+        {4840, text("HELF\x1c\0\0\0\0\0\0\0\0\0\1\0\0\0\1\0\0\0\0\0\0\0\0\0"),
+         text("ACKF\x1c\0\0\0\0\0\0\0\0\0\1\0\0\0\1\0\0\0\0\0\0\0\0\0")},
+        {80, text("GET /index.html HTTP/1.1\r\nHost: 192.168.1.10\r\n\r\n"), text("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n")},
+        {9600, text("FINS\0\0\0\x0c\0\0\0\0\0\0\0\0\0\0\0\0"), text("FINS\0\0\0\x10\0\0\0\1\0\0\0\0\0\0\0\1\0\0\0\x0a")},
+    };
+    generateTrafficPackets(trafficList, flowCount, pktCount, pktList);
+}
+
+/**
+ * @brief 协议识别测试: 混合工业流量, 注册20个解析器(均不绑定端口), 对比声明特征(特征过滤)和不声明特征(逐个尝试)的吞吐,
+ *        长流场景下流识别结果缓存后两者差别不大, 短流场景(每个流每个方向只有1个包)每个包都需要识别
+ * @param flowCount 流数量
+ * @param pktCount 数据包数量
+ */
+void benchDetection(size_t flowCount, size_t pktCount)
+{
+    for (int shortFlow = 0; shortFlow < 2; ++shortFlow)
+    {
+        const size_t count = shortFlow ? std::max(pktCount / 2, (size_t)1) : flowCount;
+        std::vector<BenchPacket> pktList;
+        generateMixedPackets(count, pktCount, pktList);
+        printf("混合流量(%s): %zu 个流, %zu 个包\n", shortFlow ? "短流" : "长流", count, pktList.size());
+        for (int declare = 0; declare < 2; ++declare)
+        {
+            s_detectCount = 0;
+            npacket::TcpReassemblyConfig tcpCfg;
+            tcpCfg.maxCacheCount = std::min(std::max(tcpCfg.maxCacheCount, count * 2), (size_t)100000);
+            npacket::Analyzer analyzer(npacket::CallbackConfig(), npacket::IpReassemblyConfig(), tcpCfg);
+            addDetectionParsers(analyzer, 1 == declare);
+            const auto tp = std::chrono::steady_clock::now();
+            size_t num = 0;
+            for (const auto& pkt : pktList)
+            {
+                analyzer.parse(0, ++num, tp, pkt.data.data(), (uint32_t)pkt.data.size());
+            }
+            const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+            printf("    %-20s 耗时: %.3f 秒, 吞吐: %.0f 包/秒, 识别帧: %zu\n", declare ? "特征识别(20解析器)" : "逐个尝试(20解析器)", sec,
+                   pktList.size() / sec, s_detectCount.load());
+        }
+    }
+}
+
+/**
+ * @brief 生成工控解码流量(IEC103召唤/被测值/通用分类数据/带时标报文, S7COMM读写变量请求和响应), 每个流请求和响应交替
+ * @param flowCount 流数量
+ * @param pktCount 数据包数量
+ * @param pktList [输出]数据包列表
+ */
+void generateDecodePackets(size_t flowCount, size_t pktCount, std::vector<BenchPacket>& pktList)
+{
+    auto iec103 = [](const std::vector<uint8_t>& asdu) { /* IEC103可变帧: 68H L L 68H C A ASDU CS 16H */
+        std::vector<uint8_t> frame = {0x68, (uint8_t)(asdu.size() + 2), (uint8_t)(asdu.size() + 2), 0x68, 0x08, 0x01};
+        frame.insert(frame.end(), asdu.begin(), asdu.end());
+        uint8_t cs = 0;
+        for (size_t i = 4; i < frame.size(); ++i)
+        {
+            cs += frame[i];
+        }
+        frame.insert(frame.end(), {cs, 0x16});
+        return frame;
+    };
+    auto s7comm = [](const std::vector<uint8_t>& header, const std::vector<uint8_t>& param, const std::vector<uint8_t>& data) {
+        const size_t len = 4 + 3 + header.size() + param.size() + data.size();
+        std::vector<uint8_t> frame = {0x03, 0x00, (uint8_t)(len >> 8), (uint8_t)len, 0x02, 0xF0, 0x80}; /* TPKT + COTP(DT) */
+        frame.resize(len);
+        uint8_t* s7 = &frame[7];
+        std::copy(header.begin(), header.end(), s7);
+        s7[6] = (uint8_t)(param.size() >> 8); /* S7COMM头部的参数长度和数据长度 */
+        s7[7] = (uint8_t)param.size();
+        s7[8] = (uint8_t)(data.size() >> 8);
+        s7[9] = (uint8_t)data.size();
+        std::copy(param.begin(), param.end(), s7 + header.size());
+        std::copy(data.begin(), data.end(), s7 + header.size() + param.size());
+        return frame;
+    };
+    const uint8_t itemCount = 8;
+    std::vector<uint8_t> asdu9 = {0x09, 0x09, 0x02, 0x01, 0xB2, 0x94}, asdu10 = {0x0A, 0x81, 0x2A, 0x01, 0xFE, 0xF1, 0x00, 0x04};
+    for (int i = 0; i < 9; ++i) /* 9个被测值 */
+    {
+        asdu9.insert(asdu9.end(), {(uint8_t)(i << 3), 0x10});
+    }
+    for (uint8_t i = 0; i < 4; ++i) /* 4个数据集, 每个2个IEEE754短实数 */
+    {
+        asdu10.insert(asdu10.end(), {0x02, i, 0x01, 0x07, 0x04, 0x02, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x40});
+    }
+    std::vector<uint8_t> readParam = {0x04, itemCount}, readData, writeParam = {0x05, itemCount}, writeData, writeAck;
+    for (uint8_t i = 0; i < itemCount; ++i)
+    {
+        const uint8_t addr[] = {(uint8_t)(i >> 5), (uint8_t)(i << 3)};
+        const std::vector<uint8_t> item = {0x12, 0x0A, 0x10, 0x02, 0x00, 0x02, 0x00, 0x01, 0x84, 0x00, addr[0], addr[1]};
+        readParam.insert(readParam.end(), item.begin(), item.end());
+        readData.insert(readData.end(), {0xFF, 0x04, 0x00, 0x10, i, 0x01});
+        writeParam.insert(writeParam.end(), item.begin(), item.end());
+        writeData.insert(writeData.end(), {0x00, 0x04, 0x00, 0x10, i, 0x02});
+        writeAck.emplace_back(0xFF);
+    }
+    const std::vector<uint8_t> job = {0x32, 0x01, 0x00, 0x00, 0x00, 0x01, 0, 0, 0, 0};
+    const std::vector<uint8_t> ackData = {0x32, 0x03, 0x00, 0x00, 0x00, 0x01, 0, 0, 0, 0, 0x00, 0x00};
+    const std::vector<Traffic> trafficList = {
+        {1048, {0x10, 0x5B, 0x01, 0x5C, 0x16}, iec103(asdu9)},
+        {1048, {0x10, 0x7A, 0x01, 0x7B, 0x16}, iec103(asdu10)},
+        {1048, {0x10, 0x5A, 0x01, 0x5B, 0x16}, iec103({0x01, 0x81, 0x01, 0x01, 0xB2, 0x10, 0x02, 0x10, 0x27, 0x1E, 0x0A, 0x00})},
+        {102, s7comm(job, readParam, {}), s7comm(ackData, {0x04, itemCount}, readData)},
+        {102, s7comm(job, writeParam, writeData), s7comm(ackData, {0x05, itemCount}, writeAck)},
+    };
+    generateTrafficPackets(trafficList, flowCount, pktCount, pktList);
+}
+
+/**
+ * @brief 工控解码测试: IEC103和S7COMM(经TPKT/COTP)逐帧解码, 统计解码帧率和每帧的堆分配次数,
+ *        回调中读取解码结果(数据项数量)以便对比不同实现的解码结果是否一致
+ * @param filename 抓包文件(为空时使用模拟数据)
+ * @param flowCount 模拟流数量
+ * @param pktCount 模拟数据包数量
+ * @param repeat 回放次数
+ */
+void benchDecode(const std::string& filename, size_t flowCount, size_t pktCount, size_t repeat)
+{
+    std::vector<BenchPacket> pktList;
+    if (filename.empty())
+    {
+        generateDecodePackets(flowCount, pktCount, pktList);
+        printf("模拟工控流量(IEC103/S7COMM): %zu 个流, %zu 个包\n", flowCount, pktList.size());
+    }
+    else
+    {
+        if (!loadPcapFile(filename, pktList))
+        {
+            return;
+        }
+        printf("抓包文件: %s, %zu 个包\n", filename.c_str(), pktList.size());
+    }
+    using namespace npacket;
+    size_t frameCount = 0, itemCount = 0, allocCount = 0;
+    const auto tp = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeat; ++r) /* 每次使用新的分析器(同一份数据重复送入同一分析器会被当作TCP重传丢弃) */
+    {
+        Analyzer analyzer;
+        auto iec103 = std::make_shared<Iec103Parser>();
+        iec103->setFixedFrameCallback([&](const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen, const ProtocolHeader* header,
+                                          const std::shared_ptr<iec103::FixedFrame>& frame) { ++frameCount; });
+        iec103->setVariableFrameCallback([&](const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
+                                             const ProtocolHeader* header, const std::shared_ptr<iec103::VariableFrame>& frame) {
+            ++frameCount;
+            if (!frame->asdu)
+            {
+                return;
+            }
+            switch (frame->asdu->identify.type)
+            {
+            case 0x09:
+                itemCount += std::static_pointer_cast<iec103::Asdu9>(frame->asdu)->meaList.size();
+                break;
+            case 0x0A:
+                for (const auto& dataSet : std::static_pointer_cast<iec103::Asdu10>(frame->asdu)->dataSet)
+                {
+                    itemCount += dataSet.gidList.size();
+                }
+                break;
+            default:
+                ++itemCount;
+                break;
+            }
+        });
+        auto s7 = std::make_shared<S7CommParser>();
+        s7->setFrameCallback([&](const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen, const ProtocolHeader* header,
+                                 const TpktInfo& tpktInfo, const CotpInfo& cotpInfo, const s7comm::S7CommInfo& s7Info) {
+            ++frameCount;
+            itemCount += s7Info.rwParam.items.size() + s7Info.rwData.size();
+        });
+        auto tpktCotp = std::make_shared<TpktCotpParser>();
+        tpktCotp->setDataCallback([s7](size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
+                                       const ProtocolHeader* header, const TpktInfo& tpktInfo, const CotpInfo& cotpInfo,
+                                       const uint8_t* payload, uint32_t payloadLen) {
+            s7->parse(flag, num, ntp, totalLen, header, tpktInfo, cotpInfo, payload, payloadLen);
+        });
+        analyzer.addProtocolParser(iec103, {1048});
+        analyzer.addProtocolParser(tpktCotp, {102});
+        const size_t allocBegin = s_allocCount.load(std::memory_order_relaxed);
+        size_t num = 0;
+        for (const auto& pkt : pktList)
+        {
+            analyzer.parse(0, ++num, tp, pkt.data.data(), (uint32_t)pkt.data.size());
+        }
+        allocCount += s_allocCount.load(std::memory_order_relaxed) - allocBegin;
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    printf("%-24s 包数: %zu, 耗时: %.3f 秒, 解码: %zu 帧, %.0f 帧/秒, 数据项: %zu, 堆分配: %.2f 次/帧\n", "解码Analyzer(1线程)",
+           pktList.size() * repeat, sec, frameCount, frameCount / sec, itemCount, frameCount ? (double)allocCount / frameCount : 0.0);
+}
+
+int main(int argc, char* argv[])
+{
+    printf("*************************************************************************************************************\n");
+    printf("** 说明: 数据包分析性能测试(回放pcap文件或模拟Modbus/TCP流), 对比单线程分析器和多线程分片分析器.           **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 选项:                                                                                                   **\n");
+    printf("**                                                                                                         **\n");
+    printf("** [-f 文件]           pcap/pcapng文件(链路类型为以太网), 不指定则使用模拟数据.                            **\n");
+    printf("** [-s 分片数]         分片数量(工作线程数), 默认为CPU核数.                                                **\n");
+    printf("** [-n 包数]           模拟数据包数量, 默认1000000.                                                        **\n");
+    printf("** [-c 流数]           模拟流数量, 默认1000.                                                               **\n");
+    printf("** [-r 次数]           回放次数, 默认3.                                                                    **\n");
+    printf("** [-o 0/1]            是否加入重组压力(乱序分段+分片洪泛), 默认0.                                         **\n");
+    printf("** [-m 内存上限]       重组内存上限(MB), 默认256.                                                          **\n");
+    printf("** [-e 0/1]            是否只进行流过期测试(大量短流, 统计单包延迟分布), 默认0.                            **\n");
+    printf("** [-d 0/1]            是否只进行协议识别测试(混合工业流量, 20个解析器), 默认0.                            **\n");
+    printf("** [-i 0/1]            是否只进行工控解码测试(IEC103/S7COMM, 可用-f指定文件), 默认0.                       **\n");
+    printf("** [-p 速度]           回放模式(需-f): 按原始时间戳从文件映射直接送入分析器, 0-全速, 1-原始速率, 2-2倍速.    **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 示例:                                                                                                   **\n");
+    printf("**       npacket_bench.exe -f test.pcap -s 4                                                               **\n");
+    printf("**       npacket_bench.exe -f test.pcapng -p 0                                                             **\n");
+    printf("**                                                                                                         **\n");
+    printf("*************************************************************************************************************\n");
+    printf("\n");
+    std::string filename;
+    size_t shardCount = std::max(std::thread::hardware_concurrency(), 1U);
+    size_t pktCount = 1000000;
+    size_t flowCount = 1000;
+    size_t repeat = 3;
+    bool stress = false;
+    bool expiry = false;
+    bool detection = false;
+    bool decode = false;
+    double speed = -1;
+    npacket::ReassemblyMemoryConfig memoryCfg;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string key = argv[i];
+        if (0 == key.compare("-f"))
+        {
+            filename = argv[i + 1];
+        }
+        else if (0 == key.compare("-s"))
+        {
+            shardCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if (0 == key.compare("-n"))
+        {
+            pktCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if (0 == key.compare("-c"))
+        {
+            flowCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if (0 == key.compare("-r"))
+        {
+            repeat = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if (0 == key.compare("-o"))
+        {
+            stress = (0 != atoi(argv[i + 1]));
+        }
+        else if (0 == key.compare("-m"))
+        {
+            memoryCfg.maxMemory = (size_t)std::max(atoi(argv[i + 1]), 1) * 1024 * 1024;
+        }
+        else if (0 == key.compare("-e"))
+        {
+            expiry = (0 != atoi(argv[i + 1]));
+        }
+        else if (0 == key.compare("-d"))
+        {
+            detection = (0 != atoi(argv[i + 1]));
+        }
+        else if (0 == key.compare("-i"))
+        {
+            decode = (0 != atoi(argv[i + 1]));
+        }
+        else if (0 == key.compare("-p"))
+        {
+            speed = std::max(atof(argv[i + 1]), 0.0);
+        }
+    }
+    if (expiry)
+    {
+        benchFlowExpiry(pktCount);
+        return 0;
+    }
+    if (detection)
+    {
+        benchDetection(flowCount, pktCount);
+        return 0;
+    }
+    if (decode)
+    {
+        benchDecode(filename, flowCount, pktCount, repeat);
+        return 0;
+    }
+    if (speed >= 0 && !filename.empty())
+    {
+        benchReplay(filename, speed, repeat, memoryCfg);
+        return 0;
+    }
+    std::vector<BenchPacket> pktList;
+    if (filename.empty())
+    {
+        generatePackets(flowCount, pktCount, pktList);
+        printf("模拟数据: %zu 个流, %zu 个包\n", flowCount, pktList.size());
+    }
+    else
+    {
+        if (!loadPcapFile(filename, pktList))
+        {
+            return 0;
+        }
+        printf("抓包文件: %s, %zu 个包\n", filename.c_str(), pktList.size());
+    }
+    if (pktList.empty())
+    {
+        return 0;
+    }
+    if (stress)
+    {
+        addReassemblyStress(flowCount, pktList);
+        printf("加入重组压力后: %zu 个包\n", pktList.size());
+    }
+    auto creator = [](size_t shardIndex) {
+        auto parser = std::make_shared<npacket::ModbusTcpParser>();
+        parser->setDataCallback([](const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
+                                   const npacket::ProtocolHeader* header, const npacket::modbus::DataSt& data) { ++s_modbusCount; });
+        return parser;
+    };
+    const size_t total = pktList.size() * repeat;
+    uint64_t totalBytes = 0;
+    for (const auto& pkt : pktList)
+    {
+        totalBytes += pkt.data.size();
+    }
+    totalBytes *= repeat;
+    /* 单线程分析器 */
+    {
+        s_modbusCount = 0;
+        npacket::Analyzer analyzer(npacket::CallbackConfig(), npacket::IpReassemblyConfig(), npacket::TcpReassemblyConfig(), memoryCfg);
+        analyzer.addProtocolParser(creator(0), {502});
+        const auto tp = std::chrono::steady_clock::now();
+        size_t num = 0;
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            for (const auto& pkt : pktList)
+            {
+                analyzer.parse(0, ++num, tp, pkt.data.data(), (uint32_t)pkt.data.size());
+            }
+        }
+        printResult("Analyzer(1线程)", total, totalBytes, std::chrono::steady_clock::now() - tp);
+        printReassemblyStat(analyzer.getReassemblyStat());
+    }
+    /* 分片分析器 */
+    {
+        s_modbusCount = 0;
+        npacket::ShardConfig shardCfg;
+        shardCfg.shardCount = shardCount;
+        shardCfg.ringSize = 16384;
+        shardCfg.blockWhenFull = true;
+        npacket::ShardedAnalyzer analyzer(shardCfg, npacket::CallbackConfig(), npacket::IpReassemblyConfig(),
+                                          npacket::TcpReassemblyConfig(), memoryCfg);
+        analyzer.addProtocolParser(creator, {502});
+        const auto tp = std::chrono::steady_clock::now();
+        size_t num = 0;
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            for (const auto& pkt : pktList)
+            {
+                analyzer.parse(0, ++num, tp, pkt.data.data(), (uint32_t)pkt.data.size());
+            }
+        }
+        analyzer.waitIdle();
+        const auto elapsed = std::chrono::steady_clock::now() - tp;
+        printResult("ShardedAnalyzer(" + std::to_string(analyzer.getShardCount()) + "线程)", total, totalBytes, elapsed);
+        const auto statList = analyzer.getStats();
+        for (size_t i = 0; i < statList.size(); ++i)
+        {
+            const double busySec = std::chrono::duration<double>(statList[i].busyTime).count();
+            printf("    分片[%zu] 包数: %zu, 丢弃: %zu, 解析耗时: %.3f 秒, 单核吞吐: %.0f 包/秒\n", i, statList[i].packets, statList[i].drops,
+                   busySec, busySec > 0 ? statList[i].packets / busySec : 0.0);
+            printReassemblyStat(statList[i].reassembly);
+        }
+    }
+    return 0;
+}
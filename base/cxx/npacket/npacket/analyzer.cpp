@@ -155,11 +155,45 @@ inline TcpReassemblyConfig limitTcpReassemblyConfig(TcpReassemblyConfig cfg)
     return cfg;
 }
 
-Analyzer::Analyzer(const CallbackConfig& cbCfg, IpReassemblyConfig ipReassemblyCfg, TcpReassemblyConfig tcpReassemblyCfg)
+/**
+ * @brief 限制重组内存配置
+ * @param cfg 外部定义的配置信息
+ * @return 限制后的新配置
+ */
+inline ReassemblyMemoryConfig limitReassemblyMemoryConfig(ReassemblyMemoryConfig cfg)
+{
+    if (cfg.chunkSize < 256 || cfg.chunkSize > (64 * 1024))
+    {
+        cfg.chunkSize = 2048;
+    }
+    if (0 == cfg.slabChunkCount || cfg.slabChunkCount > 4096)
+    {
+        cfg.slabChunkCount = 64;
+    }
+    if (cfg.maxMemory < (1024 * 1024))
+    {
+        cfg.maxMemory = (256 * 1024 * 1024);
+    }
+    return cfg;
+}
+
+Analyzer::Analyzer(const CallbackConfig& cbCfg, IpReassemblyConfig ipReassemblyCfg, TcpReassemblyConfig tcpReassemblyCfg,
+                   ReassemblyMemoryConfig memoryCfg)
     : m_cbCfg(cbCfg)
     , m_ipReassemblyCfg(limitIpReassemblyConfig(ipReassemblyCfg))
     , m_tcpReassemblyCfg(limitTcpReassemblyConfig(tcpReassemblyCfg))
+    , m_memoryCfg(limitReassemblyMemoryConfig(memoryCfg))
+    , m_reassemblyMemory(m_memoryCfg.chunkSize, m_memoryCfg.slabChunkCount, m_memoryCfg.maxMemory)
 {
+    /* 按最大缓存数量预留, 避免流数量增长过程中哈希表扩容(全表重哈希)造成的延迟毛刺 */
+    if (m_ipReassemblyCfg.enable)
+    {
+        m_fragmentCache.reserve(m_ipReassemblyCfg.maxCacheCount + 1);
+    }
+    if (m_tcpReassemblyCfg.enable)
+    {
+        m_tcpStreamCache.reserve(m_tcpReassemblyCfg.maxCacheCount + 1);
+    }
 }
 
 bool Analyzer::addProtocolParser(const std::shared_ptr<ProtocolParser>& parser, const std::vector<uint16_t>& ports, bool portStrict)
@@ -182,6 +216,7 @@ bool Analyzer::addProtocolParser(const std::shared_ptr<ProtocolParser>& parser,
     if (addFlag)
     {
         m_applicationParserList.emplace_back(parser);
+        compileSignatures();
     }
     /* 绑定端口 */
     for (const auto& port : ports)
@@ -207,6 +242,7 @@ void Analyzer::removeProtocolParser(uint32_t protocol)
         if (*iter && (*iter)->getProtocol() == protocol)
         {
             m_applicationParserList.erase(iter);
+            compileSignatures();
             break;
         }
     }
@@ -223,18 +259,53 @@ void Analyzer::removeProtocolParser(uint32_t protocol)
     }
 }
 
+void Analyzer::compileSignatures()
+{
+    m_signatureMatcher.clear();
+    for (const auto& parser : m_applicationParserList)
+    {
+        for (const auto& sig : parser->getSignatures())
+        {
+            m_signatureMatcher.add(parser->getProtocol(), sig);
+        }
+    }
+    m_signatureMatcher.compile();
+}
+
 int Analyzer::parse(size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, const uint8_t* data, uint32_t dataLen,
                     const DataSource& dataSource)
 {
-    return parseWithDepth(flag, num, ntp, nullptr, data, dataLen, dataSource, 0, 0);
+    cleanupFragmentCache(ntp); /* 清空超时IP分片缓存 */
+    cleanupTcpStreamCache(ntp); /* 清理超时TCP流缓存 */
+    if (!m_flowEndList.empty()) /* 超时/淘汰的流在解析当前数据包之前通知, 避免同键的新流在解析后被当作已结束 */
+    {
+        notifyFlowEnd();
+    }
+    const int ret = parseWithDepth(flag, num, ntp, nullptr, data, dataLen, dataSource, 0, 0);
+    if (!m_flowEndList.empty()) /* FIN/RST等在解析过程中结束的流, 当前数据包解析完之后再通知 */
+    {
+        notifyFlowEnd();
+    }
+    return ret;
+}
+
+ReassemblyStat Analyzer::getReassemblyStat() const
+{
+    ReassemblyStat stat;
+    stat.maxMemory = m_reassemblyMemory.getMaxMemory();
+    stat.usedMemory = m_reassemblyMemory.getUsedMemory();
+    stat.reservedMemory = m_reassemblyMemory.getReservedMemory();
+    stat.dataBytes = m_reassemblyMemory.getDataBytes();
+    stat.evictedFlows = m_evictedFlows.load(std::memory_order_relaxed);
+    stat.evictedBytes = m_evictedBytes.load(std::memory_order_relaxed);
+    stat.allocFailures = m_reassemblyMemory.getAllocFailures();
+    return stat;
 }
 
 int Analyzer::parseWithDepth(size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp,
                              const ProtocolHeader* ethernetHeader, const uint8_t* data, uint32_t dataLen, const DataSource& dataSource,
                              int depth, int reassemblyFlag)
 {
-    cleanupFragmentCache(ntp); /* 清空超时IP分片缓存 */
-    cleanupTcpStreamCache(ntp); /* 清理超时TCP流缓存 */
     if (!data || 0 == dataLen)
     {
         return -1;
@@ -806,11 +877,42 @@ int Analyzer::handleApplicationLayer(size_t flag, size_t num, const std::chrono:
         /* 2. 查找其他解析器(排除已添加的端口匹配协议) */
         if (parserList.empty() || !portStrict) /* 端口未匹配到任何解析器, 或者端口非严格匹配 */
         {
-            for (const auto& parser : m_applicationParserList)
+            std::shared_ptr<ProtocolParser> detectedParser = nullptr;
+            if (streamInfo && streamInfo->detectedProtocol > 0) /* 流已识别出协议, 直接交给该协议的解析器 */
             {
-                if (addedList.insert(parser->getProtocol()).second)
+                for (const auto& parser : m_applicationParserList)
                 {
-                    parserList.emplace_back(parser);
+                    if (parser->getProtocol() == streamInfo->detectedProtocol)
+                    {
+                        detectedParser = parser;
+                        break;
+                    }
+                }
+            }
+            if (detectedParser)
+            {
+                if (addedList.insert(detectedParser->getProtocol()).second)
+                {
+                    parserList.emplace_back(detectedParser);
+                }
+            }
+            else
+            {
+                /* 特征过滤: 没有声明特征, 特征命中, 或者流中还有该协议未消费数据的解析器才参与解析 */
+                static thread_local std::vector<uint32_t> hitList;
+                m_signatureMatcher.match(payload, payloadLen, hitList);
+                for (const auto& parser : m_applicationParserList)
+                {
+                    const auto protocol = parser->getProtocol();
+                    if (m_signatureMatcher.contains(protocol) && hitList.end() == std::find(hitList.begin(), hitList.end(), protocol)
+                        && (!streamInfo || streamInfo->parserPendingData.end() == streamInfo->parserPendingData.find(protocol)))
+                    {
+                        continue;
+                    }
+                    if (addedList.insert(protocol).second)
+                    {
+                        parserList.emplace_back(parser);
+                    }
                 }
             }
         }
@@ -846,7 +948,9 @@ int Analyzer::handleApplicationLayer(size_t flag, size_t num, const std::chrono:
                 && !iterPending->second.empty())
             {
                 /* 恢复历史状态: 历史未消费数据 + 新数据 */
-                context.pendingData = std::move(iterPending->second);
+                context.pendingData.reserve(iterPending->second.size() + payloadLen);
+                iterPending->second.copyTo(0, context.pendingData);
+                iterPending->second.clear(); /* 内存块立即归还, 保存状态时重新写入 */
                 if (payload && payloadLen > 0)
                 {
                     context.pendingData.insert(context.pendingData.end(), payload, payload + payloadLen);
@@ -936,7 +1040,14 @@ int Analyzer::handleApplicationLayer(size_t flag, size_t num, const std::chrono:
             {
                 if (context.data && remainingLen > 0) /* 拷贝未消费数据(存储隔离) */
                 {
-                    context.pendingData.assign(context.data + context.offset, context.data + context.offset + remainingLen);
+                    if (context.data == context.pendingData.data()) /* 数据已在暂存区中, 只去掉已消费部分 */
+                    {
+                        context.pendingData.erase(context.pendingData.begin(), context.pendingData.begin() + context.offset);
+                    }
+                    else
+                    {
+                        context.pendingData.assign(context.data + context.offset, context.data + context.offset + remainingLen);
+                    }
                 }
                 context.needMoreData = true;
                 needMoreDataProtocol.push_back(context.protocol);
@@ -967,9 +1078,16 @@ int Analyzer::handleApplicationLayer(size_t flag, size_t num, const std::chrono:
             }
             if (context.needMoreData && pendingSize > 0) /* 暂存未消费数据 */
             {
-                streamInfo->parserConsumedOffset[context.protocol] = 0; /* 下次从0开始消费 */
                 streamInfo->parserPendingData.erase(context.protocol); /* 先删除旧的, 释放内存 */
-                streamInfo->parserPendingData[context.protocol] = std::move(context.pendingData); /* 移动 */
+                ChunkBuffer buffer(&m_reassemblyMemory);
+                if (!reserveReassemblyMemory(ntp, pendingSize, nullptr, streamInfo)
+                    || !buffer.append(context.pendingData.data(), pendingSize))
+                {
+                    streamInfo->parserConsumedOffset.erase(context.protocol); /* 内存不足, 丢弃该协议的状态 */
+                    continue;
+                }
+                streamInfo->parserConsumedOffset[context.protocol] = 0; /* 下次从0开始消费 */
+                streamInfo->parserPendingData[context.protocol] = std::move(buffer);
             }
             else if (context.offset > 0 || !context.isActive) /* 清理该协议的所有状态 */
             {
@@ -977,6 +1095,37 @@ int Analyzer::handleApplicationLayer(size_t flag, size_t num, const std::chrono:
                 streamInfo->parserPendingData.erase(context.protocol);
             }
         }
+        /* 更新流的协议识别结果: 只有一个解析器消费了数据时认为识别成功, 已识别的解析器失败时重新识别 */
+        const ParserContext* consumedContext = nullptr;
+        size_t consumedCount = 0;
+        for (const auto& context : parserContextList)
+        {
+            if (context.offset > 0)
+            {
+                consumedContext = &context;
+                ++consumedCount;
+            }
+            else if (!context.isActive && context.protocol == streamInfo->detectedProtocol)
+            {
+                streamInfo->detectedProtocol = 0;
+            }
+        }
+        if (1 == consumedCount && 0 == streamInfo->detectedProtocol)
+        {
+            streamInfo->detectedProtocol = consumedContext->protocol;
+            for (auto iter = streamInfo->parserPendingData.begin(); streamInfo->parserPendingData.end() != iter;) /* 丢弃其他协议的暂存数据 */
+            {
+                if (iter->first != consumedContext->protocol)
+                {
+                    streamInfo->parserConsumedOffset.erase(iter->first);
+                    streamInfo->parserPendingData.erase(iter++);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+        }
     }
     /* step7. 返回结果决策 */
     if (anySuccess) /* 至少一个解析器成功消费了数据 */
@@ -1063,44 +1212,25 @@ void Analyzer::cleanupFragmentCache(const std::chrono::steady_clock::time_point&
     {
         return;
     }
-    size_t clearInterval = m_ipReassemblyCfg.timeout / 10; /* 使用(超时时间/10)作为清理间隔 */
-    if (clearInterval < 1000)
-    {
-        clearInterval = 1000;
-    }
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(ntp - m_lastCleanupTime).count() <= clearInterval)
-    {
-        return;
-    }
-    m_lastCleanupTime = ntp;
-    static thread_local std::vector<std::pair<FragmentKey, std::chrono::steady_clock::time_point>> entries;
-    entries.clear();
-    entries.reserve(m_fragmentCache.size());
-    for (auto iter = m_fragmentCache.begin(); m_fragmentCache.end() != iter;)
+    /* LRU链表从旧到新排列, 遇到第一个未超时的分片组即可停止, 开销只和需要清理的数量有关 */
+    while (!m_fragmentLru.empty())
     {
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(ntp - iter->second->lastAccessTime).count();
-        if (elapsed > m_ipReassemblyCfg.timeout) /* 清理超时分片缓存 */
+        auto info = static_cast<FragmentInfo*>(m_fragmentLru.next);
+        if (m_fragmentCache.size() <= m_ipReassemblyCfg.maxCacheCount
+            && ntp - info->lastAccessTime <= std::chrono::milliseconds(m_ipReassemblyCfg.timeout))
         {
-            iter = m_fragmentCache.erase(iter);
-        }
-        else
-        {
-            entries.emplace_back(iter->first, iter->second->lastAccessTime); /* 收集条目 */
-            ++iter;
-        }
-    }
-    if (entries.size() > m_ipReassemblyCfg.maxCacheCount) /* 限制分片缓存大小 */
-    {
-        auto needRemoveCount = entries.size() - m_ipReassemblyCfg.maxCacheCount;
-        static const auto compareFunc = [](const auto& a, const auto& b) { return a.second < b.second; };
-        std::nth_element(entries.begin(), entries.begin() + needRemoveCount, entries.end(), compareFunc);
-        for (size_t i = 0; i < needRemoveCount; ++i) /* 删除最旧的条目 */
-        {
-            m_fragmentCache.erase(entries[i].first);
+            break;
         }
+        eraseFragment(info);
     }
 }
 
+void Analyzer::eraseFragment(FragmentInfo* info)
+{
+    const FragmentKey key = info->key; /* 先拷贝, 删除时节点(包括键)会被析构 */
+    m_fragmentCache.erase(key);
+}
+
 bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_point& ntp, const ProtocolHeader* networkHeader,
                                       const uint8_t* data, uint32_t dataLen, std::vector<uint8_t>& outData, bool& isReassembly)
 {
@@ -1192,6 +1322,7 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
     {
         auto fragmentInfo = std::make_unique<FragmentInfo>();
         info = fragmentInfo.get();
+        info->key = key;
         info->originalProtocol = originalProtocol; /* 保存原始协议 */
         iter = m_fragmentCache.insert(std::make_pair(key, std::move(fragmentInfo))).first;
     }
@@ -1205,6 +1336,7 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
         }
     }
     info->lastAccessTime = ntp; /* 更新访问时间 */
+    m_fragmentLru.moveToBack(info);
     if (info->fragmentCount >= m_ipReassemblyCfg.maxFragCount) /* 检查分片数量(疑似DoS攻击) */
     {
         m_fragmentCache.erase(key);
@@ -1215,15 +1347,22 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
         m_fragmentCache.erase(key);
         return true;
     }
+    /* 新分片 + 拆分旧分片最多多用1块 */
+    if (!reserveReassemblyMemory(ntp, payloadLen + m_reassemblyMemory.getChunkCapacity(), info, nullptr))
+    {
+        m_fragmentCache.erase(key);
+        return true;
+    }
     /* 分片重叠处理 */
     uint32_t newStart = fragOffset * 8;
     uint32_t newEnd = newStart + payloadLen;
     if (isIpv4) /* IPv4: RFC 791 允许重叠分片, 采用"后到的覆盖先到的"策略处理四种重叠场景 */
     {
+        std::vector<std::pair<uint32_t, ChunkBuffer>> reinsertList; /* 调整后需要重新插入的旧分片(遍历期间不能插入) */
         for (auto iterFrag = info->fragments.begin(); iterFrag != info->fragments.end();)
         {
             uint32_t existStart = iterFrag->first * 8;
-            uint32_t existEnd = existStart + iterFrag->second.size();
+            uint32_t existEnd = existStart + (uint32_t)iterFrag->second.size();
             /* 场景0: 无重叠(新分片完全在前或在后) */
             if (newStart >= existEnd || newEnd <= existStart)
             {
@@ -1233,72 +1372,32 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
             /* 场景1: 新分片完全覆盖旧分片(新 < 旧 且 新 > 旧尾) */
             if (newStart <= existStart && newEnd >= existEnd)
             {
-                info->totalPayloadSize -= iterFrag->second.size();
+                info->totalPayloadSize -= (uint32_t)iterFrag->second.size();
                 iterFrag = info->fragments.erase(iterFrag);
             }
-            /* 场景2: 新分片内嵌在旧分片内部(旧 < 新 且 旧尾 > 新尾) */
+            /* 场景2: 新分片内嵌在旧分片内部(旧 < 新 且 旧尾 > 新尾), 旧分片拆分为前后两段 */
             else if (existStart < newStart && existEnd > newEnd)
             {
                 uint32_t frontLen = newStart - existStart; /* 前段保留长度 */
-                uint32_t backStart = newEnd; /* 后段起始字节偏移 */
                 uint32_t backLen = existEnd - newEnd; /* 后段保留长度 */
-                /* 保存旧数据引用 */
-                std::vector<uint8_t> oldData = std::move(iterFrag->second);
-                /* 删除原条目(迭代器失效, 需要重新获取) */
-                iterFrag = info->fragments.erase(iterFrag);
-                info->totalPayloadSize -= oldData.size();
-                if (0 == frontLen && backLen > 0) /* 情况1: 只有后段(前段为空, 新分片从旧分片开头开始) */
+                ChunkBuffer frontData = std::move(iterFrag->second);
+                ChunkBuffer backData;
+                if (!frontData.splitAt(newEnd - existStart, backData)) /* 整块转移, 只拷贝拆分点所在块的剩余部分 */
                 {
-                    size_t skipLen = newEnd - existStart; /* 跳过新分片覆盖的部分 */
-                    oldData.erase(oldData.begin(), oldData.begin() + skipLen);
-                    uint32_t backOffset = backStart / 8;
-                    info->fragments[backOffset] = std::move(oldData); /* 移动, 零拷贝 */
-                    info->totalPayloadSize += backLen;
+                    m_fragmentCache.erase(key);
+                    return true;
                 }
-                else if (frontLen > 0 && 0 == backLen) /* 情况2: 只有前段(后段为空, 新分片延伸到旧分片末尾) */
-                {
-                    oldData.resize(frontLen); /* 直接截断oldData */
-                    uint32_t frontOffset = existStart / 8;
-                    info->fragments[frontOffset] = std::move(oldData); /* 移动, 零拷贝 */
-                    info->totalPayloadSize += frontLen;
-                }
-                else if (frontLen > 0 && backLen > 0) /* 情况3: 前后段都存在(必须分割) */
-                {
-                    size_t backStartPos = backStart - existStart;
-                    if (frontLen <= backLen) /* 移动前段, 拷贝后段(因为后段需要重新分配) */
-                    {
-                        /* 前段小, 拷贝前段, 移动后段 */
-                        std::vector<uint8_t> backData;
-                        backData.reserve(backLen);
-                        backData.assign(oldData.begin() + backStartPos, oldData.end()); /* 拷贝后段 */
-                        oldData.resize(frontLen); /* 截断为前段 */
-                        uint32_t frontOffset = existStart / 8;
-                        uint32_t backOffset = backStart / 8;
-                        info->fragments[frontOffset] = std::move(oldData); /* 移动前段 */
-                        info->fragments[backOffset] = std::move(backData); /* 移动后段 */
-                    }
-                    else /* 移动后段, 拷贝前段(选择数据量小的拷贝) */
-                    {
-                        /* 后段小, 拷贝后段, 移动前段 */
-                        std::vector<uint8_t> frontData(oldData.begin(), oldData.begin() + frontLen); /* 拷贝前段 */
-                        //* 构造后段: 复用oldData的内存 */
-                        std::vector<uint8_t> backData;
-                        backData.reserve(backLen);
-                        backData.assign(oldData.begin() + backStartPos, oldData.end());
-                        uint32_t frontOffset = existStart / 8;
-                        uint32_t backOffset = backStart / 8;
-                        info->fragments[frontOffset] = std::move(frontData); /* 移动前段(新分配) */
-                        info->fragments[backOffset] = std::move(backData); /* 移动后段(新分配) */
-                    }
-                    info->totalPayloadSize += (frontLen + backLen);
-                }
-                /* 注意: 内嵌场景后, 当前旧分片已被分割, 继续检查下一个旧分片 */
+                frontData.truncate(frontLen);
+                iterFrag = info->fragments.erase(iterFrag);
+                info->totalPayloadSize -= (existEnd - existStart - frontLen - backLen);
+                reinsertList.emplace_back(existStart / 8, std::move(frontData));
+                reinsertList.emplace_back(newEnd / 8, std::move(backData));
             }
             /* 场景3: 尾部重叠(新分片头部与旧分片尾部重叠) */
             else if (existStart < newStart && existEnd <= newEnd && existEnd > newStart)
             {
                 uint32_t keepLen = newStart - existStart; /* 旧分片保留长度 */
-                iterFrag->second.resize(keepLen);
+                iterFrag->second.truncate(keepLen);
                 info->totalPayloadSize -= (existEnd - existStart - keepLen);
                 ++iterFrag;
             }
@@ -1306,11 +1405,11 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
             else if (existStart >= newStart && existEnd > newEnd && existStart < newEnd)
             {
                 uint32_t skipLen = newEnd - existStart; /* 需要跳过的重复字节数 */
-                uint32_t newOffset = newEnd / 8; /* 新偏移量(按8字节对齐) */
-                std::vector<uint8_t> newData(iterFrag->second.begin() + skipLen, iterFrag->second.end());
+                ChunkBuffer backData = std::move(iterFrag->second);
+                backData.trimFront(skipLen); /* 只调整内存块起始位置, 不拷贝 */
                 info->totalPayloadSize -= skipLen;
                 iterFrag = info->fragments.erase(iterFrag);
-                info->fragments[newOffset] = std::move(newData);
+                reinsertList.emplace_back(newEnd / 8, std::move(backData)); /* 新偏移量(按8字节对齐) */
             }
             else
             {
@@ -1318,13 +1417,17 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
                 ++iterFrag;
             }
         }
+        for (auto& kv : reinsertList)
+        {
+            info->fragments[kv.first] = std::move(kv.second);
+        }
     }
     else /* IPv6: RFC 5722 严格禁止重叠分片, 发现任何重叠立即废弃整个分片组 */
     {
         for (auto& kv : info->fragments)
         {
             uint32_t existStart = kv.first * 8;
-            uint32_t existEnd = existStart + kv.second.size();
+            uint32_t existEnd = existStart + (uint32_t)kv.second.size();
             if (newStart < existEnd && newEnd > existStart) /* 任何重叠都视为攻击 */
             {
                 m_fragmentCache.erase(key);
@@ -1333,7 +1436,13 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
         }
     }
     /* 存储分片数据(跳过IP头, 只存payload) */
-    info->fragments[fragOffset] = std::vector<uint8_t>(payload, payload + payloadLen);
+    ChunkBuffer fragData(&m_reassemblyMemory);
+    if (!fragData.append(payload, payloadLen))
+    {
+        m_fragmentCache.erase(key);
+        return true;
+    }
+    info->fragments[fragOffset] = std::move(fragData);
     info->totalPayloadSize += payloadLen;
     ++info->fragmentCount;
     if (!isMoreFragment) /* 处理最后一个分片 */
@@ -1342,12 +1451,14 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
         info->lastOffset = fragOffset;
         info->totalLen = (uint32_t)estimatedTotal;
     }
-    if (!info->gotLastFragment) /* 检查是否收齐所有分片, 继续等待 */
+    if (!info->gotLastFragment || info->totalPayloadSize < info->totalLen) /* 检查是否收齐所有分片(最后一片可能先到), 继续等待 */
     {
         return true;
     }
+    iter = m_fragmentCache.find(key); /* 预留内存时可能淘汰了其他分片组 */
     auto fragmentInfo = std::move(iter->second); /* 需要先将数据移出暂存, 避免数据被销毁 */
     info = fragmentInfo.get(); /* 修改指针指向地址 */
+    info->unlink();
     m_fragmentCache.erase(key); /* 清理缓存 */
     if (0 == info->totalLen || info->totalLen > m_ipReassemblyCfg.maxReassembleSize) /* 验证总长度 */
     {
@@ -1356,17 +1467,25 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
     /* 重组数据 */
     outData.reserve(basicHeaderLen + info->totalLen);
     outData.insert(outData.end(), data, data + basicHeaderLen); /* 先复制IP头部 */
-    /* 检查分片连续性 */
+    /* 检查分片连续性(哈希表无序, 先按偏移量排序) */
+    static thread_local std::vector<uint32_t> offsetList;
+    offsetList.clear();
+    for (const auto& kv : info->fragments)
+    {
+        offsetList.emplace_back(kv.first);
+    }
+    std::sort(offsetList.begin(), offsetList.end());
     uint32_t currentPos = 0;
-    for (auto& kv : info->fragments)
+    for (auto offset : offsetList)
     {
-        uint32_t expectedBytePos = kv.first * 8; /* 将块索引转换为字节偏移 */
+        uint32_t expectedBytePos = offset * 8; /* 将块索引转换为字节偏移 */
         if (expectedBytePos != currentPos) /* 分片不连续 */
         {
             return true;
         }
-        outData.insert(outData.end(), kv.second.begin(), kv.second.end());
-        currentPos += kv.second.size();
+        const auto& fragData = info->fragments[offset];
+        fragData.copyTo(0, outData);
+        currentPos += (uint32_t)fragData.size();
     }
     if (currentPos != info->totalLen) /* 验证重组结果 */
     {
@@ -1380,7 +1499,7 @@ bool Analyzer::checkAndHandleFragment(const std::chrono::steady_clock::time_poin
         ipHeader->totalLen[0] = ((newTotalLen >> 8) & 0xFF);
         ipHeader->totalLen[1] = (newTotalLen & 0xFF);
         /* 清除MF标志和片段偏移 */
-        ipHeader->flags_offset[0] &= 0xE0; /* 清除MF和偏移 */
+        ipHeader->flags_offset[0] &= 0xC0; /* 清除MF和偏移(保留标志位和DF) */
         ipHeader->flags_offset[1] = 0; /* 清除偏移低位 */
     }
     else /* IPv6 */
@@ -1426,58 +1545,165 @@ void Analyzer::cleanupTcpStreamCache(const std::chrono::steady_clock::time_point
     {
         return;
     }
-    size_t clearInterval = m_tcpReassemblyCfg.timeout / 10; /* 使用(超时时间/10)作为清理间隔 */
-    if (clearInterval < 1000)
+    /* LRU链表从旧到新排列, 遇到第一个未超时的流即可停止(流中超时的乱序分段在访问该流时清理) */
+    while (!m_tcpStreamLru.empty())
     {
-        clearInterval = 1000;
+        auto info = static_cast<TcpStreamInfo*>(m_tcpStreamLru.next);
+        if (ntp - info->lastAccessTime > std::chrono::milliseconds(m_tcpReassemblyCfg.timeout))
+        {
+            endTcpStream(ntp, info, FlowEndReason::TIMEOUT);
+        }
+        else if (m_tcpStreamCache.size() > m_tcpReassemblyCfg.maxCacheCount) /* 限制流数量(LRU) */
+        {
+            endTcpStream(ntp, info, FlowEndReason::EVICTED);
+        }
+        else
+        {
+            break;
+        }
     }
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(ntp - m_lastTcpCleanupTime).count() <= clearInterval)
+}
+
+void Analyzer::cleanupTcpSegments(const std::chrono::steady_clock::time_point& ntp, TcpStreamInfo* info)
+{
+    const auto timeout = std::chrono::milliseconds(m_tcpReassemblyCfg.timeout);
+    if (info->segments.empty() || ntp - info->oldestSegmentTime <= timeout)
     {
         return;
     }
-    m_lastTcpCleanupTime = ntp;
-    static thread_local std::vector<std::pair<TcpStreamKey, std::chrono::steady_clock::time_point>> entries;
-    entries.clear();
-    entries.reserve(m_tcpStreamCache.size());
-    for (auto iter = m_tcpStreamCache.begin(); iter != m_tcpStreamCache.end();)
+    bool hasOldest = false;
+    for (auto segIt = info->segments.begin(); info->segments.end() != segIt;)
     {
-        /* 遍历清理当前流中超时乱序分段 */
-        auto& streamInfo = iter->second;
-        for (auto segIt = streamInfo->segments.begin(); streamInfo->segments.end() != segIt;)
+        if (ntp - segIt->second.recvTime > timeout)
         {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(ntp - segIt->second.recvTime).count();
-            if (elapsed > m_tcpReassemblyCfg.timeout)
+            segIt = info->segments.erase(segIt);
+        }
+        else
+        {
+            if (!hasOldest || segIt->second.recvTime < info->oldestSegmentTime)
             {
-                segIt = streamInfo->segments.erase(segIt);
+                info->oldestSegmentTime = segIt->second.recvTime;
+                hasOldest = true;
             }
-            else
+            ++segIt;
+        }
+    }
+}
+
+void Analyzer::endTcpStream(const std::chrono::steady_clock::time_point& ntp, TcpStreamInfo* info, FlowEndReason reason)
+{
+    FlowEndEvent event;
+    event.ntp = ntp;
+    event.key = info->key;
+    event.reason = reason;
+    m_flowEndList.emplace_back(event);
+    m_tcpStreamCache.erase(m_flowEndList.back().key);
+}
+
+void Analyzer::notifyFlowEnd()
+{
+    static thread_local std::vector<std::shared_ptr<ProtocolParser>> parserList;
+    parserList.clear();
+    {
+        std::lock_guard<std::mutex> locker(m_mutexParserList);
+        parserList.insert(parserList.end(), m_applicationParserList.begin(), m_applicationParserList.end());
+        for (const auto& kv : m_applicationParserMap) /* 只绑定了端口的解析器(同协议的解析器已在列表中) */
+        {
+            if (kv.second && parserList.end() == std::find(parserList.begin(), parserList.end(), kv.second))
             {
-                ++segIt;
+                parserList.emplace_back(kv.second);
             }
         }
-        /* FIN状态使用短超时, 正常状态使用标准超时 */
-        auto lastNtp = iter->second->lastAccessTime;
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(ntp - lastNtp).count();
-        if (elapsed > m_tcpReassemblyCfg.timeout) /* 清理超时的流 */
+    }
+    for (const auto& event : m_flowEndList)
+    {
+        if (m_cbCfg.flowEndCb)
         {
-            iter = m_tcpStreamCache.erase(iter);
+            try
+            {
+                m_cbCfg.flowEndCb(event.ntp, event.key, event.reason);
+            }
+            catch (const std::exception& e)
+            {
+                printf("[Exception][%s %d %s] flowEndCb, %s\n", __FILE__, __LINE__, __FUNCTION__, e.what());
+            }
+            catch (...)
+            {
+                printf("[Exception][%s %d %s] flowEndCb, unknown\n", __FILE__, __LINE__, __FUNCTION__);
+            }
         }
-        else
+        for (const auto& parser : parserList)
         {
-            entries.emplace_back(iter->first, iter->second->lastAccessTime); /* 收集条目 */
-            ++iter;
+            try
+            {
+                parser->onFlowEnd(event.ntp, event.key, event.reason);
+            }
+            catch (const std::exception& e)
+            {
+                printf("[Exception][%s %d %s] parser[%u]: %s\n", __FILE__, __LINE__, __FUNCTION__, parser->getProtocol(), e.what());
+            }
+            catch (...)
+            {
+                printf("[Exception][%s %d %s] parser[%u]: unknown\n", __FILE__, __LINE__, __FUNCTION__, parser->getProtocol());
+            }
         }
     }
-    if (entries.size() > m_tcpReassemblyCfg.maxCacheCount) /* 限制流数量(LRU) */
+    m_flowEndList.clear();
+    parserList.clear();
+}
+
+bool Analyzer::reserveReassemblyMemory(const std::chrono::steady_clock::time_point& ntp, size_t len, const FragmentInfo* keepFragment,
+                                       const TcpStreamInfo* keepStream)
+{
+    if (m_reassemblyMemory.canAlloc(len))
+    {
+        return true;
+    }
+    /* 从两个LRU链表头部(最旧)开始, 每次淘汰两者中更旧的那个, 跳过不持有重组内存的节点 */
+    const size_t lowWatermark = m_reassemblyMemory.getMaxMemory() - m_reassemblyMemory.getMaxMemory() / 8; /* 一次淘汰到上限的7/8以下 */
+    const size_t usedBefore = m_reassemblyMemory.getUsedMemory();
+    size_t evictedCount = 0;
+    LruNode* fragNode = m_fragmentLru.next;
+    LruNode* streamNode = m_tcpStreamLru.next;
+    while (!m_reassemblyMemory.canAlloc(len) || m_reassemblyMemory.getUsedMemory() > lowWatermark)
     {
-        auto needRemoveCount = entries.size() - m_tcpReassemblyCfg.maxCacheCount;
-        static const auto compareFunc = [](const auto& a, const auto& b) { return a.second < b.second; };
-        std::nth_element(entries.begin(), entries.begin() + needRemoveCount, entries.end(), compareFunc);
-        for (size_t i = 0; i < needRemoveCount; ++i) /* 删除最旧的条目 */
+        while (&m_fragmentLru != fragNode
+               && (fragNode == keepFragment || static_cast<FragmentInfo*>(fragNode)->fragments.empty()))
+        {
+            fragNode = fragNode->next;
+        }
+        while (&m_tcpStreamLru != streamNode
+               && (streamNode == keepStream
+                   || (static_cast<TcpStreamInfo*>(streamNode)->segments.empty()
+                       && static_cast<TcpStreamInfo*>(streamNode)->parserPendingData.empty())))
         {
-            m_tcpStreamCache.erase(entries[i].first);
+            streamNode = streamNode->next;
         }
+        auto fragInfo = (&m_fragmentLru != fragNode) ? static_cast<FragmentInfo*>(fragNode) : nullptr;
+        auto streamInfo = (&m_tcpStreamLru != streamNode) ? static_cast<TcpStreamInfo*>(streamNode) : nullptr;
+        if (!fragInfo && !streamInfo)
+        {
+            break;
+        }
+        if (fragInfo && (!streamInfo || fragInfo->lastAccessTime <= streamInfo->lastAccessTime))
+        {
+            fragNode = fragNode->next; /* 先移到下一个节点, 当前节点会被析构 */
+            eraseFragment(fragInfo);
+        }
+        else
+        {
+            streamNode = streamNode->next;
+            endTcpStream(ntp, streamInfo, FlowEndReason::EVICTED);
+        }
+        ++evictedCount;
+    }
+    if (evictedCount > 0)
+    {
+        m_evictedFlows.store(m_evictedFlows.load(std::memory_order_relaxed) + evictedCount, std::memory_order_relaxed);
+        m_evictedBytes.store(m_evictedBytes.load(std::memory_order_relaxed) + (usedBefore - m_reassemblyMemory.getUsedMemory()),
+                             std::memory_order_relaxed);
     }
+    return m_reassemblyMemory.canAlloc(len);
 }
 
 bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_point& ntp, const ProtocolHeader* networkHeader,
@@ -1528,6 +1754,7 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
             return true;
         }
         auto streamInfo = std::make_unique<TcpStreamInfo>();
+        streamInfo->key = key;
         iter = m_tcpStreamCache.insert(std::make_pair(key, std::move(streamInfo))).first;
     }
     info = iter->second.get();
@@ -1537,13 +1764,15 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
         return true;
     }
     info->lastAccessTime = ntp;
+    m_tcpStreamLru.moveToBack(info);
+    cleanupTcpSegments(ntp, info);
     if (tcpHeader->flagRst) /* 处理特殊控制位RST: 立即清空流, 但返回当前数据(如果有) */
     {
         if (payloadLen > 0)
         {
             outData.insert(outData.end(), payload, payload + payloadLen);
         }
-        m_tcpStreamCache.erase(iter);
+        endTcpStream(ntp, info, FlowEndReason::RST);
         return true;
     }
     if (tcpHeader->flagFin) /* 处理FIN: 进入半关闭状态, 不立即删除流 */
@@ -1560,17 +1789,22 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
         /* FIN时无条件合并所有缓存的乱序数据 */
         if (!info->segments.empty())
         {
-            std::vector<std::pair<uint32_t, TcpSegment>> sortedSegs(info->segments.begin(), info->segments.end());
-            std::sort(sortedSegs.begin(), sortedSegs.end(), [](const auto& a, const auto& b) { return seqLt(a.first, b.first); });
-            for (const auto& p : sortedSegs)
+            std::vector<uint32_t> sortedSeqs;
+            sortedSeqs.reserve(info->segments.size());
+            for (const auto& kv : info->segments)
+            {
+                sortedSeqs.emplace_back(kv.first);
+            }
+            std::sort(sortedSeqs.begin(), sortedSeqs.end(), [](uint32_t a, uint32_t b) { return seqLt(a, b); });
+            for (auto seq : sortedSeqs)
             {
-                outData.insert(outData.end(), p.second.data.begin(), p.second.data.end());
+                info->segments[seq].data.copyTo(0, outData);
             }
             info->segmentsContinueCount = 0;
             info->segments.clear();
             isReassembly = true;
         }
-        m_tcpStreamCache.erase(iter); /* 收到FIN后立即删除流, 因为所有数据已经返回 */
+        endTcpStream(ntp, info, FlowEndReason::FIN); /* 收到FIN后立即删除流, 因为所有数据已经返回 */
         return true;
     }
     if (!info->isSeqInitialized) /* 初始化序列号 */
@@ -1677,7 +1911,7 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
                     }
                     if (offset < segment.data.size())
                     {
-                        outData.insert(outData.end(), segment.data.begin() + offset, segment.data.end());
+                        segment.data.copyTo(offset, outData);
                         info->nextExpectedSeq = seqAdd(info->nextExpectedSeq, (uint32_t)(segment.data.size() - offset));
                     }
                     info->segments.erase(it);
@@ -1704,7 +1938,12 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
                          || (info->segmentsContinueCount >= m_tcpReassemblyCfg.maxSegCount);
         if (cacheFull && !info->segments.empty()) /* 缓存满: 优先输出头部连续分段, 无连续则淘汰最小seq分段 */
         {
-            std::vector<std::pair<uint32_t, TcpSegment>> sortedSegs(info->segments.begin(), info->segments.end());
+            std::vector<std::pair<uint32_t, uint32_t>> sortedSegs; /* 只排序seq和长度, 不拷贝数据 */
+            sortedSegs.reserve(info->segments.size());
+            for (const auto& kv : info->segments)
+            {
+                sortedSegs.emplace_back(kv.first, kv.second.payloadLen);
+            }
             std::sort(sortedSegs.begin(), sortedSegs.end(), [](const auto& a, const auto& b) { return seqLt(a.first, b.first); });
             uint32_t expectSeq = info->nextExpectedSeq;
             std::vector<phmap::flat_hash_map<uint32_t, TcpSegment>::iterator> continuousList;
@@ -1716,7 +1955,7 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
                     if (info->segments.end() != it)
                     {
                         continuousList.push_back(it);
-                        expectSeq = seqAdd(p.first, p.second.payloadLen);
+                        expectSeq = seqAdd(p.first, p.second);
                     }
                 }
                 else if (seqLt(p.first, expectSeq)) /* 该分段的seq小于期望seq, 说明是重复或已覆盖的数据, 跳过 */
@@ -1742,7 +1981,7 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
                 uint32_t lastEndSeq = 0;
                 for (auto it : continuousList)
                 {
-                    outData.insert(outData.end(), it->second.data.begin(), it->second.data.end());
+                    it->second.data.copyTo(0, outData);
                     lastEndSeq = seqAdd(it->first, it->second.payloadLen);
                     info->segments.erase(it); /* 删除已输出分段 */
                 }
@@ -1754,8 +1993,16 @@ bool Analyzer::checkAndHandleTcpStream(const std::chrono::steady_clock::time_poi
             TcpSegment segment;
             segment.seq = curSeq;
             segment.payloadLen = payloadLen;
-            segment.data.assign(payload, payload + payloadLen);
+            segment.data = ChunkBuffer(&m_reassemblyMemory);
             segment.recvTime = ntp;
+            if (!reserveReassemblyMemory(ntp, payloadLen, nullptr, info) || !segment.data.append(payload, payloadLen)) /* 内存不足 */
+            {
+                return true;
+            }
+            if (info->segments.empty())
+            {
+                info->oldestSegmentTime = ntp;
+            }
             auto segIt = info->segments.find(curSeq);
             if (info->segments.end() == segIt)
             {
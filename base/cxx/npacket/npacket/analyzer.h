@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -9,6 +10,8 @@
 #include "parallel_hashmap/phmap.h"
 #include "protocol.h"
 #include "protocol_parser.h"
+#include "reassembly_memory.h"
+#include "signature_matcher.h"
 
 namespace phmap
 {
@@ -40,6 +43,15 @@ namespace npacket
  */
 using LAYER_CALLBACK = std::function<bool(const ProtocolData& pd)>;
 
+/**
+ * @brief TCP流结束回调(FIN/RST在该流最后一个数据包解析完之后调用, 超时/淘汰在下一个数据包解析之前调用)
+ * @param ntp 当前时间点
+ * @param key TCP流键(有方向)
+ * @param reason 结束原因
+ */
+using FLOW_END_CALLBACK =
+    std::function<void(const std::chrono::steady_clock::time_point& ntp, const TcpStreamKey& key, FlowEndReason reason)>;
+
 /**
  * @brief 数据源
  */
@@ -59,6 +71,7 @@ struct CallbackConfig
     LAYER_CALLBACK ethernetLayerCb = nullptr; /* 以太网层数据回调 */
     LAYER_CALLBACK networkLayerCb = nullptr; /* 网络层数据回调 */
     LAYER_CALLBACK transportLayerCb = nullptr; /* 传输层数据回调 */
+    FLOW_END_CALLBACK flowEndCb = nullptr; /* TCP流结束回调(FIN/RST/超时/淘汰) */
 };
 
 /**
@@ -88,6 +101,80 @@ struct TcpReassemblyConfig
     size_t maxPendingSize = (128 * 1024); /* 协议解析器(单个流)最大缓存大小(单位:字节), 值: [1024, maxSegSize/4] */
 };
 
+/**
+ * @brief 重组内存配置(IP分片, TCP乱序分段, 解析器未消费数据共用一个内存池)
+ */
+struct ReassemblyMemoryConfig
+{
+    size_t chunkSize = 2048; /* 内存块大小(单位:字节, 包含16字节块头), 值: [256, 64Kb] */
+    size_t slabChunkCount = 64; /* 每次向系统申请的内存块数量(单位:个数), 值: [1, 4096] */
+    size_t maxMemory = (256 * 1024 * 1024); /* 所有流共用的内存上限(单位:字节), 达到上限时淘汰最旧的流, 值: [1Mb, -] */
+};
+
+/**
+ * @brief 重组内存统计
+ */
+struct ReassemblyStat
+{
+    size_t maxMemory = 0; /* 内存上限(字节) */
+    size_t usedMemory = 0; /* 已分配的内存(字节, 按内存块计算) */
+    size_t reservedMemory = 0; /* 已向系统申请的内存(字节) */
+    size_t dataBytes = 0; /* 缓存的数据长度(字节) */
+    size_t evictedFlows = 0; /* 因内存不足被淘汰的流(分片组)数量 */
+    size_t evictedBytes = 0; /* 淘汰的流释放的内存(字节) */
+    size_t allocFailures = 0; /* 内存分配失败(超出上限)次数 */
+};
+
+/**
+ * @brief LRU链表节点(侵入式双向循环链表, 链表头为哨兵节点, 从头到尾按最近访问时间从旧到新排列)
+ */
+struct LruNode
+{
+    LruNode* prev = this; /* 前一个节点 */
+    LruNode* next = this; /* 后一个节点 */
+
+    LruNode() = default;
+    LruNode(const LruNode& src) = delete;
+    LruNode& operator=(const LruNode& src) = delete;
+
+    ~LruNode()
+    {
+        unlink();
+    }
+
+    /**
+     * @brief 从链表中移除
+     */
+    void unlink()
+    {
+        prev->next = next;
+        next->prev = prev;
+        prev = this;
+        next = this;
+    }
+
+    /**
+     * @brief 把节点移到链表尾部(作为链表头调用)
+     * @param node 节点
+     */
+    void moveToBack(LruNode* node)
+    {
+        node->unlink();
+        node->prev = prev;
+        node->next = this;
+        prev->next = node;
+        prev = node;
+    }
+
+    /**
+     * @brief 链表是否为空(作为链表头调用)
+     */
+    bool empty() const
+    {
+        return (next == this);
+    }
+};
+
 /**
  * @brief 分析器
  */
@@ -99,12 +186,13 @@ public:
      * @param cbCfg 回调配置
      * @param ipReassemblyCfg IP分片重组配置
      * @param tcpReassemblyCfg TCP分段重组配置
+     * @param memoryCfg 重组内存配置
      */
     Analyzer(const CallbackConfig& cbCfg = CallbackConfig(), IpReassemblyConfig ipReassemblyCfg = IpReassemblyConfig(),
-             TcpReassemblyConfig tcpReassemblyCfg = TcpReassemblyConfig());
+             TcpReassemblyConfig tcpReassemblyCfg = TcpReassemblyConfig(), ReassemblyMemoryConfig memoryCfg = ReassemblyMemoryConfig());
 
     /**
-     * @brief 添加应用层解析器(当协议端口不固定或者未知时使用此接口)
+     * @brief 添加应用层解析器(当协议端口不固定或者未知时使用此接口, 解析器声明了特征时, 只有特征命中的数据才会交给该解析器)
      * @param parser 应用层协议解析器
      * @param ports 端口号列表, 当协议端口固定且已知时, 可以把解析器绑定到所指定端口
      * @param portStrict 端口是否严格匹配, true-严格匹配(当解析数据时根据端口有查找到对应的解析器, 则不继续查找其他解析器), false-否
@@ -131,15 +219,22 @@ public:
     int parse(size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, const uint8_t* data, uint32_t dataLen,
               const DataSource& dataSource = DataSource::NETWORK_ETH);
 
+    /**
+     * @brief 获取重组内存统计(可以跨线程调用)
+     * @return 统计
+     */
+    ReassemblyStat getReassemblyStat() const;
+
 private:
     /**
      * @brief IP分片信息
      */
-    struct FragmentInfo
+    struct FragmentInfo : LruNode
     {
+        FragmentKey key; /* 分片键(LRU淘汰时用于从缓存中删除) */
         std::chrono::steady_clock::time_point lastAccessTime; /* 最近访问时间(用于超时和LRU) */
         uint8_t originalProtocol = 0; /* 原始协议类型(IPv6需要) */
-        phmap::flat_hash_map<uint32_t, std::vector<uint8_t>> fragments; /* 分片集合(key-偏移量, value-分片数据) */
+        phmap::flat_hash_map<uint32_t, ChunkBuffer> fragments; /* 分片集合(key-偏移量, value-分片数据) */
         bool gotLastFragment = false; /* 是否已收到最后一片 */
         uint32_t lastOffset = 0; /* 最后一片的偏移量 */
         uint32_t totalLen = 0; /* 重组后总长度 */
@@ -166,7 +261,7 @@ private:
     {
         uint32_t seq = 0; /* TCP序列号 */
         uint32_t payloadLen = 0; /* 负载长度 */
-        std::vector<uint8_t> data; /* 数据 */
+        ChunkBuffer data; /* 数据 */
         std::chrono::steady_clock::time_point recvTime; /* 接收时间 */
         bool isFin = false; /* 是否是FIN包 */
         bool isRst = false; /* 是否是RST包 */
@@ -175,15 +270,18 @@ private:
     /**
      * @brief TCP流信息
      */
-    struct TcpStreamInfo
+    struct TcpStreamInfo : LruNode
     {
+        TcpStreamKey key; /* 流键(LRU淘汰时用于从缓存中删除) */
         std::chrono::steady_clock::time_point lastAccessTime; /* 最近访问时间(用于超时和LRU) */
+        std::chrono::steady_clock::time_point oldestSegmentTime; /* 乱序分段中最早的接收时间(用于按需清理超时分段) */
         bool isSeqInitialized = false; /* 序列号是否已初始化(收到第一个SYN或数据的SYN) */
         uint32_t nextExpectedSeq = 0; /* 期望的下一个序列号 */
         size_t segmentsContinueCount = 0; /* 乱序分段连续出现次数 */
+        uint32_t detectedProtocol = 0; /* 已识别的应用层协议(0-未识别), 识别后只交给该协议的解析器 */
         phmap::flat_hash_map<uint32_t, TcpSegment> segments; /* 乱序分段缓存, key-seq, value-分段信息 */
         phmap::flat_hash_map<uint32_t, uint32_t> parserConsumedOffset; /* 解析器已消费的字节数, key-协议, value-偏移值 */
-        phmap::flat_hash_map<uint32_t, std::vector<uint8_t>> parserPendingData; /* 解析器未消费的数据, key-协议, value-数据 */
+        phmap::flat_hash_map<uint32_t, ChunkBuffer> parserPendingData; /* 解析器未消费的数据, key-协议, value-数据 */
     };
 
 private:
@@ -306,6 +404,11 @@ private:
                                const ProtocolHeader* header, const uint8_t* payload, uint32_t payloadLen, const TcpStreamKey* tcpKey,
                                int depth, int reassemblyFlag);
 
+    /**
+     * @brief 重新编译应用层解析器特征(调用前需要持有解析器列表锁)
+     */
+    void compileSignatures();
+
     /**
      * @brief 遍历IPv6扩展头链获取最终协议类型
      * @param data IPv6数据包起始位置
@@ -320,7 +423,7 @@ private:
                                bool stopAtFragment = false, Ipv6FragmentHeader* fragHeader = nullptr);
 
     /**
-     * @brief 清理IP分片缓存
+     * @brief 清理IP分片缓存(从LRU链表头部开始, 只处理超时或超出数量的分片组)
      * @param ntp 当前时间点
      */
     void cleanupFragmentCache(const std::chrono::steady_clock::time_point& ntp);
@@ -354,11 +457,37 @@ private:
                                  bool& isMoreFragment, uint32_t& fragOffset, uint32_t& fragHeaderLen, uint32_t& identification);
 
     /**
-     * @brief 清理TCP流缓存
+     * @brief 清理TCP流缓存(从LRU链表头部开始, 只处理超时或超出数量的流)
      * @param ntp 当前时间点
      */
     void cleanupTcpStreamCache(const std::chrono::steady_clock::time_point& ntp);
 
+    /**
+     * @brief 清理流中超时的乱序分段
+     * @param ntp 当前时间点
+     * @param info 流信息
+     */
+    void cleanupTcpSegments(const std::chrono::steady_clock::time_point& ntp, TcpStreamInfo* info);
+
+    /**
+     * @brief 删除IP分片组
+     * @param info 分片信息
+     */
+    void eraseFragment(FragmentInfo* info);
+
+    /**
+     * @brief 结束TCP流(从缓存中删除, 并记录待通知的流结束事件)
+     * @param ntp 当前时间点
+     * @param info 流信息
+     * @param reason 结束原因
+     */
+    void endTcpStream(const std::chrono::steady_clock::time_point& ntp, TcpStreamInfo* info, FlowEndReason reason);
+
+    /**
+     * @brief 通知流结束事件(在数据包解析之前或解析完之后调用, 避免解析器在解析过程中被回调)
+     */
+    void notifyFlowEnd();
+
     /**
      * @brief 检查并处理TCP流
      * @param ntp 当前时间点
@@ -376,19 +505,48 @@ private:
                                  const ProtocolHeader* transportHeader, const uint8_t* payload, uint32_t payloadLen, TcpStreamKey& key,
                                  bool& needMoreData, std::vector<uint8_t>& outData, bool& isReassembly);
 
+    /**
+     * @brief 确保重组内存足够, 不足时按最近访问时间淘汰最旧的流(分片组), 直到已用内存降到上限的7/8以下
+     * @param ntp 当前时间点
+     * @param len 需要的数据长度
+     * @param keepFragment 不能淘汰的分片组(正在处理)
+     * @param keepStream 不能淘汰的流(正在处理)
+     * @return true-内存足够, false-淘汰后仍然不足
+     */
+    bool reserveReassemblyMemory(const std::chrono::steady_clock::time_point& ntp, size_t len, const FragmentInfo* keepFragment,
+                                 const TcpStreamInfo* keepStream);
+
+private:
+    /**
+     * @brief 待通知的流结束事件
+     */
+    struct FlowEndEvent
+    {
+        std::chrono::steady_clock::time_point ntp; /* 结束时间点 */
+        TcpStreamKey key; /* 流键 */
+        FlowEndReason reason; /* 结束原因 */
+    };
+
 private:
     const CallbackConfig m_cbCfg; /* 回调配置 */
     const IpReassemblyConfig m_ipReassemblyCfg; /* IP分片重组配置 */
     const TcpReassemblyConfig m_tcpReassemblyCfg; /* TCP分段重组配置 */
+    const ReassemblyMemoryConfig m_memoryCfg; /* 重组内存配置 */
+
+    ReassemblyMemory m_reassemblyMemory; /* 重组内存池(需要在各个缓存之前定义, 最后析构) */
+    std::atomic<size_t> m_evictedFlows = {0}; /* 淘汰的流数量 */
+    std::atomic<size_t> m_evictedBytes = {0}; /* 淘汰的流释放的内存 */
 
+    LruNode m_fragmentLru; /* IP分片LRU链表头(需要在缓存之前定义, 缓存中的节点析构时会访问链表头) */
     phmap::flat_hash_map<FragmentKey, std::unique_ptr<FragmentInfo>> m_fragmentCache; /* IP分片缓存 */
-    std::chrono::steady_clock::time_point m_lastCleanupTime = std::chrono::steady_clock::now(); /* 上次清理IP分片缓存时间 */
 
+    LruNode m_tcpStreamLru; /* TCP流LRU链表头(需要在缓存之前定义) */
     phmap::flat_hash_map<TcpStreamKey, std::unique_ptr<TcpStreamInfo>> m_tcpStreamCache; /* TCP流缓存 */
-    std::chrono::steady_clock::time_point m_lastTcpCleanupTime = std::chrono::steady_clock::now(); /* 上次清理TCP流缓存时间 */
+    std::vector<FlowEndEvent> m_flowEndList; /* 待通知的流结束事件 */
 
     std::mutex m_mutexParserList;
     std::vector<std::shared_ptr<ProtocolParser>> m_applicationParserList; /* 应用层解析器列表 */
+    SignatureMatcher m_signatureMatcher; /* 应用层解析器特征匹配器(解析器列表变化时重新编译) */
     phmap::flat_hash_map<uint16_t, std::shared_ptr<ProtocolParser>> m_applicationParserMap; /* 应用层解析器映射表, key-端口 */
     phmap::flat_hash_map<uint16_t, bool> m_portStrictMap; /* 端口严格匹配映射表, key-端口, value-是否严格匹配 */
 };
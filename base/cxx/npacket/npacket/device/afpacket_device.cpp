@@ -1,7 +1,9 @@
 #include "afpacket_device.h"
 #ifdef __linux__
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cerrno>
 #include <cstring>
 #include <ifaddrs.h>
 #include <linux/if_ether.h>
@@ -10,6 +12,8 @@
 #include <net/if.h>
 #include <pcap.h> /* 用于BPF编译 */
 #include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
@@ -18,9 +22,33 @@
 #ifndef PACKET_IGNORE_OUTGOING
 #define PACKET_IGNORE_OUTGOING 27
 #endif
+#ifndef PACKET_FANOUT_QM
+#define PACKET_FANOUT_QM 5
+#endif
+#ifndef PACKET_FANOUT_FLAG_DEFRAG
+#define PACKET_FANOUT_FLAG_DEFRAG 0x8000
+#endif
 
 namespace npacket
 {
+/**
+ * @brief 自动生成的扇出组ID冲突时的最大重试次数
+ */
+static const int MAX_FANOUT_GROUP_RETRY = 16;
+
+/**
+ * @brief 自动生成扇出组ID(混合进程ID, 接口索引和进程内递增序号, 同一进程在同一网卡上打开的多个设备使用不同的组)
+ * @param ifIndex 接口索引
+ * @return 组ID, 值: [1, 65535]
+ */
+static int generateFanoutGroupId(int ifIndex)
+{
+    static std::atomic<uint32_t> s_fanoutSeq(0);
+    const uint32_t seq = s_fanoutSeq.fetch_add(1); /* 乘以奇数, 65536个序号内不会重复 */
+    const int groupId = (int)(((uint32_t)getpid() ^ ((uint32_t)ifIndex << 8) ^ (seq * 0x9E3B)) & 0xFFFF);
+    return (0 == groupId) ? 1 : groupId;
+}
+
 AfPacketDevice::~AfPacketDevice()
 {
     close();
@@ -50,70 +78,99 @@ bool AfPacketDevice::isLoopback()
     return m_isLoopback;
 }
 
-bool AfPacketDevice::open(const std::string& name, int direction, int snapLen, int promisc, int timeout, int bufferSize)
+bool AfPacketDevice::open(const std::string& name, int direction, int snapLen, int promisc, int timeout, int bufferSize,
+                          const AfPacketFanoutConfig& fanoutCfg)
 {
     if (name.empty() || name.size() >= IFNAMSIZ)
     {
         return false;
     }
     std::lock_guard<std::recursive_mutex> locker(m_mutex);
-    if (m_sockfd >= 0)
+    if (!m_queueList.empty())
     {
         return true;
     }
-    /* 创建AF_PACKET套接字 */
-    m_sockfd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
-    if (m_sockfd < 0)
-    {
-        return false;
-    }
     /* 获取接口索引 */
     int ifIndex = if_nametoindex(name.c_str());
     if (0 == ifIndex)
     {
-        close();
         return false;
     }
+    /* 保存参数 */
+    m_name = name;
+    m_snapLen = (snapLen <= 0 || snapLen > 65536) ? 65536 : snapLen;
+    m_timeoutMs = timeout;
+    m_describe = name;
+    m_fanoutCfg = fanoutCfg;
+    m_fanoutCfg.queueCount = std::min(std::max(m_fanoutCfg.queueCount, (size_t)1), (size_t)64);
+    const bool autoGroupId = (m_fanoutCfg.groupId <= 0 || m_fanoutCfg.groupId > 0xFFFF);
+    if (autoGroupId)
+    {
+        m_fanoutCfg.groupId = generateFanoutGroupId(ifIndex);
+    }
+    /* 创建队列 */
+    for (size_t i = 0; i < m_fanoutCfg.queueCount; ++i)
+    {
+        auto queue = std::make_unique<Queue>();
+        queue->index = i;
+        if (!openQueue(*queue, ifIndex, direction, promisc, bufferSize))
+        {
+            closeQueue(*queue);
+            close();
+            return false;
+        }
+        /* 加入扇出组(需要在绑定之后设置) */
+        if (m_fanoutCfg.queueCount > 1)
+        {
+            int fanoutType = PACKET_FANOUT_HASH;
+            switch (m_fanoutCfg.mode)
+            {
+            case AfPacketFanoutMode::LB:
+                fanoutType = PACKET_FANOUT_LB;
+                break;
+            case AfPacketFanoutMode::CPU:
+                fanoutType = PACKET_FANOUT_CPU;
+                break;
+            case AfPacketFanoutMode::QM:
+                fanoutType = PACKET_FANOUT_QM;
+                break;
+            default:
+                break;
+            }
+            if (m_fanoutCfg.defrag)
+            {
+                fanoutType |= PACKET_FANOUT_FLAG_DEFRAG;
+            }
+            int fanoutArg = (m_fanoutCfg.groupId | (fanoutType << 16));
+            int ret = setsockopt(queue->sockfd, SOL_PACKET, PACKET_FANOUT, &fanoutArg, sizeof(fanoutArg));
+            /* 自动生成的组ID已被其他抓包程序使用(类型或标志不同)时, 换下一个ID重试(只在创建组的第1个队列上重试) */
+            for (int retry = 0; ret < 0 && autoGroupId && 0 == i && (EINVAL == errno || EBUSY == errno) && retry < MAX_FANOUT_GROUP_RETRY;
+                 ++retry)
+            {
+                m_fanoutCfg.groupId = generateFanoutGroupId(ifIndex);
+                fanoutArg = (m_fanoutCfg.groupId | (fanoutType << 16));
+                ret = setsockopt(queue->sockfd, SOL_PACKET, PACKET_FANOUT, &fanoutArg, sizeof(fanoutArg));
+            }
+            if (ret < 0)
+            {
+                closeQueue(*queue);
+                close();
+                return false;
+            }
+        }
+        m_queueList.emplace_back(std::move(queue));
+    }
     /* 获取接口标志 */
     struct ifreq ifr;
     memset(&ifr, 0, sizeof(ifr));
     strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
     ifr.ifr_name[IFNAMSIZ - 1] = '\0'; /* 确保字符串终止 */
-    if (ioctl(m_sockfd, SIOCGIFFLAGS, &ifr) < 0)
+    if (ioctl(m_queueList[0]->sockfd, SIOCGIFFLAGS, &ifr) < 0)
     {
         close();
         return false;
     }
     m_isLoopback = (ifr.ifr_flags & IFF_LOOPBACK) != 0;
-    /* 设置混杂模式 */
-    if (promisc)
-    {
-        struct packet_mreq mr;
-        memset(&mr, 0, sizeof(mr));
-        mr.mr_ifindex = ifIndex;
-        mr.mr_type = PACKET_MR_PROMISC;
-        if (setsockopt(m_sockfd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mr, sizeof(mr)) < 0)
-        {
-            /* 非致命错误, 继续 */
-        }
-    }
-    /* 设置接收缓冲区大小 */
-    if (bufferSize >= 65536)
-    {
-        setsockopt(m_sockfd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
-    }
-    /* 设置方向过滤(Linux 3.2+支持) */
-    if (direction == 1 || direction == 2)
-    {
-        /* 1=仅接收, 2=仅发送 -> 0=不忽略发送, 1=忽略发送(仅接收) */
-        int ignore_outgoing = (direction == 1) ? 1 : 0;
-        setsockopt(m_sockfd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore_outgoing, sizeof(ignore_outgoing));
-    }
-    /* 保存参数 */
-    m_name = name;
-    m_snapLen = (snapLen <= 0 || snapLen > 65536) ? 65536 : snapLen;
-    m_timeoutMs = timeout;
-    m_describe = name;
     /* 获取IPv4地址 */
     struct ifaddrs* ifaddr;
     if (0 == getifaddrs(&ifaddr))
@@ -130,77 +187,13 @@ bool AfPacketDevice::open(const std::string& name, int direction, int snapLen, i
         }
         freeifaddrs(ifaddr);
     }
-    /* TPACKET_V3 配置 */
-    m_useV3 = false;
-    const size_t minV3BufferSize = 8 * 1024 * 1024; /* 至少8MB才启用V3 */
-    const size_t v3BlockSize = 2 * 1024 * 1024; /* 块大小: 2MB (必须是2的幂) */
-    if (bufferSize >= (int)(minV3BufferSize))
-    {
-        int version = TPACKET_V3; /* 启用TPACKET_V3版本 */
-        if (0 == setsockopt(m_sockfd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)))
-        {
-            /* 配置V3环形缓冲区 */
-            struct tpacket_req3 req;
-            memset(&req, 0, sizeof(req));
-            req.tp_block_size = v3BlockSize;
-            req.tp_block_nr = bufferSize / req.tp_block_size;
-            if (req.tp_block_nr == 0) /* 防止除零 */
-            {
-                close();
-                return false;
-            }
-            req.tp_frame_size = m_snapLen;
-            /* 检查整数溢出: tp_block_size * tp_block_nr */
-            size_t totalSize = 0;
-            if (__builtin_mul_overflow(req.tp_block_size, req.tp_block_nr, &totalSize))
-            {
-                close();
-                return false;
-            }
-            req.tp_frame_nr = totalSize / req.tp_frame_size;
-            /* 设置15ms超时, 避免块长时间未满 */
-            req.tp_retire_blk_tov = 15; /* 15ms超时退役块 */
-            req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
-            if (0 == setsockopt(m_sockfd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)))
-            {
-                /* 内存映射环形缓冲区 */
-                m_ringBufferSize = req.tp_block_size * req.tp_block_nr;
-                m_ringBuffer = (uint8_t*)(mmap(nullptr, m_ringBufferSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, m_sockfd, 0));
-                if (MAP_FAILED != m_ringBuffer)
-                {
-                    m_useV3 = true;
-                    m_blockCount = req.tp_block_nr;
-                    m_currentBlock = (struct tpacket_block_desc*)(m_ringBuffer);
-                    m_blockIndex = 0;
-                    /* 锁定内存，防止被交换到磁盘 */
-                    mlock(m_ringBuffer, m_ringBufferSize);
-                }
-            }
-        }
-    }
-    /* 绑定到指定接口 */
-    struct sockaddr_ll saddr;
-    memset(&saddr, 0, sizeof(saddr));
-    saddr.sll_family = AF_PACKET;
-    saddr.sll_protocol = htons(ETH_P_ALL);
-    saddr.sll_ifindex = ifIndex;
-    if (bind(m_sockfd, (struct sockaddr*)&saddr, sizeof(saddr)) < 0)
-    {
-        close();
-        return false;
-    }
-    /* 普通模式缓冲区 */
-    if (!m_useV3)
-    {
-        m_buffer.resize(m_snapLen);
-    }
     return true;
 }
 
 bool AfPacketDevice::setFilter(const std::string& bpf, int optimize, int netmask)
 {
     std::lock_guard<std::recursive_mutex> locker(m_mutex);
-    if (m_sockfd < 0)
+    if (m_queueList.empty())
     {
         return false;
     }
@@ -216,16 +209,19 @@ bool AfPacketDevice::setFilter(const std::string& bpf, int optimize, int netmask
         pcap_close(pcap);
         return false;
     }
-    /* 应用BPF到套接字 */
-    if (setsockopt(m_sockfd, SOL_SOCKET, SO_ATTACH_FILTER, &fp, sizeof(fp)) < 0)
+    /* 应用BPF到所有队列的套接字 */
+    bool ret = true;
+    for (const auto& queue : m_queueList)
     {
-        pcap_freecode(&fp);
-        pcap_close(pcap);
-        return false;
+        if (setsockopt(queue->sockfd, SOL_SOCKET, SO_ATTACH_FILTER, &fp, sizeof(fp)) < 0)
+        {
+            ret = false;
+            break;
+        }
     }
     pcap_freecode(&fp);
     pcap_close(pcap);
-    return true;
+    return ret;
 }
 
 void AfPacketDevice::setDataCallback(const std::function<void(const unsigned char* data, unsigned int dataLen)>& cb)
@@ -234,100 +230,153 @@ void AfPacketDevice::setDataCallback(const std::function<void(const unsigned cha
     m_onDataCallback = cb;
 }
 
+void AfPacketDevice::setBatchCallback(const BATCH_CALLBACK& cb)
+{
+    std::lock_guard<std::mutex> locker(m_mutexOnDataCallback);
+    m_onBatchCallback = cb;
+}
+
 int AfPacketDevice::captureOnce(unsigned int count)
 {
     std::lock_guard<std::recursive_mutex> locker(m_mutex);
-    if (m_sockfd < 0 || !m_captureStarted.load())
+    if (m_queueList.empty() || !m_captureStarted.load() || m_threaded.load())
     {
         return -1;
     }
-    /* TPACKET_V3 模式 */
-    if (m_useV3)
+    /* 先处理已就绪的数据 */
+    size_t packets = 0; /* 实际处理的包数量 */
+    for (auto& queue : m_queueList)
     {
-        return (int)processV3Block();
+        packets += processQueue(*queue, count > 0 ? count - (unsigned int)packets : 0);
+        if (count > 0 && packets >= count) /* 达到限制则退出 */
+        {
+            return (int)packets;
+        }
     }
-    /* 普通模式 */
-    struct pollfd pfd;
-    pfd.fd = m_sockfd;
-    pfd.events = POLLIN;
-    if (poll(&pfd, 1, m_timeoutMs) <= 0) /* 超时或无数据 */
+    if (packets > 0)
     {
-        return 0;
+        return (int)packets;
     }
-    /* 获取回调(减少锁开销) */
-    std::function<void(const unsigned char* data, unsigned int dataLen)> onDataCallback = nullptr;
+    /* 等待任意队列就绪 */
+    std::vector<struct pollfd> pfdList(m_queueList.size());
+    for (size_t i = 0; i < m_queueList.size(); ++i)
     {
-        std::lock_guard<std::mutex> locker(m_mutexOnDataCallback);
-        onDataCallback = m_onDataCallback;
+        pfdList[i].fd = m_queueList[i]->sockfd;
+        pfdList[i].events = POLLIN;
+        pfdList[i].revents = 0;
     }
-    if (!onDataCallback) /* 无回调无需捕获 */
+    if (poll(pfdList.data(), pfdList.size(), m_timeoutMs) <= 0) /* 超时或无数据 */
     {
         return 0;
     }
-    size_t packets = 0; /* 实际处理的包数量 */
-    while (1) /* 循环处理 */
+    for (size_t i = 0; i < m_queueList.size(); ++i)
     {
-        if (count > 0 && packets >= count) /* 达到限制则退出 */
-        {
-            break;
-        }
-        ssize_t len = recvfrom(m_sockfd, m_buffer.data(), m_snapLen, MSG_DONTWAIT, nullptr, nullptr);
-        if (len <= 0) /* EAGAIN或无数据 */
+        if (pfdList[i].revents & POLLIN)
         {
-            break;
+            packets += processQueue(*m_queueList[i], count > 0 ? count - (unsigned int)packets : 0);
+            if (count > 0 && packets >= count)
+            {
+                break;
+            }
         }
-        ++packets;
-        onDataCallback(m_buffer.data(), len);
     }
     return (int)packets;
 }
 
-bool AfPacketDevice::startCapture()
+bool AfPacketDevice::startCapture(bool threaded)
 {
     std::lock_guard<std::recursive_mutex> locker(m_mutex);
-    if (m_sockfd < 0 || m_captureStarted.load())
+    if (m_queueList.empty() || m_captureStarted.load())
     {
         return false;
     }
+    for (const auto& queue : m_queueList) /* 上次停止时未回收的线程(在回调中调用stopCapture) */
+    {
+        if (queue->thread.joinable())
+        {
+            return false;
+        }
+    }
     m_captureStarted = true;
+    m_threaded = threaded;
+    if (threaded)
+    {
+        for (auto& queue : m_queueList)
+        {
+            auto ptr = queue.get();
+            queue->thread = std::thread([this, ptr]() { captureLoop(ptr); });
+            if (!m_fanoutCfg.cpuList.empty()) /* 绑定CPU */
+            {
+                const int cpu = m_fanoutCfg.cpuList[queue->index % m_fanoutCfg.cpuList.size()];
+                if (cpu >= 0 && cpu < CPU_SETSIZE)
+                {
+                    cpu_set_t cpuset;
+                    CPU_ZERO(&cpuset);
+                    CPU_SET(cpu, &cpuset);
+                    pthread_setaffinity_np(queue->thread.native_handle(), sizeof(cpuset), &cpuset);
+                }
+            }
+        }
+    }
     return true;
 }
 
 void AfPacketDevice::stopCapture()
 {
     m_captureStarted = false;
+    /* 取出捕获线程后再等待退出, 避免持锁等待(回调中可能调用其他接口) */
+    std::vector<std::thread> threadList;
+    {
+        std::lock_guard<std::recursive_mutex> locker(m_mutex);
+        for (auto& queue : m_queueList)
+        {
+            if (queue->thread.joinable() && std::this_thread::get_id() != queue->thread.get_id())
+            {
+                threadList.emplace_back(std::move(queue->thread));
+            }
+        }
+    }
+    for (auto& th : threadList)
+    {
+        th.join();
+    }
+    m_threaded = false;
 }
 
 void AfPacketDevice::close()
 {
     stopCapture();
     std::lock_guard<std::recursive_mutex> locker(m_mutex);
-    /* 清理TPACKET_V3资源 */
-    if (m_useV3 && m_ringBuffer)
+    for (const auto& queue : m_queueList)
     {
-        /* 解除内存锁定 */
-        if (m_ringBufferSize > 0)
+        if (queue->thread.joinable()) /* 在捕获线程的回调中调用, 线程退出后才能释放队列, 由后续调用(或析构)关闭 */
         {
-            munlock(m_ringBuffer, m_ringBufferSize);
+            return;
         }
-        /* 取消内存映射 */
-        if (MAP_FAILED != m_ringBuffer)
-        {
-            munmap(m_ringBuffer, m_ringBufferSize);
-        }
-        /* 停止环形缓冲区 */
-        struct tpacket_req3 req = {0};
-        setsockopt(m_sockfd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
-        m_ringBuffer = nullptr;
-        m_ringBufferSize = 0;
-        m_blockCount = 0;
-        m_useV3 = false;
     }
-    if (m_sockfd >= 0)
+    for (auto& queue : m_queueList)
+    {
+        closeQueue(*queue);
+    }
+    m_queueList.clear();
+}
+
+size_t AfPacketDevice::getQueueCount()
+{
+    std::lock_guard<std::recursive_mutex> locker(m_mutex);
+    return m_queueList.size();
+}
+
+std::vector<AfPacketStat> AfPacketDevice::getStats()
+{
+    std::lock_guard<std::recursive_mutex> locker(m_mutex);
+    std::vector<AfPacketStat> statList;
+    for (auto& queue : m_queueList)
     {
-        ::close(m_sockfd);
-        m_sockfd = -1;
+        updateStat(*queue);
+        statList.emplace_back(queue->stat);
     }
+    return statList;
 }
 
 std::vector<std::shared_ptr<AfPacketDevice>> AfPacketDevice::getAllDevices(std::string* errorBuffer)
@@ -387,59 +436,293 @@ std::vector<std::shared_ptr<AfPacketDevice>> AfPacketDevice::getAllDevices(std::
     return devList;
 }
 
-size_t AfPacketDevice::processV3Block()
+bool AfPacketDevice::openQueue(Queue& queue, int ifIndex, int direction, int promisc, int bufferSize)
+{
+    /* 创建AF_PACKET套接字 */
+    queue.sockfd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (queue.sockfd < 0)
+    {
+        return false;
+    }
+    /* 设置混杂模式 */
+    if (promisc)
+    {
+        struct packet_mreq mr;
+        memset(&mr, 0, sizeof(mr));
+        mr.mr_ifindex = ifIndex;
+        mr.mr_type = PACKET_MR_PROMISC;
+        if (setsockopt(queue.sockfd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mr, sizeof(mr)) < 0)
+        {
+            /* 非致命错误, 继续 */
+        }
+    }
+    /* 设置接收缓冲区大小 */
+    if (bufferSize >= 65536)
+    {
+        setsockopt(queue.sockfd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    }
+    /* 设置方向过滤(Linux 3.2+支持) */
+    if (direction == 1 || direction == 2)
+    {
+        /* 1=仅接收, 2=仅发送 -> 0=不忽略发送, 1=忽略发送(仅接收) */
+        int ignore_outgoing = (direction == 1) ? 1 : 0;
+        setsockopt(queue.sockfd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore_outgoing, sizeof(ignore_outgoing));
+    }
+    /* TPACKET_V3 配置 */
+    queue.useV3 = false;
+    const size_t minV3BufferSize = 8 * 1024 * 1024; /* 至少8MB才启用V3 */
+    const size_t v3BlockSize = 2 * 1024 * 1024; /* 块大小: 2MB (必须是2的幂) */
+    if (bufferSize >= (int)(minV3BufferSize))
+    {
+        int version = TPACKET_V3; /* 启用TPACKET_V3版本 */
+        if (0 == setsockopt(queue.sockfd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)))
+        {
+            /* 配置V3环形缓冲区 */
+            struct tpacket_req3 req;
+            memset(&req, 0, sizeof(req));
+            req.tp_block_size = v3BlockSize;
+            req.tp_block_nr = bufferSize / req.tp_block_size;
+            if (req.tp_block_nr == 0) /* 防止除零 */
+            {
+                return false;
+            }
+            req.tp_frame_size = m_snapLen;
+            /* 检查整数溢出: tp_block_size * tp_block_nr */
+            size_t totalSize = 0;
+            if (__builtin_mul_overflow(req.tp_block_size, req.tp_block_nr, &totalSize))
+            {
+                return false;
+            }
+            req.tp_frame_nr = totalSize / req.tp_frame_size;
+            /* 设置15ms超时, 避免块长时间未满 */
+            req.tp_retire_blk_tov = 15; /* 15ms超时退役块 */
+            req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+            if (0 == setsockopt(queue.sockfd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)))
+            {
+                /* 内存映射环形缓冲区 */
+                queue.ringBufferSize = req.tp_block_size * req.tp_block_nr;
+                queue.ringBuffer =
+                    (uint8_t*)(mmap(nullptr, queue.ringBufferSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, queue.sockfd, 0));
+                if (MAP_FAILED != queue.ringBuffer)
+                {
+                    queue.useV3 = true;
+                    queue.blockSize = req.tp_block_size;
+                    queue.blockCount = req.tp_block_nr;
+                    queue.blockIndex = 0;
+                    /* 锁定内存，防止被交换到磁盘 */
+                    mlock(queue.ringBuffer, queue.ringBufferSize);
+                }
+                else
+                {
+                    queue.ringBuffer = nullptr;
+                    queue.ringBufferSize = 0;
+                }
+            }
+        }
+    }
+    /* 绑定到指定接口 */
+    struct sockaddr_ll saddr;
+    memset(&saddr, 0, sizeof(saddr));
+    saddr.sll_family = AF_PACKET;
+    saddr.sll_protocol = htons(ETH_P_ALL);
+    saddr.sll_ifindex = ifIndex;
+    if (bind(queue.sockfd, (struct sockaddr*)&saddr, sizeof(saddr)) < 0)
+    {
+        return false;
+    }
+    /* 普通模式缓冲区 */
+    if (!queue.useV3)
+    {
+        queue.buffer.resize(m_snapLen);
+    }
+    return true;
+}
+
+void AfPacketDevice::closeQueue(Queue& queue)
+{
+    /* 清理TPACKET_V3资源 */
+    if (queue.ringBuffer)
+    {
+        /* 解除内存锁定 */
+        if (queue.ringBufferSize > 0)
+        {
+            munlock(queue.ringBuffer, queue.ringBufferSize);
+        }
+        /* 取消内存映射 */
+        munmap(queue.ringBuffer, queue.ringBufferSize);
+        /* 停止环形缓冲区 */
+        struct tpacket_req3 req = {0};
+        setsockopt(queue.sockfd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+        queue.ringBuffer = nullptr;
+        queue.ringBufferSize = 0;
+        queue.blockCount = 0;
+        queue.useV3 = false;
+    }
+    if (queue.sockfd >= 0)
+    {
+        ::close(queue.sockfd);
+        queue.sockfd = -1;
+    }
+}
+
+size_t AfPacketDevice::processQueue(Queue& queue, unsigned int count)
+{
+    /* TPACKET_V3 模式 */
+    if (queue.useV3)
+    {
+        return processV3Block(queue);
+    }
+    /* 普通模式 */
+    /* 获取回调(减少锁开销) */
+    std::function<void(const unsigned char* data, unsigned int dataLen)> onDataCallback = nullptr;
+    BATCH_CALLBACK onBatchCallback = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexOnDataCallback);
+        onDataCallback = m_onDataCallback;
+        onBatchCallback = m_onBatchCallback;
+    }
+    if (!onDataCallback && !onBatchCallback) /* 无回调无需捕获 */
+    {
+        return 0;
+    }
+    size_t packets = 0; /* 实际处理的包数量 */
+    while (1) /* 循环处理 */
+    {
+        if (count > 0 && packets >= count) /* 达到限制则退出 */
+        {
+            break;
+        }
+        /* MSG_TRUNC: 返回数据包的原始长度 */
+        ssize_t len = recvfrom(queue.sockfd, queue.buffer.data(), m_snapLen, MSG_DONTWAIT | MSG_TRUNC, nullptr, nullptr);
+        if (len <= 0) /* EAGAIN或无数据 */
+        {
+            break;
+        }
+        ++packets;
+        const unsigned int dataLen = (len > m_snapLen) ? m_snapLen : (unsigned int)len;
+        if (onBatchCallback)
+        {
+            AfPacketFrame frame;
+            frame.data = queue.buffer.data();
+            frame.dataLen = dataLen;
+            frame.wireLen = (unsigned int)len;
+            onBatchCallback(queue.index, &frame, 1);
+        }
+        else
+        {
+            onDataCallback(queue.buffer.data(), dataLen);
+        }
+    }
+    return packets;
+}
+
+size_t AfPacketDevice::processV3Block(Queue& queue)
 {
-    if (!m_useV3 || !m_ringBuffer || !m_captureStarted.load())
+    if (!queue.useV3 || !queue.ringBuffer || !m_captureStarted.load())
     {
         return 0;
     }
     size_t packetsProcessed = 0;
-    /* 遍历所有块, 处理就绪的块 */
-    for (unsigned int i = 0; i < m_blockCount; ++i)
+    /* 内核按顺序填充块, 从当前块开始依次处理就绪的块(每次最多处理1轮, 避免长时间占用) */
+    for (unsigned int i = 0; i < queue.blockCount; ++i)
     {
-        ::tpacket_block_desc* block = (::tpacket_block_desc*)(m_ringBuffer + (i * m_ringBufferSize / m_blockCount));
+        ::tpacket_block_desc* block = (::tpacket_block_desc*)(queue.ringBuffer + (size_t)queue.blockIndex * queue.blockSize);
         /* 检查块是否准备好被用户处理 */
-        if (0 == (block->hdr.bh1.block_status & TP_STATUS_USER))
+        if (0 == (__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER))
         {
-            continue;
+            break;
         }
-        /* 遍历块中的所有帧 */
-        ::tpacket3_hdr* ppd = (::tpacket3_hdr*)((uint8_t*)(block) + block->hdr.bh1.offset_to_first_pkt);
-        unsigned int pktIndex = 0;
         /* 获取回调(减少锁开销) */
         std::function<void(const unsigned char* data, unsigned int dataLen)> onDataCallback = nullptr;
+        BATCH_CALLBACK onBatchCallback = nullptr;
         {
             std::lock_guard<std::mutex> locker(m_mutexOnDataCallback);
             onDataCallback = m_onDataCallback;
+            onBatchCallback = m_onBatchCallback;
         }
-        if (!onDataCallback) /* 无回调无需处理 */
-        {
-            block->hdr.bh1.block_status = TP_STATUS_KERNEL; /* 直接归还内核 */
-            continue;
-        }
-        while (ppd && pktIndex < block->hdr.bh1.num_pkts)
+        /* 遍历块中的所有帧 */
+        const unsigned int numPkts = block->hdr.bh1.num_pkts;
+        if (onDataCallback || onBatchCallback) /* 无回调时直接归还内核 */
         {
-            ++packetsProcessed;
-            /* 验证帧数据指针和长度 */
-            uint8_t* data = (uint8_t*)(ppd) + ppd->tp_mac;
-            unsigned int dataLen = ppd->tp_snaplen;
-            if (dataLen > m_snapLen) /* 防止回调处理越界数据 */
+            ::tpacket3_hdr* ppd = (::tpacket3_hdr*)((uint8_t*)(block) + block->hdr.bh1.offset_to_first_pkt);
+            queue.frameList.clear();
+            for (unsigned int pktIndex = 0; ppd && pktIndex < numPkts; ++pktIndex)
             {
-                dataLen = m_snapLen;
+                /* 验证帧数据指针和长度 */
+                AfPacketFrame frame;
+                frame.data = (uint8_t*)(ppd) + ppd->tp_mac;
+                frame.dataLen = ppd->tp_snaplen;
+                if (frame.dataLen > (unsigned int)m_snapLen) /* 防止回调处理越界数据 */
+                {
+                    frame.dataLen = m_snapLen;
+                }
+                frame.wireLen = ppd->tp_len;
+                frame.sec = ppd->tp_sec;
+                frame.nsec = ppd->tp_nsec;
+                frame.rxHash = ppd->hv1.tp_rxhash;
+                if (onBatchCallback)
+                {
+                    queue.frameList.emplace_back(frame);
+                }
+                else
+                {
+                    onDataCallback(frame.data, frame.dataLen);
+                }
+                ++packetsProcessed;
+                /* 移动到下一帧, 检查tp_next_offset防止越界 */
+                if (pktIndex + 1 < numPkts && (0 == ppd->tp_next_offset || ppd->tp_next_offset > queue.blockSize))
+                {
+                    break; /* 异常偏移, 防止越界访问 */
+                }
+                ppd = (::tpacket3_hdr*)((uint8_t*)(ppd) + ppd->tp_next_offset);
             }
-            /* 调用回调 */
-            onDataCallback(data, dataLen);
-            /* 移动到下一帧, 检查tp_next_offset防止越界 */
-            if (ppd->tp_next_offset == 0 || ppd->tp_next_offset > (m_ringBufferSize / m_blockCount))
+            if (onBatchCallback && !queue.frameList.empty()) /* 每个块回调1次 */
             {
-                break; /* 异常偏移, 防止越界访问 */
+                onBatchCallback(queue.index, queue.frameList.data(), queue.frameList.size());
             }
-            ppd = (::tpacket3_hdr*)((uint8_t*)(ppd) + ppd->tp_next_offset);
-            ++pktIndex;
         }
-        block->hdr.bh1.block_status = TP_STATUS_KERNEL; /* 块处理完毕, 归还内核 */
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE); /* 块处理完毕, 归还内核 */
+        queue.blockIndex = (queue.blockIndex + 1) % queue.blockCount;
     }
     return packetsProcessed;
 }
+
+void AfPacketDevice::captureLoop(Queue* queue)
+{
+    const int waitMs = (m_timeoutMs > 0 && m_timeoutMs < 100) ? m_timeoutMs : 100; /* 等待超时, 保证能及时响应停止 */
+    struct pollfd pfd;
+    pfd.fd = queue->sockfd;
+    pfd.events = POLLIN;
+    while (m_captureStarted.load())
+    {
+        if (processQueue(*queue, 0) > 0)
+        {
+            continue;
+        }
+        pfd.revents = 0;
+        poll(&pfd, 1, waitMs);
+    }
+}
+
+void AfPacketDevice::updateStat(Queue& queue)
+{
+    if (queue.sockfd < 0)
+    {
+        return;
+    }
+    /* 内核在读取后清零计数, 这里累计 */
+    union tpacket_stats_u st;
+    memset(&st, 0, sizeof(st));
+    socklen_t len = queue.useV3 ? sizeof(st.stats3) : sizeof(st.stats1);
+    if (0 == getsockopt(queue.sockfd, SOL_PACKET, PACKET_STATISTICS, &st, &len))
+    {
+        queue.stat.packets += st.stats1.tp_packets;
+        queue.stat.drops += st.stats1.tp_drops;
+        if (queue.useV3)
+        {
+            queue.stat.freezes += st.stats3.tp_freeze_q_cnt;
+        }
+    }
+}
 } // namespace npacket
 #endif
@@ -2,6 +2,7 @@
 #ifdef __linux__
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -11,17 +12,75 @@
 
 namespace npacket
 {
+/**
+ * @brief 扇出模式(多队列抓包时数据包在各个套接字之间的分配方式)
+ */
+enum class AfPacketFanoutMode
+{
+    HASH = 0, /* 按流哈希分配(同一个流的数据包总是分配到同一队列, 推荐) */
+    LB, /* 轮询分配(负载最均衡, 但同一个流的数据包会分散到不同队列) */
+    CPU, /* 按接收数据包的CPU分配(配合网卡RSS和中断亲和性使用) */
+    QM, /* 按网卡接收队列分配(需要Linux 3.14+) */
+};
+
+/**
+ * @brief 扇出配置
+ */
+struct AfPacketFanoutConfig
+{
+    size_t queueCount = 1; /* 队列数量(即套接字数量, 每个套接字拥有独立的环形缓冲区), 值: [1, 64], 1表示不启用扇出 */
+    AfPacketFanoutMode mode = AfPacketFanoutMode::HASH; /* 扇出模式 */
+    bool defrag = true; /* 是否在分配前重组IP分片(保证HASH模式下分片与首片分配到同一队列) */
+    int groupId = 0; /* 扇出组ID, 值: [1, 65535], 0表示自动生成(同一网卡上的多个抓包程序需使用不同的组ID) */
+    std::vector<int> cpuList; /* 捕获线程绑定的CPU列表(按队列索引循环使用), 为空表示不绑定 */
+};
+
+/**
+ * @brief 数据帧
+ */
+struct AfPacketFrame
+{
+    const unsigned char* data = nullptr; /* 数据 */
+    unsigned int dataLen = 0; /* 数据长度(捕获长度) */
+    unsigned int wireLen = 0; /* 原始长度 */
+    uint32_t sec = 0; /* 时间戳(秒), 仅TPACKET_V3有效 */
+    uint32_t nsec = 0; /* 时间戳(纳秒), 仅TPACKET_V3有效 */
+    uint32_t rxHash = 0; /* 内核计算的流哈希值, 仅TPACKET_V3有效 */
+};
+
+/**
+ * @brief 队列统计
+ */
+struct AfPacketStat
+{
+    uint64_t packets = 0; /* 内核接收的数据包数量 */
+    uint64_t drops = 0; /* 环形缓冲区满时内核丢弃的数据包数量 */
+    uint64_t freezes = 0; /* 环形缓冲区被冻结的次数(所有块都被用户占用), 仅TPACKET_V3有效 */
+};
+
 /**
  * @brief AF_PACKET设备(Linux平台高性能抓包)
- * 
+ *
  * 修复说明:
  * - 修复方向过滤功能(原PACKET_FANOUT误用)
  * - 修复字符串未终止导致的潜在越界
  * - 修复整数溢出和除零风险
  * - 优化锁粒度和V3处理效率
+ *
+ * 多队列: 打开设备时指定扇出配置, 会创建多个套接字并加入同一个PACKET_FANOUT组, 每个套接字拥有独立的环形缓冲区,
+ *         可调用startCapture(true)为每个队列启动1个捕获线程(可绑定CPU), 回调在各个捕获线程中并发调用
  */
 class AfPacketDevice final
 {
+public:
+    /**
+     * @brief 批量数据回调(TPACKET_V3模式下每个块回调1次, 普通模式下每个包回调1次)
+     * @param queueIndex 队列索引
+     * @param frames 数据帧列表(只在回调期间有效, 回调返回后块归还内核)
+     * @param count 数据帧数量
+     */
+    using BATCH_CALLBACK = std::function<void(size_t queueIndex, const AfPacketFrame* frames, size_t count)>;
+
 public:
     ~AfPacketDevice();
 
@@ -56,13 +115,15 @@ public:
      * @param snapLen 快照长度, 要捕获的数据包长度, 正常设置为65536能够满足所有网络
      * @param promisc 混杂模式, 0-普通模式, 1-混杂模式
      * @param timeout 超时读取(毫秒), <=0表示缓冲区满时才返回缓冲区所有包, >0表示超过该时间就返回缓冲区所有包(不管缓冲区有没有满)
-     * @param bufferSize 接收缓冲区大小(字节), >=8MB时自动启用TPACKET_V3
+     * @param bufferSize 接收缓冲区大小(字节, 每个队列), >=8MB时自动启用TPACKET_V3
+     * @param fanoutCfg 扇出配置(多队列)
      * @return true-成功, false-失败
      */
-    bool open(const std::string& name, int direction = 0, int snapLen = 0, int promisc = 1, int timeout = 0, int bufferSize = 0);
+    bool open(const std::string& name, int direction = 0, int snapLen = 0, int promisc = 1, int timeout = 0, int bufferSize = 0,
+              const AfPacketFanoutConfig& fanoutCfg = AfPacketFanoutConfig());
 
     /**
-     * @brief 设置BPF过滤
+     * @brief 设置BPF过滤(应用到所有队列)
      * @param bpf 过滤表达式, 例如: "dst port 80"
      * @param optimize 是否需要优化过滤表达式, 值: 0-不优化, 1-优化
      * @param netmask 指定本地网络的网络掩码
@@ -77,20 +138,27 @@ public:
     void setDataCallback(const std::function<void(const unsigned char* data, unsigned int dataLen)>& cb);
 
     /**
-     * @brief 捕获单次(需要在循环调用)
+     * @brief 设置批量数据回调(设置后优先于数据回调), 说明: 批量回调减少了每个包的函数调用开销, 适用于高速抓包
+     * @param cb 批量数据回调
+     */
+    void setBatchCallback(const BATCH_CALLBACK& cb);
+
+    /**
+     * @brief 捕获单次(需要在循环调用, 依次处理所有队列), 注意: 启动捕获线程时不可调用
      * @param count 指定期望处理的最大数据包数量, 值: 0-无数量限制, >0-最多处理count个数据包
      * @return <0-错误, >=0-实际处理的数据包数量
      */
     int captureOnce(unsigned int count = 0);
 
     /**
-     * @brief 开始捕获(启动后台线程)
+     * @brief 开始捕获
+     * @param threaded 是否启动捕获线程, true-每个队列启动1个后台线程, false-由调用者循环调用captureOnce
      * @return true-成功, false-失败
      */
-    bool startCapture();
+    bool startCapture(bool threaded = false);
 
     /**
-     * @brief 停止捕获
+     * @brief 停止捕获(等待捕获线程退出)
      */
     void stopCapture();
 
@@ -99,6 +167,18 @@ public:
      */
     void close();
 
+    /**
+     * @brief 获取队列数量
+     * @return 队列数量
+     */
+    size_t getQueueCount();
+
+    /**
+     * @brief 获取各个队列的统计(PACKET_STATISTICS, 从打开设备开始累计)
+     * @return 统计列表(按队列索引)
+     */
+    std::vector<AfPacketStat> getStats();
+
     /**
      * @brief 获取本机所有AF_PACKET设备
      * @param errorBuffer [输出]错误信息
@@ -108,10 +188,69 @@ public:
 
 private:
     /**
-     * @brief 处理TPACKET_V3块
+     * @brief 队列(1个套接字及其环形缓冲区)
+     */
+    struct Queue
+    {
+        size_t index = 0; /* 队列索引 */
+        int sockfd = -1; /* AF_PACKET套接字描述符 */
+        std::vector<uint8_t> buffer; /* 普通模式数据缓冲区 */
+        std::vector<AfPacketFrame> frameList; /* 批量回调的数据帧列表(复用) */
+        std::thread thread; /* 捕获线程 */
+        AfPacketStat stat; /* 统计(累计) */
+
+        /* TPACKET_V3 相关成员 */
+        bool useV3 = false; /* 是否使用TPACKET_V3 */
+        uint8_t* ringBuffer = nullptr; /* 环形缓冲区映射地址 */
+        size_t ringBufferSize = 0; /* 环形缓冲区大小 */
+        size_t blockSize = 0; /* 块大小 */
+        unsigned int blockIndex = 0; /* 当前块索引 */
+        unsigned int blockCount = 0; /* 块总数 */
+    };
+
+    /**
+     * @brief 打开队列(创建套接字, 配置并绑定到接口)
+     * @param queue 队列
+     * @param ifIndex 接口索引
+     * @param direction 数据流向
+     * @param promisc 混杂模式
+     * @param bufferSize 接收缓冲区大小
+     * @return true-成功, false-失败
+     */
+    bool openQueue(Queue& queue, int ifIndex, int direction, int promisc, int bufferSize);
+
+    /**
+     * @brief 关闭队列
+     * @param queue 队列
+     */
+    void closeQueue(Queue& queue);
+
+    /**
+     * @brief 处理队列中已就绪的数据(不等待)
+     * @param queue 队列
+     * @param count 最大数据包数量(仅普通模式有效, TPACKET_V3模式按块处理), 0-无数量限制
      * @return 处理的包数量
      */
-    size_t processV3Block();
+    size_t processQueue(Queue& queue, unsigned int count);
+
+    /**
+     * @brief 处理TPACKET_V3块(按顺序处理就绪的块)
+     * @param queue 队列
+     * @return 处理的包数量
+     */
+    size_t processV3Block(Queue& queue);
+
+    /**
+     * @brief 捕获线程
+     * @param queue 队列
+     */
+    void captureLoop(Queue* queue);
+
+    /**
+     * @brief 读取队列的内核统计并累计
+     * @param queue 队列
+     */
+    void updateStat(Queue& queue);
 
 private:
     std::string m_name; /* 设备名 */
@@ -119,21 +258,15 @@ private:
     std::string m_ipv4Address; /* IPv4地址 */
     bool m_isLoopback = false; /* 是否回环 */
     std::recursive_mutex m_mutex; /* 设备操作互斥锁 */
-    int m_sockfd = -1; /* AF_PACKET套接字描述符 */
     int m_snapLen = 65536; /* 快照长度 */
     int m_timeoutMs = 0; /* 超时时间(毫秒) */
+    AfPacketFanoutConfig m_fanoutCfg; /* 扇出配置 */
+    std::vector<std::unique_ptr<Queue>> m_queueList; /* 队列列表 */
     std::atomic<bool> m_captureStarted{false}; /* 是否已经开始捕获 */
-    std::vector<uint8_t> m_buffer; /* 普通模式数据缓冲区 */
+    std::atomic<bool> m_threaded{false}; /* 是否启动了捕获线程 */
     std::mutex m_mutexOnDataCallback;
     std::function<void(const unsigned char* data, unsigned int dataLen)> m_onDataCallback = nullptr; /* 数据回调 */
-
-    /* TPACKET_V3 相关成员 */
-    bool m_useV3 = false; /* 是否使用TPACKET_V3 */
-    uint8_t* m_ringBuffer = nullptr; /* 环形缓冲区映射地址 */
-    size_t m_ringBufferSize = 0; /* 环形缓冲区大小 */
-    struct tpacket_block_desc* m_currentBlock = nullptr; /* 当前块 */
-    unsigned int m_blockIndex = 0; /* 当前块索引 */
-    unsigned int m_blockCount = 0; /* 块总数 */
+    BATCH_CALLBACK m_onBatchCallback = nullptr; /* 批量数据回调 */
 };
 } // namespace npacket
 #endif
@@ -0,0 +1,840 @@
+#include "pcap_file.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace npacket
+{
+static const uint32_t PCAP_MAGIC_US = 0xa1b2c3d4; /* pcap魔数(微秒精度) */
+static const uint32_t PCAP_MAGIC_NS = 0xa1b23c4d; /* pcap魔数(纳秒精度) */
+static const uint32_t PCAPNG_SHB = 0x0A0D0D0A; /* pcapng段头块 */
+static const uint32_t PCAPNG_IDB = 0x00000001; /* pcapng接口描述块 */
+static const uint32_t PCAPNG_OPB = 0x00000002; /* pcapng数据包块(已废弃) */
+static const uint32_t PCAPNG_SPB = 0x00000003; /* pcapng简单数据包块 */
+static const uint32_t PCAPNG_EPB = 0x00000006; /* pcapng增强数据包块 */
+static const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D; /* pcapng字节序魔数 */
+static const uint32_t PCAP_FILE_HEADER_LEN = 24; /* pcap文件头长度 */
+static const uint32_t PCAP_RECORD_HEADER_LEN = 16; /* pcap记录头长度 */
+static const int64_t NANOSECOND_PER_SECOND = 1000000000;
+
+static inline uint16_t swap16(uint16_t v)
+{
+    return (uint16_t)((v >> 8) | (v << 8));
+}
+
+static inline uint32_t swap32(uint32_t v)
+{
+    return (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+}
+
+static inline uint64_t swap64(uint64_t v)
+{
+    return ((uint64_t)swap32((uint32_t)v) << 32) | swap32((uint32_t)(v >> 32));
+}
+
+PcapFileReader::~PcapFileReader()
+{
+    close();
+}
+
+bool PcapFileReader::open(const std::string& filename, std::string* errorDesc)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (INVALID_HANDLE_VALUE == file)
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "can't open file [" + filename + "], error: " + std::to_string(GetLastError());
+        }
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "file [" + filename + "] is empty";
+        }
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* addr = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!addr)
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "can't map file [" + filename + "], error: " + std::to_string(GetLastError());
+        }
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_fileSize = (uint64_t)size.QuadPart;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "can't open file [" + filename + "], errno: " + std::to_string(errno);
+        }
+        return false;
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size <= 0)
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "file [" + filename + "] is empty";
+        }
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); /* 映射建立后不再需要文件描述符 */
+    if (MAP_FAILED == addr)
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "can't map file [" + filename + "], errno: " + std::to_string(errno);
+        }
+        return false;
+    }
+    madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL); /* 顺序读取, 内核加大预读 */
+    m_fileSize = (uint64_t)st.st_size;
+#endif
+    m_data = (const uint8_t*)addr;
+    if (!parseFileHeader(errorDesc))
+    {
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void PcapFileReader::close()
+{
+    if (m_data)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        munmap((void*)m_data, (size_t)m_fileSize);
+#endif
+    }
+    m_data = nullptr;
+    m_fileSize = 0;
+    m_offset = 0;
+    m_firstOffset = 0;
+    m_truncated = false;
+    m_interfaceList.clear();
+}
+
+bool PcapFileReader::isOpened() const
+{
+    return (nullptr != m_data);
+}
+
+PcapFileFormat PcapFileReader::getFormat() const
+{
+    return m_format;
+}
+
+uint64_t PcapFileReader::getFileSize() const
+{
+    return m_fileSize;
+}
+
+bool PcapFileReader::next(PcapFilePacket& pkt)
+{
+    if (!m_data)
+    {
+        return false;
+    }
+    return (PcapFileFormat::PCAPNG == m_format) ? nextPcapng(pkt) : nextPcap(pkt);
+}
+
+void PcapFileReader::rewind()
+{
+    m_offset = m_firstOffset;
+    m_truncated = false;
+    m_interfaceList.clear(); /* pcapng从段头块开始重新读取 */
+}
+
+bool PcapFileReader::isTruncated() const
+{
+    return m_truncated;
+}
+
+size_t PcapFileReader::replay(const REPLAY_CALLBACK& callback, double speed)
+{
+    if (!callback)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    PcapFilePacket pkt;
+    const auto startTime = std::chrono::steady_clock::now();
+    int64_t firstTimestamp = 0;
+    int64_t elapsed = 0;
+    while (next(pkt))
+    {
+        if (0 == count)
+        {
+            firstTimestamp = pkt.timestamp;
+        }
+        elapsed = std::max(elapsed, pkt.timestamp - firstTimestamp); /* 时间戳倒退时保持不变, 保证时间点单调递增 */
+        const auto ntp = startTime + std::chrono::nanoseconds(elapsed);
+        if (speed > 0)
+        {
+            const auto target = startTime + std::chrono::nanoseconds((int64_t)(elapsed / speed));
+            if (target > std::chrono::steady_clock::now())
+            {
+                std::this_thread::sleep_until(target);
+            }
+        }
+        ++count;
+        if (!callback(pkt, ntp))
+        {
+            break;
+        }
+    }
+    return count;
+}
+
+bool PcapFileReader::parseFileHeader(std::string* errorDesc)
+{
+    uint32_t magic = 0;
+    if (m_fileSize >= 4)
+    {
+        memcpy(&magic, m_data, 4);
+    }
+    m_swapped = false;
+    m_nanosecond = false;
+    if (PCAPNG_SHB == magic)
+    {
+        m_format = PcapFileFormat::PCAPNG;
+        m_firstOffset = 0;
+        if (m_fileSize >= 28 && parseSectionHeader(m_data, (uint32_t)std::min(m_fileSize, (uint64_t)UINT32_MAX)))
+        {
+            return true;
+        }
+    }
+    else if (PCAP_MAGIC_US == magic || PCAP_MAGIC_NS == magic || PCAP_MAGIC_US == swap32(magic) || PCAP_MAGIC_NS == swap32(magic))
+    {
+        m_format = PcapFileFormat::PCAP;
+        m_swapped = (PCAP_MAGIC_US != magic && PCAP_MAGIC_NS != magic);
+        m_nanosecond = (PCAP_MAGIC_NS == (m_swapped ? swap32(magic) : magic));
+        m_firstOffset = PCAP_FILE_HEADER_LEN;
+        if (m_fileSize >= PCAP_FILE_HEADER_LEN)
+        {
+            m_linkType = read32(m_data + 20) & 0x0FFFFFFF; /* 高4位为FCS信息 */
+            return true;
+        }
+    }
+    if (errorDesc)
+    {
+        *errorDesc = "unsupported file format";
+    }
+    return false;
+}
+
+bool PcapFileReader::nextPcap(PcapFilePacket& pkt)
+{
+    if (m_offset + PCAP_RECORD_HEADER_LEN > m_fileSize)
+    {
+        m_truncated = (m_offset != m_fileSize);
+        return false;
+    }
+    const uint8_t* p = m_data + m_offset;
+    const uint32_t sec = read32(p);
+    const uint32_t frac = read32(p + 4);
+    const uint32_t capLen = read32(p + 8);
+    if (capLen > m_fileSize - m_offset - PCAP_RECORD_HEADER_LEN)
+    {
+        m_truncated = true;
+        return false;
+    }
+    pkt.data = p + PCAP_RECORD_HEADER_LEN;
+    pkt.capLen = capLen;
+    pkt.wireLen = read32(p + 12);
+    pkt.timestamp = (int64_t)sec * NANOSECOND_PER_SECOND + (m_nanosecond ? frac : (int64_t)frac * 1000);
+    pkt.linkType = m_linkType;
+    pkt.interfaceId = 0;
+    m_offset += PCAP_RECORD_HEADER_LEN + capLen;
+    return true;
+}
+
+bool PcapFileReader::nextPcapng(PcapFilePacket& pkt)
+{
+    while (m_offset + 12 <= m_fileSize)
+    {
+        const uint8_t* p = m_data + m_offset;
+        const uint64_t remainLen = m_fileSize - m_offset;
+        uint32_t type = 0;
+        memcpy(&type, p, 4);
+        if (PCAPNG_SHB == type && !parseSectionHeader(p, (uint32_t)std::min(remainLen, (uint64_t)UINT32_MAX))) /* 新的段, 字节序可能变化 */
+        {
+            m_truncated = true;
+            return false;
+        }
+        type = read32(p);
+        const uint32_t blockLen = read32(p + 4);
+        if (blockLen < 12 || 0 != blockLen % 4 || blockLen > remainLen)
+        {
+            m_truncated = true;
+            return false;
+        }
+        m_offset += blockLen;
+        uint32_t interfaceId = 0, capLen = 0, wireLen = 0, dataOffset = 0;
+        uint64_t ts = 0;
+        switch (type)
+        {
+        case PCAPNG_IDB:
+            parseInterface(p, blockLen);
+            continue;
+        case PCAPNG_EPB: /* 类型(4) + 长度(4) + 接口(4) + 时间戳(8) + 捕获长度(4) + 原始长度(4) + 数据 + 选项 + 长度(4) */
+        case PCAPNG_OPB: /* 类型(4) + 长度(4) + 接口(2) + 丢包数(2) + 时间戳(8) + 捕获长度(4) + 原始长度(4) + 数据 + 选项 + 长度(4) */
+            if (blockLen < 32)
+            {
+                continue;
+            }
+            interfaceId = (PCAPNG_EPB == type) ? read32(p + 8) : read16(p + 8);
+            ts = ((uint64_t)read32(p + 12) << 32) | read32(p + 16);
+            capLen = read32(p + 20);
+            wireLen = read32(p + 24);
+            dataOffset = 28;
+            break;
+        case PCAPNG_SPB: /* 类型(4) + 长度(4) + 原始长度(4) + 数据 + 长度(4), 没有时间戳 */
+            if (blockLen < 16)
+            {
+                continue;
+            }
+            wireLen = read32(p + 8);
+            capLen = std::min(wireLen, blockLen - 16);
+            dataOffset = 12;
+            break;
+        default: /* 其他块(名称解析, 统计等)跳过 */
+            continue;
+        }
+        if (interfaceId >= m_interfaceList.size() || capLen > blockLen - dataOffset - 4)
+        {
+            continue; /* 块内容不合法, 跳过 */
+        }
+        const auto& iface = m_interfaceList[interfaceId];
+        pkt.data = p + dataOffset;
+        pkt.capLen = capLen;
+        pkt.wireLen = wireLen;
+        pkt.timestamp = (PCAPNG_SPB == type) ? 0 : toNanosecond(iface, ts);
+        pkt.linkType = iface.linkType;
+        pkt.interfaceId = interfaceId;
+        return true;
+    }
+    m_truncated = (m_offset != m_fileSize);
+    return false;
+}
+
+bool PcapFileReader::parseSectionHeader(const uint8_t* block, uint32_t blockLen)
+{
+    if (blockLen < 12)
+    {
+        return false;
+    }
+    uint32_t byteOrder = 0;
+    memcpy(&byteOrder, block + 8, 4);
+    if (PCAPNG_BYTE_ORDER_MAGIC == byteOrder)
+    {
+        m_swapped = false;
+    }
+    else if (PCAPNG_BYTE_ORDER_MAGIC == swap32(byteOrder))
+    {
+        m_swapped = true;
+    }
+    else
+    {
+        return false;
+    }
+    m_interfaceList.clear(); /* 接口序号在每个段内独立编号 */
+    return true;
+}
+
+void PcapFileReader::parseInterface(const uint8_t* block, uint32_t blockLen)
+{
+    Interface iface;
+    if (blockLen >= 20)
+    {
+        iface.linkType = read16(block + 8);
+        /* 选项: 代码(2) + 长度(2) + 值(按4字节对齐) */
+        uint32_t pos = 16;
+        while (pos + 4 <= blockLen - 4)
+        {
+            const uint16_t code = read16(block + pos);
+            const uint16_t len = read16(block + pos + 2);
+            pos += 4;
+            if (0 == code || pos + len > blockLen - 4) /* opt_endofopt */
+            {
+                break;
+            }
+            if (9 == code && len >= 1) /* if_tsresol */
+            {
+                iface.binaryResolution = (0 != (block[pos] & 0x80));
+                iface.resolution = block[pos] & 0x7F;
+            }
+            else if (14 == code && len >= 8) /* if_tsoffset */
+            {
+                iface.offset = (int64_t)read64(block + pos);
+            }
+            pos += (len + 3) & ~3U;
+        }
+    }
+    m_interfaceList.emplace_back(iface);
+}
+
+int64_t PcapFileReader::toNanosecond(const Interface& iface, uint64_t ts) const
+{
+    int64_t ns = 0;
+    if (iface.binaryResolution)
+    {
+        const uint32_t bits = std::min(iface.resolution, (uint8_t)63);
+        const uint64_t sec = ts >> bits;
+        const uint64_t frac = ts & ((1ULL << bits) - 1);
+        const uint64_t fracNs = (bits <= 32) ? ((frac * NANOSECOND_PER_SECOND) >> bits)
+                                             : (((frac >> (bits - 32)) * NANOSECOND_PER_SECOND) >> 32); /* 避免乘法溢出 */
+        ns = (int64_t)(sec * NANOSECOND_PER_SECOND + fracNs);
+    }
+    else
+    {
+        uint64_t scale = 1;
+        for (uint32_t i = std::min(iface.resolution, (uint8_t)9); i < 9; ++i) /* 精度低于纳秒时放大 */
+        {
+            scale *= 10;
+        }
+        for (uint32_t i = 9; i < iface.resolution && i < 28; ++i) /* 精度高于纳秒时缩小(超过10^19后结果恒为0) */
+        {
+            scale = (scale > UINT64_MAX / 10) ? UINT64_MAX : scale * 10;
+        }
+        ns = (int64_t)((iface.resolution <= 9) ? (ts * scale) : (ts / scale));
+    }
+    return ns + iface.offset * NANOSECOND_PER_SECOND;
+}
+
+uint16_t PcapFileReader::read16(const uint8_t* p) const
+{
+    uint16_t v = 0;
+    memcpy(&v, p, 2);
+    return m_swapped ? swap16(v) : v;
+}
+
+uint32_t PcapFileReader::read32(const uint8_t* p) const
+{
+    uint32_t v = 0;
+    memcpy(&v, p, 4);
+    return m_swapped ? swap32(v) : v;
+}
+
+uint64_t PcapFileReader::read64(const uint8_t* p) const
+{
+    uint64_t v = 0;
+    memcpy(&v, p, 8);
+    return m_swapped ? swap64(v) : v;
+}
+
+PcapFileWriter::~PcapFileWriter()
+{
+    close();
+}
+
+bool PcapFileWriter::open(const PcapWriterConfig& cfg, std::string* errorDesc)
+{
+    close();
+    if (cfg.path.empty())
+    {
+        if (errorDesc)
+        {
+            *errorDesc = "path is empty";
+        }
+        return false;
+    }
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_cfg = cfg;
+    m_cfg.snapLen = (0 == m_cfg.snapLen) ? 65535 : std::min(m_cfg.snapLen, (uint32_t)(256 * 1024));
+    m_cfg.bufferSize = std::max(m_cfg.bufferSize, (size_t)(PCAP_RECORD_HEADER_LEN + m_cfg.snapLen));
+    m_cfg.bufferCount = std::max(m_cfg.bufferCount, (size_t)2);
+    m_cfg.flushInterval = std::max(m_cfg.flushInterval, (uint32_t)1);
+    m_bufferList.clear();
+    m_bufferList.resize(m_cfg.bufferCount);
+    m_freeList.clear();
+    for (size_t i = 0; i < m_bufferList.size(); ++i)
+    {
+        m_bufferList[i].data.reset(new uint8_t[m_cfg.bufferSize]); /* 不初始化, 首次写入时才分配物理内存 */
+        if (i > 0)
+        {
+            m_freeList.emplace_back(i);
+        }
+    }
+    m_fullList.clear();
+    m_current = 0;
+    m_writingCount = 0;
+    m_flushRequest = false;
+    m_fileBytes = 0;
+    m_fileStartTimestamp = 0;
+    m_fileIndex = 0;
+    m_fileList.clear();
+    m_packets = 0;
+    m_bytes = 0;
+    m_drops = 0;
+    m_files = 0;
+    m_errors = 0;
+    m_running = true;
+    m_thread = std::thread(&PcapFileWriter::run, this);
+    return true;
+}
+
+bool PcapFileWriter::write(const uint8_t* data, uint32_t dataLen, int64_t timestamp, uint32_t wireLen)
+{
+    if (!data || 0 == dataLen)
+    {
+        return false;
+    }
+    if (timestamp <= 0)
+    {
+        timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (!m_running)
+    {
+        return false;
+    }
+    const uint32_t capLen = std::min(dataLen, m_cfg.snapLen);
+    const size_t recordLen = PCAP_RECORD_HEADER_LEN + capLen;
+    /* 切换文件: 当前缓冲区写完后关闭文件, 新文件从下一个缓冲区开始 */
+    if (0 == m_fileBytes)
+    {
+        m_fileBytes = PCAP_FILE_HEADER_LEN;
+        m_fileStartTimestamp = timestamp;
+    }
+    else if ((m_cfg.maxFileSize > 0 && m_fileBytes + recordLen > m_cfg.maxFileSize)
+             || (m_cfg.maxFileDuration > 0 && timestamp - m_fileStartTimestamp >= (int64_t)m_cfg.maxFileDuration * NANOSECOND_PER_SECOND))
+    {
+        if (!submitCurrent(true))
+        {
+            ++m_drops;
+            return false;
+        }
+        m_fileBytes = PCAP_FILE_HEADER_LEN;
+        m_fileStartTimestamp = timestamp;
+    }
+    if (m_bufferList[m_current].len + recordLen > m_cfg.bufferSize && !submitCurrent(false))
+    {
+        ++m_drops;
+        return false;
+    }
+    auto& buf = m_bufferList[m_current];
+    if (0 == buf.len)
+    {
+        buf.firstTimestamp = timestamp;
+    }
+    const uint32_t frac = (uint32_t)(timestamp % NANOSECOND_PER_SECOND);
+    const uint32_t header[4] = {(uint32_t)(timestamp / NANOSECOND_PER_SECOND), m_cfg.nanosecond ? frac : frac / 1000, capLen,
+                                (0 == wireLen) ? dataLen : wireLen};
+    uint8_t* p = buf.data.get() + buf.len;
+    memcpy(p, header, sizeof(header));
+    memcpy(p + PCAP_RECORD_HEADER_LEN, data, capLen);
+    buf.len += recordLen;
+    m_fileBytes += recordLen;
+    ++m_packets;
+    return true;
+}
+
+void PcapFileWriter::flush()
+{
+    std::unique_lock<std::mutex> locker(m_mutex);
+    if (!m_running)
+    {
+        return;
+    }
+    m_flushRequest = true;
+    m_cvWrite.notify_one();
+    m_cvDone.wait(locker, [&]() { return !m_running || (!m_flushRequest && m_fullList.empty() && 0 == m_writingCount); });
+}
+
+void PcapFileWriter::close()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_running = false;
+    }
+    m_cvWrite.notify_one();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    m_cvDone.notify_all();
+}
+
+PcapWriterStat PcapFileWriter::getStat() const
+{
+    PcapWriterStat stat;
+    stat.packets = m_packets;
+    stat.bytes = m_bytes;
+    stat.drops = m_drops;
+    stat.files = m_files;
+    stat.errors = m_errors;
+    return stat;
+}
+
+bool PcapFileWriter::submitCurrent(bool rotate)
+{
+    if (m_freeList.empty())
+    {
+        return false;
+    }
+    m_bufferList[m_current].rotate = rotate;
+    m_fullList.emplace_back(m_current);
+    m_current = m_freeList.back();
+    m_freeList.pop_back();
+    m_bufferList[m_current].len = 0;
+    m_bufferList[m_current].rotate = false;
+    m_cvWrite.notify_one();
+    return true;
+}
+
+void PcapFileWriter::run()
+{
+    std::vector<size_t> indexList;
+    std::vector<Buffer*> bufferList;
+    while (true)
+    {
+        indexList.clear();
+        bufferList.clear();
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            const bool notified = m_cvWrite.wait_for(locker, std::chrono::milliseconds(m_cfg.flushInterval),
+                                                     [&]() { return !m_fullList.empty() || m_flushRequest || !m_running; });
+            if (!notified || m_flushRequest || !m_running) /* 超时/请求写入/停止: 未写满的缓冲区也提交 */
+            {
+                if (m_bufferList[m_current].len > 0)
+                {
+                    submitCurrent(false);
+                }
+                if (0 == m_bufferList[m_current].len) /* 没有空闲缓冲区时, 等待本轮写完后再提交 */
+                {
+                    m_flushRequest = false;
+                }
+            }
+            while (!m_fullList.empty())
+            {
+                indexList.emplace_back(m_fullList.front());
+                bufferList.emplace_back(&m_bufferList[m_fullList.front()]);
+                m_fullList.pop_front();
+            }
+            if (indexList.empty())
+            {
+                m_cvDone.notify_all();
+                if (!m_running)
+                {
+                    break;
+                }
+                continue;
+            }
+            m_writingCount = indexList.size();
+        }
+        writeBuffers(bufferList); /* 写磁盘时不持有锁, 生产者继续填充其他缓冲区 */
+        {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_freeList.insert(m_freeList.end(), indexList.begin(), indexList.end());
+            m_writingCount = 0;
+        }
+        m_cvDone.notify_all();
+    }
+    closeFile();
+}
+
+void PcapFileWriter::writeBuffers(const std::vector<Buffer*>& bufferList)
+{
+    std::vector<std::pair<const uint8_t*, size_t>> blockList;
+    for (auto buf : bufferList)
+    {
+        if (buf->len > 0)
+        {
+            if (m_fd < 0 && !openFile(buf->firstTimestamp))
+            {
+                ++m_errors; /* 创建文件失败, 丢弃该缓冲区 */
+            }
+            else
+            {
+                blockList.emplace_back(buf->data.get(), buf->len);
+            }
+        }
+        if (buf->rotate)
+        {
+            writeAll(blockList);
+            blockList.clear();
+            closeFile();
+        }
+    }
+    writeAll(blockList);
+}
+
+bool PcapFileWriter::openFile(int64_t timestamp)
+{
+    const time_t sec = (time_t)(timestamp / NANOSECOND_PER_SECOND);
+    struct tm t;
+#ifdef _WIN32
+    localtime_s(&t, &sec);
+#else
+    localtime_r(&sec, &t);
+#endif
+    char suffix[64] = {0};
+    snprintf(suffix, sizeof(suffix), "_%04d%02d%02d_%02d%02d%02d_%05u.pcap", t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour,
+             t.tm_min, t.tm_sec, ++m_fileIndex);
+    const std::string filename = m_cfg.path + suffix;
+#ifdef _WIN32
+    m_fd = _open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+    if (m_fd < 0)
+    {
+        return false;
+    }
+    /* 文件头: 魔数(4) + 主版本(2) + 次版本(2) + 时区(4) + 精度(4) + 快照长度(4) + 链路类型(4), 使用本机字节序 */
+    uint8_t header[PCAP_FILE_HEADER_LEN] = {0};
+    const uint32_t magic = m_cfg.nanosecond ? PCAP_MAGIC_NS : PCAP_MAGIC_US;
+    const uint16_t versionMajor = 2, versionMinor = 4;
+    memcpy(header, &magic, 4);
+    memcpy(header + 4, &versionMajor, 2);
+    memcpy(header + 6, &versionMinor, 2);
+    memcpy(header + 16, &m_cfg.snapLen, 4);
+    memcpy(header + 20, &m_cfg.linkType, 4);
+    ++m_files;
+    m_fileList.emplace_back(filename);
+    if (m_cfg.maxFileCount > 0)
+    {
+        while (m_fileList.size() > m_cfg.maxFileCount)
+        {
+            ::remove(m_fileList.front().c_str());
+            m_fileList.pop_front();
+        }
+    }
+    if (!writeAll({std::make_pair((const uint8_t*)header, sizeof(header))}))
+    {
+        closeFile();
+        return false;
+    }
+    return true;
+}
+
+void PcapFileWriter::closeFile()
+{
+    if (m_fd >= 0)
+    {
+#ifdef _WIN32
+        _close(m_fd);
+#else
+        ::close(m_fd);
+#endif
+        m_fd = -1;
+    }
+}
+
+bool PcapFileWriter::writeAll(const std::vector<std::pair<const uint8_t*, size_t>>& blockList)
+{
+    if (m_fd < 0 || blockList.empty())
+    {
+        return false;
+    }
+#ifdef _WIN32
+    for (const auto& block : blockList)
+    {
+        size_t pos = 0;
+        while (pos < block.second)
+        {
+            const int n = _write(m_fd, block.first + pos, (unsigned int)std::min(block.second - pos, (size_t)(1024 * 1024 * 1024)));
+            if (n <= 0)
+            {
+                ++m_errors;
+                return false;
+            }
+            pos += (size_t)n;
+            m_bytes += (uint64_t)n;
+        }
+    }
+#else
+    static const size_t MAX_IOV_COUNT = 64;
+    struct iovec iov[MAX_IOV_COUNT];
+    size_t index = 0;
+    while (index < blockList.size())
+    {
+        /* 一次系统调用提交多个缓冲区 */
+        size_t count = 0;
+        for (; count < MAX_IOV_COUNT && index + count < blockList.size(); ++count)
+        {
+            iov[count].iov_base = (void*)blockList[index + count].first;
+            iov[count].iov_len = blockList[index + count].second;
+        }
+        index += count;
+        struct iovec* cur = iov;
+        while (count > 0)
+        {
+            const ssize_t n = writev(m_fd, cur, (int)count);
+            if (n < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                ++m_errors;
+                return false;
+            }
+            m_bytes += (uint64_t)n;
+            size_t left = (size_t)n;
+            while (count > 0 && left >= cur->iov_len) /* 处理部分写入 */
+            {
+                left -= cur->iov_len;
+                ++cur;
+                --count;
+            }
+            if (count > 0)
+            {
+                cur->iov_base = (uint8_t*)cur->iov_base + left;
+                cur->iov_len -= left;
+            }
+        }
+    }
+#endif
+    return true;
+}
+} // namespace npacket
@@ -0,0 +1,322 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace npacket
+{
+/**
+ * @brief 抓包文件格式
+ */
+enum class PcapFileFormat
+{
+    PCAP = 0, /* 经典pcap格式(微秒或纳秒精度) */
+    PCAPNG /* pcapng格式 */
+};
+
+/**
+ * @brief 抓包文件中的数据包
+ */
+struct PcapFilePacket
+{
+    const uint8_t* data = nullptr; /* 数据(指向文件映射内存, 文件关闭前有效) */
+    uint32_t capLen = 0; /* 捕获长度 */
+    uint32_t wireLen = 0; /* 原始长度 */
+    int64_t timestamp = 0; /* 时间戳(纳秒, 自1970-01-01 00:00:00 UTC) */
+    uint32_t linkType = 0; /* 链路类型(1-以太网) */
+    uint32_t interfaceId = 0; /* 接口序号(只有pcapng有效) */
+};
+
+/**
+ * @brief 抓包文件读取器(支持pcap和pcapng格式), 整个文件映射到内存, 数据包直接引用映射内存(零拷贝)
+ */
+class PcapFileReader final
+{
+public:
+    /**
+     * @brief 回放回调
+     * @param pkt 数据包
+     * @param ntp 数据包接收时间点(按原始时间戳间隔映射到steady_clock, 可直接传给Analyzer::parse)
+     * @return true-继续, false-停止回放
+     */
+    using REPLAY_CALLBACK = std::function<bool(const PcapFilePacket& pkt, const std::chrono::steady_clock::time_point& ntp)>;
+
+public:
+    ~PcapFileReader();
+
+    /**
+     * @brief 打开
+     * @param filename 文件名
+     * @param errorDesc [输出]错误描述
+     * @return true-成功, false-失败
+     */
+    bool open(const std::string& filename, std::string* errorDesc = nullptr);
+
+    /**
+     * @brief 关闭
+     */
+    void close();
+
+    /**
+     * @brief 是否已打开
+     * @return true-是, false-否
+     */
+    bool isOpened() const;
+
+    /**
+     * @brief 获取文件格式
+     * @return 文件格式
+     */
+    PcapFileFormat getFormat() const;
+
+    /**
+     * @brief 获取文件大小
+     * @return 文件大小(字节)
+     */
+    uint64_t getFileSize() const;
+
+    /**
+     * @brief 读取下一个数据包
+     * @param pkt [输出]数据包
+     * @return true-成功, false-没有更多数据包(文件结束或者文件损坏/截断)
+     */
+    bool next(PcapFilePacket& pkt);
+
+    /**
+     * @brief 回到第一个数据包
+     */
+    void rewind();
+
+    /**
+     * @brief 文件是否损坏或被截断(读取结束后判断)
+     * @return true-是, false-否
+     */
+    bool isTruncated() const;
+
+    /**
+     * @brief 回放(从当前位置开始), 第1个数据包映射为当前时间点, 后续数据包按原始时间戳间隔递增
+     * @param callback 回放回调
+     * @param speed 回放速度, <=0表示全速(不等待), 1表示按原始速率, 2表示2倍速, 以此类推
+     * @return 回放的数据包数量
+     */
+    size_t replay(const REPLAY_CALLBACK& callback, double speed = 0);
+
+private:
+    /**
+     * @brief pcapng接口信息
+     */
+    struct Interface
+    {
+        uint32_t linkType = 0; /* 链路类型 */
+        bool binaryResolution = false; /* 时间戳精度是否为2的负幂 */
+        uint8_t resolution = 6; /* 时间戳精度(10或2的负幂), 默认微秒 */
+        int64_t offset = 0; /* 时间戳偏移(秒) */
+    };
+
+    /**
+     * @brief 解析文件头
+     */
+    bool parseFileHeader(std::string* errorDesc);
+
+    /**
+     * @brief 读取下一个pcap数据包
+     */
+    bool nextPcap(PcapFilePacket& pkt);
+
+    /**
+     * @brief 读取下一个pcapng数据包
+     */
+    bool nextPcapng(PcapFilePacket& pkt);
+
+    /**
+     * @brief 解析pcapng段头块
+     */
+    bool parseSectionHeader(const uint8_t* block, uint32_t blockLen);
+
+    /**
+     * @brief 解析pcapng接口描述块
+     */
+    void parseInterface(const uint8_t* block, uint32_t blockLen);
+
+    /**
+     * @brief pcapng时间戳转换为纳秒
+     */
+    int64_t toNanosecond(const Interface& iface, uint64_t ts) const;
+
+    /**
+     * @brief 按文件字节序读取
+     */
+    uint16_t read16(const uint8_t* p) const;
+
+    uint32_t read32(const uint8_t* p) const;
+
+    uint64_t read64(const uint8_t* p) const;
+
+private:
+    const uint8_t* m_data = nullptr; /* 文件映射内存 */
+    uint64_t m_fileSize = 0; /* 文件大小 */
+#ifdef _WIN32
+    void* m_file = nullptr; /* 文件句柄 */
+    void* m_mapping = nullptr; /* 映射句柄 */
+#endif
+    PcapFileFormat m_format = PcapFileFormat::PCAP; /* 文件格式 */
+    bool m_swapped = false; /* 字节序是否与本机相反 */
+    bool m_nanosecond = false; /* pcap时间戳是否为纳秒精度 */
+    uint32_t m_linkType = 0; /* pcap链路类型 */
+    uint64_t m_firstOffset = 0; /* 第一个数据包(块)的偏移 */
+    uint64_t m_offset = 0; /* 当前读取偏移 */
+    bool m_truncated = false; /* 文件是否损坏或被截断 */
+    std::vector<Interface> m_interfaceList; /* pcapng当前段的接口列表 */
+};
+
+/**
+ * @brief 抓包文件写入配置
+ */
+struct PcapWriterConfig
+{
+    std::string path; /* 文件路径前缀, 例如: /data/eth0, 生成的文件名为: /data/eth0_20240101_120000_00001.pcap */
+    uint64_t maxFileSize = 0; /* 单个文件最大大小(字节), 超出时切换到新文件, 0表示不限制 */
+    uint32_t maxFileDuration = 0; /* 单个文件最长时间(秒, 按数据包时间戳计算), 超出时切换到新文件, 0表示不限制 */
+    size_t maxFileCount = 0; /* 最多保留的文件数量(超出时删除最早写入的文件), 0表示不限制 */
+    uint32_t snapLen = 65535; /* 快照长度, 超出部分截断 */
+    uint32_t linkType = 1; /* 链路类型(1-以太网) */
+    bool nanosecond = true; /* 是否使用纳秒精度的时间戳 */
+    size_t bufferSize = (4 * 1024 * 1024); /* 单个缓冲区大小(字节) */
+    size_t bufferCount = 16; /* 缓冲区数量, 所有缓冲区都在等待写入磁盘时, 新的数据包会被丢弃 */
+    uint32_t flushInterval = 1000; /* 缓冲区未满时写入磁盘的间隔(毫秒) */
+};
+
+/**
+ * @brief 抓包文件写入统计
+ */
+struct PcapWriterStat
+{
+    uint64_t packets = 0; /* 写入的数据包数量 */
+    uint64_t bytes = 0; /* 写入磁盘的字节数(包含文件头和记录头) */
+    uint64_t drops = 0; /* 缓冲区不足丢弃的数据包数量 */
+    uint64_t files = 0; /* 创建的文件数量 */
+    uint64_t errors = 0; /* 写磁盘失败的次数 */
+};
+
+/**
+ * @brief 抓包文件写入器(pcap格式), 写入接口只把数据包拷贝到内存缓冲区, 写满的缓冲区由后台线程批量(writev)写入磁盘,
+ *        支持按大小/时间切换文件, 写入接口可以多线程调用
+ */
+class PcapFileWriter final
+{
+public:
+    ~PcapFileWriter();
+
+    /**
+     * @brief 打开(启动写线程)
+     * @param cfg 配置
+     * @param errorDesc [输出]错误描述
+     * @return true-成功, false-失败
+     */
+    bool open(const PcapWriterConfig& cfg, std::string* errorDesc = nullptr);
+
+    /**
+     * @brief 写入数据包
+     * @param data 数据
+     * @param dataLen 数据长度
+     * @param timestamp 时间戳(纳秒, 自1970-01-01 00:00:00 UTC), <=0表示使用当前时间
+     * @param wireLen 原始长度, 0表示与数据长度相同
+     * @return true-成功, false-失败(未打开或者缓冲区不足丢弃)
+     */
+    bool write(const uint8_t* data, uint32_t dataLen, int64_t timestamp = 0, uint32_t wireLen = 0);
+
+    /**
+     * @brief 把所有缓冲的数据写入磁盘(阻塞直到写完)
+     */
+    void flush();
+
+    /**
+     * @brief 关闭(写完剩余数据后停止写线程)
+     */
+    void close();
+
+    /**
+     * @brief 获取统计
+     * @return 统计
+     */
+    PcapWriterStat getStat() const;
+
+private:
+    /**
+     * @brief 缓冲区
+     */
+    struct Buffer
+    {
+        std::unique_ptr<uint8_t[]> data; /* 数据 */
+        size_t len = 0; /* 已使用长度 */
+        int64_t firstTimestamp = 0; /* 第一个数据包的时间戳(用于生成文件名) */
+        bool rotate = false; /* 写完该缓冲区后是否切换文件 */
+    };
+
+    /**
+     * @brief 把当前缓冲区提交给写线程(调用前需要持有锁)
+     * @param rotate 写完后是否切换文件
+     * @return true-成功, false-没有空闲缓冲区
+     */
+    bool submitCurrent(bool rotate);
+
+    /**
+     * @brief 写线程
+     */
+    void run();
+
+    /**
+     * @brief 批量写入缓冲区
+     */
+    void writeBuffers(const std::vector<Buffer*>& bufferList);
+
+    /**
+     * @brief 创建新文件
+     */
+    bool openFile(int64_t timestamp);
+
+    /**
+     * @brief 关闭当前文件
+     */
+    void closeFile();
+
+    /**
+     * @brief 写入磁盘(处理部分写入)
+     */
+    bool writeAll(const std::vector<std::pair<const uint8_t*, size_t>>& blockList);
+
+private:
+    PcapWriterConfig m_cfg; /* 配置 */
+    std::vector<Buffer> m_bufferList; /* 缓冲区 */
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvWrite; /* 通知写线程 */
+    std::condition_variable m_cvDone; /* 通知缓冲区已写完 */
+    std::deque<size_t> m_fullList; /* 等待写入的缓冲区 */
+    std::vector<size_t> m_freeList; /* 空闲的缓冲区 */
+    size_t m_current = 0; /* 当前正在填充的缓冲区 */
+    size_t m_writingCount = 0; /* 写线程正在写的缓冲区数量 */
+    bool m_running = false; /* 是否运行中 */
+    bool m_flushRequest = false; /* 是否请求立即写入 */
+    uint64_t m_fileBytes = 0; /* 当前文件已分配的字节数(生产者视角) */
+    int64_t m_fileStartTimestamp = 0; /* 当前文件第一个数据包的时间戳 */
+    std::thread m_thread; /* 写线程 */
+
+    int m_fd = -1; /* 当前文件描述符(只在写线程中访问) */
+    uint32_t m_fileIndex = 0; /* 文件序号 */
+    std::deque<std::string> m_fileList; /* 已创建的文件(用于限制数量) */
+
+    std::atomic<uint64_t> m_packets = {0};
+    std::atomic<uint64_t> m_bytes = {0};
+    std::atomic<uint64_t> m_drops = {0};
+    std::atomic<uint64_t> m_files = {0};
+    std::atomic<uint64_t> m_errors = {0};
+};
+} // namespace npacket
@@ -237,6 +237,44 @@ ParseResult FtpParser::parse(const ProtocolData& pd, uint32_t& consumeLen)
     return ParseResult::FAILURE;
 }
 
+void FtpParser::onFlowEnd(const std::chrono::steady_clock::time_point& ntp, const TcpStreamKey& key, FlowEndReason reason)
+{
+    IpPortKey srcKey, dstKey;
+    if (4 == key.ipVersion)
+    {
+        srcKey = IpPortKey::createIpv4((const uint8_t*)&key.v4.srcIp, key.v4.srcPort);
+        dstKey = IpPortKey::createIpv4((const uint8_t*)&key.v4.dstIp, key.v4.dstPort);
+    }
+    else if (6 == key.ipVersion)
+    {
+        srcKey = IpPortKey::createIpv6((const uint8_t*)key.v6.srcIp, key.v6.srcPort);
+        dstKey = IpPortKey::createIpv6((const uint8_t*)key.v6.dstIp, key.v6.dstPort);
+    }
+    else
+    {
+        return;
+    }
+    auto iter = m_dataConnectList.find(srcKey);
+    if (m_dataConnectList.end() == iter)
+    {
+        iter = m_dataConnectList.find(dstKey);
+        if (m_dataConnectList.end() == iter)
+        {
+            return;
+        }
+    }
+    if (DataConnectStatus::CREATED != iter->second->status) /* 未建立的数据连接, 结束的是之前复用该端口的连接, 不处理 */
+    {
+        return;
+    }
+    auto ctrl = iter->second->ctrl;
+    m_dataConnectList.erase(iter);
+    if (m_dataCb)
+    {
+        m_dataCb(ntp, 0, nullptr, ctrl, FlowEndReason::FIN == reason ? DataFlag::FINISH : DataFlag::ABNORMAL, nullptr, 0);
+    }
+}
+
 void FtpParser::setRequestCallback(const CTRL_PKT_CALLBACK& callback)
 {
     m_requestCb = callback;
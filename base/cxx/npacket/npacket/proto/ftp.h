@@ -95,6 +95,14 @@ public:
      */
     ParseResult parse(const ProtocolData& pd, uint32_t& consumeLen) override;
 
+    /**
+     * @brief TCP流结束通知(已建立的数据连接结束时立即回收, 不再等待超时)
+     * @param ntp 当前时间点
+     * @param key TCP流键
+     * @param reason 结束原因
+     */
+    void onFlowEnd(const std::chrono::steady_clock::time_point& ntp, const TcpStreamKey& key, FlowEndReason reason) override;
+
     /**
      * @brief 设置请求包回调
      * @param callback 回调
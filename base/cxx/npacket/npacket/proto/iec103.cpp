@@ -1,10 +1,30 @@
 #include "iec103.h"
 
+#include <atomic>
 #include <math.h>
 #include <string.h>
 
 namespace npacket
 {
+/**
+ * @brief 通用分类标识数据集列表的最大缓存数量
+ */
+static const size_t MAX_GID_LIST_POOL_SIZE = 64;
+
+/**
+ * @brief 重置对象为默认值, 但保留列表成员已分配的内存
+ * @param obj 对象
+ * @param list 列表成员
+ */
+template<typename T, typename L>
+static void resetKeepList(T& obj, L T::*list)
+{
+    L keep = std::move(obj.*list);
+    keep.clear();
+    obj = T();
+    obj.*list = std::move(keep);
+}
+
 /**
  * 控制域
  * 1. 主站 -> 从站, 控制方向
@@ -66,6 +86,12 @@ uint32_t Iec103Parser::getProtocol() const noexcept
     return ApplicationProtocol::IEC103;
 }
 
+std::vector<ProtocolSignature> Iec103Parser::getSignatures() const
+{
+    return {ProtocolSignature(0, {0x10}), /* 固定长度帧: 启动字符0x10 */
+            ProtocolSignature(0, {0x68, 0x00, 0x00, 0x68}, {0xFF, 0x00, 0x00, 0xFF})}; /* 可变长度帧: 0x68 L L 0x68 */
+}
+
 ParseResult Iec103Parser::parse(const ProtocolData& pd, uint32_t& consumeLen)
 {
     consumeLen = 0;
@@ -142,7 +168,7 @@ bool Iec103Parser::parseFixedFrame(const std::chrono::steady_clock::time_point&
             uint8_t fcb_acd = (ctrl & 0x20) >> 5;
             uint8_t fcv_dfc = (ctrl & 0x10) >> 4;
             uint8_t func = (ctrl & 0xF);
-            auto frame = std::make_shared<iec103::FixedFrame>();
+            auto frame = acquireObject<iec103::FixedFrame>(m_fixedFrame);
             frame->prm = prm;
             frame->fcb_acd = fcb_acd;
             frame->fcv_dfc = fcv_dfc;
@@ -222,7 +248,7 @@ bool Iec103Parser::parseVariableFrame(const std::chrono::steady_clock::time_poin
                 uint8_t fcb_acd = (ctrl & 0x20) >> 5;
                 uint8_t fcv_dfc = (ctrl & 0x10) >> 4;
                 uint8_t func = (ctrl & 0xF);
-                auto frame = std::make_shared<iec103::VariableFrame>();
+                auto frame = acquireObject<iec103::VariableFrame>(m_variableFrame); /* 先重置帧(释放上一帧的ASDU), ASDU才能被复用 */
                 frame->prm = prm;
                 frame->fcb_acd = fcb_acd;
                 frame->fcv_dfc = fcv_dfc;
@@ -253,7 +279,7 @@ std::shared_ptr<iec103::Asdu> Iec103Parser::parseAsdu(const uint8_t* data, uint3
     auto asdu = parseInfoSet(identify, data + 4, dataLen - 4);
     if (!asdu)
     {
-        asdu = std::make_shared<iec103::Asdu>();
+        asdu = acquireObject<iec103::Asdu>(m_asduPool[0]);
     }
     asdu->identify = identify;
     return asdu;
@@ -331,7 +357,7 @@ std::shared_ptr<iec103::Asdu1> Iec103Parser::parseAsud1(const iec103::DataUnitId
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu1>();
+        auto asdu = acquireObject<iec103::Asdu1>(m_asduPool[1]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -365,7 +391,7 @@ std::shared_ptr<iec103::Asdu2> Iec103Parser::parseAsud2(const iec103::DataUnitId
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu2>();
+        auto asdu = acquireObject<iec103::Asdu2>(m_asduPool[2]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -411,7 +437,7 @@ std::shared_ptr<iec103::Asdu3> Iec103Parser::parseAsud3(const iec103::DataUnitId
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu3>();
+        auto asdu = acquireObject<iec103::Asdu3>(m_asduPool[3]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         for (uint8_t i = 0; i < identify.vsq.num; ++i)
@@ -436,7 +462,7 @@ std::shared_ptr<iec103::Asdu4> Iec103Parser::parseAsud4(const iec103::DataUnitId
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu4>();
+        auto asdu = acquireObject<iec103::Asdu4>(m_asduPool[4]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -476,7 +502,7 @@ std::shared_ptr<iec103::Asdu5> Iec103Parser::parseAsud5(const iec103::DataUnitId
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu5>();
+        auto asdu = acquireObject<iec103::Asdu5>(m_asduPool[5]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -515,7 +541,7 @@ std::shared_ptr<iec103::Asdu6> Iec103Parser::parseAsud6(const iec103::DataUnitId
     int32_t offset = 2;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu6>();
+        auto asdu = acquireObject<iec103::Asdu6>(m_asduPool[6]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         if (getCP56Time2a(elements + offset, elementLen - offset, asdu->tm) > 0)
@@ -532,7 +558,7 @@ std::shared_ptr<iec103::Asdu7> Iec103Parser::parseAsud7(const iec103::DataUnitId
     int32_t offset = 2;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu7>();
+        auto asdu = acquireObject<iec103::Asdu7>(m_asduPool[7]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         if (getScn(elements + offset, elementLen - offset, asdu->scn) > 0)
@@ -549,7 +575,7 @@ std::shared_ptr<iec103::Asdu8> Iec103Parser::parseAsud8(const iec103::DataUnitId
     int32_t offset = 2;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu8>();
+        auto asdu = acquireObject<iec103::Asdu8>(m_asduPool[8]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         if (getScn(elements + offset, elementLen - offset, asdu->scn) > 0)
@@ -566,7 +592,7 @@ std::shared_ptr<iec103::Asdu9> Iec103Parser::parseAsud9(const iec103::DataUnitId
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu9>();
+        auto asdu = acquireObject<iec103::Asdu9>(m_asduPool[9]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         for (uint8_t i = 0; i < identify.vsq.num; ++i)
@@ -591,7 +617,7 @@ std::shared_ptr<iec103::Asdu10> Iec103Parser::parseAsud10(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu10>();
+        auto asdu = acquireObject<iec103::Asdu10>(m_asduPool[10]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -610,7 +636,9 @@ std::shared_ptr<iec103::Asdu10> Iec103Parser::parseAsud10(const iec103::DataUnit
             offset += count;
             for (uint8_t i = 0; i < asdu->ngd.no; ++i)
             {
-                iec103::DataSet10 dataSet10;
+                asdu->dataSet.emplace_back();
+                auto& dataSet10 = asdu->dataSet.back();
+                dataSet10.gidList = takeGidList();
                 count = getGin(elements + offset, elementLen - offset, dataSet10.gin);
                 if (count <= 0)
                 {
@@ -640,7 +668,6 @@ std::shared_ptr<iec103::Asdu10> Iec103Parser::parseAsud10(const iec103::DataUnit
                     offset += count;
                     dataSet10.gidList.emplace_back(gid);
                 }
-                asdu->dataSet.emplace_back(dataSet10);
             }
             return asdu;
         } while (0);
@@ -654,7 +681,7 @@ std::shared_ptr<iec103::Asdu11> Iec103Parser::parseAsud11(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu11>();
+        auto asdu = acquireObject<iec103::Asdu11>(m_asduPool[11]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -679,7 +706,9 @@ std::shared_ptr<iec103::Asdu11> Iec103Parser::parseAsud11(const iec103::DataUnit
             offset += count;
             for (uint8_t i = 0; i < asdu->nde.no; ++i)
             {
-                iec103::DataSet11 dataSet11;
+                asdu->dataSet.emplace_back();
+                auto& dataSet11 = asdu->dataSet.back();
+                dataSet11.gidList = takeGidList();
                 count = getKod(elements + offset, elementLen - offset, dataSet11.kod);
                 if (count <= 0)
                 {
@@ -703,7 +732,6 @@ std::shared_ptr<iec103::Asdu11> Iec103Parser::parseAsud11(const iec103::DataUnit
                     offset += count;
                     dataSet11.gidList.emplace_back(gid);
                 }
-                asdu->dataSet.emplace_back(dataSet11);
             }
             return asdu;
         } while (0);
@@ -717,7 +745,7 @@ std::shared_ptr<iec103::Asdu20> Iec103Parser::parseAsud20(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu20>();
+        auto asdu = acquireObject<iec103::Asdu20>(m_asduPool[20]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -745,7 +773,7 @@ std::shared_ptr<iec103::Asdu21> Iec103Parser::parseAsud21(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu21>();
+        auto asdu = acquireObject<iec103::Asdu21>(m_asduPool[21]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -790,7 +818,7 @@ std::shared_ptr<iec103::Asdu23> Iec103Parser::parseAsud23(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu23>();
+        auto asdu = acquireObject<iec103::Asdu23>(m_asduPool[23]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         for (uint8_t i = 0; i < identify.vsq.num; ++i)
@@ -827,7 +855,7 @@ std::shared_ptr<iec103::Asdu24> Iec103Parser::parseAsud24(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu24>();
+        auto asdu = acquireObject<iec103::Asdu24>(m_asduPool[24]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         do
@@ -867,7 +895,7 @@ std::shared_ptr<iec103::Asdu25> Iec103Parser::parseAsud25(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu25>();
+        auto asdu = acquireObject<iec103::Asdu25>(m_asduPool[25]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         do
@@ -907,7 +935,7 @@ std::shared_ptr<iec103::Asdu26> Iec103Parser::parseAsud26(const iec103::DataUnit
     int32_t offset = 3, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu26>();
+        auto asdu = acquireObject<iec103::Asdu26>(m_asduPool[26]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         asdu->__ = elements[2];
@@ -966,7 +994,7 @@ std::shared_ptr<iec103::Asdu27> Iec103Parser::parseAsud27(const iec103::DataUnit
     int32_t offset = 3, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu27>();
+        auto asdu = acquireObject<iec103::Asdu27>(m_asduPool[27]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         asdu->__ = elements[2];
@@ -1019,7 +1047,7 @@ std::shared_ptr<iec103::Asdu28> Iec103Parser::parseAsud28(const iec103::DataUnit
     int32_t offset = 4;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu28>();
+        auto asdu = acquireObject<iec103::Asdu28>(m_asduPool[28]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         asdu->__ = elements[2];
@@ -1038,7 +1066,7 @@ std::shared_ptr<iec103::Asdu29> Iec103Parser::parseAsud29(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu29>();
+        auto asdu = acquireObject<iec103::Asdu29>(m_asduPool[29]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         do
@@ -1091,7 +1119,7 @@ std::shared_ptr<iec103::Asdu30> Iec103Parser::parseAsud30(const iec103::DataUnit
     int32_t offset = 3, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu30>();
+        auto asdu = acquireObject<iec103::Asdu30>(m_asduPool[30]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         asdu->__ = elements[2];
@@ -1150,7 +1178,7 @@ std::shared_ptr<iec103::Asdu31> Iec103Parser::parseAsud31(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu31>();
+        auto asdu = acquireObject<iec103::Asdu31>(m_asduPool[31]);
         asdu->func = elements[0];
         asdu->_ = elements[1];
         do
@@ -1190,7 +1218,7 @@ std::shared_ptr<iec103::Asdu38> Iec103Parser::parseAsud38(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu38>();
+        auto asdu = acquireObject<iec103::Asdu38>(m_asduPool[38]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -1218,7 +1246,7 @@ std::shared_ptr<iec103::Asdu42> Iec103Parser::parseAsud42(const iec103::DataUnit
     int32_t offset = 2, count = 0;
     if (elementLen >= offset)
     {
-        auto asdu = std::make_shared<iec103::Asdu42>();
+        auto asdu = acquireObject<iec103::Asdu42>(m_asduPool[42]);
         asdu->func = elements[0];
         asdu->inf = elements[1];
         do
@@ -1972,4 +2000,97 @@ int Iec103Parser::getQds(const uint8_t* data, uint32_t dataLen, iec103::QDS& val
     }
     return -1;
 }
+
+template<typename T, typename B>
+std::shared_ptr<T> Iec103Parser::acquireObject(std::shared_ptr<B>& slot)
+{
+    if (slot && 1 == slot.use_count()) /* 上次回调后没有被保留, 重置后复用 */
+    {
+        std::atomic_thread_fence(std::memory_order_acquire); /* 保留者可能在其他线程释放, 保证其访问先于重置 */
+        auto obj = std::static_pointer_cast<T>(slot);
+        resetObject(*obj);
+        return obj;
+    }
+    auto obj = std::make_shared<T>(); /* 首次使用或者已被保留(归保留者所有) */
+    slot = obj;
+    return obj;
+}
+
+template<typename T>
+void Iec103Parser::resetObject(T& obj)
+{
+    obj = T();
+}
+
+void Iec103Parser::resetObject(iec103::Asdu3& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu3::meaList);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu9& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu9::meaList);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu10& asdu)
+{
+    for (auto& dataSet : asdu.dataSet) /* 数据集中的列表放回缓存, 下次解析时取出 */
+    {
+        if (dataSet.gidList.capacity() > 0 && m_gidListPool.size() < MAX_GID_LIST_POOL_SIZE)
+        {
+            dataSet.gidList.clear();
+            m_gidListPool.emplace_back(std::move(dataSet.gidList));
+        }
+    }
+    resetKeepList(asdu, &iec103::Asdu10::dataSet);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu11& asdu)
+{
+    for (auto& dataSet : asdu.dataSet) /* 数据集中的列表放回缓存, 下次解析时取出 */
+    {
+        if (dataSet.gidList.capacity() > 0 && m_gidListPool.size() < MAX_GID_LIST_POOL_SIZE)
+        {
+            dataSet.gidList.clear();
+            m_gidListPool.emplace_back(std::move(dataSet.gidList));
+        }
+    }
+    resetKeepList(asdu, &iec103::Asdu11::dataSet);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu21& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu21::dataSet);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu23& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu23::dataSet);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu29& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu29::dataSet);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu30& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu30::sdvList);
+}
+
+void Iec103Parser::resetObject(iec103::Asdu42& asdu)
+{
+    resetKeepList(asdu, &iec103::Asdu42::dpiList);
+}
+
+std::vector<iec103::GID> Iec103Parser::takeGidList()
+{
+    std::vector<iec103::GID> gidList;
+    if (!m_gidListPool.empty())
+    {
+        gidList = std::move(m_gidListPool.back());
+        m_gidListPool.pop_back();
+    }
+    return gidList;
+}
 } // namespace npacket
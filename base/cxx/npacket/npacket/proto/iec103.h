@@ -59,6 +59,8 @@ namespace npacket
 
 /**
  * @brief IEC103协议解析器
+ *        回调中的帧和应用服务数据单元由解析器复用(避免逐帧分配内存): 回调返回后, 如果没有保留(拷贝)帧或ASDU的shared_ptr,
+ *        下一个同类帧会重置并复用该对象; 被保留的对象不再复用, 归保留者所有, 可以长期持有
  */
 class Iec103Parser : public ProtocolParser
 {
@@ -68,7 +70,7 @@ public:
      * @param ntp 数据包接收时间点
      * @param totalLen 数据包总长度
      * @param header 传输层头部(当数据走的是非网络时, 为空)
-     * @param frame 固定帧数据
+     * @param frame 固定帧数据(需要在回调之后使用时, 保留shared_ptr即可)
      */
     using FIXED_FRAME_CALLBACK = std::function<void(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
                                                     const ProtocolHeader* header, const std::shared_ptr<iec103::FixedFrame>& frame)>;
@@ -78,7 +80,7 @@ public:
      * @param ntp 数据包接收时间点
      * @param totalLen 数据包总长度
      * @param header 传输层头部(当数据走的是非网络时, 为空)
-     * @param frame 可变帧数据
+     * @param frame 可变帧数据(需要在回调之后使用时, 保留帧或ASDU的shared_ptr即可)
      */
     using VARIABLE_FRAME_CALLBACK = std::function<void(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
                                                        const ProtocolHeader* header, const std::shared_ptr<iec103::VariableFrame>& frame)>;
@@ -90,6 +92,12 @@ public:
      */
     uint32_t getProtocol() const noexcept override;
 
+    /**
+     * @brief 获取协议特征
+     * @return 特征列表
+     */
+    std::vector<ProtocolSignature> getSignatures() const override;
+
     /**
      * @brief 解析
      * @param pd 协议数据
@@ -215,8 +223,40 @@ private:
     int getVti(const uint8_t* data, uint32_t dataLen, iec103::VTI& val);
     int getQds(const uint8_t* data, uint32_t dataLen, iec103::QDS& val);
 
+    /**
+     * @brief 获取复用对象: 对象只被解析器持有(上次回调后没有被保留)时重置后复用, 否则新建对象放入复用槽位
+     * @param slot 复用槽位
+     * @return 对象
+     */
+    template<typename T, typename B>
+    std::shared_ptr<T> acquireObject(std::shared_ptr<B>& slot);
+
+    /**
+     * @brief 重置对象(列表成员保留已分配的内存)
+     */
+    template<typename T>
+    void resetObject(T& obj);
+    void resetObject(iec103::Asdu3& asdu);
+    void resetObject(iec103::Asdu9& asdu);
+    void resetObject(iec103::Asdu10& asdu);
+    void resetObject(iec103::Asdu11& asdu);
+    void resetObject(iec103::Asdu21& asdu);
+    void resetObject(iec103::Asdu23& asdu);
+    void resetObject(iec103::Asdu29& asdu);
+    void resetObject(iec103::Asdu30& asdu);
+    void resetObject(iec103::Asdu42& asdu);
+
+    /**
+     * @brief 从缓存中取出通用分类标识数据集列表(已清空, 保留已分配的内存)
+     */
+    std::vector<iec103::GID> takeGidList();
+
 private:
     FIXED_FRAME_CALLBACK m_fixedFrameCb = nullptr; /* 固定帧回调 */
     VARIABLE_FRAME_CALLBACK m_variableFrameCb = nullptr; /* 可变帧回调 */
+    std::shared_ptr<iec103::FixedFrame> m_fixedFrame = nullptr; /* 复用的固定帧 */
+    std::shared_ptr<iec103::VariableFrame> m_variableFrame = nullptr; /* 复用的可变帧 */
+    std::shared_ptr<iec103::Asdu> m_asduPool[0x2B]; /* 复用的应用服务数据单元(按类型标识索引, 0为无法解析的类型) */
+    std::vector<std::vector<iec103::GID>> m_gidListPool; /* 复用的通用分类标识数据集列表(Asdu10/Asdu11) */
 }; // namespace npacket
 } // namespace npacket
@@ -14,6 +14,11 @@ uint32_t ModbusTcpParser::getProtocol() const noexcept
     return ApplicationProtocol::MODBUS_TCP;
 }
 
+std::vector<ProtocolSignature> ModbusTcpParser::getSignatures() const
+{
+    return {ProtocolSignature(2, {0x00, 0x00, 0x00})}; /* MBAP头: 协议标识符为0, 长度不超过254(高字节为0) */
+}
+
 ParseResult ModbusTcpParser::parse(const ProtocolData& pd, uint32_t& consumeLen)
 {
     consumeLen = 0;
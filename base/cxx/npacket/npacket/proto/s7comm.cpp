@@ -4,6 +4,22 @@
 
 namespace npacket
 {
+/**
+ * @brief 分片数据缓冲区的最大缓存数量
+ */
+static const size_t MAX_FRAGMENT_BUFFER_POOL_SIZE = 16;
+
+/**
+ * @brief 取出容器(清空内容, 保留已分配的内存)
+ */
+template<typename T>
+static T takeCleared(T& container)
+{
+    T result = std::move(container);
+    result.clear();
+    return result;
+}
+
 inline void parseAsciiString(const uint8_t* data, uint32_t maxLen, std::string& str)
 {
     uint32_t actualLen = 0;
@@ -37,7 +53,7 @@ bool S7CommParser::parse(size_t flag, size_t num, const std::chrono::steady_cloc
     {
         return false;
     }
-    s7comm::S7CommInfo s7Info;
+    auto& s7Info = m_s7Info; /* 复用, 避免逐帧分配列表内存 */
     if (!parseS7CommInfo(ntp, header, payload, payloadLen, s7Info))
     {
         return false;
@@ -69,6 +85,7 @@ void S7CommParser::cleanupFragmentCache(const std::chrono::steady_clock::time_po
     {
         if (ntp - iter->second.lastAccess > std::chrono::milliseconds(m_fragTimeout))
         {
+            recycleFragmentBuffer(iter->second.data);
             iter = m_cpuServiceFragments.erase(iter);
         }
         else
@@ -81,7 +98,7 @@ void S7CommParser::cleanupFragmentCache(const std::chrono::steady_clock::time_po
 bool S7CommParser::parseS7CommInfo(const std::chrono::steady_clock::time_point& ntp, const ProtocolHeader* header, const uint8_t* data,
                                    uint32_t dataLen, s7comm::S7CommInfo& info)
 {
-    memset(&info, 0, sizeof(s7comm::S7CommInfo));
+    resetS7CommInfo(info);
     if (dataLen < 10)
     {
         return false;
@@ -682,6 +699,41 @@ bool S7CommParser::parseCpuServiceData(const s7comm::RosctrType& rosctr, const u
     return true;
 }
 
+void S7CommParser::releaseFlow(const TcpStreamKey& key)
+{
+    if (m_cpuServiceFragments.empty())
+    {
+        return;
+    }
+    uint32_t srcIp = 0, dstIp = 0; /* 分片缓存键只记录IPv4地址, IPv6时为0 */
+    uint16_t srcPort = 0, dstPort = 0;
+    if (4 == key.ipVersion)
+    {
+        srcIp = key.v4.srcIp;
+        dstIp = key.v4.dstIp;
+        srcPort = key.v4.srcPort;
+        dstPort = key.v4.dstPort;
+    }
+    else
+    {
+        srcPort = key.v6.srcPort;
+        dstPort = key.v6.dstPort;
+    }
+    for (auto iter = m_cpuServiceFragments.begin(); m_cpuServiceFragments.end() != iter;)
+    {
+        const auto& k = iter->first;
+        if (k.srcIp == srcIp && k.dstIp == dstIp && k.srcPort == srcPort && k.dstPort == dstPort)
+        {
+            recycleFragmentBuffer(iter->second.data);
+            iter = m_cpuServiceFragments.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
 bool S7CommParser::tryReassembleCpuServiceData(const std::chrono::steady_clock::time_point& ntp, const ProtocolHeader* header,
                                                s7comm::S7CommInfo& info)
 {
@@ -721,7 +773,8 @@ bool S7CommParser::tryReassembleCpuServiceData(const std::chrono::steady_clock::
             /* 更新头部: 第一片的PDU参考号, 总长度(仅含一个4字节头部) */
             info.header.protocolDataUnitReference = iter->second.firstProtocolDataUnitReference;
             info.header.dataLength = iter->second.totalDataLength;
-            info.reassembledData = std::move(iter->second.data); /* 将合并后的数据转移到info中, 避免指针悬空 */
+            info.reassembledData.swap(iter->second.data); /* 将合并后的数据转移到info中, 避免指针悬空 */
+            recycleFragmentBuffer(iter->second.data); /* info原有的缓冲区回收复用 */
             m_cpuServiceFragments.erase(iter);
             if (info.reassembledData.empty())
             {
@@ -746,6 +799,11 @@ bool S7CommParser::tryReassembleCpuServiceData(const std::chrono::steady_clock::
             frag.lastAccess = ntp;
             frag.firstProtocolDataUnitReference = info.header.protocolDataUnitReference;
             frag.totalDataLength = info.header.dataLength;
+            if (!m_fragmentBufferPool.empty())
+            {
+                frag.data = std::move(m_fragmentBufferPool.back());
+                m_fragmentBufferPool.pop_back();
+            }
             if (info.cpuData.rawData && info.cpuData.length > 0)
             {
                 frag.data.insert(frag.data.end(), info.cpuData.rawData, info.cpuData.rawData + info.cpuData.length);
@@ -767,6 +825,40 @@ bool S7CommParser::tryReassembleCpuServiceData(const std::chrono::steady_clock::
     return true; /* 非分片情况, 直接解析 */
 }
 
+void S7CommParser::resetS7CommInfo(s7comm::S7CommInfo& info)
+{
+    auto cpuParamItems = takeCleared(info.cpuParam.items);
+    auto blockList = takeCleared(info.cpuData.blockList);
+    auto blockListOfTypeItems = takeCleared(info.cpuData.blockListOfType.resp.items);
+    auto szlDatas = takeCleared(info.cpuData.szlDatas);
+    auto username = takeCleared(info.cpuData.msgService.req.username);
+    auto rwParamItems = takeCleared(info.rwParam.items);
+    auto rwData = takeCleared(info.rwData);
+    auto plcCtrlParams = takeCleared(info.plcCtrlParam.params);
+    auto statusMsg = takeCleared(info.plcCtrlData.statusMsg);
+    auto reassembledData = takeCleared(info.reassembledData);
+    info = s7comm::S7CommInfo();
+    info.cpuParam.items = std::move(cpuParamItems);
+    info.cpuData.blockList = std::move(blockList);
+    info.cpuData.blockListOfType.resp.items = std::move(blockListOfTypeItems);
+    info.cpuData.szlDatas = std::move(szlDatas);
+    info.cpuData.msgService.req.username = std::move(username);
+    info.rwParam.items = std::move(rwParamItems);
+    info.rwData = std::move(rwData);
+    info.plcCtrlParam.params = std::move(plcCtrlParams);
+    info.plcCtrlData.statusMsg = std::move(statusMsg);
+    info.reassembledData = std::move(reassembledData);
+}
+
+void S7CommParser::recycleFragmentBuffer(std::vector<uint8_t>& data)
+{
+    if (data.capacity() > 0 && m_fragmentBufferPool.size() < MAX_FRAGMENT_BUFFER_POOL_SIZE)
+    {
+        data.clear();
+        m_fragmentBufferPool.emplace_back(std::move(data));
+    }
+}
+
 bool S7CommParser::parseReadWriteParamItem(const uint8_t* data, uint32_t dataLen, s7comm::ReadWriteParamItem& item, uint32_t& itemLen)
 {
     itemLen = 0;
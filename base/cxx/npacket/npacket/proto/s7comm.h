@@ -38,7 +38,7 @@ public:
      * @param header 传输层头部(TCP)
      * @param tpktInfo TPKT包信息
      * @param cotpInfo COTP包信息
-     * @param s7Info S7COMM信息
+     * @param s7Info S7COMM信息(由解析器复用, 只在回调中有效, 需要在回调之后使用时请拷贝)
      */
     using FRAME_CALLBACK =
         std::function<void(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen, const ProtocolHeader* header,
@@ -79,6 +79,12 @@ public:
      */
     void cleanupFragmentCache(const std::chrono::steady_clock::time_point& ntp);
 
+    /**
+     * @brief 释放指定TCP流的分片缓存(可在分析器的流结束回调中调用, 不必等待超时)
+     * @param key TCP流键
+     */
+    void releaseFlow(const TcpStreamKey& key);
+
 private:
     /**
      * @brief 解析S7COMM信息
@@ -115,6 +121,16 @@ private:
     bool tryReassembleCpuServiceData(const std::chrono::steady_clock::time_point& ntp, const ProtocolHeader* header,
                                      s7comm::S7CommInfo& info);
 
+    /**
+     * @brief 重置S7COMM信息(列表和字符串成员保留已分配的内存)
+     */
+    static void resetS7CommInfo(s7comm::S7CommInfo& info);
+
+    /**
+     * @brief 回收分片数据缓冲区(清空内容, 保留已分配的内存, 供下一个分片序列使用)
+     */
+    void recycleFragmentBuffer(std::vector<uint8_t>& data);
+
     /**
      * @brief 解析读/写
      */
@@ -279,5 +295,7 @@ private:
     const size_t m_fragTimeout; /* 分片重组超时时间(单位:毫秒) */
     FRAME_CALLBACK m_frameCb = nullptr; /* 帧回调 */
     std::unordered_map<CpuServiceFragmentKey, S7FragmentCache, CpuServiceFragmentKeyHash> m_cpuServiceFragments; /* CPU服务分片缓存 */
+    std::vector<std::vector<uint8_t>> m_fragmentBufferPool; /* 复用的分片数据缓冲区 */
+    s7comm::S7CommInfo m_s7Info; /* 复用的S7COMM信息(每帧重置) */
 };
 } // namespace npacket
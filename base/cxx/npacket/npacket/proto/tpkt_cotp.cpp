@@ -7,6 +7,11 @@ uint32_t TpktCotpParser::getProtocol() const noexcept
     return ApplicationProtocol::TPKT_COTP;
 }
 
+std::vector<ProtocolSignature> TpktCotpParser::getSignatures() const
+{
+    return {ProtocolSignature(0, {0x03, 0x00})}; /* TPKT头: 版本3, 保留字节0 */
+}
+
 ParseResult TpktCotpParser::parse(const ProtocolData& pd, uint32_t& consumeLen)
 {
     consumeLen = 0;
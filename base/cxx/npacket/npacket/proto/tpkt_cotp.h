@@ -111,6 +111,12 @@ public:
      */
     uint32_t getProtocol() const noexcept override;
 
+    /**
+     * @brief 获取协议特征
+     * @return 特征列表
+     */
+    std::vector<ProtocolSignature> getSignatures() const override;
+
     /**
      * @brief 解析
      * @param pd 协议数据
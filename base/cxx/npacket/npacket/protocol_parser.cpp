@@ -7,5 +7,12 @@ uint32_t ProtocolParser::getParentProtocol() const noexcept
     return ApplicationProtocol::NONE;
 }
 
+std::vector<ProtocolSignature> ProtocolParser::getSignatures() const
+{
+    return {};
+}
+
+void ProtocolParser::onFlowEnd(const std::chrono::steady_clock::time_point& /*ntp*/, const TcpStreamKey& /*key*/, FlowEndReason /*reason*/) {}
+
 void ProtocolParser::reset() {}
 } // namespace npacket
@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <vector>
 
 #include "protocol.h"
 
@@ -43,6 +44,35 @@ enum ParseResult
     CONTINUE, /* 数据不足, 需要继续接收 */
 };
 
+/**
+ * @brief 协议特征(用于应用层协议识别, 在解析前快速筛选候选解析器)
+ */
+struct ProtocolSignature
+{
+    int32_t offset = 0; /* 特征在负载中的偏移, 小于0表示在负载前depth字节内的任意位置 */
+    uint32_t depth = 128; /* 搜索深度(字节), 只在offset小于0时有效 */
+    std::vector<uint8_t> pattern; /* 特征字节 */
+    std::vector<uint8_t> mask; /* 掩码, 为空表示全部为0xFF, 否则与pattern等长, 规则: (data[i] & mask[i]) == (pattern[i] & mask[i]) */
+
+    ProtocolSignature() = default;
+
+    ProtocolSignature(int32_t offset, const std::vector<uint8_t>& pattern, const std::vector<uint8_t>& mask = {})
+        : offset(offset), pattern(pattern), mask(mask)
+    {
+    }
+};
+
+/**
+ * @brief TCP流结束原因
+ */
+enum class FlowEndReason
+{
+    FIN = 0, /* 收到FIN */
+    RST, /* 收到RST */
+    TIMEOUT, /* 超时未收到数据 */
+    EVICTED /* 被淘汰(超出最大流缓存数量或重组内存上限) */
+};
+
 /**
  * @brief 应用层协议解析器(接口类)
  */
@@ -69,6 +99,21 @@ public:
      */
     virtual ParseResult parse(const ProtocolData& pd, uint32_t& consumeLen) = 0;
 
+    /**
+     * @brief 获取协议特征, 分析器据此在解析前筛选候选解析器(任意一个特征命中才会尝试解析),
+     *        未声明特征的解析器对所有数据都会尝试解析(例如需要识别动态端口数据连接的FTP)
+     * @return 特征列表
+     */
+    virtual std::vector<ProtocolSignature> getSignatures() const;
+
+    /**
+     * @brief TCP流结束通知(在该流最后一个数据包解析完之后调用), 可用于及时释放解析器中与该流相关的状态
+     * @param ntp 当前时间点
+     * @param key TCP流键(有方向, 与结束的那个方向的数据包一致)
+     * @param reason 结束原因
+     */
+    virtual void onFlowEnd(const std::chrono::steady_clock::time_point& ntp, const TcpStreamKey& key, FlowEndReason reason);
+
     /**
      * @brief 重置
      */
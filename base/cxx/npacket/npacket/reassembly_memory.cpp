@@ -0,0 +1,371 @@
+#include "reassembly_memory.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace npacket
+{
+/**
+ * @brief 内存块头(数据紧随其后, 有效数据范围: [begin, end))
+ */
+struct ChunkBuffer::Chunk
+{
+    Chunk* next; /* 下一个内存块 */
+    uint32_t begin; /* 数据起始位置 */
+    uint32_t end; /* 数据结束位置 */
+
+    uint8_t* data()
+    {
+        return (uint8_t*)(this + 1);
+    }
+
+    size_t size() const
+    {
+        return end - begin;
+    }
+};
+
+/**
+ * @brief 增加统计值(只有1个线程写, 其他线程只读, 不需要原子加)
+ */
+static inline void addStat(std::atomic<size_t>& stat, size_t value)
+{
+    stat.store(stat.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 减少统计值
+ */
+static inline void subStat(std::atomic<size_t>& stat, size_t value)
+{
+    stat.store(stat.load(std::memory_order_relaxed) - value, std::memory_order_relaxed);
+}
+
+ChunkBuffer::ChunkBuffer(ReassemblyMemory* memory) : m_memory(memory) {}
+
+ChunkBuffer::~ChunkBuffer()
+{
+    clear();
+}
+
+ChunkBuffer::ChunkBuffer(ChunkBuffer&& src) noexcept : m_memory(src.m_memory), m_head(src.m_head), m_tail(src.m_tail), m_size(src.m_size)
+{
+    src.m_head = nullptr;
+    src.m_tail = nullptr;
+    src.m_size = 0;
+}
+
+ChunkBuffer& ChunkBuffer::operator=(ChunkBuffer&& src) noexcept
+{
+    if (this != &src)
+    {
+        clear();
+        m_memory = src.m_memory;
+        m_head = src.m_head;
+        m_tail = src.m_tail;
+        m_size = src.m_size;
+        src.m_head = nullptr;
+        src.m_tail = nullptr;
+        src.m_size = 0;
+    }
+    return *this;
+}
+
+size_t ChunkBuffer::size() const
+{
+    return m_size;
+}
+
+bool ChunkBuffer::empty() const
+{
+    return (0 == m_size);
+}
+
+bool ChunkBuffer::append(const uint8_t* data, size_t len)
+{
+    if (!data || 0 == len)
+    {
+        return true;
+    }
+    if (!m_memory)
+    {
+        return false;
+    }
+    const size_t capacity = m_memory->getChunkCapacity();
+    const size_t tailRoom = m_tail ? (capacity - m_tail->end) : 0;
+    const size_t needChunkCount = (len > tailRoom) ? ((len - tailRoom + capacity - 1) / capacity) : 0;
+    if (m_memory->m_usedChunkCount + needChunkCount > m_memory->m_maxChunkCount) /* 先检查, 保证失败时缓冲不变 */
+    {
+        addStat(m_memory->m_allocFailures, 1);
+        return false;
+    }
+    size_t remain = len;
+    if (tailRoom > 0)
+    {
+        const size_t n = std::min(tailRoom, remain);
+        memcpy(m_tail->data() + m_tail->end, data, n);
+        m_tail->end += (uint32_t)n;
+        data += n;
+        remain -= n;
+    }
+    while (remain > 0)
+    {
+        auto chunk = m_memory->allocChunk();
+        const size_t n = std::min(capacity, remain);
+        memcpy(chunk->data(), data, n);
+        chunk->begin = 0;
+        chunk->end = (uint32_t)n;
+        if (m_tail)
+        {
+            m_tail->next = chunk;
+        }
+        else
+        {
+            m_head = chunk;
+        }
+        m_tail = chunk;
+        data += n;
+        remain -= n;
+    }
+    m_size += len;
+    addStat(m_memory->m_dataBytes, len);
+    return true;
+}
+
+void ChunkBuffer::trimFront(size_t len)
+{
+    if (len >= m_size)
+    {
+        clear();
+        return;
+    }
+    subStat(m_memory->m_dataBytes, len);
+    m_size -= len;
+    while (len > 0)
+    {
+        const size_t n = m_head->size();
+        if (len < n)
+        {
+            m_head->begin += (uint32_t)len;
+            break;
+        }
+        auto chunk = m_head;
+        m_head = chunk->next;
+        m_memory->freeChunk(chunk);
+        len -= n;
+    }
+}
+
+void ChunkBuffer::truncate(size_t len)
+{
+    if (len >= m_size)
+    {
+        return;
+    }
+    if (0 == len)
+    {
+        clear();
+        return;
+    }
+    subStat(m_memory->m_dataBytes, m_size - len);
+    m_size = len;
+    auto chunk = m_head;
+    while (len > chunk->size())
+    {
+        len -= chunk->size();
+        chunk = chunk->next;
+    }
+    chunk->end = chunk->begin + (uint32_t)len;
+    auto next = chunk->next;
+    chunk->next = nullptr;
+    m_tail = chunk;
+    while (next)
+    {
+        auto tmp = next->next;
+        m_memory->freeChunk(next);
+        next = tmp;
+    }
+}
+
+bool ChunkBuffer::splitAt(size_t pos, ChunkBuffer& back)
+{
+    back.clear();
+    back.m_memory = m_memory;
+    if (pos >= m_size)
+    {
+        return true;
+    }
+    if (0 == pos)
+    {
+        std::swap(m_head, back.m_head);
+        std::swap(m_tail, back.m_tail);
+        std::swap(m_size, back.m_size);
+        return true;
+    }
+    /* 查找拆分点所在的内存块 */
+    auto chunk = m_head;
+    size_t offset = pos;
+    while (offset >= chunk->size())
+    {
+        offset -= chunk->size();
+        chunk = chunk->next;
+    }
+    const size_t backSize = m_size - pos;
+    if (0 == offset) /* 拆分点在块边界, 前一块之后的整块转移 */
+    {
+        auto prev = m_head;
+        while (prev->next != chunk)
+        {
+            prev = prev->next;
+        }
+        prev->next = nullptr;
+        back.m_head = chunk;
+        back.m_tail = m_tail;
+        m_tail = prev;
+    }
+    else /* 拆分点在块内, 把该块的剩余部分拷贝到新块, 后续整块转移 */
+    {
+        if (m_memory->m_usedChunkCount + 1 > m_memory->m_maxChunkCount)
+        {
+            addStat(m_memory->m_allocFailures, 1);
+            return false;
+        }
+        auto newChunk = m_memory->allocChunk();
+        const size_t n = chunk->size() - offset;
+        memcpy(newChunk->data(), chunk->data() + chunk->begin + offset, n);
+        newChunk->begin = 0;
+        newChunk->end = (uint32_t)n;
+        newChunk->next = chunk->next;
+        chunk->end = chunk->begin + (uint32_t)offset;
+        chunk->next = nullptr;
+        back.m_head = newChunk;
+        back.m_tail = (m_tail == chunk) ? newChunk : m_tail;
+        m_tail = chunk;
+    }
+    back.m_size = backSize;
+    m_size = pos;
+    return true;
+}
+
+void ChunkBuffer::copyTo(size_t offset, std::vector<uint8_t>& out) const
+{
+    if (offset >= m_size)
+    {
+        return;
+    }
+    out.reserve(out.size() + m_size - offset);
+    for (auto chunk = m_head; chunk; chunk = chunk->next)
+    {
+        const size_t n = chunk->size();
+        if (offset >= n)
+        {
+            offset -= n;
+            continue;
+        }
+        const uint8_t* p = chunk->data() + chunk->begin;
+        out.insert(out.end(), p + offset, p + n);
+        offset = 0;
+    }
+}
+
+void ChunkBuffer::clear()
+{
+    if (!m_head)
+    {
+        return;
+    }
+    subStat(m_memory->m_dataBytes, m_size);
+    while (m_head)
+    {
+        auto next = m_head->next;
+        m_memory->freeChunk(m_head);
+        m_head = next;
+    }
+    m_tail = nullptr;
+    m_size = 0;
+}
+
+ReassemblyMemory::ReassemblyMemory(size_t chunkSize, size_t slabChunkCount, size_t maxMemory)
+    : m_chunkSize((std::max(chunkSize, sizeof(ChunkBuffer::Chunk) + 64) + 7) & ~(size_t)7) /* 8字节对齐 */
+    , m_slabChunkCount(std::max(slabChunkCount, (size_t)1))
+    , m_maxChunkCount(std::max(maxMemory / m_chunkSize, (size_t)1))
+{
+}
+
+ReassemblyMemory::~ReassemblyMemory()
+{
+    /* 注意: 所有ChunkBuffer需要在内存池之前析构 */
+}
+
+bool ReassemblyMemory::canAlloc(size_t len) const
+{
+    const size_t capacity = getChunkCapacity();
+    return (m_usedChunkCount + (len + capacity - 1) / capacity <= m_maxChunkCount);
+}
+
+size_t ReassemblyMemory::getChunkCapacity() const
+{
+    return m_chunkSize - sizeof(ChunkBuffer::Chunk);
+}
+
+size_t ReassemblyMemory::getMaxMemory() const
+{
+    return m_maxChunkCount * m_chunkSize;
+}
+
+size_t ReassemblyMemory::getUsedMemory() const
+{
+    return m_usedMemory.load(std::memory_order_relaxed);
+}
+
+size_t ReassemblyMemory::getReservedMemory() const
+{
+    return m_reservedMemory.load(std::memory_order_relaxed);
+}
+
+size_t ReassemblyMemory::getDataBytes() const
+{
+    return m_dataBytes.load(std::memory_order_relaxed);
+}
+
+size_t ReassemblyMemory::getAllocFailures() const
+{
+    return m_allocFailures.load(std::memory_order_relaxed);
+}
+
+ChunkBuffer::Chunk* ReassemblyMemory::allocChunk()
+{
+    if (m_usedChunkCount >= m_maxChunkCount)
+    {
+        addStat(m_allocFailures, 1);
+        return nullptr;
+    }
+    if (!m_freeList) /* 空闲链表为空, 申请新的slab(不超过上限) */
+    {
+        const size_t count = std::min(m_slabChunkCount, m_maxChunkCount - m_usedChunkCount);
+        std::unique_ptr<uint8_t[]> slab(new uint8_t[count * m_chunkSize]);
+        for (size_t i = count; i > 0; --i)
+        {
+            auto chunk = (ChunkBuffer::Chunk*)(slab.get() + (i - 1) * m_chunkSize);
+            chunk->next = m_freeList;
+            m_freeList = chunk;
+        }
+        m_slabList.emplace_back(std::move(slab));
+        addStat(m_reservedMemory, count * m_chunkSize);
+    }
+    auto chunk = m_freeList;
+    m_freeList = chunk->next;
+    chunk->next = nullptr;
+    ++m_usedChunkCount;
+    addStat(m_usedMemory, m_chunkSize);
+    return chunk;
+}
+
+void ReassemblyMemory::freeChunk(ChunkBuffer::Chunk* chunk)
+{
+    chunk->next = m_freeList;
+    m_freeList = chunk;
+    --m_usedChunkCount;
+    subStat(m_usedMemory, m_chunkSize);
+}
+} // namespace npacket
@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace npacket
+{
+class ReassemblyMemory;
+
+/**
+ * @brief 重组数据缓冲(由固定大小的内存块串成链表, 只能移动不能拷贝, 析构时把内存块归还给所属的内存池)
+ */
+class ChunkBuffer final
+{
+public:
+    ChunkBuffer() = default;
+    explicit ChunkBuffer(ReassemblyMemory* memory);
+    ~ChunkBuffer();
+    ChunkBuffer(const ChunkBuffer& src) = delete;
+    ChunkBuffer& operator=(const ChunkBuffer& src) = delete;
+    ChunkBuffer(ChunkBuffer&& src) noexcept;
+    ChunkBuffer& operator=(ChunkBuffer&& src) noexcept;
+
+    /**
+     * @brief 获取数据长度
+     * @return 长度(字节)
+     */
+    size_t size() const;
+
+    /**
+     * @brief 是否为空
+     * @return true-空, false-非空
+     */
+    bool empty() const;
+
+    /**
+     * @brief 追加数据(先填满尾部内存块, 再申请新的内存块)
+     * @param data 数据
+     * @param len 数据长度
+     * @return true-成功, false-超出内存上限(缓冲不变)
+     */
+    bool append(const uint8_t* data, size_t len);
+
+    /**
+     * @brief 丢弃头部数据(只调整内存块起始位置, 不拷贝)
+     * @param len 丢弃长度, 超过数据长度时清空
+     */
+    void trimFront(size_t len);
+
+    /**
+     * @brief 截断为指定长度(释放多余的内存块)
+     * @param len 保留长度
+     */
+    void truncate(size_t len);
+
+    /**
+     * @brief 从指定位置拆分, 后半部分移到另一个缓冲(整块转移, 最多拷贝拆分点所在内存块的剩余部分)
+     * @param pos 拆分位置
+     * @param back [输出]后半部分(原有数据被清空)
+     * @return true-成功, false-超出内存上限(缓冲不变)
+     */
+    bool splitAt(size_t pos, ChunkBuffer& back);
+
+    /**
+     * @brief 把数据追加到输出
+     * @param offset 起始偏移
+     * @param out [输出]数据
+     */
+    void copyTo(size_t offset, std::vector<uint8_t>& out) const;
+
+    /**
+     * @brief 清空(内存块归还给内存池)
+     */
+    void clear();
+
+private:
+    friend class ReassemblyMemory;
+    struct Chunk;
+
+    ReassemblyMemory* m_memory = nullptr; /* 所属内存池 */
+    Chunk* m_head = nullptr; /* 头部内存块 */
+    Chunk* m_tail = nullptr; /* 尾部内存块 */
+    size_t m_size = 0; /* 数据长度 */
+};
+
+/**
+ * @brief 重组内存池(按固定大小的内存块分配, 内存块从批量申请的slab中切分, 释放后进入空闲链表复用),
+ *        所有缓冲共用同一个内存上限, 注意: 非线程安全, 统计值可以跨线程读取
+ */
+class ReassemblyMemory final
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param chunkSize 内存块大小(字节, 包含块头)
+     * @param slabChunkCount 每个slab包含的内存块数量
+     * @param maxMemory 内存上限(字节, 按已分配的内存块计算)
+     */
+    ReassemblyMemory(size_t chunkSize, size_t slabChunkCount, size_t maxMemory);
+    ~ReassemblyMemory();
+    ReassemblyMemory(const ReassemblyMemory& src) = delete;
+    ReassemblyMemory& operator=(const ReassemblyMemory& src) = delete;
+
+    /**
+     * @brief 判断追加数据是否会超出内存上限
+     * @param len 数据长度
+     * @return true-可以分配, false-超出上限
+     */
+    bool canAlloc(size_t len) const;
+
+    /**
+     * @brief 获取单个内存块可存储的数据长度
+     */
+    size_t getChunkCapacity() const;
+
+    /**
+     * @brief 获取内存上限
+     */
+    size_t getMaxMemory() const;
+
+    /**
+     * @brief 获取已分配的内存(内存块数量 * 内存块大小)
+     */
+    size_t getUsedMemory() const;
+
+    /**
+     * @brief 获取已向系统申请的内存(所有slab的大小)
+     */
+    size_t getReservedMemory() const;
+
+    /**
+     * @brief 获取缓存的数据长度
+     */
+    size_t getDataBytes() const;
+
+    /**
+     * @brief 获取分配失败(超出内存上限)的次数
+     */
+    size_t getAllocFailures() const;
+
+private:
+    friend class ChunkBuffer;
+
+    /**
+     * @brief 分配内存块
+     * @return 内存块, 超出上限时为空
+     */
+    ChunkBuffer::Chunk* allocChunk();
+
+    /**
+     * @brief 释放内存块
+     */
+    void freeChunk(ChunkBuffer::Chunk* chunk);
+
+private:
+    const size_t m_chunkSize; /* 内存块大小(包含块头) */
+    const size_t m_slabChunkCount; /* 每个slab包含的内存块数量 */
+    const size_t m_maxChunkCount; /* 内存块数量上限 */
+    std::vector<std::unique_ptr<uint8_t[]>> m_slabList; /* slab列表(只在析构时释放) */
+    ChunkBuffer::Chunk* m_freeList = nullptr; /* 空闲内存块链表 */
+    size_t m_usedChunkCount = 0; /* 已分配的内存块数量 */
+    std::atomic<size_t> m_usedMemory = {0}; /* 已分配的内存 */
+    std::atomic<size_t> m_reservedMemory = {0}; /* 已申请的内存 */
+    std::atomic<size_t> m_dataBytes = {0}; /* 缓存的数据长度 */
+    std::atomic<size_t> m_allocFailures = {0}; /* 分配失败次数 */
+};
+} // namespace npacket
@@ -0,0 +1,484 @@
+#include "sharded_analyzer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "helper.h"
+
+namespace npacket
+{
+static const size_t IDLE_SPIN_COUNT = 64; /* 工作线程空闲时自旋(让出CPU)次数, 超过后进入等待 */
+
+/**
+ * @brief 数据包的分发信息
+ */
+struct DispatchInfo
+{
+    size_t hash = 0; /* 流哈希值(非首片无效) */
+    bool isFragment = false; /* 是否IP分片 */
+    bool isFirstFragment = false; /* 是否IP分片的首片 */
+    bool isLastFragment = false; /* 是否IP分片的最后一片 */
+    uint32_t fragOffset = 0; /* 分片负载在数据报中的偏移(字节) */
+    uint32_t fragLen = 0; /* 分片负载长度 */
+    FragmentKey fragKey; /* 分片键(isFragment为true时有效) */
+};
+
+/**
+ * @brief 混合哈希值(TcpStreamKey的哈希值低位分布不够均匀, 取模前需要混合)
+ */
+static size_t mixHash(uint64_t h)
+{
+    h ^= (h >> 33);
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= (h >> 33);
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= (h >> 33);
+    return (size_t)h;
+}
+
+/**
+ * @brief 计算对称的流哈希值(交换源/目的后哈希值不变), 复用TcpStreamKey的哈希算法
+ * @param ipVersion IP版本
+ * @param srcIp 源地址
+ * @param dstIp 目的地址
+ * @param srcPort 源端口
+ * @param dstPort 目的端口
+ * @return 哈希值
+ */
+static size_t symmetricHash(int ipVersion, const uint8_t* srcIp, const uint8_t* dstIp, uint16_t srcPort, uint16_t dstPort)
+{
+    const size_t addrLen = (4 == ipVersion ? 4 : 16);
+    auto ret = memcmp(srcIp, dstIp, addrLen);
+    if (ret > 0 || (0 == ret && srcPort > dstPort)) /* 按(地址, 端口)排序, 较小的一端作为源 */
+    {
+        std::swap(srcIp, dstIp);
+        std::swap(srcPort, dstPort);
+    }
+    if (4 == ipVersion)
+    {
+        return mixHash(TcpStreamKey::createIpv4(srcIp, dstIp, srcPort, dstPort).hash());
+    }
+    return mixHash(TcpStreamKey::createIpv6(srcIp, dstIp, srcPort, dstPort).hash());
+}
+
+/**
+ * @brief 获取数据包的分发信息(只解析必要的字段, 不创建头部对象)
+ * @param data 数据
+ * @param dataLen 数据长度
+ * @param dataSource 数据源
+ * @param usePorts 是否使用端口计算哈希值
+ * @param info [输出]分发信息
+ */
+static void getDispatchInfo(const uint8_t* data, uint32_t dataLen, const DataSource& dataSource, bool usePorts, DispatchInfo& info)
+{
+    uint32_t offset = 0;
+    uint16_t networkProtocol = 0;
+    if (DataSource::NETWORK_ETH == dataSource)
+    {
+        if (dataLen < 14)
+        {
+            return;
+        }
+        networkProtocol = Helper::ntoh16(data + 12);
+        offset = 14;
+    }
+    else
+    {
+        networkProtocol = (DataSource::NETWORK_IPv4 == dataSource ? NetworkProtocol::IPv4 : NetworkProtocol::IPv6);
+    }
+    const uint8_t* ip = data + offset;
+    const uint32_t ipLen = dataLen - offset;
+    const uint8_t *srcIp = nullptr, *dstIp = nullptr;
+    int ipVersion = 0;
+    uint8_t transportProtocol = 0;
+    uint32_t transportOffset = 0; /* 传输层在IP包中的偏移, 0表示不包含传输层头部(非首片) */
+    if (NetworkProtocol::IPv4 == networkProtocol)
+    {
+        if (ipLen < 20)
+        {
+            return;
+        }
+        ipVersion = 4;
+        srcIp = ip + 12;
+        dstIp = ip + 16;
+        transportProtocol = ip[9];
+        const uint16_t flagOffset = Helper::ntoh16(ip + 6);
+        const bool isMoreFragment = (0 != (flagOffset & 0x2000));
+        const uint16_t fragOffset = (flagOffset & 0x1FFF);
+        if (isMoreFragment || fragOffset > 0)
+        {
+            info.isFragment = true;
+            info.isFirstFragment = (0 == fragOffset);
+            info.isLastFragment = !isMoreFragment;
+            info.fragOffset = (uint32_t)fragOffset * 8;
+            const uint32_t totalLen = Helper::ntoh16(ip + 2), headerLen = (ip[0] & 0x0F) * 4;
+            info.fragLen = (totalLen > headerLen) ? (totalLen - headerLen) : 0;
+            info.fragKey = FragmentKey::createIpv4(srcIp, dstIp, Helper::ntoh16(ip + 4));
+        }
+        if (0 == fragOffset)
+        {
+            transportOffset = (ip[0] & 0x0F) * 4;
+        }
+    }
+    else if (NetworkProtocol::IPv6 == networkProtocol)
+    {
+        if (ipLen < 40)
+        {
+            return;
+        }
+        ipVersion = 6;
+        srcIp = ip + 8;
+        dstIp = ip + 24;
+        uint8_t nextHeader = ip[6];
+        uint32_t pos = 40;
+        transportOffset = pos;
+        while (transportOffset > 0
+               && (IPV6_EXT_HOP_BY_HOP == nextHeader || IPV6_EXT_ROUTING == nextHeader || IPV6_EXT_DEST_OPTIONS == nextHeader
+                   || IPV6_EXT_AUTH == nextHeader || IPV6_EXT_FRAGMENT == nextHeader)) /* 遍历扩展头 */
+        {
+            if (pos + 8 > ipLen)
+            {
+                transportOffset = 0;
+                break;
+            }
+            const uint8_t* ext = ip + pos;
+            if (IPV6_EXT_FRAGMENT == nextHeader)
+            {
+                const uint16_t fragOffset = (Helper::ntoh16(ext + 2) >> 3);
+                info.isFragment = true;
+                info.isFirstFragment = (0 == fragOffset);
+                info.isLastFragment = (0 == (Helper::ntoh16(ext + 2) & 0x0001));
+                info.fragOffset = (uint32_t)fragOffset * 8;
+                const uint32_t totalLen = 40 + (uint32_t)Helper::ntoh16(ip + 4);
+                info.fragLen = (totalLen > pos + 8) ? (totalLen - pos - 8) : 0;
+                info.fragKey = FragmentKey::createIpv6(srcIp, dstIp, Helper::ntoh32(ext + 4));
+                if (fragOffset > 0)
+                {
+                    transportOffset = 0;
+                    break;
+                }
+                pos += 8;
+            }
+            else if (IPV6_EXT_AUTH == nextHeader)
+            {
+                pos += ((uint32_t)ext[1] + 2) * 4;
+            }
+            else
+            {
+                pos += ((uint32_t)ext[1] + 1) * 8;
+            }
+            nextHeader = ext[0];
+            transportOffset = pos;
+        }
+        transportProtocol = nextHeader;
+    }
+    else /* 非IP数据包(例如ARP) */
+    {
+        return;
+    }
+    uint16_t srcPort = 0, dstPort = 0;
+    if (usePorts && transportOffset > 0 && transportOffset + 4 <= ipLen
+        && (TransportProtocol::TCP == transportProtocol || TransportProtocol::UDP == transportProtocol))
+    {
+        srcPort = Helper::ntoh16(ip + transportOffset);
+        dstPort = Helper::ntoh16(ip + transportOffset + 2);
+    }
+    info.hash = symmetricHash(ipVersion, srcIp, dstIp, srcPort, dstPort);
+}
+
+/**
+ * @brief 分片
+ */
+struct ShardedAnalyzer::Shard
+{
+    size_t index = 0; /* 分片索引 */
+    std::unique_ptr<Analyzer> analyzer; /* 分析器 */
+    std::vector<Packet> ring; /* 环形队列(容量为2的幂) */
+    size_t mask = 0; /* 环形队列索引掩码 */
+    char pad1[64]; /* 避免读写位置位于同一缓存行(伪共享) */
+    std::atomic<size_t> head = {0}; /* 写位置(只由分发线程修改) */
+    char pad2[64];
+    std::atomic<size_t> tail = {0}; /* 读位置(只由工作线程修改, 数据包解析完成后才前移) */
+    char pad3[64];
+    std::atomic<size_t> packets = {0}; /* 已解析的数据包数量 */
+    std::atomic<size_t> drops = {0}; /* 丢弃的数据包数量 */
+    std::atomic<int64_t> busyTime = {0}; /* 解析累计耗时(纳秒) */
+    std::atomic_bool waiting = {false}; /* 工作线程是否在等待 */
+    std::mutex mutex; /* for 等待 */
+    std::condition_variable cv; /* 唤醒工作线程 */
+    std::thread thread; /* 工作线程 */
+};
+
+ShardedAnalyzer::ShardedAnalyzer(ShardConfig shardCfg, const CallbackConfig& cbCfg, const IpReassemblyConfig& ipReassemblyCfg,
+                                 const TcpReassemblyConfig& tcpReassemblyCfg, const ReassemblyMemoryConfig& memoryCfg)
+    : m_ipReassemblyCfg(ipReassemblyCfg)
+{
+    shardCfg.shardCount = std::min(std::max(shardCfg.shardCount, (size_t)1), (size_t)64);
+    shardCfg.ringSize = std::min(std::max(shardCfg.ringSize, (size_t)64), (size_t)1048576);
+    size_t ringSize = 64;
+    while (ringSize < shardCfg.ringSize) /* 向上取整为2的幂 */
+    {
+        ringSize <<= 1;
+    }
+    shardCfg.ringSize = ringSize;
+    m_shardCfg = shardCfg;
+    auto shardMemoryCfg = memoryCfg;
+    shardMemoryCfg.maxMemory = std::max(memoryCfg.maxMemory / m_shardCfg.shardCount, (size_t)(1024 * 1024)); /* 各个分片平分内存上限 */
+    for (size_t i = 0; i < m_shardCfg.shardCount; ++i)
+    {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        shard->analyzer = std::make_unique<Analyzer>(cbCfg, ipReassemblyCfg, tcpReassemblyCfg, shardMemoryCfg);
+        shard->ring.resize(ringSize);
+        shard->mask = ringSize - 1;
+        m_shardList.emplace_back(std::move(shard));
+    }
+    for (auto& shard : m_shardList)
+    {
+        auto ptr = shard.get();
+        shard->thread = std::thread([this, ptr]() { workerLoop(ptr); });
+    }
+}
+
+ShardedAnalyzer::~ShardedAnalyzer()
+{
+    m_running = false;
+    for (auto& shard : m_shardList)
+    {
+        shard->cv.notify_one();
+        if (shard->thread.joinable())
+        {
+            shard->thread.join();
+        }
+    }
+}
+
+bool ShardedAnalyzer::addProtocolParser(const PARSER_CREATOR& creator, const std::vector<uint16_t>& ports, bool portStrict)
+{
+    if (!creator)
+    {
+        return false;
+    }
+    bool ret = true;
+    for (auto& shard : m_shardList)
+    {
+        if (!shard->analyzer->addProtocolParser(creator(shard->index), ports, portStrict))
+        {
+            ret = false;
+        }
+    }
+    return ret;
+}
+
+void ShardedAnalyzer::removeProtocolParser(uint32_t protocol)
+{
+    for (auto& shard : m_shardList)
+    {
+        shard->analyzer->removeProtocolParser(protocol);
+    }
+}
+
+int ShardedAnalyzer::parse(size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, const uint8_t* data,
+                           uint32_t dataLen, const DataSource& dataSource)
+{
+    if (!data || 0 == dataLen)
+    {
+        return -1;
+    }
+    cleanupFragmentRoute(ntp);
+    const size_t shardCount = m_shardList.size();
+    if (DataSource::SERIAL == dataSource) /* 串口数据没有流的概念, 按数据标志分发, 保证同一来源的数据有序 */
+    {
+        return push(flag % shardCount, flag, num, ntp, data, dataLen, dataSource);
+    }
+    DispatchInfo info;
+    getDispatchInfo(data, dataLen, dataSource, ShardKeyType::FIVE_TUPLE == m_shardCfg.keyType, info);
+    if (!info.isFragment)
+    {
+        return push(info.hash % shardCount, flag, num, ntp, data, dataLen, dataSource);
+    }
+    /* IP分片: 后续分片跟随首片分发到同一个分析器, 保证分片重组的状态一致 */
+    auto iter = m_fragmentRouteMap.find(info.fragKey);
+    if (m_fragmentRouteMap.end() == iter)
+    {
+        if (m_fragmentRouteMap.size() >= m_ipReassemblyCfg.maxCacheCount && !m_fragmentRouteLru.empty()) /* 防止分片攻击, 淘汰最早的路由 */
+        {
+            eraseFragmentRoute(static_cast<FragmentRoute*>(m_fragmentRouteLru.next));
+        }
+        auto newRoute = std::make_unique<FragmentRoute>();
+        newRoute->key = info.fragKey;
+        newRoute->createTime = ntp;
+        m_fragmentRouteLru.moveToBack(newRoute.get());
+        iter = m_fragmentRouteMap.insert(std::make_pair(info.fragKey, std::move(newRoute))).first;
+    }
+    auto& route = *iter->second;
+    if (route.shardIndex < 0 && !info.isFirstFragment && route.pendingList.size() >= m_ipReassemblyCfg.maxFragCount)
+    {
+        return 2;
+    }
+    route.receivedLen += info.fragLen;
+    if (info.isLastFragment)
+    {
+        route.totalLen = info.fragOffset + info.fragLen;
+    }
+    /* 首片已分发且所有分片都已收到, 不会再有该数据报的分片, 删除路由 */
+    const bool complete = (route.totalLen > 0 && route.receivedLen >= route.totalLen);
+    if (route.shardIndex >= 0) /* 首片已到达 */
+    {
+        const auto ret = push(route.shardIndex, flag, num, ntp, data, dataLen, dataSource);
+        if (complete)
+        {
+            eraseFragmentRoute(&route);
+        }
+        return ret;
+    }
+    if (!info.isFirstFragment) /* 首片未到达, 暂存 */
+    {
+        Packet pkt;
+        pkt.flag = flag;
+        pkt.num = num;
+        pkt.ntp = ntp;
+        pkt.dataSource = dataSource;
+        pkt.data.assign(data, data + dataLen);
+        route.pendingList.emplace_back(std::move(pkt));
+        return 5;
+    }
+    route.shardIndex = (int)(info.hash % shardCount);
+    auto ret = push(route.shardIndex, flag, num, ntp, data, dataLen, dataSource);
+    for (const auto& pkt : route.pendingList) /* 分发暂存的后续分片 */
+    {
+        push(route.shardIndex, pkt.flag, pkt.num, pkt.ntp, pkt.data.data(), pkt.data.size(), pkt.dataSource);
+    }
+    route.pendingList.clear();
+    route.pendingList.shrink_to_fit();
+    if (complete)
+    {
+        eraseFragmentRoute(&route);
+    }
+    return ret;
+}
+
+void ShardedAnalyzer::waitIdle()
+{
+    for (auto& shard : m_shardList)
+    {
+        while (shard->tail.load(std::memory_order_acquire) != shard->head.load(std::memory_order_acquire))
+        {
+            shard->cv.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+size_t ShardedAnalyzer::getShardCount() const
+{
+    return m_shardList.size();
+}
+
+std::vector<ShardStat> ShardedAnalyzer::getStats() const
+{
+    std::vector<ShardStat> statList;
+    for (const auto& shard : m_shardList)
+    {
+        ShardStat stat;
+        stat.packets = shard->packets.load(std::memory_order_relaxed);
+        stat.drops = shard->drops.load(std::memory_order_relaxed);
+        stat.busyTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(shard->busyTime.load(std::memory_order_relaxed)));
+        stat.reassembly = shard->analyzer->getReassemblyStat();
+        statList.emplace_back(stat);
+    }
+    return statList;
+}
+
+void ShardedAnalyzer::workerLoop(Shard* shard)
+{
+    size_t idleCount = 0;
+    while (true)
+    {
+        const size_t tail = shard->tail.load(std::memory_order_relaxed);
+        if (tail != shard->head.load(std::memory_order_acquire)) /* 队列非空 */
+        {
+            const auto& pkt = shard->ring[tail & shard->mask];
+            auto tp1 = std::chrono::steady_clock::now();
+            shard->analyzer->parse(pkt.flag, pkt.num, pkt.ntp, pkt.data.data(), pkt.data.size(), pkt.dataSource);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tp1).count();
+            shard->busyTime.fetch_add(elapsed, std::memory_order_relaxed);
+            shard->packets.fetch_add(1, std::memory_order_relaxed);
+            shard->tail.store(tail + 1, std::memory_order_release); /* 解析完成后才释放槽位 */
+            idleCount = 0;
+            continue;
+        }
+        if (!m_running) /* 队列已清空且已停止 */
+        {
+            break;
+        }
+        if (++idleCount < IDLE_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        /* 长时间空闲, 进入等待(超时兜底, 避免错过唤醒) */
+        std::unique_lock<std::mutex> locker(shard->mutex);
+        shard->waiting = true;
+        if (shard->tail.load() == shard->head.load() && m_running)
+        {
+            shard->cv.wait_for(locker, std::chrono::milliseconds(1));
+        }
+        shard->waiting = false;
+    }
+}
+
+int ShardedAnalyzer::push(size_t index, size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, const uint8_t* data,
+                          uint32_t dataLen, const DataSource& dataSource)
+{
+    auto& shard = m_shardList[index];
+    const size_t head = shard->head.load(std::memory_order_relaxed);
+    while (head - shard->tail.load(std::memory_order_acquire) >= shard->ring.size()) /* 队列已满 */
+    {
+        if (!m_shardCfg.blockWhenFull)
+        {
+            shard->drops.fetch_add(1, std::memory_order_relaxed);
+            return 7;
+        }
+        shard->cv.notify_one();
+        std::this_thread::yield();
+    }
+    auto& pkt = shard->ring[head & shard->mask];
+    pkt.flag = flag;
+    pkt.num = num;
+    pkt.ntp = ntp;
+    pkt.dataSource = dataSource;
+    pkt.data.assign(data, data + dataLen); /* 槽位的缓冲区容量会被复用, 稳定后不再分配内存 */
+    shard->head.store(head + 1, std::memory_order_release);
+    if (shard->waiting.load(std::memory_order_relaxed))
+    {
+        shard->cv.notify_one();
+    }
+    return 0;
+}
+
+void ShardedAnalyzer::cleanupFragmentRoute(const std::chrono::steady_clock::time_point& ntp)
+{
+    /* LRU链表按创建时间从旧到新排列, 遇到第一个未超时的路由即可停止 */
+    const auto timeout = std::chrono::milliseconds(m_ipReassemblyCfg.timeout);
+    while (!m_fragmentRouteLru.empty())
+    {
+        auto route = static_cast<FragmentRoute*>(m_fragmentRouteLru.next);
+        if (ntp - route->createTime <= timeout)
+        {
+            break;
+        }
+        eraseFragmentRoute(route); /* 超时(首片未到达时暂存的分片一并丢弃) */
+    }
+}
+
+void ShardedAnalyzer::eraseFragmentRoute(FragmentRoute* route)
+{
+    const FragmentKey key = route->key; /* 删除后节点被析构, 先复制键 */
+    m_fragmentRouteMap.erase(key);
+}
+} // namespace npacket
@@ -0,0 +1,190 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "analyzer.h"
+
+namespace npacket
+{
+/**
+ * @brief 分发键类型
+ */
+enum class ShardKeyType
+{
+    FIVE_TUPLE = 0, /* 对称五元组(源/目的地址+源/目的端口), 负载最均衡 */
+    IP_PAIR, /* 对称地址对(源/目的地址), 同一对主机之间的所有连接分发到同一分片, 适用于需要关联多个连接的协议(例如: FTP控制连接和数据连接) */
+};
+
+/**
+ * @brief 分片配置
+ */
+struct ShardConfig
+{
+    size_t shardCount = 4; /* 分片数量(即工作线程数量, 每个分片拥有独立的分析器), 值: [1, 64] */
+    size_t ringSize = 4096; /* 每个分片的环形队列容量(数据包个数, 向上取整为2的幂), 值: [64, 1048576] */
+    ShardKeyType keyType = ShardKeyType::FIVE_TUPLE; /* 分发键类型 */
+    bool blockWhenFull = false; /* 队列满时是否阻塞等待, true-阻塞(适用于离线回放), false-丢弃数据包(适用于实时抓包) */
+};
+
+/**
+ * @brief 分片统计
+ */
+struct ShardStat
+{
+    size_t packets = 0; /* 已解析的数据包数量 */
+    size_t drops = 0; /* 队列满时丢弃的数据包数量 */
+    std::chrono::steady_clock::duration busyTime = std::chrono::steady_clock::duration::zero(); /* 解析累计耗时 */
+    ReassemblyStat reassembly; /* 重组内存统计 */
+};
+
+/**
+ * @brief 应用层解析器创建函数(每个分片创建1个独立的解析器实例, 因为解析器内部有状态)
+ * @param shardIndex 分片索引
+ * @return 应用层解析器
+ */
+using PARSER_CREATOR = std::function<std::shared_ptr<ProtocolParser>(size_t shardIndex)>;
+
+/**
+ * @brief 分片分析器(多线程), 按对称五元组把数据包分发到多个工作线程, 每个工作线程拥有独立的分析器,
+ *        同一个流(双向)的数据包总是由同一个分析器按到达顺序解析, 因此流重组和应用层解析的状态无需加锁
+ *        IP分片: 只有首片包含端口, 分发器记录分片标识到分片索引的映射, 后续分片跟随首片, 首片之前到达的分片暂存到首片到达后再分发
+ *        注意: 回调在各个工作线程中并发调用, 需要保证线程安全
+ */
+class ShardedAnalyzer
+{
+public:
+    /**
+     * @brief 构造函数(创建并启动工作线程)
+     * @param shardCfg 分片配置
+     * @param cbCfg 回调配置
+     * @param ipReassemblyCfg IP分片重组配置
+     * @param tcpReassemblyCfg TCP分段重组配置
+     * @param memoryCfg 重组内存配置(内存上限由各个分片平分)
+     */
+    ShardedAnalyzer(ShardConfig shardCfg = ShardConfig(), const CallbackConfig& cbCfg = CallbackConfig(),
+                    const IpReassemblyConfig& ipReassemblyCfg = IpReassemblyConfig(),
+                    const TcpReassemblyConfig& tcpReassemblyCfg = TcpReassemblyConfig(),
+                    const ReassemblyMemoryConfig& memoryCfg = ReassemblyMemoryConfig());
+
+    /**
+     * @brief 析构函数(解析完队列中剩余的数据包后停止工作线程)
+     */
+    ~ShardedAnalyzer();
+
+    /**
+     * @brief 添加应用层解析器
+     * @param creator 解析器创建函数, 为每个分片创建1个解析器
+     * @param ports 端口号列表, 当协议端口固定且已知时, 可以把解析器绑定到所指定端口
+     * @param portStrict 端口是否严格匹配, true-严格匹配(当解析数据时根据端口有查找到对应的解析器, 则不继续查找其他解析器), false-否
+     * @return true-添加成功, false-添加失败
+     */
+    bool addProtocolParser(const PARSER_CREATOR& creator, const std::vector<uint16_t>& ports = {}, bool portStrict = false);
+
+    /**
+     * @brief 删除应用层解析器
+     * @param protocol 应用层协议
+     */
+    void removeProtocolParser(uint32_t protocol);
+
+    /**
+     * @brief 分发数据(拷贝到对应分片的队列后立即返回, 由工作线程解析), 注意: 只能在1个线程中调用
+     * @param flag 数据标志, 自定义(可用于区分不同数据来源或类型), 串口数据按此值分发
+     * @param num 数据序号, 自定义(一般是递增)
+     * @param ntp 数据包接收时间点(注意: 尽量不要频繁调用std::chrono::steady_clock::now()获取, 建议1秒获取1次)
+     * @param data 数据指针
+     * @param dataLen 数据长度
+     * @param dataSource 数据源, 默认为NETWORK_ETH(以太网帧)
+     * @return -1-数据为空, 0-成功, 2-暂存的分片已满(丢弃), 5-分片已暂存(等待首片), 7-队列已满(丢弃)
+     */
+    int parse(size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, const uint8_t* data, uint32_t dataLen,
+              const DataSource& dataSource = DataSource::NETWORK_ETH);
+
+    /**
+     * @brief 等待所有已分发的数据包解析完成
+     */
+    void waitIdle();
+
+    /**
+     * @brief 获取分片数量
+     * @return 分片数量
+     */
+    size_t getShardCount() const;
+
+    /**
+     * @brief 获取各个分片的统计
+     * @return 统计列表(按分片索引)
+     */
+    std::vector<ShardStat> getStats() const;
+
+private:
+    /**
+     * @brief 数据包(队列中的槽位, 数据缓冲区分配后复用)
+     */
+    struct Packet
+    {
+        size_t flag = 0; /* 数据标志 */
+        size_t num = 0; /* 数据序号 */
+        std::chrono::steady_clock::time_point ntp; /* 数据包接收时间点 */
+        DataSource dataSource = DataSource::NETWORK_ETH; /* 数据源 */
+        std::vector<uint8_t> data; /* 数据 */
+    };
+
+    struct Shard;
+
+    /**
+     * @brief IP分片路由(LRU链表按创建时间从旧到新排列)
+     */
+    struct FragmentRoute : LruNode
+    {
+        FragmentKey key; /* 分片键(淘汰时用于从路由表中删除) */
+        std::chrono::steady_clock::time_point createTime; /* 创建时间(用于超时) */
+        int shardIndex = -1; /* 分片索引, <0表示首片未到达 */
+        uint32_t totalLen = 0; /* 数据报负载总长度, 0表示最后一片未到达 */
+        uint32_t receivedLen = 0; /* 已收到的分片负载长度 */
+        std::vector<Packet> pendingList; /* 首片到达前暂存的后续分片 */
+    };
+
+    /**
+     * @brief 工作线程
+     * @param shard 分片
+     */
+    void workerLoop(Shard* shard);
+
+    /**
+     * @brief 把数据包放入分片的队列
+     * @param index 分片索引
+     * @param flag 数据标志
+     * @param num 数据序号
+     * @param ntp 数据包接收时间点
+     * @param data 数据指针
+     * @param dataLen 数据长度
+     * @param dataSource 数据源
+     * @return 0-成功, 7-队列已满(丢弃)
+     */
+    int push(size_t index, size_t flag, size_t num, const std::chrono::steady_clock::time_point& ntp, const uint8_t* data,
+             uint32_t dataLen, const DataSource& dataSource);
+
+    /**
+     * @brief 清理超时的IP分片路由
+     * @param ntp 当前时间点
+     */
+    void cleanupFragmentRoute(const std::chrono::steady_clock::time_point& ntp);
+
+    /**
+     * @brief 删除IP分片路由
+     * @param route 路由
+     */
+    void eraseFragmentRoute(FragmentRoute* route);
+
+private:
+    ShardConfig m_shardCfg; /* 分片配置 */
+    const IpReassemblyConfig m_ipReassemblyCfg; /* IP分片重组配置 */
+    std::vector<std::unique_ptr<Shard>> m_shardList; /* 分片列表 */
+    std::atomic_bool m_running = {true}; /* 是否运行中 */
+    LruNode m_fragmentRouteLru; /* IP分片路由LRU链表头(需要在路由表之前定义) */
+    phmap::flat_hash_map<FragmentKey, std::unique_ptr<FragmentRoute>> m_fragmentRouteMap; /* IP分片路由表(只在分发线程中访问) */
+};
+} // namespace npacket
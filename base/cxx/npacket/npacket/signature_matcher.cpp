@@ -0,0 +1,330 @@
+#include "signature_matcher.h"
+
+#include <algorithm>
+#include <deque>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NPACKET_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define NPACKET_HAVE_SSE2 0
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace npacket
+{
+/**
+ * @brief 自动机最大状态数(状态转移表使用16位存储)
+ */
+static const size_t MAX_STATE_COUNT = 65535;
+
+#if NPACKET_HAVE_SSE2
+/**
+ * @brief 获取最低位的1所在的位置
+ */
+static inline uint32_t countTrailingZero(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(value);
+#endif
+}
+#endif
+
+void SignatureMatcher::clear()
+{
+    m_signatureList.clear();
+    compile();
+}
+
+bool SignatureMatcher::add(uint32_t id, const ProtocolSignature& sig)
+{
+    if (sig.pattern.empty() || (!sig.mask.empty() && sig.mask.size() != sig.pattern.size()))
+    {
+        return false;
+    }
+    Signature item;
+    item.id = id;
+    item.offset = sig.offset;
+    item.depth = sig.depth;
+    item.pattern = sig.pattern;
+    item.mask = sig.mask.empty() ? std::vector<uint8_t>(sig.pattern.size(), 0xFF) : sig.mask;
+    for (size_t i = 0; i < item.pattern.size(); ++i)
+    {
+        item.pattern[i] &= item.mask[i];
+    }
+    /* 取最长的无掩码字节段作为关键字 */
+    for (size_t i = 0; i < item.mask.size();)
+    {
+        if (0xFF != item.mask[i])
+        {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < item.mask.size() && 0xFF == item.mask[j])
+        {
+            ++j;
+        }
+        if (j - i > item.keyLen)
+        {
+            item.keyOffset = (uint32_t)i;
+            item.keyLen = (uint32_t)(j - i);
+        }
+        i = j;
+    }
+    m_signatureList.emplace_back(std::move(item));
+    return true;
+}
+
+void SignatureMatcher::compile()
+{
+    m_idList.clear();
+    m_directList.clear();
+    memset(m_byteClass, 0, sizeof(m_byteClass));
+    m_classCount = 1;
+    m_transTable.clear();
+    m_outputBegin.clear();
+    m_outputList.clear();
+    memset(m_startBitmap, 0, sizeof(m_startBitmap));
+    m_startByteList.clear();
+    m_scanEnd = 0;
+    m_maxAnchoredEnd = 0;
+    /* step1. 字节等价类: 关键字中出现的每个字节单独一类, 其余字节归为第0类 */
+    for (const auto& sig : m_signatureList)
+    {
+        m_idList.emplace_back(sig.id);
+        for (uint32_t i = 0; i < sig.keyLen; ++i)
+        {
+            const uint8_t b = sig.pattern[sig.keyOffset + i];
+            if (0 == m_byteClass[b])
+            {
+                m_byteClass[b] = (uint16_t)m_classCount++;
+            }
+        }
+    }
+    std::sort(m_idList.begin(), m_idList.end());
+    m_idList.erase(std::unique(m_idList.begin(), m_idList.end()), m_idList.end());
+    /* step2. 构建字典树 */
+    std::vector<int32_t> gotoTable(m_classCount, -1); /* -1表示没有子节点 */
+    std::vector<std::vector<uint32_t>> outputs(1);
+    for (uint32_t index = 0; index < (uint32_t)m_signatureList.size(); ++index)
+    {
+        auto& sig = m_signatureList[index];
+        if (sig.offset >= 0)
+        {
+            m_maxAnchoredEnd = std::max(m_maxAnchoredEnd, (uint32_t)sig.offset + (uint32_t)sig.pattern.size());
+        }
+        if (0 == sig.keyLen || outputs.size() + sig.keyLen > MAX_STATE_COUNT) /* 没有关键字(或状态数超限), 直接校验 */
+        {
+            sig.keyLen = 0;
+            m_directList.emplace_back(index);
+            continue;
+        }
+        size_t state = 0;
+        for (uint32_t i = 0; i < sig.keyLen; ++i)
+        {
+            const uint32_t cls = m_byteClass[sig.pattern[sig.keyOffset + i]];
+            if (gotoTable[state * m_classCount + cls] < 0)
+            {
+                gotoTable[state * m_classCount + cls] = (int32_t)outputs.size();
+                outputs.emplace_back();
+                gotoTable.resize(outputs.size() * m_classCount, -1);
+            }
+            state = (size_t)gotoTable[state * m_classCount + cls];
+        }
+        outputs[state].emplace_back(index);
+        const uint8_t first = sig.pattern[sig.keyOffset];
+        if (0 == (m_startBitmap[first >> 3] & (1 << (first & 7))))
+        {
+            m_startBitmap[first >> 3] |= (uint8_t)(1 << (first & 7));
+            m_startByteList.emplace_back(first);
+        }
+        const uint32_t start = (sig.offset >= 0) ? (uint32_t)sig.offset : sig.depth; /* 特征起始位置的最大值 */
+        m_scanEnd = std::max(m_scanEnd, start + sig.keyOffset + sig.keyLen);
+    }
+    /* step3. 广度优先计算失败指针, 并补全为确定性状态转移表, 同时合并失败链上的输出 */
+    const size_t stateCount = outputs.size();
+    m_transTable.assign(stateCount * m_classCount, 0);
+    std::vector<uint32_t> failList(stateCount, 0);
+    std::deque<uint32_t> queue;
+    for (uint32_t cls = 0; cls < m_classCount; ++cls)
+    {
+        const int32_t next = gotoTable[cls];
+        if (next > 0)
+        {
+            m_transTable[cls] = (uint16_t)next;
+            failList[next] = 0;
+            queue.emplace_back((uint32_t)next);
+        }
+    }
+    while (!queue.empty())
+    {
+        const uint32_t state = queue.front();
+        queue.pop_front();
+        const auto& failOutput = outputs[failList[state]];
+        outputs[state].insert(outputs[state].end(), failOutput.begin(), failOutput.end());
+        for (uint32_t cls = 0; cls < m_classCount; ++cls)
+        {
+            const int32_t next = gotoTable[state * m_classCount + cls];
+            if (next > 0)
+            {
+                failList[next] = m_transTable[failList[state] * m_classCount + cls];
+                m_transTable[state * m_classCount + cls] = (uint16_t)next;
+                queue.emplace_back((uint32_t)next);
+            }
+            else
+            {
+                m_transTable[state * m_classCount + cls] = m_transTable[failList[state] * m_classCount + cls];
+            }
+        }
+    }
+    m_outputBegin.reserve(stateCount + 1);
+    for (const auto& output : outputs)
+    {
+        m_outputBegin.emplace_back((uint32_t)m_outputList.size());
+        m_outputList.insert(m_outputList.end(), output.begin(), output.end());
+    }
+    m_outputBegin.emplace_back((uint32_t)m_outputList.size());
+    if (m_startByteList.size() > 8) /* 首字节太多时SIMD比较次数过多, 使用位图 */
+    {
+        m_startByteList.clear();
+    }
+}
+
+bool SignatureMatcher::contains(uint32_t id) const
+{
+    return std::binary_search(m_idList.begin(), m_idList.end(), id);
+}
+
+void SignatureMatcher::match(const uint8_t* data, uint32_t dataLen, std::vector<uint32_t>& idList) const
+{
+    idList.clear();
+    if (!data || 0 == dataLen)
+    {
+        return;
+    }
+    /* step1. 没有关键字的特征直接校验 */
+    for (auto index : m_directList)
+    {
+        const auto& sig = m_signatureList[index];
+        if (sig.offset >= 0)
+        {
+            if (verify(sig, data, dataLen, (uint32_t)sig.offset))
+            {
+                addId(sig.id, idList);
+            }
+            continue;
+        }
+        for (uint32_t start = 0; start <= sig.depth && start < dataLen; ++start)
+        {
+            if (verify(sig, data, dataLen, start))
+            {
+                addId(sig.id, idList);
+                break;
+            }
+        }
+    }
+    /* step2. 数据较短时, 固定偏移特征的关键字可能还没到达, 逐个校验已有的字节 */
+    if (dataLen < m_maxAnchoredEnd)
+    {
+        for (const auto& sig : m_signatureList)
+        {
+            if (sig.keyLen > 0 && sig.offset >= 0 && (uint32_t)sig.offset + sig.keyOffset + sig.keyLen > dataLen
+                && verify(sig, data, dataLen, (uint32_t)sig.offset))
+            {
+                addId(sig.id, idList);
+            }
+        }
+    }
+    /* step3. 自动机扫描关键字, 命中后校验完整特征 */
+    const uint32_t end = std::min(dataLen, m_scanEnd);
+    uint32_t state = 0;
+    for (uint32_t i = 0; i < end; ++i)
+    {
+        if (0 == state)
+        {
+            i = skipToStartByte(data, i, end);
+            if (i >= end)
+            {
+                break;
+            }
+        }
+        state = m_transTable[state * m_classCount + m_byteClass[data[i]]];
+        for (uint32_t k = m_outputBegin[state]; k < m_outputBegin[state + 1]; ++k)
+        {
+            const auto& sig = m_signatureList[m_outputList[k]];
+            const uint32_t keyStart = i + 1 - sig.keyLen;
+            if (keyStart < sig.keyOffset)
+            {
+                continue;
+            }
+            const uint32_t start = keyStart - sig.keyOffset;
+            if ((sig.offset >= 0 ? (start == (uint32_t)sig.offset) : (start <= sig.depth)) && verify(sig, data, dataLen, start))
+            {
+                addId(sig.id, idList);
+            }
+        }
+    }
+}
+
+bool SignatureMatcher::verify(const Signature& sig, const uint8_t* data, uint32_t dataLen, uint32_t start)
+{
+    if (start >= dataLen)
+    {
+        return false;
+    }
+    const uint32_t len = std::min((uint32_t)sig.pattern.size(), dataLen - start); /* 数据不足时只比较已有的字节 */
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if ((data[start + i] & sig.mask[i]) != sig.pattern[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t SignatureMatcher::skipToStartByte(const uint8_t* data, uint32_t pos, uint32_t end) const
+{
+#if NPACKET_HAVE_SSE2
+    if (!m_startByteList.empty())
+    {
+        while (pos + 16 <= end)
+        {
+            const __m128i block = _mm_loadu_si128((const __m128i*)(data + pos));
+            __m128i hit = _mm_setzero_si128();
+            for (auto b : m_startByteList)
+            {
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, _mm_set1_epi8((char)b)));
+            }
+            const uint32_t bits = (uint32_t)_mm_movemask_epi8(hit);
+            if (0 != bits)
+            {
+                return pos + countTrailingZero(bits);
+            }
+            pos += 16;
+        }
+    }
+#endif
+    while (pos < end && 0 == (m_startBitmap[data[pos] >> 3] & (1 << (data[pos] & 7))))
+    {
+        ++pos;
+    }
+    return pos;
+}
+
+void SignatureMatcher::addId(uint32_t id, std::vector<uint32_t>& idList)
+{
+    if (idList.end() == std::find(idList.begin(), idList.end(), id))
+    {
+        idList.emplace_back(id);
+    }
+}
+} // namespace npacket
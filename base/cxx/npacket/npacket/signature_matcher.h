@@ -0,0 +1,104 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "protocol_parser.h"
+
+namespace npacket
+{
+/**
+ * @brief 协议特征匹配器(所有特征编译成一个多模式匹配器): 每个特征取最长的无掩码字节段作为关键字,
+ *        所有关键字构建Aho-Corasick自动机(字节先映射为等价类以压缩状态表), 扫描时在初始状态下先用首字节集合跳过
+ *        不可能命中的字节(支持SSE2时每次比较16字节), 关键字命中后再按偏移和掩码校验完整特征,
+ *        注意: 编译后只读, 匹配接口可以多线程同时调用
+ */
+class SignatureMatcher final
+{
+public:
+    /**
+     * @brief 清空所有特征
+     */
+    void clear();
+
+    /**
+     * @brief 添加特征(添加完成后需要调用compile)
+     * @param id 标识(一般为协议类型), 同一标识可以添加多个特征, 任意一个命中即可
+     * @param sig 特征
+     * @return true-成功, false-特征无效(为空或掩码长度不一致)
+     */
+    bool add(uint32_t id, const ProtocolSignature& sig);
+
+    /**
+     * @brief 编译
+     */
+    void compile();
+
+    /**
+     * @brief 是否包含指定标识的特征
+     * @param id 标识
+     * @return true-包含, false-不包含
+     */
+    bool contains(uint32_t id) const;
+
+    /**
+     * @brief 匹配(负载长度不足时, 只要已有的字节符合也算命中, 因为后续数据可能还没到达, 但任意位置的特征要求关键字完整出现)
+     * @param data 数据
+     * @param dataLen 数据长度
+     * @param idList [输出]命中的标识列表(不重复)
+     */
+    void match(const uint8_t* data, uint32_t dataLen, std::vector<uint32_t>& idList) const;
+
+private:
+    /**
+     * @brief 特征(编译后)
+     */
+    struct Signature
+    {
+        uint32_t id = 0; /* 标识 */
+        int32_t offset = 0; /* 偏移, 小于0表示任意位置 */
+        uint32_t depth = 0; /* 搜索深度 */
+        std::vector<uint8_t> pattern; /* 特征字节(已和掩码相与) */
+        std::vector<uint8_t> mask; /* 掩码 */
+        uint32_t keyOffset = 0; /* 关键字在特征中的偏移 */
+        uint32_t keyLen = 0; /* 关键字长度, 0表示没有无掩码字节(不参与自动机, 每次直接校验) */
+    };
+
+    /**
+     * @brief 校验特征
+     * @param sig 特征
+     * @param data 数据
+     * @param dataLen 数据长度
+     * @param start 特征在数据中的起始位置
+     * @return true-命中, false-未命中
+     */
+    static bool verify(const Signature& sig, const uint8_t* data, uint32_t dataLen, uint32_t start);
+
+    /**
+     * @brief 在初始状态下跳到下一个可能是关键字首字节的位置
+     * @param data 数据
+     * @param pos 起始位置
+     * @param end 结束位置
+     * @return 位置, 等于end表示没有
+     */
+    uint32_t skipToStartByte(const uint8_t* data, uint32_t pos, uint32_t end) const;
+
+    /**
+     * @brief 添加命中的标识(去重)
+     */
+    static void addId(uint32_t id, std::vector<uint32_t>& idList);
+
+private:
+    std::vector<Signature> m_signatureList; /* 特征列表 */
+    std::vector<uint32_t> m_idList; /* 所有标识(有序) */
+    std::vector<uint32_t> m_directList; /* 没有关键字的特征(每次直接校验) */
+    uint16_t m_byteClass[256] = {0}; /* 字节等价类(0-不在任何关键字中出现, 最多257类, 需要16位) */
+    uint32_t m_classCount = 1; /* 等价类数量 */
+    std::vector<uint16_t> m_transTable; /* 状态转移表(状态 * 等价类数量 + 等价类) */
+    std::vector<uint32_t> m_outputBegin; /* 每个状态命中的关键字列表起始位置(长度为状态数量+1) */
+    std::vector<uint32_t> m_outputList; /* 命中的特征序号 */
+    uint8_t m_startBitmap[32] = {0}; /* 关键字首字节集合 */
+    std::vector<uint8_t> m_startByteList; /* 关键字首字节列表(数量不超过8时使用SIMD跳过) */
+    uint32_t m_scanEnd = 0; /* 扫描结束位置(所有特征可能出现的最大结束位置) */
+    uint32_t m_maxAnchoredEnd = 0; /* 固定偏移特征的最大结束位置(数据短于此值时需要逐个校验) */
+};
+} // namespace npacket
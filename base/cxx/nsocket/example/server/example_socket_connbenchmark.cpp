@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../nsocket/tcp/tcp_server.h"
+
+/**
+ * @brief 压测结果
+ */
+struct BenchResult
+{
+    size_t connCount = 0; /* 服务端完成的连接数(非TLS为新连接回调次数, TLS为握手成功回调次数) */
+    size_t failCount = 0; /* 失败次数(客户端连接/握手失败, 服务端握手失败) */
+    double connPerSec = 0; /* 每秒连接数 */
+    std::vector<size_t> threadConnList; /* 各个服务端线程处理的连接数 */
+};
+
+/**
+ * @brief 压测统计
+ */
+struct BenchStat
+{
+    void add(bool ok)
+    {
+        if (ok)
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            ++threadConnMap[std::this_thread::get_id()];
+        }
+        if ((ok ? ++connCount + failCount : ++failCount + connCount) >= totalCount)
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            cv.notify_all();
+        }
+    }
+
+    size_t totalCount = 0;
+    std::atomic<size_t> connCount = {0};
+    std::atomic<size_t> failCount = {0};
+    std::map<std::thread::id, size_t> threadConnMap;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+/**
+ * @brief 客户端关闭连接
+ * @param socket 套接字
+ * @param reset 是否发送RST(避免大量TIME_WAIT耗尽本地端口), TLS连接不能使用, 否则服务端可能未读取客户端的Finished就被重置
+ */
+static void closeSocket(boost::asio::ip::tcp::socket& socket, bool reset)
+{
+    boost::system::error_code code;
+    if (reset)
+    {
+        socket.set_option(boost::asio::socket_base::linger(true, 0), code);
+    }
+    socket.close(code);
+}
+
+/**
+ * @brief 客户端线程: 以阻塞方式反复建立连接(和TLS握手)后立即关闭
+ */
+static void clientLoop(BenchStat& stat, uint16_t port, bool sslOn, size_t connCount)
+{
+    boost::asio::io_context ioContext;
+    const boost::asio::ip::tcp::endpoint point(boost::asio::ip::make_address("127.0.0.1"), port);
+#if (1 == ENABLE_NSOCKET_OPENSSL)
+    boost::asio::ssl::context sslContext(boost::asio::ssl::context::sslv23_client);
+    sslContext.set_verify_mode(boost::asio::ssl::verify_none);
+#endif
+    for (size_t i = 0; i < connCount; ++i)
+    {
+        boost::system::error_code code;
+#if (1 == ENABLE_NSOCKET_OPENSSL)
+        if (sslOn)
+        {
+            boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream(ioContext, sslContext);
+            stream.lowest_layer().connect(point, code);
+            if (!code)
+            {
+                stream.handshake(boost::asio::ssl::stream_base::client, code);
+            }
+            if (code)
+            {
+                stat.add(false);
+            }
+            closeSocket(stream.next_layer(), false);
+            continue;
+        }
+#endif
+        boost::asio::ip::tcp::socket socket(ioContext);
+        socket.connect(point, code);
+        if (code)
+        {
+            stat.add(false);
+        }
+        closeSocket(socket, true);
+    }
+}
+
+/**
+ * @brief 回环压测: 多个客户端线程同时建立短连接, 服务端统计每秒完成的连接数
+ */
+static BenchResult bench(bool reusePort, bool sslOn, uint16_t port, size_t serverThreads, size_t clientThreads, size_t connCount,
+                         const std::string& certFile, const std::string& pkFile, const std::string& pkPwd)
+{
+    BenchStat stat;
+    stat.totalCount = clientThreads * connCount;
+    auto server = std::make_shared<nsocket::TcpServer>("bench", serverThreads, "127.0.0.1", port, true);
+    server->setReusePortAcceptors(reusePort);
+    if (sslOn)
+    {
+        server->setHandshakeOkCallback([&](const std::weak_ptr<nsocket::TcpConnection>& wpConn) { stat.add(true); });
+        server->setHandshakeFailCallback(
+            [&](uint64_t cid, const boost::asio::ip::tcp::endpoint& point, const boost::system::error_code& code) { stat.add(false); });
+    }
+    else
+    {
+        server->setNewConnectionCallback([&](const std::weak_ptr<nsocket::TcpConnection>& wpConn) { stat.add(true); });
+    }
+    std::string errorMsg;
+    if (!server->run(sslOn, 1, 2, certFile, pkFile, pkPwd, &errorMsg))
+    {
+        printf("server run fail: %s\n", errorMsg.c_str());
+        exit(1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); /* 等待服务端线程启动 */
+    const auto tp1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threadList;
+    for (size_t i = 0; i < clientThreads; ++i)
+    {
+        threadList.emplace_back([&] { clientLoop(stat, port, sslOn, connCount); });
+    }
+    for (auto& th : threadList)
+    {
+        th.join();
+    }
+    {
+        /* 等待服务端处理完所有连接, 最多再等待1秒 */
+        std::unique_lock<std::mutex> locker(stat.mutex);
+        stat.cv.wait_for(locker, std::chrono::seconds(1), [&] { return stat.connCount + stat.failCount >= stat.totalCount; });
+    }
+    const auto tp2 = std::chrono::steady_clock::now();
+    server->stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); /* 等待连接线程中的回调执行完毕, 避免在回调线程中销毁服务端 */
+    BenchResult result;
+    result.connCount = stat.connCount;
+    result.failCount = stat.failCount;
+    result.connPerSec = result.connCount / std::chrono::duration<double>(tp2 - tp1).count();
+    {
+        std::lock_guard<std::mutex> locker(stat.mutex);
+        for (const auto& item : stat.threadConnMap)
+        {
+            result.threadConnList.emplace_back(item.second);
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    printf("*************************************************************************************************************\n");
+    printf("** 说明: TCP服务端每秒建立连接数压测(回环), 对比单接收器和SO_REUSEPORT多接收器, 非TLS和TLS.                **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 选项:                                                                                                   **\n");
+    printf("**                                                                                                         **\n");
+    printf("** [-p 端口]           监听端口, 默认4446.                                                                 **\n");
+    printf("** [-st 线程数]        服务端连接线程数, 默认为CPU核数.                                                    **\n");
+    printf("** [-ct 线程数]        客户端线程数, 默认为CPU核数.                                                        **\n");
+    printf("** [-n 连接数]         每个客户端线程的连接数, 默认2000.                                                   **\n");
+    printf("** [-cf 证书文件]      服务端证书文件(PEM格式), 不指定则不测试TLS.                                         **\n");
+    printf("** [-pk 私钥文件]      服务端私钥文件(PEM格式).                                                            **\n");
+    printf("** [-pkp 私钥密码]     服务端私钥文件密码.                                                                 **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 示例:                                                                                                   **\n");
+    printf("**       example_nsocket_connbenchmark -cf server.crt -pk server.key -pkp qq123456                        **\n");
+    printf("**                                                                                                         **\n");
+    printf("*************************************************************************************************************\n");
+    printf("\n");
+    uint16_t port = 4446;
+    size_t serverThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    size_t clientThreads = serverThreads;
+    size_t connCount = 2000;
+    std::string certFile, pkFile, pkPwd;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        if ("-p" == key)
+        {
+            port = (uint16_t)atoi(argv[i + 1]);
+        }
+        else if ("-st" == key)
+        {
+            serverThreads = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-ct" == key)
+        {
+            clientThreads = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-n" == key)
+        {
+            connCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-cf" == key)
+        {
+            certFile = argv[i + 1];
+        }
+        else if ("-pk" == key)
+        {
+            pkFile = argv[i + 1];
+        }
+        else if ("-pkp" == key)
+        {
+            pkPwd = argv[i + 1];
+        }
+    }
+#ifndef SO_REUSEPORT
+    printf("warning: SO_REUSEPORT is not supported on this platform, reuseport mode falls back to single acceptor\n");
+#endif
+    printf("loopback port: %d, server threads: %zu, client threads: %zu, connections per client: %zu\n", (int)port, serverThreads,
+           clientThreads, connCount);
+    printf("%-6s %-10s %12s %8s %12s  %s\n", "tls", "acceptor", "connections", "fails", "conn/sec", "per server thread");
+    std::vector<bool> sslList = {false};
+#if (1 == ENABLE_NSOCKET_OPENSSL)
+    if (!certFile.empty() && !pkFile.empty())
+    {
+        sslList.emplace_back(true);
+    }
+#endif
+    for (auto sslOn : sslList)
+    {
+        for (auto reusePort : {false, true})
+        {
+            auto result = bench(reusePort, sslOn, port, serverThreads, clientThreads, connCount, certFile, pkFile, pkPwd);
+            std::string perThread;
+            for (auto count : result.threadConnList)
+            {
+                perThread += (perThread.empty() ? "" : " ") + std::to_string(count);
+            }
+            printf("%-6s %-10s %12zu %8zu %12.0f  %s\n", sslOn ? "on" : "off", reusePort ? "reuseport" : "single", result.connCount,
+                   result.failCount, result.connPerSec, perThread.c_str());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../../nsocket/frame_decoder.h"
+#include "../../nsocket/payload.h"
+
+/**
+ * @brief 统计内存分配次数(替换全局operator new)
+ */
+static std::atomic<size_t> s_allocCount{0};
+
+void* operator new(size_t size)
+{
+    ++s_allocCount;
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept
+{
+    free(ptr);
+}
+
+static const size_t FRAME_SIZE = 32; /* 帧长度 */
+static const size_t READ_SIZE = 1024 * 1024; /* 每次读取的数据长度 */
+
+/**
+ * @brief 压测结果
+ */
+struct BenchResult
+{
+    size_t frames = 0; /* 解析出的帧数量 */
+    double framesPerSec = 0; /* 每秒帧数 */
+    double allocPerFrame = 0; /* 每帧内存分配次数 */
+};
+
+/**
+ * @brief 生成数据流
+ * @param type 分帧方式
+ * @param frameCount 帧数量
+ * @return 数据流
+ */
+static std::vector<unsigned char> makeStream(nsocket::FrameType type, size_t frameCount)
+{
+    std::vector<unsigned char> stream(FRAME_SIZE * frameCount);
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        unsigned char* frame = stream.data() + i * FRAME_SIZE;
+        memset(frame, 'a' + (int)(i % 26), FRAME_SIZE);
+        if (nsocket::FrameType::length == type) /* 4字节大端包体长度 + 28字节包体 */
+        {
+            const uint32_t bodyLen = FRAME_SIZE - 4;
+            frame[0] = (unsigned char)(bodyLen >> 24);
+            frame[1] = (unsigned char)(bodyLen >> 16);
+            frame[2] = (unsigned char)(bodyLen >> 8);
+            frame[3] = (unsigned char)bodyLen;
+        }
+        else if (nsocket::FrameType::delimiter == type) /* 30字节包体 + "\r\n" */
+        {
+            frame[FRAME_SIZE - 2] = '\r';
+            frame[FRAME_SIZE - 1] = '\n';
+        }
+    }
+    return stream;
+}
+
+/**
+ * @brief 按READ_SIZE分块喂数据(第1块少13字节, 使后续每块的边界都落在帧中间)
+ * @param stream 数据流
+ * @param feed 喂数据函数
+ */
+template<typename Func>
+static void feedStream(const std::vector<unsigned char>& stream, const Func& feed)
+{
+    size_t offset = 0;
+    size_t chunkLen = READ_SIZE - 13;
+    while (offset < stream.size())
+    {
+        const size_t len = std::min(chunkLen, stream.size() - offset);
+        feed(stream.data() + offset, len);
+        offset += len;
+        chunkLen = READ_SIZE;
+    }
+}
+
+/**
+ * @brief 压测帧解码器
+ * @param type 分帧方式
+ * @param readCount 读取次数
+ * @return 压测结果
+ */
+static BenchResult benchDecoder(nsocket::FrameType type, size_t readCount)
+{
+    const size_t frameCount = readCount * READ_SIZE / FRAME_SIZE;
+    const auto stream = makeStream(type, frameCount);
+    nsocket::FrameConfig cfg;
+    cfg.type = type;
+    cfg.fixedLen = FRAME_SIZE;
+    nsocket::FrameDecoder decoder(cfg);
+    BenchResult result;
+    size_t checksum = 0;
+    const size_t allocCount = s_allocCount;
+    const auto tp = std::chrono::steady_clock::now();
+    feedStream(stream, [&](const unsigned char* data, size_t len) {
+        decoder.decode(data, len, [&](const unsigned char* head, size_t headLen, const unsigned char* body, size_t bodyLen) {
+            checksum += body[0] + bodyLen;
+            ++result.frames;
+        });
+    });
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    result.framesPerSec = result.frames / sec;
+    result.allocPerFrame = (double)(s_allocCount - allocCount) / std::max<size_t>(result.frames, 1);
+    if (0 == checksum)
+    {
+        printf("checksum error\n");
+    }
+    return result;
+}
+
+/**
+ * @brief 压测旧接口Payload::unpack(每帧拷贝包头/包体到新的vector, 每帧从接收缓冲区头部删除数据)
+ * @param readCount 读取次数
+ * @return 压测结果
+ */
+static BenchResult benchPayload(size_t readCount)
+{
+    const size_t frameCount = readCount * READ_SIZE / FRAME_SIZE;
+    const auto stream = makeStream(nsocket::FrameType::length, frameCount);
+    nsocket::Payload payload(4);
+    BenchResult result;
+    size_t checksum = 0;
+    const size_t allocCount = s_allocCount;
+    const auto tp = std::chrono::steady_clock::now();
+    feedStream(stream, [&](const unsigned char* data, size_t len) {
+        std::vector<unsigned char> chunk(data, data + len); /* 旧接口的数据回调参数为vector */
+        payload.unpack(
+            chunk,
+            [&](const std::vector<unsigned char>& head) {
+                return (int)(((uint32_t)head[0] << 24) | ((uint32_t)head[1] << 16) | ((uint32_t)head[2] << 8) | head[3]);
+            },
+            [&](const std::vector<unsigned char>& body) {
+                checksum += body[0] + body.size();
+                ++result.frames;
+            });
+    });
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    result.framesPerSec = result.frames / sec;
+    result.allocPerFrame = (double)(s_allocCount - allocCount) / std::max<size_t>(result.frames, 1);
+    if (0 == checksum)
+    {
+        printf("checksum error\n");
+    }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t readCount = 64;
+    size_t payloadReadCount = 2; /* 旧接口拆包为O(n^2), 只读取少量数据 */
+    if (argc > 1)
+    {
+        readCount = std::max<size_t>(1, atoll(argv[1]));
+    }
+    if (argc > 2)
+    {
+        payloadReadCount = std::max<size_t>(1, atoll(argv[2]));
+    }
+    printf("frame size: %zu bytes, read size: %zu bytes, reads: %zu (payload: %zu)\n", FRAME_SIZE, READ_SIZE, readCount,
+           payloadReadCount);
+    printf("%-12s %12s %16s %14s\n", "decoder", "frames", "frames/sec", "allocs/frame");
+    const std::vector<std::pair<nsocket::FrameType, const char*>> typeList = {
+        {nsocket::FrameType::length, "length"}, {nsocket::FrameType::fixed, "fixed"}, {nsocket::FrameType::delimiter, "delimiter"}};
+    for (const auto& type : typeList)
+    {
+        auto result = benchDecoder(type.first, readCount);
+        printf("%-12s %12zu %16.0f %14.4f\n", type.second, result.frames, result.framesPerSec, result.allocPerFrame);
+    }
+    auto result = benchPayload(payloadReadCount);
+    printf("%-12s %12zu %16.0f %14.4f\n", "payload", result.frames, result.framesPerSec, result.allocPerFrame);
+    return 0;
+}
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../nsocket/ftp/client.h"
+#include "../../nsocket/ftp/server.h"
+
+static const size_t MB = 1024 * 1024;
+static const size_t BLOCK_SIZE = 4 * MB; /* 生成/比较文件时每次读写的长度 */
+
+/**
+ * @brief 生成测试文件(伪随机内容)
+ * @param path 路径
+ * @param size 大小(字节)
+ * @return true-成功, false-失败
+ */
+static bool makeFile(const std::string& path, uint64_t size)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f)
+    {
+        return false;
+    }
+    std::vector<uint64_t> block(BLOCK_SIZE / sizeof(uint64_t));
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint64_t written = 0;
+    bool ok = true;
+    while (ok && written < size)
+    {
+        for (auto& value : block) /* xorshift64 */
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            value = seed;
+        }
+        const size_t len = (size_t)std::min<uint64_t>(BLOCK_SIZE, size - written);
+        ok = (fwrite(block.data(), 1, len, f) == len);
+        written += len;
+    }
+    fclose(f);
+    return ok;
+}
+
+/**
+ * @brief 比较文件内容是否相同
+ * @param path1 路径1
+ * @param path2 路径2
+ * @return true-相同, false-不同
+ */
+static bool compareFile(const std::string& path1, const std::string& path2)
+{
+    FILE* f1 = fopen(path1.c_str(), "rb");
+    FILE* f2 = fopen(path2.c_str(), "rb");
+    bool same = (f1 && f2);
+    std::vector<char> buf1(BLOCK_SIZE), buf2(BLOCK_SIZE);
+    while (same)
+    {
+        const auto len1 = fread(buf1.data(), 1, buf1.size(), f1);
+        const auto len2 = fread(buf2.data(), 1, buf2.size(), f2);
+        same = (len1 == len2 && 0 == memcmp(buf1.data(), buf2.data(), len1));
+        if (0 == len1)
+        {
+            break;
+        }
+    }
+    if (f1)
+    {
+        fclose(f1);
+    }
+    if (f2)
+    {
+        fclose(f2);
+    }
+    return same;
+}
+
+/**
+ * @brief 截断文件
+ * @param path 路径
+ * @param size 大小(字节)
+ * @return true-成功, false-失败
+ */
+static bool truncateFile(const std::string& path, uint64_t size)
+{
+#ifdef _WIN32
+    FILE* f = fopen(path.c_str(), "r+b");
+    if (!f)
+    {
+        return false;
+    }
+    const bool ok = (0 == _chsize_s(_fileno(f), (__int64)size));
+    fclose(f);
+    return ok;
+#else
+    return 0 == truncate(path.c_str(), (off_t)size);
+#endif
+}
+
+/**
+ * @brief 测试客户端(在后台线程中运行I/O循环)
+ */
+class BenchClient
+{
+public:
+    BenchClient(uint16_t port) : m_client(std::make_shared<nsocket::ftp::Client>())
+    {
+        auto client = m_client;
+        m_thread = std::thread([client, port]() { client->run("127.0.0.1", port); });
+    }
+
+    ~BenchClient()
+    {
+        m_client->quit();
+        m_thread.join();
+    }
+
+    /**
+     * @brief 登录(等待连接建立)
+     * @return true-成功, false-失败
+     */
+    bool login()
+    {
+        for (int i = 0; i < 30; ++i)
+        {
+            if (m_client->login("bench", "bench"))
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        return false;
+    }
+
+    std::shared_ptr<nsocket::ftp::Client> operator->()
+    {
+        return m_client;
+    }
+
+private:
+    std::shared_ptr<nsocket::ftp::Client> m_client;
+    std::thread m_thread;
+};
+
+/**
+ * @brief 打印传输结果
+ * @param name 名称
+ * @param ok 是否成功
+ * @param bytes 传输字节数
+ * @param tp 开始时间
+ * @param verified 内容校验是否通过
+ */
+static void printResult(const char* name, bool ok, uint64_t bytes, const std::chrono::steady_clock::time_point& tp, bool verified)
+{
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    printf("%-16s %-6s %12.1f %10.2f %12.1f  %s\n", name, ok ? "ok" : "fail", (double)bytes / MB, sec, (double)bytes / MB / sec,
+           verified ? "verified" : "MISMATCH");
+}
+
+int main(int argc, char* argv[])
+{
+    printf("*************************************************************************************************************\n");
+    printf("** 说明: FTP回环传输压测, 测试RETR(sendfile), STOR(大缓冲区写入), REST断点续传和限速.                      **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 选项:                                                                                                   **\n");
+    printf("**                                                                                                         **\n");
+    printf("** [-p 端口]           监听端口, 默认4447.                                                                 **\n");
+    printf("** [-d 目录]           测试目录(服务端根路径), 默认ftpbench, 测试结束后删除测试文件.                       **\n");
+    printf("** [-s 大小]           测试文件大小(MB), 默认2048.                                                         **\n");
+    printf("** [-b 大小]           服务端上传文件缓冲区大小(MB), 默认4.                                                **\n");
+    printf("** [-dw 0/1]           服务端上传文件是否使用O_DIRECT写入, 默认0.                                          **\n");
+    printf("** [-r 速率]           限速测试的速率(MB/s), 默认0(不测试).                                                **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 示例:                                                                                                   **\n");
+    printf("**       example_nsocket_ftpbenchmark -s 4096 -dw 1 -r 50                                                  **\n");
+    printf("**                                                                                                         **\n");
+    printf("*************************************************************************************************************\n");
+    printf("\n");
+    uint16_t port = 4447;
+    std::string dir = "ftpbench";
+    uint64_t sizeMb = 2048;
+    size_t bufferMb = 4;
+    bool directWrite = false;
+    size_t rateMb = 0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        if ("-p" == key)
+        {
+            port = (uint16_t)atoi(argv[i + 1]);
+        }
+        else if ("-d" == key)
+        {
+            dir = argv[i + 1];
+        }
+        else if ("-s" == key)
+        {
+            sizeMb = std::max(atoll(argv[i + 1]), 1LL);
+        }
+        else if ("-b" == key)
+        {
+            bufferMb = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-dw" == key)
+        {
+            directWrite = (0 != atoi(argv[i + 1]));
+        }
+        else if ("-r" == key)
+        {
+            rateMb = std::max(atoi(argv[i + 1]), 0);
+        }
+    }
+#ifdef _WIN32
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
+    const uint64_t fileSize = sizeMb * MB;
+    const std::string srcPath = dir + "/src.bin", downPath = dir + "/down.bin", upPath = dir + "/up.bin", ratePath = dir + "/rate.bin";
+    printf("generating %s (%llu MB) ...\n", srcPath.c_str(), (unsigned long long)sizeMb);
+    if (!makeFile(srcPath, fileSize))
+    {
+        printf("generate file fail\n");
+        return 1;
+    }
+    nsocket::ftp::TransferConfig cfg;
+    cfg.fileBufferSize = bufferMb * MB;
+    cfg.directWrite = directWrite;
+    auto server = std::make_shared<nsocket::ftp::Server>("ftp_bench", 2, "127.0.0.1", port, true);
+    server->setRootPath(dir);
+    server->setTransferConfig(cfg);
+    server->setLoginCallback([](const std::string& user, const std::string& password, nsocket::ftp::Permission& permission) {
+        permission = nsocket::ftp::Permission::All; /* 需要测试上传 */
+        return ("bench" == user && "bench" == password);
+    });
+    std::string errDesc;
+    if (!server->run(false, 1, 2, "", "", "", &errDesc))
+    {
+        printf("server run fail: %s\n", errDesc.c_str());
+        return 1;
+    }
+    printf("loopback port: %d, file buffer: %zu MB, direct write: %s\n", (int)port, bufferMb, directWrite ? "on" : "off");
+    printf("%-16s %-6s %12s %10s %12s  %s\n", "transfer", "result", "MB", "sec", "MB/s", "content");
+    {
+        BenchClient client(port);
+        if (!client.login())
+        {
+            printf("login fail\n");
+            return 1;
+        }
+        uint64_t bytes = 0;
+        /* 1.下载(RETR) */
+        auto tp = std::chrono::steady_clock::now();
+        bool ok = client->download("/src.bin", downPath, 0, &bytes);
+        printResult("RETR", ok, bytes, tp, compareFile(srcPath, downPath));
+        /* 2.上传(STOR) */
+        tp = std::chrono::steady_clock::now();
+        ok = client->upload(downPath, "/up.bin", 0, &bytes);
+        printResult("STOR", ok, bytes, tp, compareFile(srcPath, upPath));
+        /* 3.断点续传下载(REST + RETR), 偏移不按块对齐 */
+        const uint64_t offset = fileSize / 2 + 123;
+        truncateFile(downPath, offset);
+        tp = std::chrono::steady_clock::now();
+        ok = client->download("/src.bin", downPath, offset, &bytes);
+        printResult("REST+RETR", ok, bytes, tp, compareFile(srcPath, downPath));
+        /* 4.断点续传上传(REST + STOR) */
+        truncateFile(upPath, offset);
+        tp = std::chrono::steady_clock::now();
+        ok = client->upload(downPath, "/up.bin", offset, &bytes);
+        printResult("REST+STOR", ok, bytes, tp, compareFile(srcPath, upPath));
+        printf("SIZE /src.bin: %lld\n", (long long)client->size("/src.bin"));
+    }
+    /* 5.限速下载(限速只对之后建立的会话有效) */
+    if (rateMb > 0)
+    {
+        cfg.rateLimit = rateMb * MB;
+        server->setTransferConfig(cfg);
+        makeFile(ratePath, rateMb * MB * 3);
+        BenchClient client(port);
+        if (client.login())
+        {
+            uint64_t bytes = 0;
+            const auto tp = std::chrono::steady_clock::now();
+            const bool ok = client->download("/rate.bin", downPath, 0, &bytes);
+            printResult(("RETR@" + std::to_string(rateMb) + "MB/s").c_str(), ok, bytes, tp, compareFile(ratePath, downPath));
+        }
+    }
+    server->stop();
+    remove(srcPath.c_str());
+    remove(downPath.c_str());
+    remove(upPath.c_str());
+    remove(ratePath.c_str());
+    return 0;
+}
@@ -14,6 +14,7 @@ int main(int argc, char* argv[])
     printf("** [-s]                   server address, default: 0.0.0.0                                               **\n");
     printf("** [-p]                   server port, default: 21                                                       **\n");
     printf("** [-d]                   file dir, default: program directory                                           **\n");
+    printf("** [-w]                   write permission [0-read only, 1-all], default: 0                              **\n");
 #if (1 == ENABLE_NSOCKET_OPENSSL)
     printf("** [-tls]                 specify enable ssl [0-disable, 1-enable]. default: 0                           **\n");
     printf("** [-way]                 specify ssl way verify [1, 2], default: 1                                      **\n");
@@ -28,6 +29,7 @@ int main(int argc, char* argv[])
     std::string serverHost;
     int serverPort = 0;
     std::string rootPath;
+    int writable = 0;
     int sslOn = 0;
     int sslWay = 1;
     int certFmt = 2;
@@ -64,6 +66,15 @@ int main(int argc, char* argv[])
                 ++i;
             }
         }
+        else if (0 == strcmp(key, "-w")) /* 写权限 */
+        {
+            ++i;
+            if (i < argc)
+            {
+                writable = atoi(argv[i]);
+                ++i;
+            }
+        }
 #if (1 == ENABLE_NSOCKET_OPENSSL)
         else if (0 == strcmp(key, "-tls")) /* 是否启用TLS */
         {
@@ -172,6 +183,11 @@ int main(int argc, char* argv[])
     }
     auto server = std::make_shared<nsocket::ftp::Server>("ftp_server", 10, serverHost, serverPort);
     server->setRootPath(rootPath);
+    server->setLoginCallback([writable](const std::string& user, const std::string& password, nsocket::ftp::Permission& permission) {
+        printf("user [%s] login\n", user.c_str());
+        permission = (1 == writable) ? nsocket::ftp::Permission::All : nsocket::ftp::Permission::ReadOnly; /* 允许任意用户登录 */
+        return true;
+    });
     /* 注意: 最好增加异常捕获, 因为当密码不对时会抛异常 */
     try
     {
@@ -498,6 +498,30 @@ int main(int argc, char* argv[])
         };
         server->addRouter({nsocket::http::Method::POST}, {"/multi"}, r);
     }
+    {
+        auto r = std::make_shared<nsocket::http::Router_simple>();
+        r->respHandler = [&](uint64_t cid, const nsocket::http::REQUEST_PTR& req, const std::string& data,
+                             const nsocket::http::Connector& conn) {
+            printf("-------------------------- Param Router --------------------------\n");
+            printf("---     Uri: %s\n", req->uri.c_str());
+            printf("--- Params:\n");
+            for (auto iter = req->params.begin(); req->params.end() != iter; ++iter)
+            {
+                printf("             %s: %s\n", iter->first.c_str(), iter->second.c_str());
+            }
+            printf("--------------------------------------------------------------------\n");
+            std::string result = "{\"code\":0,\"msg\":\"ok\",\"data\":{";
+            for (auto iter = req->params.begin(); req->params.end() != iter; ++iter)
+            {
+                result += (req->params.begin() == iter ? "\"" : ",\"") + iter->first + "\":\"" + iter->second + "\"";
+            }
+            result += "}}";
+            auto resp = nsocket::http::makeResponse200();
+            resp->body.insert(resp->body.end(), result.begin(), result.end());
+            conn.sendAndClose(resp->pack());
+        };
+        server->addRouter({nsocket::http::Method::GET}, {"/api/dev/{id}/state", "/static/{path*}"}, r);
+    }
     try
     {
         if (1 == sslOn && !certFile.empty() && !pkFile.empty())
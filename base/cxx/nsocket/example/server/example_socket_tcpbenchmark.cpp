@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../nsocket/tcp/tcp_server.h"
+
+/**
+ * @brief 统计内存分配次数(替换全局operator new)
+ */
+static std::atomic<size_t> s_allocCount{0};
+
+void* operator new(size_t size)
+{
+    ++s_allocCount;
+    void* ptr = malloc(size > 0 ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept
+{
+    free(ptr);
+}
+
+/**
+ * @brief 接收模式
+ */
+enum class RecvMode
+{
+    copy, /* 旧接口: 每次接收拷贝到新分配的vector */
+    view, /* 零拷贝接口 */
+    buffer, /* 缓冲区池接口 */
+};
+
+/**
+ * @brief 压测结果
+ */
+struct BenchResult
+{
+    double mbPerSec = 0; /* 吞吐量(MB/秒) */
+    size_t recvCount = 0; /* 数据回调次数 */
+    double allocPerRecv = 0; /* 每次数据回调的内存分配次数 */
+};
+
+/**
+ * @brief 压测统计
+ */
+struct BenchStat
+{
+    void add(size_t length)
+    {
+        ++recvCount;
+        if ((recvBytes += length) >= totalBytes)
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            cv.notify_all();
+        }
+    }
+
+    size_t totalBytes = 0;
+    std::atomic<size_t> recvBytes = {0};
+    std::atomic<size_t> recvCount = {0};
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+/**
+ * @brief 回环压测: 客户端以阻塞方式持续发送, 服务端统计接收速率和内存分配次数
+ */
+static BenchResult bench(RecvMode mode, uint16_t port, size_t msgSize, size_t msgCount)
+{
+    BenchStat stat;
+    stat.totalBytes = msgSize * msgCount;
+    auto server = std::make_shared<nsocket::TcpServer>("bench", 1, "127.0.0.1", port, true, 65536);
+    std::vector<std::shared_ptr<std::vector<unsigned char>>> heldBuffers; /* 模拟使用者短暂持有缓冲区 */
+    switch (mode)
+    {
+    case RecvMode::copy:
+        server->setConnectionDataCallback(
+            [&](const std::weak_ptr<nsocket::TcpConnection>& wpConn, const std::vector<unsigned char>& data) { stat.add(data.size()); });
+        break;
+    case RecvMode::view:
+        server->setConnectionDataViewCallback(
+            [&](const std::weak_ptr<nsocket::TcpConnection>& wpConn, const unsigned char* data, size_t length) { stat.add(length); });
+        break;
+    case RecvMode::buffer:
+        heldBuffers.reserve(4);
+        server->setNewConnectionCallback([&](const std::weak_ptr<nsocket::TcpConnection>& wpConn) {
+            const auto conn = wpConn.lock();
+            if (conn)
+            {
+                conn->setDataBufferCallback([&](const std::shared_ptr<std::vector<unsigned char>>& buffer) {
+                    if (heldBuffers.size() >= 4)
+                    {
+                        heldBuffers.clear();
+                    }
+                    heldBuffers.emplace_back(buffer);
+                    stat.add(buffer->size());
+                });
+            }
+        });
+        break;
+    }
+    std::string errorMsg;
+    if (!server->run(false, 1, 2, "", "", "", &errorMsg))
+    {
+        printf("server run fail: %s\n", errorMsg.c_str());
+        exit(1);
+    }
+    boost::asio::io_context ioContext;
+    boost::asio::ip::tcp::socket socket(ioContext);
+    boost::system::error_code code;
+    socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), port), code);
+    if (code)
+    {
+        printf("connect fail: %s\n", code.message().c_str());
+        exit(1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); /* 等待服务端设置好连接回调 */
+    std::vector<unsigned char> msg(msgSize, 'x');
+    const size_t allocCount1 = s_allocCount;
+    auto tp1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < msgCount; ++i)
+    {
+        boost::asio::write(socket, boost::asio::buffer(msg), code);
+        if (code)
+        {
+            printf("send fail: %s\n", code.message().c_str());
+            exit(1);
+        }
+    }
+    {
+        std::unique_lock<std::mutex> locker(stat.mutex);
+        stat.cv.wait(locker, [&] { return stat.recvBytes >= stat.totalBytes; });
+    }
+    auto tp2 = std::chrono::steady_clock::now();
+    const size_t allocCount2 = s_allocCount;
+    socket.close(code);
+    server->stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); /* 等待连接线程中的回调执行完毕, 避免在回调线程中销毁服务端 */
+    BenchResult result;
+    result.mbPerSec = stat.totalBytes / (1024.0 * 1024.0) / std::chrono::duration<double>(tp2 - tp1).count();
+    result.recvCount = stat.recvCount;
+    result.allocPerRecv = (double)(allocCount2 - allocCount1) / (result.recvCount > 0 ? result.recvCount : 1);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    uint16_t port = 4445;
+    size_t totalMb = 256;
+    if (argc > 1)
+    {
+        port = (uint16_t)atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        totalMb = std::max<size_t>(1, atoll(argv[2]));
+    }
+    printf("loopback port: %d, total: %zu MB per round\n", (int)port, totalMb);
+    printf("%-10s %-8s %12s %12s %14s\n", "msg size", "mode", "MB/sec", "recv calls", "allocs/recv");
+    const std::vector<size_t> msgSizeList = {64, 1024, 16384};
+    const std::vector<std::pair<RecvMode, const char*>> modeList = {{RecvMode::copy, "copy"}, {RecvMode::view, "view"},
+                                                                    {RecvMode::buffer, "buffer"}};
+    for (auto msgSize : msgSizeList)
+    {
+        const size_t msgCount = totalMb * 1024 * 1024 / msgSize;
+        for (const auto& mode : modeList)
+        {
+            auto result = bench(mode.first, port, msgSize, msgCount);
+            printf("%-10zu %-8s %12.1f %12zu %14.3f\n", msgSize, mode.second, result.mbPerSec, result.recvCount, result.allocPerRecv);
+        }
+    }
+    return 0;
+}
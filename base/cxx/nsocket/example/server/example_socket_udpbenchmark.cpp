@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../nsocket/udp/udp_node.h"
+
+/**
+ * @brief 在后台线程中运行的UDP节点
+ */
+struct BenchNode
+{
+    BenchNode(const std::shared_ptr<nsocket::UdpNode>& n, const std::string& host, unsigned int port) : node(n)
+    {
+        thread = std::thread([n, host, port]() { n->run(host, port); });
+        while (!node->isRunning() || 0 == node->getLocalEndpoint().port()) /* 等待打开 */
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    ~BenchNode()
+    {
+        node->stop();
+        thread.join();
+    }
+
+    std::shared_ptr<nsocket::UdpNode> node;
+    std::thread thread;
+};
+
+/**
+ * @brief 创建发送的数据报列表
+ * @param point 远端端点
+ * @param payload 数据
+ * @param count 数量
+ * @return 数据报列表
+ */
+static std::vector<nsocket::UdpDatagram> makeDatagrams(const boost::asio::ip::udp::endpoint& point,
+                                                       const std::vector<unsigned char>& payload, size_t count)
+{
+    std::vector<nsocket::UdpDatagram> datagrams(count);
+    for (auto& item : datagrams)
+    {
+        item.point = point;
+        item.data = payload.data();
+        item.length = payload.size();
+    }
+    return datagrams;
+}
+
+/**
+ * @brief 发送压测: 对比逐个发送(UdpNode::send)和批量发送(UdpNode::sendBatch)
+ */
+static void benchSend(uint16_t port, size_t size, size_t total, size_t batchCount)
+{
+    /* 接收端只绑定不读取, 内核缓冲区满后丢弃 */
+    auto sink = std::make_shared<nsocket::UdpNode>();
+    BenchNode sinkNode(sink, "127.0.0.1", port);
+    auto sender = std::make_shared<nsocket::UdpNode>();
+    BenchNode senderNode(sender, "127.0.0.1", 0);
+    const std::vector<unsigned char> payload(size, 'x');
+    const auto datagrams = makeDatagrams(sink->getLocalEndpoint(), payload, batchCount);
+    for (int batch = 0; batch < 2; ++batch)
+    {
+        size_t sent = 0;
+        const auto tp = std::chrono::steady_clock::now();
+        while (sent < total)
+        {
+            size_t count = 0;
+            boost::system::error_code code;
+            if (0 == batch)
+            {
+                code = sender->send("127.0.0.1", port, payload, count);
+                count = (code ? 0 : 1);
+            }
+            else
+            {
+                code = sender->sendBatch(datagrams.data(), std::min(batchCount, total - sent), count);
+            }
+            if (code && 0 == count)
+            {
+                printf("send fail: %s\n", code.message().c_str());
+                return;
+            }
+            sent += count;
+        }
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+        printf("%-22s %12zu %14.0f\n", 0 == batch ? "send (per datagram)" : "sendBatch (mmsg+gso)", sent, sent / sec);
+    }
+}
+
+/**
+ * @brief 接收压测: 发送端持续批量发送, 统计接收端每秒收到的数据报数量
+ * @param shards 接收节点数量(>1时使用SO_REUSEPORT分担)
+ * @param batch 接收节点是否使用批量接收
+ */
+static void benchRecv(uint16_t port, size_t size, size_t batchCount, size_t shards, bool batch, double seconds)
+{
+    std::vector<std::shared_ptr<std::atomic<size_t>>> counterList;
+    std::vector<std::unique_ptr<BenchNode>> recvList;
+    for (size_t i = 0; i < shards; ++i)
+    {
+        auto counter = std::make_shared<std::atomic<size_t>>(0);
+        auto node = std::make_shared<nsocket::UdpNode>(size > 2048 ? size : 2048);
+        node->setRecvBufferSize(8 * 1024 * 1024);
+        node->setReusePort(shards > 1);
+        if (batch)
+        {
+            node->setBatchDataCallback([counter](const boost::system::error_code& code, const nsocket::UdpDatagram* datagrams,
+                                                 size_t count) { *counter += count; },
+                                       batchCount);
+        }
+        else
+        {
+            node->setDataCallback([counter](const boost::asio::ip::udp::endpoint& point, const boost::system::error_code& code,
+                                            const std::vector<unsigned char>& data) {
+                if (!code)
+                {
+                    ++(*counter);
+                }
+            });
+        }
+        counterList.emplace_back(counter);
+        recvList.emplace_back(new BenchNode(node, "127.0.0.1", port));
+    }
+    /* 多个发送端口, 使内核按四元组哈希把数据报分配到不同的接收节点 */
+    const size_t senderCount = (shards > 1 ? shards * 4 : 1);
+    std::vector<std::unique_ptr<BenchNode>> senderList;
+    for (size_t i = 0; i < senderCount; ++i)
+    {
+        senderList.emplace_back(new BenchNode(std::make_shared<nsocket::UdpNode>(), "127.0.0.1", 0));
+    }
+    const std::vector<unsigned char> payload(size, 'x');
+    const auto datagrams = makeDatagrams(boost::asio::ip::udp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port), payload,
+                                         batchCount);
+    std::atomic<bool> running{true};
+    std::atomic<size_t> sent{0};
+    std::thread sendThread([&]() {
+        for (size_t i = 0; running; ++i)
+        {
+            size_t count = 0;
+            senderList[i % senderCount]->node->sendBatch(datagrams.data(), datagrams.size(), count);
+            sent += count;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); /* 预热 */
+    size_t received = 0;
+    for (const auto& counter : counterList)
+    {
+        received += *counter;
+    }
+    const size_t sentStart = sent;
+    const auto tp = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds((int)(seconds * 1000)));
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    std::string perShard;
+    size_t receivedEnd = 0;
+    for (const auto& counter : counterList)
+    {
+        receivedEnd += *counter;
+        perShard += (perShard.empty() ? "" : " ") + std::to_string(*counter);
+    }
+    const size_t sentEnd = sent;
+    running = false;
+    sendThread.join();
+    const std::string name = std::string(batch ? "recvBatch" : "recv (per datagram)") + (shards > 1 ? " x" + std::to_string(shards) : "");
+    printf("%-22s %12zu %14.0f %12.0f  %s\n", name.c_str(), receivedEnd - received, (receivedEnd - received) / sec,
+           (sentEnd - sentStart) / sec, perShard.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+    printf("*************************************************************************************************************\n");
+    printf("** 说明: UDP回环收发压测, 对比逐个收发和recvmmsg/sendmmsg(+GSO)批量收发, 以及SO_REUSEPORT多节点分担接收.     **\n");
+    printf("**                                                                                                         **\n");
+    printf("** 选项:                                                                                                   **\n");
+    printf("**                                                                                                         **\n");
+    printf("** [-p 端口]           接收端口, 默认4448.                                                                 **\n");
+    printf("** [-s 大小]           数据报大小(字节), 默认128.                                                          **\n");
+    printf("** [-n 数量]           发送压测的数据报数量, 默认1000000.                                                  **\n");
+    printf("** [-b 数量]           每批数据报数量, 默认64.                                                             **\n");
+    printf("** [-r 数量]           SO_REUSEPORT接收节点数量, 默认为CPU核数(至少2).                                     **\n");
+    printf("** [-t 秒]             接收压测时长(秒), 默认2.                                                            **\n");
+    printf("**                                                                                                         **\n");
+    printf("*************************************************************************************************************\n");
+    printf("\n");
+    uint16_t port = 4448;
+    size_t size = 128;
+    size_t total = 1000000;
+    size_t batchCount = 64;
+    size_t shards = std::max(std::thread::hardware_concurrency(), 2U);
+    double seconds = 2;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        if ("-p" == key)
+        {
+            port = (uint16_t)atoi(argv[i + 1]);
+        }
+        else if ("-s" == key)
+        {
+            size = std::min(std::max(atoi(argv[i + 1]), 1), 65507);
+        }
+        else if ("-n" == key)
+        {
+            total = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-b" == key)
+        {
+            batchCount = std::max(atoi(argv[i + 1]), 1);
+        }
+        else if ("-r" == key)
+        {
+            shards = std::max(atoi(argv[i + 1]), 2);
+        }
+        else if ("-t" == key)
+        {
+            seconds = std::max(atof(argv[i + 1]), 0.1);
+        }
+    }
+    printf("datagram size: %zu bytes, batch: %zu, cpu cores: %u\n", size, batchCount, std::thread::hardware_concurrency());
+    printf("%-22s %12s %14s\n", "send", "datagrams", "datagrams/sec");
+    benchSend(port, size, total, batchCount);
+    printf("\n%-22s %12s %14s %12s  %s\n", "recv", "datagrams", "datagrams/sec", "sent/sec", "per node");
+    benchRecv(port, size, batchCount, 1, false, seconds);
+    benchRecv(port, size, batchCount, 1, true, seconds);
+    benchRecv(port, size, batchCount, shards, true, seconds);
+    return 0;
+}
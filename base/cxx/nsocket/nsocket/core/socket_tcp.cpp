@@ -1,7 +1,85 @@
 #include "socket_tcp.h"
 
+#include <boost/asio/write.hpp>
+#ifdef __linux__
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#endif
+
 namespace nsocket
 {
+static const size_t MAX_SENDFILE_SIZE = (16 * 1024 * 1024); /* 每次调用sendfile的最大发送长度(字节) */
+
+#ifdef __linux__
+/**
+ * @brief 在当前线程中屏蔽SIGPIPE(sendfile不支持MSG_NOSIGNAL, 对端已关闭时会产生SIGPIPE导致进程退出), 析构时丢弃产生的信号并恢复
+ */
+class SigPipeGuard final
+{
+public:
+    SigPipeGuard()
+    {
+        sigemptyset(&m_sigSet);
+        sigaddset(&m_sigSet, SIGPIPE);
+        sigset_t pendingSet;
+        sigpending(&pendingSet);
+        m_alreadyPending = (1 == sigismember(&pendingSet, SIGPIPE));
+        pthread_sigmask(SIG_BLOCK, &m_sigSet, &m_oldSet);
+    }
+
+    ~SigPipeGuard()
+    {
+        sigset_t pendingSet;
+        sigpending(&pendingSet);
+        if (!m_alreadyPending && 1 == sigismember(&pendingSet, SIGPIPE)) /* 丢弃本次产生的信号 */
+        {
+            const struct timespec timeout = {0, 0};
+            while (sigtimedwait(&m_sigSet, nullptr, &timeout) < 0 && EINTR == errno)
+            {
+            }
+        }
+        pthread_sigmask(SIG_SETMASK, &m_oldSet, nullptr);
+    }
+
+private:
+    sigset_t m_sigSet; /* SIGPIPE信号集 */
+    sigset_t m_oldSet; /* 原来的信号掩码 */
+    bool m_alreadyPending = false; /* 屏蔽前是否已有未决的SIGPIPE */
+};
+
+/**
+ * @brief 等待套接字可写
+ * @param fd 套接字描述符
+ * @param timeout 超时时间(毫秒), <=0表示不超时
+ * @return 错误码, 超时时为timed_out
+ */
+static boost::system::error_code waitWritable(int fd, int timeout)
+{
+    struct pollfd pfd = {};
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    while (1)
+    {
+        const auto ret = poll(&pfd, 1, (timeout > 0) ? timeout : -1);
+        if (ret > 0) /* 可写或出错(出错时由下次发送返回错误码) */
+        {
+            return boost::system::error_code();
+        }
+        else if (0 == ret)
+        {
+            return boost::asio::error::timed_out;
+        }
+        else if (EINTR != errno)
+        {
+            return boost::system::error_code(errno, boost::system::system_category());
+        }
+    }
+}
+#endif
+
 SocketTcp::SocketTcp(boost::asio::ip::tcp::socket socket) : m_socket(std::move(socket)) {}
 
 SocketTcp::~SocketTcp()
@@ -24,6 +102,11 @@ void SocketTcpBase::setRecvBufferSize(int bufferSize)
     m_recvBufferSize = bufferSize;
 }
 
+void SocketTcpBase::setSendTimeout(int timeout)
+{
+    m_sendTimeout = timeout;
+}
+
 void SocketTcpBase::setNagleEnable(bool enable)
 {
     m_enableNagle = (enable ? 1 : 0);
@@ -34,6 +117,11 @@ void SocketTcpBase::setLocalPort(uint16_t port)
     m_localPort = port;
 }
 
+bool SocketTcpBase::sendFile(FILE* /*f*/, size_t /*offset*/, size_t /*length*/, const TCP_SEND_CALLBACK& /*onSendCb*/)
+{
+    return false;
+}
+
 void SocketTcp::connect(const boost::asio::ip::tcp::endpoint& point, const TCP_CONNECT_CALLBACK& onConnectCb, bool async)
 {
     if (m_socket.is_open())
@@ -146,7 +234,17 @@ void SocketTcp::send(const boost::asio::const_buffer& data, const TCP_SEND_CALLB
         else
         {
             boost::system::error_code code;
-            auto length = m_socket.send(data, boost::asio::socket_base::message_flags(0), code);
+            size_t length = 0;
+#ifdef __linux__
+            if (m_sendTimeout > 0)
+            {
+                length = sendWithTimeout(data, code);
+            }
+            else
+#endif
+            {
+                length = m_socket.send(data, boost::asio::socket_base::message_flags(0), code);
+            }
             if (onSendCb)
             {
                 onSendCb(code, length);
@@ -159,6 +257,111 @@ void SocketTcp::send(const boost::asio::const_buffer& data, const TCP_SEND_CALLB
     }
 }
 
+void SocketTcp::sendAsync(const std::vector<boost::asio::const_buffer>& buffers, const TCP_SEND_CALLBACK& onSendCb)
+{
+    if (m_socket.is_open())
+    {
+        boost::asio::async_write(m_socket, buffers, onSendCb);
+    }
+    else if (onSendCb)
+    {
+        onSendCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+    }
+}
+
+bool SocketTcp::sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& onSendCb)
+{
+#ifdef __linux__
+    if (!f)
+    {
+        return false;
+    }
+    if (!m_socket.is_open())
+    {
+        if (onSendCb)
+        {
+            onSendCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+        }
+        return true;
+    }
+    boost::system::error_code code;
+    size_t sentLength = 0;
+    const int fd = fileno(f);
+    off64_t pos = (off64_t)offset;
+    const int timeout = m_sendTimeout;
+    if (timeout > 0) /* 设置了发送超时, 使用非阻塞模式(阻塞模式下sendfile会在内核中无限期等待) */
+    {
+        m_socket.native_non_blocking(true, code);
+        code.clear();
+    }
+    const SigPipeGuard sigPipeGuard;
+    while (sentLength < length) /* 循环发送所有数据 */
+    {
+        auto ret = sendfile64(m_socket.native_handle(), fd, &pos, std::min(length - sentLength, MAX_SENDFILE_SIZE));
+        if (ret > 0)
+        {
+            sentLength += (size_t)ret;
+        }
+        else if (0 == ret) /* 文件长度不足(例如已被截断) */
+        {
+            code = boost::asio::error::eof;
+            break;
+        }
+        else if (EINTR == errno)
+        {
+            continue;
+        }
+        else if (EAGAIN == errno || EWOULDBLOCK == errno) /* 套接字为非阻塞模式(例如已发起过异步操作)时, 等待可写后继续发送 */
+        {
+            code = waitWritable(m_socket.native_handle(), timeout);
+            if (code)
+            {
+                break;
+            }
+        }
+        else
+        {
+            code = boost::system::error_code(errno, boost::system::system_category());
+            break;
+        }
+    }
+    if (onSendCb)
+    {
+        onSendCb(code, sentLength);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef __linux__
+size_t SocketTcp::sendWithTimeout(const boost::asio::const_buffer& data, boost::system::error_code& code)
+{
+    while (1)
+    {
+        const auto ret = ::send(m_socket.native_handle(), data.data(), data.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret >= 0)
+        {
+            return (size_t)ret;
+        }
+        else if (EAGAIN == errno || EWOULDBLOCK == errno)
+        {
+            code = waitWritable(m_socket.native_handle(), m_sendTimeout);
+            if (code)
+            {
+                return 0;
+            }
+        }
+        else if (EINTR != errno)
+        {
+            code = boost::system::error_code(errno, boost::system::system_category());
+            return 0;
+        }
+    }
+}
+#endif
+
 void SocketTcp::recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CALLBACK& onRecvCb)
 {
     if (m_socket.is_open())
@@ -171,6 +374,23 @@ void SocketTcp::recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CAL
     }
 }
 
+void SocketTcp::recv(const boost::asio::mutable_buffer& data, const std::shared_ptr<TCP_RECV_CALLBACK>& onRecvCb)
+{
+    if (!onRecvCb || !(*onRecvCb))
+    {
+        return;
+    }
+    if (m_socket.is_open())
+    {
+        /* 只拷贝共享指针, 异步操作对象由asio回收复用, 因此不会分配内存 */
+        m_socket.async_receive(data, [onRecvCb](const boost::system::error_code& code, size_t length) { (*onRecvCb)(code, length); });
+    }
+    else
+    {
+        (*onRecvCb)(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+    }
+}
+
 void SocketTcp::close()
 {
     if (m_socket.is_open())
@@ -181,6 +401,15 @@ void SocketTcp::close()
     }
 }
 
+void SocketTcp::shutdown()
+{
+    if (m_socket.is_open())
+    {
+        boost::system::error_code code;
+        m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, code);
+    }
+}
+
 bool SocketTcp::isOpened() const
 {
     return m_socket.is_open();
@@ -205,6 +434,16 @@ int SocketTcp::getRecvBufferSize() const
     return opt.value();
 }
 
+void SocketTcp::setNagleEnable(bool enable)
+{
+    SocketTcpBase::setNagleEnable(enable);
+    if (m_socket.is_open()) /* 已建立的连接(例如服务端接受的连接)立即生效 */
+    {
+        boost::system::error_code code;
+        m_socket.set_option(boost::asio::ip::tcp::no_delay(enable ? false : true), code);
+    }
+}
+
 bool SocketTcp::isNagleEnable() const
 {
     boost::asio::ip::tcp::no_delay opt;
@@ -369,11 +608,34 @@ void SocketTls::send(const boost::asio::const_buffer& data, const TCP_SEND_CALLB
     }
 }
 
+void SocketTls::sendAsync(const std::vector<boost::asio::const_buffer>& buffers, const TCP_SEND_CALLBACK& onSendCb)
+{
+    if (m_sslStream.lowest_layer().is_open())
+    {
+        boost::asio::async_write(m_sslStream, buffers,
+                                 [self = shared_from_this(), onSendCb](const boost::system::error_code& code, size_t length) {
+                                     if (onSendCb)
+                                     {
+                                         onSendCb(code, length);
+                                     }
+                                 });
+    }
+    else if (onSendCb)
+    {
+        onSendCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+    }
+}
+
 void SocketTls::recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CALLBACK& onRecvCb)
 {
     if (m_sslStream.lowest_layer().is_open())
     {
-        m_sslStream.async_read_some(data, onRecvCb);
+        m_sslStream.async_read_some(data, [self = shared_from_this(), onRecvCb](const boost::system::error_code& code, size_t length) {
+            if (onRecvCb)
+            {
+                onRecvCb(code, length);
+            }
+        });
     }
     else if (onRecvCb)
     {
@@ -381,6 +643,24 @@ void SocketTls::recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CAL
     }
 }
 
+void SocketTls::recv(const boost::asio::mutable_buffer& data, const std::shared_ptr<TCP_RECV_CALLBACK>& onRecvCb)
+{
+    if (!onRecvCb || !(*onRecvCb))
+    {
+        return;
+    }
+    if (m_sslStream.lowest_layer().is_open())
+    {
+        m_sslStream.async_read_some(data, [self = shared_from_this(), onRecvCb](const boost::system::error_code& code, size_t length) {
+            (*onRecvCb)(code, length);
+        });
+    }
+    else
+    {
+        (*onRecvCb)(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+    }
+}
+
 void SocketTls::close()
 {
     if (m_sslStream.lowest_layer().is_open())
@@ -391,6 +671,15 @@ void SocketTls::close()
     }
 }
 
+void SocketTls::shutdown()
+{
+    if (m_sslStream.lowest_layer().is_open())
+    {
+        boost::system::error_code code;
+        m_sslStream.lowest_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_both, code);
+    }
+}
+
 bool SocketTls::isOpened() const
 {
     return m_sslStream.lowest_layer().is_open();
@@ -415,6 +704,16 @@ int SocketTls::getRecvBufferSize() const
     return opt.value();
 }
 
+void SocketTls::setNagleEnable(bool enable)
+{
+    SocketTcpBase::setNagleEnable(enable);
+    if (m_sslStream.lowest_layer().is_open()) /* 已建立的连接(例如服务端接受的连接)立即生效 */
+    {
+        boost::system::error_code code;
+        m_sslStream.lowest_layer().set_option(boost::asio::ip::tcp::no_delay(enable ? false : true), code);
+    }
+}
+
 bool SocketTls::isNagleEnable() const
 {
     boost::asio::ip::tcp::no_delay opt;
@@ -450,7 +749,12 @@ void SocketTls::handshake(boost::asio::ssl::stream_base::handshake_type type, co
     {
         if (async)
         {
-            m_sslStream.async_handshake(type, onHandshakeCb);
+            m_sslStream.async_handshake(type, [self = shared_from_this(), onHandshakeCb](const boost::system::error_code& code) {
+                if (onHandshakeCb)
+                {
+                    onHandshakeCb(code);
+                }
+            });
         }
         else
         {
@@ -6,7 +6,10 @@
 #include <boost/asio/ssl.hpp>
 #endif
 #include <boost/system/system_error.hpp>
+#include <cstdio>
 #include <functional>
+#include <memory>
+#include <vector>
 
 /* 
  * 关于同步/异步发送数据说明:
@@ -30,6 +33,10 @@
  * (1)不要连续发起异步发送, 要等上次发送完成之后再发起下一个异步发送.
  * (2)要考虑异步发送的发送队列内存可能会暴涨的问题.
  * (3)相比复杂的异步发送, 同步发送简单可靠, 推荐优先使用同步发送接口.
+ *
+ * 补充: TcpConnection::sendAsync实现了有上限的异步发送队列, 由连接所在的I/O线程串行发送, 每次把队列中
+ * 的多个数据合并为一次写操作(writev), 并提供高/低水位回调用于背压控制, 队列溢出时按策略丢弃数据或关闭连接.
+ * 对端接收缓慢时不会阻塞调用线程, 适用于服务端向大量连接推送数据的场景.
  */
 
 namespace nsocket
@@ -88,12 +95,19 @@ public:
     void setRecvBufferSize(int bufferSize);
 
     /**
-     * @brief 设置是否启用Nagle算法(连接前调用才有效), Nagle算法会将小的数据包合并成较大的数据包再发送, 以提高网络传输效率.
+     * @brief 设置同步发送超时(仅Linux下的TCP套接字有效), 套接字持续不可写(例如对端不再接收数据)超过该时间则发送失败
+     *        (错误码为timed_out), 避免同步发送无限期阻塞
+     * @param timeout 超时时间(毫秒), <=0表示不超时
+     */
+    void setSendTimeout(int timeout);
+
+    /**
+     * @brief 设置是否启用Nagle算法(连接前调用, 对已建立的连接则立即生效), Nagle算法会将小的数据包合并成较大的数据包再发送, 以提高网络传输效率.
      *        但在某些情况下, 这可能会导致数据发送的延迟, 使应用程序认为数据已经发送成功, 但实际上数据还在等待合并的过程中,
      *        没有立即被发送到网络上, 关闭Nagle算法可能会增加网络传输的开销, 应在权衡利弊后谨慎使用
      * @param enable true-启用, false-关闭
      */
-    void setNagleEnable(bool enable);
+    virtual void setNagleEnable(bool enable);
 
     /**
      * @brief 设置本地端口(连接前调用才有效)
@@ -122,6 +136,23 @@ public:
      */
     virtual void send(const boost::asio::const_buffer& data, const TCP_SEND_CALLBACK& onSendCb) = 0;
 
+    /**
+     * @brief 发送数据(异步, 多个缓冲区合并为一次写操作), 注意: 上次发送完成之前不能再次调用
+     * @param buffers 缓冲区列表(发送完成之前需要保证缓冲区有效)
+     * @param onSendCb 发送回调(所有数据发送完成或出错时回调)
+     */
+    virtual void sendAsync(const std::vector<boost::asio::const_buffer>& buffers, const TCP_SEND_CALLBACK& onSendCb) = 0;
+
+    /**
+     * @brief 发送文件内容(同步, 零拷贝), 由内核直接把文件内容发送到套接字(Linux下使用sendfile), 不改变文件的读写位置
+     * @param f 文件指针
+     * @param offset 文件偏移
+     * @param length 发送长度
+     * @param onSendCb 发送回调
+     * @return true-支持零拷贝发送(结果通过回调返回), false-不支持(例如TLS套接字), 需要调用者读取文件后发送
+     */
+    virtual bool sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& onSendCb);
+
     /**
      * @brief 接收数据
      * @param data [输出]数据
@@ -129,11 +160,23 @@ public:
      */
     virtual void recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CALLBACK& onRecvCb) = 0;
 
+    /**
+     * @brief 接收数据(回调对象共享, 每次接收不再拷贝回调, 适用于循环接收)
+     * @param data [输出]数据
+     * @param onRecvCb 接收回调
+     */
+    virtual void recv(const boost::asio::mutable_buffer& data, const std::shared_ptr<TCP_RECV_CALLBACK>& onRecvCb) = 0;
+
     /**
      * @brief 关闭连接
      */
     virtual void close() = 0;
 
+    /**
+     * @brief 关闭读写(不关闭套接字, 可在其他线程中调用), 其他线程中阻塞的同步发送会立即返回错误
+     */
+    virtual void shutdown() = 0;
+
     /**
      * @brief 连接是否已打开
      * @return true-已打开, false-关闭
@@ -180,6 +223,7 @@ protected:
     std::atomic<int> m_nonBlock = {-1}; /* 是否非阻塞: <0-默认, 0-阻塞, 1-非阻塞 */
     std::atomic<int> m_sendBufferSize = {-1}; /* 发送缓冲区大小(字节), <=0-默认, >0-指定大小 */
     std::atomic<int> m_recvBufferSize = {-1}; /* 接收缓冲区大小(字节), <=0-默认, >0-指定大小 */
+    std::atomic<int> m_sendTimeout = {0}; /* 同步发送超时(毫秒), <=0-不超时 */
     std::atomic<int> m_enableNagle = {-1}; /* 是否禁用Nagle算法, <0-默认, 0-禁用, 1-启用 */
     std::atomic<uint16_t> m_localPort = {0}; /* 本地端口 */
     boost::asio::ip::tcp::endpoint m_remotePoint; /* 远端端点 */
@@ -199,12 +243,22 @@ public:
 
     boost::asio::io_context& getIoContext();
 
+    void setNagleEnable(bool enable) override;
+
     void send(const boost::asio::const_buffer& data, const TCP_SEND_CALLBACK& onSendCb) override;
 
+    void sendAsync(const std::vector<boost::asio::const_buffer>& buffers, const TCP_SEND_CALLBACK& onSendCb) override;
+
+    bool sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& onSendCb) override;
+
     void recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CALLBACK& onRecvCb) override;
 
+    void recv(const boost::asio::mutable_buffer& data, const std::shared_ptr<TCP_RECV_CALLBACK>& onRecvCb) override;
+
     void close() override;
 
+    void shutdown() override;
+
     bool isOpened() const override;
 
     bool isNonBlock() const override;
@@ -219,15 +273,27 @@ public:
 
     boost::asio::ip::tcp::endpoint getRemoteEndpoint() const override;
 
+private:
+#ifdef __linux__
+    /**
+     * @brief 发送数据(非阻塞方式, 不可写时等待, 等待超过发送超时则失败)
+     * @param data 数据
+     * @param code [输出]错误码
+     * @return 已发送的长度
+     */
+    size_t sendWithTimeout(const boost::asio::const_buffer& data, boost::system::error_code& code);
+#endif
+
 private:
     boost::asio::ip::tcp::socket m_socket;
 };
 
 #if (1 == ENABLE_NSOCKET_OPENSSL)
 /**
- * @brief TLS套接字(安全的TCP)
+ * @brief TLS套接字(安全的TCP), 注意: 必须使用std::make_shared创建, 异步操作期间会持有自身的引用,
+ *        避免连接在异步操作未完成时被销毁(SSL流的异步操作在底层套接字关闭后仍会访问流对象)
  */
-class SocketTls : public SocketTcpBase
+class SocketTls : public SocketTcpBase, public std::enable_shared_from_this<SocketTls>
 {
 public:
     SocketTls(boost::asio::ip::tcp::socket socket, boost::asio::ssl::context& sslContext);
@@ -238,12 +304,20 @@ public:
 
     boost::asio::io_context& getIoContext();
 
+    void setNagleEnable(bool enable) override;
+
     void send(const boost::asio::const_buffer& data, const TCP_SEND_CALLBACK& onSendCb) override;
 
+    void sendAsync(const std::vector<boost::asio::const_buffer>& buffers, const TCP_SEND_CALLBACK& onSendCb) override;
+
     void recv(const boost::asio::mutable_buffer& data, const TCP_RECV_CALLBACK& onRecvCb) override;
 
+    void recv(const boost::asio::mutable_buffer& data, const std::shared_ptr<TCP_RECV_CALLBACK>& onRecvCb) override;
+
     void close() override;
 
+    void shutdown() override;
+
     bool isOpened() const override;
 
     bool isNonBlock() const override;
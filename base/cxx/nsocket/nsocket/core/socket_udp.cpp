@@ -1,7 +1,43 @@
 #include "socket_udp.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103 /* Linux 4.18+ */
+#endif
+#endif
+
 namespace nsocket
 {
+#ifdef __linux__
+static const size_t MAX_BATCH_MSG_COUNT = 1024; /* sendmmsg/recvmmsg每次最多处理的消息数量(UIO_MAXIOV) */
+static const size_t MAX_GSO_SEGMENTS = 64; /* UDP GSO每个消息最多的分段数量 */
+static const size_t MAX_GSO_PAYLOAD = 65507; /* UDP GSO每个消息最大的数据长度 */
+
+/**
+ * @brief 批量收发上下文
+ */
+struct SocketUdp::BatchContext
+{
+    std::vector<mmsghdr> msgList; /* 消息头列表 */
+    std::vector<iovec> iovList; /* 数据块列表 */
+    std::vector<sockaddr_storage> addrList; /* [接收]远端地址列表 */
+    std::vector<unsigned char> slab; /* [接收]数据缓冲区(每个数据报占用maxSize字节) */
+    std::vector<UdpDatagram> datagramList; /* [接收]数据报列表 */
+    std::vector<size_t> groupList; /* [发送]每个消息包含的数据报数量 */
+    std::vector<unsigned char> cmsgBuf; /* [发送]控制消息缓冲区(UDP_SEGMENT) */
+};
+#else
+struct SocketUdp::BatchContext
+{
+};
+#endif
+
 void SocketUdpBase::setNonBlock(bool nonBlock)
 {
     m_nonBlock = (nonBlock ? 1 : 0);
@@ -17,6 +53,21 @@ void SocketUdpBase::setRecvBufferSize(int bufferSize)
     m_recvBufferSize = bufferSize;
 }
 
+void SocketUdpBase::setReusePort(bool reusePort)
+{
+    m_reusePort = reusePort;
+}
+
+bool SocketUdpBase::sendBatch(const UdpDatagram* /*datagrams*/, size_t /*count*/, const UDP_SEND_CALLBACK& /*onSendCb*/)
+{
+    return false;
+}
+
+bool SocketUdpBase::recvBatch(size_t /*maxCount*/, size_t /*maxSize*/, const UDP_RECV_BATCH_CALLBACK& /*onRecvCb*/)
+{
+    return false;
+}
+
 SocketUdp::SocketUdp(boost::asio::ip::udp::socket socket) : m_socket(std::move(socket)) {}
 
 SocketUdp::~SocketUdp()
@@ -78,6 +129,16 @@ void SocketUdp::open(const boost::asio::ip::udp::endpoint& point, bool broadcast
                 {
                     break;
                 }
+#ifdef SO_REUSEPORT
+                if (m_reusePort)
+                {
+                    m_socket.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true), code);
+                    if (code)
+                    {
+                        break;
+                    }
+                }
+#endif
             } while (0);
             if (code)
             {
@@ -130,10 +191,11 @@ void SocketUdp::recv(const boost::asio::mutable_buffer& data, const UDP_RECV_CAL
 {
     if (m_socket.is_open())
     {
-        m_socket.async_receive_from(data, m_remotePoint, [&, onRecvCb](const boost::system::error_code& code, size_t length) {
+        const auto self = shared_from_this();
+        m_socket.async_receive_from(data, m_remotePoint, [self, onRecvCb](const boost::system::error_code& code, size_t length) {
             if (onRecvCb)
             {
-                onRecvCb(m_remotePoint, code, length);
+                onRecvCb(self->m_remotePoint, code, length);
             }
         });
     }
@@ -143,6 +205,209 @@ void SocketUdp::recv(const boost::asio::mutable_buffer& data, const UDP_RECV_CAL
     }
 }
 
+bool SocketUdp::sendBatch(const UdpDatagram* datagrams, size_t count, const UDP_SEND_CALLBACK& onSendCb)
+{
+#ifdef __linux__
+    if (!m_socket.is_open())
+    {
+        if (onSendCb)
+        {
+            onSendCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+        }
+        return true;
+    }
+    boost::system::error_code code;
+    size_t sentCount = 0;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSendBatch);
+        if (!m_sendBatch)
+        {
+            m_sendBatch.reset(new BatchContext());
+        }
+        auto& ctx = *m_sendBatch;
+        const size_t cmsgSpace = CMSG_SPACE(sizeof(uint16_t));
+        while (sentCount < count)
+        {
+            /* 1.组装消息, 发往同一端点的连续数据报(最后1个可以较短)合并为1个GSO消息 */
+            const bool gso = m_gsoEnabled;
+            const size_t maxMsgCount = std::min(count - sentCount, MAX_BATCH_MSG_COUNT);
+            ctx.msgList.resize(maxMsgCount);
+            ctx.groupList.resize(maxMsgCount);
+            ctx.iovList.resize(std::min(count - sentCount, MAX_BATCH_MSG_COUNT * (gso ? MAX_GSO_SEGMENTS : 1)));
+            ctx.cmsgBuf.assign(maxMsgCount * cmsgSpace, 0);
+            size_t msgCount = 0, iovCount = 0, index = sentCount;
+            while (msgCount < maxMsgCount && index < count && iovCount < ctx.iovList.size())
+            {
+                const auto& first = datagrams[index];
+                const size_t segSize = first.length;
+                size_t segCount = 0, payload = 0;
+                while (index < count && iovCount < ctx.iovList.size())
+                {
+                    const auto& item = datagrams[index];
+                    if (segCount > 0
+                        && (!gso || 0 == segSize || segCount >= MAX_GSO_SEGMENTS || item.length > segSize || 0 == item.length
+                            || payload + item.length > MAX_GSO_PAYLOAD || item.point != first.point))
+                    {
+                        break;
+                    }
+                    ctx.iovList[iovCount + segCount].iov_base = (void*)item.data;
+                    ctx.iovList[iovCount + segCount].iov_len = item.length;
+                    payload += item.length;
+                    ++segCount;
+                    ++index;
+                    if (item.length < segSize) /* 较短的数据报只能作为最后1个分段 */
+                    {
+                        break;
+                    }
+                }
+                auto& hdr = ctx.msgList[msgCount].msg_hdr;
+                memset(&ctx.msgList[msgCount], 0, sizeof(mmsghdr));
+                hdr.msg_name = (void*)first.point.data();
+                hdr.msg_namelen = (socklen_t)first.point.size();
+                hdr.msg_iov = &ctx.iovList[iovCount];
+                hdr.msg_iovlen = segCount;
+                if (segCount > 1)
+                {
+                    hdr.msg_control = ctx.cmsgBuf.data() + msgCount * cmsgSpace;
+                    hdr.msg_controllen = cmsgSpace;
+                    auto cmsg = CMSG_FIRSTHDR(&hdr);
+                    cmsg->cmsg_level = SOL_UDP;
+                    cmsg->cmsg_type = UDP_SEGMENT;
+                    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    const uint16_t gsoSize = (uint16_t)segSize;
+                    memcpy(CMSG_DATA(cmsg), &gsoSize, sizeof(gsoSize));
+                }
+                ctx.groupList[msgCount] = segCount;
+                iovCount += segCount;
+                ++msgCount;
+            }
+            /* 2.发送 */
+            const int ret = sendmmsg(m_socket.native_handle(), ctx.msgList.data(), (unsigned int)msgCount, 0);
+            if (ret > 0)
+            {
+                for (int i = 0; i < ret; ++i)
+                {
+                    sentCount += ctx.groupList[i];
+                }
+            }
+            else if (EINTR == errno)
+            {
+                continue;
+            }
+            else if (EAGAIN == errno || EWOULDBLOCK == errno) /* 套接字为非阻塞模式时, 等待可写后继续发送 */
+            {
+                m_socket.wait(boost::asio::ip::udp::socket::wait_write, code);
+                if (code)
+                {
+                    break;
+                }
+            }
+            else if (gso && iovCount > msgCount && (EIO == errno || EINVAL == errno || ENOPROTOOPT == errno)) /* 不支持GSO */
+            {
+                m_gsoEnabled = false;
+            }
+            else
+            {
+                code = boost::system::error_code(errno, boost::system::system_category());
+                break;
+            }
+        }
+    }
+    if (onSendCb)
+    {
+        onSendCb(code, sentCount);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SocketUdp::recvBatch(size_t maxCount, size_t maxSize, const UDP_RECV_BATCH_CALLBACK& onRecvCb)
+{
+#ifdef __linux__
+    if (!m_socket.is_open())
+    {
+        if (onRecvCb)
+        {
+            onRecvCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), nullptr, 0);
+        }
+        return true;
+    }
+    maxCount = std::min(std::max(maxCount, (size_t)1), MAX_BATCH_MSG_COUNT);
+    maxSize = std::max(maxSize, (size_t)1);
+    if (!m_recvBatch)
+    {
+        m_recvBatch.reset(new BatchContext());
+    }
+    auto& ctx = *m_recvBatch;
+    if (ctx.msgList.size() != maxCount || ctx.slab.size() != maxCount * maxSize) /* 预分配, 后续接收复用 */
+    {
+        ctx.msgList.assign(maxCount, mmsghdr());
+        ctx.iovList.resize(maxCount);
+        ctx.addrList.resize(maxCount);
+        ctx.slab.resize(maxCount * maxSize);
+        ctx.datagramList.resize(maxCount);
+        for (size_t i = 0; i < maxCount; ++i)
+        {
+            ctx.iovList[i].iov_base = ctx.slab.data() + i * maxSize;
+            ctx.iovList[i].iov_len = maxSize;
+            ctx.datagramList[i].data = ctx.slab.data() + i * maxSize;
+        }
+    }
+    const auto self = shared_from_this();
+    m_socket.async_wait(boost::asio::ip::udp::socket::wait_read, [self, onRecvCb](boost::system::error_code code) {
+        if (code)
+        {
+            if (onRecvCb)
+            {
+                onRecvCb(code, nullptr, 0);
+            }
+            return;
+        }
+        auto& ctx = *self->m_recvBatch;
+        const size_t maxCount = ctx.msgList.size();
+        for (size_t i = 0; i < maxCount; ++i) /* 每次接收前需重置输入输出参数 */
+        {
+            auto& hdr = ctx.msgList[i].msg_hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_name = &ctx.addrList[i];
+            hdr.msg_namelen = sizeof(sockaddr_storage);
+            hdr.msg_iov = &ctx.iovList[i];
+            hdr.msg_iovlen = 1;
+        }
+        int ret = 0;
+        do
+        {
+            ret = recvmmsg(self->m_socket.native_handle(), ctx.msgList.data(), (unsigned int)maxCount, MSG_DONTWAIT, nullptr);
+        } while (ret < 0 && EINTR == errno);
+        if (ret < 0)
+        {
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                code = boost::system::error_code(errno, boost::system::system_category());
+            }
+            ret = 0;
+        }
+        for (int i = 0; i < ret; ++i)
+        {
+            auto& item = ctx.datagramList[i];
+            const auto namelen = std::min((size_t)ctx.msgList[i].msg_hdr.msg_namelen, item.point.capacity());
+            memcpy(item.point.data(), &ctx.addrList[i], namelen);
+            item.point.resize(namelen);
+            item.length = ctx.msgList[i].msg_len;
+        }
+        if (onRecvCb)
+        {
+            onRecvCb(code, ctx.datagramList.data(), (size_t)ret);
+        }
+    });
+    return true;
+#else
+    return false;
+#endif
+}
+
 void SocketUdp::close()
 {
     if (m_socket.is_open())
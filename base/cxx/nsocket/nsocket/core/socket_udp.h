@@ -4,6 +4,8 @@
 #include <boost/asio/ip/udp.hpp>
 #include <boost/system/system_error.hpp>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 namespace nsocket
 {
@@ -29,6 +31,24 @@ using UDP_SEND_CALLBACK = std::function<void(const boost::system::error_code& co
 using UDP_RECV_CALLBACK =
     std::function<void(const boost::asio::ip::udp::endpoint& point, const boost::system::error_code& code, size_t length)>;
 
+/**
+ * @brief UDP数据报(批量接收时data指向接收缓冲区, 只在回调期间有效)
+ */
+struct UdpDatagram
+{
+    boost::asio::ip::udp::endpoint point; /* 远端端点 */
+    const unsigned char* data = nullptr; /* 数据 */
+    size_t length = 0; /* 数据长度 */
+};
+
+/**
+ * @brief UDP批量接收回调
+ * @param code 错误码
+ * @param datagrams 数据报列表
+ * @param count 数据报数量
+ */
+using UDP_RECV_BATCH_CALLBACK = std::function<void(const boost::system::error_code& code, const UdpDatagram* datagrams, size_t count)>;
+
 /**
  * @brief UDP套接字基类
  */
@@ -56,6 +76,12 @@ public:
      */
     void setRecvBufferSize(int bufferSize);
 
+    /**
+     * @brief 设置是否允许多个套接字绑定到相同的端口(SO_REUSEPORT, 打开前调用才有效), 由内核按四元组哈希分配数据报
+     * @param reusePort true-允许, false-不允许
+     */
+    void setReusePort(bool reusePort);
+
     /**
      * @brief 打开套接字
      * @param point 本地端点
@@ -80,6 +106,24 @@ public:
      */
     virtual void recv(const boost::asio::mutable_buffer& data, const UDP_RECV_CALLBACK& onRecvCb) = 0;
 
+    /**
+     * @brief 批量发送数据(同步), 说明: 默认不支持, 返回false时需要调用send逐个发送
+     * @param datagrams 数据报列表
+     * @param count 数据报数量
+     * @param onSendCb 发送回调(参数length为已发送的数据报数量)
+     * @return true-支持, false-不支持
+     */
+    virtual bool sendBatch(const UdpDatagram* datagrams, size_t count, const UDP_SEND_CALLBACK& onSendCb);
+
+    /**
+     * @brief 批量接收数据(可读时1次读取多个数据报), 说明: 默认不支持, 返回false时需要调用recv逐个接收
+     * @param maxCount 每次最多接收的数据报数量
+     * @param maxSize 每个数据报的最大长度(超过时被截断)
+     * @param onRecvCb 接收回调(数据报数量可能为0)
+     * @return true-支持, false-不支持
+     */
+    virtual bool recvBatch(size_t maxCount, size_t maxSize, const UDP_RECV_BATCH_CALLBACK& onRecvCb);
+
     /**
      * @brief 关闭套接字
      */
@@ -119,13 +163,14 @@ protected:
     std::atomic<int> m_nonBlock = {-1}; /* 是否非阻塞: <0-默认, 0-阻塞, 1-非阻塞 */
     std::atomic<int> m_sendBufferSize = {-1}; /* 发送缓冲区大小(字节), <=0-默认, >0-指定大小 */
     std::atomic<int> m_recvBufferSize = {-1}; /* 接收缓冲区大小(字节), <=0-默认, >0-指定大小 */
+    std::atomic_bool m_reusePort = {false}; /* 是否允许多个套接字绑定到相同的端口 */
     boost::asio::ip::udp::endpoint m_localPoint; /* 本地端点 */
 };
 
 /**
- * @brief UDP套接字
+ * @brief UDP套接字(注意: 需要实例化为共享指针, 异步操作期间持有自身引用)
  */
-class SocketUdp : public SocketUdpBase
+class SocketUdp : public SocketUdpBase, public std::enable_shared_from_this<SocketUdp>
 {
 public:
     SocketUdp(boost::asio::ip::udp::socket socket);
@@ -139,6 +184,16 @@ public:
 
     void recv(const boost::asio::mutable_buffer& data, const UDP_RECV_CALLBACK& onRecvCb) override;
 
+    /**
+     * @brief 批量发送数据(Linux使用sendmmsg, 发往同一端点的连续等长数据报使用UDP GSO合并为1个消息, 内核不支持时自动关闭GSO)
+     */
+    bool sendBatch(const UdpDatagram* datagrams, size_t count, const UDP_SEND_CALLBACK& onSendCb) override;
+
+    /**
+     * @brief 批量接收数据(Linux使用recvmmsg, 接收到预分配的连续缓冲区中)
+     */
+    bool recvBatch(size_t maxCount, size_t maxSize, const UDP_RECV_BATCH_CALLBACK& onRecvCb) override;
+
     void close() override;
 
     bool isOpened() const override;
@@ -152,7 +207,13 @@ public:
     boost::asio::ip::udp::endpoint getLocalEndpoint() const override;
 
 private:
+    struct BatchContext;
+
     boost::asio::ip::udp::socket m_socket;
     boost::asio::ip::udp::endpoint m_remotePoint; /* 远端端点 */
+    std::unique_ptr<BatchContext> m_recvBatch; /* 批量接收上下文(消息头, 地址和数据缓冲区, 复用) */
+    std::mutex m_mutexSendBatch;
+    std::unique_ptr<BatchContext> m_sendBatch; /* 批量发送上下文(复用) */
+    std::atomic_bool m_gsoEnabled = {true}; /* 是否使用UDP GSO(发送失败时关闭) */
 };
 } // namespace nsocket
@@ -0,0 +1,236 @@
+#include "frame_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace nsocket
+{
+FrameDecoder::FrameDecoder(const FrameConfig& cfg) : m_cfg(cfg)
+{
+    switch (cfg.type)
+    {
+    case FrameType::fixed:
+        if (0 == cfg.fixedLen)
+        {
+            throw std::logic_error(std::string("[") + __FILE__ + " " + std::to_string(__LINE__) + " " + __FUNCTION__
+                                   + "] arg 'cfg.fixedLen' = 0 is invalid");
+        }
+        break;
+    case FrameType::length:
+        if ((1 != cfg.lengthSize && 2 != cfg.lengthSize && 4 != cfg.lengthSize && 8 != cfg.lengthSize)
+            || cfg.lengthOffset + cfg.lengthSize > cfg.headLen)
+        {
+            throw std::logic_error(std::string("[") + __FILE__ + " " + std::to_string(__LINE__) + " " + __FUNCTION__
+                                   + "] arg 'cfg.lengthSize' = " + std::to_string(cfg.lengthSize) + " or 'cfg.lengthOffset' = "
+                                   + std::to_string(cfg.lengthOffset) + " is invalid");
+        }
+        break;
+    case FrameType::delimiter:
+        if (cfg.delimiter.empty())
+        {
+            throw std::logic_error(std::string("[") + __FILE__ + " " + std::to_string(__LINE__) + " " + __FUNCTION__
+                                   + "] arg 'cfg.delimiter' is empty");
+        }
+        break;
+    }
+}
+
+const FrameConfig& FrameDecoder::getConfig() const
+{
+    return m_cfg;
+}
+
+void FrameDecoder::reset()
+{
+    m_readPos = 0;
+    m_writePos = 0;
+    m_scanPos = 0;
+}
+
+size_t FrameDecoder::getPendingSize() const
+{
+    return m_writePos - m_readPos;
+}
+
+int FrameDecoder::decode(const unsigned char* data, size_t dataLen, const FRAME_CALLBACK& frameCb)
+{
+    if (!data || 0 == dataLen)
+    {
+        return 0;
+    }
+    const size_t delimiterLen = m_cfg.delimiter.size();
+    int count = 0;
+    /* 1.补全缓冲区中未完整的帧(只追加需要的数据) */
+    while (m_writePos > m_readPos && dataLen > 0)
+    {
+        const size_t pendingLen = m_writePos - m_readPos;
+        const auto totalLen = probe(m_buffer.data() + m_readPos, pendingLen, m_scanPos);
+        if (totalLen < 0)
+        {
+            reset();
+            return -1;
+        }
+        size_t takeLen = dataLen;
+        if (totalLen > 0) /* 帧长度已知 */
+        {
+            takeLen = std::min((size_t)totalLen - pendingLen, dataLen);
+        }
+        else if (FrameType::length == m_cfg.type) /* 包头不完整 */
+        {
+            takeLen = std::min(m_cfg.headLen - pendingLen, dataLen);
+        }
+        append(data, takeLen);
+        data += takeLen;
+        dataLen -= takeLen;
+        const auto usedLen = split(m_buffer.data() + m_readPos, m_writePos - m_readPos, m_scanPos, frameCb, count);
+        if (usedLen < 0)
+        {
+            reset();
+            return -1;
+        }
+        m_readPos += (size_t)usedLen;
+        if (m_readPos == m_writePos) /* 缓冲区已清空 */
+        {
+            reset();
+        }
+        else if (FrameType::delimiter == m_cfg.type)
+        {
+            const size_t remainLen = m_writePos - m_readPos;
+            m_scanPos = (remainLen >= delimiterLen ? remainLen - delimiterLen + 1 : 0);
+        }
+    }
+    /* 2.直接在输入数据上拆包, 剩余不完整的帧追加到缓冲区 */
+    if (dataLen > 0)
+    {
+        const auto usedLen = split(data, dataLen, 0, frameCb, count);
+        if (usedLen < 0)
+        {
+            reset();
+            return -1;
+        }
+        if ((size_t)usedLen < dataLen)
+        {
+            const size_t remainLen = dataLen - (size_t)usedLen;
+            append(data + usedLen, remainLen);
+            if (FrameType::delimiter == m_cfg.type)
+            {
+                m_scanPos = (remainLen >= delimiterLen ? remainLen - delimiterLen + 1 : 0);
+            }
+        }
+    }
+    return count;
+}
+
+int64_t FrameDecoder::probe(const unsigned char* data, size_t dataLen, size_t scanFrom) const
+{
+    switch (m_cfg.type)
+    {
+    case FrameType::fixed:
+        return (int64_t)m_cfg.fixedLen;
+    case FrameType::length: {
+        if (dataLen < m_cfg.headLen)
+        {
+            return 0;
+        }
+        const unsigned char* p = data + m_cfg.lengthOffset;
+        uint64_t value = 0;
+        for (size_t i = 0; i < m_cfg.lengthSize; ++i)
+        {
+            value |= (uint64_t)(m_cfg.bigEndian ? p[i] : p[m_cfg.lengthSize - 1 - i]) << (8 * (m_cfg.lengthSize - 1 - i));
+        }
+        if (value > (uint64_t)INT64_MAX - m_cfg.headLen)
+        {
+            return -1;
+        }
+        const int64_t bodyLen = (int64_t)value + m_cfg.lengthAdjust;
+        if (bodyLen < 0 || (uint64_t)bodyLen > m_cfg.maxBodyLen)
+        {
+            return -1;
+        }
+        return (int64_t)m_cfg.headLen + bodyLen;
+    }
+    case FrameType::delimiter: {
+        const auto& delimiter = m_cfg.delimiter;
+        const unsigned char first = (unsigned char)delimiter[0];
+        const size_t delimiterLen = delimiter.size();
+        size_t pos = scanFrom;
+        while (pos + delimiterLen <= dataLen)
+        {
+            auto ptr = (const unsigned char*)memchr(data + pos, first, dataLen - delimiterLen + 1 - pos);
+            if (!ptr)
+            {
+                break;
+            }
+            pos = ptr - data;
+            if (0 == memcmp(ptr, delimiter.data(), delimiterLen))
+            {
+                return (pos > m_cfg.maxBodyLen) ? -1 : (int64_t)(pos + delimiterLen);
+            }
+            ++pos;
+        }
+        if (dataLen >= delimiterLen && dataLen - delimiterLen + 1 > m_cfg.maxBodyLen) /* 超过最大长度仍未找到分隔符 */
+        {
+            return -1;
+        }
+        return 0;
+    }
+    }
+    return -1;
+}
+
+int64_t FrameDecoder::split(const unsigned char* data, size_t dataLen, size_t scanFrom, const FRAME_CALLBACK& frameCb, int& count)
+{
+    size_t pos = 0;
+    while (pos < dataLen)
+    {
+        const auto totalLen = probe(data + pos, dataLen - pos, 0 == pos ? scanFrom : 0);
+        if (totalLen < 0)
+        {
+            return -1;
+        }
+        if (0 == totalLen || (size_t)totalLen > dataLen - pos) /* 帧不完整 */
+        {
+            break;
+        }
+        const unsigned char* frame = data + pos;
+        if (frameCb)
+        {
+            switch (m_cfg.type)
+            {
+            case FrameType::fixed:
+                frameCb(nullptr, 0, frame, (size_t)totalLen);
+                break;
+            case FrameType::length:
+                frameCb(frame, m_cfg.headLen, frame + m_cfg.headLen, (size_t)totalLen - m_cfg.headLen);
+                break;
+            case FrameType::delimiter:
+                frameCb(nullptr, 0, frame, (size_t)totalLen - m_cfg.delimiter.size());
+                break;
+            }
+        }
+        pos += (size_t)totalLen;
+        ++count;
+    }
+    return (int64_t)pos;
+}
+
+void FrameDecoder::append(const unsigned char* data, size_t dataLen)
+{
+    if (m_buffer.size() - m_writePos < dataLen)
+    {
+        if (m_readPos > 0) /* 把未读数据移到头部 */
+        {
+            memmove(m_buffer.data(), m_buffer.data() + m_readPos, m_writePos - m_readPos);
+            m_writePos -= m_readPos;
+            m_readPos = 0;
+        }
+        if (m_buffer.size() - m_writePos < dataLen)
+        {
+            m_buffer.resize(std::max(m_writePos + dataLen, m_buffer.size() * 2));
+        }
+    }
+    memcpy(m_buffer.data() + m_writePos, data, dataLen);
+    m_writePos += dataLen;
+}
+} // namespace nsocket
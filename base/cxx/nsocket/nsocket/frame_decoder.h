@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace nsocket
+{
+/**
+ * @brief 分帧方式
+ */
+enum class FrameType
+{
+    fixed = 0, /* 固定长度 */
+    length, /* 长度前缀(包头中包含包体长度字段) */
+    delimiter /* 分隔符 */
+};
+
+/**
+ * @brief 分帧配置
+ */
+struct FrameConfig
+{
+    FrameType type = FrameType::length; /* 分帧方式 */
+    size_t fixedLen = 0; /* [fixed]帧长度 */
+    size_t headLen = 4; /* [length]包头长度(包含长度字段) */
+    size_t lengthOffset = 0; /* [length]长度字段在包头中的偏移 */
+    size_t lengthSize = 4; /* [length]长度字段字节数, 值: 1, 2, 4, 8 */
+    bool bigEndian = true; /* [length]长度字段是否为大端字节序 */
+    int64_t lengthAdjust = 0; /* [length]包体长度 = 长度字段值 + lengthAdjust, 例如: 长度字段包含包头长度时为-headLen */
+    std::string delimiter = "\r\n"; /* [delimiter]分隔符(不包含在包体中) */
+    size_t maxBodyLen = 16 * 1024 * 1024; /* 最大包体长度, 超过时视为出错 */
+};
+
+/**
+ * @brief 帧解码器(替代Payload), 说明:
+ *        1.接收缓冲区为连续内存, 使用读/写位置标记有效数据, 不在头部删除数据, 拆包的开销与数据长度成线性关系
+ *        2.缓冲区为空时直接在输入数据上拆包(零拷贝), 只有未完整的帧尾才会拷贝到缓冲区
+ *        3.包头和包体以指针+长度的形式回调, 只在回调期间有效, 每帧无内存分配
+ */
+class FrameDecoder final
+{
+public:
+    /**
+     * @brief 帧回调函数
+     * @param head 包头(分帧方式为fixed/delimiter时为空)
+     * @param headLen 包头长度
+     * @param body 包体
+     * @param bodyLen 包体长度
+     */
+    using FRAME_CALLBACK = std::function<void(const unsigned char* head, size_t headLen, const unsigned char* body, size_t bodyLen)>;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param cfg 分帧配置(非法时抛出异常)
+     */
+    FrameDecoder(const FrameConfig& cfg);
+
+    /**
+     * @brief 获取分帧配置
+     * @return 分帧配置
+     */
+    const FrameConfig& getConfig() const;
+
+    /**
+     * @brief 重置缓冲区
+     */
+    void reset();
+
+    /**
+     * @brief 获取缓冲区中未完整的数据长度
+     * @return 数据长度
+     */
+    size_t getPendingSize() const;
+
+    /**
+     * @brief 对数据进行拼接/拆包
+     * @param data 数据
+     * @param dataLen 数据长度
+     * @param frameCb 帧回调
+     * @return 解析出的帧数量, 小于0表示出错(包体长度非法, 缓冲区已重置)
+     */
+    int decode(const unsigned char* data, size_t dataLen, const FRAME_CALLBACK& frameCb);
+
+private:
+    /**
+     * @brief 计算帧的总长度
+     * @param data 数据
+     * @param dataLen 数据长度
+     * @param scanFrom [delimiter]从此位置开始查找分隔符(之前的数据已查找过)
+     * @return >0-帧总长度(可能大于dataLen, 表示帧不完整), 0-数据不足无法确定, <0-出错
+     */
+    int64_t probe(const unsigned char* data, size_t dataLen, size_t scanFrom) const;
+
+    /**
+     * @brief 拆分完整的帧
+     * @param data 数据
+     * @param dataLen 数据长度
+     * @param scanFrom [delimiter]第1帧从此位置开始查找分隔符
+     * @param frameCb 帧回调
+     * @param count [输出]帧数量
+     * @return 已消耗的数据长度, 小于0表示出错
+     */
+    int64_t split(const unsigned char* data, size_t dataLen, size_t scanFrom, const FRAME_CALLBACK& frameCb, int& count);
+
+    /**
+     * @brief 追加数据到缓冲区
+     * @param data 数据
+     * @param dataLen 数据长度
+     */
+    void append(const unsigned char* data, size_t dataLen);
+
+private:
+    const FrameConfig m_cfg; /* 分帧配置 */
+    std::vector<unsigned char> m_buffer; /* 接收缓冲区 */
+    size_t m_readPos = 0; /* 读位置 */
+    size_t m_writePos = 0; /* 写位置 */
+    size_t m_scanPos = 0; /* [delimiter]缓冲区中已查找过分隔符的长度 */
+};
+} // namespace nsocket
@@ -1,9 +1,29 @@
 #include "client.h"
 
+#include <cstdio>
+
 namespace nsocket
 {
 namespace ftp
 {
+static const size_t TRANSFER_BUFFER_SIZE = 1024 * 1024; /* 文件传输缓冲区大小 */
+static const size_t TRANSFER_TIMEOUT = 60000; /* 等待传输完成响应的超时时间(毫秒) */
+
+/**
+ * @brief 文件定位
+ * @param f 文件
+ * @param offset 偏移
+ * @return true-成功, false-失败
+ */
+static bool seekFile(FILE* f, uint64_t offset)
+{
+#ifdef _WIN32
+    return 0 == _fseeki64(f, (__int64)offset, SEEK_SET);
+#else
+    return 0 == fseeko64(f, (off64_t)offset, SEEK_SET);
+#endif
+}
+
 Client::Client(uint16_t localPort, size_t bz) : m_localPort(localPort), m_bufferSize(bz) {}
 
 Client::~Client()
@@ -174,13 +194,126 @@ boost::asio::ip::tcp::endpoint Client::getRemoteEndpoint()
 bool Client::login(const std::string& user, const std::string& password)
 {
     std::string response;
-    if (sendCommand("USER " + user, ReplyCode::user_ok, &response))
+    if (sendCommand("USER " + user, ReplyCode::NeedPassword, &response))
     {
-        return sendCommand("PASS " + password, ReplyCode::login_ok, &response);
+        return sendCommand("PASS " + password, ReplyCode::LoginSuccess, &response);
     }
     return false;
 }
 
+bool Client::quit()
+{
+    std::string response;
+    return sendCommand("QUIT", ReplyCode::Closing, &response);
+}
+
+int64_t Client::size(const std::string& remotePath)
+{
+    std::string response;
+    if (!sendCommand("SIZE " + remotePath, ReplyCode::FileStatus, &response)
+        || response.empty() || std::string::npos != response.find_first_not_of("0123456789"))
+    {
+        return -1;
+    }
+    return (int64_t)std::stoull(response);
+}
+
+bool Client::download(const std::string& remotePath, const std::string& localPath, uint64_t offset, uint64_t* transferred)
+{
+    if (transferred)
+    {
+        *transferred = 0;
+    }
+    FILE* f = fopen(localPath.c_str(), offset > 0 ? "r+b" : "wb");
+    if (!f)
+    {
+        return false;
+    }
+    const std::shared_ptr<FILE> file(f, fclose);
+    boost::asio::io_context ioContext;
+    boost::asio::ip::tcp::socket socket(ioContext);
+    std::string response;
+    if ((offset > 0 && (!seekFile(f, offset) || !sendCommand("REST " + std::to_string(offset), ReplyCode::FileActionPending, &response)))
+        || !sendCommand("TYPE I", ReplyCode::Success, &response) || !openDataConnection(socket)
+        || !sendCommand("RETR " + remotePath, ReplyCode::FileStatusOk, &response))
+    {
+        return false;
+    }
+    m_transferBuffer.resize(TRANSFER_BUFFER_SIZE);
+    bool writeOk = true;
+    boost::system::error_code code;
+    while (1) /* 读取到服务端关闭数据连接为止 */
+    {
+        const auto length = socket.read_some(boost::asio::buffer(m_transferBuffer), code);
+        if (code)
+        {
+            break;
+        }
+        if (fwrite(m_transferBuffer.data(), 1, length, f) != length)
+        {
+            writeOk = false;
+            break;
+        }
+        if (transferred)
+        {
+            *transferred += length;
+        }
+    }
+    socket.close(code);
+    const bool replyOk = waitForReply(ReplyCode::TransferComplete, &response, TRANSFER_TIMEOUT);
+    return writeOk && 0 == fflush(f) && replyOk;
+}
+
+bool Client::upload(const std::string& localPath, const std::string& remotePath, uint64_t offset, uint64_t* transferred)
+{
+    if (transferred)
+    {
+        *transferred = 0;
+    }
+    FILE* f = fopen(localPath.c_str(), "rb");
+    if (!f)
+    {
+        return false;
+    }
+    const std::shared_ptr<FILE> file(f, fclose);
+    boost::asio::io_context ioContext;
+    boost::asio::ip::tcp::socket socket(ioContext);
+    std::string response;
+    if ((offset > 0 && (!seekFile(f, offset) || !sendCommand("REST " + std::to_string(offset), ReplyCode::FileActionPending, &response)))
+        || !sendCommand("TYPE I", ReplyCode::Success, &response) || !openDataConnection(socket)
+        || !sendCommand("STOR " + remotePath, ReplyCode::FileStatusOk, &response))
+    {
+        return false;
+    }
+    m_transferBuffer.resize(TRANSFER_BUFFER_SIZE);
+    bool sendOk = true;
+    boost::system::error_code code;
+    while (1)
+    {
+        const auto length = fread(m_transferBuffer.data(), 1, m_transferBuffer.size(), f);
+        if (0 == length)
+        {
+            sendOk = (0 == ferror(f));
+            break;
+        }
+        boost::asio::write(socket, boost::asio::buffer(m_transferBuffer.data(), length), code);
+        if (code)
+        {
+            sendOk = false;
+            break;
+        }
+        if (transferred)
+        {
+            *transferred += length;
+        }
+    }
+    /* 关闭数据连接表示文件结束 */
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_send, code);
+    socket.close(code);
+    const bool replyOk = waitForReply(ReplyCode::TransferComplete, &response, TRANSFER_TIMEOUT);
+    return sendOk && replyOk;
+}
+
 void Client::stop()
 {
     std::shared_ptr<TcpClient> tcpClient = nullptr;
@@ -224,28 +357,44 @@ void Client::handleData(const std::vector<unsigned char>& data)
             line = m_cmdBuffer.substr(0, pos);
             m_cmdBuffer.erase(0, pos + 2);
         }
+        /* 响应格式: "3位应答码 文本", 多行响应的中间行为"3位应答码-文本", 只取最后一行 */
+        if (line.size() < 3 || std::string::npos != line.substr(0, 3).find_first_not_of("0123456789")
+            || (line.size() > 3 && ' ' != line[3]))
+        {
+            continue;
+        }
+        const auto code = (ReplyCode)std::stoi(line.substr(0, 3));
+        {
+            std::lock_guard<std::mutex> locker(m_mutexReply);
+            m_replyQueue.push(std::make_pair(code, line.size() > 4 ? line.substr(4) : std::string()));
+        }
+        m_cvReply.notify_all();
     }
 }
 
 bool Client::waitForReply(const ReplyCode& expectedCode, std::string* response, size_t timeout)
 {
     timeout = (0 == timeout) ? 2000 : timeout;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
     std::unique_lock<std::mutex> locker(m_mutexReply);
-    auto status = m_cvReply.wait_for(locker, std::chrono::milliseconds(timeout),
-                                     [&, expectedCode]() { return (!m_replyQueue.empty() && expectedCode == m_replyQueue.front().first); });
-    if (status)
+    while (m_cvReply.wait_until(locker, deadline, [&]() { return !m_replyQueue.empty(); }))
     {
+        const auto reply = m_replyQueue.front();
+        m_replyQueue.pop();
+        if (ReplyCode::Ready == reply.first && ReplyCode::Ready != expectedCode) /* 跳过连接时的欢迎信息 */
+        {
+            continue;
+        }
         if (response)
         {
-            *response = m_replyQueue.front().second;
+            *response = reply.second;
         }
-        m_replyQueue.pop();
-        return true;
+        return (expectedCode == reply.first);
     }
     return false;
 }
 
-bool Client::sendCommand(const std::string& cmd, const ReplyCode& expectedCode, std::string* response)
+bool Client::sendCommand(const std::string& cmd, const ReplyCode& expectedCode, std::string* response, size_t timeout)
 {
     std::shared_ptr<TcpClient> tcpClient;
     {
@@ -264,7 +413,32 @@ bool Client::sendCommand(const std::string& cmd, const ReplyCode& expectedCode,
         return false;
     }
     /* 等待响应 */
-    return waitForReply(expectedCode, response);
+    return waitForReply(expectedCode, response, timeout);
+}
+
+bool Client::openDataConnection(boost::asio::ip::tcp::socket& socket)
+{
+    std::string response;
+    if (!sendCommand("PASV", ReplyCode::PassiveMode, &response))
+    {
+        return false;
+    }
+    /* 响应格式: Entering Passive Mode (h1,h2,h3,h4,p1,p2) */
+    int h1, h2, h3, h4, p1, p2;
+    const auto pos = response.find('(');
+    if (std::string::npos == pos || 6 != sscanf(response.c_str() + pos, "(%d,%d,%d,%d,%d,%d)", &h1, &h2, &h3, &h4, &p1, &p2))
+    {
+        return false;
+    }
+    const auto host = std::to_string(h1) + "." + std::to_string(h2) + "." + std::to_string(h3) + "." + std::to_string(h4);
+    boost::system::error_code code;
+    const auto addr = boost::asio::ip::make_address(host, code);
+    if (code)
+    {
+        return false;
+    }
+    socket.connect(boost::asio::ip::tcp::endpoint(addr, (uint16_t)(p1 * 256 + p2)), code);
+    return !code;
 }
 } // namespace ftp
 } // namespace nsocket
@@ -6,25 +6,12 @@
 #include <string>
 
 #include "../tcp/tcp_client.h"
+#include "type_def.h"
 
 namespace nsocket
 {
 namespace ftp
 {
-enum class ReplyCode
-{
-    ready = 220,
-    user_ok = 331,
-    login_ok = 230,
-    data_conn_open = 150,
-    transfer_complete = 226,
-    command_ok = 200,
-    path_created = 257,
-    closing = 221,
-    bad_command = 500,
-    file_unavailable = 550
-};
-
 /**
  * @brief FTP客户端(注意: 需要实例化为共享指针否则会报错)
  */
@@ -120,8 +107,47 @@ public:
      */
     boost::asio::ip::tcp::endpoint getRemoteEndpoint();
 
+    /**
+     * @brief 登录(在其他线程中调用, 以下接口均为阻塞调用, 不能在多个线程中同时调用)
+     * @param user 用户名
+     * @param password 密码
+     * @return true-成功, false-失败
+     */
     bool login(const std::string& user, const std::string& password);
 
+    /**
+     * @brief 退出(服务端关闭连接后, run返回)
+     * @return true-成功, false-失败
+     */
+    bool quit();
+
+    /**
+     * @brief 获取远端文件大小(SIZE)
+     * @param remotePath 远端文件路径
+     * @return 文件大小, <0表示失败
+     */
+    int64_t size(const std::string& remotePath);
+
+    /**
+     * @brief 下载文件(被动模式, 二进制传输)
+     * @param remotePath 远端文件路径
+     * @param localPath 本地文件路径
+     * @param offset 断点续传偏移(REST), 0表示从头下载(覆盖本地文件), >0表示从本地文件的该位置开始续写
+     * @param transferred [输出]本次传输的字节数
+     * @return true-成功, false-失败
+     */
+    bool download(const std::string& remotePath, const std::string& localPath, uint64_t offset = 0, uint64_t* transferred = nullptr);
+
+    /**
+     * @brief 上传文件(被动模式, 二进制传输)
+     * @param localPath 本地文件路径
+     * @param remotePath 远端文件路径
+     * @param offset 断点续传偏移(REST), 0表示从头上传(覆盖远端文件), >0表示从本地文件的该位置开始上传并续写远端文件
+     * @param transferred [输出]本次传输的字节数
+     * @return true-成功, false-失败
+     */
+    bool upload(const std::string& localPath, const std::string& remotePath, uint64_t offset = 0, uint64_t* transferred = nullptr);
+
 private:
     /**
      * @brief 停止
@@ -145,16 +171,26 @@ private:
      * @param expectedCode 期待应答码
      * @param response [输出]响应内容
      * @param timeout 超时时间(单位: 毫秒)
+     * @return true-收到期待的应答码, false-超时或收到其他应答码
      */
     bool waitForReply(const ReplyCode& expectedCode, std::string* response, size_t timeout = 5000);
 
     /**
-     * @brief response
-     * @param cmd 命令 
+     * @brief 发送命令并等待响应
+     * @param cmd 命令
      * @param expectedCode 期待应答码
-     * @param response 超时时间(单位: 毫秒)
+     * @param response [输出]响应内容
+     * @param timeout 超时时间(单位: 毫秒)
+     * @return true-成功, false-失败
+     */
+    bool sendCommand(const std::string& cmd, const ReplyCode& expectedCode, std::string* response, size_t timeout = 5000);
+
+    /**
+     * @brief 建立数据连接(发送PASV并连接到服务端返回的地址)
+     * @param socket 套接字
+     * @return true-成功, false-失败
      */
-    bool sendCommand(const std::string& cmd, const ReplyCode& expectedCode, std::string* response);
+    bool openDataConnection(boost::asio::ip::tcp::socket& socket);
 
 private:
     const uint16_t m_localPort; /* 本地端口, 0表示使用自动分配 */
@@ -170,6 +206,7 @@ private:
     std::mutex m_mutexReply;
     std::condition_variable m_cvReply; /* 命令响应条件变量 */
     std::queue<std::pair<ReplyCode, std::string>> m_replyQueue; /* 响应队列 */
+    std::vector<char> m_transferBuffer; /* 文件传输缓冲区(复用) */
 };
 } // namespace ftp
 } // namespace nsocket
@@ -14,9 +14,10 @@ Server::Server(const std::string& name, size_t threadCount, const std::string& h
 Server::~Server()
 {
     m_tcpServer->stop();
+    std::unordered_map<uint64_t, std::shared_ptr<Session>> sessionMap; /* 在锁外释放会话(析构时会等待传输线程退出) */
     {
         std::lock_guard<std::mutex> locker(m_mutexSessionMap);
-        m_sessionMap.clear();
+        sessionMap.swap(m_sessionMap);
     }
 }
 
@@ -28,6 +29,18 @@ void Server::setRootPath(const std::string& rootPath)
     }
 }
 
+void Server::setTransferConfig(const TransferConfig& cfg)
+{
+    std::lock_guard<std::mutex> locker(m_mutexTransferConfig);
+    m_transferConfig = cfg;
+}
+
+void Server::setLoginCallback(const LOGIN_CALLBACK& cb)
+{
+    std::lock_guard<std::mutex> locker(m_mutexLoginCb);
+    m_loginCb = cb;
+}
+
 bool Server::run(bool sslOn, int sslWay, int certFmt, const std::string& certFile, const std::string& pkFile, const std::string& pkPwd,
                  std::string* errDesc)
 {
@@ -70,9 +83,10 @@ bool Server::run(bool sslOn, int sslWay, int certFmt, const std::string& certFil
 void Server::stop()
 {
     m_tcpServer->stop();
+    std::unordered_map<uint64_t, std::shared_ptr<Session>> sessionMap; /* 在锁外释放会话(析构时会等待传输线程退出) */
     {
         std::lock_guard<std::mutex> locker(m_mutexSessionMap);
-        m_sessionMap.clear();
+        sessionMap.swap(m_sessionMap);
     }
 }
 
@@ -93,11 +107,21 @@ void Server::handleNewConnection(const std::weak_ptr<TcpConnection>& wpConn)
             std::lock_guard<std::mutex> locker(m_mutexRootPath);
             rootPath = m_rootPath;
         }
+        TransferConfig cfg;
+        {
+            std::lock_guard<std::mutex> locker(m_mutexTransferConfig);
+            cfg = m_transferConfig;
+        }
+        LOGIN_CALLBACK loginCb;
+        {
+            std::lock_guard<std::mutex> locker(m_mutexLoginCb);
+            loginCb = m_loginCb;
+        }
         {
             std::lock_guard<std::mutex> lock(m_mutexSessionMap);
             if (m_sessionMap.end() == m_sessionMap.find(cid))
             {
-                session = std::make_shared<Session>(wpConn, rootPath, m_dataBufferSize);
+                session = std::make_shared<Session>(wpConn, rootPath, m_dataBufferSize, cfg, loginCb);
                 m_sessionMap.insert(std::make_pair(cid, session));
             }
         }
@@ -132,11 +156,13 @@ void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, co
 
 void Server::handleConnectionClose(uint64_t cid)
 {
+    std::shared_ptr<Session> session = nullptr; /* 在锁外释放会话(析构时会等待传输线程退出) */
     {
         std::lock_guard<std::mutex> locker(m_mutexSessionMap);
         auto iter = m_sessionMap.find(cid);
         if (m_sessionMap.end() != iter)
         {
+            session = std::move(iter->second);
             m_sessionMap.erase(iter);
         }
     }
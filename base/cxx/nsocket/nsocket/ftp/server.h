@@ -40,6 +40,18 @@ public:
      */
     void setRootPath(const std::string& rootPath);
 
+    /**
+     * @brief 设置传输配置(只对之后建立的会话有效)
+     * @param cfg 传输配置
+     */
+    void setTransferConfig(const TransferConfig& cfg);
+
+    /**
+     * @brief 设置登录验证回调(只对之后建立的会话有效), 未设置时允许任意用户登录, 登录后的权限为只读
+     * @param cb 回调
+     */
+    void setLoginCallback(const LOGIN_CALLBACK& cb);
+
     /**
      * @brief 运行(非阻塞)
      * @param sslOn 是否开启SSL, true-是, false-否
@@ -86,6 +98,10 @@ private:
     const uint32_t m_dataBufferSize; /* 数据连接接收缓冲区大小 */
     std::mutex m_mutexRootPath;
     std::string m_rootPath; /* 根路径 */
+    std::mutex m_mutexTransferConfig;
+    TransferConfig m_transferConfig; /* 传输配置 */
+    std::mutex m_mutexLoginCb;
+    LOGIN_CALLBACK m_loginCb = nullptr; /* 登录验证回调 */
     std::mutex m_mutexSessionMap;
     std::unordered_map<uint64_t, std::shared_ptr<Session>> m_sessionMap; /* 会话表 */
 };
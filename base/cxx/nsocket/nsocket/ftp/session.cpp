@@ -1,13 +1,264 @@
 #include "session.h"
 
+#include <algorithm>
+#include <boost/asio/steady_timer.hpp>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
 #include "server.h"
 
 namespace nsocket
 {
 namespace ftp
 {
-Session::Session(const std::weak_ptr<TcpConnection>& wpConn, const std::string& rootPath, size_t bz)
-    : m_wpConn(wpConn), m_dataBufferSize(bz), m_rootPath(rootPath), m_currentPath("/")
+static const size_t FILE_BLOCK_SIZE = 4096; /* ļС(O_DIRECTҪ󻺳ַ, ļƫƺд볤Ȱ) */
+static const size_t DATA_RECV_SIZE = 256 * 1024; /* ӽջСֵ */
+static const size_t SEND_CHUNK_SIZE = 4 * 1024 * 1024; /* ʱÿη͵󳤶(ÿηͺֹ) */
+static const size_t LIST_BUFFER_SIZE = 64 * 1024; /* Ŀ¼бͻС */
+
+/**
+ * @brief ļϢ
+ */
+struct FileInfo
+{
+    bool isDir = false; /* ǷĿ¼ */
+    uint64_t size = 0; /* С */
+    time_t mtime = 0; /* ޸ʱ */
+    unsigned int mode = 0; /* Ȩ */
+    unsigned int nlink = 1; /* Ӳ */
+};
+
+/**
+ * @brief ȡļϢ
+ * @param path ·
+ * @param info []ļϢ
+ * @return true-ɹ, false-ʧ()
+ */
+static bool getFileInfo(const std::string& path, FileInfo& info)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    if (0 != _stat64(path.c_str(), &st))
+    {
+        return false;
+    }
+    info.isDir = (0 != (st.st_mode & _S_IFDIR));
+#else
+    struct stat st;
+    if (0 != stat(path.c_str(), &st))
+    {
+        return false;
+    }
+    info.isDir = S_ISDIR(st.st_mode);
+#endif
+    info.size = (uint64_t)st.st_size;
+    info.mtime = st.st_mtime;
+    info.mode = (unsigned int)st.st_mode;
+    info.nlink = (unsigned int)st.st_nlink;
+    return true;
+}
+
+/**
+ * @brief ȡļС
+ * @param f ļ
+ * @return ļС, <0ʾʧ
+ */
+static int64_t getFileSize(FILE* f)
+{
+#ifdef _WIN32
+    if (0 != _fseeki64(f, 0, SEEK_END))
+    {
+        return -1;
+    }
+    return _ftelli64(f);
+#else
+    if (0 != fseeko64(f, 0, SEEK_END))
+    {
+        return -1;
+    }
+    return ftello64(f);
+#endif
+}
+
+/**
+ * @brief ϴļ(ʱ, ضϵƫλ, λƫλ)
+ * @param path ·
+ * @param offset ƫ
+ * @param direct ǷʹO_DIRECT(LinuxЧ, ƫδļϵͳ֧ʱʹ)
+ * @param directUsed []ǷʹO_DIRECT
+ * @return ļ, <0ʾʧ
+ */
+static int openStoreFile(const std::string& path, uint64_t offset, bool direct, bool& directUsed)
+{
+    directUsed = false;
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd >= 0 && (0 != _chsize_s(fd, (__int64)offset) || _lseeki64(fd, (__int64)offset, SEEK_SET) < 0))
+    {
+        _close(fd);
+        fd = -1;
+    }
+#else
+    int fd = -1;
+#ifdef __linux__
+    if (direct && 0 == offset % FILE_BLOCK_SIZE)
+    {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_DIRECT, 0644);
+        directUsed = (fd >= 0);
+    }
+#endif
+    if (fd < 0)
+    {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    }
+    if (fd >= 0 && (0 != ftruncate(fd, (off_t)offset) || lseek(fd, (off_t)offset, SEEK_SET) < 0))
+    {
+        close(fd);
+        fd = -1;
+    }
+#endif
+    return fd;
+}
+
+/**
+ * @brief رļ
+ * @param fd ļ
+ */
+static void closeFile(int fd)
+{
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+/**
+ * @brief д
+ * @param fd ļ
+ * @param data 
+ * @param length ݳ
+ * @return true-ɹ, false-ʧ
+ */
+static bool writeFile(int fd, const unsigned char* data, size_t length)
+{
+    size_t written = 0;
+    while (written < length)
+    {
+#ifdef _WIN32
+        const auto ret = _write(fd, data + written, (unsigned int)std::min<size_t>(length - written, 0x40000000));
+#else
+        const auto ret = write(fd, data + written, length - written);
+#endif
+        if (ret > 0)
+        {
+            written += (size_t)ret;
+        }
+        else if (ret < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Ŀ¼
+ * @param path Ŀ¼·
+ * @param func , : , : true-, false-ֹͣ
+ * @return true-ɹ, false-޷Ŀ¼
+ */
+static bool iterateDirectory(const std::string& path, const std::function<bool(const char* name)>& func)
+{
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE h = FindFirstFileA((path + "\\*").c_str(), &data);
+    if (INVALID_HANDLE_VALUE == h)
+    {
+        return false;
+    }
+    do
+    {
+        if (!func(data.cFileName))
+        {
+            break;
+        }
+    } while (FindNextFileA(h, &data));
+    FindClose(h);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+    {
+        return false;
+    }
+    struct dirent* ent = nullptr;
+    while ((ent = readdir(dir)))
+    {
+        if (!func(ent->d_name))
+        {
+            break;
+        }
+    }
+    closedir(dir);
+#endif
+    return true;
+}
+
+/**
+ * @brief ʽĿ¼беǰ׺(ls -l, )
+ * @param info ļϢ
+ * @param now ǰʱ
+ * @param buf []
+ * @param bufSize С
+ * @return 
+ */
+static size_t formatListPrefix(const FileInfo& info, time_t now, char* buf, size_t bufSize)
+{
+    char mode[11] = {0};
+    mode[0] = info.isDir ? 'd' : '-';
+#ifdef _WIN32
+    memcpy(mode + 1, info.isDir ? "rwxr-xr-x" : "rw-r--r--", 9);
+#else
+    static const mode_t BITS[9] = {S_IRUSR, S_IWUSR, S_IXUSR, S_IRGRP, S_IWGRP, S_IXGRP, S_IROTH, S_IWOTH, S_IXOTH};
+    for (int i = 0; i < 9; ++i)
+    {
+        mode[i + 1] = (info.mode & BITS[i]) ? "rwxrwxrwx"[i] : '-';
+    }
+#endif
+    struct tm t;
+#ifdef _WIN32
+    localtime_s(&t, &info.mtime);
+#else
+    localtime_r(&info.mtime, &t);
+#endif
+    char timeStr[32] = {0};
+    const bool recent = (info.mtime <= now + 3600 && now - info.mtime < 180 * 24 * 3600); /* ʾʱ, ʾ */
+    strftime(timeStr, sizeof(timeStr), recent ? "%b %d %H:%M" : "%b %d  %Y", &t);
+    const int len = snprintf(buf, bufSize, "%s %3u ftp      ftp      %12llu %s ", mode, info.nlink, (unsigned long long)info.size, timeStr);
+    return (len > 0) ? std::min<size_t>((size_t)len, bufSize - 1) : 0;
+}
+
+Session::Session(const std::weak_ptr<TcpConnection>& wpConn, const std::string& rootPath, size_t bz, const TransferConfig& cfg,
+                 const LOGIN_CALLBACK& loginCb)
+    : m_wpConn(wpConn)
+    , m_dataBufferSize(bz)
+    , m_cfg(cfg)
+    , m_loginCb(loginCb)
+    , m_dataContext(std::make_shared<boost::asio::io_context>())
+    , m_rootPath(rootPath)
+    , m_currentPath("/")
 {
 #ifdef _WIN32
     /* Windows°ѸĿ¼/\, ȥĩβб */
@@ -21,7 +272,24 @@ Session::Session(const std::weak_ptr<TcpConnection>& wpConn, const std::string&
 
 Session::~Session()
 {
-    closeDataConnection();
+    /* ֹڽеĴ䲢ȴ߳˳ */
+    abortTransfer();
+    m_dataContext->stop();
+    if (m_transferThread.joinable())
+    {
+        m_transferThread.join();
+    }
+    std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        acceptor = m_dataAcceptor;
+        m_dataAcceptor = nullptr;
+    }
+    if (acceptor)
+    {
+        boost::system::error_code code;
+        acceptor->close(code);
+    }
 }
 
 uint64_t Session::getId() const
@@ -92,17 +360,28 @@ void Session::handleCommand(const std::string& cmdLine)
         return;
     }
     std::string cmd, arg;
-    auto pos = cmdLine.find(' ');
+    const auto start = cmdLine.find_first_not_of("\xFF\xF4\xF2"); /* ͻABORǰ͵Telnetж(IAC IP)ͬ(IAC DM)ַ */
+    if (std::string::npos == start)
+    {
+        return;
+    }
+    const auto pos = cmdLine.find(' ', start);
     if (std::string::npos == pos)
     {
-        cmd = cmdLine;
+        cmd = cmdLine.substr(start);
     }
     else
     {
-        cmd = cmdLine.substr(0, pos);
+        cmd = cmdLine.substr(start, pos - start);
         arg = cmdLine.substr(pos + 1);
     }
-    switch (parseCommand(cmd))
+    const auto command = parseCommand(cmd);
+    if (!m_loggedIn && Command::USER != command && Command::PASS != command && Command::QUIT != command && Command::FEAT != command)
+    {
+        sendReply(ReplyCode::NotLoggedIn, "Please login with USER and PASS");
+        return;
+    }
+    switch (command)
     {
     case Command::USER:
         handleUser(arg);
@@ -128,6 +407,12 @@ void Session::handleCommand(const std::string& cmdLine)
     case Command::STOR:
         handleStor(arg);
         break;
+    case Command::REST:
+        handleRest(arg);
+        break;
+    case Command::SIZE:
+        handleSize(arg);
+        break;
     case Command::LIST:
         handleList(arg);
         break;
@@ -164,15 +449,55 @@ void Session::handleCommand(const std::string& cmdLine)
     case Command::NOOP:
         handleNoop();
         break;
+    case Command::ABOR:
+        handleAbor();
+        break;
+    case Command::FEAT:
+        handleFeat();
+        break;
     default:
         sendReply(ReplyCode::BadCommand, "Unknown command");
         break;
     }
 }
 
-void Session::handleUser(const std::string& arg) {}
+void Session::handleUser(const std::string& arg)
+{
+    if (arg.empty())
+    {
+        sendReply(ReplyCode::BadArguments, "Invalid user name");
+        return;
+    }
+    /* µ¼, ֮ǰĵ¼״̬ */
+    m_user = arg;
+    m_loggedIn = false;
+    m_permission = Permission::None;
+    sendReply(ReplyCode::NeedPassword, "Please specify the password");
+}
 
-void Session::handlePass(const std::string& arg) {}
+void Session::handlePass(const std::string& arg)
+{
+    if (m_loggedIn)
+    {
+        sendReply(ReplyCode::LoginSuccess, "Already logged in");
+        return;
+    }
+    else if (m_user.empty())
+    {
+        sendReply(ReplyCode::BadSequence, "Login with USER first");
+        return;
+    }
+    Permission permission = Permission::ReadOnly;
+    if (m_loginCb && !m_loginCb(m_user, arg, permission))
+    {
+        m_user.clear();
+        sendReply(ReplyCode::NotLoggedIn, "Login incorrect");
+        return;
+    }
+    m_loggedIn = true;
+    m_permission = permission;
+    sendReply(ReplyCode::LoginSuccess, "Login successful");
+}
 
 void Session::handleQuit()
 {
@@ -184,76 +509,814 @@ void Session::handleQuit()
     }
 }
 
-void Session::handlePort(const std::string& arg) {}
+void Session::handlePort(const std::string& arg)
+{
+    if (m_transferring)
+    {
+        sendReply(ReplyCode::BadSequence, "Transfer in progress");
+        return;
+    }
+    /* ʽ: h1,h2,h3,h4,p1,p2 */
+    int values[6] = {0};
+    size_t count = 0, pos = 0;
+    while (count < 6 && pos <= arg.size())
+    {
+        auto end = arg.find(',', pos);
+        end = (std::string::npos == end) ? arg.size() : end;
+        const auto item = arg.substr(pos, end - pos);
+        if (item.empty() || item.size() > 3 || std::string::npos != item.find_first_not_of("0123456789"))
+        {
+            break;
+        }
+        values[count] = atoi(item.c_str());
+        if (values[count] > 255)
+        {
+            break;
+        }
+        ++count;
+        pos = end + 1;
+    }
+    const auto conn = m_wpConn.lock();
+    if (6 != count || pos <= arg.size() || !conn)
+    {
+        sendReply(ReplyCode::BadArguments, "Illegal PORT command");
+        return;
+    }
+    const boost::asio::ip::address_v4 addr(boost::asio::ip::address_v4::bytes_type{
+        {(unsigned char)values[0], (unsigned char)values[1], (unsigned char)values[2], (unsigned char)values[3]}});
+    if (addr != conn->getRemoteEndpoint().address()) /* ֻӿͻ, ֹFTPת */
+    {
+        sendReply(ReplyCode::BadArguments, "Illegal PORT address");
+        return;
+    }
+    std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        acceptor = m_dataAcceptor;
+        m_dataAcceptor = nullptr;
+        m_activePoint = std::make_shared<boost::asio::ip::tcp::endpoint>(addr, (uint16_t)(values[4] * 256 + values[5]));
+    }
+    if (acceptor)
+    {
+        boost::system::error_code code;
+        acceptor->close(code);
+    }
+    sendReply(ReplyCode::Success, "PORT command successful");
+}
 
-void Session::handlePasv() {}
+void Session::handlePasv()
+{
+    if (m_transferring)
+    {
+        sendReply(ReplyCode::BadSequence, "Transfer in progress");
+        return;
+    }
+    const auto conn = m_wpConn.lock();
+    if (!conn)
+    {
+        return;
+    }
+    const auto localAddr = conn->getLocalEndpoint().address();
+    if (!localAddr.is_v4())
+    {
+        sendReply(ReplyCode::CommandNotImplemented, "PASV is only supported on IPv4");
+        return;
+    }
+    std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+    try
+    {
+        acceptor = std::make_shared<boost::asio::ip::tcp::acceptor>(*m_dataContext, boost::asio::ip::tcp::endpoint(localAddr, 0));
+    }
+    catch (...)
+    {
+        sendReply(ReplyCode::CantOpenDataConn, "Can't open passive connection");
+        return;
+    }
+    const auto port = acceptor->local_endpoint().port();
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        std::swap(acceptor, m_dataAcceptor);
+        m_activePoint = nullptr;
+    }
+    if (acceptor) /* ر֮ǰδʹõĽ */
+    {
+        boost::system::error_code code;
+        acceptor->close(code);
+    }
+    const auto bytes = localAddr.to_v4().to_bytes();
+    sendReply(ReplyCode::PassiveMode, "Entering Passive Mode (" + std::to_string(bytes[0]) + "," + std::to_string(bytes[1]) + ","
+                                          + std::to_string(bytes[2]) + "," + std::to_string(bytes[3]) + "," + std::to_string(port / 256)
+                                          + "," + std::to_string(port % 256) + ")");
+}
 
 void Session::handleType(const std::string& arg)
 {
-    if ("A" == arg || "a" == arg)
+    if ("A" == arg || "a" == arg || "A N" == arg || "a n" == arg)
     {
+        sendReply(ReplyCode::Success, "Switching to ASCII mode");
     }
-    else if ("I" == arg || "i" == arg)
+    else if ("I" == arg || "i" == arg || "L 8" == arg || "l 8" == arg)
     {
+        sendReply(ReplyCode::Success, "Switching to Binary mode");
     }
     else
     {
+        sendReply(ReplyCode::BadArguments, "Unrecognised TYPE command");
     }
 }
 
-void Session::handleRetr(const std::string& arg) {}
+void Session::handleRetr(const std::string& arg)
+{
+    if (m_transferring)
+    {
+        sendReply(ReplyCode::BadSequence, "Transfer in progress");
+        return;
+    }
+    else if (!checkPermission(Permission::FileRead))
+    {
+        return;
+    }
+    const auto offset = m_restOffset;
+    m_restOffset = 0;
+    const auto localPath = toLocalPath(toVirtualPath(arg));
+    FileInfo info;
+    FILE* f = nullptr;
+    if (!getFileInfo(localPath, info) || info.isDir || !(f = fopen(localPath.c_str(), "rb")))
+    {
+        sendReply(ReplyCode::FileUnavailable, "Failed to open file");
+        return;
+    }
+    const std::shared_ptr<FILE> file(f, fclose);
+    const auto fileSize = getFileSize(f);
+    if (fileSize < 0 || offset > (uint64_t)fileSize)
+    {
+        sendReply(ReplyCode::FileUnavailable, "Invalid restart offset");
+        return;
+    }
+    sendReply(ReplyCode::FileStatusOk,
+              "Opening BINARY mode data connection for " + arg + " (" + std::to_string(fileSize - offset) + " bytes)");
+    startTransfer([this, file, offset, fileSize]() { return sendFileData(file.get(), offset, (uint64_t)fileSize - offset); });
+}
 
-void Session::handleStor(const std::string& arg) {}
+void Session::handleStor(const std::string& arg)
+{
+    if (m_transferring)
+    {
+        sendReply(ReplyCode::BadSequence, "Transfer in progress");
+        return;
+    }
+    else if (!checkPermission(Permission::FileWrite))
+    {
+        return;
+    }
+    const auto offset = m_restOffset;
+    m_restOffset = 0;
+    const auto localPath = toLocalPath(toVirtualPath(arg));
+    FileInfo info;
+    bool direct = false;
+    const int fd = (getFileInfo(localPath, info) && info.isDir) ? -1 : openStoreFile(localPath, offset, m_cfg.directWrite, direct);
+    if (fd < 0)
+    {
+        sendReply(ReplyCode::FileUnavailable, "Could not create file");
+        return;
+    }
+    sendReply(ReplyCode::FileStatusOk, "Ok to send data");
+    startTransfer([this, fd, direct]() {
+        m_storeDirect = direct;
+        return recvFileData(fd);
+    });
+}
 
-void Session::handleList(const std::string& arg) {}
+void Session::handleRest(const std::string& arg)
+{
+    if (arg.empty() || arg.size() > 19 || std::string::npos != arg.find_first_not_of("0123456789"))
+    {
+        sendReply(ReplyCode::BadArguments, "Invalid REST parameter");
+        return;
+    }
+    m_restOffset = std::stoull(arg);
+    sendReply(ReplyCode::FileActionPending, "Restart position accepted (" + arg + ")");
+}
+
+void Session::handleSize(const std::string& arg)
+{
+    if (!checkPermission(Permission::FileRead))
+    {
+        return;
+    }
+    FileInfo info;
+    if (!getFileInfo(toLocalPath(toVirtualPath(arg)), info) || info.isDir)
+    {
+        sendReply(ReplyCode::FileUnavailable, "Could not get file size");
+        return;
+    }
+    sendReply(ReplyCode::FileStatus, std::to_string(info.size));
+}
+
+void Session::handleList(const std::string& arg)
+{
+    if (m_transferring)
+    {
+        sendReply(ReplyCode::BadSequence, "Transfer in progress");
+        return;
+    }
+    else if (!checkPermission(Permission::DirList))
+    {
+        return;
+    }
+    /* ls, : LIST -la */
+    std::string path = arg;
+    while (!path.empty() && '-' == path[0])
+    {
+        const auto pos = path.find(' ');
+        path = (std::string::npos == pos) ? "" : path.substr(pos + 1);
+    }
+    const auto localPath = toLocalPath(toVirtualPath(path));
+    FileInfo info;
+    if (!getFileInfo(localPath, info))
+    {
+        sendReply(ReplyCode::FileUnavailable, "No such file or directory");
+        return;
+    }
+    sendReply(ReplyCode::FileStatusOk, "Here comes the directory listing");
+    startTransfer([this, localPath]() { return sendListData(localPath, false); });
+}
 
-void Session::handleNlst(const std::string& arg) {}
+void Session::handleNlst(const std::string& arg)
+{
+    if (m_transferring)
+    {
+        sendReply(ReplyCode::BadSequence, "Transfer in progress");
+        return;
+    }
+    else if (!checkPermission(Permission::DirList))
+    {
+        return;
+    }
+    const auto localPath = toLocalPath(toVirtualPath(arg));
+    FileInfo info;
+    if (!getFileInfo(localPath, info))
+    {
+        sendReply(ReplyCode::FileUnavailable, "No such file or directory");
+        return;
+    }
+    sendReply(ReplyCode::FileStatusOk, "Here comes the directory listing");
+    startTransfer([this, localPath]() { return sendListData(localPath, true); });
+}
 
-void Session::handleCwd(const std::string& arg) {}
+void Session::handleCwd(const std::string& arg)
+{
+    const auto virtualPath = toVirtualPath(arg);
+    FileInfo info;
+    if (!getFileInfo(toLocalPath(virtualPath), info) || !info.isDir)
+    {
+        sendReply(ReplyCode::FileUnavailable, "Failed to change directory");
+        return;
+    }
+    m_currentPath = virtualPath;
+    sendReply(ReplyCode::FileActionOk, "Directory successfully changed");
+}
 
-void Session::handleCdup() {}
+void Session::handleCdup()
+{
+    handleCwd("..");
+}
 
-void Session::handlePwd() {}
+void Session::handlePwd()
+{
+    sendReply(ReplyCode::PathCreated, "\"" + m_currentPath + "\" is the current directory");
+}
 
-void Session::handleMkd(const std::string& arg) {}
+void Session::handleMkd(const std::string& arg)
+{
+    if (!checkPermission(Permission::DirCreate))
+    {
+        return;
+    }
+    sendReply(ReplyCode::CommandNotImplemented, "Command not implemented");
+}
 
-void Session::handleRmd(const std::string& arg) {}
+void Session::handleRmd(const std::string& arg)
+{
+    if (!checkPermission(Permission::DirDelete))
+    {
+        return;
+    }
+    sendReply(ReplyCode::CommandNotImplemented, "Command not implemented");
+}
 
-void Session::handleDele(const std::string& arg) {}
+void Session::handleDele(const std::string& arg)
+{
+    if (!checkPermission(Permission::FileDelete))
+    {
+        return;
+    }
+    sendReply(ReplyCode::CommandNotImplemented, "Command not implemented");
+}
 
-void Session::handleRnfr(const std::string& arg) {}
+void Session::handleRnfr(const std::string& arg)
+{
+    FileInfo info;
+    const bool isDir = getFileInfo(toLocalPath(toVirtualPath(arg)), info) && info.isDir;
+    if (!checkPermission(isDir ? Permission::DirRename : Permission::FileRename))
+    {
+        return;
+    }
+    sendReply(ReplyCode::CommandNotImplemented, "Command not implemented");
+}
 
-void Session::handleRnto(const std::string& arg) {}
+void Session::handleRnto(const std::string& arg)
+{
+    if (!checkPermission(Permission::FileRename | Permission::DirRename))
+    {
+        return;
+    }
+    sendReply(ReplyCode::CommandNotImplemented, "Command not implemented");
+}
 
-void Session::handleSyst() {}
+void Session::handleSyst()
+{
+    sendReply(ReplyCode::SystemType, "UNIX Type: L8");
+}
 
-void Session::handleNoop() {}
+void Session::handleNoop()
+{
+    sendReply(ReplyCode::Success, "NOOP ok");
+}
 
-void Session::setupDataConnection()
+void Session::handleAbor()
 {
-    if (m_dataConn && m_dataConn->isConnected())
+    bool transferring = false;
     {
-        sendReply(ReplyCode::DataConnOpen, "Data connection open");
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        transferring = m_transferring;
+        m_abortCmd = transferring;
+    }
+    if (transferring) /* ɴ߳Ӧ(ֹʱΪ426), Ӧ226 */
+    {
+        abortTransfer();
     }
     else
     {
-        sendReply(ReplyCode::FileUnavailable, "No data connection");
+        sendReply(ReplyCode::TransferComplete, "No transfer to abort");
+    }
+}
+
+void Session::handleFeat()
+{
+    auto conn = m_wpConn.lock();
+    if (conn)
+    {
+        const auto code = std::to_string((int)ReplyCode::SystemStatus);
+        const std::string reply = code + "-Features:\r\n SIZE\r\n REST STREAM\r\n" + code + " End\r\n"; /* Ӧ */
+        conn->send(std::vector<unsigned char>(reply.begin(), reply.end()), nullptr);
+    }
+}
+
+bool Session::checkPermission(const Permission& perm)
+{
+    if (Permission::None != (m_permission & perm))
+    {
+        return true;
+    }
+    sendReply(ReplyCode::FileUnavailable, "Permission denied");
+    return false;
+}
+
+std::string Session::toVirtualPath(const std::string& arg) const
+{
+    const std::string fullPath = (!arg.empty() && ('/' == arg[0] || '\\' == arg[0])) ? arg : (m_currentPath + "/" + arg);
+    std::vector<std::string> partList;
+    size_t pos = 0;
+    while (pos <= fullPath.size())
+    {
+        auto end = fullPath.find_first_of("/\\", pos);
+        end = (std::string::npos == end) ? fullPath.size() : end;
+        const auto part = fullPath.substr(pos, end - pos);
+        if (".." == part) /* ڸ·ʱ */
+        {
+            if (!partList.empty())
+            {
+                partList.pop_back();
+            }
+        }
+        else if (!part.empty() && "." != part)
+        {
+            partList.emplace_back(part);
+        }
+        pos = end + 1;
+    }
+    std::string virtualPath;
+    for (const auto& part : partList)
+    {
+        virtualPath.append("/").append(part);
+    }
+    return virtualPath.empty() ? "/" : virtualPath;
+}
+
+std::string Session::toLocalPath(const std::string& virtualPath) const
+{
+    std::string localPath = m_rootPath.empty() ? "." : m_rootPath;
+    while (localPath.size() > 1 && ('/' == localPath.back() || '\\' == localPath.back()))
+    {
+        localPath.pop_back();
+    }
+    if ("/" != virtualPath)
+    {
+        localPath.append(virtualPath);
+    }
+#ifdef _WIN32
+    std::replace(localPath.begin(), localPath.end(), '/', '\\');
+#endif
+    return localPath;
+}
+
+void Session::startTransfer(const std::function<std::pair<ReplyCode, std::string>()>& task)
+{
+    if (m_transferThread.joinable()) /* һδѽ, ߳ */
+    {
+        m_transferThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        m_transferring = true;
+        m_abort = false;
+        m_abortCmd = false;
+    }
+    m_transferThread = std::thread([this, task]() {
+        const auto result = task();
+        /* ȹرӲ״̬Ӧ, ͻյӦʼһδ */
+        closeDataConnection();
+        bool abortCmd = false;
+        {
+            std::lock_guard<std::mutex> locker(m_mutexData);
+            abortCmd = m_abortCmd;
+            m_transferring = false;
+        }
+        sendReply(result.first, result.second);
+        if (abortCmd)
+        {
+            sendReply(ReplyCode::TransferComplete, "ABOR command successful");
+        }
+    });
+}
+
+std::shared_ptr<TcpConnection> Session::setupDataConnection()
+{
+    std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+    std::shared_ptr<boost::asio::ip::tcp::endpoint> activePoint;
+    {
+        /* ÿδǰҪ·PASV/PORT */
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        acceptor = m_dataAcceptor;
+        activePoint = m_activePoint;
+        m_dataAcceptor = nullptr;
+        m_activePoint = nullptr;
+    }
+    if ((!acceptor && !activePoint) || m_abort)
+    {
+        return nullptr;
+    }
+    m_dataContext->restart();
+    boost::asio::ip::tcp::socket socket(*m_dataContext);
+    bool done = false;
+    boost::system::error_code code;
+    const auto handler = [&done, &code](const boost::system::error_code& ec) {
+        done = true;
+        code = ec;
+    };
+    if (acceptor) /* ģʽ: ȴͻ */
+    {
+        acceptor->async_accept(socket, handler);
+    }
+    else /* ģʽ: ӿͻ */
+    {
+        socket.async_connect(*activePoint, handler);
+    }
+    m_dataContext->run_for(m_cfg.dataConnTimeout);
+    boost::system::error_code ec;
+    if (acceptor)
+    {
+        acceptor->close(ec);
+    }
+    if (!done) /* ʱֹ, ȡִص */
+    {
+        socket.close(ec);
+        m_dataContext->restart();
+        m_dataContext->run();
+        return nullptr;
+    }
+    if (code)
+    {
+        return nullptr;
     }
+    auto conn = std::make_shared<TcpConnection>(std::make_shared<SocketTcp>(std::move(socket)), true,
+                                                std::max<size_t>(m_dataBufferSize, DATA_RECV_SIZE));
+    conn->setSendTimeout(m_cfg.idleTimeout);
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        if (m_abort) /* ڼ, ֹ֤ʱҪô˴, Ҫôֹõ */
+        {
+            return nullptr;
+        }
+        m_dataConn = conn;
+    }
+    return conn;
 }
 
 void Session::closeDataConnection()
 {
-    if (m_dataConn && m_dataConn->isConnected())
+    std::shared_ptr<TcpConnection> dataConn;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        dataConn = m_dataConn;
+        m_dataConn = nullptr;
+    }
+    if (dataConn)
+    {
+        dataConn->close();
+    }
+}
+
+void Session::abortTransfer()
+{
+    std::shared_ptr<TcpConnection> dataConn;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexData);
+        m_abort = true;
+        dataConn = m_dataConn;
+    }
+    if (dataConn) /* ֻرնд(ɴ̹߳ر), еķͺͽ */
+    {
+        dataConn->shutdown();
+    }
+    else /* ڵȴ */
+    {
+        m_dataContext->stop();
+    }
+}
+
+void Session::throttle(const std::chrono::steady_clock::time_point& startTime, uint64_t bytes)
+{
+    if (0 == m_cfg.rateLimit)
+    {
+        return;
+    }
+    const auto expectTime = startTime + std::chrono::microseconds(bytes * 1000000 / m_cfg.rateLimit);
+    while (!m_abort) /* ֶ, Ա㼰ʱӦֹ */
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= expectTime)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(expectTime - now, std::chrono::milliseconds(100)));
+    }
+}
+
+void Session::onDataConnectionRecv(const unsigned char* data, size_t length)
+{
+    m_storeBytes += length;
+    m_storeActiveTime = std::chrono::steady_clock::now();
+    while (length > 0)
+    {
+        const auto count = std::min(length, m_fileBufferCapacity - m_fileBufferLen);
+        memcpy(m_fileBufferData + m_fileBufferLen, data, count);
+        m_fileBufferLen += count;
+        data += count;
+        length -= count;
+        if (m_fileBufferLen == m_fileBufferCapacity && !flushFileBuffer(false)) /* ʱд(д) */
+        {
+            m_storeError = true;
+            abortTransfer();
+            return;
+        }
+    }
+    throttle(m_storeStartTime, m_storeBytes);
+}
+
+bool Session::flushFileBuffer(bool final)
+{
+    size_t writeLen = m_fileBufferLen;
+    if (m_storeDirect && final) /* O_DIRECTֻܰд */
+    {
+        writeLen = m_fileBufferLen / FILE_BLOCK_SIZE * FILE_BLOCK_SIZE;
+    }
+    if (writeLen > 0 && !writeFile(m_storeFd, m_fileBufferData, writeLen))
+    {
+#ifdef __linux__
+        if (!m_storeDirect || EINVAL != errno) /* ļϵͳ֧O_DIRECTʱرպ */
+        {
+            return false;
+        }
+        fcntl(m_storeFd, F_SETFL, fcntl(m_storeFd, F_GETFL) & ~O_DIRECT);
+        m_storeDirect = false;
+        if (!writeFile(m_storeFd, m_fileBufferData, writeLen))
+        {
+            return false;
+        }
+#else
+        return false;
+#endif
+    }
+    if (writeLen < m_fileBufferLen) /* βһ, رO_DIRECTд */
     {
-        m_dataConn->close();
-        m_dataConn.reset();
+#ifdef __linux__
+        fcntl(m_storeFd, F_SETFL, fcntl(m_storeFd, F_GETFL) & ~O_DIRECT);
+#endif
+        m_storeDirect = false;
+        if (!writeFile(m_storeFd, m_fileBufferData + writeLen, m_fileBufferLen - writeLen))
+        {
+            return false;
+        }
     }
+    m_fileBufferLen = 0;
+    return true;
 }
 
-void Session::onDataConnectionRecv(const std::vector<unsigned char>& data) {}
+std::pair<ReplyCode, std::string> Session::sendFileData(FILE* f, uint64_t offset, uint64_t length)
+{
+    const auto conn = setupDataConnection();
+    if (!conn)
+    {
+        return std::make_pair(ReplyCode::CantOpenDataConn, "Failed to establish connection");
+    }
+    /* ʱÿ1/10ֿ鷢, ʹƽ */
+    const size_t chunkSize = (m_cfg.rateLimit > 0) ? std::max<size_t>(std::min(m_cfg.rateLimit / 10, SEND_CHUNK_SIZE), FILE_BLOCK_SIZE)
+                                                   : SEND_CHUNK_SIZE;
+    const auto startTime = std::chrono::steady_clock::now();
+    uint64_t sentLength = 0;
+    boost::system::error_code code;
+    while (sentLength < length && !m_abort)
+    {
+        size_t count = 0;
+        conn->sendFile(f, (size_t)(offset + sentLength), (size_t)std::min<uint64_t>(chunkSize, length - sentLength),
+                       [&](const boost::system::error_code& ec, size_t len) {
+                           code = ec;
+                           count = len;
+                       });
+        sentLength += count;
+        if (code)
+        {
+            break;
+        }
+        throttle(startTime, sentLength);
+    }
+    if (sentLength == length)
+    {
+        return std::make_pair(ReplyCode::TransferComplete, "Transfer complete");
+    }
+    else if (boost::asio::error::timed_out == code)
+    {
+        return std::make_pair(ReplyCode::TransferAborted, "Data connection timed out; transfer aborted");
+    }
+    return std::make_pair(ReplyCode::TransferAborted, "Connection closed; transfer aborted");
+}
 
-void Session::sendFileData(const std::string& path) {}
+std::pair<ReplyCode, std::string> Session::recvFileData(int fd)
+{
+    if (m_fileBuffer.empty()) /* (1ڶ) */
+    {
+        m_fileBufferCapacity = std::max(m_cfg.fileBufferSize / FILE_BLOCK_SIZE, (size_t)1) * FILE_BLOCK_SIZE;
+        m_fileBuffer.resize(m_fileBufferCapacity + FILE_BLOCK_SIZE);
+        const auto addr = (uintptr_t)m_fileBuffer.data();
+        m_fileBufferData = m_fileBuffer.data() + (FILE_BLOCK_SIZE - addr % FILE_BLOCK_SIZE) % FILE_BLOCK_SIZE;
+    }
+    m_storeFd = fd;
+    m_storeError = false;
+    m_storeBytes = 0;
+    m_fileBufferLen = 0;
+    const auto conn = setupDataConnection();
+    if (!conn)
+    {
+        closeFile(fd);
+        m_storeFd = -1;
+        return std::make_pair(ReplyCode::CantOpenDataConn, "Failed to establish connection");
+    }
+    boost::system::error_code closeCode;
+    bool idleTimeout = false;
+    boost::asio::steady_timer idleTimer(*m_dataContext);
+    std::function<void(const boost::system::error_code&)> onIdleTimer = [&](const boost::system::error_code& code) {
+        if (code) /* ȡ */
+        {
+            return;
+        }
+        const auto idleTime = std::chrono::steady_clock::now() - m_storeActiveTime;
+        if (idleTime >= m_cfg.idleTimeout) /* гʱ, رնд漴 */
+        {
+            idleTimeout = true;
+            conn->shutdown();
+            return;
+        }
+        idleTimer.expires_after(m_cfg.idleTimeout - idleTime);
+        idleTimer.async_wait(onIdleTimer);
+    };
+    conn->setDataViewCallback([this](const unsigned char* data, size_t length) { onDataConnectionRecv(data, length); });
+    conn->setConnectCallback([&closeCode, &idleTimer](const boost::system::error_code& code) {
+        closeCode = code;
+        if (code) /* ѶϿ, ȡжʱ */
+        {
+            idleTimer.cancel();
+        }
+    });
+    m_storeStartTime = std::chrono::steady_clock::now();
+    m_storeActiveTime = m_storeStartTime;
+    if (m_cfg.idleTimeout > std::chrono::steady_clock::duration::zero())
+    {
+        idleTimer.expires_after(m_cfg.idleTimeout);
+        idleTimer.async_wait(onIdleTimer);
+    }
+    /* ׽, ֱӿʼ, ڵǰ߳дֱͻ˹ر */
+    conn->connect(conn->getRemoteEndpoint(), true);
+    m_dataContext->restart();
+    m_dataContext->run();
+    /* ص˾ֲ, ɴ̹߳ر */
+    conn->setDataViewCallback(nullptr);
+    conn->setConnectCallback(nullptr);
+    const bool flushOk = !m_storeError && flushFileBuffer(true); /* ֹʱҲдѽյ, Աϵ */
+    closeFile(fd);
+    m_storeFd = -1;
+    if (!flushOk)
+    {
+        return std::make_pair(ReplyCode::LocalError, "Failure writing to local file");
+    }
+    else if (idleTimeout)
+    {
+        return std::make_pair(ReplyCode::TransferAborted, "Data connection timed out; transfer aborted");
+    }
+    else if (m_abort || boost::asio::error::eof != closeCode)
+    {
+        return std::make_pair(ReplyCode::TransferAborted, "Connection closed; transfer aborted");
+    }
+    return std::make_pair(ReplyCode::TransferComplete, "Transfer complete");
+}
 
-void Session::recvFileData(const std::string& path) {}
+std::pair<ReplyCode, std::string> Session::sendListData(const std::string& localPath, bool nameOnly)
+{
+    const auto conn = setupDataConnection();
+    if (!conn)
+    {
+        return std::make_pair(ReplyCode::CantOpenDataConn, "Failed to establish connection");
+    }
+    std::vector<unsigned char> buffer;
+    buffer.reserve(LIST_BUFFER_SIZE);
+    bool sendOk = true;
+    const auto flush = [&]() {
+        if (!buffer.empty() && sendOk)
+        {
+            conn->send(buffer.data(), buffer.size(), [&sendOk](const boost::system::error_code& code, size_t length) {
+                sendOk = !code;
+            });
+        }
+        buffer.clear();
+    };
+    const auto now = time(nullptr);
+    char prefix[128];
+    const auto appendEntry = [&](const char* name, const FileInfo& info) {
+        const size_t prefixLen = nameOnly ? 0 : formatListPrefix(info, now, prefix, sizeof(prefix));
+        const size_t nameLen = strlen(name);
+        if (buffer.size() + prefixLen + nameLen + 2 > LIST_BUFFER_SIZE) /* ʱȷ */
+        {
+            flush();
+        }
+        buffer.insert(buffer.end(), prefix, prefix + prefixLen);
+        buffer.insert(buffer.end(), name, name + nameLen);
+        buffer.push_back('\r');
+        buffer.push_back('\n');
+    };
+    FileInfo info;
+    if (getFileInfo(localPath, info) && !info.isDir) /* ļ */
+    {
+        const auto pos = localPath.find_last_of("/\\");
+        appendEntry(localPath.c_str() + (std::string::npos == pos ? 0 : pos + 1), info);
+    }
+    else /* Ŀ¼ */
+    {
+        std::string entryPath;
+        iterateDirectory(localPath, [&](const char* name) {
+            if (0 == strcmp(name, ".") || 0 == strcmp(name, ".."))
+            {
+                return true;
+            }
+#ifdef _WIN32
+            entryPath.assign(localPath).append("\\").append(name);
+#else
+            entryPath.assign(localPath).append("/").append(name);
+#endif
+            FileInfo entryInfo;
+            if (nameOnly || getFileInfo(entryPath, entryInfo))
+            {
+                appendEntry(name, entryInfo);
+            }
+            return sendOk && !m_abort;
+        });
+    }
+    flush();
+    if (sendOk && !m_abort)
+    {
+        return std::make_pair(ReplyCode::TransferComplete, "Directory send OK");
+    }
+    return std::make_pair(ReplyCode::TransferAborted, "Connection closed; transfer aborted");
+}
 } // namespace ftp
 } // namespace nsocket
@@ -1,8 +1,11 @@
 #pragma once
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
 #include "../tcp/tcp_connection.h"
 #include "type_def.h"
@@ -12,14 +15,24 @@ namespace nsocket
 namespace ftp
 {
 /**
- * @brief Ftp会话
+ * @brief Ftp会话, 说明: 每次传输(RETR/STOR/LIST/NLST)在会话的传输线程中进行, 数据连接运行在传输线程私有的上下文中,
+ *        不占用服务器的I/O线程, 同一时刻每个会话只有1个传输, 传输可通过ABOR命令中止, 数据连接空闲超时也会中止传输
  */
 class Session : public std::enable_shared_from_this<Session>
 {
     friend class Server;
 
 public:
-    Session(const std::weak_ptr<TcpConnection>& wpConn, const std::string& rootPath, size_t bz = 4096);
+    /**
+     * @brief 构造函数
+     * @param wpConn 命令连接
+     * @param rootPath 根路径
+     * @param bz 数据连接接收缓冲区大小(字节)
+     * @param cfg 传输配置
+     * @param loginCb 登录验证回调, 为空时允许任意用户登录(权限为只读)
+     */
+    Session(const std::weak_ptr<TcpConnection>& wpConn, const std::string& rootPath, size_t bz = 4096,
+            const TransferConfig& cfg = TransferConfig(), const LOGIN_CALLBACK& loginCb = nullptr);
     ~Session();
 
     /**
@@ -73,6 +86,8 @@ private:
     void handleType(const std::string& arg);
     void handleRetr(const std::string& arg);
     void handleStor(const std::string& arg);
+    void handleRest(const std::string& arg);
+    void handleSize(const std::string& arg);
     void handleList(const std::string& arg);
     void handleNlst(const std::string& arg);
     void handleCwd(const std::string& arg);
@@ -85,11 +100,41 @@ private:
     void handleRnto(const std::string& arg);
     void handleSyst();
     void handleNoop();
+    void handleAbor();
+    void handleFeat();
+
+    /**
+     * @brief 检查当前用户的权限, 无权限时应答550
+     * @param perm 需要的权限(满足其中之一即可)
+     * @return true-有权限, false-无权限
+     */
+    bool checkPermission(const Permission& perm);
+
+    /**
+     * @brief 解析虚拟路径(相对于当前工作路径, 处理.和.., 不会超出根路径)
+     * @param arg 命令参数中的路径
+     * @return 虚拟路径, 以/开头
+     */
+    std::string toVirtualPath(const std::string& arg) const;
+
+    /**
+     * @brief 虚拟路径转换为本地路径
+     * @param virtualPath 虚拟路径
+     * @return 本地路径
+     */
+    std::string toLocalPath(const std::string& virtualPath) const;
+
+    /**
+     * @brief 开始传输(在传输线程中执行, 结束后关闭数据连接, 清除传输状态, 最后发送任务返回的应答)
+     * @param task 传输任务, 返回: 应答码和应答消息
+     */
+    void startTransfer(const std::function<std::pair<ReplyCode, std::string>()>& task);
 
     /**
-     * @brief 设置数据连接
+     * @brief 建立数据连接(在传输线程中调用, 被动模式等待客户端连接, 主动模式连接客户端)
+     * @return 数据连接, 为空表示失败
      */
-    void setupDataConnection();
+    std::shared_ptr<TcpConnection> setupDataConnection();
 
     /**
      * @brief 关闭数据连接
@@ -97,28 +142,83 @@ private:
     void closeDataConnection();
 
     /**
-     * @brief 响应数据连接数据接收
+     * @brief 中止传输(不会阻塞, 可在其他线程中调用), 关闭数据连接的读写使阻塞中的发送/接收立即返回, 传输线程随后结束
+     */
+    void abortTransfer();
+
+    /**
+     * @brief 传输限速(传输量超过配置的速率时休眠)
+     * @param startTime 传输开始时间
+     * @param bytes 已传输的字节数
+     */
+    void throttle(const std::chrono::steady_clock::time_point& startTime, uint64_t bytes);
+
+    /**
+     * @brief 响应数据连接数据接收(上传文件)
      * @param data 数据
+     * @param length 数据长度
+     */
+    void onDataConnectionRecv(const unsigned char* data, size_t length);
+
+    /**
+     * @brief 写入文件缓冲区中的数据
+     * @param final 是否为最后一次写入(写入不足一块的尾部数据)
+     * @return true-成功, false-失败
+     */
+    bool flushFileBuffer(bool final);
+
+    /**
+     * @brief 发送文件数据(下载文件, 普通TCP连接使用sendfile零拷贝发送)
+     * @param f 文件
+     * @param offset 起始偏移
+     * @param length 发送长度
+     * @return 应答码和应答消息
      */
-    void onDataConnectionRecv(const std::vector<unsigned char>& data);
+    std::pair<ReplyCode, std::string> sendFileData(FILE* f, uint64_t offset, uint64_t length);
 
     /**
-     * @brief 发送文件数据
-     * @param path 文件路径
+     * @brief 接收文件数据(上传文件)
+     * @param fd 文件描述符
+     * @return 应答码和应答消息
      */
-    void sendFileData(const std::string& path);
+    std::pair<ReplyCode, std::string> recvFileData(int fd);
 
     /**
-     * @brief 接收文件数据
-     * @param path 文件路径
+     * @brief 发送目录列表(边遍历边发送, 不在内存中构建完整列表)
+     * @param localPath 本地路径(目录或文件)
+     * @param nameOnly 是否只发送名称(NLST)
+     * @return 应答码和应答消息
      */
-    void recvFileData(const std::string& path);
+    std::pair<ReplyCode, std::string> sendListData(const std::string& localPath, bool nameOnly);
 
 private:
     std::weak_ptr<TcpConnection> m_wpConn; /* 命令连接 */
     const uint32_t m_dataBufferSize; /* 数据连接接收缓冲区大小 */
+    const TransferConfig m_cfg; /* 传输配置 */
+    const LOGIN_CALLBACK m_loginCb; /* 登录验证回调 */
+    std::string m_user; /* 用户名(USER命令设置) */
+    bool m_loggedIn = false; /* 是否已登录 */
+    Permission m_permission = Permission::None; /* 当前用户的权限 */
+    std::mutex m_mutexData;
+    std::shared_ptr<boost::asio::io_context> m_dataContext = nullptr; /* 数据连接上下文(在传输线程中运行) */
     std::shared_ptr<boost::asio::ip::tcp::acceptor> m_dataAcceptor = nullptr; /* 数据连接接收器(被动模式才有) */
+    std::shared_ptr<boost::asio::ip::tcp::endpoint> m_activePoint = nullptr; /* 客户端数据端点(主动模式才有) */
     std::shared_ptr<TcpConnection> m_dataConn = nullptr; /* 数据连接 */
+    std::thread m_transferThread; /* 传输线程 */
+    std::atomic<bool> m_transferring = {false}; /* 是否正在传输 */
+    std::atomic<bool> m_abort = {false}; /* 是否中止传输 */
+    bool m_abortCmd = false; /* 是否收到ABOR命令(传输线程在传输应答之后再应答ABOR) */
+    uint64_t m_restOffset = 0; /* 断点续传偏移(REST命令设置, 下一次传输后清零) */
+    std::vector<unsigned char> m_fileBuffer; /* 上传文件缓冲区(分配后复用) */
+    unsigned char* m_fileBufferData = nullptr; /* 上传文件缓冲区首地址(按块对齐, 满足O_DIRECT要求) */
+    size_t m_fileBufferCapacity = 0; /* 上传文件缓冲区容量(块大小的整数倍) */
+    size_t m_fileBufferLen = 0; /* 上传文件缓冲区中待写入的数据长度 */
+    int m_storeFd = -1; /* 上传文件描述符 */
+    bool m_storeDirect = false; /* 上传文件是否使用O_DIRECT写入 */
+    bool m_storeError = false; /* 上传文件是否写入失败 */
+    uint64_t m_storeBytes = 0; /* 上传文件已接收的字节数 */
+    std::chrono::steady_clock::time_point m_storeStartTime; /* 上传开始时间 */
+    std::chrono::steady_clock::time_point m_storeActiveTime; /* 上传最后收到数据的时间 */
     std::string m_cmdBuffer; /* 命令缓冲区 */
     std::string m_rootPath; /* 根路径 */
     std::string m_currentPath; /* 当前工作路径 */
@@ -43,6 +43,14 @@ Command parseCommand(const std::string& cmd)
     {
         return Command::STOR;
     }
+    else if ("REST" == upperCmd)
+    {
+        return Command::REST;
+    }
+    else if ("SIZE" == upperCmd)
+    {
+        return Command::SIZE;
+    }
     else if ("LIST" == upperCmd)
     {
         return Command::LIST;
@@ -91,6 +99,14 @@ Command parseCommand(const std::string& cmd)
     {
         return Command::NOOP;
     }
+    else if ("ABOR" == upperCmd)
+    {
+        return Command::ABOR;
+    }
+    else if ("FEAT" == upperCmd)
+    {
+        return Command::FEAT;
+    }
     return Command::UNKNOWN;
 }
 } // namespace ftp
@@ -1,8 +1,12 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
+#include "permissions.h"
+
 namespace nsocket
 {
 namespace ftp
@@ -20,6 +24,8 @@ enum class Command
     TYPE,
     RETR,
     STOR,
+    REST,
+    SIZE,
     LIST,
     NLST,
     CWD,
@@ -32,6 +38,8 @@ enum class Command
     RNTO,
     SYST,
     NOOP,
+    ABOR,
+    FEAT,
     UNKNOWN
 };
 
@@ -40,23 +48,54 @@ enum class Command
  */
 enum class ReplyCode
 {
+    FileStatusOk = 150,
     Success = 200,
+    SystemStatus = 211,
+    FileStatus = 213,
+    SystemType = 215,
     Ready = 220,
     Closing = 221,
     DataConnOpen = 225,
     TransferComplete = 226,
     PassiveMode = 227,
     LoginSuccess = 230,
+    FileActionOk = 250,
+    PathCreated = 257,
     NeedPassword = 331,
     NeedAccount = 332,
     FileActionPending = 350,
+    CantOpenDataConn = 425,
+    TransferAborted = 426,
+    LocalError = 451,
     CommandNotImplemented = 502,
     BadCommand = 500,
     BadArguments = 501,
+    BadSequence = 503,
     NotLoggedIn = 530,
     FileUnavailable = 550
 };
 
+/**
+ * @brief 传输配置
+ */
+struct TransferConfig
+{
+    size_t rateLimit = 0; /* 每个会话的传输速率限制(字节/秒), 0表示不限制 */
+    size_t fileBufferSize = 4 * 1024 * 1024; /* 上传文件缓冲区大小(字节, 按4096字节对齐), 缓冲区满时才写入文件 */
+    bool directWrite = false; /* 上传文件是否使用O_DIRECT写入(绕过页缓存, 仅Linux有效, 文件系统不支持时自动回退) */
+    std::chrono::steady_clock::duration dataConnTimeout = std::chrono::seconds(10); /* 建立数据连接的超时时间 */
+    std::chrono::steady_clock::duration idleTimeout = std::chrono::seconds(60); /* 数据连接空闲超时时间, 为0表示不超时 */
+};
+
+/**
+ * @brief 登录验证回调(在服务器的I/O线程中回调)
+ * @param user 用户名
+ * @param password 密码
+ * @param permission [输出]登录后的权限, 默认只读
+ * @return true-验证通过, false-用户名或密码错误
+ */
+using LOGIN_CALLBACK = std::function<bool(const std::string& user, const std::string& password, Permission& permission)>;
+
 /**
  * @brief 响应码
  */
@@ -139,6 +139,10 @@ int Request::parse(const unsigned char* data, int length, const HEAD_CALLBACK& h
     {
         return 0;
     }
+    if (ParseStep::finish == m_parseStep) /* 上个请求已结束, 在此才重置, 使得请求对象在响应期间保持完整 */
+    {
+        reset();
+    }
     int totalUsed = 0;
     while (totalUsed < length)
     {
@@ -189,8 +193,14 @@ int Request::parse(const unsigned char* data, int length, const HEAD_CALLBACK& h
                 return 0;
             }
             break;
+        case ParseStep::finish:
+            break;
         }
         totalUsed += used;
+        if (ParseStep::finish == m_parseStep) /* 每次最多解析1个完整请求, 以便调用方按顺序处理流水线请求 */
+        {
+            break;
+        }
     }
     return totalUsed;
 }
@@ -210,11 +220,30 @@ size_t Request::getContentLength()
     return m_contentLength;
 }
 
+bool Request::isKeepAlive()
+{
+    bool keepAlive = !case_insensitive_equal("HTTP/0.9", version) && !case_insensitive_equal("HTTP/1.0", version);
+    auto range = headers.equal_range("Connection");
+    for (auto iter = range.first; range.second != iter; ++iter)
+    {
+        if (case_insensitive_contains(iter->second, "close"))
+        {
+            return false;
+        }
+        else if (case_insensitive_contains(iter->second, "keep-alive"))
+        {
+            keepAlive = true;
+        }
+    }
+    return keepAlive;
+}
+
 void Request::reset()
 {
     method.clear();
     uri.clear();
     queries.clear();
+    params.clear();
     version.clear();
     headers.clear();
     m_sepFlag = SepFlag::none;
@@ -417,6 +446,10 @@ int Request::parseHeader(const unsigned char* data, int length, const HEAD_CALLB
         }
         else if ('\n' == ch)
         {
+            if (SepFlag::r == m_sepFlag && m_tmpKey.empty() && m_tmpValue.empty()) /* 空行(请求无头部字段), 头部结束 */
+            {
+                m_sepFlag = SepFlag::rnr;
+            }
             if (SepFlag::r == m_sepFlag)
             {
                 if (used + 1 < length && '\r' == data[used + 1]) /* 下一个也是'\r' */
@@ -462,7 +495,7 @@ int Request::parseHeader(const unsigned char* data, int length, const HEAD_CALLB
                         {
                             finishCb();
                         }
-                        reset();
+                        m_parseStep = ParseStep::finish;
                     }
                 }
                 return (used + 1);
@@ -589,7 +622,7 @@ int Request::parseChunk(const unsigned char* data, int length, const CONTENT_CAL
                     {
                         finishCb();
                     }
-                    reset();
+                    m_parseStep = ParseStep::finish;
                     return (used + 1);
                 }
                 else
@@ -674,7 +707,7 @@ int Request::parseUnchunk(const unsigned char* data, int length, const CONTENT_C
         {
             finishCb();
         }
-        reset();
+        m_parseStep = ParseStep::finish;
     }
     return used;
 }
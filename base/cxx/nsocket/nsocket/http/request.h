@@ -81,7 +81,7 @@ public:
      * @param headCb 头部回调
      * @param contentCb 内容回调
      * @param finishCb 结束回调
-     * @return 已解析的数据长度, <=0表示解析出错
+     * @return 已解析的数据长度(每次最多解析1个完整请求, 剩余数据需再次调用解析), <=0表示解析出错
      */
     int parse(const unsigned char* data, int length, const HEAD_CALLBACK& headCb, const CONTENT_CALLBACK& contentCb,
               const FINISH_CALLBACK& finishCb);
@@ -104,6 +104,12 @@ public:
      */
     size_t getContentLength();
 
+    /**
+     * @brief 是否保活连接(HTTP/1.1及以上默认保活, 除非`Connection: close`; HTTP/1.0及以下默认不保活, 除非`Connection: keep-alive`)
+     * @return true-保活, false-不保活
+     */
+    bool isKeepAlive();
+
 public:
     std::string host; /* 客户端主机 */
     int port = 0; /* 客户端端口 */
@@ -111,6 +117,7 @@ public:
     bool isMethodAllowed = true; /* 是否允许该方法 */
     std::string uri; /* URI */
     CaseInsensitiveMultimap queries; /* 查询参数 */
+    CaseInsensitiveMultimap params; /* 路径参数(路由URI中`{name}`和通配符匹配到的值) */
     std::string version; /* 版本 */
     CaseInsensitiveMultimap headers; /* 头部 */
 
@@ -239,7 +246,8 @@ private:
         version, /* 版本 */
         header, /* 头部 */
         chunk, /* 分块内容 */
-        unchunk /* 非分块内容 */
+        unchunk, /* 非分块内容 */
+        finish /* 请求结束(下次解析时重置) */
     };
 
     SepFlag m_sepFlag = SepFlag::none; /* 分隔符 */
@@ -0,0 +1,246 @@
+#include "route_tree.h"
+
+#include <algorithm>
+
+namespace nsocket
+{
+namespace http
+{
+/**
+ * @brief 路径段类型
+ */
+enum class SegmentType
+{
+    invalid, /* 非法 */
+    normal, /* 静态路径 */
+    param, /* 路径参数 */
+    wildcard /* 通配符 */
+};
+
+/**
+ * @brief 解析路径段类型
+ * @param segment 路径段
+ * @param name [输出]参数名
+ * @return 路径段类型
+ */
+static SegmentType parseSegment(const std::string& segment, std::string& name)
+{
+    name.clear();
+    if ("*" == segment)
+    {
+        name = "*";
+        return SegmentType::wildcard;
+    }
+    if (segment.size() >= 3 && '{' == segment.front() && '}' == segment.back())
+    {
+        name = segment.substr(1, segment.size() - 2);
+        auto type = SegmentType::param;
+        if ('*' == name.back())
+        {
+            name.pop_back();
+            type = SegmentType::wildcard;
+        }
+        if (name.empty() || std::string::npos != name.find_first_of("{}*"))
+        {
+            return SegmentType::invalid;
+        }
+        return type;
+    }
+    if (std::string::npos != segment.find_first_of("{}*"))
+    {
+        return SegmentType::invalid;
+    }
+    return SegmentType::normal;
+}
+
+bool RouteTree::add(const std::string& uri, const std::shared_ptr<Router>& router)
+{
+    if (uri.empty() || '/' != uri[0] || !router)
+    {
+        return false;
+    }
+    /* 分割路径段 */
+    std::vector<std::string> segments;
+    if (uri.size() > 1)
+    {
+        size_t pos = 1;
+        while (true)
+        {
+            auto end = uri.find('/', pos);
+            segments.emplace_back(uri.substr(pos, std::string::npos == end ? std::string::npos : end - pos));
+            if (std::string::npos == end)
+            {
+                break;
+            }
+            pos = end + 1;
+        }
+    }
+    /* 检查路径段 */
+    std::vector<std::string> paramNames;
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        std::string name;
+        switch (parseSegment(segments[i], name))
+        {
+        case SegmentType::invalid:
+            return false;
+        case SegmentType::normal:
+            break;
+        case SegmentType::param:
+            paramNames.emplace_back(name);
+            break;
+        case SegmentType::wildcard:
+            if (i + 1 != segments.size()) /* 通配符只能作为最后1段 */
+            {
+                return false;
+            }
+            paramNames.emplace_back(name);
+            break;
+        }
+    }
+    auto root = insert(m_root, segments, 0, router, paramNames);
+    if (!root)
+    {
+        return false;
+    }
+    m_root = root;
+    return true;
+}
+
+std::shared_ptr<Router> RouteTree::find(const std::string& uri, CaseInsensitiveMultimap& params) const
+{
+    if (!m_root || uri.empty() || '/' != uri[0])
+    {
+        return nullptr;
+    }
+    std::vector<Capture> captures;
+    auto node = match(m_root.get(), uri, uri.size() > 1 ? 1 : std::string::npos, captures);
+    if (!node)
+    {
+        return nullptr;
+    }
+    for (size_t i = 0; i < captures.size() && i < node->paramNames.size(); ++i)
+    {
+        params.insert(std::make_pair(node->paramNames[i], uri.substr(captures[i].first, captures[i].second)));
+    }
+    return node->router;
+}
+
+std::shared_ptr<const RouteTree::Node> RouteTree::insert(const std::shared_ptr<const Node>& node, const std::vector<std::string>& segments,
+                                                         size_t index, const std::shared_ptr<Router>& router,
+                                                         const std::vector<std::string>& paramNames)
+{
+    auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>(); /* 只复制本节点, 子节点仍与原路由树共享 */
+    if (index == segments.size()) /* 终点 */
+    {
+        if (copy->router) /* 已存在 */
+        {
+            return nullptr;
+        }
+        copy->router = router;
+        copy->paramNames = paramNames;
+        return copy;
+    }
+    const auto& segment = segments[index];
+    std::string name;
+    switch (parseSegment(segment, name))
+    {
+    case SegmentType::param: {
+        auto child = insert(copy->paramChild, segments, index + 1, router, paramNames);
+        if (!child)
+        {
+            return nullptr;
+        }
+        copy->paramChild = child;
+        break;
+    }
+    case SegmentType::wildcard: {
+        if (copy->wildcardChild) /* 已存在 */
+        {
+            return nullptr;
+        }
+        auto child = std::make_shared<Node>();
+        child->router = router;
+        child->paramNames = paramNames;
+        copy->wildcardChild = child;
+        break;
+    }
+    default: {
+        auto iter = std::lower_bound(copy->children.begin(), copy->children.end(), segment,
+                                     [](const std::pair<std::string, std::shared_ptr<const Node>>& item,
+                                        const std::string& key) { return item.first < key; });
+        const bool found = (copy->children.end() != iter && segment == iter->first);
+        auto child = insert(found ? iter->second : nullptr, segments, index + 1, router, paramNames);
+        if (!child)
+        {
+            return nullptr;
+        }
+        if (found)
+        {
+            iter->second = child;
+        }
+        else
+        {
+            copy->children.insert(iter, std::make_pair(segment, child));
+        }
+        break;
+    }
+    }
+    return copy;
+}
+
+const RouteTree::Node* RouteTree::match(const Node* node, const std::string& uri, size_t pos, std::vector<Capture>& captures)
+{
+    if (std::string::npos == pos) /* 已匹配完 */
+    {
+        if (node->router)
+        {
+            return node;
+        }
+        if (node->wildcardChild) /* 通配符匹配空路径 */
+        {
+            captures.emplace_back(uri.size(), 0);
+            return node->wildcardChild.get();
+        }
+        return nullptr;
+    }
+    const auto end = uri.find('/', pos);
+    const size_t segmentLen = (std::string::npos == end ? uri.size() : end) - pos;
+    const size_t next = (std::string::npos == end ? std::string::npos : end + 1);
+    /* 静态路径(二分查找, 直接与URI比较, 避免构造子字符串) */
+    if (!node->children.empty())
+    {
+        auto iter = std::lower_bound(node->children.begin(), node->children.end(), 0,
+                                     [&](const std::pair<std::string, std::shared_ptr<const Node>>& item, int) {
+                                         return uri.compare(pos, segmentLen, item.first) > 0;
+                                     });
+        if (node->children.end() != iter && 0 == uri.compare(pos, segmentLen, iter->first))
+        {
+            auto result = match(iter->second.get(), uri, next, captures);
+            if (result)
+            {
+                return result;
+            }
+        }
+    }
+    /* 路径参数 */
+    if (node->paramChild && segmentLen > 0)
+    {
+        captures.emplace_back(pos, segmentLen);
+        auto result = match(node->paramChild.get(), uri, next, captures);
+        if (result)
+        {
+            return result;
+        }
+        captures.pop_back();
+    }
+    /* 通配符 */
+    if (node->wildcardChild)
+    {
+        captures.emplace_back(pos, uri.size() - pos);
+        return node->wildcardChild.get();
+    }
+    return nullptr;
+}
+} // namespace http
+} // namespace nsocket
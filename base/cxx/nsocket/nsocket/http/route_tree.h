@@ -0,0 +1,84 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "router.h"
+
+namespace nsocket
+{
+namespace http
+{
+/**
+ * @brief 路由树(按路径段压缩的前缀树), 支持以下形式的URI:
+ *        1.静态路径, 例如: /api/dev/list
+ *        2.路径参数(匹配1个非空路径段), 例如: /api/dev/{id}/state
+ *        3.通配符(只能作为最后1段, 匹配剩余的所有路径, 可为空), 例如: `/static/` + `*` 或 /static/{path*}
+ *        匹配优先级: 静态路径 > 路径参数 > 通配符, 捕获的值保存到请求的`params`中(未命名的通配符键名为`*`)
+ *        注意: 节点创建后不再修改, 添加路由时只复制被修改路径上的节点(其余节点与原路由树共享), 因此已发布的路由树可被多个线程无锁读取
+ */
+class RouteTree
+{
+public:
+    /**
+     * @brief 添加路由
+     * @param uri URI(需以'/'开始)
+     * @param router 路由
+     * @return true-成功, false-失败(URI已存在或格式非法)
+     */
+    bool add(const std::string& uri, const std::shared_ptr<Router>& router);
+
+    /**
+     * @brief 查找路由
+     * @param uri URI
+     * @param params [输出]路径参数
+     * @return 路由, 为空表示找不到
+     */
+    std::shared_ptr<Router> find(const std::string& uri, CaseInsensitiveMultimap& params) const;
+
+private:
+    /**
+     * @brief 节点
+     */
+    struct Node
+    {
+        std::vector<std::pair<std::string, std::shared_ptr<const Node>>> children; /* 静态子节点(按路径段排序) */
+        std::shared_ptr<const Node> paramChild = nullptr; /* 路径参数子节点 */
+        std::shared_ptr<const Node> wildcardChild = nullptr; /* 通配符子节点 */
+        std::shared_ptr<Router> router = nullptr; /* 路由(为空表示非终点) */
+        std::vector<std::string> paramNames; /* 终点的参数名列表(按出现顺序) */
+    };
+
+    /**
+     * @brief 捕获的参数值(在URI中的偏移和长度)
+     */
+    using Capture = std::pair<size_t, size_t>;
+
+    /**
+     * @brief 插入节点(复制路径上的节点)
+     * @param node 原节点, 可为空
+     * @param segments 路径段列表
+     * @param index 当前路径段索引
+     * @param router 路由
+     * @param paramNames 参数名列表
+     * @return 新节点, 为空表示插入失败
+     */
+    static std::shared_ptr<const Node> insert(const std::shared_ptr<const Node>& node, const std::vector<std::string>& segments,
+                                              size_t index, const std::shared_ptr<Router>& router, const std::vector<std::string>& paramNames);
+
+    /**
+     * @brief 匹配节点
+     * @param node 当前节点
+     * @param uri URI
+     * @param pos 当前路径段在URI中的起始位置, `std::string::npos`表示已匹配完
+     * @param captures [输出]捕获的参数值
+     * @return 匹配到的终点节点, 为空表示匹配失败
+     */
+    static const Node* match(const Node* node, const std::string& uri, size_t pos, std::vector<Capture>& captures);
+
+private:
+    std::shared_ptr<const Node> m_root = nullptr; /* 根节点 */
+};
+} // namespace http
+} // namespace nsocket
@@ -38,9 +38,8 @@ static bool parseMultipartFormDataBoundary(const std::string& contentType, std::
     return true;
 }
 
-Connector::Connector(const std::function<void(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb)>& sendFunc,
-                     const std::function<void()>& closeFunc)
-    : m_sendFunc(sendFunc), m_closeFunc(closeFunc)
+Connector::Connector(const SEND_FUNC& sendFunc, const SEND_FILE_FUNC& sendFileFunc, const std::function<void()>& closeFunc)
+    : m_sendFunc(sendFunc), m_sendFileFunc(sendFileFunc), m_closeFunc(closeFunc)
 {
 }
 
@@ -56,7 +55,23 @@ void Connector::send(const std::vector<unsigned char>& data, const TCP_SEND_CALL
 {
     if (m_sendFunc)
     {
-        m_sendFunc(data, cb);
+        m_sendFunc(data.data(), data.size(), cb);
+    }
+}
+
+void Connector::send(const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& cb) const
+{
+    if (m_sendFunc)
+    {
+        m_sendFunc(data, length, cb);
+    }
+}
+
+void Connector::sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& cb) const
+{
+    if (m_sendFileFunc)
+    {
+        m_sendFileFunc(f, offset, length, cb);
     }
 }
 
@@ -64,7 +79,7 @@ void Connector::sendAndClose(const std::vector<unsigned char>& data, const TCP_S
 {
     if (m_sendFunc)
     {
-        m_sendFunc(data, cb);
+        m_sendFunc(data.data(), data.size(), cb);
     }
     if (m_closeFunc)
     {
@@ -15,20 +15,37 @@ namespace http
 {
 /**
  * @brief 连接器
+ *        流式响应: 先调用`send`发送响应头部(头部需包含`Content-Length`), 再分块调用`send`/`sendFile`发送包体, 最后调用`close`结束响应
  */
 class Connector
 {
 public:
+    /**
+     * @brief 发送函数
+     * @param data 数据
+     * @param length 数据长度
+     * @param cb 发送回调
+     */
+    using SEND_FUNC = std::function<void(const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& cb)>;
+
+    /**
+     * @brief 发送文件函数
+     * @param f 文件指针
+     * @param offset 文件偏移
+     * @param length 发送长度
+     * @param cb 发送回调
+     */
+    using SEND_FILE_FUNC = std::function<void(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& cb)>;
+
     Connector() = default;
 
     /**
      * @brief 构造函数
      */
-    Connector(const std::function<void(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb)>& sendFunc,
-              const std::function<void()>& closeFunc);
+    Connector(const SEND_FUNC& sendFunc, const SEND_FILE_FUNC& sendFileFunc, const std::function<void()>& closeFunc);
 
     /**
-     * @brief 关闭连接, 主要用于分批发送数据后手动调用
+     * @brief 结束响应, 主要用于分批发送数据后手动调用(非保活连接将被关闭, 保活连接继续处理后续请求)
      */
     void close() const;
 
@@ -40,14 +57,32 @@ public:
     void send(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb = nullptr) const;
 
     /**
-     * @brief 发送数据并关闭连接(同步)
+     * @brief 发送数据(同步, 不拷贝数据, 返回后缓冲区即可复用)
+     * @param data 数据
+     * @param length 数据长度
+     * @param cb 发送回调
+     */
+    void send(const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& cb = nullptr) const;
+
+    /**
+     * @brief 发送文件内容(同步), 普通TCP连接在Linux下由内核直接发送(sendfile), TLS连接读取到复用的缓冲区后发送
+     * @param f 文件指针(由调用者打开和关闭)
+     * @param offset 文件偏移
+     * @param length 发送长度
+     * @param cb 发送回调
+     */
+    void sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& cb = nullptr) const;
+
+    /**
+     * @brief 发送数据并结束响应(同步)
      * @param data 数据
      * @param cb 发送回调
      */
     void sendAndClose(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb = nullptr) const;
 
 private:
-    const std::function<void(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb)> m_sendFunc = nullptr; /* 发送函数 */
+    const SEND_FUNC m_sendFunc = nullptr; /* 发送函数 */
+    const SEND_FILE_FUNC m_sendFileFunc = nullptr; /* 发送文件函数 */
     const std::function<void()> m_closeFunc = nullptr; /* 关闭连接函数 */
 };
 
@@ -1,9 +1,44 @@
 #include "server.h"
 
+#include <algorithm>
+#include <boost/asio/post.hpp>
+
 namespace nsocket
 {
 namespace http
 {
+static const size_t MAX_PENDING_SIZE = (4 * 1024 * 1024); /* 响应期间最多暂存的后续请求数据(字节) */
+
+/**
+ * @brief 在响应头部添加`Connection: close`(响应头部已包含`Connection`时不添加)
+ * @param data 响应数据(需以状态行开始)
+ * @param length 数据长度
+ * @return 添加后的响应数据, 为空表示无需添加
+ */
+static std::vector<unsigned char> insertConnectionClose(const unsigned char* data, size_t length)
+{
+    static const std::string HTTP_PREFIX = "HTTP/";
+    static const std::string CONNECTION_CLOSE = "Connection: close\r\n";
+    if (length < HTTP_PREFIX.size() || !std::equal(HTTP_PREFIX.begin(), HTTP_PREFIX.end(), data))
+    {
+        return {};
+    }
+    const std::string head(data, data + length);
+    const auto lineEnd = head.find("\r\n");
+    const auto headEnd = head.find("\r\n\r\n");
+    if (std::string::npos == lineEnd || std::string::npos == headEnd
+        || case_insensitive_contains(head.substr(lineEnd, headEnd - lineEnd + 2), "\r\nConnection:"))
+    {
+        return {};
+    }
+    std::vector<unsigned char> result;
+    result.reserve(length + CONNECTION_CLOSE.size());
+    result.insert(result.end(), data, data + lineEnd + 2);
+    result.insert(result.end(), CONNECTION_CLOSE.begin(), CONNECTION_CLOSE.end());
+    result.insert(result.end(), data + lineEnd + 2, data + length);
+    return result;
+}
+
 Server::Server(const std::string& name, size_t threadCount, const std::string& host, uint16_t port, bool reuseAddr, size_t bz,
                const std::chrono::steady_clock::duration& handshakeTimeout)
 {
@@ -21,28 +56,39 @@ void Server::setDefaultRouterCallback(const std::function<void(uint64_t cid, con
     m_defaultRouterCb = cb;
 }
 
+void Server::setKeepAlive(bool enable, const std::chrono::steady_clock::duration& idleTimeout, size_t maxRequests)
+{
+    std::lock_guard<std::mutex> locker(m_mutexKeepAlive);
+    m_keepAliveEnabled = enable;
+    m_idleTimeout = idleTimeout;
+    m_maxRequests = maxRequests;
+}
+
 std::vector<std::string> Server::addRouter(const std::vector<Method>& methods, const std::vector<std::string>& uriList,
                                            const std::shared_ptr<Router>& router)
 {
     std::vector<std::string> repeatUriList;
     {
-        std::lock_guard<std::mutex> locker(m_mutexRouterMap);
+        std::lock_guard<std::mutex> locker(m_mutexRouteTree);
+        /* 读-复制-更新: 在当前路由树的副本上添加(只复制被修改路径上的节点), 然后发布新版本, 读取方无需加锁 */
+        const auto current = std::atomic_load(&m_routeTree);
+        auto routeTree = current ? std::make_shared<RouteTree>(*current) : std::make_shared<RouteTree>();
         for (auto uri : uriList)
         {
             if (uri.empty() || '/' != uri[0])
             {
                 uri.insert(uri.begin(), '/');
             }
-            if (m_routerMap.end() == m_routerMap.find(uri)) /* 新的URI */
+            if (routeTree->add(uri, router)) /* 新的URI */
             {
                 router->m_methods = methods;
-                m_routerMap.insert(std::make_pair(uri, router));
             }
-            else /* URI已添加过 */
+            else /* URI已添加过(或格式非法) */
             {
                 repeatUriList.emplace_back(uri);
             }
         }
+        std::atomic_store(&m_routeTree, std::shared_ptr<const RouteTree>(std::move(routeTree)));
     }
     return repeatUriList;
 }
@@ -68,13 +114,14 @@ bool Server::run(bool sslOn, int sslWay, int certFmt, const std::string& certFil
             self->handleNewConnection(wpConn);
         }
     });
-    m_tcpServer->setConnectionDataCallback([wpSelf](const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data) {
-        const auto& self = wpSelf.lock();
-        if (self)
-        {
-            self->handleConnectionData(wpConn, data);
-        }
-    });
+    m_tcpServer->setConnectionDataViewCallback(
+        [wpSelf](const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length) {
+            const auto& self = wpSelf.lock();
+            if (self)
+            {
+                self->handleConnectionData(wpConn, data, length);
+            }
+        });
     m_tcpServer->setConnectionCloseCallback(
         [wpSelf](uint64_t cid, const boost::asio::ip::tcp::endpoint& point, const boost::system::error_code& code) {
             const auto& self = wpSelf.lock();
@@ -101,20 +148,40 @@ void Server::handleNewConnection(const std::weak_ptr<TcpConnection>& wpConn)
     const auto conn = wpConn.lock();
     if (conn)
     {
-        std::lock_guard<std::mutex> locker(m_mutexSessionMap);
-        if (m_sessionMap.end() == m_sessionMap.find(conn->getId()))
+        conn->setNagleEnable(false); /* 保活连接上会连续发送多个小响应, 禁用Nagle算法避免与客户端的延迟确认叠加产生延时 */
+        std::shared_ptr<Session> session = nullptr;
+        {
+            std::lock_guard<std::mutex> locker(m_mutexSessionMap);
+            if (m_sessionMap.end() == m_sessionMap.find(conn->getId()))
+            {
+                session = std::make_shared<Session>();
+                session->wpConn = wpConn;
+                session->req = std::make_shared<Request>();
+                session->req->host = conn->getRemoteEndpoint().address().to_string();
+                session->req->port = (int)conn->getRemoteEndpoint().port();
+                {
+                    std::lock_guard<std::mutex> locker(m_mutexKeepAlive);
+                    session->keepAliveEnabled = m_keepAliveEnabled;
+                    session->idleTimeout = m_idleTimeout;
+                    session->maxRequests = m_maxRequests;
+                }
+                if (session->idleTimeout > std::chrono::steady_clock::duration::zero())
+                {
+                    session->idleTimer = std::make_shared<boost::asio::steady_timer>(conn->getIoContext());
+                }
+                m_sessionMap.insert(std::make_pair(conn->getId(), session));
+            }
+        }
+        if (session)
         {
-            auto session = std::make_shared<Session>();
-            session->wpConn = wpConn;
-            session->req = std::make_shared<Request>();
-            session->req->host = conn->getRemoteEndpoint().address().to_string();
-            session->req->port = (int)conn->getRemoteEndpoint().port();
-            m_sessionMap.insert(std::make_pair(conn->getId(), session));
+            std::lock_guard<std::mutex> locker(session->mutex);
+            session->activeTime = std::chrono::steady_clock::now();
+            startIdleTimer(session);
         }
     }
 }
 
-void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data)
+void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length)
 {
     const auto conn = wpConn.lock();
     if (conn)
@@ -131,42 +198,118 @@ void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, co
         }
         if (session)
         {
-            int used = session->req->parse(
-                data.data(), data.size(), [&]() { handleReqHead(session); },
-                [&](size_t offset, const unsigned char* data, int dataLen) { handleReqContent(session, offset, data, dataLen); },
-                [&]() { handleReqFinish(session); });
-            if (used <= 0) /* 解析失败 */
+            {
+                std::lock_guard<std::mutex> locker(session->mutex);
+                session->activeTime = std::chrono::steady_clock::now();
+                if (session->responding || !session->pendingData.empty()) /* 上个请求未响应结束, 暂存数据, 保证流水线请求按顺序处理 */
+                {
+                    if (session->pendingData.size() + length <= MAX_PENDING_SIZE)
+                    {
+                        session->pendingData.insert(session->pendingData.end(), data, data + length);
+                        return;
+                    }
+                    session->closed = true;
+                }
+            }
+            if (session->closed) /* 暂存数据过多 */
             {
                 conn->close();
+                return;
             }
+            parseData(conn, session, data, length);
+        }
+    }
+}
+
+bool Server::parseData(const std::shared_ptr<TcpConnection>& conn, const std::shared_ptr<Session>& session, const unsigned char* data,
+                       size_t length)
+{
+    size_t offset = 0;
+    while (offset < length)
+    {
+        int used = session->req->parse(
+            data + offset, length - offset, [&]() { handleReqHead(session); },
+            [&](size_t offset, const unsigned char* data, int dataLen) { handleReqContent(session, offset, data, dataLen); },
+            [&]() { handleReqFinish(session); });
+        if (used <= 0) /* 解析失败 */
+        {
+            conn->close();
+            return false;
+        }
+        offset += used;
+        std::lock_guard<std::mutex> locker(session->mutex);
+        if (session->closed)
+        {
+            return false;
+        }
+        if (session->responding) /* 请求正在响应(异步), 剩余数据待响应结束后再解析 */
+        {
+            session->pendingData.insert(session->pendingData.end(), data + offset, data + length);
+            return false;
+        }
+    }
+    return true;
+}
+
+void Server::resumeData(const std::shared_ptr<Session>& session)
+{
+    const auto conn = session->wpConn.lock();
+    if (conn)
+    {
+        std::vector<unsigned char> data;
+        {
+            std::lock_guard<std::mutex> locker(session->mutex);
+            if (session->responding || session->closed)
+            {
+                return;
+            }
+            data.swap(session->pendingData);
+        }
+        if (parseData(conn, session, data.data(), data.size()))
+        {
+            std::lock_guard<std::mutex> locker(session->mutex);
+            startIdleTimer(session);
         }
     }
 }
 
 void Server::handleConnectionClose(uint64_t cid)
 {
-    std::lock_guard<std::mutex> locker(m_mutexSessionMap);
-    auto iter = m_sessionMap.find(cid);
-    if (m_sessionMap.end() != iter)
+    std::shared_ptr<Session> session = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSessionMap);
+        auto iter = m_sessionMap.find(cid);
+        if (m_sessionMap.end() != iter)
+        {
+            session = iter->second;
+            m_sessionMap.erase(iter);
+        }
+    }
+    if (session)
     {
-        m_sessionMap.erase(iter);
+        std::lock_guard<std::mutex> locker(session->mutex);
+        session->closed = true;
+        session->pendingData.clear();
+        if (session->idleTimer)
+        {
+            session->idleTimer->cancel();
+        }
     }
 }
 
 void Server::handleReqHead(const std::shared_ptr<Session>& session)
 {
     const auto conn = session->wpConn.lock();
+    session->router = nullptr;
     if (conn)
     {
         std::shared_ptr<Router> router = nullptr;
+        const auto routeTree = std::atomic_load(&m_routeTree);
+        if (routeTree)
         {
-            std::lock_guard<std::mutex> locker(m_mutexRouterMap);
-            auto iter = m_routerMap.find(session->req->uri);
-            if (m_routerMap.end() != iter)
-            {
-                router = iter->second;
-            }
+            router = routeTree->find(session->req->uri, session->req->params);
         }
+        session->router = router; /* 缓存匹配结果, 避免处理内容和结束时重复查找 */
         if (router) /* 找到路由 */
         {
             /* 判断是否允许请求的方法 */
@@ -201,15 +344,7 @@ void Server::handleReqContent(const std::shared_ptr<Session>& session, size_t of
         const auto conn = session->wpConn.lock();
         if (conn)
         {
-            std::shared_ptr<Router> router = nullptr;
-            {
-                std::lock_guard<std::mutex> locker(m_mutexRouterMap);
-                auto iter = m_routerMap.find(session->req->uri);
-                if (m_routerMap.end() != iter)
-                {
-                    router = iter->second;
-                }
-            }
+            const auto& router = session->router;
             if (router) /* 找到路由 */
             {
                 router->onReqContent(conn->getId(), session->req, offset, data, dataLen);
@@ -223,59 +358,28 @@ void Server::handleReqFinish(const std::shared_ptr<Session>& session)
     const auto conn = session->wpConn.lock();
     if (conn)
     {
-        std::shared_ptr<Router> router = nullptr;
         {
-            std::lock_guard<std::mutex> locker(m_mutexRouterMap);
-            auto iter = m_routerMap.find(session->req->uri);
-            if (m_routerMap.end() != iter)
-            {
-                router = iter->second;
-            }
+            std::lock_guard<std::mutex> locker(session->mutex);
+            ++session->requestCount;
+            const bool reqKeepAlive = session->req->isKeepAlive();
+            session->keepAlive = session->keepAliveEnabled && reqKeepAlive
+                                 && (0 == session->maxRequests || session->requestCount < session->maxRequests);
+            session->forceClose = reqKeepAlive && !session->keepAlive;
+            session->respHeadPending = true;
+            session->responding = true;
         }
+        const auto router = session->router;
         std::shared_ptr<Response> resp = nullptr;
-        const std::weak_ptr<Server> wpSelf = shared_from_this();
         if (router) /* 找到路由 */
         {
             if (session->req->isMethodAllowed) /* 允许方法 */
             {
-                router->onResponse(
-                    conn->getId(), session->req,
-                    Connector(
-                        [wpSelf, wpConn = session->wpConn](const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb) {
-                            const auto& self = wpSelf.lock();
-                            if (self)
-                            {
-                                self->sendResponse(wpConn, data, cb);
-                            }
-                        },
-                        [wpSelf, wpConn = session->wpConn]() {
-                            const auto& self = wpSelf.lock();
-                            if (self)
-                            {
-                                self->closeConnection(wpConn);
-                            }
-                        }));
+                router->onResponse(conn->getId(), session->req, makeConnector(session));
                 return;
             }
             else if (router->methodNotAllowedCb) /* 方法不允许 */
             {
-                router->methodNotAllowedCb(
-                    conn->getId(), session->req,
-                    Connector(
-                        [wpSelf, wpConn = session->wpConn](const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb) {
-                            const auto& self = wpSelf.lock();
-                            if (self)
-                            {
-                                self->sendResponse(wpConn, data, cb);
-                            }
-                        },
-                        [wpSelf, wpConn = session->wpConn]() {
-                            const auto& self = wpSelf.lock();
-                            if (self)
-                            {
-                                self->closeConnection(wpConn);
-                            }
-                        }));
+                router->methodNotAllowedCb(conn->getId(), session->req, makeConnector(session));
                 return;
             }
             resp = std::make_shared<Response>();
@@ -290,55 +394,180 @@ void Server::handleReqFinish(const std::shared_ptr<Session>& session)
             }
             if (defaultRouterCb)
             {
-                defaultRouterCb(
-                    conn->getId(), session->req,
-                    Connector(
-                        [wpSelf, wpConn = session->wpConn](const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb) {
-                            const auto& self = wpSelf.lock();
-                            if (self)
-                            {
-                                self->sendResponse(wpConn, data, cb);
-                            }
-                        },
-                        [wpSelf, wpConn = session->wpConn]() {
-                            const auto& self = wpSelf.lock();
-                            if (self)
-                            {
-                                self->closeConnection(wpConn);
-                            }
-                        }));
+                defaultRouterCb(conn->getId(), session->req, makeConnector(session));
                 return;
             }
             resp = std::make_shared<Response>();
             resp->statusCode = StatusCode::client_error_not_found;
         }
         /* 发送响应数据 */
-        sendResponse(session->wpConn, resp ? resp->pack() : std::vector<unsigned char>(),
-                     [wpSelf, wpConn = session->wpConn](const boost::system::error_code& code, size_t length) {
-                         const auto& self = wpSelf.lock();
-                         if (self)
-                         {
-                             self->closeConnection(wpConn); /* 关闭连接 */
-                         }
-                     });
+        resp->headers.insert(std::make_pair("Connection", session->keepAlive ? "keep-alive" : "close"));
+        const auto data = resp->pack();
+        sendResponse(session, data.data(), data.size(), nullptr);
+        finishResponse(session);
     }
 }
 
-void Server::sendResponse(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb)
+Connector Server::makeConnector(const std::shared_ptr<Session>& session)
 {
-    const auto conn = wpConn.lock();
+    const std::weak_ptr<Server> wpSelf = shared_from_this();
+    const std::weak_ptr<Session> wpSession = session;
+    return Connector(
+        [wpSelf, wpSession](const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& cb) {
+            const auto& self = wpSelf.lock();
+            const auto& session = wpSession.lock();
+            if (self && session)
+            {
+                self->sendResponse(session, data, length, cb);
+            }
+        },
+        [wpSelf, wpSession](FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& cb) {
+            const auto& self = wpSelf.lock();
+            const auto& session = wpSession.lock();
+            if (self && session)
+            {
+                self->sendFileResponse(session, f, offset, length, cb);
+            }
+        },
+        [wpSelf, wpSession]() {
+            const auto& self = wpSelf.lock();
+            const auto& session = wpSession.lock();
+            if (self && session)
+            {
+                self->finishResponse(session);
+            }
+        });
+}
+
+void Server::finishResponse(const std::shared_ptr<Session>& session)
+{
+    const auto conn = session->wpConn.lock();
     if (conn)
     {
-        conn->send(data, cb);
+        bool resumeFlag = false;
+        {
+            std::lock_guard<std::mutex> locker(session->mutex);
+            if (!session->responding || session->closed) /* 重复调用 */
+            {
+                return;
+            }
+            session->responding = false;
+            if (session->keepAlive)
+            {
+                session->activeTime = std::chrono::steady_clock::now();
+                if (session->pendingData.empty())
+                {
+                    startIdleTimer(session);
+                }
+                else /* 有后续请求数据, 回到连接所在线程继续解析 */
+                {
+                    resumeFlag = true;
+                }
+            }
+            else
+            {
+                session->closed = true;
+            }
+        }
+        if (resumeFlag)
+        {
+            const std::weak_ptr<Server> wpSelf = shared_from_this();
+            const std::weak_ptr<Session> wpSession = session;
+            boost::asio::post(conn->getIoContext(), [wpSelf, wpSession]() {
+                const auto& self = wpSelf.lock();
+                const auto& session = wpSession.lock();
+                if (self && session)
+                {
+                    self->resumeData(session);
+                }
+            });
+        }
+        else if (session->closed)
+        {
+            conn->close(); /* 非保活时响应结束后关闭连接(有些客户端不会主动关闭连接) */
+        }
     }
 }
 
-void Server::closeConnection(const std::weak_ptr<TcpConnection>& wpConn)
+void Server::startIdleTimer(const std::shared_ptr<Session>& session)
 {
-    const auto conn = wpConn.lock();
+    if (!session->idleTimer || session->idleWaiting || session->closed)
+    {
+        return;
+    }
+    session->idleWaiting = true;
+    session->idleTimer->expires_at(session->activeTime + session->idleTimeout);
+    const std::weak_ptr<Server> wpSelf = shared_from_this();
+    const std::weak_ptr<Session> wpSession = session;
+    session->idleTimer->async_wait([wpSelf, wpSession](const boost::system::error_code& code) {
+        const auto& self = wpSelf.lock();
+        const auto& session = wpSession.lock();
+        if (self && session)
+        {
+            {
+                std::lock_guard<std::mutex> locker(session->mutex);
+                session->idleWaiting = false;
+            }
+            if (boost::asio::error::operation_aborted != code)
+            {
+                self->handleIdleTimer(session);
+            }
+        }
+    });
+}
+
+void Server::handleIdleTimer(const std::shared_ptr<Session>& session)
+{
+    const auto conn = session->wpConn.lock();
+    if (conn)
+    {
+        {
+            std::lock_guard<std::mutex> locker(session->mutex);
+            if (session->responding || session->closed) /* 正在响应时不计空闲, 响应结束后重新计时 */
+            {
+                return;
+            }
+            if (std::chrono::steady_clock::now() - session->activeTime < session->idleTimeout) /* 期间有数据到达, 继续计时 */
+            {
+                startIdleTimer(session);
+                return;
+            }
+            session->closed = true;
+        }
+        conn->close();
+    }
+}
+
+void Server::sendResponse(const std::shared_ptr<Session>& session, const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& cb)
+{
+    const auto conn = session->wpConn.lock();
+    if (conn)
+    {
+        bool forceClose = false;
+        {
+            std::lock_guard<std::mutex> locker(session->mutex);
+            forceClose = session->respHeadPending && session->forceClose;
+            session->respHeadPending = false;
+        }
+        if (forceClose) /* 客户端要求保活但服务器将关闭连接, 需告知客户端, 避免客户端在该连接上继续发送请求 */
+        {
+            auto result = insertConnectionClose(data, length);
+            if (!result.empty())
+            {
+                conn->send(result, cb);
+                return;
+            }
+        }
+        conn->send(data, length, cb);
+    }
+}
+
+void Server::sendFileResponse(const std::shared_ptr<Session>& session, FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& cb)
+{
+    const auto conn = session->wpConn.lock();
     if (conn)
     {
-        conn->close(); /* 响应结束后, 需要关闭连接(有些客户端不会主动关闭连接) */
+        conn->sendFile(f, offset, length, cb);
     }
 }
 } // namespace http
@@ -1,11 +1,16 @@
 #pragma once
+#include <atomic>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../tcp/tcp_server.h"
 #include "request.h"
 #include "response.h"
+#include "route_tree.h"
 #include "router.h"
 
 namespace nsocket
@@ -14,6 +19,8 @@ namespace http
 {
 /**
  * @brief HTTP服务器(注意: 需要实例化为共享指针否则会报错)
+ *        支持HTTP/1.1连接保活和流水线请求: 处理器调用`Connector::close`表示响应结束, 服务器根据请求的`Connection`头部和版本
+ *        决定是否断开连接, 保活时继续按顺序处理同一连接上的后续请求(上个响应结束前, 后续请求数据暂存不解析)
  */
 class Server final : public std::enable_shared_from_this<Server>
 {
@@ -42,12 +49,22 @@ public:
      */
     void setDefaultRouterCallback(const std::function<void(uint64_t cid, const REQUEST_PTR& req, const Connector& conn)>& cb);
 
+    /**
+     * @brief 设置连接保活参数(需在运行前设置, 只对之后的新连接生效)
+     * @param enable 是否开启保活, 关闭时每个响应结束后都断开连接, 默认开启
+     * @param idleTimeout 空闲超时时间, 连接在该时间内无请求则断开, 为0表示不超时, 默认60秒
+     * @param maxRequests 单个连接最多处理的请求数, 达到后响应结束即断开连接, 为0表示不限制, 默认1000
+     */
+    void setKeepAlive(bool enable, const std::chrono::steady_clock::duration& idleTimeout = std::chrono::seconds(60),
+                      size_t maxRequests = 1000);
+
     /**
      * @brief 添加路由
      * @param methods 方法列表, 为空时表示支持所有方法(注意: 正常有且支持1种), 例如: {Method::GET}, {Method::POST}
-     * @param uriList 服务URI列表, 例如: {"/", "/index","/index.htm", "/index.html"}
+     * @param uriList 服务URI列表, 例如: {"/", "/index","/index.htm", "/index.html"}, 支持路径参数和通配符(参见`RouteTree`),
+     *                例如: {"/api/dev/{id}/state", "/static/{path*}"}, 匹配到的参数值保存在请求的`params`中
      * @param router 路由
-     * @return 返回已添加过的URI列表
+     * @return 返回已添加过(或格式非法)的URI列表
      */
     std::vector<std::string> addRouter(const std::vector<Method>& methods, const std::vector<std::string>& uriList,
                                        const std::shared_ptr<Router>& router);
@@ -85,6 +102,21 @@ private:
     {
         std::weak_ptr<TcpConnection> wpConn; /* TCP连接 */
         std::shared_ptr<Request> req; /* 请求 */
+        std::shared_ptr<Router> router = nullptr; /* 当前请求匹配到的路由 */
+        bool keepAliveEnabled = true; /* 是否开启保活 */
+        std::chrono::steady_clock::duration idleTimeout; /* 空闲超时时间 */
+        size_t maxRequests = 0; /* 最多处理的请求数 */
+        std::mutex mutex; /* for 以下字段 */
+        bool keepAlive = true; /* 当前请求是否保活 */
+        bool forceClose = false; /* 客户端要求保活但服务器将关闭连接(需在响应头部添加`Connection: close`) */
+        bool respHeadPending = false; /* 当前响应是否还未发送头部 */
+        size_t requestCount = 0; /* 已收到的请求数 */
+        bool responding = false; /* 是否正在响应 */
+        bool closed = false; /* 是否已关闭 */
+        std::vector<unsigned char> pendingData; /* 响应期间收到的后续请求数据 */
+        std::shared_ptr<boost::asio::steady_timer> idleTimer = nullptr; /* 空闲定时器 */
+        bool idleWaiting = false; /* 空闲定时器是否在等待中 */
+        std::chrono::steady_clock::time_point activeTime; /* 最后活跃时间 */
     };
 
 private:
@@ -96,7 +128,19 @@ private:
     /**
      * @brief 处理连接数据
      */
-    void handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data);
+    void handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length);
+
+    /**
+     * @brief 解析连接数据(当有请求正在响应时, 剩余数据暂存到会话中)
+     * @return true-数据已全部解析, false-解析中止(正在响应/已关闭/解析出错)
+     */
+    bool parseData(const std::shared_ptr<TcpConnection>& conn, const std::shared_ptr<Session>& session, const unsigned char* data,
+                   size_t length);
+
+    /**
+     * @brief 继续解析响应期间暂存的数据
+     */
+    void resumeData(const std::shared_ptr<Session>& session);
 
     /**
      * @brief 处理连接断开
@@ -118,15 +162,36 @@ private:
      */
     void handleReqFinish(const std::shared_ptr<Session>& session);
 
+    /**
+     * @brief 创建连接器
+     */
+    Connector makeConnector(const std::shared_ptr<Session>& session);
+
+    /**
+     * @brief 结束响应(非保活时关闭连接, 保活时继续处理后续请求)
+     */
+    void finishResponse(const std::shared_ptr<Session>& session);
+
+    /**
+     * @brief 开始空闲计时(调用前需对会话加锁)
+     */
+    void startIdleTimer(const std::shared_ptr<Session>& session);
+
+    /**
+     * @brief 处理空闲定时器到期
+     */
+    void handleIdleTimer(const std::shared_ptr<Session>& session);
+
     /**
      * @brief 发送响应
      */
-    void sendResponse(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& cb);
+    void sendResponse(const std::shared_ptr<Session>& session, const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& cb);
 
     /**
-     * @brief 关闭连接
+     * @brief 发送响应(文件内容)
      */
-    void closeConnection(const std::weak_ptr<TcpConnection>& wpConn);
+    void sendFileResponse(const std::shared_ptr<Session>& session, FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& cb);
+
 
 private:
     std::shared_ptr<TcpServer> m_tcpServer = nullptr; /* TCP服务器 */
@@ -134,8 +199,12 @@ private:
     std::unordered_map<uint64_t, std::shared_ptr<Session>> m_sessionMap; /* 会话表 */
     std::mutex m_mutexDefaultRouterCb;
     std::function<void(uint64_t cid, const REQUEST_PTR& req, const Connector& conn)> m_defaultRouterCb = nullptr; /* 默认路由回调 */
-    std::mutex m_mutexRouterMap;
-    std::unordered_map<std::string, std::shared_ptr<Router>> m_routerMap; /* 路由表 */
+    std::mutex m_mutexRouteTree; /* for 添加路由 */
+    std::shared_ptr<const RouteTree> m_routeTree = nullptr; /* 当前路由树(原子读写, 旧版本在最后一个读取方释放后销毁) */
+    std::mutex m_mutexKeepAlive;
+    bool m_keepAliveEnabled = true; /* 是否开启保活 */
+    std::chrono::steady_clock::duration m_idleTimeout = std::chrono::seconds(60); /* 空闲超时时间 */
+    size_t m_maxRequests = 1000; /* 单个连接最多处理的请求数 */
 };
 } // namespace http
 } // namespace nsocket
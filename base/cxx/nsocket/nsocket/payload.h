@@ -1,11 +1,12 @@
 #pragma once
+#include <cstdint>
 #include <functional>
 #include <vector>
 
 namespace nsocket
 {
 /**
- * @brief 负载
+ * @brief 负载, 说明: 每帧都会拷贝包头/包体并从缓冲区头部删除数据, 1次接收包含大量小帧时开销较大, 新代码建议使用FrameDecoder
  */
 class Payload final
 {
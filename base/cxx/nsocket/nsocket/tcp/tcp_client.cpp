@@ -19,6 +19,11 @@ void TcpClient::setDataCallback(const TCP_DATA_CALLBACK& onDataCb)
     m_onDataCallback = onDataCb;
 }
 
+void TcpClient::setDataViewCallback(const TCP_DATA_VIEW_CALLBACK& onDataViewCb)
+{
+    m_onDataViewCallback = onDataViewCb;
+}
+
 void TcpClient::setNonBlock(bool nonBlock)
 {
     m_nonBlock = (nonBlock ? 1 : 0);
@@ -99,6 +104,7 @@ void TcpClient::run(const std::string& host, uint16_t port, bool sslOn, int sslW
                 }
             });
             tcpConn->setDataCallback(m_onDataCallback);
+            tcpConn->setDataViewCallback(m_onDataViewCallback);
             if (m_nonBlock >= 0)
             {
                 tcpConn->setNonBlock(m_nonBlock > 0 ? true : false);
@@ -34,6 +34,12 @@ public:
      */
     void setDataCallback(const TCP_DATA_CALLBACK& onDataCb);
 
+    /**
+     * @brief 设置数据回调(零拷贝, 接收时不分配内存)
+     * @param onDataViewCb 数据回调
+     */
+    void setDataViewCallback(const TCP_DATA_VIEW_CALLBACK& onDataViewCb);
+
     /**
      * @brief 设置非阻塞模式(运行前调用才有效)
      * @param nonBlock 非阻塞模式, true-是, false-否(阻塞模式)
@@ -158,6 +164,7 @@ private:
     std::shared_ptr<TcpConnection> m_tcpConn = nullptr; /* TCP连接 */
     TCP_CONNECT_CALLBACK m_onConnectCallback = nullptr; /* 连接回调 */
     TCP_DATA_CALLBACK m_onDataCallback = nullptr; /* 数据回调 */
+    TCP_DATA_VIEW_CALLBACK m_onDataViewCallback = nullptr; /* 数据回调(零拷贝) */
     std::atomic<int> m_nonBlock = {-1}; /* 是否非阻塞: <0-默认, 0-阻塞, 1-非阻塞 */
     std::atomic<int> m_sendBufferSize = {-1}; /* 发送缓冲区大小(字节), <=0-默认, >0-指定大小 */
     std::atomic<int> m_recvBufferSize = {-1}; /* 接收缓冲区大小(字节), <=0-默认, >0-指定大小 */
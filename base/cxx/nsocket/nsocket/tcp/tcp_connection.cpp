@@ -1,11 +1,15 @@
 #include "tcp_connection.h"
 
+#include <algorithm>
+#include <boost/asio/post.hpp>
 #include <chrono>
 
 namespace nsocket
 {
 static std::atomic<uint64_t> s_timestamp{0}; /* 注意: std::atomic_uint64_t在某些平台下未定义 */
 static std::atomic_int s_count{0};
+static const size_t MAX_SEND_BUFFERS = 64; /* 每次写操作合并的最大缓冲区个数(asio在Linux下每次writev最多64个) */
+static const size_t SEND_FILE_BUFFER_SIZE = (64 * 1024); /* 发送文件的缓冲区大小(字节) */
 
 TcpConnection::TcpConnection(const std::shared_ptr<SocketTcpBase>& socket, bool alreadyConnected, size_t bz) : m_socketTcpBase(socket)
 {
@@ -49,7 +53,7 @@ boost::asio::io_context& TcpConnection::getIoContext()
     }
     if (socketTcpBase)
     {
-        socketTcpBase->getIoContext();
+        return socketTcpBase->getIoContext();
     }
     return ioContext;
 }
@@ -64,6 +68,17 @@ void TcpConnection::setDataCallback(const TCP_DATA_CALLBACK& onDataCb)
     m_onDataCallback = onDataCb;
 }
 
+void TcpConnection::setDataViewCallback(const TCP_DATA_VIEW_CALLBACK& onDataViewCb)
+{
+    m_onDataViewCallback = onDataViewCb;
+}
+
+void TcpConnection::setDataBufferCallback(const TCP_DATA_BUFFER_CALLBACK& onDataBufferCb, size_t poolSize)
+{
+    m_bufferPoolSize = (poolSize > 0 ? poolSize : 1);
+    m_onDataBufferCallback = onDataBufferCb;
+}
+
 void TcpConnection::setNonBlock(bool nonBlock)
 {
     std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
@@ -103,6 +118,19 @@ void TcpConnection::setRecvBufferSize(int bufferSize)
     }
 }
 
+void TcpConnection::setSendTimeout(const std::chrono::steady_clock::duration& timeout)
+{
+    std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        socketTcpBase = m_socketTcpBase;
+    }
+    if (socketTcpBase)
+    {
+        socketTcpBase->setSendTimeout((int)std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count());
+    }
+}
+
 void TcpConnection::setNagleEnable(bool enable)
 {
     std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
@@ -234,7 +262,12 @@ void TcpConnection::handshake(boost::asio::ssl::stream_base::handshake_type type
 
 void TcpConnection::send(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& onSendCb)
 {
-    if (data.empty())
+    send(data.data(), data.size(), onSendCb);
+}
+
+void TcpConnection::send(const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& onSendCb)
+{
+    if (!data || 0 == length)
     {
         if (onSendCb)
         {
@@ -246,16 +279,21 @@ void TcpConnection::send(const std::vector<unsigned char>& data, const TCP_SEND_
         boost::system::error_code code;
         size_t sentLength = 0;
         {
-            std::lock_guard<std::mutex> locker(m_mutex);
-            while (sentLength < data.size()) /* 循环发送所有数据 */
+            std::lock_guard<std::mutex> locker(m_mutexSyncSend);
+            std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
             {
-                if (m_socketTcpBase && m_isConnected)
+                std::lock_guard<std::mutex> socketLocker(m_mutex);
+                socketTcpBase = m_socketTcpBase;
+            }
+            while (sentLength < length) /* 循环发送所有数据 */
+            {
+                if (socketTcpBase && m_isConnected)
                 {
-                    m_socketTcpBase->send(boost::asio::buffer(data.data() + sentLength, data.size() - sentLength),
-                                          [&code, &sentLength](const boost::system::error_code& ec, size_t length) {
-                                              code = ec;
-                                              sentLength += length;
-                                          });
+                    socketTcpBase->send(boost::asio::buffer(data + sentLength, length - sentLength),
+                                        [&code, &sentLength](const boost::system::error_code& ec, size_t length) {
+                                            code = ec;
+                                            sentLength += length;
+                                        });
                     if (code) /* 发送失败 */
                     {
                         break;
@@ -276,45 +314,336 @@ void TcpConnection::send(const std::vector<unsigned char>& data, const TCP_SEND_
     }
 }
 
-void TcpConnection::TcpConnection::recv()
+void TcpConnection::sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& onSendCb)
+{
+    if (!f || 0 == length)
+    {
+        if (onSendCb)
+        {
+            onSendCb(boost::system::errc::make_error_code(boost::system::errc::no_message_available), 0);
+        }
+        return;
+    }
+    boost::system::error_code code;
+    size_t sentLength = 0;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSyncSend);
+        std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
+        {
+            std::lock_guard<std::mutex> socketLocker(m_mutex);
+            socketTcpBase = m_socketTcpBase;
+        }
+        if (!socketTcpBase || !m_isConnected)
+        {
+            code = boost::system::errc::make_error_code(boost::system::errc::not_connected);
+        }
+        else if (!socketTcpBase->sendFile(f, offset, length, [&](const boost::system::error_code& ec, size_t len) {
+                     code = ec;
+                     sentLength = len;
+                 }))
+        {
+            /* 不支持零拷贝发送, 分块读取到复用的缓冲区后发送 */
+            if (m_sendFileBuf.empty())
+            {
+                m_sendFileBuf.resize(SEND_FILE_BUFFER_SIZE);
+            }
+#ifdef _WIN32
+            if (0 != _fseeki64(f, offset, SEEK_SET))
+#else
+            if (0 != fseeko64(f, offset, SEEK_SET))
+#endif
+            {
+                code = boost::system::errc::make_error_code(boost::system::errc::io_error);
+            }
+            while (!code && sentLength < length)
+            {
+                auto count = fread(m_sendFileBuf.data(), 1, std::min(length - sentLength, m_sendFileBuf.size()), f);
+                if (0 == count) /* 文件长度不足(例如已被截断)或读失败 */
+                {
+                    code = boost::asio::error::eof;
+                    break;
+                }
+                size_t blockSent = 0;
+                while (blockSent < count && m_isConnected)
+                {
+                    socketTcpBase->send(boost::asio::buffer(m_sendFileBuf.data() + blockSent, count - blockSent),
+                                        [&code, &blockSent](const boost::system::error_code& ec, size_t len) {
+                                            code = ec;
+                                            blockSent += len;
+                                        });
+                    if (code)
+                    {
+                        break;
+                    }
+                }
+                sentLength += blockSent;
+                if (!code && blockSent < count)
+                {
+                    code = boost::system::errc::make_error_code(boost::system::errc::not_connected);
+                }
+            }
+        }
+    }
+    if (onSendCb)
+    {
+        onSendCb(code, sentLength);
+    }
+}
+
+bool TcpConnection::sendAsync(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& onSendCb)
+{
+    return sendAsync(std::vector<unsigned char>(data), onSendCb);
+}
+
+bool TcpConnection::sendAsync(std::vector<unsigned char>&& data, const TCP_SEND_CALLBACK& onSendCb)
 {
+    if (data.empty())
+    {
+        if (onSendCb)
+        {
+            onSendCb(boost::system::errc::make_error_code(boost::system::errc::no_message_available), 0);
+        }
+        return false;
+    }
     std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
     {
         std::lock_guard<std::mutex> locker(m_mutex);
         socketTcpBase = m_socketTcpBase;
     }
-    if (socketTcpBase)
+    if (!socketTcpBase || !m_isConnected)
+    {
+        if (onSendCb)
+        {
+            onSendCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+        }
+        return false;
+    }
+    bool overflow = false;
+    bool highWatermark = false;
+    bool startSend = false;
+    size_t queueBytes = 0;
+    SendOverflowPolicy policy;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSend);
+        policy = m_sendOverflowPolicy;
+        if (m_sendQueueBytes > 0 && m_sendQueueBytes + data.size() > m_sendQueueMaxBytes) /* 队列溢出 */
+        {
+            overflow = true;
+        }
+        else
+        {
+            m_sendQueueBytes += data.size();
+            m_sendQueue.emplace_back(SendItem{std::move(data), onSendCb});
+            if (!m_sendHighWatermarked && m_sendQueueBytes >= m_sendHighWatermark)
+            {
+                m_sendHighWatermarked = true;
+                highWatermark = true;
+            }
+            if (!m_sending) /* 没有写操作在进行中, 需要发起 */
+            {
+                m_sending = true;
+                startSend = true;
+            }
+        }
+        queueBytes = m_sendQueueBytes;
+    }
+    if (overflow)
+    {
+        if (SendOverflowPolicy::close == policy)
+        {
+            close();
+        }
+        if (onSendCb)
+        {
+            onSendCb(boost::system::errc::make_error_code(boost::system::errc::no_buffer_space), 0);
+        }
+        return false;
+    }
+    if (highWatermark && m_onSendWatermarkCallback)
+    {
+        m_onSendWatermarkCallback(true, queueBytes);
+    }
+    if (startSend) /* 写操作需要在I/O线程中发起 */
     {
         const std::weak_ptr<TcpConnection> wpSelf = shared_from_this();
-        socketTcpBase->recv(boost::asio::buffer(m_recvBuf), [wpSelf](const boost::system::error_code& code, size_t length) {
+        boost::asio::post(socketTcpBase->getIoContext(), [wpSelf]() {
             const auto self = wpSelf.lock();
             if (self)
             {
-                if (code) /* 接收失败 */
-                {
-                    bool connectedFlag = self->m_isConnected;
-                    self->closeImpl();
-                    if (connectedFlag && self->m_onConnectCallback)
-                    {
-                        self->m_onConnectCallback(code);
-                    }
-                }
-                else /* 接收成功 */
+                self->doSend();
+            }
+        });
+    }
+    return true;
+}
+
+void TcpConnection::setSendQueue(size_t maxBytes, size_t highWatermark, size_t lowWatermark, SendOverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> locker(m_mutexSend);
+    m_sendQueueMaxBytes = maxBytes;
+    m_sendHighWatermark = std::min(highWatermark, maxBytes);
+    m_sendLowWatermark = std::min(lowWatermark, m_sendHighWatermark);
+    m_sendOverflowPolicy = policy;
+}
+
+void TcpConnection::setSendWatermarkCallback(const TCP_SEND_WATERMARK_CALLBACK& onWatermarkCb)
+{
+    m_onSendWatermarkCallback = onWatermarkCb;
+}
+
+size_t TcpConnection::getSendQueueBytes()
+{
+    std::lock_guard<std::mutex> locker(m_mutexSend);
+    return m_sendQueueBytes;
+}
+
+void TcpConnection::doSend()
+{
+    std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        socketTcpBase = m_socketTcpBase;
+    }
+    if (!socketTcpBase)
+    {
+        clearSendQueue(boost::system::errc::make_error_code(boost::system::errc::not_connected));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSend);
+        while (!m_sendQueue.empty() && m_sendingList.size() < MAX_SEND_BUFFERS) /* 合并队列中的数据 */
+        {
+            m_sendingList.emplace_back(std::move(m_sendQueue.front()));
+            m_sendQueue.pop_front();
+        }
+        if (m_sendingList.empty())
+        {
+            m_sending = false;
+            return;
+        }
+    }
+    m_sendingBuffers.clear();
+    for (const auto& item : m_sendingList)
+    {
+        m_sendingBuffers.emplace_back(boost::asio::buffer(item.data));
+    }
+    const std::weak_ptr<TcpConnection> wpSelf = shared_from_this();
+    socketTcpBase->sendAsync(m_sendingBuffers, [wpSelf](const boost::system::error_code& code, size_t length) {
+        const auto self = wpSelf.lock();
+        if (self)
+        {
+            self->handleSendResult(code);
+        }
+    });
+}
+
+void TcpConnection::handleSendResult(const boost::system::error_code& code)
+{
+    size_t sentBytes = 0;
+    for (const auto& item : m_sendingList)
+    {
+        sentBytes += item.data.size();
+    }
+    bool lowWatermark = false;
+    size_t queueBytes = 0;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSend);
+        m_sendQueueBytes -= sentBytes;
+        if (m_sendHighWatermarked && m_sendQueueBytes <= m_sendLowWatermark)
+        {
+            m_sendHighWatermarked = false;
+            lowWatermark = true;
+        }
+        queueBytes = m_sendQueueBytes;
+        if (code)
+        {
+            m_sending = false;
+        }
+    }
+    for (const auto& item : m_sendingList)
+    {
+        if (item.callback)
+        {
+            item.callback(code, code ? 0 : item.data.size());
+        }
+    }
+    m_sendingList.clear();
+    if (code) /* 发送失败 */
+    {
+        bool connectedFlag = m_isConnected;
+        closeImpl();
+        clearSendQueue(code);
+        if (connectedFlag && m_onConnectCallback)
+        {
+            m_onConnectCallback(code);
+        }
+        return;
+    }
+    if (lowWatermark && m_onSendWatermarkCallback)
+    {
+        m_onSendWatermarkCallback(false, queueBytes);
+    }
+    doSend(); /* 继续发送队列中的数据 */
+}
+
+void TcpConnection::clearSendQueue(const boost::system::error_code& code)
+{
+    std::deque<SendItem> sendQueue;
+    {
+        std::lock_guard<std::mutex> locker(m_mutexSend);
+        sendQueue.swap(m_sendQueue);
+        for (const auto& item : sendQueue)
+        {
+            m_sendQueueBytes -= item.data.size();
+        }
+        if (m_sendingList.empty())
+        {
+            m_sending = false;
+        }
+    }
+    for (const auto& item : sendQueue)
+    {
+        if (item.callback)
+        {
+            item.callback(code, 0);
+        }
+    }
+}
+
+void TcpConnection::TcpConnection::recv()
+{
+    std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        socketTcpBase = m_socketTcpBase;
+    }
+    if (socketTcpBase)
+    {
+        if (!m_onRecvCallback) /* 接收回调只创建一次, 后续循环接收时复用 */
+        {
+            const std::weak_ptr<TcpConnection> wpSelf = shared_from_this();
+            m_onRecvCallback = std::make_shared<TCP_RECV_CALLBACK>([wpSelf](const boost::system::error_code& code, size_t length) {
+                const auto self = wpSelf.lock();
+                if (self)
                 {
-                    if (self->m_onDataCallback)
+                    if (code) /* 接收失败 */
                     {
-                        std::vector<unsigned char> data;
-                        const unsigned char* rawData = (const unsigned char*)self->m_recvBuf.data();
-                        if (rawData && length > 0)
+                        bool connectedFlag = self->m_isConnected;
+                        self->closeImpl();
+                        if (connectedFlag && self->m_onConnectCallback)
                         {
-                            data.insert(data.end(), rawData, rawData + length);
+                            self->m_onConnectCallback(code);
                         }
-                        self->m_onDataCallback(data);
                     }
-                    self->recv(); /* 继续接收 */
+                    else /* 接收成功 */
+                    {
+                        self->handleRecvData(length);
+                        self->recv(); /* 继续接收 */
+                    }
                 }
-            }
-        });
+            });
+        }
+        socketTcpBase->recv(boost::asio::buffer(m_recvBuf), m_onRecvCallback);
     }
     else
     {
@@ -326,6 +655,56 @@ void TcpConnection::TcpConnection::recv()
     }
 }
 
+void TcpConnection::handleRecvData(size_t length)
+{
+    const unsigned char* rawData = (const unsigned char*)m_recvBuf.data();
+    if (m_onDataViewCallback)
+    {
+        m_onDataViewCallback(rawData, length);
+    }
+    if (m_onDataBufferCallback)
+    {
+        m_onDataBufferCallback(acquireBuffer(rawData, length));
+    }
+    if (m_onDataCallback)
+    {
+        std::vector<unsigned char> data;
+        if (rawData && length > 0)
+        {
+            data.insert(data.end(), rawData, rawData + length);
+        }
+        m_onDataCallback(data);
+    }
+}
+
+std::shared_ptr<std::vector<unsigned char>> TcpConnection::acquireBuffer(const unsigned char* data, size_t length)
+{
+    std::shared_ptr<std::vector<unsigned char>> buffer = nullptr;
+    const auto poolCount = m_bufferPool.size();
+    for (size_t i = 0; i < poolCount; ++i) /* 只被缓冲区池引用的缓冲区即为空闲 */
+    {
+        const auto index = (m_bufferPoolIndex + i) % poolCount;
+        if (1 == m_bufferPool[index].use_count())
+        {
+            std::atomic_thread_fence(std::memory_order_acquire); /* 确保其他持有者释放前对缓冲区的访问已完成 */
+            buffer = m_bufferPool[index];
+            m_bufferPoolIndex = (index + 1) % poolCount;
+            break;
+        }
+    }
+    if (!buffer)
+    {
+        buffer = std::make_shared<std::vector<unsigned char>>();
+        buffer->reserve(m_recvBuf.size());
+        if (poolCount < m_bufferPoolSize) /* 缓冲区池未满, 加入池中复用, 否则用完即释放 */
+        {
+            m_bufferPool.emplace_back(buffer);
+        }
+    }
+    buffer->assign(data, data + length); /* 容量足够时不会重新分配 */
+    return buffer;
+}
+
 void TcpConnection::closeImpl()
 {
     m_isConnected = false;
@@ -337,6 +716,8 @@ void TcpConnection::closeImpl()
     }
     if (socketTcpBase)
     {
+        socketTcpBase->shutdown(); /* 先关闭读写, 使其他线程中阻塞的同步发送立即返回 */
+        std::lock_guard<std::mutex> locker(m_mutexSyncSend); /* 等待同步发送返回后再关闭(避免套接字描述符被复用后仍在发送) */
         socketTcpBase->close();
     }
 }
@@ -351,6 +732,19 @@ void TcpConnection::close()
     }
 }
 
+void TcpConnection::shutdown()
+{
+    std::shared_ptr<SocketTcpBase> socketTcpBase = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        socketTcpBase = m_socketTcpBase;
+    }
+    if (socketTcpBase)
+    {
+        socketTcpBase->shutdown();
+    }
+}
+
 bool TcpConnection::isEnableSSL() const
 {
     return m_isEnableSSL;
@@ -1,6 +1,8 @@
 #pragma once
 #include <atomic>
 #include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -15,6 +17,35 @@ namespace nsocket
  */
 using TCP_DATA_CALLBACK = std::function<void(const std::vector<unsigned char>& data)>;
 
+/**
+ * @brief TCP数据回调(零拷贝), 注意: 数据指向连接内部的接收缓冲区, 仅在回调期间有效, 需要保留时请拷贝或使用缓冲区池模式
+ * @param data 数据
+ * @param length 数据长度
+ */
+using TCP_DATA_VIEW_CALLBACK = std::function<void(const unsigned char* data, size_t length)>;
+
+/**
+ * @brief TCP数据回调(缓冲区池模式), 缓冲区取自连接内部的缓冲区池, 使用者可以持有, 所有持有者释放后自动回收复用
+ * @param buffer 缓冲区(大小即为数据长度)
+ */
+using TCP_DATA_BUFFER_CALLBACK = std::function<void(const std::shared_ptr<std::vector<unsigned char>>& buffer)>;
+
+/**
+ * @brief TCP发送队列水位回调
+ * @param high true-达到高水位(应暂停发送), false-回落到低水位(可恢复发送)
+ * @param queueBytes 发送队列中的字节数(包括正在发送的数据)
+ */
+using TCP_SEND_WATERMARK_CALLBACK = std::function<void(bool high, size_t queueBytes)>;
+
+/**
+ * @brief 发送队列溢出策略
+ */
+enum class SendOverflowPolicy
+{
+    drop, /* 丢弃新数据 */
+    close, /* 关闭连接 */
+};
+
 /**
  * @brief TCP连接, 注意: 调用close后实例不可再使用, 需要重新创建
  */
@@ -55,6 +86,19 @@ public:
      */
     void setDataCallback(const TCP_DATA_CALLBACK& onDataCb);
 
+    /**
+     * @brief 设置数据回调(零拷贝, 接收时不分配内存)
+     * @param onDataViewCb 数据回调
+     */
+    void setDataViewCallback(const TCP_DATA_VIEW_CALLBACK& onDataViewCb);
+
+    /**
+     * @brief 设置数据回调(缓冲区池模式, 适用于需要保留数据的场景)
+     * @param onDataBufferCb 数据回调
+     * @param poolSize 缓冲区池大小(池中缓冲区都被持有时临时分配新的缓冲区)
+     */
+    void setDataBufferCallback(const TCP_DATA_BUFFER_CALLBACK& onDataBufferCb, size_t poolSize = 8);
+
     /**
      * @brief 设置非阻塞模式(连接前调用才有效)
      * @param nonBlock 非阻塞模式, true-是, false-否(阻塞模式)
@@ -74,7 +118,13 @@ public:
     void setRecvBufferSize(int bufferSize);
 
     /**
-     * @brief 设置是否启用Nagle算法(连接前调用才有效)
+     * @brief 设置同步发送超时(仅Linux下的普通TCP连接有效), 对端持续不接收数据超过该时间则发送失败(错误码为timed_out)
+     * @param timeout 超时时间, <=0表示不超时
+     */
+    void setSendTimeout(const std::chrono::steady_clock::duration& timeout);
+
+    /**
+     * @brief 设置是否启用Nagle算法(连接前调用, 对已建立的连接则立即生效)
      * @param enable true-启用, false-关闭
      */
     void setNagleEnable(bool enable);
@@ -109,11 +159,70 @@ public:
      */
     void send(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& onSendCb);
 
+    /**
+     * @brief 发送数据(同步, 直接发送调用者的缓冲区, 不拷贝数据)
+     * @param data 数据
+     * @param length 数据长度
+     * @param onSendCb 发送回调
+     */
+    void send(const unsigned char* data, size_t length, const TCP_SEND_CALLBACK& onSendCb);
+
+    /**
+     * @brief 发送文件内容(同步), 普通TCP连接在Linux下使用sendfile零拷贝发送, 其他情况(例如TLS)读取到连接内复用的缓冲区后发送
+     * @param f 文件指针(由调用者打开和关闭, 可多次调用以分段发送)
+     * @param offset 文件偏移
+     * @param length 发送长度
+     * @param onSendCb 发送回调
+     */
+    void sendFile(FILE* f, size_t offset, size_t length, const TCP_SEND_CALLBACK& onSendCb);
+
+    /**
+     * @brief 发送数据(异步), 数据先加入发送队列, 由连接所在的I/O线程把队列中的多个数据合并为一次写操作发送
+     * @param data 数据
+     * @param onSendCb 发送回调(在I/O线程中回调, 入队失败时在调用线程中回调)
+     * @return true-已加入发送队列, false-入队失败(未连接, 数据为空或队列溢出)
+     */
+    bool sendAsync(const std::vector<unsigned char>& data, const TCP_SEND_CALLBACK& onSendCb);
+
+    /**
+     * @brief 发送数据(异步, 数据移入发送队列, 避免拷贝)
+     * @param data 数据
+     * @param onSendCb 发送回调(在I/O线程中回调, 入队失败时在调用线程中回调)
+     * @return true-已加入发送队列, false-入队失败(未连接, 数据为空或队列溢出)
+     */
+    bool sendAsync(std::vector<unsigned char>&& data, const TCP_SEND_CALLBACK& onSendCb);
+
+    /**
+     * @brief 设置异步发送队列参数
+     * @param maxBytes 队列最大字节数(包括正在发送的数据), 超出时按溢出策略处理, 注意: 队列为空时总是允许入队
+     * @param highWatermark 高水位(字节), 队列字节数达到高水位时触发水位回调
+     * @param lowWatermark 低水位(字节), 达到高水位后回落到低水位时触发水位回调
+     * @param policy 溢出策略
+     */
+    void setSendQueue(size_t maxBytes, size_t highWatermark, size_t lowWatermark, SendOverflowPolicy policy = SendOverflowPolicy::drop);
+
+    /**
+     * @brief 设置发送队列水位回调
+     * @param onWatermarkCb 水位回调
+     */
+    void setSendWatermarkCallback(const TCP_SEND_WATERMARK_CALLBACK& onWatermarkCb);
+
+    /**
+     * @brief 获取发送队列中的字节数(包括正在发送的数据)
+     * @return 字节数
+     */
+    size_t getSendQueueBytes();
+
     /**
      * @brief 关闭
      */
     void close();
 
+    /**
+     * @brief 关闭读写(可在其他线程中调用, 不会阻塞), 阻塞中的同步发送立即返回错误, 接收结束后连接自动关闭
+     */
+    void shutdown();
+
     /**
      * @brief 是否启用SSL
      * @return true-是, false-否
@@ -209,19 +318,80 @@ private:
      */
     void recv();
 
+    /**
+     * @brief 处理接收到的数据(分发给各数据回调)
+     * @param length 数据长度
+     */
+    void handleRecvData(size_t length);
+
+    /**
+     * @brief 从缓冲区池获取空闲缓冲区并填充数据
+     * @param data 数据
+     * @param length 数据长度
+     * @return 缓冲区
+     */
+    std::shared_ptr<std::vector<unsigned char>> acquireBuffer(const unsigned char* data, size_t length);
+
     /**
      * @brief 关闭(内部实现)
      */
     void closeImpl();
 
+    /**
+     * @brief 从发送队列取出数据并发起异步写操作(只在I/O线程中调用)
+     */
+    void doSend();
+
+    /**
+     * @brief 处理异步写操作结果(只在I/O线程中调用)
+     * @param code 错误码
+     */
+    void handleSendResult(const boost::system::error_code& code);
+
+    /**
+     * @brief 清空发送队列(不包括正在发送的数据), 并以指定错误码通知各个发送回调
+     * @param code 错误码
+     */
+    void clearSendQueue(const boost::system::error_code& code);
+
 private:
     uint64_t m_id = 0; /* ID */
-    std::mutex m_mutex;
+    std::mutex m_mutex; /* for 套接字指针(不在发送时持有, 避免阻塞的发送影响其他操作) */
     std::shared_ptr<SocketTcpBase> m_socketTcpBase = nullptr; /* 套接字 */
+    std::mutex m_mutexSyncSend; /* for 同步发送(保证多线程发送时数据不交织, 关闭套接字前需要等待) */
     std::atomic_bool m_isEnableSSL = {false}; /* 是否启用SSL */
     std::atomic_bool m_isConnected = {false}; /* 是否已连接上 */
     std::vector<unsigned char> m_recvBuf; /* 接收缓冲区 */
+    std::vector<unsigned char> m_sendFileBuf; /* 发送文件的缓冲区(不支持零拷贝发送时使用, 分配后复用) */
+    std::shared_ptr<TCP_RECV_CALLBACK> m_onRecvCallback = nullptr; /* 接收回调(只创建一次, 循环接收时复用) */
     TCP_CONNECT_CALLBACK m_onConnectCallback = nullptr; /* 连接回调 */
     TCP_DATA_CALLBACK m_onDataCallback = nullptr; /* 数据回调 */
+    TCP_DATA_VIEW_CALLBACK m_onDataViewCallback = nullptr; /* 数据回调(零拷贝) */
+    TCP_DATA_BUFFER_CALLBACK m_onDataBufferCallback = nullptr; /* 数据回调(缓冲区池模式) */
+    std::vector<std::shared_ptr<std::vector<unsigned char>>> m_bufferPool; /* 缓冲区池(只在接收线程中访问) */
+    size_t m_bufferPoolSize = 0; /* 缓冲区池大小 */
+    size_t m_bufferPoolIndex = 0; /* 下次查找空闲缓冲区的起始索引 */
+
+    /**
+     * @brief 发送队列项
+     */
+    struct SendItem
+    {
+        std::vector<unsigned char> data; /* 数据 */
+        TCP_SEND_CALLBACK callback; /* 发送回调 */
+    };
+
+    std::mutex m_mutexSend; /* for 发送队列 */
+    std::deque<SendItem> m_sendQueue; /* 发送队列 */
+    std::vector<SendItem> m_sendingList; /* 正在发送的数据 */
+    std::vector<boost::asio::const_buffer> m_sendingBuffers; /* 正在发送的缓冲区(合并为一次写操作) */
+    size_t m_sendQueueBytes = 0; /* 发送队列中的字节数(包括正在发送的数据) */
+    bool m_sending = false; /* 是否有写操作在进行中 */
+    bool m_sendHighWatermarked = false; /* 是否处于高水位 */
+    size_t m_sendQueueMaxBytes = 16 * 1024 * 1024; /* 发送队列最大字节数 */
+    size_t m_sendHighWatermark = 4 * 1024 * 1024; /* 高水位(字节) */
+    size_t m_sendLowWatermark = 1024 * 1024; /* 低水位(字节) */
+    SendOverflowPolicy m_sendOverflowPolicy = SendOverflowPolicy::drop; /* 溢出策略 */
+    TCP_SEND_WATERMARK_CALLBACK m_onSendWatermarkCallback = nullptr; /* 发送队列水位回调 */
 };
 } // namespace nsocket
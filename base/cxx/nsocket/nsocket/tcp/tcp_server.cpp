@@ -92,32 +92,29 @@ void io_context_pool::start()
 void io_context_pool::join()
 {
     std::lock_guard<std::mutex> locker(m_mutex);
+    /* 注意: 需要先释放work再销毁上下文, 并在线程退出后再销毁上下文(work析构时会访问上下文) */
+    m_ioWorker = nullptr;
     if (m_ioContext)
     {
         m_ioContext->stop();
-        m_ioContext = nullptr;
     }
-    m_ioWorker = nullptr;
     if (m_ioThread)
     {
         m_ioThread->join();
         m_ioThread = nullptr;
     }
+    m_ioContext = nullptr;
+    m_connWorkers.clear();
     for (size_t i = 0; i < m_connContexts.size(); ++i)
     {
         m_connContexts[i]->stop();
     }
-    m_connContexts.clear();
-    for (size_t i = 0; i < m_connWorkers.size(); ++i)
-    {
-        m_connWorkers[i] = nullptr;
-    }
-    m_connWorkers.clear();
     for (size_t i = 0; i < m_connThreads.size(); ++i)
     {
         m_connThreads[i]->join();
     }
     m_connThreads.clear();
+    m_connContexts.clear();
 }
 
 boost::asio::io_context& io_context_pool::getIoContext()
@@ -134,6 +131,18 @@ boost::asio::io_context& io_context_pool::getConnContext()
     return context;
 }
 
+boost::asio::io_context& io_context_pool::getConnContext(size_t index)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return *m_connContexts[index % m_connContexts.size()];
+}
+
+size_t io_context_pool::getConnContextCount()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_connContexts.size();
+}
+
 #if (1 == ENABLE_NSOCKET_OPENSSL)
 static std::mutex s_mutexHandshakeCheck;
 static std::unique_ptr<boost::asio::io_context> s_handshakeCheckContext = nullptr;
@@ -174,11 +183,12 @@ TcpServer::TcpServer(const std::string& name, size_t threadCount, const std::str
 TcpServer::~TcpServer()
 {
     std::lock_guard<std::mutex> locker(m_mutex);
-    if (m_acceptor)
+    for (const auto& acceptor : m_acceptorList)
     {
-        m_acceptor->close();
-        m_acceptor = nullptr;
+        boost::system::error_code code;
+        acceptor->close(code);
     }
+    m_acceptorList.clear();
     if (m_contextPool)
     {
         m_contextPool->join();
@@ -208,11 +218,22 @@ void TcpServer::setConnectionDataCallback(const TCP_SRV_CONN_DATA_CALLBACK& onDa
     m_onConnectionDataCallback = onDataCb;
 }
 
+void TcpServer::setConnectionDataViewCallback(const TCP_SRV_CONN_DATA_VIEW_CALLBACK& onDataViewCb)
+{
+    m_onConnectionDataViewCallback = onDataViewCb;
+}
+
 void TcpServer::setConnectionCloseCallback(const TCP_SRV_CONN_CLOSE_CALLBACK& onCloseCb)
 {
     m_onConnectionCloseCallback = onCloseCb;
 }
 
+void TcpServer::setReusePortAcceptors(bool enable)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    m_reusePortAcceptors = enable;
+}
+
 bool TcpServer::run(bool sslOn, int sslWay, int certFmt, const std::string& certFile, const std::string& pkFile, const std::string& pkPwd,
                     std::string* errorMsg)
 {
@@ -231,9 +252,24 @@ bool TcpServer::run(bool sslOn, int sslWay, int certFmt, const std::string& cert
         }
         try
         {
-            m_acceptor = std::make_shared<boost::asio::ip::tcp::acceptor>(
-                m_contextPool->getIoContext(), boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address(m_host.c_str()), m_port),
-                m_reuseAddr);
+            const boost::asio::ip::tcp::endpoint point(boost::asio::ip::make_address(m_host.c_str()), m_port);
+#ifdef SO_REUSEPORT
+            if (m_reusePortAcceptors) /* 每个连接线程1个接收器, 由内核分配新连接 */
+            {
+                auto first = createAcceptor(m_contextPool->getConnContext(0), point, true);
+                m_acceptorList.emplace_back(first);
+                /* 端口为0时由系统分配, 其余接收器需绑定到相同的端口 */
+                const boost::asio::ip::tcp::endpoint boundPoint(point.address(), first->local_endpoint().port());
+                for (size_t i = 1, count = m_contextPool->getConnContextCount(); i < count; ++i)
+                {
+                    m_acceptorList.emplace_back(createAcceptor(m_contextPool->getConnContext(i), boundPoint, true));
+                }
+            }
+#endif
+            if (m_acceptorList.empty()) /* 单个接收器 */
+            {
+                m_acceptorList.emplace_back(createAcceptor(m_contextPool->getIoContext(), point, false));
+            }
 #if (1 == ENABLE_NSOCKET_OPENSSL)
             if (sslOn)
             {
@@ -251,7 +287,7 @@ bool TcpServer::run(bool sslOn, int sslWay, int certFmt, const std::string& cert
                                                                                   : boost::asio::ssl::context::file_format::pem,
                                                                      certFile, pkFile, pkPwd, true);
                 }
-                auto sessionIdCtx = std::to_string(m_acceptor->local_endpoint().port()) + ':';
+                auto sessionIdCtx = std::to_string(m_acceptorList[0]->local_endpoint().port()) + ':';
                 sessionIdCtx.append(m_host.rbegin(), m_host.rend());
                 SSL_CTX_set_session_id_context(m_sslContext->native_handle(), (const unsigned char*)sessionIdCtx.data(),
                                                std::min<size_t>(sessionIdCtx.size(), SSL_MAX_SSL_SESSION_ID_LENGTH));
@@ -263,7 +299,7 @@ bool TcpServer::run(bool sslOn, int sslWay, int certFmt, const std::string& cert
         }
         catch (const std::exception& e)
         {
-            m_acceptor = nullptr;
+            m_acceptorList.clear();
             if (errorMsg)
             {
                 *errorMsg = std::string("exception: ") + e.what();
@@ -271,7 +307,7 @@ bool TcpServer::run(bool sslOn, int sslWay, int certFmt, const std::string& cert
         }
         catch (...)
         {
-            m_acceptor = nullptr;
+            m_acceptorList.clear();
             if (errorMsg)
             {
                 *errorMsg = "unknown exception";
@@ -280,7 +316,16 @@ bool TcpServer::run(bool sslOn, int sslWay, int certFmt, const std::string& cert
     }
     if (runFlag)
     {
-        doAccept();
+        std::vector<std::shared_ptr<boost::asio::ip::tcp::acceptor>> acceptorList;
+        {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            acceptorList = m_acceptorList;
+        }
+        for (size_t i = 0; i < acceptorList.size(); ++i)
+        {
+            /* 多接收器模式下新连接留在接收器所在的线程, 否则从连接池中轮询 */
+            doAccept(acceptorList[i], acceptorList.size() > 1 ? &m_contextPool->getConnContext(i) : nullptr);
+        }
     }
     return runFlag;
 }
@@ -290,7 +335,12 @@ void TcpServer::stop()
     std::lock_guard<std::mutex> locker(m_mutex);
     if (m_running)
     {
-        m_acceptor->close();
+        for (const auto& acceptor : m_acceptorList)
+        {
+            boost::system::error_code code;
+            acceptor->close(code);
+        }
+        m_acceptorList.clear();
         m_connectionMap.clear();
         m_handshakeMap.clear();
         m_running = false;
@@ -313,20 +363,40 @@ bool TcpServer::isRunning()
     return m_running;
 }
 
-void TcpServer::doAccept()
+std::shared_ptr<boost::asio::ip::tcp::acceptor> TcpServer::createAcceptor(boost::asio::io_context& context,
+                                                                          const boost::asio::ip::tcp::endpoint& point, bool reusePort)
+{
+    if (!reusePort)
+    {
+        return std::make_shared<boost::asio::ip::tcp::acceptor>(context, point, m_reuseAddr);
+    }
+    auto acceptor = std::make_shared<boost::asio::ip::tcp::acceptor>(context);
+    acceptor->open(point.protocol());
+    if (m_reuseAddr)
+    {
+        acceptor->set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    }
+#ifdef SO_REUSEPORT
+    acceptor->set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#endif
+    acceptor->bind(point);
+    acceptor->listen();
+    return acceptor;
+}
+
+void TcpServer::doAccept(const std::shared_ptr<boost::asio::ip::tcp::acceptor>& acceptor, boost::asio::io_context* connContext)
 {
     std::shared_ptr<nsocket::io_context_pool> contextPool;
-    std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
     {
         std::lock_guard<std::mutex> locker(m_mutex);
         contextPool = m_contextPool;
-        acceptor = m_acceptor;
     }
-    if (contextPool && acceptor)
+    if (contextPool && acceptor && acceptor->is_open())
     {
         const std::weak_ptr<TcpServer> wpSelf = shared_from_this();
-        acceptor->async_accept(contextPool->getConnContext(),
-                               [wpSelf](boost::system::error_code code, boost::asio::ip::tcp::socket socket) {
+        acceptor->async_accept(connContext ? *connContext : contextPool->getConnContext(),
+                               [wpSelf, wpAcceptor = std::weak_ptr<boost::asio::ip::tcp::acceptor>(acceptor),
+                                connContext](boost::system::error_code code, boost::asio::ip::tcp::socket socket) {
                                    const auto self = wpSelf.lock();
                                    if (self)
                                    {
@@ -334,8 +404,11 @@ void TcpServer::doAccept()
                                        {
                                            self->handleNewConnection(std::move(socket));
                                        }
-                                       /* 继续接收下一个连接 */
-                                       self->doAccept();
+                                       /* 继续接收下一个连接(接收器已关闭时不再继续, 否则会空转) */
+                                       if (boost::asio::error::operation_aborted != code)
+                                       {
+                                           self->doAccept(wpAcceptor.lock(), connContext);
+                                       }
                                    }
                                });
     }
@@ -378,11 +451,18 @@ void TcpServer::handleNewConnection(boost::asio::ip::tcp::socket socket)
         }
     });
     /* 设置数据回调 */
-    conn->setDataCallback([wpSelf, wpConn](const std::vector<unsigned char>& data) {
+    conn->setDataViewCallback([wpSelf, wpConn](const unsigned char* data, size_t length) {
         const auto self = wpSelf.lock();
-        if (self && self->m_onConnectionDataCallback)
+        if (self)
         {
-            self->m_onConnectionDataCallback(wpConn, data);
+            if (self->m_onConnectionDataViewCallback)
+            {
+                self->m_onConnectionDataViewCallback(wpConn, data, length);
+            }
+            if (self->m_onConnectionDataCallback) /* 兼容旧接口, 需要拷贝数据 */
+            {
+                self->m_onConnectionDataCallback(wpConn, std::vector<unsigned char>(data, data + length));
+            }
         }
     });
     /* 开始连接 */
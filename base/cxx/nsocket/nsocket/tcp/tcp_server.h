@@ -39,6 +39,15 @@ using TLS_SRV_HANDSHAKE_FAIL_CALLBACK =
  */
 using TCP_SRV_CONN_DATA_CALLBACK = std::function<void(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data)>;
 
+/**
+ * @brief TCP数据回调(零拷贝), 注意: 数据仅在回调期间有效
+ * @param wpConn 连接
+ * @param data 数据
+ * @param length 数据长度
+ */
+using TCP_SRV_CONN_DATA_VIEW_CALLBACK =
+    std::function<void(const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length)>;
+
 /**
  * @brief TCP连接关闭回调
  * @param cid 连接ID
@@ -80,11 +89,24 @@ public:
     boost::asio::io_context& getIoContext();
 
     /**
-     * @brief 获取处理连接的上下文
+     * @brief 获取处理连接的上下文(轮询)
      * @return 上下文
      */
     boost::asio::io_context& getConnContext();
 
+    /**
+     * @brief 获取指定的处理连接的上下文
+     * @param index 索引, 值: [0, getConnContextCount())
+     * @return 上下文
+     */
+    boost::asio::io_context& getConnContext(size_t index);
+
+    /**
+     * @brief 获取处理连接的上下文个数
+     * @return 个数
+     */
+    size_t getConnContextCount();
+
 private:
     const std::string m_name; /* 名称 */
     std::mutex m_mutex;
@@ -145,12 +167,26 @@ public:
      */
     void setConnectionDataCallback(const TCP_SRV_CONN_DATA_CALLBACK& onDataCb);
 
+    /**
+     * @brief 设置数据回调(零拷贝, 接收时不分配内存), 注意: 严禁在回调里执行死循环或长时间循环逻辑, 否则会阻塞该连接线程
+     * @param onDataViewCb 数据回调
+     */
+    void setConnectionDataViewCallback(const TCP_SRV_CONN_DATA_VIEW_CALLBACK& onDataViewCb);
+
     /**
      * @brief 设置连接关闭回调
      * @param onCloseCb 连接关闭回调
      */
     void setConnectionCloseCallback(const TCP_SRV_CONN_CLOSE_CALLBACK& onCloseCb);
 
+    /**
+     * @brief 设置是否启用多接收器模式(需要在运行前设置, 仅支持SO_REUSEPORT的平台有效, 例如: Linux 3.9+),
+     *        启用后每个连接线程拥有各自的接收器(绑定到相同的主机和端口), 由内核在各个线程之间分配新连接,
+     *        适用于大量客户端同时(重)连接的场景, 默认只有1个接收器(在I/O线程接收后分配到连接线程)
+     * @param enable 是否启用
+     */
+    void setReusePortAcceptors(bool enable);
+
     /**
      * @brief 运行(非阻塞)
      * @param sslOn 是否开启SSL, true-是, false-否
@@ -183,10 +219,22 @@ public:
     bool isRunning();
 
 private:
+    /**
+     * @brief 创建接收器
+     * @param context 上下文
+     * @param point 绑定的端点
+     * @param reusePort 是否设置SO_REUSEPORT
+     * @return 接收器
+     */
+    std::shared_ptr<boost::asio::ip::tcp::acceptor> createAcceptor(boost::asio::io_context& context,
+                                                                   const boost::asio::ip::tcp::endpoint& point, bool reusePort);
+
     /**
      * @brief 接收客户端连接请求
+     * @param acceptor 接收器
+     * @param connContext 接收的连接所在的上下文, 为空表示从连接池中轮询
      */
-    void doAccept();
+    void doAccept(const std::shared_ptr<boost::asio::ip::tcp::acceptor>& acceptor, boost::asio::io_context* connContext);
 
     /**
      * @brief 处理客户端新连接
@@ -218,7 +266,8 @@ private:
     const uint32_t m_bufferSize; /* 数据接收缓冲区大小 */
     const std::chrono::steady_clock::duration m_handshakeTimeout; /* 握手超时时间 */
     std::mutex m_mutex;
-    std::shared_ptr<boost::asio::ip::tcp::acceptor> m_acceptor = nullptr; /* 接收器 */
+    bool m_reusePortAcceptors = false; /* 是否启用多接收器模式 */
+    std::vector<std::shared_ptr<boost::asio::ip::tcp::acceptor>> m_acceptorList; /* 接收器列表 */
 #if (1 == ENABLE_NSOCKET_OPENSSL)
     std::shared_ptr<boost::asio::ssl::context> m_sslContext = nullptr; /* TLS上下文 */
 #endif
@@ -228,6 +277,7 @@ private:
     TLS_SRV_HANDSHAKE_OK_CALLBACK m_onHandshakeOkCallback = nullptr; /* 握手成功回调 */
     TLS_SRV_HANDSHAKE_FAIL_CALLBACK m_onHandshakeFailCallback = nullptr; /* 握手成失败回调 */
     TCP_SRV_CONN_DATA_CALLBACK m_onConnectionDataCallback = nullptr; /* 连接数据回调 */
+    TCP_SRV_CONN_DATA_VIEW_CALLBACK m_onConnectionDataViewCallback = nullptr; /* 连接数据回调(零拷贝) */
     TCP_SRV_CONN_CLOSE_CALLBACK m_onConnectionCloseCallback = nullptr; /* 连接关闭回调 */
     bool m_running = false; /* 是否运行中 */
 };
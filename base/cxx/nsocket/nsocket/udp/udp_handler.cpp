@@ -53,6 +53,12 @@ void UdpHandler::setDataCallback(const UDP_DATA_CALLBACK& onDataCb)
     m_onDataCallback = onDataCb;
 }
 
+void UdpHandler::setBatchDataCallback(const UDP_BATCH_DATA_CALLBACK& onBatchDataCb, size_t batchCount)
+{
+    m_onBatchDataCallback = onBatchDataCb;
+    m_batchCount = (batchCount > 0 ? batchCount : 1);
+}
+
 void UdpHandler::setNonBlock(bool nonBlock)
 {
     std::shared_ptr<SocketUdpBase> socketUdpBase = nullptr;
@@ -92,6 +98,19 @@ void UdpHandler::setRecvBufferSize(int bufferSize)
     }
 }
 
+void UdpHandler::setReusePort(bool reusePort)
+{
+    std::shared_ptr<SocketUdpBase> socketUdpBase = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        socketUdpBase = m_socketUdpBase;
+    }
+    if (socketUdpBase)
+    {
+        socketUdpBase->setReusePort(reusePort);
+    }
+}
+
 void UdpHandler::open(const boost::asio::ip::udp::endpoint& point, bool broadcast)
 {
     std::shared_ptr<SocketUdpBase> socketUdpBase = nullptr;
@@ -185,6 +204,49 @@ void UdpHandler::send(const boost::asio::ip::udp::endpoint& point, const std::ve
     }
 }
 
+void UdpHandler::sendBatch(const UdpDatagram* datagrams, size_t count, const UDP_SEND_CALLBACK& onSendCb)
+{
+    std::shared_ptr<SocketUdpBase> socketUdpBase = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        socketUdpBase = m_socketUdpBase;
+    }
+    if (socketUdpBase && m_isOpened)
+    {
+        if (!datagrams || 0 == count)
+        {
+            if (onSendCb)
+            {
+                onSendCb(boost::system::errc::make_error_code(boost::system::errc::no_message_available), 0);
+            }
+        }
+        else if (!socketUdpBase->sendBatch(datagrams, count, onSendCb)) /* 不支持批量发送, 逐个发送 */
+        {
+            boost::system::error_code code;
+            size_t sentCount = 0;
+            while (sentCount < count && m_isOpened)
+            {
+                const auto& item = datagrams[sentCount];
+                socketUdpBase->send(item.point, boost::asio::buffer(item.data, item.length),
+                                    [&code](const boost::system::error_code& ec, size_t length) { code = ec; });
+                if (code)
+                {
+                    break;
+                }
+                ++sentCount;
+            }
+            if (onSendCb)
+            {
+                onSendCb(m_isOpened ? code : boost::system::errc::make_error_code(boost::system::errc::not_connected), sentCount);
+            }
+        }
+    }
+    else if (onSendCb)
+    {
+        onSendCb(boost::system::errc::make_error_code(boost::system::errc::not_connected), 0);
+    }
+}
+
 void UdpHandler::UdpHandler::recv()
 {
     std::shared_ptr<SocketUdpBase> socketUdpBase = nullptr;
@@ -195,10 +257,42 @@ void UdpHandler::UdpHandler::recv()
     if (socketUdpBase)
     {
         const std::weak_ptr<UdpHandler> wpSelf = shared_from_this();
+        if (m_onBatchDataCallback)
+        {
+            const auto onRecvCb = [wpSelf](const boost::system::error_code& code, const UdpDatagram* datagrams, size_t count) {
+                const auto self = wpSelf.lock();
+                if (self)
+                {
+                    if (code || count > 0)
+                    {
+                        self->m_onBatchDataCallback(code, datagrams, count);
+                    }
+                    if (self->m_isOpened)
+                    {
+                        self->recv(); /* 继续接收 */
+                    }
+                }
+            };
+            if (socketUdpBase->recvBatch(m_batchCount, m_recvBuf.size(), onRecvCb))
+            {
+                return;
+            }
+        }
         socketUdpBase->recv(boost::asio::buffer(m_recvBuf),
                             [wpSelf](const boost::asio::ip::udp::endpoint& point, const boost::system::error_code& code, size_t length) {
                                 const auto self = wpSelf.lock();
-                                if (self)
+                                if (self && self->m_onBatchDataCallback) /* 不支持批量接收, 每次回调1个数据报 */
+                                {
+                                    self->m_singleDatagram.point = point;
+                                    self->m_singleDatagram.data = self->m_recvBuf.data();
+                                    self->m_singleDatagram.length = (code ? 0 : length);
+                                    self->m_onBatchDataCallback(code, &self->m_singleDatagram, code ? 0 : 1);
+                                    if (self->m_isOpened)
+                                    {
+                                        self->recv();
+                                    }
+                                }
+                                else if (self)
                                 {
                                     std::vector<unsigned char> data;
                                     if (!code) /* 接收成功 */
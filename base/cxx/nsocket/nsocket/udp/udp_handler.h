@@ -18,6 +18,14 @@ namespace nsocket
 using UDP_DATA_CALLBACK = std::function<void(const boost::asio::ip::udp::endpoint& point, const boost::system::error_code& code,
                                              const std::vector<unsigned char>& data)>;
 
+/**
+ * @brief UDP批量数据回调(数据报只在回调期间有效, 无内存分配和拷贝)
+ * @param code 错误码
+ * @param datagrams 数据报列表
+ * @param count 数据报数量
+ */
+using UDP_BATCH_DATA_CALLBACK = std::function<void(const boost::system::error_code& code, const UdpDatagram* datagrams, size_t count)>;
+
 /**
  * @brief UDP处理器, 注意: 调用close后实例不可再使用, 需要重新创建
  */
@@ -63,6 +71,14 @@ public:
      */
     void setDataCallback(const UDP_DATA_CALLBACK& onDataCb);
 
+    /**
+     * @brief 设置批量数据回调(打开前调用才有效, 设置后优先于数据回调), 说明: 每次可读时用recvmmsg读取多个数据报到预分配的缓冲区,
+     *        平台不支持时退化为逐个接收(每次回调1个数据报)
+     * @param onBatchDataCb 批量数据回调
+     * @param batchCount 每次最多接收的数据报数量(每个数据报最大长度为数据缓冲区大小)
+     */
+    void setBatchDataCallback(const UDP_BATCH_DATA_CALLBACK& onBatchDataCb, size_t batchCount = 64);
+
     /**
      * @brief 设置非阻塞(打开前调用才有效)
      * @param nonBlock true-非阻塞, false-阻塞
@@ -81,6 +97,12 @@ public:
      */
     void setRecvBufferSize(int bufferSize);
 
+    /**
+     * @brief 设置是否允许多个处理器绑定到相同的端口(SO_REUSEPORT, 打开前调用才有效), 用于在多个线程中分担接收
+     * @param reusePort true-允许, false-不允许
+     */
+    void setReusePort(bool reusePort);
+
     /**
      * @brief 打开
      * @param point 本地端点
@@ -96,6 +118,14 @@ public:
      */
     void send(const boost::asio::ip::udp::endpoint& point, const std::vector<unsigned char>& data, const UDP_SEND_CALLBACK& onSendCb);
 
+    /**
+     * @brief 批量发送数据(同步, 平台支持时使用sendmmsg和UDP GSO, 否则逐个发送)
+     * @param datagrams 数据报列表
+     * @param count 数据报数量
+     * @param onSendCb 发送回调(参数length为已发送的数据报数量)
+     */
+    void sendBatch(const UdpDatagram* datagrams, size_t count, const UDP_SEND_CALLBACK& onSendCb);
+
     /**
      * @brief 关闭
      */
@@ -150,5 +180,8 @@ private:
     std::vector<unsigned char> m_recvBuf; /* 接收缓冲区 */
     UDP_OPEN_CALLBACK m_onOpenCallback = nullptr; /* 打开回调 */
     UDP_DATA_CALLBACK m_onDataCallback = nullptr; /* 数据回调 */
+    UDP_BATCH_DATA_CALLBACK m_onBatchDataCallback = nullptr; /* 批量数据回调 */
+    size_t m_batchCount = 64; /* 每次最多接收的数据报数量 */
+    UdpDatagram m_singleDatagram; /* 不支持批量接收时, 逐个接收的数据报 */
 };
 } // namespace nsocket
@@ -23,6 +23,13 @@ void UdpNode::setDataCallback(const UDP_DATA_CALLBACK& onDataCb)
 {
     m_onDataCallback = onDataCb;
 }
+
+void UdpNode::setBatchDataCallback(const UDP_BATCH_DATA_CALLBACK& onBatchDataCb, size_t batchCount)
+{
+    m_onBatchDataCallback = onBatchDataCb;
+    m_batchCount = batchCount;
+}
+
 void UdpNode::setNonBlock(bool nonBlock)
 {
     m_nonBlock = nonBlock ? 1 : 0;
@@ -38,6 +45,11 @@ void UdpNode::setRecvBufferSize(int bufferSize)
     m_recvBufferSize = bufferSize;
 }
 
+void UdpNode::setReusePort(bool reusePort)
+{
+    m_reusePort = reusePort;
+}
+
 void UdpNode::run(const std::string& host, unsigned int port, bool broadcast)
 {
     if (RunStatus::running == m_runStatus)
@@ -66,6 +78,10 @@ void UdpNode::run(const std::string& host, unsigned int port, bool broadcast)
             }
         });
         udpHandler->setDataCallback(m_onDataCallback);
+        if (m_onBatchDataCallback)
+        {
+            udpHandler->setBatchDataCallback(m_onBatchDataCallback, m_batchCount);
+        }
         if (m_nonBlock >= 0)
         {
             udpHandler->setNonBlock(m_nonBlock > 0 ? true : false);
@@ -78,6 +94,10 @@ void UdpNode::run(const std::string& host, unsigned int port, bool broadcast)
         {
             udpHandler->setRecvBufferSize(m_recvBufferSize);
         }
+        if (m_reusePort)
+        {
+            udpHandler->setReusePort(true);
+        }
         {
             std::lock_guard<std::mutex> locker(m_mutex);
             m_udpHandler = udpHandler;
@@ -172,6 +192,25 @@ void UdpNode::sendAsync(const std::string& host, unsigned int port, const std::v
     }
 }
 
+boost::system::error_code UdpNode::sendBatch(const UdpDatagram* datagrams, size_t count, size_t& sentCount)
+{
+    auto code = boost::system::errc::make_error_code(boost::system::errc::not_connected);
+    sentCount = 0;
+    std::shared_ptr<UdpHandler> udpHandler = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        udpHandler = m_udpHandler;
+    }
+    if (RunStatus::running == m_runStatus && !m_ioContext.stopped() && udpHandler)
+    {
+        udpHandler->sendBatch(datagrams, count, [&code, &sentCount](const boost::system::error_code& ec, size_t length) {
+            code = ec;
+            sentCount = length;
+        });
+    }
+    return code;
+}
+
 void UdpNode::stop()
 {
     if (RunStatus::running == m_runStatus)
@@ -35,6 +35,13 @@ public:
      */
     void setDataCallback(const UDP_DATA_CALLBACK& onDataCb);
 
+    /**
+     * @brief 设置批量数据回调(运行前调用才有效, 设置后优先于数据回调)
+     * @param onBatchDataCb 批量数据回调
+     * @param batchCount 每次最多接收的数据报数量
+     */
+    void setBatchDataCallback(const UDP_BATCH_DATA_CALLBACK& onBatchDataCb, size_t batchCount = 64);
+
     /**
      * @brief 设置非阻塞(运行前调用才有效)
      * @param nonBlock true-非阻塞, false-阻塞
@@ -53,6 +60,12 @@ public:
      */
     void setRecvBufferSize(int bufferSize);
 
+    /**
+     * @brief 设置是否允许多个节点绑定到相同的端口(运行前调用才有效), 说明: 多个节点在各自的线程中运行, 由内核按四元组哈希分配数据报
+     * @param reusePort true-允许, false-不允许
+     */
+    void setReusePort(bool reusePort);
+
     /**
      * @brief 运行(进入循环, 阻塞和占用调用线程)
      * @param host 本地地址
@@ -80,6 +93,15 @@ public:
      */
     void sendAsync(const std::string& host, unsigned int port, const std::vector<unsigned char>& data, const UDP_SEND_CALLBACK& onSendCb);
 
+    /**
+     * @brief 批量发送数据(同步, 平台支持时使用sendmmsg和UDP GSO, 1次系统调用发送多个数据报)
+     * @param datagrams 数据报列表(远端端点需已解析)
+     * @param count 数据报数量
+     * @param sentCount [输出]已发送的数据报数量
+     * @return 错误码
+     */
+    boost::system::error_code sendBatch(const UdpDatagram* datagrams, size_t count, size_t& sentCount);
+
     /**
      * @brief 停止
      */
@@ -129,9 +151,12 @@ private:
     size_t m_bufferSize; /* 数据接收缓冲区大小 */
     UDP_OPEN_CALLBACK m_onOpenCallback = nullptr; /* 打开回调 */
     UDP_DATA_CALLBACK m_onDataCallback = nullptr; /* 数据回调 */
+    UDP_BATCH_DATA_CALLBACK m_onBatchDataCallback = nullptr; /* 批量数据回调 */
+    size_t m_batchCount = 64; /* 每次最多接收的数据报数量 */
     std::atomic<int> m_nonBlock = {-1}; /* 是否非阻塞: <0-默认, 0-阻塞, 1-非阻塞 */
     std::atomic<int> m_sendBufferSize = {-1}; /* 发送缓冲区大小(字节), <=0-默认, >0-指定大小 */
     std::atomic<int> m_recvBufferSize = {-1}; /* 接收缓冲区大小(字节), <=0-默认, >0-指定大小 */
+    std::atomic_bool m_reusePort = {false}; /* 是否允许多个节点绑定到相同的端口 */
     enum class RunStatus
     {
         idle, /* 空闲 */
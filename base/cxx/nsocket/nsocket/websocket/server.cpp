@@ -68,13 +68,14 @@ bool Server::run(bool sslOn, int sslWay, int certFmt, const std::string& certFil
             self->handleNewConnection(wpConn);
         }
     });
-    m_tcpServer->setConnectionDataCallback([wpSelf](const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data) {
-        const auto self = wpSelf.lock();
-        if (self)
-        {
-            self->handleConnectionData(wpConn, data);
-        }
-    });
+    m_tcpServer->setConnectionDataViewCallback(
+        [wpSelf](const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length) {
+            const auto self = wpSelf.lock();
+            if (self)
+            {
+                self->handleConnectionData(wpConn, data, length);
+            }
+        });
     m_tcpServer->setConnectionCloseCallback(
         [wpSelf](uint64_t cid, const boost::asio::ip::tcp::endpoint& point, const boost::system::error_code& code) {
             const auto self = wpSelf.lock();
@@ -124,7 +125,7 @@ void Server::handleNewConnection(const std::weak_ptr<TcpConnection>& wpConn)
     }
 }
 
-void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data)
+void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length)
 {
     const auto conn = wpConn.lock();
     if (conn)
@@ -151,15 +152,15 @@ void Server::handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, co
         auto frameFinishCb = [&]() { handleFrameFinish(session); };
         if (session->m_req->isParseEnd()) /* 请求处理完毕, 后续收到的都是帧数据 */
         {
-            used = session->m_frame->parse(data.data(), data.size(), frameHeadCb, framePayloadCb, frameFinishCb);
+            used = session->m_frame->parse(data, length, frameHeadCb, framePayloadCb, frameFinishCb);
         }
         else /* 请求未处理结束, 需要继续解析 */
         {
-            used = session->m_req->parse(data.data(), data.size(), [&]() { handleRequest(session); });
-            int remainLen = data.size() - used;
+            used = session->m_req->parse(data, length, [&]() { handleRequest(session); });
+            int remainLen = length - used;
             if (remainLen > 0 && session->m_req->isParseEnd()) /* 有剩余数据, 则视为帧数据(该情况几乎不会出现, 这里只是防御性处理) */
             {
-                const unsigned char* remainData = data.data() + used;
+                const unsigned char* remainData = data + used;
                 used = session->m_frame->parse(remainData, remainLen, frameHeadCb, framePayloadCb, frameFinishCb);
             }
         }
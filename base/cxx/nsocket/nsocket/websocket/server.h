@@ -146,7 +146,7 @@ private:
     /**
      * @brief 处理连接数据
      */
-    void handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const std::vector<unsigned char>& data);
+    void handleConnectionData(const std::weak_ptr<TcpConnection>& wpConn, const unsigned char* data, size_t length);
 
     /**
      * @brief 处理连接断开
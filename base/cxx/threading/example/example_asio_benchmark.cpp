@@ -0,0 +1,163 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "threading/asio/asio_executor.h"
+#include "threading/diagnose/diagnose.h"
+#include "threading/platform.h"
+#include "threading/task/simple_task.h"
+
+/**
+ * @brief 压测计数器, 所有任务执行完毕后唤醒等待者
+ */
+struct BenchCounter
+{
+    explicit BenchCounter(size_t total) : total(total) {}
+
+    void done()
+    {
+        if (++count == total)
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            cv.notify_all();
+        }
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        cv.wait(locker, [&] { return count >= total; });
+    }
+
+    const size_t total;
+    std::atomic<size_t> count = {0};
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+/**
+ * @brief 压测结果
+ */
+struct BenchResult
+{
+    double postPerSec = 0; /* 投递速率(个/秒) */
+    double runPerSec = 0; /* 执行速率(个/秒), 从第一个投递到最后一个执行完毕 */
+};
+
+/**
+ * @brief 模拟旧的投递方式: 每次投递加锁拷贝整个线程映射表, 执行时再查表并转换线程id字符串
+ */
+static BenchResult benchLegacy(size_t threadCount, size_t taskCount)
+{
+    threading::AsioExecutor executor("bench", threadCount);
+    std::mutex mapMutex;
+    std::unordered_map<int, std::string> threadIdNameMap;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threadIdNameMap[(int)i + 1] = "bench-" + std::to_string(i + 1);
+    }
+    BenchCounter counter(taskCount);
+    auto tp1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < taskCount; ++i)
+    {
+        auto task = std::make_shared<threading::SimpleTask>("bench", [&counter] { counter.done(); });
+        std::unordered_map<int, std::string> mapCopy;
+        {
+            std::lock_guard<std::mutex> locker(mapMutex);
+            mapCopy = threadIdNameMap;
+        }
+        boost::asio::post(*executor.getContext(), [mapCopy, task] {
+            auto threadId = threading::Platform::getThreadId();
+            std::string threadName = std::to_string(threadId);
+            auto iter = mapCopy.find(threadId);
+            if (mapCopy.end() != iter)
+            {
+                threadName = iter->second;
+            }
+            task->setState(threading::Task::State::running);
+            task->run();
+            task->setState(threading::Task::State::finished);
+        });
+    }
+    auto tp2 = std::chrono::steady_clock::now();
+    counter.wait();
+    auto tp3 = std::chrono::steady_clock::now();
+    BenchResult result;
+    result.postPerSec = taskCount / std::chrono::duration<double>(tp2 - tp1).count();
+    result.runPerSec = taskCount / std::chrono::duration<double>(tp3 - tp1).count();
+    return result;
+}
+
+/**
+ * @brief 打印诊断模块统计的耗时
+ */
+static void printLatencyInfo()
+{
+    auto us = [](const std::chrono::steady_clock::duration& d) {
+        return (long long)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    };
+    for (const auto& info : threading::Diagnose::getLatencyInfo())
+    {
+        printf("    executor[%s] count: %llu, queue p50/p99/max: %lld/%lld/%lld us, run p50/p99/max: %lld/%lld/%lld us\n", info.name.c_str(),
+               (unsigned long long)info.queue.count, us(info.queue.p50), us(info.queue.p99), us(info.queue.max), us(info.run.p50),
+               us(info.run.p99), us(info.run.max));
+    }
+}
+
+/**
+ * @brief 当前的投递方式: AsioExecutor::post
+ * @param printLatency 是否打印诊断模块统计的耗时(需先开启诊断功能)
+ */
+static BenchResult benchCurrent(size_t threadCount, size_t taskCount, bool printLatency = false)
+{
+    threading::AsioExecutor executor("bench", threadCount);
+    BenchCounter counter(taskCount);
+    auto tp1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < taskCount; ++i)
+    {
+        executor.post(std::make_shared<threading::SimpleTask>("bench", [&counter] { counter.done(); }));
+    }
+    auto tp2 = std::chrono::steady_clock::now();
+    counter.wait();
+    auto tp3 = std::chrono::steady_clock::now();
+    BenchResult result;
+    result.postPerSec = taskCount / std::chrono::duration<double>(tp2 - tp1).count();
+    result.runPerSec = taskCount / std::chrono::duration<double>(tp3 - tp1).count();
+    if (printLatency)
+    {
+        executor.join();
+        printLatencyInfo();
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    size_t taskCount = 1000000;
+    if (argc > 1)
+    {
+        taskCount = std::max<size_t>(1, std::atoll(argv[1]));
+    }
+    printf("tasks per round: %zu\n", taskCount);
+    printf("%-8s %-8s %16s %16s\n", "threads", "mode", "posts/sec", "runs/sec");
+    const std::vector<size_t> threadCountList = {1, 4, 16};
+    for (auto threadCount : threadCountList)
+    {
+        auto legacy = benchLegacy(threadCount, taskCount);
+        printf("%-8zu %-8s %16.0f %16.0f\n", threadCount, "legacy", legacy.postPerSec, legacy.runPerSec);
+        auto current = benchCurrent(threadCount, taskCount);
+        printf("%-8zu %-8s %16.0f %16.0f\n", threadCount, "current", current.postPerSec, current.runPerSec);
+        threading::Diagnose::setEnable(true);
+        auto diagnose = benchCurrent(threadCount, taskCount, true);
+        printf("%-8zu %-8s %16.0f %16.0f\n", threadCount, "diagnose", diagnose.postPerSec, diagnose.runPerSec);
+        threading::Diagnose::setEnable(false);
+    }
+    return 0;
+}
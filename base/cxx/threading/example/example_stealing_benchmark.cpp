@@ -0,0 +1,135 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "threading/thread_proxy.hpp"
+
+/**
+ * @brief 压测计数器, 所有任务执行完毕后唤醒等待者
+ */
+struct BenchCounter
+{
+    explicit BenchCounter(size_t total) : total(total) {}
+
+    void done()
+    {
+        if (++count == total)
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            cv.notify_all();
+        }
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        cv.wait(locker, [&] { return count >= total; });
+    }
+
+    const size_t total;
+    std::atomic<size_t> count = {0};
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+/**
+ * @brief 模拟少量计算
+ */
+static void spinWork(int loops)
+{
+    volatile int sum = 0;
+    for (int i = 0; i < loops; ++i)
+    {
+        sum += i;
+    }
+}
+
+/**
+ * @brief 扇出/扇入: 外部线程一次性投递全部任务, 等待全部完成
+ * @return 任务数/秒
+ */
+static double benchFanOut(const threading::ExecutorPtr& executor, size_t taskCount, int loops)
+{
+    BenchCounter counter(taskCount);
+    auto tp1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < taskCount; ++i)
+    {
+        executor->post("fanout", [&counter, loops] {
+            spinWork(loops);
+            counter.done();
+        });
+    }
+    counter.wait();
+    auto tp2 = std::chrono::steady_clock::now();
+    return taskCount / std::chrono::duration<double>(tp2 - tp1).count();
+}
+
+/**
+ * @brief 嵌套投递: 每个任务在执行线程内继续投递2个子任务, 直到达到指定深度(二叉树)
+ * @return 任务数/秒
+ */
+static double benchNested(const threading::ExecutorPtr& executor, int depth, int loops)
+{
+    const size_t taskCount = (size_t(1) << (depth + 1)) - 1;
+    BenchCounter counter(taskCount);
+    std::function<void(int)> node;
+    node = [&](int level) {
+        spinWork(loops);
+        if (level < depth)
+        {
+            executor->post("nested", [&node, level] { node(level + 1); });
+            executor->post("nested", [&node, level] { node(level + 1); });
+        }
+        counter.done();
+    };
+    auto tp1 = std::chrono::steady_clock::now();
+    executor->post("nested", [&node] { node(0); });
+    counter.wait();
+    auto tp2 = std::chrono::steady_clock::now();
+    return taskCount / std::chrono::duration<double>(tp2 - tp1).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t taskCount = 500000;
+    int depth = 18;
+    int loops = 200;
+    if (argc > 1)
+    {
+        taskCount = std::max<size_t>(1, std::atoll(argv[1]));
+    }
+    if (argc > 2)
+    {
+        depth = std::max(1, std::atoi(argv[2]));
+    }
+    if (argc > 3)
+    {
+        loops = std::max(0, std::atoi(argv[3]));
+    }
+    printf("fan-out tasks: %zu, nested depth: %d (%zu tasks), spin loops: %d\n", taskCount, depth, (size_t(1) << (depth + 1)) - 1,
+           loops);
+    printf("%-8s %-10s %16s %16s\n", "threads", "executor", "fanout/sec", "nested/sec");
+    const std::vector<size_t> threadCountList = {1, 4, 16};
+    for (auto threadCount : threadCountList)
+    {
+        {
+            auto executor = threading::ThreadProxy::createAsioExecutor("bench", threadCount);
+            auto fanout = benchFanOut(executor, taskCount, loops);
+            auto nested = benchNested(executor, depth, loops);
+            printf("%-8zu %-10s %16.0f %16.0f\n", threadCount, "asio", fanout, nested);
+        }
+        {
+            auto executor = threading::ThreadProxy::createWorkStealingExecutor("bench", threadCount);
+            auto fanout = benchFanOut(executor, taskCount, loops);
+            auto nested = benchNested(executor, depth, loops);
+            printf("%-8zu %-10s %16.0f %16.0f\n", threadCount, "stealing", fanout, nested);
+        }
+    }
+    return 0;
+}
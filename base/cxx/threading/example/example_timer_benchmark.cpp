@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "threading/thread_proxy.hpp"
+#include "threading/timer/steady_timer.h"
+
+/**
+ * @brief 计算每次操作的耗时(纳秒)
+ */
+static double nsPerOp(const std::chrono::steady_clock::time_point& tp1, const std::chrono::steady_clock::time_point& tp2, size_t count)
+{
+    return std::chrono::duration<double, std::nano>(tp2 - tp1).count() / std::max<size_t>(1, count);
+}
+
+/**
+ * @brief 时间轮定时器: 创建/布防/重新布防(心跳重置)/取消
+ */
+static void benchWheel(size_t timerCount)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(30000, 90000); /* 30~90秒, 压测期间不会触发 */
+    std::vector<threading::SteadyTimerPtr> timerList;
+    timerList.reserve(timerCount);
+    auto tp1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < timerCount; ++i)
+    {
+        timerList.emplace_back(threading::SteadyTimer::onceTimer("bench", std::chrono::milliseconds(dist(rng)),
+                                                                 [](const std::chrono::steady_clock::time_point&) {}));
+    }
+    auto tp2 = std::chrono::steady_clock::now();
+    for (const auto& timer : timerList)
+    {
+        timer->start();
+    }
+    auto tp3 = std::chrono::steady_clock::now();
+    const size_t armedCount = threading::TimerWheel::getInstance().getCount();
+    for (const auto& timer : timerList)
+    {
+        timer->stop();
+        timer->start();
+    }
+    auto tp4 = std::chrono::steady_clock::now();
+    for (const auto& timer : timerList)
+    {
+        timer->stop();
+    }
+    auto tp5 = std::chrono::steady_clock::now();
+    printf("%-12s %12.1f %12.1f %12.1f %12.1f %12zu\n", "wheel", nsPerOp(tp1, tp2, timerCount), nsPerOp(tp2, tp3, timerCount),
+           nsPerOp(tp3, tp4, timerCount), nsPerOp(tp4, tp5, timerCount), armedCount);
+}
+
+/**
+ * @brief boost::asio::steady_timer(对照): 创建/布防/重新布防/取消
+ */
+static void benchAsio(size_t timerCount)
+{
+    boost::asio::io_context context;
+    auto work = boost::asio::make_work_guard(context);
+    std::thread thread([&context] { context.run(); });
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(30000, 90000);
+    std::vector<std::unique_ptr<boost::asio::steady_timer>> timerList;
+    timerList.reserve(timerCount);
+    auto tp1 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < timerCount; ++i)
+    {
+        timerList.emplace_back(std::make_unique<boost::asio::steady_timer>(context));
+    }
+    auto tp2 = std::chrono::steady_clock::now();
+    for (const auto& timer : timerList)
+    {
+        timer->expires_after(std::chrono::milliseconds(dist(rng)));
+        timer->async_wait([](const boost::system::error_code&) {});
+    }
+    auto tp3 = std::chrono::steady_clock::now();
+    for (const auto& timer : timerList)
+    {
+        timer->expires_after(std::chrono::milliseconds(dist(rng))); /* 会取消之前的等待 */
+        timer->async_wait([](const boost::system::error_code&) {});
+    }
+    auto tp4 = std::chrono::steady_clock::now();
+    for (const auto& timer : timerList)
+    {
+        timer->cancel();
+    }
+    auto tp5 = std::chrono::steady_clock::now();
+    printf("%-12s %12.1f %12.1f %12.1f %12.1f %12zu\n", "asio_timer", nsPerOp(tp1, tp2, timerCount), nsPerOp(tp2, tp3, timerCount),
+           nsPerOp(tp3, tp4, timerCount), nsPerOp(tp4, tp5, timerCount), timerCount);
+    work.reset();
+    context.stop();
+    thread.join();
+}
+
+/**
+ * @brief 到期批量投递: 定时器均匀分布在1秒内到期, 统计触发延迟
+ */
+static void benchExpiry(size_t fireCount)
+{
+    auto executor = threading::ThreadProxy::createAsioExecutor("bench", 1);
+    std::vector<int64_t> lateList(fireCount, 0); /* 触发延迟(微秒) */
+    std::atomic<size_t> firedCount = {0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<threading::SteadyTimerPtr> timerList;
+    timerList.reserve(fireCount);
+    for (size_t i = 0; i < fireCount; ++i)
+    {
+        const auto delay = std::chrono::microseconds(1000000 * i / fireCount);
+        timerList.emplace_back(threading::SteadyTimer::onceTimer(
+            "bench", delay,
+            [&, i, expected = std::chrono::steady_clock::now() + delay](const std::chrono::steady_clock::time_point&) {
+                lateList[i] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - expected).count();
+                if (++firedCount == fireCount)
+                {
+                    std::lock_guard<std::mutex> locker(mutex);
+                    cv.notify_all();
+                }
+            },
+            executor));
+        timerList.back()->start();
+    }
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        cv.wait_for(locker, std::chrono::seconds(30), [&] { return firedCount >= fireCount; });
+    }
+    const size_t fired = firedCount;
+    std::sort(lateList.begin(), lateList.end());
+    printf("expiry: fired %zu/%zu, late(us) p50: %lld, p99: %lld, max: %lld, min: %lld\n", fired, fireCount,
+           (long long)lateList[fireCount / 2], (long long)lateList[fireCount * 99 / 100], (long long)lateList.back(),
+           (long long)lateList.front());
+    timerList.clear();
+    executor->join();
+}
+
+int main(int argc, char** argv)
+{
+    size_t timerCount = 1000000;
+    size_t fireCount = 200000;
+    if (argc > 1)
+    {
+        timerCount = std::max<size_t>(1, std::atoll(argv[1]));
+    }
+    if (argc > 2)
+    {
+        fireCount = std::max<size_t>(1, std::atoll(argv[2]));
+    }
+    printf("timers: %zu, fire: %zu, resolution: %lld us, cpu cores: %u\n", timerCount, fireCount,
+           (long long)std::chrono::duration_cast<std::chrono::microseconds>(threading::TimerWheel::getResolution()).count(),
+           std::thread::hardware_concurrency());
+    printf("%-12s %12s %12s %12s %12s %12s\n", "impl", "create(ns)", "arm(ns)", "rearm(ns)", "cancel(ns)", "outstanding");
+    benchWheel(timerCount);
+    benchAsio(timerCount);
+    benchExpiry(fireCount);
+    return 0;
+}
@@ -7,6 +7,18 @@
 
 namespace threading
 {
+/**
+ * @brief 工作线程信息(在线程入口函数中设置一次, 执行任务时直接读取, 无需加锁查表)
+ */
+struct AsioWorkerInfo
+{
+    const AsioExecutor* executor = nullptr; /* 所属执行者 */
+    int threadId = 0; /* 线程id */
+    std::string threadName; /* 线程名称 */
+};
+
+static thread_local AsioWorkerInfo s_workerInfo;
+
 AsioExecutor::AsioExecutor(const std::string& name, size_t threadCount)
     : Executor(name, threadCount), m_worker(boost::asio::make_work_guard(m_context))
 {
@@ -41,21 +53,17 @@ TaskPtr AsioExecutor::post(const TaskPtr& task, bool wait)
     }
     task->setState(Task::State::queuing);
     Diagnose::onTaskCreated(this, task.get());
-    std::unordered_map<int, std::string> threadIdNameMap;
-    {
-        std::lock_guard<std::mutex> locker(m_mapMutex);
-        threadIdNameMap = m_threadIdNameMap;
-    }
-    boost::asio::post(m_context, [this, threadIdNameMap, task] {
+    boost::asio::post(m_context, [this, task] {
         ++m_busyCount;
-        /* 获取线程名称 */
-        auto threadId = Platform::getThreadId();
-        std::string threadName = std::to_string(threadId);
-        auto iter = threadIdNameMap.find(threadId);
-        if (threadIdNameMap.end() != iter)
+        /* 获取线程信息(非本执行者的线程调用`getContext()->run()`时才需要临时获取) */
+        if (this != s_workerInfo.executor)
         {
-            threadName = iter->second;
+            s_workerInfo.executor = this;
+            s_workerInfo.threadId = Platform::getThreadId();
+            s_workerInfo.threadName = std::to_string(s_workerInfo.threadId);
         }
+        const auto threadId = s_workerInfo.threadId;
+        const auto& threadName = s_workerInfo.threadName;
         /* 执行任务 */
         try
         {
@@ -96,18 +104,13 @@ boost::asio::io_context* AsioExecutor::getContext()
 void AsioExecutor::threadFunc(const std::string& name, size_t totalCount)
 {
     /* 设置线程名称 */
-    ++m_threadIndex;
-    auto threadName = name + (totalCount > 1 ? "-" + std::to_string(m_threadIndex) : "");
+    auto threadIndex = ++m_threadIndex;
+    auto threadName = name + (totalCount > 1 ? "-" + std::to_string(threadIndex) : "");
     Platform::setThreadName(threadName);
-    /* 关联线程id和名称 */
-    auto threadId = Platform::getThreadId();
-    {
-        std::lock_guard<std::mutex> locker(m_mapMutex);
-        if (m_threadIdNameMap.end() == m_threadIdNameMap.find(threadId))
-        {
-            m_threadIdNameMap.insert(std::make_pair(threadId, threadName));
-        }
-    }
+    /* 记录线程信息 */
+    s_workerInfo.executor = this;
+    s_workerInfo.threadId = Platform::getThreadId();
+    s_workerInfo.threadName = threadName;
     m_context.run();
 }
 } // namespace threading
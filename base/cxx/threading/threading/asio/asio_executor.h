@@ -1,8 +1,6 @@
 #pragma once
 #include <atomic>
 #include <boost/asio.hpp>
-#include <mutex>
-#include <unordered_map>
 
 #include "../task/executor.h"
 
@@ -63,8 +61,6 @@ private:
     boost::asio::detail::thread_group m_threads; /* 线程组 */
     boost::asio::io_context m_context;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_worker;
-    std::mutex m_mapMutex; /* 映射表互斥锁 */
-    std::unordered_map<int, std::string> m_threadIdNameMap; /* 线程id和名称映射表 */
     std::atomic_int m_busyCount = {0}; /* 正在执行的线程数 */
 };
 } // namespace threading
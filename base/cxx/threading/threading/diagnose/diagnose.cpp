@@ -1,7 +1,9 @@
 #include "diagnose.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <iostream>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 
@@ -9,97 +11,297 @@
 
 namespace threading
 {
+static const size_t LATENCY_BUCKET_COUNT = 40; /* 耗时分桶数: 第0个桶为[0, 1)微秒, 第i个桶为[2^(i-1), 2^i)微秒 */
+static const size_t SHARD_COUNT = 16; /* 每个执行者的分片数(降低同一执行者内多线程的锁竞争) */
+static const size_t MAX_TASK_STAT_COUNT_PER_SHARD = 64; /* 每个分片最多按名称统计的任务数, 超出后归入同一项 */
+static const std::string OTHER_TASK_NAME = "<other>"; /* 超出统计数量的任务名称 */
+
+/**
+ * @brief 耗时直方图(固定分桶, 记录时无锁)
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram()
+    {
+        reset();
+    }
+
+    void record(const std::chrono::steady_clock::duration& elapsed)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        size_t index = 0;
+        while (index < LATENCY_BUCKET_COUNT - 1 && us >= (int64_t(1) << index))
+        {
+            ++index;
+        }
+        m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+        auto rep = elapsed.count();
+        auto prevMax = m_max.load(std::memory_order_relaxed);
+        while (prevMax < rep && !m_max.compare_exchange_weak(prevMax, rep, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    LatencyStatInfo snapshot() const
+    {
+        std::array<uint64_t, LATENCY_BUCKET_COUNT> buckets;
+        LatencyStatInfo info;
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+        {
+            buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            info.count += buckets[i];
+        }
+        info.max = std::chrono::steady_clock::duration(m_max.load(std::memory_order_relaxed));
+        info.p50 = percentile(buckets, info.count, 50, info.max);
+        info.p99 = percentile(buckets, info.count, 99, info.max);
+        return info;
+    }
+
+    void reset()
+    {
+        for (auto& bucket : m_buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static std::chrono::steady_clock::duration percentile(const std::array<uint64_t, LATENCY_BUCKET_COUNT>& buckets, uint64_t count,
+                                                          uint64_t pct, const std::chrono::steady_clock::duration& maxValue)
+    {
+        if (0 == count)
+        {
+            return std::chrono::steady_clock::duration::zero();
+        }
+        const uint64_t rank = (count * pct + 99) / 100; /* 向上取整 */
+        uint64_t sum = 0;
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+        {
+            sum += buckets[i];
+            if (sum >= rank)
+            {
+                std::chrono::steady_clock::duration upper = std::chrono::microseconds(int64_t(1) << i);
+                return std::min(upper, maxValue);
+            }
+        }
+        return maxValue;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, LATENCY_BUCKET_COUNT> m_buckets; /* 各分桶样本数 */
+    std::atomic<std::chrono::steady_clock::rep> m_max; /* 最大耗时 */
+};
+
+struct DiagExecutor;
+struct DiagTask;
+
+/**
+ * @brief 任务耗时统计(按任务名称)
+ */
+struct DiagTaskStat
+{
+    DiagTaskStat(const std::string& name) : name(name) {}
+    const std::string name; /* 任务名称 */
+    LatencyHistogram queue; /* 排队耗时 */
+    LatencyHistogram run; /* 运行耗时 */
+};
+
+/**
+ * @brief 执行者分片(按任务地址分配任务列表, 按任务名称分配耗时统计)
+ */
+struct DiagShard
+{
+    /**
+     * @brief 把任务加入任务列表(需在分片锁内调用)
+     */
+    void link(DiagTask* diagTask);
+
+    /**
+     * @brief 把任务从任务列表中移除(需在分片锁内调用)
+     */
+    void unlink(DiagTask* diagTask);
+
+    std::mutex mutex;
+    DiagTask* taskHead = nullptr; /* 任务列表(侵入式双向链表, 增删无需分配内存) */
+    std::unordered_map<std::string, std::unique_ptr<DiagTaskStat>> statList; /* 耗时统计列表 */
+    std::unique_ptr<DiagTaskStat> otherStat; /* 超出统计数量的任务耗时统计 */
+};
+
 /**
- * @brief 任务诊断信息
+ * @brief 任务诊断信息(由任务对象持有, 状态变更时无需查找)
  */
 struct DiagTask
 {
-    DiagTask(const Task* task) : task(task) {}
-    const Task* task;
+    ~DiagTask();
+
+    std::shared_ptr<DiagExecutor> executor; /* 所在执行者(线程池) */
+    DiagShard* shard = nullptr; /* 所在分片 */
+    DiagTaskStat* stat = nullptr; /* 所属的耗时统计 */
+    std::string taskName; /* 任务名称(仅当统计项为`OTHER_TASK_NAME`时记录) */
+    /* 以下字段由所在分片的互斥锁保护 */
+    bool listed = false; /* 是否在任务列表中 */
+    DiagTask* prev = nullptr;
+    DiagTask* next = nullptr;
+    DiagnoseState state = DiagnoseState::created; /* 状态 */
     std::chrono::steady_clock::time_point queuing{}; /* 开始排队时间点 */
     std::chrono::steady_clock::time_point running{}; /* 开始运行时间点 */
     std::chrono::steady_clock::time_point finished{}; /* 运行结束时间点 */
     std::chrono::steady_clock::time_point abnormal{}; /* 出现异常时间点 */
-    std::string executorName; /* 所在执行者(线程池)名称 */
     int64_t threadId = 0; /* 所在线程id */
     std::string threadName; /* 所在线程名称 */
     std::string exceptionMsg; /* 异常消息 */
 };
 
+void DiagShard::link(DiagTask* diagTask)
+{
+    diagTask->prev = nullptr;
+    diagTask->next = taskHead;
+    if (taskHead)
+    {
+        taskHead->prev = diagTask;
+    }
+    taskHead = diagTask;
+    diagTask->listed = true;
+}
+
+void DiagShard::unlink(DiagTask* diagTask)
+{
+    if (diagTask->prev)
+    {
+        diagTask->prev->next = diagTask->next;
+    }
+    else
+    {
+        taskHead = diagTask->next;
+    }
+    if (diagTask->next)
+    {
+        diagTask->next->prev = diagTask->prev;
+    }
+    diagTask->prev = nullptr;
+    diagTask->next = nullptr;
+    diagTask->listed = false;
+}
+
 /**
  * @brief 执行者(线程池)诊断信息
  */
 struct DiagExecutor
 {
-    DiagExecutor(const Executor* executor) : executor(executor) {}
-    const Executor* executor;
-    std::unordered_map<const Task*, std::shared_ptr<DiagTask>> taskList; /* 任务列表 */
+    DiagExecutor(const std::string& name) : name(name) {}
+
+    DiagShard& getTaskShard(const Task* task)
+    {
+        return shards[(std::hash<const Task*>()(task) >> 4) % SHARD_COUNT];
+    }
+
+    DiagTaskStat* getStat(const std::string& taskName)
+    {
+        auto& shard = shards[std::hash<std::string>()(taskName) % SHARD_COUNT];
+        std::lock_guard<std::mutex> locker(shard.mutex);
+        auto iter = shard.statList.find(taskName);
+        if (shard.statList.end() != iter)
+        {
+            return iter->second.get();
+        }
+        if (shard.statList.size() < MAX_TASK_STAT_COUNT_PER_SHARD)
+        {
+            auto stat = std::make_unique<DiagTaskStat>(taskName);
+            auto ptr = stat.get();
+            shard.statList.insert(std::make_pair(taskName, std::move(stat)));
+            return ptr;
+        }
+        if (!shard.otherStat)
+        {
+            shard.otherStat = std::make_unique<DiagTaskStat>(OTHER_TASK_NAME);
+        }
+        return shard.otherStat.get();
+    }
+
+    const std::string name; /* 执行者(线程池)名称 */
+    std::atomic<size_t> taskCount = {0}; /* 任务列表中的任务数 */
+    std::array<DiagShard, SHARD_COUNT> shards; /* 分片 */
+    LatencyHistogram queue; /* 排队耗时 */
+    LatencyHistogram run; /* 运行耗时 */
 };
 
+DiagTask::~DiagTask()
+{
+    if (shard) /* 任务未结束就被销毁(例如执行者停止时丢弃排队中的任务) */
+    {
+        std::lock_guard<std::mutex> locker(shard->mutex);
+        if (listed)
+        {
+            shard->unlink(this);
+            --executor->taskCount;
+        }
+    }
+}
+
 static std::atomic_bool s_enabled = {false}; /* 是否开启诊断功能(默认关闭) */
-static std::mutex s_mutexTask;
-static std::unordered_map<const Executor*, std::unique_ptr<DiagExecutor>> s_executorList; /* 执行者(线程池)列表 */
+static std::mutex s_mutexExecutor;
+static std::unordered_map<const Executor*, std::shared_ptr<DiagExecutor>> s_executorList; /* 执行者(线程池)列表 */
+static std::mutex s_mutexCallback;
+static std::atomic_bool s_hasCallback = {false}; /* 是否设置了回调(未设置时状态变更无需加锁读取回调) */
 static TaskCreatedCallback s_taskCreatedCallback = nullptr; /* 任务创建回调 */
 static TaskNormalStateCallback s_taskRunningStateCallback = nullptr; /* 任务运行状态回调 */
 static TaskNormalStateCallback s_taskFinishedStateCallback = nullptr; /* 任务结束状态回调 */
 static TaskExceptionStateCallback s_taskExceptionStateCallback = nullptr; /* 任务异常状态回调 */
 
-static std::shared_ptr<DiagTask> getDiagTask(const Task* task)
+static void updateHasCallback()
 {
-    if (!task)
-    {
-        return {};
-    }
-    for (const auto& iter : s_executorList)
-    {
-        auto taskIter = iter.second->taskList.find(task);
-        if (iter.second->taskList.end() != taskIter)
-        {
-            return taskIter->second;
-        }
-    }
-    return {};
+    s_hasCallback = s_taskCreatedCallback || s_taskRunningStateCallback || s_taskFinishedStateCallback || s_taskExceptionStateCallback;
 }
 
-static void delDiagTask(const Task* task)
+static std::vector<std::shared_ptr<DiagExecutor>> getDiagExecutorList()
 {
-    if (!task)
-    {
-        return;
-    }
+    std::vector<std::shared_ptr<DiagExecutor>> executorList;
+    std::lock_guard<std::mutex> locker(s_mutexExecutor);
+    executorList.reserve(s_executorList.size());
     for (const auto& iter : s_executorList)
     {
-        auto taskIter = iter.second->taskList.find(task);
-        if (iter.second->taskList.end() != taskIter)
-        {
-            iter.second->taskList.erase(taskIter);
-            return;
-        }
+        executorList.emplace_back(iter.second);
     }
+    return executorList;
+}
+
+/**
+ * @brief 把任务从所在分片的任务列表中移除(需在分片锁内调用)
+ */
+static void unlistDiagTask(DiagTask* diagTask)
+{
+    diagTask->shard->unlink(diagTask);
+    --diagTask->executor->taskCount;
 }
 
 void Diagnose::setTaskCreatedCallback(const TaskCreatedCallback& createdCb)
 {
-    std::lock_guard<std::mutex> locker(s_mutexTask);
+    std::lock_guard<std::mutex> locker(s_mutexCallback);
     s_taskCreatedCallback = createdCb;
+    updateHasCallback();
 }
 
 void Diagnose::setTaskRunningStateCallback(const TaskNormalStateCallback& stateCb)
 {
-    std::lock_guard<std::mutex> locker(s_mutexTask);
+    std::lock_guard<std::mutex> locker(s_mutexCallback);
     s_taskRunningStateCallback = stateCb;
+    updateHasCallback();
 }
 
 void Diagnose::setTaskFinishedStateCallback(const TaskNormalStateCallback& stateCb)
 {
-    std::lock_guard<std::mutex> locker(s_mutexTask);
+    std::lock_guard<std::mutex> locker(s_mutexCallback);
     s_taskFinishedStateCallback = stateCb;
+    updateHasCallback();
 }
 
 void Diagnose::setTaskExceptionStateCallback(const TaskExceptionStateCallback& stateCb)
 {
-    std::lock_guard<std::mutex> locker(s_mutexTask);
+    std::lock_guard<std::mutex> locker(s_mutexCallback);
     s_taskExceptionStateCallback = stateCb;
+    updateHasCallback();
 }
 
 void Diagnose::setEnable(bool enable)
@@ -110,126 +312,193 @@ void Diagnose::setEnable(bool enable)
 std::vector<ExecutorDiagnoseInfo> Diagnose::getTaskDiagnoseInfo()
 {
     std::vector<ExecutorDiagnoseInfo> infoList;
-    std::lock_guard<std::mutex> locker(s_mutexTask);
-    for (auto iter = s_executorList.begin(); s_executorList.end() != iter; ++iter)
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto& diagExecutor : getDiagExecutorList())
     {
         ExecutorDiagnoseInfo edi;
-        edi.name = iter->second->executor->getName();
-        for (auto taskIter = iter->second->taskList.begin(); iter->second->taskList.end() != taskIter; ++taskIter)
+        edi.name = diagExecutor->name;
+        for (auto& shard : diagExecutor->shards)
         {
-            TaskDiagnoseInfo info;
-            info.taskName = taskIter->second->task->getName();
-            info.threadId = taskIter->second->threadId;
-            info.threadName = taskIter->second->threadName;
-            switch (taskIter->second->task->getState())
+            std::lock_guard<std::mutex> locker(shard.mutex);
+            for (auto diagTask = shard.taskHead; diagTask; diagTask = diagTask->next)
             {
-            case Task::State::created:
-                info.state = DiagnoseState::created;
-                info.queue = std::chrono::steady_clock::duration::zero();
-                info.run = std::chrono::steady_clock::duration::zero();
-                break;
-            case Task::State::queuing:
-                info.state = DiagnoseState::queuing;
-                info.queue = std::chrono::steady_clock::now() - taskIter->second->queuing;
-                info.run = std::chrono::steady_clock::duration::zero();
-                break;
-            case Task::State::running:
-                info.state = DiagnoseState::running;
-                info.queue = taskIter->second->running - taskIter->second->queuing;
-                info.run = std::chrono::steady_clock::now() - taskIter->second->running;
-                break;
-            case Task::State::finished:
-                info.state = DiagnoseState::finished;
-                std::chrono::steady_clock::time_point zero{};
-                if (taskIter->second->finished > zero)
-                {
-                    info.run = taskIter->second->finished - taskIter->second->running;
-                }
-                else if (taskIter->second->abnormal > zero)
-                {
-                    info.run = taskIter->second->abnormal - taskIter->second->running;
-                }
-                else
+                TaskDiagnoseInfo info;
+                info.taskName = diagTask->taskName.empty() ? diagTask->stat->name : diagTask->taskName;
+                info.threadId = diagTask->threadId;
+                info.threadName = diagTask->threadName;
+                info.state = diagTask->state;
+                switch (diagTask->state)
                 {
-                    info.run = std::chrono::steady_clock::now() - taskIter->second->running;
+                case DiagnoseState::created:
+                    info.queue = std::chrono::steady_clock::duration::zero();
+                    info.run = std::chrono::steady_clock::duration::zero();
+                    break;
+                case DiagnoseState::queuing:
+                    info.queue = now - diagTask->queuing;
+                    info.run = std::chrono::steady_clock::duration::zero();
+                    break;
+                case DiagnoseState::running:
+                    info.queue = diagTask->running - diagTask->queuing;
+                    info.run = now - diagTask->running;
+                    break;
+                case DiagnoseState::finished:
+                    info.queue = diagTask->running - diagTask->queuing;
+                    info.run = now - diagTask->running;
+                    break;
                 }
-                break;
+                info.exceptionMsg = diagTask->exceptionMsg;
+                edi.taskInfoList.emplace_back(info);
             }
-            info.exceptionMsg = taskIter->second->exceptionMsg;
-            edi.taskInfoList.emplace_back(info);
         }
         infoList.emplace_back(edi);
     }
     return infoList;
 }
 
-void Diagnose::onExecutorCreated(const Executor* executor)
+std::vector<ExecutorLatencyInfo> Diagnose::getLatencyInfo()
+{
+    std::vector<ExecutorLatencyInfo> infoList;
+    for (const auto& diagExecutor : getDiagExecutorList())
+    {
+        ExecutorLatencyInfo eli;
+        eli.name = diagExecutor->name;
+        eli.queue = diagExecutor->queue.snapshot();
+        eli.run = diagExecutor->run.snapshot();
+        for (auto& shard : diagExecutor->shards)
+        {
+            std::lock_guard<std::mutex> locker(shard.mutex);
+            for (const auto& iter : shard.statList)
+            {
+                TaskLatencyInfo info;
+                info.taskName = iter.second->name;
+                info.queue = iter.second->queue.snapshot();
+                info.run = iter.second->run.snapshot();
+                eli.taskInfoList.emplace_back(info);
+            }
+            if (shard.otherStat)
+            {
+                TaskLatencyInfo info;
+                info.taskName = shard.otherStat->name;
+                info.queue = shard.otherStat->queue.snapshot();
+                info.run = shard.otherStat->run.snapshot();
+                eli.taskInfoList.emplace_back(info);
+            }
+        }
+        infoList.emplace_back(eli);
+    }
+    return infoList;
+}
+
+void Diagnose::resetLatencyInfo()
+{
+    for (const auto& diagExecutor : getDiagExecutorList())
+    {
+        diagExecutor->queue.reset();
+        diagExecutor->run.reset();
+        for (auto& shard : diagExecutor->shards)
+        {
+            std::lock_guard<std::mutex> locker(shard.mutex);
+            for (const auto& iter : shard.statList)
+            {
+                iter.second->queue.reset();
+                iter.second->run.reset();
+            }
+            if (shard.otherStat)
+            {
+                shard.otherStat->queue.reset();
+                shard.otherStat->run.reset();
+            }
+        }
+    }
+}
+
+void Diagnose::onExecutorCreated(Executor* executor)
 {
     if (!executor)
     {
         return;
     }
-    std::lock_guard<std::mutex> locker(s_mutexTask);
+    std::lock_guard<std::mutex> locker(s_mutexExecutor);
     if (s_executorList.end() == s_executorList.find(executor))
     {
-        auto executorInfo = std::make_unique<DiagExecutor>(executor);
-        s_executorList.insert(std::make_pair(executor, std::move(executorInfo)));
+        executor->m_diagExecutor = std::make_shared<DiagExecutor>(executor->getName());
+        s_executorList.insert(std::make_pair(executor, executor->m_diagExecutor));
     }
 }
 
-void Diagnose::onExecutorDestroyed(const Executor* executor)
+void Diagnose::onExecutorDestroyed(Executor* executor)
 {
     if (!executor)
     {
         return;
     }
-    std::lock_guard<std::mutex> locker(s_mutexTask);
-    const auto iter = s_executorList.find(executor);
-    if (s_executorList.end() != iter)
+    std::shared_ptr<DiagExecutor> diagExecutor;
     {
-        iter->second->taskList.clear();
+        std::lock_guard<std::mutex> locker(s_mutexExecutor);
+        const auto iter = s_executorList.find(executor);
+        if (s_executorList.end() == iter)
+        {
+            return;
+        }
+        diagExecutor = iter->second;
         s_executorList.erase(iter);
     }
+    for (auto& shard : diagExecutor->shards) /* 解除任务和执行者之间的相互引用 */
+    {
+        std::lock_guard<std::mutex> locker(shard.mutex);
+        while (shard.taskHead)
+        {
+            shard.unlink(shard.taskHead);
+        }
+    }
 }
 
-void Diagnose::onTaskCreated(const Executor* executor, const Task* task)
+void Diagnose::onTaskCreated(const Executor* executor, Task* task)
 {
     if (!s_enabled)
     {
         return;
     }
-    if (!executor || !task)
+    if (!executor || !task || !executor->m_diagExecutor)
     {
         return;
     }
-    TaskCreatedCallback createdCallback;
-    std::string executorName;
-    size_t maxCount, nowCount;
-    std::string taskName;
+    const auto& diagExecutor = executor->m_diagExecutor;
+    if (task->m_diagTask) /* 任务被重复投递 */
     {
-        std::lock_guard<std::mutex> locker(s_mutexTask);
-        const auto iter = s_executorList.find(executor);
-        if (s_executorList.end() == iter)
+        std::lock_guard<std::mutex> locker(task->m_diagTask->shard->mutex);
+        if (task->m_diagTask->listed)
         {
             return;
         }
-        if (iter->second->taskList.end() != iter->second->taskList.find(task))
-        {
-            return;
-        }
-        executorName = executor->getName();
-        maxCount = executor->getMaxCount();
-        nowCount = iter->second->taskList.size();
-        taskName = task->getName();
-        auto diagTask = std::make_shared<DiagTask>(task);
-        diagTask->executorName = executor->getName();
-        diagTask->queuing = std::chrono::steady_clock::now();
-        iter->second->taskList.insert(std::make_pair(task, diagTask));
-        createdCallback = s_taskCreatedCallback;
     }
-    if (createdCallback)
+    auto diagTask = std::make_shared<DiagTask>();
+    diagTask->executor = diagExecutor;
+    diagTask->shard = &diagExecutor->getTaskShard(task);
+    diagTask->stat = diagExecutor->getStat(task->getName());
+    if (OTHER_TASK_NAME == diagTask->stat->name)
+    {
+        diagTask->taskName = task->getName();
+    }
+    diagTask->state = DiagnoseState::queuing;
+    diagTask->queuing = std::chrono::steady_clock::now();
+    task->m_diagTask = diagTask;
+    size_t nowCount = diagExecutor->taskCount++;
+    {
+        std::lock_guard<std::mutex> locker(diagTask->shard->mutex);
+        diagTask->shard->link(diagTask.get());
+    }
+    if (s_hasCallback)
     {
-        createdCallback(executorName, maxCount, nowCount, taskName);
+        TaskCreatedCallback createdCallback;
+        {
+            std::lock_guard<std::mutex> locker(s_mutexCallback);
+            createdCallback = s_taskCreatedCallback;
+        }
+        if (createdCallback)
+        {
+            createdCallback(diagExecutor->name, executor->getMaxCount(), nowCount, task->getName());
+        }
     }
 }
 
@@ -239,28 +508,41 @@ void Diagnose::onTaskRunning(int threadId, const std::string& threadName, const
     {
         return;
     }
-    TaskNormalStateCallback runningCallback;
-    std::string executorName;
-    std::string taskName;
-    std::chrono::steady_clock::duration prevElapsed;
+    if (!task)
+    {
+        return;
+    }
+    const auto diagTask = task->m_diagTask; /* 复制(任务可能在其他线程被重复投递而重新设置) */
+    if (!diagTask)
+    {
+        return;
+    }
+    const auto running = std::chrono::steady_clock::now();
+    const auto prevElapsed = running - diagTask->queuing;
+    diagTask->executor->queue.record(prevElapsed);
+    diagTask->stat->queue.record(prevElapsed);
     {
-        std::lock_guard<std::mutex> locker(s_mutexTask);
-        auto diagTask = getDiagTask(task);
-        if (!diagTask)
+        std::lock_guard<std::mutex> locker(diagTask->shard->mutex);
+        if (!diagTask->listed)
         {
             return;
         }
-        diagTask->running = std::chrono::steady_clock::now();
+        diagTask->state = DiagnoseState::running;
+        diagTask->running = running;
         diagTask->threadId = threadId;
         diagTask->threadName = threadName;
-        runningCallback = s_taskRunningStateCallback;
-        executorName = diagTask->executorName;
-        taskName = task->getName();
-        prevElapsed = diagTask->running - diagTask->queuing;
     }
-    if (runningCallback)
+    if (s_hasCallback)
     {
-        runningCallback(executorName, threadId, threadName, taskName, prevElapsed);
+        TaskNormalStateCallback runningCallback;
+        {
+            std::lock_guard<std::mutex> locker(s_mutexCallback);
+            runningCallback = s_taskRunningStateCallback;
+        }
+        if (runningCallback)
+        {
+            runningCallback(diagTask->executor->name, threadId, threadName, task->getName(), prevElapsed);
+        }
     }
 }
 
@@ -270,29 +552,47 @@ void Diagnose::onTaskFinished(int threadId, const std::string& threadName, const
     {
         return;
     }
-    TaskNormalStateCallback finishedCallback;
-    std::string executorName;
-    std::string taskName;
+    if (!task)
+    {
+        return;
+    }
+    const auto diagTask = task->m_diagTask; /* 复制(任务可能在其他线程被重复投递而重新设置) */
+    if (!diagTask)
+    {
+        return;
+    }
+    const auto finished = std::chrono::steady_clock::now();
     std::chrono::steady_clock::duration prevElapsed;
     {
-        std::lock_guard<std::mutex> locker(s_mutexTask);
-        auto diagTask = getDiagTask(task);
-        if (!diagTask)
+        std::lock_guard<std::mutex> locker(diagTask->shard->mutex);
+        if (!diagTask->listed)
         {
             return;
         }
-        diagTask->finished = std::chrono::steady_clock::now();
+        if (DiagnoseState::running != diagTask->state) /* 任务被取消, 未运行 */
+        {
+            diagTask->running = finished;
+        }
+        diagTask->state = DiagnoseState::finished;
+        diagTask->finished = finished;
         diagTask->threadId = threadId;
         diagTask->threadName = threadName;
-        finishedCallback = s_taskFinishedStateCallback;
-        executorName = diagTask->executorName;
-        taskName = task->getName();
         prevElapsed = diagTask->finished - diagTask->running;
-        delDiagTask(task);
+        unlistDiagTask(diagTask.get());
     }
-    if (finishedCallback)
+    diagTask->executor->run.record(prevElapsed);
+    diagTask->stat->run.record(prevElapsed);
+    if (s_hasCallback)
     {
-        finishedCallback(executorName, threadId, threadName, taskName, prevElapsed);
+        TaskNormalStateCallback finishedCallback;
+        {
+            std::lock_guard<std::mutex> locker(s_mutexCallback);
+            finishedCallback = s_taskFinishedStateCallback;
+        }
+        if (finishedCallback)
+        {
+            finishedCallback(diagTask->executor->name, threadId, threadName, task->getName(), prevElapsed);
+        }
     }
 }
 
@@ -302,13 +602,18 @@ void Diagnose::onTaskException(int threadId, const std::string& threadName, cons
     {
         return;
     }
-    TaskExceptionStateCallback exceptionCallback;
-    std::string executorName;
-    std::string taskName;
+    if (!task)
+    {
+        return;
+    }
+    const auto diagTask = task->m_diagTask; /* 复制(任务可能在其他线程被重复投递而重新设置) */
+    if (!diagTask)
     {
-        std::lock_guard<std::mutex> locker(s_mutexTask);
-        auto diagTask = getDiagTask(task);
-        if (!diagTask)
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> locker(diagTask->shard->mutex);
+        if (!diagTask->listed)
         {
             return;
         }
@@ -316,14 +621,19 @@ void Diagnose::onTaskException(int threadId, const std::string& threadName, cons
         diagTask->threadId = threadId;
         diagTask->threadName = threadName;
         diagTask->exceptionMsg = msg;
-        exceptionCallback = s_taskExceptionStateCallback;
-        executorName = diagTask->executorName;
-        taskName = task->getName();
-        delDiagTask(task);
+        unlistDiagTask(diagTask.get());
     }
-    if (exceptionCallback)
+    if (s_hasCallback)
     {
-        exceptionCallback(executorName, threadId, threadName, taskName, msg);
+        TaskExceptionStateCallback exceptionCallback;
+        {
+            std::lock_guard<std::mutex> locker(s_mutexCallback);
+            exceptionCallback = s_taskExceptionStateCallback;
+        }
+        if (exceptionCallback)
+        {
+            exceptionCallback(diagTask->executor->name, threadId, threadName, task->getName(), msg);
+        }
     }
 }
 } // namespace threading
@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <vector>
@@ -11,6 +12,7 @@ class Executor;
 class FiberExecutor;
 class Task;
 class ThreadProxy;
+class WorkStealingExecutor;
 
 /**
  * @brief 诊断状态
@@ -46,6 +48,38 @@ struct ExecutorDiagnoseInfo
     std::vector<TaskDiagnoseInfo> taskInfoList; /* 任务信息列表 */
 };
 
+/**
+ * @brief 耗时统计信息(基于固定分桶直方图, 分位值为样本所在分桶的上界, 运行耗时只统计正常结束的任务)
+ */
+struct LatencyStatInfo
+{
+    uint64_t count = 0; /* 样本数 */
+    std::chrono::steady_clock::duration p50{}; /* 50分位耗时 */
+    std::chrono::steady_clock::duration p99{}; /* 99分位耗时 */
+    std::chrono::steady_clock::duration max{}; /* 最大耗时 */
+};
+
+/**
+ * @brief 任务耗时统计信息(按任务名称聚合)
+ */
+struct TaskLatencyInfo
+{
+    std::string taskName; /* 任务名称 */
+    LatencyStatInfo queue; /* 排队耗时 */
+    LatencyStatInfo run; /* 运行耗时 */
+};
+
+/**
+ * @brief 执行者(线程池)耗时统计信息
+ */
+struct ExecutorLatencyInfo
+{
+    std::string name; /* 执行者(线程池)名称 */
+    LatencyStatInfo queue; /* 排队耗时 */
+    LatencyStatInfo run; /* 运行耗时 */
+    std::vector<TaskLatencyInfo> taskInfoList; /* 任务耗时统计列表 */
+};
+
 /**
  * @brief 任务创建回调
  * @param executorName 执行者名称
@@ -86,6 +120,7 @@ class Diagnose final
     friend AsioExecutor;
     friend FiberExecutor;
     friend ThreadProxy;
+    friend WorkStealingExecutor;
 
 public:
     /**
@@ -124,25 +159,36 @@ public:
      */
     static std::vector<ExecutorDiagnoseInfo> getTaskDiagnoseInfo();
 
+    /**
+     * @brief 获取耗时统计信息(开销很小, 可常驻开启后定期采集)
+     * @return 耗时统计信息列表
+     */
+    static std::vector<ExecutorLatencyInfo> getLatencyInfo();
+
+    /**
+     * @brief 清空耗时统计信息(例如每个采集周期结束后清空)
+     */
+    static void resetLatencyInfo();
+
 protected:
     /**
      * @brief 响应执行者被创建(模块内部接口)
      * @param executor 执行者
      */
-    static void onExecutorCreated(const Executor* executor);
+    static void onExecutorCreated(Executor* executor);
 
     /**
      * @brief 响应执行者被销毁(模块内部接口)
      * @param executor 执行者
      */
-    static void onExecutorDestroyed(const Executor* executor);
+    static void onExecutorDestroyed(Executor* executor);
 
     /**
      * @brief 响应任务创建(模块内部接口)
      * @param executor 执行者
      * @param task 任务
      */
-    static void onTaskCreated(const Executor* executor, const Task* task);
+    static void onTaskCreated(const Executor* executor, Task* task);
 
     /**
      * @brief 响应任务开始运行(模块内部接口)
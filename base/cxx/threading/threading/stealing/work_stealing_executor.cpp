@@ -0,0 +1,217 @@
+#include "work_stealing_executor.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "../diagnose/diagnose.h"
+#include "../platform.h"
+
+namespace threading
+{
+/**
+ * @brief 当前线程所属的执行者和工作线程索引(在线程入口函数中设置)
+ */
+struct StealingWorkerInfo
+{
+    const void* state = nullptr; /* 所属执行者的共享状态 */
+    size_t index = 0; /* 工作线程索引 */
+};
+
+static thread_local StealingWorkerInfo s_workerInfo;
+
+const size_t WorkStealingExecutor::MAX_THREAD_COUNT;
+
+WorkStealingExecutor::WorkStealingExecutor(const std::string& name, size_t threadCount)
+    : Executor(name, std::min(std::max<size_t>(1U, threadCount), MAX_THREAD_COUNT)), m_state(std::make_shared<State>())
+{
+    Diagnose::onExecutorCreated(this);
+    m_state->workers.reserve(MAX_THREAD_COUNT);
+    createWorkers(getMaxCount(), getMaxCount());
+}
+
+WorkStealingExecutor::~WorkStealingExecutor()
+{
+    join();
+    Diagnose::onExecutorDestroyed(this);
+}
+
+size_t WorkStealingExecutor::getBusyCount()
+{
+    return m_state->busyCount;
+}
+
+void WorkStealingExecutor::join()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_state->mutexSleep);
+        m_state->stopped = true;
+        m_state->cvSleep.notify_all();
+    }
+    std::lock_guard<std::mutex> locker(m_state->mutexWorkers);
+    for (const auto& worker : m_state->workers)
+    {
+        if (!worker->thread.joinable())
+        {
+            continue;
+        }
+        if (std::this_thread::get_id() == worker->thread.get_id()) /* 在工作线程内调用时无法等待自身退出, 线程持有共享状态直到退出 */
+        {
+            worker->thread.detach();
+        }
+        else
+        {
+            worker->thread.join();
+        }
+    }
+}
+
+TaskPtr WorkStealingExecutor::post(const TaskPtr& task, bool wait)
+{
+    if (m_state->busyCount >= getMaxCount() && !wait) /* 队列已满且不等待, 则丢弃该任务 */
+    {
+        task->setState(Task::State::discard);
+        return task;
+    }
+    const auto workerCount = m_state->workerCount.load();
+    if (m_state->stopped || 0 == workerCount)
+    {
+        return task;
+    }
+    task->setState(Task::State::queuing);
+    Diagnose::onTaskCreated(this, task.get());
+    /* 在本执行者的线程内投递时加入该线程的队列(局部性更好), 否则轮流加入各个线程的队列 */
+    size_t index = 0;
+    if (m_state.get() == s_workerInfo.state)
+    {
+        index = s_workerInfo.index;
+    }
+    else
+    {
+        index = m_postIndex.fetch_add(1, std::memory_order_relaxed) % workerCount;
+    }
+    auto worker = m_state->workers[index].get();
+    {
+        std::lock_guard<std::mutex> locker(worker->mutex);
+        worker->queue.emplace_back(task);
+        ++m_state->pendingCount;
+    }
+    if (m_state->sleepCount > 0) /* 有线程在休眠时才需要唤醒 */
+    {
+        std::lock_guard<std::mutex> locker(m_state->mutexSleep);
+        m_state->cvSleep.notify_one();
+    }
+    return task;
+}
+
+size_t WorkStealingExecutor::extend(size_t count)
+{
+    std::lock_guard<std::mutex> locker(m_state->mutexWorkers);
+    count = std::min(count, MAX_THREAD_COUNT - m_state->workers.size());
+    auto totalCount = Executor::extend(count);
+    createWorkers(count, totalCount);
+    return totalCount;
+}
+
+void WorkStealingExecutor::createWorkers(size_t count, size_t totalCount)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto worker = std::make_unique<Worker>();
+        worker->index = m_state->workers.size();
+        auto threadName = getName() + (totalCount > 1 ? "-" + std::to_string(worker->index + 1) : "");
+        auto ptr = worker.get();
+        m_state->workers.emplace_back(std::move(worker)); /* 已预留容量, 不会重新分配, 其他线程可按索引并发读取 */
+        ++m_state->workerCount;
+        auto state = m_state;
+        ptr->thread = std::thread([state, ptr, threadName] { threadFunc(state, ptr, threadName); });
+    }
+}
+
+void WorkStealingExecutor::threadFunc(const std::shared_ptr<State>& state, Worker* worker, const std::string& name)
+{
+    Platform::setThreadName(name);
+    s_workerInfo.state = state.get();
+    s_workerInfo.index = worker->index;
+    const auto threadId = Platform::getThreadId();
+    while (!state->stopped)
+    {
+        auto task = popLocal(*state, worker);
+        if (!task)
+        {
+            task = steal(*state, worker);
+        }
+        if (task)
+        {
+            runTask(*state, threadId, name, task);
+            continue;
+        }
+        /* 所有队列都为空, 进入休眠 */
+        std::unique_lock<std::mutex> locker(state->mutexSleep);
+        ++state->sleepCount;
+        state->cvSleep.wait(locker, [&] { return state->stopped || state->pendingCount > 0; });
+        --state->sleepCount;
+    }
+    s_workerInfo.state = nullptr;
+}
+
+TaskPtr WorkStealingExecutor::popLocal(State& state, Worker* worker)
+{
+    std::lock_guard<std::mutex> locker(worker->mutex);
+    if (worker->queue.empty())
+    {
+        return nullptr;
+    }
+    auto task = std::move(worker->queue.back());
+    worker->queue.pop_back();
+    --state.pendingCount;
+    return task;
+}
+
+TaskPtr WorkStealingExecutor::steal(State& state, Worker* worker)
+{
+    const auto workerCount = state.workerCount.load();
+    for (size_t i = 1; i < workerCount; ++i)
+    {
+        auto victim = state.workers[(worker->index + i) % workerCount].get();
+        std::unique_lock<std::mutex> locker(victim->mutex, std::try_to_lock); /* 对方正忙时跳过, 避免相互阻塞 */
+        if (!locker.owns_lock() || victim->queue.empty())
+        {
+            continue;
+        }
+        auto task = std::move(victim->queue.front());
+        victim->queue.pop_front();
+        --state.pendingCount;
+        return task;
+    }
+    if (state.pendingCount > 0) /* 有任务但窃取时对方正忙, 让出时间片后重试 */
+    {
+        std::this_thread::yield();
+    }
+    return nullptr;
+}
+
+void WorkStealingExecutor::runTask(State& state, int threadId, const std::string& threadName, const TaskPtr& task)
+{
+    ++state.busyCount;
+    try
+    {
+        if (!task->isCancelled())
+        {
+            task->setState(Task::State::running);
+            Diagnose::onTaskRunning(threadId, threadName, task.get());
+            task->run();
+        }
+        task->setState(Task::State::finished);
+        Diagnose::onTaskFinished(threadId, threadName, task.get());
+    }
+    catch (const std::exception& e)
+    {
+        Diagnose::onTaskException(threadId, threadName, task.get(), e.what());
+    }
+    catch (...)
+    {
+        Diagnose::onTaskException(threadId, threadName, task.get(), "unknown exception");
+    }
+    --state.busyCount;
+}
+} // namespace threading
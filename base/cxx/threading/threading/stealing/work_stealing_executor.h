@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../task/executor.h"
+
+namespace threading
+{
+/**
+ * @brief 工作窃取线程, 每个线程拥有独立的任务队列, 空闲时从其他线程的队列中窃取任务
+ *        注意: 如果线程内执行死循环, 当要杀死线程时需要先退出循环, 否则会阻塞调用线程
+ */
+class WorkStealingExecutor final : public Executor
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param name 线程名称(强烈建议设置唯一标识, 以方便后续诊断)
+     * @param threadCount 线程个数
+     */
+    WorkStealingExecutor(const std::string& name, size_t threadCount = 1);
+
+    virtual ~WorkStealingExecutor();
+
+    /**
+     * @brief 获取正在执行的线程数
+     * @return 正在执行的线程数
+     */
+    size_t getBusyCount() override;
+
+    /**
+     * @brief 等待退出
+     */
+    void join() override;
+
+    /**
+     * @brief 把异步任务加入队列(在本执行者的线程内调用时加入该线程的队列, 否则轮流加入各个线程的队列)
+     * @param task 异步任务
+     * @param wait 队列满时是否等待, true-等待, false-丢弃
+     * @return 异步任务(和入参一致)
+     */
+    TaskPtr post(const TaskPtr& task, bool wait = true) override;
+
+    /**
+     * @brief 扩展线程池(线程总数不超过`MAX_THREAD_COUNT`)
+     * @param count 线程数量
+     * @return 当前线程数
+     */
+    size_t extend(size_t count) override;
+
+    static const size_t MAX_THREAD_COUNT = 256; /* 最多线程数 */
+
+private:
+    /**
+     * @brief 工作线程
+     */
+    struct Worker
+    {
+        size_t index = 0; /* 线程索引 */
+        std::mutex mutex; /* for queue */
+        std::deque<TaskPtr> queue; /* 任务队列: 本线程从尾部取, 其他线程从头部窃取 */
+        std::thread thread;
+    };
+
+    /**
+     * @brief 共享状态(由执行者和工作线程共同持有, 在工作线程内析构执行者时, 该线程被分离, 退出前仍可安全访问)
+     */
+    struct State
+    {
+        std::mutex mutexWorkers; /* for workers创建和回收 */
+        std::vector<std::unique_ptr<Worker>> workers; /* 工作线程列表(预留容量, 扩展时不会重新分配) */
+        std::atomic<size_t> workerCount = {0}; /* 已启动的工作线程数 */
+        std::atomic<size_t> pendingCount = {0}; /* 排队中的任务数 */
+        std::atomic<size_t> sleepCount = {0}; /* 休眠中的线程数 */
+        std::mutex mutexSleep; /* for cvSleep */
+        std::condition_variable cvSleep;
+        std::atomic_bool stopped = {false}; /* 是否已停止 */
+        std::atomic_int busyCount = {0}; /* 正在执行的线程数 */
+    };
+
+    /**
+     * @brief 创建工作线程
+     * @param count 线程数量
+     * @param totalCount 线程总数(用于生成线程名称)
+     */
+    void createWorkers(size_t count, size_t totalCount);
+
+    /**
+     * @brief 工作线程入口函数
+     * @param state 共享状态
+     * @param worker 工作线程
+     * @param name 线程名称
+     */
+    static void threadFunc(const std::shared_ptr<State>& state, Worker* worker, const std::string& name);
+
+    /**
+     * @brief 从本线程队列尾部取出任务
+     * @param state 共享状态
+     * @param worker 工作线程
+     * @return 任务, 为空表示队列为空
+     */
+    static TaskPtr popLocal(State& state, Worker* worker);
+
+    /**
+     * @brief 从其他线程队列头部窃取任务
+     * @param state 共享状态
+     * @param worker 工作线程(发起窃取的线程)
+     * @return 任务, 为空表示未窃取到任务
+     */
+    static TaskPtr steal(State& state, Worker* worker);
+
+    /**
+     * @brief 执行任务
+     * @param state 共享状态
+     * @param threadId 线程id
+     * @param threadName 线程名称
+     * @param task 任务
+     */
+    static void runTask(State& state, int threadId, const std::string& threadName, const TaskPtr& task);
+
+private:
+    std::shared_ptr<State> m_state; /* 共享状态 */
+    std::atomic<size_t> m_postIndex = {0}; /* 外部线程投递时的轮询索引 */
+};
+} // namespace threading
@@ -6,7 +6,7 @@ namespace threading
 {
 Executor::Executor(const std::string& name, size_t maxCount) : m_name(name), m_maxCount(maxCount) {}
 
-std::string Executor::getName() const
+const std::string& Executor::getName() const
 {
     return m_name;
 }
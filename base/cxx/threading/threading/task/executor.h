@@ -8,6 +8,9 @@
 
 namespace threading
 {
+class Diagnose;
+struct DiagExecutor;
+
 /**
  * @brief 执行者基类
  */
@@ -27,7 +30,7 @@ public:
 	 * @brief 获取名称
 	 * @return 执行者名称
 	 */
-    std::string getName() const;
+    const std::string& getName() const;
 
     /**
      * @brief 获取允许同时执行的最多任务数
@@ -73,6 +76,9 @@ public:
 private:
     const std::string m_name; /* 执行者名称 */
     std::atomic<size_t> m_maxCount = {0}; /* 最多任务数 */
+
+    friend Diagnose;
+    std::shared_ptr<DiagExecutor> m_diagExecutor; /* 诊断信息(由诊断模块在执行者创建时设置) */
 };
 
 using ExecutorPtr = std::shared_ptr<Executor>;
@@ -4,7 +4,7 @@ namespace threading
 {
 Task::Task(const std::string& name) : m_name(name) {}
 
-std::string Task::getName() const
+const std::string& Task::getName() const
 {
     return m_name;
 }
@@ -20,6 +20,9 @@
 
 namespace threading
 {
+class Diagnose;
+struct DiagTask;
+
 /**
  * @brief 任务基类
  */
@@ -50,7 +53,7 @@ public:
 	 * @brief 获取名称
 	 * @return 任务名称
 	 */
-    std::string getName() const;
+    const std::string& getName() const;
 
     /**
 	 * @brief 获取执行状态
@@ -91,6 +94,9 @@ private:
     std::atomic_bool m_cancelled = {false}; /* 是否已取消 */
     std::mutex m_mutex; /* for m_cv */
     std::condition_variable m_cv;
+
+    friend Diagnose;
+    std::shared_ptr<DiagTask> m_diagTask; /* 诊断信息(由诊断模块在任务投递时设置) */
 };
 
 using TaskPtr = std::shared_ptr<Task>;
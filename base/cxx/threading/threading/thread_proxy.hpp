@@ -1,5 +1,6 @@
 #pragma once
 #include "asio/asio_executor.h"
+#include "stealing/work_stealing_executor.h"
 #if 1 == ENABLE_THREADING_FIBER
 #include "fiber/fiber_executor.h"
 #endif
@@ -30,6 +31,17 @@ public:
         return std::make_shared<AsioExecutor>(name, threadCount);
     }
 
+    /**
+     * @brief 创建工作窃取线程(每个线程拥有独立任务队列, 适合线程数较多或任务内再投递子任务的场景)
+     * @param name 线程名称(强烈建议设置唯一标识, 以方便后续诊断)
+     * @param threadCount 线程个数
+     * @param 线程执行者
+     */
+    static ExecutorPtr createWorkStealingExecutor(const std::string& name, size_t threadCount = 1)
+    {
+        return std::make_shared<WorkStealingExecutor>(name, threadCount);
+    }
+
     /**
      * @brief 同步接口
      * @param taskName 任务名称(强烈建议设置唯一标识, 以方便后续诊断)
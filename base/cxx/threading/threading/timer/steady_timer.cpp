@@ -6,7 +6,6 @@ SteadyTimer::SteadyTimer(const std::string& name, const std::chrono::steady_cloc
                          const std::chrono::steady_clock::duration& interval, const TimerTriggerFunc& func, const ExecutorPtr& executor)
     : Timer(name, func, executor), m_delay(delay), m_interval(interval)
 {
-    m_timer = std::make_shared<boost::asio::steady_timer>(getContext());
 }
 
 SteadyTimer::~SteadyTimer()
@@ -40,22 +39,7 @@ void SteadyTimer::start()
             }
             else
             {
-                const std::weak_ptr<SteadyTimer>& wpSelf = shared_from_this();
-                m_timer->expires_from_now(m_delay);
-                m_timer->async_wait([wpSelf](const boost::system::error_code& code) {
-                    const auto self = wpSelf.lock();
-                    if (self)
-                    {
-                        if (code) /* 说明: `cancel`后立即调用`async_wait`, `cancel`的回调可能会晚于`async_wait`执行 */
-                        {
-                            self->onRecover();
-                        }
-                        else
-                        {
-                            self->onTrigger();
-                        }
-                    }
-                });
+                arm(m_delay);
             }
         }
     }
@@ -71,7 +55,7 @@ void SteadyTimer::stop()
     if (m_started)
     {
         m_started = false;
-        m_timer->cancel();
+        TimerWheel::getInstance().remove(&m_node); /* 布防序号不变, 已被时间轮取出的到期也会被忽略(已停止) */
     }
 }
 
@@ -87,20 +71,13 @@ std::shared_ptr<SteadyTimer> SteadyTimer::loopTimer(const std::string& name, con
     return std::make_shared<threading::SteadyTimer>(name, std::chrono::steady_clock::duration::zero(), interval, func, executor);
 }
 
-void SteadyTimer::onRecover()
+void SteadyTimer::arm(const std::chrono::steady_clock::duration& delay)
 {
-    std::lock_guard<std::recursive_mutex> locker(m_mutex);
-    if (m_started)
+    if (m_node.owner.expired()) /* 首次布防时设置(节点未布防, 时间轮不会访问) */
     {
-        const std::weak_ptr<SteadyTimer> wpSelf = shared_from_this();
-        m_timer->async_wait([wpSelf](const boost::system::error_code& code) {
-            const auto self = wpSelf.lock();
-            if (self && !code)
-            {
-                self->onTrigger();
-            }
-        });
+        m_node.owner = shared_from_this();
     }
+    m_armId = TimerWheel::getInstance().add(&m_node, delay);
 }
 
 void SteadyTimer::onTrigger()
@@ -113,15 +90,7 @@ void SteadyTimer::onTrigger()
             m_started = (std::chrono::steady_clock::duration::zero() != m_interval);
             if (m_started) /* 继续 */
             {
-                const std::weak_ptr<SteadyTimer>& wpSelf = shared_from_this();
-                m_timer->expires_from_now(m_interval);
-                m_timer->async_wait([wpSelf](const boost::system::error_code& code) {
-                    const auto self = wpSelf.lock();
-                    if (self && !code)
-                    {
-                        self->onTrigger();
-                    }
-                });
+                arm(m_interval);
             }
             triggered = true;
         }
@@ -131,4 +100,36 @@ void SteadyTimer::onTrigger()
         onTriggerFunc(shared_from_this());
     }
 }
+
+bool SteadyTimer::onExpire(uint64_t armId)
+{
+    std::lock_guard<std::recursive_mutex> locker(m_mutex);
+    if (!m_started || armId != m_armId) /* 到期后被停止, 或被停止后重新启动 */
+    {
+        return false;
+    }
+    m_started = (std::chrono::steady_clock::duration::zero() != m_interval);
+    if (m_started) /* 继续 */
+    {
+        arm(m_interval);
+    }
+    return true;
+}
+
+void SteadyTimer::onWheelExpire(const std::vector<std::pair<std::shared_ptr<SteadyTimer>, uint64_t>>& expiredList)
+{
+    std::vector<std::shared_ptr<Timer>> timerList;
+    timerList.reserve(expiredList.size());
+    for (const auto& item : expiredList)
+    {
+        if (item.first->onExpire(item.second))
+        {
+            timerList.emplace_back(item.first);
+        }
+    }
+    if (!timerList.empty())
+    {
+        onTriggerFuncBatch(timerList);
+    }
+}
 } // namespace threading
@@ -1,12 +1,12 @@
 #pragma once
-#include <boost/asio/steady_timer.hpp>
-
 #include "timer.h"
+#include "timer_wheel.h"
 
 namespace threading
 {
 /**
  * @brief 稳定定时器, 可以保证以固定时间间隔触发, 不受系统时间影响
+ *        说明: 由全局时间轮驱动(布防/取消为O(1)), 触发精度为时间轮刻度(默认1毫秒, 可通过`TimerWheel::setResolution`设置)
  */
 class SteadyTimer final : public Timer, public std::enable_shared_from_this<SteadyTimer>
 {
@@ -70,19 +70,35 @@ public:
 
 private:
     /**
-     * @brief 触发恢复
+     * @brief 布防
+     * @param delay 延时
      */
-    void onRecover();
+    void arm(const std::chrono::steady_clock::duration& delay);
 
     /**
      * @brief 定时器触发
      */
     void onTrigger();
 
+    /**
+     * @brief 时间轮到期(在时间轮线程调用)
+     * @param armId 布防序号
+     * @return true-需要执行触发函数, false-已停止或已重新布防
+     */
+    bool onExpire(uint64_t armId);
+
+    /**
+     * @brief 时间轮批量到期(在时间轮线程调用), 需要触发的定时器按执行器批量投递
+     * @param expiredList 到期列表, 值-定时器和布防序号
+     */
+    static void onWheelExpire(const std::vector<std::pair<std::shared_ptr<SteadyTimer>, uint64_t>>& expiredList);
+
 private:
+    friend TimerWheel;
     std::chrono::steady_clock::duration m_delay; /* 首次触发延迟时间 */
     std::chrono::steady_clock::duration m_interval; /* 定时器间隔 */
-    std::shared_ptr<boost::asio::steady_timer> m_timer; /* boost稳定定时器 */
+    TimerWheelNode m_node; /* 时间轮节点 */
+    uint64_t m_armId = 0; /* 当前布防序号 */
 };
 
 using SteadyTimerPtr = std::shared_ptr<SteadyTimer>;
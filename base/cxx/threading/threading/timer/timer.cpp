@@ -1,5 +1,6 @@
 #include "timer.h"
 
+#include <algorithm>
 #include <thread>
 
 namespace threading
@@ -104,6 +105,32 @@ boost::asio::io_context& Timer::getContext()
     return (*s_context);
 }
 
+/**
+ * @brief 执行触发函数(定时器已释放时忽略)
+ */
+static void invokeTriggerFunc(const std::weak_ptr<Timer>& wpTimer, const TimerTriggerFunc& func, const TimerExecutorHook& hook,
+                              const std::chrono::steady_clock::time_point& ntp)
+{
+    const auto timer = wpTimer.lock();
+    if (timer && func)
+    {
+        if (hook)
+        {
+            hook(timer->getName(), [wpTimer, func, ntp] {
+                const auto timer = wpTimer.lock();
+                if (timer && func)
+                {
+                    func(ntp);
+                }
+            });
+        }
+        else
+        {
+            func(ntp);
+        }
+    }
+}
+
 void Timer::onTriggerFunc(const std::shared_ptr<Timer>& timer)
 {
     if (!m_func)
@@ -125,27 +152,64 @@ void Timer::onTriggerFunc(const std::shared_ptr<Timer>& timer)
     auto ntp = std::chrono::steady_clock::now();
     const std::weak_ptr<Timer> wpTimer = timer;
     executor->post(
-        getName(),
-        [wpTimer, func = m_func, hook, ntp]() {
-            const auto timer = wpTimer.lock();
-            if (timer && func)
-            {
-                if (hook)
-                {
-                    hook(timer->getName(), [wpTimer, func, ntp] {
-                        const auto timer = wpTimer.lock();
-                        if (timer && func)
-                        {
-                            func(ntp);
-                        }
-                    });
-                }
-                else
+        getName(), [wpTimer, func = m_func, hook, ntp]() { invokeTriggerFunc(wpTimer, func, hook, ntp); }, true);
+}
+
+void Timer::onTriggerFuncBatch(const std::vector<std::shared_ptr<Timer>>& timerList)
+{
+    ExecutorPtr defaultExecutor;
+    TimerExecutorHook defaultHook;
+    {
+        std::lock_guard<std::mutex> locker(s_mutexDefault);
+        defaultExecutor = s_defaultExecutor;
+        defaultHook = s_defaultExecutorHook;
+    }
+    /* 按执行器分组(执行器数量通常很少, 线性查找即可) */
+    std::vector<std::pair<ExecutorPtr, std::vector<std::shared_ptr<Timer>>>> groupList;
+    for (const auto& timer : timerList)
+    {
+        const auto& executor = timer->m_executor ? timer->m_executor : defaultExecutor;
+        if (!timer->m_func || !executor)
+        {
+            continue;
+        }
+        auto iter = std::find_if(groupList.begin(), groupList.end(), [&](const auto& group) { return group.first == executor; });
+        if (groupList.end() == iter)
+        {
+            groupList.emplace_back(executor, std::vector<std::shared_ptr<Timer>>());
+            iter = groupList.end() - 1;
+        }
+        iter->second.emplace_back(timer);
+    }
+    auto ntp = std::chrono::steady_clock::now();
+    for (const auto& group : groupList)
+    {
+        if (1 == group.second.size()) /* 只有一个时保持原有的任务名称(便于诊断) */
+        {
+            group.second[0]->onTriggerFunc(group.second[0]);
+            continue;
+        }
+        struct Item
+        {
+            std::weak_ptr<Timer> wpTimer;
+            TimerTriggerFunc func;
+            TimerExecutorHook hook;
+        };
+        auto itemList = std::make_shared<std::vector<Item>>();
+        itemList->reserve(group.second.size());
+        for (const auto& timer : group.second)
+        {
+            itemList->push_back({timer, timer->m_func, timer->m_executor ? nullptr : defaultHook});
+        }
+        group.first->post(
+            "timer::batch",
+            [itemList, ntp]() {
+                for (const auto& item : *itemList)
                 {
-                    func(ntp);
+                    invokeTriggerFunc(item.wpTimer, item.func, item.hook, ntp);
                 }
-            }
-        },
-        true);
+            },
+            true);
+    }
 }
 } // namespace threading
@@ -5,6 +5,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "../task/executor.h"
 
@@ -80,6 +81,12 @@ protected:
      */
     void onTriggerFunc(const std::shared_ptr<Timer>& timer);
 
+    /**
+     * @brief 批量响应触发函数(同一执行器的定时器合并为一个任务投递)
+     * @param timerList 定时器列表
+     */
+    static void onTriggerFuncBatch(const std::vector<std::shared_ptr<Timer>>& timerList);
+
 protected:
     std::recursive_mutex m_mutex;
     bool m_started = false; /* 是否已启动 */
@@ -0,0 +1,263 @@
+#include "timer_wheel.h"
+
+#include <thread>
+
+#include "../platform.h"
+#include "steady_timer.h"
+
+namespace threading
+{
+static std::mutex s_mutexResolution;
+static std::chrono::steady_clock::duration s_resolution = std::chrono::milliseconds(1); /* 刻度 */
+static bool s_created = false; /* 时间轮是否已创建 */
+
+/**
+ * @brief 把节点从链表中移除
+ */
+static inline void unlinkNode(TimerWheelNode* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+}
+
+/**
+ * @brief 把节点追加到链表尾部
+ */
+static inline void linkNode(TimerWheelNode* head, TimerWheelNode* node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+TimerWheel& TimerWheel::getInstance()
+{
+    static TimerWheel* s_wheel = [] {
+        auto wheel = new TimerWheel(); /* 不释放, 线程分离运行, 避免进程退出时访问已析构的对象 */
+        std::thread([wheel] {
+            Platform::setThreadName("thd::wheel");
+            wheel->run();
+        }).detach();
+        return wheel;
+    }();
+    return *s_wheel;
+}
+
+bool TimerWheel::setResolution(const std::chrono::steady_clock::duration& resolution)
+{
+    std::lock_guard<std::mutex> locker(s_mutexResolution);
+    if (s_created || resolution <= std::chrono::steady_clock::duration::zero())
+    {
+        return false;
+    }
+    s_resolution = resolution;
+    return true;
+}
+
+std::chrono::steady_clock::duration TimerWheel::getResolution()
+{
+    std::lock_guard<std::mutex> locker(s_mutexResolution);
+    return s_resolution;
+}
+
+TimerWheel::TimerWheel() : m_startTime(std::chrono::steady_clock::now()), m_resolution([] {
+    std::lock_guard<std::mutex> locker(s_mutexResolution);
+    s_created = true;
+    return s_resolution;
+}())
+{
+    for (auto& slot : m_root)
+    {
+        slot.head.prev = slot.head.next = &slot.head;
+    }
+    for (auto& level : m_levels)
+    {
+        for (auto& slot : level)
+        {
+            slot.head.prev = slot.head.next = &slot.head;
+        }
+    }
+}
+
+uint64_t TimerWheel::add(TimerWheelNode* node, const std::chrono::steady_clock::duration& delay)
+{
+    const auto expireTime = std::chrono::steady_clock::now() + delay;
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (node->prev)
+    {
+        unlinkNode(node);
+        --m_count;
+    }
+    node->expireTick = toTick(expireTime);
+    node->armId = m_nextArmId++;
+    place(node);
+    ++m_count;
+    if (node->expireTick < m_wakeTick) /* 比线程等待的时间更早, 需要唤醒线程 */
+    {
+        m_wakeTick = 0;
+        m_cv.notify_one();
+    }
+    return node->armId;
+}
+
+void TimerWheel::remove(TimerWheelNode* node)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (node->prev)
+    {
+        unlinkNode(node);
+        --m_count;
+    }
+}
+
+size_t TimerWheel::getCount()
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    return m_count;
+}
+
+uint64_t TimerWheel::toTick(const std::chrono::steady_clock::time_point& tp) const
+{
+    if (tp <= m_startTime)
+    {
+        return 0;
+    }
+    const auto elapsed = tp - m_startTime;
+    return (uint64_t)((elapsed + m_resolution - std::chrono::steady_clock::duration(1)) / m_resolution); /* 向上取整 */
+}
+
+void TimerWheel::place(TimerWheelNode* node)
+{
+    uint64_t expires = (node->expireTick < m_currTick) ? m_currTick : node->expireTick; /* 已到期的放到下一个待处理的刻度 */
+    uint64_t delta = expires - m_currTick;
+    if (delta < ROOT_SIZE)
+    {
+        linkNode(&m_root[expires & (ROOT_SIZE - 1)].head, node);
+        return;
+    }
+    const uint64_t maxDelta = (uint64_t(1) << (ROOT_BITS + (LEVEL_COUNT - 1) * LEVEL_BITS)) - 1;
+    if (delta > maxDelta) /* 超出范围, 先放到最高层, 降层时重新计算 */
+    {
+        expires = m_currTick + maxDelta;
+        delta = maxDelta;
+    }
+    int level = 1;
+    while (level < LEVEL_COUNT - 1 && delta >= (uint64_t(1) << (ROOT_BITS + level * LEVEL_BITS)))
+    {
+        ++level;
+    }
+    const uint32_t index = (uint32_t)(expires >> (ROOT_BITS + (level - 1) * LEVEL_BITS)) & (LEVEL_SIZE - 1);
+    linkNode(&m_levels[level - 1][index].head, node);
+}
+
+uint32_t TimerWheel::cascade(int level, uint32_t index)
+{
+    auto& head = m_levels[level - 1][index].head;
+    if (head.next != &head)
+    {
+        TimerWheelNode list; /* 先摘下整个链表, 避免重新分配时放回同一个槽 */
+        list.next = head.next;
+        list.prev = head.prev;
+        list.next->prev = &list;
+        list.prev->next = &list;
+        head.prev = head.next = &head;
+        while (list.next != &list)
+        {
+            auto node = list.next;
+            unlinkNode(node);
+            place(node);
+        }
+    }
+    return index;
+}
+
+void TimerWheel::processTick(std::vector<std::pair<std::shared_ptr<SteadyTimer>, uint64_t>>& expiredList)
+{
+    const uint32_t index = (uint32_t)(m_currTick & (ROOT_SIZE - 1));
+    if (0 == index) /* 第0层转完一圈, 依次把上层的槽降下来 */
+    {
+        for (int level = 1; level < LEVEL_COUNT; ++level)
+        {
+            if (0 != cascade(level, (uint32_t)(m_currTick >> (ROOT_BITS + (level - 1) * LEVEL_BITS)) & (LEVEL_SIZE - 1)))
+            {
+                break;
+            }
+        }
+    }
+    auto& head = m_root[index].head;
+    while (head.next != &head)
+    {
+        auto node = head.next;
+        unlinkNode(node);
+        --m_count;
+        auto owner = node->owner.lock(); /* 定时器正在析构时为空 */
+        if (owner)
+        {
+            expiredList.emplace_back(std::move(owner), node->armId);
+        }
+    }
+    ++m_currTick;
+}
+
+uint64_t TimerWheel::calcWakeTick() const
+{
+    if (0 == m_count)
+    {
+        return UINT64_MAX;
+    }
+    if (0 == (m_currTick & (ROOT_SIZE - 1))) /* 当前刻度需要先降层, 第0层此时可能为空 */
+    {
+        return m_currTick;
+    }
+    const uint64_t boundary = (m_currTick | (ROOT_SIZE - 1)) + 1; /* 下一次降层的刻度 */
+    for (uint64_t tick = m_currTick; tick < boundary; ++tick)
+    {
+        const auto& head = m_root[tick & (ROOT_SIZE - 1)].head;
+        if (head.next != &head)
+        {
+            return tick;
+        }
+    }
+    return boundary;
+}
+
+void TimerWheel::run()
+{
+    std::vector<std::pair<std::shared_ptr<SteadyTimer>, uint64_t>> expiredList;
+    std::unique_lock<std::mutex> locker(m_mutex);
+    while (true)
+    {
+        m_wakeTick = 0; /* 处理期间布防不需要唤醒 */
+        const uint64_t nowTick = (uint64_t)((std::chrono::steady_clock::now() - m_startTime) / m_resolution); /* 向下取整, 不会提前触发 */
+        while (m_currTick <= nowTick)
+        {
+            if (0 == m_count) /* 没有定时器, 直接跳到当前刻度 */
+            {
+                m_currTick = nowTick + 1;
+                break;
+            }
+            processTick(expiredList);
+        }
+        if (!expiredList.empty())
+        {
+            locker.unlock();
+            SteadyTimer::onWheelExpire(expiredList); /* 不加锁, 触发函数中可以重新布防 */
+            expiredList.clear();
+            locker.lock();
+            continue;
+        }
+        m_wakeTick = calcWakeTick();
+        if (UINT64_MAX == m_wakeTick)
+        {
+            m_cv.wait(locker);
+        }
+        else
+        {
+            m_cv.wait_until(locker, m_startTime + m_resolution * m_wakeTick);
+        }
+    }
+}
+} // namespace threading
@@ -0,0 +1,133 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace threading
+{
+class SteadyTimer;
+
+/**
+ * @brief 时间轮节点(侵入式双向链表节点, 由定时器持有, 布防/取消都是O(1))
+ */
+struct TimerWheelNode
+{
+    TimerWheelNode* prev = nullptr; /* 前一个节点 */
+    TimerWheelNode* next = nullptr; /* 后一个节点 */
+    uint64_t expireTick = 0; /* 到期刻度 */
+    uint64_t armId = 0; /* 布防序号(每次布防递增, 用于识别已过期的触发) */
+    std::weak_ptr<SteadyTimer> owner; /* 所属定时器 */
+};
+
+/**
+ * @brief 分层时间轮(全局一个, 由独立的线程驱动)
+ *        说明: 1.第0层256个槽, 第1~4层各64个槽, 覆盖2^32个刻度, 超出范围的定时器到达最高层后重新分配
+ *              2.线程只在有定时器到期或需要降层时唤醒, 空闲时不空转
+ *              3.同一刻度到期的定时器按执行器分组批量投递
+ */
+class TimerWheel final
+{
+public:
+    /**
+     * @brief 获取全局时间轮(首次调用时创建线程)
+     * @return 时间轮
+     */
+    static TimerWheel& getInstance();
+
+    /**
+     * @brief 设置刻度(精度), 需要在创建第一个稳定定时器之前设置
+     * @param resolution 刻度, 默认1毫秒
+     * @return true-成功, false-失败(时间轮已创建或参数无效)
+     */
+    static bool setResolution(const std::chrono::steady_clock::duration& resolution);
+
+    /**
+     * @brief 获取刻度
+     * @return 刻度
+     */
+    static std::chrono::steady_clock::duration getResolution();
+
+    /**
+     * @brief 布防(节点已布防时先取消)
+     * @param node 节点
+     * @param delay 延时(向上取整到刻度, 不会提前触发)
+     * @return 布防序号
+     */
+    uint64_t add(TimerWheelNode* node, const std::chrono::steady_clock::duration& delay);
+
+    /**
+     * @brief 取消(节点未布防时忽略)
+     * @param node 节点
+     */
+    void remove(TimerWheelNode* node);
+
+    /**
+     * @brief 获取已布防的定时器数量
+     * @return 数量
+     */
+    size_t getCount();
+
+private:
+    TimerWheel();
+
+    /**
+     * @brief 槽(带哨兵的双向循环链表)
+     */
+    struct Slot
+    {
+        TimerWheelNode head; /* 哨兵 */
+    };
+
+    /**
+     * @brief 根据时间计算刻度
+     */
+    uint64_t toTick(const std::chrono::steady_clock::time_point& tp) const;
+
+    /**
+     * @brief 把节点放入对应的槽(需要加锁)
+     */
+    void place(TimerWheelNode* node);
+
+    /**
+     * @brief 把高层的槽重新分配到低层(需要加锁)
+     * @return 槽索引
+     */
+    uint32_t cascade(int level, uint32_t index);
+
+    /**
+     * @brief 处理当前刻度, 到期的节点追加到列表(需要加锁)
+     */
+    void processTick(std::vector<std::pair<std::shared_ptr<SteadyTimer>, uint64_t>>& expiredList);
+
+    /**
+     * @brief 计算下次需要唤醒的刻度(需要加锁)
+     */
+    uint64_t calcWakeTick() const;
+
+    /**
+     * @brief 线程函数
+     */
+    void run();
+
+private:
+    static const int LEVEL_COUNT = 5; /* 层数 */
+    static const uint32_t ROOT_BITS = 8; /* 第0层槽数位数 */
+    static const uint32_t LEVEL_BITS = 6; /* 第1~4层槽数位数 */
+    static const uint32_t ROOT_SIZE = (1U << ROOT_BITS);
+    static const uint32_t LEVEL_SIZE = (1U << LEVEL_BITS);
+
+    const std::chrono::steady_clock::time_point m_startTime; /* 刻度0对应的时间 */
+    const std::chrono::steady_clock::duration m_resolution; /* 刻度 */
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    Slot m_root[ROOT_SIZE]; /* 第0层 */
+    Slot m_levels[LEVEL_COUNT - 1][LEVEL_SIZE]; /* 第1~4层 */
+    uint64_t m_currTick = 0; /* 当前(下一个待处理的)刻度 */
+    uint64_t m_wakeTick = UINT64_MAX; /* 线程等待到的刻度 */
+    uint64_t m_nextArmId = 1; /* 下一个布防序号 */
+    size_t m_count = 0; /* 已布防的数量 */
+};
+} // namespace threading
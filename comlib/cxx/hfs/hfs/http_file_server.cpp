@@ -1,6 +1,7 @@
 #include "http_file_server.h"
 
 #include <algorithm>
+#include <ctime>
 
 #include "utility/charset/charset.h"
 #include "utility/filesystem/file_info.h"
@@ -223,7 +224,7 @@ bool HttpFileServer::isRunning()
 }
 
 void HttpFileServer::defaultDirAccessHandler(uint64_t cid, const nsocket::http::REQUEST_PTR& req, const nsocket::http::Connector& conn,
-                                             bool keepAlive, const std::string& rootDir, const std::string& uri)
+                                             bool /*keepAlive*/, const std::string& rootDir, const std::string& uri)
 {
     /* 页面头部 */
     std::string str;
@@ -346,22 +347,237 @@ void HttpFileServer::defaultDirAccessHandler(uint64_t cid, const nsocket::http::
 #endif
     resp->body.insert(resp->body.end(), str.begin(), str.end());
     conn.send(resp->pack());
-    if (!keepAlive) /* 非保活才关闭连接 */
+    conn.close(); /* 结束响应(非保活时服务器会断开连接) */
+}
+
+/**
+ * @brief 格式化HTTP日期(RFC 7231), 例如: Sun, 06 Nov 1994 08:49:37 GMT
+ */
+static std::string formatHttpDate(time_t t)
+{
+    static const char* WEEKS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    struct tm gmt;
+#ifdef _WIN32
+    gmtime_s(&gmt, &t);
+#else
+    gmtime_r(&t, &gmt);
+#endif
+    char buf[64] = {0};
+    sprintf(buf, "%s, %02d %s %04d %02d:%02d:%02d GMT", WEEKS[gmt.tm_wday % 7], gmt.tm_mday, MONTHS[gmt.tm_mon % 12], gmt.tm_year + 1900,
+            gmt.tm_hour, gmt.tm_min, gmt.tm_sec);
+    return buf;
+}
+
+/**
+ * @brief 解析HTTP日期(RFC 7231), 兼容空格已被去除的值(请求解析时会去除头部字段值中的空格)
+ * @param str 日期字符串, 例如: Sun, 06 Nov 1994 08:49:37 GMT 或 Sun,06Nov199408:49:37GMT
+ * @param t [输出]时间
+ * @return true-成功, false-失败
+ */
+static bool parseHttpDate(const std::string& str, time_t& t)
+{
+    static const std::string MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    struct tm gmt = {};
+    char month[4] = {0};
+    if (6 != sscanf(str.c_str(), "%*[^,],%2d%3s%4d%2d:%2d:%2d", &gmt.tm_mday, month, &gmt.tm_year, &gmt.tm_hour, &gmt.tm_min, &gmt.tm_sec))
+    {
+        return false;
+    }
+    auto pos = MONTHS.find(month);
+    if (std::string::npos == pos || 0 != pos % 3)
+    {
+        return false;
+    }
+    gmt.tm_mon = (int)(pos / 3);
+    gmt.tm_year -= 1900;
+#ifdef _WIN32
+    t = _mkgmtime(&gmt);
+#else
+    t = timegm(&gmt);
+#endif
+    return t >= 0;
+}
+
+/**
+ * @brief 生成实体标签(由文件大小和修改时间组成)
+ */
+static std::string makeETag(size_t fileSize, time_t modifyTime)
+{
+    char buf[64] = {0};
+    sprintf(buf, "\"%llx-%llx\"", (unsigned long long)fileSize, (unsigned long long)modifyTime);
+    return buf;
+}
+
+/**
+ * @brief 实体标签列表中是否包含指定标签(弱比较), 例如: "a-1", W/"b-2"
+ */
+static bool matchETag(const std::string& tagList, const std::string& etag)
+{
+    size_t pos = 0;
+    while (pos < tagList.size())
     {
-        conn.close();
+        auto end = tagList.find(',', pos);
+        auto tag = tagList.substr(pos, std::string::npos == end ? std::string::npos : end - pos);
+        pos = (std::string::npos == end) ? tagList.size() : end + 1;
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        if (0 == tag.compare(0, 2, "W/"))
+        {
+            tag.erase(0, 2);
+        }
+        if ("*" == tag || etag == tag)
+        {
+            return true;
+        }
     }
+    return false;
+}
+
+/**
+ * @brief 获取请求头部字段值
+ */
+static std::string getHeader(const nsocket::http::REQUEST_PTR& req, const std::string& key)
+{
+    auto iter = req->headers.find(key);
+    return (req->headers.end() == iter) ? "" : iter->second;
+}
+
+/**
+ * @brief 客户端缓存是否仍然有效(If-None-Match优先于If-Modified-Since)
+ */
+static bool isNotModified(const nsocket::http::REQUEST_PTR& req, const std::string& etag, time_t modifyTime)
+{
+    auto ifNoneMatch = getHeader(req, "If-None-Match");
+    if (!ifNoneMatch.empty())
+    {
+        return matchETag(ifNoneMatch, etag);
+    }
+    time_t since = 0;
+    return parseHttpDate(getHeader(req, "If-Modified-Since"), since) && modifyTime <= since;
+}
+
+/**
+ * @brief 解析范围请求(只支持单个范围, 多个范围时忽略并返回完整内容)
+ * @param range 范围, 例如: bytes=0-499, bytes=500-, bytes=-500
+ * @param fileSize 文件大小
+ * @param offset [输出]起始偏移
+ * @param length [输出]长度
+ * @return 1-有效范围, 0-无范围(或忽略), -1-范围无法满足
+ */
+static int parseRange(const std::string& range, size_t fileSize, size_t& offset, size_t& length)
+{
+    static const std::string UNIT = "bytes=";
+    if (0 != range.compare(0, UNIT.size(), UNIT) || std::string::npos != range.find(','))
+    {
+        return 0;
+    }
+    auto spec = range.substr(UNIT.size());
+    auto dash = spec.find('-');
+    if (std::string::npos == dash || std::string::npos != spec.find_first_not_of("0123456789-") || dash != spec.find_last_of('-'))
+    {
+        return 0;
+    }
+    const auto first = spec.substr(0, dash), last = spec.substr(dash + 1);
+    if (first.size() > 19 || last.size() > 19) /* 避免数值溢出 */
+    {
+        return 0;
+    }
+    if (first.empty()) /* 后缀范围: 最后N个字节 */
+    {
+        if (last.empty())
+        {
+            return 0;
+        }
+        const auto suffix = (size_t)std::stoull(last);
+        if (0 == suffix || 0 == fileSize)
+        {
+            return -1;
+        }
+        length = std::min(suffix, fileSize);
+        offset = fileSize - length;
+        return 1;
+    }
+    offset = (size_t)std::stoull(first);
+    if (offset >= fileSize)
+    {
+        return -1;
+    }
+    size_t end = fileSize - 1;
+    if (!last.empty())
+    {
+        end = (size_t)std::stoull(last);
+        if (end < offset)
+        {
+            return 0;
+        }
+        end = std::min(end, fileSize - 1);
+    }
+    length = end - offset + 1;
+    return 1;
 }
 
 void HttpFileServer::defaultFileGetHandler(uint64_t cid, const nsocket::http::REQUEST_PTR& req, const nsocket::http::Connector& conn,
-                                           bool keepAlive, const std::string& fileName, size_t fileSize)
+                                           bool /*keepAlive*/, const std::string& fileName, size_t fileSize)
 {
-    utility::FileInfo fi(fileName);
+    static const size_t TEXT_SAMPLE_SIZE = 64 * 1024; /* 检测文本文件编码的采样大小 */
+    auto f = fopen(fileName.c_str(), "rb"); /* 只打开1次, 整个响应期间复用 */
+    if (!f)
+    {
+        auto htmlStr = htmlString(cid, req, "404 Not Found: " + req->uri);
+        auto resp = nsocket::http::makeResponse404();
+        resp->body.insert(resp->body.end(), htmlStr.begin(), htmlStr.end());
+        conn.sendAndClose(resp->pack());
+        return;
+    }
+    utility::FileAttribute attr;
+    utility::getFileAttribute(fileName, attr);
+    const auto etag = makeETag(fileSize, attr.modifyTime);
+    const auto lastModified = formatHttpDate(attr.modifyTime);
+    auto resp = nsocket::http::makeResponse200();
+    resp->headers.insert(std::make_pair("ETag", etag));
+    resp->headers.insert(std::make_pair("Last-Modified", lastModified));
+    if (isNotModified(req, etag, attr.modifyTime)) /* 客户端缓存仍有效 */
+    {
+        fclose(f);
+        resp->statusCode = nsocket::http::StatusCode::redirection_not_modified;
+        resp->headers.insert(std::make_pair("Content-Length", std::to_string(fileSize)));
+        conn.sendAndClose(resp->pack());
+        return;
+    }
+    /* 范围请求(If-Range不匹配时返回完整内容) */
+    size_t offset = 0, length = fileSize;
+    const auto ifRange = getHeader(req, "If-Range");
+    time_t ifRangeTime = 0;
+    if (ifRange.empty() || ifRange == etag || (parseHttpDate(ifRange, ifRangeTime) && ifRangeTime == attr.modifyTime))
+    {
+        switch (parseRange(getHeader(req, "Range"), fileSize, offset, length))
+        {
+        case 1: {
+            const auto contentRange = std::to_string(offset) + "-" + std::to_string(offset + length - 1) + "/" + std::to_string(fileSize);
+            resp->statusCode = nsocket::http::StatusCode::success_partial_content;
+            resp->headers.insert(std::make_pair("Content-Range", "bytes " + contentRange));
+            break;
+        }
+        case -1:
+            fclose(f);
+            resp->statusCode = nsocket::http::StatusCode::client_error_range_not_satisfiable;
+            resp->headers.insert(std::make_pair("Content-Range", "bytes */" + std::to_string(fileSize)));
+            conn.sendAndClose(resp->pack());
+            return;
+        }
+    }
+    /* 检测文本文件编码(只采样文件开头部分) */
     auto mimeType = nsocket::http::getFileMimeType(fileName);
-    std::string textFileData;
-    if (fi.isTextFile()) /* 检测文本文件编码 */
+    if (utility::FileInfo::isTextData(f, 0, TEXT_SAMPLE_SIZE))
     {
-        textFileData = fi.readAll();
-        switch (utility::Charset::getCoding(textFileData))
+        std::string sample(std::min(fileSize, TEXT_SAMPLE_SIZE), '\0');
+        sample.resize(fread(&sample[0], 1, sample.size(), f));
+        if (sample.size() < fileSize && std::string::npos != sample.find_last_of('\n')) /* 在行尾截断, 避免截断多字节字符 */
+        {
+            sample.resize(sample.find_last_of('\n') + 1);
+        }
+        switch (utility::Charset::getCoding(sample))
         {
         case utility::Charset::Coding::utf8:
             mimeType += "; charset=utf-8";
@@ -372,55 +588,27 @@ void HttpFileServer::defaultFileGetHandler(uint64_t cid, const nsocket::http::RE
         }
     }
     /* 发送头部 */
-    auto resp = nsocket::http::makeResponse200();
     resp->headers.insert(std::make_pair("Content-Type", mimeType));
-    resp->headers.insert(std::make_pair("Content-Length", std::to_string(fileSize)));
+    resp->headers.insert(std::make_pair("Content-Length", std::to_string(length)));
+    resp->headers.insert(std::make_pair("Accept-Ranges", "bytes"));
     conn.send(resp->pack());
-    /* 发送文件 */
-    if (fileSize <= 0)
-    {
-        return;
-    }
-    if (textFileData.empty())
+    /* 发送文件(分块发送, 普通TCP连接由内核直接发送, 不经过用户态缓冲区) */
+    bool ok = true;
+    size_t sentLength = 0;
+    while (ok && sentLength < length)
     {
-        size_t offset = 0, count = 0;
-        while (1)
-        {
-            offset += count;
-            count = m_fileBlockSize;
-            auto data = fi.read(offset, count);
-            if (!data)
-            {
-                break;
-            }
-            conn.send(std::vector<unsigned char>(data, data + count));
-            free(data);
-        }
-    }
-    else
-    {
-        conn.send(std::vector<unsigned char>(textFileData.c_str(), textFileData.c_str() + fileSize));
-    }
-    if (!keepAlive) /* 非保活才关闭连接 */
-    {
-        conn.close();
+        const auto count = std::min(length - sentLength, m_fileBlockSize);
+        conn.sendFile(f, offset + sentLength, count,
+                      [&](const boost::system::error_code& code, size_t len) { ok = (!code && len == count); });
+        sentLength += count;
     }
+    fclose(f);
+    conn.close(); /* 结束响应(非保活时服务器会断开连接) */
 }
 
 void HttpFileServer::handleDefaultRouter(uint64_t cid, const nsocket::http::REQUEST_PTR& req, const nsocket::http::Connector& conn)
 {
-    bool keeyAlive = false;
-    for (auto iter = req->headers.begin(); req->headers.end() != iter; ++iter)
-    {
-        auto name = iter->first;
-        std::transform(name.begin(), name.end(), name.begin(), tolower);
-        auto value = iter->second;
-        std::transform(value.begin(), value.end(), value.begin(), tolower);
-        if ("connection" == name && std::string::npos != value.find("keep-alive"))
-        {
-            keeyAlive = true;
-        }
-    }
+    const bool keepAlive = req->isKeepAlive();
     auto uri = req->uri;
     uri = nsocket::http::url_decode(uri);
 #ifdef _WIN32
@@ -477,11 +665,11 @@ void HttpFileServer::handleDefaultRouter(uint64_t cid, const nsocket::http::REQU
         }
         if (handler)
         {
-            handler(cid, req, conn, keeyAlive, m_rootDir, uri);
+            handler(cid, req, conn, keepAlive, m_rootDir, uri);
         }
         else
         {
-            defaultDirAccessHandler(cid, req, conn, keeyAlive, m_rootDir, uri);
+            defaultDirAccessHandler(cid, req, conn, keepAlive, m_rootDir, uri);
         }
     }
     else if (attr.isFile) /* 文件 */
@@ -493,11 +681,11 @@ void HttpFileServer::handleDefaultRouter(uint64_t cid, const nsocket::http::REQU
         }
         if (handler)
         {
-            handler(cid, req, conn, keeyAlive, target, attr.size);
+            handler(cid, req, conn, keepAlive, target, attr.size);
         }
         else
         {
-            defaultFileGetHandler(cid, req, conn, keeyAlive, target, attr.size);
+            defaultFileGetHandler(cid, req, conn, keepAlive, target, attr.size);
         }
     }
 }
@@ -23,7 +23,7 @@ using NotHandler =
  * @param cid 连接ID
  * @param req 请求对象
  * @param conn 连接器, 用于处理器内数据发送和连接断开
- * @param keepAlive 连接是否保活, 如果非保活则需要处理器最后断开连接
+ * @param keepAlive 连接是否保活, 处理器最后需调用`conn.close()`结束响应, 非保活时服务器会断开连接
  * @param rootDir 资源根目录
  * @param uri 当前访问的相对目录(不包含根目录)
  */
@@ -35,7 +35,7 @@ using DirAccessHandler = std::function<void(uint64_t cid, const nsocket::http::R
  * @param cid 连接ID
  * @param req 请求对象
  * @param conn 连接器, 用于处理器内数据发送和连接断开
- * @param keepAlive 连接是否保活, 如果非保活则需要处理器最后断开连接
+ * @param keepAlive 连接是否保活, 处理器最后需调用`conn.close()`结束响应, 非保活时服务器会断开连接
  * @param fileName 文件完整路径
  * @param fileSize 文件大小(字节)
  */
@@ -55,7 +55,7 @@ public:
      * @param host 主机地址
      * @param port 端口
      * @param rootDir 资源根目录, 默认使用程序所在目录, 默认程序文件所在目录
-     * @param fileBlockSize 每次读取的文件块大小(字节), 取值范围[4Kb - 16Mb], 默认1Mb
+     * @param fileBlockSize 每次发送的文件块大小(字节), 取值范围[4Kb - 16Mb], 默认1Mb
      * @param reuseAddr 是否允许复用端口, 默认不复用
      * @param bz 数据缓冲区大小(字节)
      * @param handshakeTimeout 握手超时时间
@@ -144,7 +144,8 @@ public:
                                  const std::string& rootDir, const std::string& uri);
 
     /**
-     * @brief 默认文件获取处理器
+     * @brief 默认文件获取处理器, 支持范围请求(Range/If-Range, 返回206/416)和缓存校验(ETag/If-None-Match, Last-Modified/If-Modified-Since,
+     *        返回304), 文件只打开1次, 普通TCP连接使用零拷贝发送文件内容
      * @param cid 连接ID
      * @param req 请求对象
      * @param conn 连接器, 用于处理器内数据发送和连接断开
@@ -173,7 +174,7 @@ private:
     const size_t m_bufferSize; /* 缓冲区大小 */
     const std::chrono::steady_clock::duration m_handshakeTimeout; /* SSL握手超时时间 */
     std::string m_rootDir; /* 文件资源根目录 */
-    size_t m_fileBlockSize; /* 每次读取的文件块大小 */
+    size_t m_fileBlockSize; /* 每次发送的文件块大小 */
     std::mutex m_mutexHttpServer;
     std::shared_ptr<nsocket::http::Server> m_httpServer = nullptr; /* HTTP服务器 */
     std::mutex m_mutexNotAllowHandler;
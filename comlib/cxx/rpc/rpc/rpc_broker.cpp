@@ -15,6 +15,21 @@ static void pack(const msg_base* msg, std::vector<unsigned char>& buffer)
     buffer.insert(buffer.end(), ba.getBuffer(), ba.getBuffer() + ba.getCurrentSize());
 }
 
+/**
+ * @brief 创建消息分帧配置: 4字节大端包体长度 + 包体
+ */
+static nsocket::FrameConfig makeFrameConfig()
+{
+    nsocket::FrameConfig cfg;
+    cfg.type = nsocket::FrameType::length;
+    cfg.headLen = 4;
+    cfg.lengthOffset = 0;
+    cfg.lengthSize = 4;
+    cfg.bigEndian = true;
+    cfg.maxBodyLen = msg_base::maxsize() - 1;
+    return cfg;
+}
+
 class Broker::Client
 {
 public:
@@ -27,7 +42,7 @@ public:
     Client(const std::weak_ptr<nsocket::TcpConnection>& wpConn, const std::string& host, int port)
         : m_wpConn(wpConn), m_host(host), m_port(port)
     {
-        m_payload = std::make_shared<nsocket::Payload>(4);
+        m_frameDecoder = std::make_shared<nsocket::FrameDecoder>(makeFrameConfig());
     }
 
     /**
@@ -129,31 +144,22 @@ public:
      */
     void handleRecv(const std::vector<unsigned char>& data)
     {
-        m_payload->unpack(
-            data,
-            [&](const std::vector<unsigned char>& head) {
-                int bodyLen = utility::ByteArray::read32(head.data(), true);
-                if (bodyLen >= msg_base::maxsize())
-                {
-                    return -1;
-                }
-                return bodyLen;
-            },
-            [&](const std::vector<unsigned char>& body) {
-                utility::ByteArray ba;
-                ba.setBuffer(body.data(), body.size());
-                /* 解析消息类型 */
-                MsgType type = (MsgType)ba.readInt32();
-                /* 处理消息 */
-                if (m_msgHandler)
-                {
-                    m_msgHandler(type, ba);
-                }
-            });
+        m_frameDecoder->decode(data.data(), data.size(),
+                               [&](const unsigned char* head, size_t headLen, const unsigned char* body, size_t bodyLen) {
+                                   utility::ByteArray ba;
+                                   ba.setBuffer(body, bodyLen);
+                                   /* 解析消息类型 */
+                                   MsgType type = (MsgType)ba.readInt32();
+                                   /* 处理消息 */
+                                   if (m_msgHandler)
+                                   {
+                                       m_msgHandler(type, ba);
+                                   }
+                               });
     }
 
 private:
-    std::shared_ptr<nsocket::Payload> m_payload; /* 负载 */
+    std::shared_ptr<nsocket::FrameDecoder> m_frameDecoder; /* 帧解码器 */
     std::weak_ptr<nsocket::TcpConnection> m_wpConn; /* 连接 */
     MSG_HANDLER m_msgHandler; /* 消息句柄 */
     std::string m_host; /* 主机地址 */
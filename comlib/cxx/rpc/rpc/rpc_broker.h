@@ -1,5 +1,5 @@
 #pragma once
-#include "nsocket/payload.h"
+#include "nsocket/frame_decoder.h"
 #include "nsocket/tcp/tcp_server.h"
 #include "rpc_msg.hpp"
 
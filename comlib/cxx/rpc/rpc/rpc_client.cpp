@@ -16,6 +16,21 @@ static void pack(const msg_base* msg, std::vector<unsigned char>& buffer)
     buffer.insert(buffer.end(), ba.getBuffer(), ba.getBuffer() + ba.getCurrentSize());
 }
 
+/**
+ * @brief 创建消息分帧配置: 4字节大端包体长度 + 包体
+ */
+static nsocket::FrameConfig makeFrameConfig()
+{
+    nsocket::FrameConfig cfg;
+    cfg.type = nsocket::FrameType::length;
+    cfg.headLen = 4;
+    cfg.lengthOffset = 0;
+    cfg.lengthSize = 4;
+    cfg.bigEndian = true;
+    cfg.maxBodyLen = msg_base::maxsize() - 1;
+    return cfg;
+}
+
 class Client::Session
 {
 public:
@@ -109,7 +124,7 @@ Client::Client(const std::string& id, const std::string& brokerHost, int brokerP
     {
         throw std::exception(std::logic_error("arg 'id' is empty"));
     }
-    m_payload = std::make_shared<nsocket::Payload>(4);
+    m_frameDecoder = std::make_shared<nsocket::FrameDecoder>(makeFrameConfig());
     m_bindHandler = nullptr;
     m_callHandler = nullptr;
     m_id = id;
@@ -155,7 +170,7 @@ void Client::run(bool async, std::chrono::steady_clock::duration retryTime)
         /* 注意: 最好增加异常捕获, 因为当密码不对时会抛异常 */
         try
         {
-            m_payload->reset();
+            m_frameDecoder->reset();
             m_tcpClient = std::make_shared<nsocket::TcpClient>();
             m_tcpClient->setConnectCallback([&, async](const boost::system::error_code& code) { handleConnection(code, async); });
             m_tcpClient->setDataCallback([&](const std::vector<unsigned char>& data) { handleRecvData(data); });
@@ -332,24 +347,15 @@ void Client::handleRecvData(const std::vector<unsigned char>& data)
     }
 #endif
     /* 逻辑处理 */
-    m_payload->unpack(
-        data,
-        [&](const std::vector<unsigned char>& head) {
-            int bodyLen = utility::ByteArray::read32(head.data(), true);
-            if (bodyLen >= msg_base::maxsize())
-            {
-                return -1;
-            }
-            return bodyLen;
-        },
-        [&](const std::vector<unsigned char>& body) {
-            utility::ByteArray ba;
-            ba.setBuffer(body.data(), body.size());
-            /* 解析消息类型 */
-            MsgType type = (MsgType)ba.readInt32();
-            /* 处理消息 */
-            handleMsg(type, ba);
-        });
+    m_frameDecoder->decode(data.data(), data.size(),
+                           [&](const unsigned char* head, size_t headLen, const unsigned char* body, size_t bodyLen) {
+                               utility::ByteArray ba;
+                               ba.setBuffer(body, bodyLen);
+                               /* 解析消息类型 */
+                               MsgType type = (MsgType)ba.readInt32();
+                               /* 处理消息 */
+                               handleMsg(type, ba);
+                           });
 }
 
 void Client::handleMsg(const MsgType& type, utility::ByteArray& ba)
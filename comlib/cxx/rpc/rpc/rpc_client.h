@@ -2,7 +2,7 @@
 #include <atomic>
 #include <future>
 
-#include "nsocket/payload.h"
+#include "nsocket/frame_decoder.h"
 #include "nsocket/tcp/tcp_client.h"
 #include "rpc_msg.hpp"
 
@@ -106,7 +106,7 @@ private:
     void onSessionTimeout(int64_t seqId);
 
 private:
-    std::shared_ptr<nsocket::Payload> m_payload; /* 负载 */
+    std::shared_ptr<nsocket::FrameDecoder> m_frameDecoder; /* 帧解码器 */
     std::shared_ptr<nsocket::TcpClient> m_tcpClient; /* 客户端 */
     BIND_HANDLER m_bindHandler; /* 绑定回调句柄 */
     CALL_HANDLER m_callHandler; /* 调用回调句柄 */
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nsocket/http/server.h"
+#include "utility/cmdline/cmdline.h"
+
+/**
+ * @brief 压测参数
+ */
+struct BenchConfig
+{
+    std::string host; /* 服务器地址 */
+    int port = 0; /* 服务器端口 */
+    std::string uri; /* 请求URI */
+    size_t connections = 0; /* 并发连接数 */
+    size_t duration = 0; /* 压测时长(秒) */
+    size_t pipeline = 1; /* 每个连接每批发送的请求数(流水线深度) */
+    bool keepAlive = true; /* 是否保活 */
+};
+
+/**
+ * @brief 压测统计
+ */
+struct BenchStat
+{
+    std::mutex mutex; /* for latencyList */
+    std::vector<int64_t> latencyList; /* 每批请求的耗时(微秒) */
+    std::atomic<size_t> requests = {0}; /* 完成的请求数 */
+    std::atomic<size_t> connects = {0}; /* 建立的连接数 */
+    std::atomic<size_t> errors = {0}; /* 错误数 */
+    std::atomic<size_t> bytes = {0}; /* 接收的字节数 */
+};
+
+/**
+ * @brief 从缓冲区中取出完整的响应(以`Content-Length`确定响应体长度)
+ * @param buffer 缓冲区
+ * @param closeFlag [输出]服务端是否要求关闭连接
+ * @return 响应长度, 0-响应不完整, <0-响应非法
+ */
+static int64_t takeResponse(const std::string& buffer, bool& closeFlag)
+{
+    auto headEnd = buffer.find("\r\n\r\n");
+    if (std::string::npos == headEnd)
+    {
+        return 0;
+    }
+    if (0 != buffer.compare(0, 5, "HTTP/"))
+    {
+        return -1;
+    }
+    auto head = buffer.substr(0, headEnd + 2);
+    std::transform(head.begin(), head.end(), head.begin(), tolower);
+    size_t contentLength = 0;
+    auto pos = head.find("\r\ncontent-length:");
+    if (std::string::npos != pos)
+    {
+        contentLength = (size_t)std::atoll(head.c_str() + pos + 17);
+    }
+    pos = head.find("\r\nconnection:");
+    if (std::string::npos != pos && std::string::npos != head.find("close", pos))
+    {
+        closeFlag = true;
+    }
+    size_t total = headEnd + 4 + contentLength;
+    return (buffer.size() >= total) ? (int64_t)total : 0;
+}
+
+/**
+ * @brief 压测连接(阻塞方式): 每批发送`pipeline`个请求, 收齐所有响应后再发送下一批
+ */
+static void benchConnection(const BenchConfig& cfg, const std::chrono::steady_clock::time_point& endTime, BenchStat& stat)
+{
+    const size_t batch = cfg.keepAlive ? cfg.pipeline : 1; /* 非保活时每个连接只能完成1个请求 */
+    std::string req;
+    for (size_t i = 0; i < batch; ++i)
+    {
+        req.append("GET " + cfg.uri + " HTTP/1.1\r\nHost: " + cfg.host + "\r\n");
+        req.append(cfg.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    }
+    const boost::asio::ip::tcp::endpoint point(boost::asio::ip::address::from_string(cfg.host), cfg.port);
+    boost::asio::io_context ioContext;
+    std::vector<int64_t> latencyList;
+    std::vector<char> recvBuf(64 * 1024);
+    while (std::chrono::steady_clock::now() < endTime)
+    {
+        boost::asio::ip::tcp::socket socket(ioContext);
+        boost::system::error_code code;
+        socket.connect(point, code);
+        if (code)
+        {
+            ++stat.errors;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        socket.set_option(boost::asio::ip::tcp::no_delay(true), code);
+        ++stat.connects;
+        std::string buffer;
+        bool closeFlag = false;
+        while (!closeFlag && std::chrono::steady_clock::now() < endTime)
+        {
+            auto tp1 = std::chrono::steady_clock::now();
+            boost::asio::write(socket, boost::asio::buffer(req), code);
+            if (code)
+            {
+                ++stat.errors;
+                break;
+            }
+            size_t done = 0;
+            while (done < batch)
+            {
+                int64_t len = takeResponse(buffer, closeFlag);
+                if (len < 0)
+                {
+                    code = boost::asio::error::invalid_argument;
+                    break;
+                }
+                else if (len > 0)
+                {
+                    buffer.erase(0, (size_t)len);
+                    ++done;
+                    continue;
+                }
+                auto n = socket.read_some(boost::asio::buffer(recvBuf), code);
+                if (code)
+                {
+                    break;
+                }
+                stat.bytes += n;
+                buffer.append(recvBuf.data(), n);
+            }
+            stat.requests += done;
+            if (done < batch)
+            {
+                ++stat.errors;
+                break;
+            }
+            latencyList.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tp1).count());
+            if (!cfg.keepAlive)
+            {
+                break;
+            }
+        }
+        socket.close(code);
+    }
+    std::lock_guard<std::mutex> locker(stat.mutex);
+    stat.latencyList.insert(stat.latencyList.end(), latencyList.begin(), latencyList.end());
+}
+
+/**
+ * @brief 启动内置的服务器(只响应固定内容)
+ */
+static std::shared_ptr<nsocket::http::Server> startEmbeddedServer(const BenchConfig& cfg, size_t threadCount, size_t idleTimeout,
+                                                                  size_t maxRequests)
+{
+    auto server = std::make_shared<nsocket::http::Server>("bench_server", threadCount, cfg.host, cfg.port, true);
+    server->setKeepAlive(true, std::chrono::seconds(idleTimeout), maxRequests);
+    auto r = std::make_shared<nsocket::http::Router_simple>();
+    r->respHandler = [](uint64_t cid, const nsocket::http::REQUEST_PTR& req, const std::string& data,
+                        const nsocket::http::Connector& conn) {
+        static const std::string BODY = "Hello World!";
+        auto resp = nsocket::http::makeResponse200();
+        resp->headers.insert(std::make_pair("Content-Type", "text/plain"));
+        resp->body.insert(resp->body.end(), BODY.begin(), BODY.end());
+        conn.sendAndClose(resp->pack());
+    };
+    server->addRouter({nsocket::http::Method::GET}, {cfg.uri}, r);
+    std::string errDesc;
+    if (!server->run(false, 1, 2, "", "", "", &errDesc))
+    {
+        printf("服务器启动失败: %s\n", errDesc.c_str());
+        return nullptr;
+    }
+    return server;
+}
+
+int main(int argc, char* argv[])
+{
+    /* 命令参数 */
+    cmdline::parser parser;
+    parser.header("HTTP压测(类似wrk), 默认启动内置服务器并对其压测");
+    parser.add<std::string>("server", 's', "服务器地址, 默认:", false, "127.0.0.1");
+    parser.add<int>("port", 'p', "服务器端口, 默认:", false, 4445, cmdline::range(1, 65535));
+    parser.add<std::string>("uri", 'u', "请求URI, 默认:", false, "/");
+    parser.add<int>("connections", 'c', "并发连接数, 默认:", false, 32, cmdline::range(1, 10000));
+    parser.add<int>("duration", 'd', "压测时长(秒), 默认:", false, 10, cmdline::range(1, 3600));
+    parser.add<int>("pipeline", 'l', "流水线深度(每批请求数), 默认:", false, 1, cmdline::range(1, 1024));
+    parser.add<int>("keep-alive", 'k', "是否保活, 值: 0-每个请求新建连接, 1-保活, 默认:", false, 1, cmdline::range(0, 1));
+    parser.add<int>("embedded", 'e', "是否启动内置服务器, 值: 0-否, 1-是, 默认:", false, 1, cmdline::range(0, 1));
+    parser.add<int>("threads", 't', "内置服务器线程数, 默认:", false, 4, cmdline::range(1, 256));
+    parser.add<int>("idle-timeout", 'i', "内置服务器保活空闲超时(秒), 默认:", false, 60, cmdline::range(0, 3600));
+    parser.add<int>("max-requests", 'm', "内置服务器单连接最多请求数(0表示不限制), 默认:", false, 0, cmdline::range(0, 100000000));
+    parser.parse_check(argc, argv, "用法", "选项", "显示帮助信息并退出");
+    /* 参数解析 */
+    BenchConfig cfg;
+    cfg.host = parser.get<std::string>("server");
+    cfg.port = parser.get<int>("port");
+    cfg.uri = parser.get<std::string>("uri");
+    cfg.connections = parser.get<int>("connections");
+    cfg.duration = parser.get<int>("duration");
+    cfg.pipeline = parser.get<int>("pipeline");
+    cfg.keepAlive = (1 == parser.get<int>("keep-alive"));
+    std::shared_ptr<nsocket::http::Server> server = nullptr;
+    if (1 == parser.get<int>("embedded"))
+    {
+        server = startEmbeddedServer(cfg, parser.get<int>("threads"), parser.get<int>("idle-timeout"), parser.get<int>("max-requests"));
+        if (!server)
+        {
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    printf("压测 http://%s:%d%s, 连接数: %zu, 时长: %zu秒, 流水线深度: %zu, 保活: %s\n", cfg.host.c_str(), cfg.port, cfg.uri.c_str(),
+           cfg.connections, cfg.duration, cfg.pipeline, cfg.keepAlive ? "是" : "否");
+    BenchStat stat;
+    auto tp1 = std::chrono::steady_clock::now();
+    const auto endTime = tp1 + std::chrono::seconds(cfg.duration);
+    std::vector<std::thread> threadList;
+    for (size_t i = 0; i < cfg.connections; ++i)
+    {
+        threadList.emplace_back([&] { benchConnection(cfg, endTime, stat); });
+    }
+    for (auto& th : threadList)
+    {
+        th.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp1).count();
+    /* 统计结果 */
+    auto& latencyList = stat.latencyList;
+    std::sort(latencyList.begin(), latencyList.end());
+    auto percentile = [&](double p) {
+        return latencyList.empty() ? 0.0 : latencyList[std::min(latencyList.size() - 1, (size_t)(latencyList.size() * p))] / 1000.0;
+    };
+    printf("  请求数: %zu, 连接数: %zu, 错误数: %zu, 接收: %.2f MB\n", stat.requests.load(), stat.connects.load(), stat.errors.load(),
+           stat.bytes / (1024.0 * 1024.0));
+    printf("  每批耗时(毫秒) p50: %.3f, p90: %.3f, p99: %.3f, max: %.3f\n", percentile(0.5), percentile(0.9), percentile(0.99),
+           percentile(1.0));
+    printf("  Requests/sec: %.0f\n", stat.requests / seconds);
+    if (server)
+    {
+        server->stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return 0;
+}
@@ -83,6 +83,8 @@ int main(int argc, char* argv[])
     parser.add<std::string>("pk-file", 'k', "私钥文件名, 例如: server.key, 默认:", false, "");
     parser.add<std::string>("pk-pwd", 'P', "私钥文件密码, 例如: 123456, 默认:", false, "");
 #endif
+    parser.add<int>("idle-timeout", 'i', "连接保活空闲超时(秒), 0表示不超时, 默认:", false, 60, cmdline::range(0, 3600));
+    parser.add<int>("max-requests", 'm', "单个连接最多处理的请求数, 0表示不限制, 默认:", false, 1000, cmdline::range(0, 100000000));
     parser.add<std::string>("router", 'r', "自定义路由(JSON), 例如: [{\"method\":\"GET\",\"uri\":\"test1\"}], 默认:", false, "");
     parser.parse_check(argc, argv, "用法", "选项", "显示帮助信息并退出");
     printf("%s\n", parser.usage().c_str());
@@ -97,8 +99,11 @@ int main(int argc, char* argv[])
     auto pkFile = parser.get<std::string>("pk-file");
     auto pkPwd = parser.get<std::string>("pk-pwd");
 #endif
+    auto idleTimeout = parser.get<int>("idle-timeout");
+    auto maxRequests = parser.get<int>("max-requests");
     auto routerList = nlohmann::parse(parser.get<std::string>("router"));
     g_server = std::make_shared<nsocket::http::Server>("http_server", 10, server, port);
+    g_server->setKeepAlive(true, std::chrono::seconds(idleTimeout), maxRequests);
     /* 设置默认路由回调 */
     g_server->setDefaultRouterCallback([&](uint64_t cid, const nsocket::http::REQUEST_PTR& req, const nsocket::http::Connector& conn) {
         printf("****************************** 路由未找到 ******************************\n");
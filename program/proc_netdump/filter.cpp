@@ -44,6 +44,21 @@ void Filter::setCondition(const std::string& condition)
     m_showIec103 = ("iec103" == condition);
 }
 
+void Filter::hideAll()
+{
+    m_showEthernet = false;
+    m_showIpv4 = false;
+    m_showArp = false;
+    m_showIpv6 = false;
+    m_showTcp = false;
+    m_showUdp = false;
+    m_showIcmp = false;
+    m_showIcmpv6 = false;
+    m_showFtp = false;
+    m_showFtpData = false;
+    m_showIec103 = false;
+}
+
 bool Filter::showEthernet() const
 {
     return m_showEthernet;
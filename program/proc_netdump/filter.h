@@ -27,6 +27,11 @@ public:
      */
     void setCondition(const std::string& condition);
 
+    /**
+     * @brief 不显示任何协议(只统计)
+     */
+    void hideAll();
+
     bool showEthernet() const;
 
     bool showIpv4() const;
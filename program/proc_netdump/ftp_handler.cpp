@@ -38,24 +38,24 @@ void printFtpCtrlResp(const std::string& flag, const std::string& param)
  */
 void printFtpData(const npacket::FtpParser::CtrlInfo& ctrl, const npacket::FtpParser::DataFlag& flag, const uint8_t* data, uint32_t dataLen)
 {
-    std::string modeDesc = npacket::FtpParser::DataMode::active == ctrl.mode ? "PORT" : "PASV";
-    if (npacket::FtpParser::DataFlag::ready == flag)
+    std::string modeDesc = npacket::FtpParser::DataMode::ACTIVE == ctrl.mode ? "PORT" : "PASV";
+    if (npacket::FtpParser::DataFlag::READY == flag)
     {
         printf("            ----- FTP-DATA [%s][start][client: %s:%d][server: %s:%d] -----\n", modeDesc.c_str(), ctrl.clientIp.c_str(),
                ctrl.clientPort, ctrl.serverIp.c_str(), ctrl.serverPort);
     }
-    else if (npacket::FtpParser::DataFlag::body == flag)
+    else if (npacket::FtpParser::DataFlag::BODY == flag)
     {
         printf("            ----- FTP-DATA [%s][%d][client: %s:%d][server: %s:%d] -----\n", modeDesc.c_str(), dataLen,
                ctrl.clientIp.c_str(), ctrl.clientPort, ctrl.serverIp.c_str(), ctrl.serverPort);
         printf("%s\n", std::string(data, data + dataLen).c_str());
     }
-    else if (npacket::FtpParser::DataFlag::finish == flag)
+    else if (npacket::FtpParser::DataFlag::FINISH == flag)
     {
         printf("            ----- FTP-DATA [%s][finish][client: %s:%d][server: %s:%d] -----\n", modeDesc.c_str(), ctrl.clientIp.c_str(),
                ctrl.clientPort, ctrl.serverIp.c_str(), ctrl.serverPort);
     }
-    else if (npacket::FtpParser::DataFlag::abnormal == flag)
+    else if (npacket::FtpParser::DataFlag::ABNORMAL == flag)
     {
         printf("            ----- FTP-DATA [%s][timeout][client: %s:%d][server: %s:%d] -----\n", modeDesc.c_str(), ctrl.clientIp.c_str(),
                ctrl.clientPort, ctrl.serverIp.c_str(), ctrl.serverPort);
@@ -63,7 +63,7 @@ void printFtpData(const npacket::FtpParser::CtrlInfo& ctrl, const npacket::FtpPa
 }
 
 void handleApplicationFtpCtrlReq(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                                 const std::shared_ptr<npacket::ProtocolHeader>& header, const std::string& flag, const std::string& param)
+                                 const npacket::ProtocolHeader* header, const std::string& flag, const std::string& param)
 {
     if (Filter::getInstance().showFtp())
     {
@@ -73,7 +73,7 @@ void handleApplicationFtpCtrlReq(const std::chrono::steady_clock::time_point& nt
 }
 
 void handleApplicationFtpCtrlResp(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                                  const std::shared_ptr<npacket::ProtocolHeader>& header, const std::string& flag, const std::string& param)
+                                  const npacket::ProtocolHeader* header, const std::string& flag, const std::string& param)
 {
     if (Filter::getInstance().showFtp())
     {
@@ -83,7 +83,7 @@ void handleApplicationFtpCtrlResp(const std::chrono::steady_clock::time_point& n
 }
 
 void handleApplicationFtpData(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                              const std::shared_ptr<npacket::ProtocolHeader>& header, const npacket::FtpParser::CtrlInfo& ctrl,
+                              const npacket::ProtocolHeader* header, const npacket::FtpParser::CtrlInfo& ctrl,
                               const npacket::FtpParser::DataFlag& flag, const uint8_t* data, uint32_t dataLen)
 {
     if (Filter::getInstance().showFtpData())
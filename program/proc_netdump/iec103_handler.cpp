@@ -557,7 +557,7 @@ void printIEC103VariableFrame(const std::shared_ptr<npacket::iec103::VariableFra
 }
 
 void handleApplicationIec103FixedFrame(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                                       const std::shared_ptr<npacket::ProtocolHeader>& header,
+                                       const npacket::ProtocolHeader* header,
                                        const std::shared_ptr<npacket::iec103::FixedFrame>& frame)
 {
     if (Filter::getInstance().showIec103())
@@ -568,7 +568,7 @@ void handleApplicationIec103FixedFrame(const std::chrono::steady_clock::time_poi
 }
 
 void handleApplicationIec103VariableFrame(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                                          const std::shared_ptr<npacket::ProtocolHeader>& header,
+                                          const npacket::ProtocolHeader* header,
                                           const std::shared_ptr<npacket::iec103::VariableFrame>& frame)
 {
     if (Filter::getInstance().showIec103())
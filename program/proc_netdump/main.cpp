@@ -14,21 +14,22 @@
 #include "iec103_handler.h"
 #include "npacket/analyzer.h"
 #include "npacket/device/pcap_device.h"
+#include "npacket/pcap_file.h"
 #include "npacket/proto/ftp.h"
 #include "npacket/proto/iec103.h"
 #include "print.h"
 #include "utility/cmdline/cmdline.h"
 #include "utility/strtool/strtool.h"
 
-static npacket::Analyzer s_pktAnalyzer; /* 包分析器 */
+static std::shared_ptr<npacket::Analyzer> s_pktAnalyzer = nullptr; /* 包分析器 */
+static npacket::PcapFileWriter s_pcapWriter; /* 抓包文件写入器 */
 
 /**
  * @brief 处理以太网层
  */
-bool handleEthernetLayer(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                         const std::shared_ptr<npacket::ProtocolHeader>& header, const uint8_t* payload, uint32_t payloadLen)
+bool handleEthernetLayer(const npacket::ProtocolData& pd)
 {
-    auto h = std::dynamic_pointer_cast<npacket::EthernetIIHeader>(header);
+    auto h = (const npacket::EthernetIIHeader*)(pd.header);
     if (Filter::getInstance().showEthernet())
     {
         printEthernet(h);
@@ -39,42 +40,41 @@ bool handleEthernetLayer(const std::chrono::steady_clock::time_point& ntp, uint3
 /**
  * @brief 处理网络层
  */
-bool handleNetworkLayer(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                        const std::shared_ptr<npacket::ProtocolHeader>& header, const uint8_t* payload, uint32_t payloadLen)
+bool handleNetworkLayer(const npacket::ProtocolData& pd)
 {
-    switch ((npacket::NetworkProtocol)header->getProtocol())
+    switch ((npacket::NetworkProtocol)pd.header->getProtocol())
     {
     case npacket::NetworkProtocol::IPv4: {
-        auto h = std::dynamic_pointer_cast<npacket::Ipv4Header>(header);
+        auto h = (const npacket::Ipv4Header*)(pd.header);
         if (Filter::getInstance().showIpv4())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent));
             }
             printIPv4(h);
         }
     }
     break;
     case npacket::NetworkProtocol::ARP: {
-        auto h = std::dynamic_pointer_cast<npacket::ArpHeader>(header);
+        auto h = (const npacket::ArpHeader*)(pd.header);
         if (Filter::getInstance().showArp())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent));
             }
             printARP(h);
         }
     }
     break;
     case npacket::NetworkProtocol::IPv6: {
-        auto h = std::dynamic_pointer_cast<npacket::Ipv6Header>(header);
+        auto h = (const npacket::Ipv6Header*)(pd.header);
         if (Filter::getInstance().showIpv6())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent));
             }
             printIPv6(h);
         }
@@ -87,31 +87,30 @@ bool handleNetworkLayer(const std::chrono::steady_clock::time_point& ntp, uint32
 /**
  * @brief 处理传输层
  */
-bool handleTransportLayer(const std::chrono::steady_clock::time_point& ntp, uint32_t totalLen,
-                          const std::shared_ptr<npacket::ProtocolHeader>& header, const uint8_t* payload, uint32_t payloadLen)
+bool handleTransportLayer(const npacket::ProtocolData& pd)
 {
-    switch ((npacket::TransportProtocol)header->getProtocol())
+    switch ((npacket::TransportProtocol)pd.header->getProtocol())
     {
     case npacket::TransportProtocol::TCP: {
-        auto h = std::dynamic_pointer_cast<npacket::TcpHeader>(header);
+        auto h = (const npacket::TcpHeader*)(pd.header);
         if (Filter::getInstance().showTcp())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent->parent));
             }
             switch (h->parent->getProtocol())
             {
             case npacket::NetworkProtocol::IPv4:
                 if (!Filter::getInstance().showIpv4())
                 {
-                    printIPv4(std::dynamic_pointer_cast<npacket::Ipv4Header>(h->parent));
+                    printIPv4((const npacket::Ipv4Header*)(h->parent));
                 }
                 break;
             case npacket::NetworkProtocol::IPv6:
                 if (!Filter::getInstance().showIpv6())
                 {
-                    printIPv6(std::dynamic_pointer_cast<npacket::Ipv6Header>(h->parent));
+                    printIPv6((const npacket::Ipv6Header*)(h->parent));
                 }
                 break;
             }
@@ -120,25 +119,25 @@ bool handleTransportLayer(const std::chrono::steady_clock::time_point& ntp, uint
     }
     break;
     case npacket::TransportProtocol::UDP: {
-        auto h = std::dynamic_pointer_cast<npacket::UdpHeader>(header);
+        auto h = (const npacket::UdpHeader*)(pd.header);
         if (Filter::getInstance().showUdp())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent->parent));
             }
             switch (h->parent->getProtocol())
             {
             case npacket::NetworkProtocol::IPv4:
                 if (!Filter::getInstance().showIpv4())
                 {
-                    printIPv4(std::dynamic_pointer_cast<npacket::Ipv4Header>(h->parent));
+                    printIPv4((const npacket::Ipv4Header*)(h->parent));
                 }
                 break;
             case npacket::NetworkProtocol::IPv6:
                 if (!Filter::getInstance().showIpv6())
                 {
-                    printIPv6(std::dynamic_pointer_cast<npacket::Ipv6Header>(h->parent));
+                    printIPv6((const npacket::Ipv6Header*)(h->parent));
                 }
                 break;
             }
@@ -147,18 +146,18 @@ bool handleTransportLayer(const std::chrono::steady_clock::time_point& ntp, uint
     }
     break;
     case npacket::TransportProtocol::ICMP: {
-        auto h = std::dynamic_pointer_cast<npacket::IcmpHeader>(header);
+        auto h = (const npacket::IcmpHeader*)(pd.header);
         if (Filter::getInstance().showIcmp())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent->parent));
             }
             if (npacket::NetworkProtocol::IPv4 == h->parent->getProtocol())
             {
                 if (!Filter::getInstance().showIpv4())
                 {
-                    printIPv4(std::dynamic_pointer_cast<npacket::Ipv4Header>(h->parent));
+                    printIPv4((const npacket::Ipv4Header*)(h->parent));
                 }
             }
             printICMP(h);
@@ -166,18 +165,18 @@ bool handleTransportLayer(const std::chrono::steady_clock::time_point& ntp, uint
     }
     break;
     case npacket::TransportProtocol::ICMPv6: {
-        auto h = std::dynamic_pointer_cast<npacket::Icmpv6Header>(header);
+        auto h = (const npacket::Icmpv6Header*)(pd.header);
         if (Filter::getInstance().showIcmpv6())
         {
             if (!Filter::getInstance().showEthernet())
             {
-                printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent->parent));
+                printEthernet((const npacket::EthernetIIHeader*)(h->parent->parent));
             }
             if (npacket::NetworkProtocol::IPv6 == h->parent->getProtocol())
             {
                 if (!Filter::getInstance().showIpv6())
                 {
-                    printIPv6(std::dynamic_pointer_cast<npacket::Ipv6Header>(h->parent));
+                    printIPv6((const npacket::Ipv6Header*)(h->parent));
                 }
             }
             printICMPv6(h);
@@ -188,6 +187,79 @@ bool handleTransportLayer(const std::chrono::steady_clock::time_point& ntp, uint
     return true;
 }
 
+/**
+ * @brief 创建包分析器
+ */
+void createAnalyzer()
+{
+    npacket::CallbackConfig cbCfg;
+    cbCfg.ethernetLayerCb = handleEthernetLayer;
+    cbCfg.networkLayerCb = handleNetworkLayer;
+    cbCfg.transportLayerCb = handleTransportLayer;
+    s_pktAnalyzer = std::make_shared<npacket::Analyzer>(cbCfg);
+    {
+        auto ftpParser = std::make_shared<npacket::FtpParser>();
+        ftpParser->setRequestCallback(handleApplicationFtpCtrlReq);
+        ftpParser->setResponseCallback(handleApplicationFtpCtrlResp);
+        ftpParser->setDataCallback(handleApplicationFtpData);
+        s_pktAnalyzer->addProtocolParser(ftpParser);
+    }
+    {
+        auto iec103Parser = std::make_shared<npacket::Iec103Parser>();
+        iec103Parser->setFixedFrameCallback(handleApplicationIec103FixedFrame);
+        iec103Parser->setVariableFrameCallback(handleApplicationIec103VariableFrame);
+        s_pktAnalyzer->addProtocolParser(iec103Parser);
+    }
+}
+
+/**
+ * @brief 回放抓包文件(数据包直接从文件映射内存送入分析器, 使用原始时间戳), 结束后输出吞吐量
+ * @param filename 文件名
+ * @param speed 回放速度, <=0表示全速
+ */
+void replayFile(const std::string& filename, double speed)
+{
+    npacket::PcapFileReader reader;
+    std::string errorDesc;
+    if (!reader.open(filename, &errorDesc))
+    {
+        printf("打开文件失败: %s\n", errorDesc.c_str());
+        return;
+    }
+    printf("文  件: %s\n", filename.c_str());
+    printf("格  式: %s, 大小: %.1f MB\n", npacket::PcapFileFormat::PCAPNG == reader.getFormat() ? "pcapng" : "pcap",
+           reader.getFileSize() / 1048576.0);
+    printf("开始回放 ...\n");
+    printf("\n");
+    size_t num = 0;
+    uint64_t byteCount = 0;
+    const auto tp = std::chrono::steady_clock::now();
+    reader.replay(
+        [&](const npacket::PcapFilePacket& pkt, const std::chrono::steady_clock::time_point& ntp) {
+            if (1 == pkt.linkType) /* 只分析以太网帧 */
+            {
+                s_pktAnalyzer->parse(0, ++num, ntp, pkt.data, pkt.capLen);
+                byteCount += pkt.capLen;
+            }
+            return true;
+        },
+        speed);
+    const double sec = std::max(std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count(), 1e-9);
+    printf("\n");
+    printf("回放结束%s, 包数: %zu, 字节数: %llu, 耗时: %.3f 秒, 吞吐: %.0f 包/秒, %.1f MB/秒\n", reader.isTruncated() ? "(文件已截断)" : "",
+           num, (unsigned long long)byteCount, sec, num / sec, byteCount / 1048576.0 / sec);
+}
+
+/**
+ * @brief 打印抓包文件写入统计
+ */
+void printWriterStat()
+{
+    const auto stat = s_pcapWriter.getStat();
+    printf("[写文件] 包数: %llu, 字节数: %llu, 丢弃: %llu, 文件数: %llu, 错误: %llu\n", (unsigned long long)stat.packets,
+           (unsigned long long)stat.bytes, (unsigned long long)stat.drops, (unsigned long long)stat.files, (unsigned long long)stat.errors);
+}
+
 int main(int argc, char* argv[])
 {
 #ifdef _WIN32
@@ -211,6 +283,14 @@ int main(int argc, char* argv[])
 #endif
     auto protos = utility::StrTool::join(Filter::protoList(), ", ");
     parser.add<std::string>("express", 'e', "设置过滤表达式, 目前只支持单个协议过滤, 例如: " + protos, false, "");
+    parser.add<std::string>("write", 'w', "把抓到的数据包写入pcap文件, 值为路径前缀(例如: /data/eth0), 文件名自动追加时间和序号.", false,
+                            "");
+    parser.add<int>("rotate-size", 'C', "单个抓包文件最大大小(MB), 超出时切换到新文件, 0表示不限制, 默认:", false, 0);
+    parser.add<int>("rotate-time", 'G', "单个抓包文件最长时间(秒), 超出时切换到新文件, 0表示不限制, 默认:", false, 0);
+    parser.add<int>("rotate-count", 'W', "最多保留的抓包文件数量(删除最早的文件), 0表示不限制, 默认:", false, 0);
+    parser.add<std::string>("read", 'r', "读取抓包文件(pcap/pcapng)进行分析(不抓包), 结束后输出吞吐量.", false, "");
+    parser.add<double>("speed", 's', "读取抓包文件的回放速度, 0-全速, 1-原始速率, 2-2倍速, 默认:", false, 0);
+    parser.add("quiet", 'q', "不打印数据包详情, 写抓包文件时也不进行分析.");
     parser.parse_check(argc, argv, " 用法 ", " 选项 ", "显示帮助信息并退出.");
     printf("%s\n", parser.usage().c_str());
     /* 参数解析 */
@@ -230,6 +310,20 @@ int main(int argc, char* argv[])
     }
 #endif
     auto express = utility::StrTool::toLower(parser.get<std::string>("express"));
+    auto writePath = parser.get<std::string>("write");
+    auto readFile = parser.get<std::string>("read");
+    bool quiet = parser.exist("quiet");
+    Filter::getInstance().setCondition(express);
+    if (quiet)
+    {
+        Filter::getInstance().hideAll();
+    }
+    createAnalyzer();
+    if (!readFile.empty())
+    {
+        replayFile(readFile, parser.get<double>("speed"));
+        return 0;
+    }
     auto devList = npacket::PcapDevice::getAllDevices();
     if (showList)
     {
@@ -267,21 +361,6 @@ int main(int argc, char* argv[])
         printf("  IPv4: %s\n", ip.c_str());
     }
     printf("包流向: %s\n", 1 == direction ? "in(接收)" : (2 == direction ? "out(发送)" : "inout(所有)"));
-    Filter::getInstance().setCondition(express);
-    s_pktAnalyzer.setLayerCallback(handleEthernetLayer, handleNetworkLayer, handleTransportLayer);
-    {
-        auto ftpParser = std::make_shared<npacket::FtpParser>();
-        ftpParser->setRequestCallback(handleApplicationFtpCtrlReq);
-        ftpParser->setResponseCallback(handleApplicationFtpCtrlResp);
-        ftpParser->setDataCallback(handleApplicationFtpData);
-        s_pktAnalyzer.addProtocolParser(ftpParser);
-    }
-    {
-        auto iec103Parser = std::make_shared<npacket::Iec103Parser>();
-        iec103Parser->setFixedFrameCallback(handleApplicationIec103FixedFrame);
-        iec103Parser->setVariableFrameCallback(handleApplicationIec103VariableFrame);
-        s_pktAnalyzer.addProtocolParser(iec103Parser);
-    }
     std::shared_ptr<npacket::PcapDevice> dev;
     for (size_t i = 0; i < devList.size(); ++i)
     {
@@ -305,15 +384,51 @@ int main(int argc, char* argv[])
         printf("  IPv4: %s\n", dev->getIpv4Address().c_str());
     }
     printf("描  述: %s\n", dev->getDescribe().c_str());
+    if (!writePath.empty())
+    {
+        npacket::PcapWriterConfig writerCfg;
+        writerCfg.path = writePath;
+        writerCfg.maxFileSize = (uint64_t)std::max(parser.get<int>("rotate-size"), 0) * 1024 * 1024;
+        writerCfg.maxFileDuration = (uint32_t)std::max(parser.get<int>("rotate-time"), 0);
+        writerCfg.maxFileCount = (size_t)std::max(parser.get<int>("rotate-count"), 0);
+        std::string errorDesc;
+        if (!s_pcapWriter.open(writerCfg, &errorDesc))
+        {
+            printf("写文件失败: %s\n", errorDesc.c_str());
+            return 0;
+        }
+        printf("写文件: %s_*.pcap\n", writePath.c_str());
+    }
     printf("开始抓包 ...\n");
     printf("\n");
-    dev->setDataCallback([&](const unsigned char* data, int dataLen) { s_pktAnalyzer.parse(data, dataLen); });
+    const bool recording = !writePath.empty();
+    const bool analyzing = !(recording && quiet); /* 只写文件时不分析, 以达到线速 */
+    size_t num = 0;
+    auto ntp = std::chrono::steady_clock::now();
+    dev->setDataCallback([&](const unsigned char* data, unsigned int dataLen) {
+        if (recording)
+        {
+            s_pcapWriter.write(data, dataLen); /* 设备回调不带时间戳, 使用当前时间 */
+        }
+        if (analyzing)
+        {
+            s_pktAnalyzer->parse(0, ++num, ntp, data, dataLen);
+        }
+    });
     dev->startCapture();
+    auto lastStatTime = ntp;
     while (1)
     {
+        ntp = std::chrono::steady_clock::now(); /* 每批数据包获取1次时间点 */
         dev->captureOnce();
+        if (recording && ntp - lastStatTime >= std::chrono::seconds(10))
+        {
+            lastStatTime = ntp;
+            printWriterStat();
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
     dev->close();
+    s_pcapWriter.close();
     return 0;
 }
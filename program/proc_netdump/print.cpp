@@ -4,15 +4,21 @@
 
 #include "filter.h"
 
-void printEthernet(const std::shared_ptr<npacket::EthernetIIHeader>& h)
+void printEthernet(const npacket::EthernetIIHeader* h)
 {
+    std::string srcMac, dstMac;
+    h->srcMacStr(srcMac);
+    h->dstMacStr(dstMac);
     printf("=============== EthernetII ===============\n");
-    printf("src mac: %s, dst mac: %s\n", h->srcMacStr().c_str(), h->dstMacStr().c_str());
+    printf("src mac: %s, dst mac: %s\n", srcMac.c_str(), dstMac.c_str());
     printf("type: 0x%04x\n", h->nextProtocol);
 }
 
-void printIPv4(const std::shared_ptr<npacket::Ipv4Header>& h)
+void printIPv4(const npacket::Ipv4Header* h)
 {
+    std::string srcAddr, dstAddr;
+    h->srcAddrStr(srcAddr);
+    h->dstAddrStr(dstAddr);
     printf("    ----- IPv4 -----\n");
     printf("    version: %d, header len: %d, tos: %d, total len: %d\n", h->version, h->headerLen, h->tos, h->totalLen);
     printf("    identification: 0x%04x (%d)\n", h->identification, h->identification);
@@ -21,28 +27,36 @@ void printIPv4(const std::shared_ptr<npacket::Ipv4Header>& h)
     printf("    ttl: %d\n", h->ttl);
     printf("    protocol: %d\n", h->nextProtocol);
     printf("    checksum: 0x%04x\n", h->checksum);
-    printf("    src addr: %s, dst addr: %s\n", h->srcAddrStr().c_str(), h->dstAddrStr().c_str());
+    printf("    src addr: %s, dst addr: %s\n", srcAddr.c_str(), dstAddr.c_str());
 }
 
-void printARP(const std::shared_ptr<npacket::ArpHeader>& h)
+void printARP(const npacket::ArpHeader* h)
 {
+    std::string senderMac, senderIp, targetMac, targetIp;
+    h->senderMacStr(senderMac);
+    h->senderIpStr(senderIp);
+    h->targetMacStr(targetMac);
+    h->targetIpStr(targetIp);
     printf("    ----- ARP -----\n");
     printf("    header len: %d\n", h->headerLen);
     printf("    hardware type: 0x%04x, hardware size: %d\n", h->hardwareType, h->hardwareSize);
     printf("    protocol type: 0x%04x, protocol size: %d\n", h->protocolType, h->protocolSize);
     printf("    opcode: %d\n", h->opcode);
-    printf("    sender mac: %s, sender ip: %s\n", h->senderMacStr().c_str(), h->senderIpStr().c_str());
-    printf("    target mac: %s, target ip: %s\n", h->targetMacStr().c_str(), h->targetIpStr().c_str());
+    printf("    sender mac: %s, sender ip: %s\n", senderMac.c_str(), senderIp.c_str());
+    printf("    target mac: %s, target ip: %s\n", targetMac.c_str(), targetIp.c_str());
 }
 
-void printIPv6(const std::shared_ptr<npacket::Ipv6Header>& h)
+void printIPv6(const npacket::Ipv6Header* h)
 {
+    std::string srcAddr, dstAddr;
+    h->srcAddrStr(srcAddr);
+    h->dstAddrStr(dstAddr);
     printf("    ----- IPv6 -----\n");
     printf("    version: %d, traffic class: %d, flow label: %u, payload len: %d\n", h->version, h->trafficClass, h->flowLabel,
            h->payloadLen);
     printf("    next header: %d\n", h->nextHeader);
     printf("    hop limit: %d\n", h->hopLimit);
-    printf("    srcAddr: %s, dstAddr: %s\n", h->srcAddrStr().c_str(), h->dstAddrStr().c_str());
+    printf("    srcAddr: %s, dstAddr: %s\n", srcAddr.c_str(), dstAddr.c_str());
     if (0 == h->nextHeader) /* 扩展包头: Hop-by-Hop */
     {
         printf("    [hop by hop] next header: %d\n", h->hopByHopHeader.nextHeader);
@@ -59,7 +73,7 @@ void printIPv6(const std::shared_ptr<npacket::Ipv6Header>& h)
     }
 }
 
-void printTCP(const std::shared_ptr<npacket::TcpHeader>& h)
+void printTCP(const npacket::TcpHeader* h)
 {
     printf("        ----- TCP -----\n");
     printf("        src port: %d, dst port: %d\n", h->srcPort, h->dstPort);
@@ -72,7 +86,7 @@ void printTCP(const std::shared_ptr<npacket::TcpHeader>& h)
     printf("        urgptr: %d\n", h->urgptr);
 }
 
-void printUDP(const std::shared_ptr<npacket::UdpHeader>& h)
+void printUDP(const npacket::UdpHeader* h)
 {
     printf("        ----- UDP -----\n");
     printf("        src port: %d, dst port: %d\n", h->srcPort, h->dstPort);
@@ -80,64 +94,64 @@ void printUDP(const std::shared_ptr<npacket::UdpHeader>& h)
     printf("        checksum: 0x%04x\n", h->checksum);
 }
 
-void printICMP(const std::shared_ptr<npacket::IcmpHeader>& h)
+void printICMP(const npacket::IcmpHeader* h)
 {
     printf("        ----- ICMP -----\n");
     printf("        type: %d, code: %d, checksum: 0x%04x\n", h->type, h->code, h->checksum);
 }
 
-void printICMPv6(const std::shared_ptr<npacket::Icmpv6Header>& h)
+void printICMPv6(const npacket::Icmpv6Header* h)
 {
     printf("        ----- ICMPv6 -----\n");
     printf("        type: %d, code: %d, checksum: 0x%04x\n", h->type, h->code, h->checksum);
 }
 
-void printTransportHeader(const std::shared_ptr<npacket::ProtocolHeader>& h)
+void printTransportHeader(const npacket::ProtocolHeader* h)
 {
     if (!Filter::getInstance().showEthernet())
     {
-        printEthernet(std::dynamic_pointer_cast<npacket::EthernetIIHeader>(h->parent->parent));
+        printEthernet((const npacket::EthernetIIHeader*)(h->parent->parent));
     }
     if (npacket::NetworkProtocol::IPv4 == h->parent->getProtocol())
     {
         if (!Filter::getInstance().showIpv4())
         {
-            printIPv4(std::dynamic_pointer_cast<npacket::Ipv4Header>(h->parent));
+            printIPv4((const npacket::Ipv4Header*)(h->parent));
         }
     }
     else if (npacket::NetworkProtocol::IPv6 == h->parent->getProtocol())
     {
         if (!Filter::getInstance().showIpv6())
         {
-            printIPv6(std::dynamic_pointer_cast<npacket::Ipv6Header>(h->parent));
+            printIPv6((const npacket::Ipv6Header*)(h->parent));
         }
     }
     if (npacket::TransportProtocol::TCP == h->getProtocol())
     {
         if (Filter::getInstance().showTcp())
         {
-            printTCP(std::dynamic_pointer_cast<npacket::TcpHeader>(h));
+            printTCP((const npacket::TcpHeader*)(h));
         }
     }
     else if (npacket::TransportProtocol::UDP == h->getProtocol())
     {
         if (Filter::getInstance().showUdp())
         {
-            printUDP(std::dynamic_pointer_cast<npacket::UdpHeader>(h));
+            printUDP((const npacket::UdpHeader*)(h));
         }
     }
     else if (npacket::TransportProtocol::ICMP == h->getProtocol())
     {
         if (Filter::getInstance().showIcmp())
         {
-            printICMP(std::dynamic_pointer_cast<npacket::IcmpHeader>(h));
+            printICMP((const npacket::IcmpHeader*)(h));
         }
     }
     else if (npacket::TransportProtocol::ICMPv6 == h->getProtocol())
     {
         if (Filter::getInstance().showIcmpv6())
         {
-            printICMPv6(std::dynamic_pointer_cast<npacket::Icmpv6Header>(h));
+            printICMPv6((const npacket::Icmpv6Header*)(h));
         }
     }
 }
@@ -4,44 +4,44 @@
 /**
  * @brief 打印以太网
  */
-void printEthernet(const std::shared_ptr<npacket::EthernetIIHeader>& h);
+void printEthernet(const npacket::EthernetIIHeader* h);
 
 /**
  * @brief 打印IPv4
  */
-void printIPv4(const std::shared_ptr<npacket::Ipv4Header>& h);
+void printIPv4(const npacket::Ipv4Header* h);
 
 /**
  * @brief 打印ARP
  */
-void printARP(const std::shared_ptr<npacket::ArpHeader>& h);
+void printARP(const npacket::ArpHeader* h);
 
 /**
  * @brief 打印IPv6
  */
-void printIPv6(const std::shared_ptr<npacket::Ipv6Header>& h);
+void printIPv6(const npacket::Ipv6Header* h);
 
 /**
  * @brief 打印TCP
  */
-void printTCP(const std::shared_ptr<npacket::TcpHeader>& h);
+void printTCP(const npacket::TcpHeader* h);
 
 /**
  * @brief 打印UDP
  */
-void printUDP(const std::shared_ptr<npacket::UdpHeader>& h);
+void printUDP(const npacket::UdpHeader* h);
 
 /**
  * @brief 打印ICMP
  */
-void printICMP(const std::shared_ptr<npacket::IcmpHeader>& h);
+void printICMP(const npacket::IcmpHeader* h);
 
 /**
  * @brief 打印ICMPv6
  */
-void printICMPv6(const std::shared_ptr<npacket::Icmpv6Header>& h);
+void printICMPv6(const npacket::Icmpv6Header* h);
 
 /**
  * @brief 打印传输层头部
  */
-void printTransportHeader(const std::shared_ptr<npacket::ProtocolHeader>& h);
+void printTransportHeader(const npacket::ProtocolHeader* h);